@@ -19,6 +19,7 @@
 #include "drm_connector.h"
 #include "drm_crtc.h"
 #include "drm_egl_backend.h"
+#include "drm_egl_layer_surface.h"
 #include "drm_gpu.h"
 #include "drm_output.h"
 #include "drm_pipeline.h"
@@ -87,6 +88,8 @@ private Q_SLOTS:
     void testModeset_data();
     void testModeset();
     void testVrrChange();
+    void testDamageClipMapping_data();
+    void testDamageClipMapping();
 };
 
 static void verifyCleanup(MockGpu *mockGpu)
@@ -488,5 +491,30 @@ void DrmTest::testVrrChange()
     QVERIFY(output->capabilities() & BackendOutput::Capability::Vrr);
 }
 
+void DrmTest::testDamageClipMapping_data()
+{
+    QTest::addColumn<OutputTransform::Kind>("outputTransform");
+    QTest::addColumn<QRegion>("deviceRegion");
+    QTest::addColumn<QRegion>("bufferRegion");
+
+    // the buffer is 100x50, the render target is rotated like the output
+    QTest::addRow("normal") << OutputTransform::Normal << QRegion(0, 0, 10, 20) << QRegion(0, 0, 10, 20);
+    QTest::addRow("normal, clipped") << OutputTransform::Normal << QRegion(90, 40, 20, 20) << QRegion(90, 40, 10, 10);
+    QTest::addRow("rotate-90") << OutputTransform::Rotate90 << QRegion(0, 0, 10, 20) << QRegion(0, 40, 20, 10);
+    QTest::addRow("rotate-270") << OutputTransform::Rotate270 << QRegion(0, 0, 10, 20) << QRegion(80, 0, 20, 10);
+    QTest::addRow("rotate-90, clipped") << OutputTransform::Rotate90 << QRegion(40, 90, 20, 20) << QRegion(90, 0, 10, 10);
+}
+
+void DrmTest::testDamageClipMapping()
+{
+    QFETCH(OutputTransform::Kind, outputTransform);
+    QFETCH(QRegion, deviceRegion);
+    QFETCH(QRegion, bufferRegion);
+
+    // EglGbmLayer renders with the output transform combined with a y flip
+    const OutputTransform contentTransform = OutputTransform(outputTransform).combine(OutputTransform::FlipY);
+    QCOMPARE(EglGbmLayerSurface::mapToBuffer(deviceRegion, contentTransform, QSize(100, 50)), bufferRegion);
+}
+
 QTEST_GUILESS_MAIN(DrmTest)
 #include "mockDrmTest.moc"
@@ -0,0 +1,218 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "compositor.h"
+#include "core/backendoutput.h"
+#include "core/output.h"
+#include "core/renderbackend.h"
+#include "core/renderjournal.h"
+#include "core/renderloop.h"
+#include "cursor.h"
+#include "effect/effecthandler.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/subsurface.h>
+#include <KWayland/Client/surface.h>
+
+#include <algorithm>
+#include <time.h>
+
+using namespace std::chrono_literals;
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_compositing_benchmark-0");
+static const int s_frameCount = 120;
+
+static std::chrono::nanoseconds cpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+static double toMilliseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static std::chrono::nanoseconds percentile(std::vector<std::chrono::nanoseconds> samples, double rank)
+{
+    if (samples.empty()) {
+        return 0ns;
+    }
+    std::ranges::sort(samples);
+    const size_t index = std::min<size_t>(samples.size() - 1, samples.size() * rank / 100);
+    return samples[index];
+}
+
+/**
+ * This benchmark lets synthetic clients commit new buffers as fast as the compositor presents
+ * them and reports how long the frames take. As the compositor and the clients share the
+ * process, the CPU time includes the work of the clients, which is the same for every run.
+ */
+class CompositingBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void benchmarkFrames_data();
+    void benchmarkFrames();
+};
+
+void CompositingBenchmark::initTestCase()
+{
+    if (!Test::renderNodeAvailable()) {
+        QSKIP("no render node available");
+        return;
+    }
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    qRegisterMetaType<Window *>();
+
+    QVERIFY(waylandServer()->init(s_socketName));
+    kwinApp()->start();
+
+    // a high refresh rate keeps the benchmark from measuring how long it waits for the vblank
+    Test::setOutputConfig({Test::OutputInfo{
+        .geometry = QRect(0, 0, 1920, 1080),
+        .modes = {{QSize(1920, 1080), 1'000'000ul, OutputMode::Flag::Preferred}},
+    }});
+
+    effects->unloadAllEffects();
+    Cursors::self()->hideCursor();
+}
+
+void CompositingBenchmark::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void CompositingBenchmark::benchmarkFrames_data()
+{
+    QTest::addColumn<int>("windowCount");
+    QTest::addColumn<int>("subsurfaceCount");
+    QTest::addColumn<bool>("fullDamage");
+
+    QTest::addRow("1 window, full damage") << 1 << 0 << true;
+    QTest::addRow("1 window, partial damage") << 1 << 0 << false;
+    QTest::addRow("8 windows, full damage") << 8 << 0 << true;
+    QTest::addRow("8 windows, partial damage") << 8 << 0 << false;
+    QTest::addRow("8 windows with subsurfaces, partial damage") << 8 << 4 << false;
+    QTest::addRow("32 windows, partial damage") << 32 << 0 << false;
+}
+
+void CompositingBenchmark::benchmarkFrames()
+{
+    QFETCH(int, windowCount);
+    QFETCH(int, subsurfaceCount);
+    QFETCH(bool, fullDamage);
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::PresentationTime));
+
+    const QSize windowSize(640, 480);
+    const QSize subsurfaceSize(64, 64);
+    const std::array<QColor, 2> colors{Qt::red, Qt::blue};
+
+    struct Client
+    {
+        std::unique_ptr<Test::XdgToplevelWindow> window;
+        std::vector<std::unique_ptr<KWayland::Client::Surface>> subsurfaces;
+        std::vector<std::unique_ptr<KWayland::Client::SubSurface>> roles;
+    };
+    std::vector<Client> clients(windowCount);
+    for (Client &client : clients) {
+        client.window = std::make_unique<Test::XdgToplevelWindow>();
+        for (int i = 0; i < subsurfaceCount; ++i) {
+            auto surface = Test::createSurface();
+            auto role = Test::createSubSurface(surface.get(), client.window->m_surface.get());
+            role->setPosition(QPoint(i * subsurfaceSize.width(), 0));
+            Test::render(surface.get(), subsurfaceSize, colors[0]);
+            client.subsurfaces.push_back(std::move(surface));
+            client.roles.push_back(std::move(role));
+        }
+        QVERIFY(client.window->show(windowSize, colors[0]));
+    }
+
+    RenderLoop *renderLoop = workspace()->outputs().front()->backendOutput()->renderLoop();
+    const auto startTimestamp = std::chrono::steady_clock::now().time_since_epoch();
+
+    std::vector<std::chrono::nanoseconds> frameTimes;
+    std::vector<std::chrono::nanoseconds> cpuTimes;
+    frameTimes.reserve(s_frameCount);
+    cpuTimes.reserve(s_frameCount);
+    for (int frame = 0; frame < s_frameCount; ++frame) {
+        const QColor &color = colors[frame % colors.size()];
+        const QRect damageRect = fullDamage
+            ? QRect(QPoint(), windowSize)
+            : QRect(QPoint((frame * 16) % (windowSize.width() - 64), (frame * 8) % (windowSize.height() - 64)), QSize(64, 64));
+
+        const auto frameStart = std::chrono::steady_clock::now();
+        const auto cpuStart = cpuTime();
+        for (Client &client : clients) {
+            for (const auto &surface : client.subsurfaces) {
+                QImage image(subsurfaceSize, QImage::Format_ARGB32_Premultiplied);
+                image.fill(color);
+                surface->attachBuffer(Test::waylandShmPool()->createBuffer(image));
+                surface->damage(QRect(QPoint(), subsurfaceSize));
+                surface->commit(KWayland::Client::Surface::CommitFlag::None);
+            }
+            QImage image(windowSize, QImage::Format_ARGB32_Premultiplied);
+            image.fill(color);
+            client.window->m_surface->attachBuffer(Test::waylandShmPool()->createBuffer(image));
+            client.window->m_surface->damage(damageRect);
+        }
+        for (size_t i = 0; i + 1 < clients.size(); ++i) {
+            clients[i].window->m_surface->commit(KWayland::Client::Surface::CommitFlag::None);
+        }
+        // the last window waits for the frame that shows all of them
+        QVERIFY(clients.back().window->presentWait());
+        frameTimes.push_back(std::chrono::steady_clock::now() - frameStart);
+        cpuTimes.push_back(cpuTime() - cpuStart);
+    }
+
+    std::vector<std::chrono::nanoseconds> renderTimes;
+    std::vector<std::chrono::nanoseconds> gpuTimes;
+    for (const FrameTimingRecord &record : renderLoop->frameTimings().records()) {
+        if (record.presentation < startTimestamp) {
+            continue;
+        }
+        if (record.renderEnd != 0ns) {
+            renderTimes.push_back(record.renderEnd - record.renderStart);
+        }
+        if (record.gpuTime != 0ns) {
+            gpuTimes.push_back(record.gpuTime);
+        }
+    }
+
+    qInfo("frame time: p50 %.3fms, p95 %.3fms, p99 %.3fms",
+          toMilliseconds(percentile(frameTimes, 50)), toMilliseconds(percentile(frameTimes, 95)), toMilliseconds(percentile(frameTimes, 99)));
+    qInfo("cpu time per frame: p50 %.3fms, p95 %.3fms",
+          toMilliseconds(percentile(cpuTimes, 50)), toMilliseconds(percentile(cpuTimes, 95)));
+    qInfo("render time: p50 %.3fms, p95 %.3fms",
+          toMilliseconds(percentile(renderTimes, 50)), toMilliseconds(percentile(renderTimes, 95)));
+    qInfo("gpu time: p50 %.3fms, p95 %.3fms",
+          toMilliseconds(percentile(gpuTimes, 50)), toMilliseconds(percentile(gpuTimes, 95)));
+
+    QTest::setBenchmarkResult(toMilliseconds(percentile(frameTimes, 95)), QTest::WalltimeMilliseconds);
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::CompositingBenchmark)
+#include "compositing_benchmark.moc"
@@ -8,6 +8,7 @@
 */
 #include "kwin_wayland_test.h"
 
+#include "idledetector.h"
 #include "input.h"
 #include "virtualdesktops.h"
 #include "wayland_server.h"
@@ -33,6 +34,7 @@ private Q_SLOTS:
     void testDontInhibitWhenMinimized();
     void testDontInhibitWhenUnmapped();
     void testDontInhibitWhenLeftCurrentDesktop();
+    void testIdleDetectors();
 };
 
 void TestIdleInhibition::initTestCase()
@@ -298,5 +300,37 @@ void TestIdleInhibition::testDontInhibitWhenLeftCurrentDesktop()
     QCOMPARE(input()->idleInhibitors(), QList<Window *>{});
 }
 
+void TestIdleInhibition::testIdleDetectors()
+{
+    // This test verifies that detectors with different timeouts go idle in order and resume
+    // together on user activity, even if there has been activity while they counted down.
+
+    IdleDetector shortDetector(std::chrono::milliseconds(100), IdleDetector::OperatingMode::FollowsInhibitors);
+    IdleDetector longDetector(std::chrono::milliseconds(300), IdleDetector::OperatingMode::FollowsInhibitors);
+    QSignalSpy shortIdleSpy(&shortDetector, &IdleDetector::idle);
+    QSignalSpy longIdleSpy(&longDetector, &IdleDetector::idle);
+    QSignalSpy shortResumedSpy(&shortDetector, &IdleDetector::resumed);
+    QSignalSpy longResumedSpy(&longDetector, &IdleDetector::resumed);
+
+    // activity in the meantime postpones the deadline
+    QTest::qWait(60);
+    input()->simulateUserActivity();
+    QTest::qWait(60);
+    QCOMPARE(shortIdleSpy.count(), 0);
+
+    QVERIFY(shortIdleSpy.wait());
+    QCOMPARE(longIdleSpy.count(), 0);
+    QVERIFY(longIdleSpy.wait());
+    QCOMPARE(shortIdleSpy.count(), 1);
+
+    input()->simulateUserActivity();
+    QCOMPARE(shortResumedSpy.count(), 1);
+    QCOMPARE(longResumedSpy.count(), 1);
+
+    // both count down again after resuming
+    QVERIFY(shortIdleSpy.wait());
+    QCOMPARE(shortIdleSpy.count(), 2);
+}
+
 WAYLANDTEST_MAIN(TestIdleInhibition)
 #include "idle_inhibition_test.moc"
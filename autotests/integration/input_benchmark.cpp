@@ -0,0 +1,201 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "input.h"
+#include "input_event_spy.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <KWayland/Client/keyboard.h>
+#include <KWayland/Client/pointer.h>
+#include <KWayland/Client/seat.h>
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/touch.h>
+
+#include <QElapsedTimer>
+#include <QScopeGuard>
+
+#include <algorithm>
+#include <linux/input-event-codes.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_input_benchmark-0");
+static const int s_eventCount = 2000;
+
+/**
+ * A filter that lets every event through, like most filters do most of the time.
+ */
+class PassthroughFilter : public InputEventFilter
+{
+public:
+    PassthroughFilter()
+        : InputEventFilter(InputFilterOrder::WindowAction)
+    {
+    }
+};
+
+/**
+ * A spy that looks at every event without doing anything with it.
+ */
+class IdleSpy : public InputEventSpy
+{
+};
+
+static qint64 percentile(std::vector<qint64> samples, double rank)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    std::ranges::sort(samples);
+    const size_t index = std::min<size_t>(samples.size() - 1, samples.size() * rank / 100);
+    return samples[index];
+}
+
+/**
+ * This benchmark injects streams of input events and measures how long InputRedirection
+ * takes to dispatch every single one, that is until the event has been handed to the
+ * focused client. Filters and spies that let the events through are installed on top of
+ * the built-in ones to see how the dispatch scales with them.
+ */
+class InputBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void benchmarkDispatch_data();
+    void benchmarkDispatch();
+};
+
+void InputBenchmark::initTestCase()
+{
+    qRegisterMetaType<Window *>();
+
+    QVERIFY(waylandServer()->init(s_socketName));
+    kwinApp()->start();
+    Test::setOutputConfig({
+        QRect(0, 0, 1280, 1024),
+    });
+}
+
+void InputBenchmark::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void InputBenchmark::benchmarkDispatch_data()
+{
+    QTest::addColumn<QString>("device");
+    QTest::addColumn<int>("filterCount");
+    QTest::addColumn<int>("spyCount");
+    QTest::addColumn<int>("clientCount");
+
+    for (const QString &device : {QStringLiteral("pointer"), QStringLiteral("touch"), QStringLiteral("tablet"), QStringLiteral("keyboard")}) {
+        QTest::addRow("%s, built-in filters", qPrintable(device)) << device << 0 << 0 << 1;
+        QTest::addRow("%s, 16 filters, 16 spies", qPrintable(device)) << device << 16 << 16 << 1;
+        QTest::addRow("%s, 8 clients", qPrintable(device)) << device << 0 << 0 << 8;
+    }
+}
+
+void InputBenchmark::benchmarkDispatch()
+{
+    QFETCH(QString, device);
+    QFETCH(int, filterCount);
+    QFETCH(int, spyCount);
+    QFETCH(int, clientCount);
+
+    std::vector<std::unique_ptr<PassthroughFilter>> filters;
+    for (int i = 0; i < filterCount; ++i) {
+        filters.push_back(std::make_unique<PassthroughFilter>());
+        input()->installInputEventFilter(filters.back().get());
+    }
+    std::vector<std::unique_ptr<IdleSpy>> spies;
+    for (int i = 0; i < spyCount; ++i) {
+        spies.push_back(std::make_unique<IdleSpy>());
+        input()->installInputEventSpy(spies.back().get());
+    }
+    auto uninstall = qScopeGuard([&filters, &spies]() {
+        for (const auto &filter : filters) {
+            input()->uninstallInputEventFilter(filter.get());
+        }
+        for (const auto &spy : spies) {
+            input()->uninstallInputEventSpy(spy.get());
+        }
+    });
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::Seat));
+    QVERIFY(Test::waitForWaylandPointer());
+    QVERIFY(Test::waitForWaylandKeyboard());
+    std::unique_ptr<KWayland::Client::Pointer> pointer(Test::waylandSeat()->createPointer());
+    std::unique_ptr<KWayland::Client::Keyboard> keyboard(Test::waylandSeat()->createKeyboard());
+    std::unique_ptr<KWayland::Client::Touch> touch(Test::waylandSeat()->hasTouch() ? Test::waylandSeat()->createTouch() : nullptr);
+
+    // the window shown last is active and on top of the others, all events go to it
+    std::vector<std::unique_ptr<Test::XdgToplevelWindow>> windows;
+    for (int i = 0; i < clientCount; ++i) {
+        windows.push_back(std::make_unique<Test::XdgToplevelWindow>());
+        QVERIFY(windows.back()->show(QSize(400, 400)));
+        windows.back()->m_window->move(QPointF(100, 100));
+    }
+    const QRectF target = windows.back()->m_window->frameGeometry();
+    QVERIFY(workspace()->activeWindow() == windows.back()->m_window);
+
+    quint32 timestamp = 0;
+    const auto positionAt = [&target](int event) {
+        return target.topLeft() + QPointF(10 + event % 300, 10 + (event * 7) % 300);
+    };
+    if (device == QLatin1String("touch")) {
+        Test::touchDown(0, positionAt(0), timestamp++);
+    } else if (device == QLatin1String("tablet")) {
+        Test::tabletToolProximityEvent(positionAt(0), 0, 0, 0, 0, false, 0, timestamp++);
+    } else if (device == QLatin1String("pointer")) {
+        Test::pointerMotion(positionAt(0), timestamp++);
+    }
+
+    std::vector<qint64> latencies;
+    latencies.reserve(s_eventCount);
+    QElapsedTimer timer;
+    for (int event = 1; event <= s_eventCount; ++event) {
+        timer.start();
+        if (device == QLatin1String("pointer")) {
+            Test::pointerMotion(positionAt(event), timestamp++);
+        } else if (device == QLatin1String("touch")) {
+            Test::touchMotion(0, positionAt(event), timestamp++);
+        } else if (device == QLatin1String("tablet")) {
+            Test::tabletToolAxisEvent(positionAt(event), 0.5, 0, 0, 0, 0, false, 0, timestamp++);
+        } else if (event % 2) {
+            Test::keyboardKeyPressed(KEY_A, timestamp++);
+        } else {
+            Test::keyboardKeyReleased(KEY_A, timestamp++);
+        }
+        latencies.push_back(timer.nsecsElapsed());
+    }
+
+    if (device == QLatin1String("touch")) {
+        Test::touchUp(0, timestamp++);
+    }
+
+    qInfo("dispatch latency: p50 %lldns, p95 %lldns, p99 %lldns, max %lldns",
+          percentile(latencies, 50), percentile(latencies, 95), percentile(latencies, 99), *std::ranges::max_element(latencies));
+    QTest::setBenchmarkResult(percentile(latencies, 95), QTest::WalltimeNanoseconds);
+
+    windows.clear();
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::InputBenchmark)
+#include "input_benchmark.moc"
@@ -50,6 +50,7 @@ private Q_SLOTS:
 
     void testKeepAbove();
     void testKeepBelow();
+    void testRaiseLowerAcrossLayerChange();
 
     void testPreserveRelativeWindowStacking();
 
@@ -937,6 +938,43 @@ void StackingOrderTest::testKeepBelow()
     QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window2, window1}));
 }
 
+void StackingOrderTest::testRaiseLowerAcrossLayerChange()
+{
+    // This test verifies that windows raised or lowered while another window is in a
+    // different layer are stacked correctly once that window is back in their layer.
+
+    std::unique_ptr<KWayland::Client::Surface> surface1 = Test::createSurface();
+    QVERIFY(surface1);
+    std::unique_ptr<Test::XdgToplevel> shellSurface1(Test::createXdgToplevelSurface(surface1.get()));
+    QVERIFY(shellSurface1);
+    Window *window1 = Test::renderAndWaitForShown(surface1.get(), QSize(128, 128), Qt::green);
+    QVERIFY(window1);
+
+    std::unique_ptr<KWayland::Client::Surface> surface2 = Test::createSurface();
+    QVERIFY(surface2);
+    std::unique_ptr<Test::XdgToplevel> shellSurface2(Test::createXdgToplevelSurface(surface2.get()));
+    QVERIFY(shellSurface2);
+    Window *window2 = Test::renderAndWaitForShown(surface2.get(), QSize(128, 128), Qt::green);
+    QVERIFY(window2);
+    QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window1, window2}));
+
+    window2->setKeepAbove(true);
+    QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window1, window2}));
+
+    // window1 is raised, but stays below window2 as long as window2 is kept above.
+    workspace()->raiseWindow(window1);
+    QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window1, window2}));
+
+    window2->setKeepAbove(false);
+    QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window2, window1}));
+
+    workspace()->lowerWindow(window1);
+    QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window1, window2}));
+
+    workspace()->raiseWindow(window1);
+    QCOMPARE(workspace()->stackingOrder(), (QList<Window *>{window2, window1}));
+}
+
 void StackingOrderTest::testPreserveRelativeWindowStacking()
 {
     // This test verifies that raising a window doesn't affect the order of transient windows that are constrained
@@ -8,6 +8,7 @@
 */
 #include "kwin_wayland_test.h"
 
+#include "dbusinterface.h"
 #include "main.h"
 #include "virtualdesktops.h"
 #include "wayland_server.h"
@@ -37,6 +38,8 @@ private Q_SLOTS:
     void testLastDesktopRemoved();
     void testWindowOnMultipleDesktops();
     void testRemoveDesktopWithWindow();
+    void testDBusSignalsCoalesced();
+    void testWindowsOnDesktop();
 };
 
 void VirtualDesktopTest::initTestCase()
@@ -262,5 +265,76 @@ void VirtualDesktopTest::testRemoveDesktopWithWindow()
     QCOMPARE(VirtualDesktopManager::self()->desktops()[1], window->desktops()[0]);
 }
 
+void VirtualDesktopTest::testDBusSignalsCoalesced()
+{
+    auto dbusInterface = VirtualDesktopManager::self()->findChild<VirtualDesktopManagerDBusInterface *>();
+    QVERIFY(dbusInterface);
+    // let the changes made in init() go out first
+    QTest::qWait(10);
+
+    QSignalSpy desktopCreatedSpy(dbusInterface, &VirtualDesktopManagerDBusInterface::desktopCreated);
+    QSignalSpy countChangedSpy(dbusInterface, &VirtualDesktopManagerDBusInterface::countChanged);
+    QSignalSpy desktopsChangedSpy(dbusInterface, &VirtualDesktopManagerDBusInterface::desktopsChanged);
+    QSignalSpy stateChangedSpy(dbusInterface, &VirtualDesktopManagerDBusInterface::stateChanged);
+
+    VirtualDesktopManager::self()->setCount(4);
+    QVERIFY(stateChangedSpy.wait());
+    QCOMPARE(desktopCreatedSpy.count(), 3);
+    QCOMPARE(countChangedSpy.count(), 1);
+    QCOMPARE(countChangedSpy.first().first().toUInt(), 4u);
+    QCOMPARE(desktopsChangedSpy.count(), 1);
+    QCOMPARE(stateChangedSpy.count(), 1);
+
+    const QVariantMap diff = stateChangedSpy.first().first().toMap();
+    QCOMPARE(diff.value(QStringLiteral("count")).toUInt(), 4u);
+    QCOMPARE(diff.value(QStringLiteral("created")).toList().count(), 3);
+    QVERIFY(!diff.contains(QStringLiteral("removed")));
+    QVERIFY(!diff.contains(QStringLiteral("current")));
+
+    // a desktop that is added and removed again in the same turn is not reported at all
+    VirtualDesktopManager::self()->setCount(5);
+    VirtualDesktopManager::self()->setCount(4);
+    QVERIFY(stateChangedSpy.wait());
+    QCOMPARE(desktopCreatedSpy.count(), 3);
+    QCOMPARE(desktopsChangedSpy.count(), 1);
+    QVERIFY(!stateChangedSpy.last().first().toMap().contains(QStringLiteral("created")));
+    QVERIFY(!stateChangedSpy.last().first().toMap().contains(QStringLiteral("removed")));
+}
+
+void VirtualDesktopTest::testWindowsOnDesktop()
+{
+    VirtualDesktopManager::self()->setCount(3);
+    const auto desktops = VirtualDesktopManager::self()->desktops();
+    VirtualDesktopManager::self()->setCurrent(desktops.at(0));
+
+    std::unique_ptr<KWayland::Client::Surface> surface(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.get()));
+    auto window = Test::renderAndWaitForShown(surface.get(), QSize(100, 50), Qt::blue);
+    QVERIFY(window);
+    QCOMPARE(workspace()->windowsOnDesktop(desktops.at(0)), QList<Window *>{window});
+    QVERIFY(workspace()->windowsOnDesktop(desktops.at(1)).isEmpty());
+
+    window->enterDesktop(desktops.at(1));
+    QCOMPARE(workspace()->windowsOnDesktop(desktops.at(0)), QList<Window *>{window});
+    QCOMPARE(workspace()->windowsOnDesktop(desktops.at(1)), QList<Window *>{window});
+    QVERIFY(workspace()->windowsOnDesktop(desktops.at(2)).isEmpty());
+
+    window->leaveDesktop(desktops.at(0));
+    QVERIFY(workspace()->windowsOnDesktop(desktops.at(0)).isEmpty());
+    QCOMPARE(workspace()->windowsOnDesktop(desktops.at(1)), QList<Window *>{window});
+
+    // a window on all desktops is on every one of them
+    window->setOnAllDesktops(true);
+    for (VirtualDesktop *desktop : desktops) {
+        QCOMPARE(workspace()->windowsOnDesktop(desktop), QList<Window *>{window});
+    }
+
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowClosed(window));
+    for (VirtualDesktop *desktop : desktops) {
+        QVERIFY(workspace()->windowsOnDesktop(desktop).isEmpty());
+    }
+}
+
 WAYLANDTEST_MAIN(VirtualDesktopTest)
 #include "virtual_desktop_test.moc"
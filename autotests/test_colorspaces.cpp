@@ -4,11 +4,15 @@
     SPDX-License-Identifier: LGPL-2.0-or-later
 */
 
+#include <QFloat16>
 #include <QImage>
 #include <QTest>
 
+#include "core/colorlut3d.h"
 #include "core/colorpipeline.h"
+#include "core/colorpipelinestage.h"
 #include "core/colorspace.h"
+#include "core/colortransformation.h"
 #include "core/iccprofile.h"
 #include "opengl/eglcontext.h"
 #include "opengl/egldisplay.h"
@@ -17,6 +21,8 @@
 #include "opengl/glshadermanager.h"
 #include "opengl/icc_shader.h"
 
+#include <array>
+#include <cmath>
 #include <lcms2.h>
 
 using namespace KWin;
@@ -48,6 +54,22 @@ private Q_SLOTS:
     void testYCbCr();
     void testBlackPointCompensation();
     void testSCRGB();
+    void testColorConversionCache();
+    void testTransferFunctionFolding();
+    void testTonemappingLut_data();
+    void testTonemappingLut();
+    void testMergedPipeline();
+    void testColorLut3D();
+
+    void benchmarkPipelineCreate_data();
+    void benchmarkPipelineCreate();
+    void benchmarkPipelineMerged();
+    void benchmarkPipelineEvaluate_data();
+    void benchmarkPipelineEvaluate();
+    void benchmarkLutBaking_data();
+    void benchmarkLutBaking();
+    void benchmarkShader_data();
+    void benchmarkShader();
 };
 
 static bool compareVectors(const QVector3D &one, const QVector3D &two, float maxDifference)
@@ -63,6 +85,68 @@ static bool compareVectors(const QVector3D &one, const QVector3D &two, float max
 
 static const double s_resolution10bit = std::pow(1.0 / 2.0, 10);
 
+static std::shared_ptr<ColorDescription> sdrColor()
+{
+    return std::make_shared<ColorDescription>(ColorDescription{
+        Colorimetry::BT709,
+        TransferFunction(TransferFunction::gamma22),
+        TransferFunction::defaultReferenceLuminanceFor(TransferFunction::gamma22),
+        0,
+        std::nullopt,
+        std::nullopt,
+    });
+}
+
+static std::shared_ptr<ColorDescription> hdrColor(double maxLuminance)
+{
+    return std::make_shared<ColorDescription>(ColorDescription{
+        Colorimetry::BT2020,
+        TransferFunction(TransferFunction::PerceptualQuantizer),
+        203,
+        0,
+        maxLuminance,
+        maxLuminance,
+    });
+}
+
+/**
+ * A gradient over all three channels, as a stand-in for the contents of a window.
+ */
+static QImage gradient(const QSize &size)
+{
+    QImage image(size, QImage::Format_RGBA8888_Premultiplied);
+    for (int y = 0; y < size.height(); y++) {
+        for (int x = 0; x < size.width(); x++) {
+            image.setPixel(x, y, qRgba(x * 255 / size.width(), y * 255 / size.height(), (x + y) * 255 / (size.width() + size.height()), 255));
+        }
+    }
+    return image;
+}
+
+static std::vector<QVector3D> colorCube(size_t size)
+{
+    std::vector<QVector3D> ret;
+    ret.reserve(size * size * size);
+    for (size_t r = 0; r < size; r++) {
+        for (size_t g = 0; g < size; g++) {
+            for (size_t b = 0; b < size; b++) {
+                ret.emplace_back(r / float(size - 1), g / float(size - 1), b / float(size - 1));
+            }
+        }
+    }
+    return ret;
+}
+
+static std::unique_ptr<ColorTransformation> gammaTransformation(double gamma)
+{
+    cmsToneCurve *curve = cmsBuildGamma(nullptr, gamma);
+    std::array curves{curve, curve, curve};
+    std::vector<std::unique_ptr<ColorPipelineStage>> stages;
+    stages.push_back(std::make_unique<ColorPipelineStage>(cmsStageAllocToneCurves(nullptr, curves.size(), curves.data())));
+    cmsFreeToneCurve(curve);
+    return std::make_unique<ColorTransformation>(std::move(stages));
+}
+
 void TestColorspaces::roundtripConversion_data()
 {
     QTest::addColumn<Colorimetry>("srcColorimetry");
@@ -280,6 +364,17 @@ void TestColorspaces::testColorPipeline()
     QVERIFY(compareVectors(inversePipeline.evaluate(dstBlack), QVector3D(0, 0, 0), s_resolution10bit));
     QVERIFY(compareVectors(inversePipeline.evaluate(dstGray), QVector3D(0.5, 0.5, 0.5), s_resolution10bit));
     QVERIFY(compareVectors(inversePipeline.evaluate(dstWhite), QVector3D(1, 1, 1), s_resolution10bit));
+
+    // evaluating a batch of colors has to give the same results as evaluating them one by one
+    std::vector<ColorOp::Operation> operations;
+    for (const ColorOp &op : pipeline.ops) {
+        operations.push_back(op.operation);
+    }
+    std::vector<QVector3D> batch{QVector3D(0, 0, 0), QVector3D(0.5, 0.5, 0.5), QVector3D(1, 1, 1)};
+    ColorOp::applyOperations(operations, batch);
+    QVERIFY(compareVectors(batch[0], dstBlack, s_resolution10bit));
+    QVERIFY(compareVectors(batch[1], dstGray, s_resolution10bit));
+    QVERIFY(compareVectors(batch[2], dstWhite, s_resolution10bit));
 }
 
 void TestColorspaces::testXYZ()
@@ -667,6 +762,263 @@ void TestColorspaces::testSCRGB()
     }
 }
 
+void TestColorspaces::testColorConversionCache()
+{
+    const auto hdr = std::make_shared<ColorDescription>(ColorDescription{
+        Colorimetry::BT2020,
+        TransferFunction(TransferFunction::PerceptualQuantizer),
+        500,
+        0,
+        std::nullopt,
+        std::nullopt,
+    });
+    const auto first = ColorConversionCache::lookup(ColorDescription::sRGB, hdr, RenderingIntent::Perceptual);
+    QCOMPARE(first->pipeline, ColorPipeline::create(ColorDescription::sRGB, hdr, RenderingIntent::Perceptual));
+    QCOMPARE(first->toOther, ColorDescription::sRGB->toOther(*hdr, RenderingIntent::Perceptual));
+
+    // the same and equal descriptions share the entry, other intents don't
+    QCOMPARE(ColorConversionCache::lookup(ColorDescription::sRGB, hdr, RenderingIntent::Perceptual), first);
+    const auto equalHdr = std::make_shared<ColorDescription>(*hdr);
+    QCOMPARE(ColorConversionCache::lookup(ColorDescription::sRGB, equalHdr, RenderingIntent::Perceptual), first);
+    QVERIFY(ColorConversionCache::lookup(ColorDescription::sRGB, hdr, RenderingIntent::RelativeColorimetric) != first);
+}
+
+void TestColorspaces::testTransferFunctionFolding()
+{
+    // encoding and decoding with transfer functions of the same type only rescales the values
+    ColorPipeline linearPipeline(ValueRange{.min = 0, .max = 10'000}, ColorspaceType::LinearRGB);
+    linearPipeline.addInverseTransferFunction(TransferFunction(TransferFunction::PerceptualQuantizer, 0, 10'000), ColorspaceType::NonLinearRGB);
+    linearPipeline.addTransferFunction(TransferFunction(TransferFunction::PerceptualQuantizer, 0, 5'000), ColorspaceType::LinearRGB);
+    QCOMPARE(linearPipeline.ops.size(), 1);
+    QVERIFY(std::holds_alternative<ColorMultiplier>(linearPipeline.ops.front().operation));
+    QVERIFY(compareVectors(linearPipeline.evaluate(QVector3D(1000, 2000, 4000)), QVector3D(500, 1000, 2000), s_resolution10bit));
+
+    // but not if the encoding clips the values
+    ColorPipeline clippedPipeline(ValueRange{.min = 0, .max = 10'000}, ColorspaceType::LinearRGB);
+    clippedPipeline.addInverseTransferFunction(TransferFunction(TransferFunction::PerceptualQuantizer, 0, 5'000), ColorspaceType::NonLinearRGB);
+    clippedPipeline.addTransferFunction(TransferFunction(TransferFunction::PerceptualQuantizer, 0, 10'000), ColorspaceType::LinearRGB);
+    QCOMPARE(clippedPipeline.ops.size(), 2);
+
+    // decoding and encoding again with pure power functions scales the encoded values
+    ColorPipeline encodedPipeline(ValueRange{.min = 0, .max = 1}, ColorspaceType::NonLinearRGB);
+    encodedPipeline.addTransferFunction(TransferFunction(TransferFunction::gamma22, 0, 100), ColorspaceType::LinearRGB);
+    encodedPipeline.addInverseTransferFunction(TransferFunction(TransferFunction::gamma22, 0, 200), ColorspaceType::NonLinearRGB);
+    QCOMPARE(encodedPipeline.ops.size(), 1);
+    const float expected = std::pow(std::pow(0.5, 2.2) * 100 / 200, 1 / 2.2);
+    QVERIFY(compareVectors(encodedPipeline.evaluate(QVector3D(0.5, 0.5, 0.5)), QVector3D(expected, expected, expected), s_resolution10bit));
+}
+
+void TestColorspaces::testTonemappingLut_data()
+{
+    QTest::addColumn<double>("referenceLuminance");
+    QTest::addColumn<double>("maxInputLuminance");
+    QTest::addColumn<double>("maxOutputLuminance");
+
+    QTest::addRow("1000 nits on 400 nits") << 203.0 << 1000.0 << 400.0;
+    QTest::addRow("10000 nits on 600 nits") << 203.0 << 10000.0 << 600.0;
+    QTest::addRow("4000 nits on 250 nits") << 100.0 << 4000.0 << 250.0;
+}
+
+void TestColorspaces::testTonemappingLut()
+{
+    QFETCH(double, referenceLuminance);
+    QFETCH(double, maxInputLuminance);
+    QFETCH(double, maxOutputLuminance);
+
+    // this mirrors the half float LUT with linear interpolation that GLShader uses with KWIN_GL_TONEMAPPING_LUT=1
+    constexpr size_t lutSize = 1024;
+    const ColorTonemapper tonemapper(referenceLuminance, maxInputLuminance, maxOutputLuminance);
+    std::array<float, lutSize> lut;
+    for (size_t i = 0; i < lutSize; i++) {
+        lut[i] = qfloat16(tonemapper.map(i / double(lutSize - 1)));
+    }
+
+    double maxDeltaE = 0;
+    constexpr size_t sampleCount = 100'000;
+    for (size_t i = 0; i < sampleCount; i++) {
+        const double intensity = i / double(sampleCount - 1);
+        const double position = intensity * (lutSize - 1);
+        const size_t index = std::min<size_t>(position, lutSize - 2);
+        const double sampled = std::lerp(double(lut[index]), double(lut[index + 1]), position - index);
+        // only the intensity of ICtCp is changed by tone mapping, so the ITP color difference
+        // from ITU-R BT.2124 boils down to this. 1 is about one just noticeable difference
+        maxDeltaE = std::max(maxDeltaE, 720 * std::abs(sampled - tonemapper.map(intensity)));
+    }
+    QCOMPARE_LT(maxDeltaE, 1.0);
+}
+
+void TestColorspaces::testMergedPipeline()
+{
+    // merging pipelines folds their operations, which must not change the result
+    const auto sdrToHdr = ColorPipeline::create(sdrColor(), hdrColor(1000), RenderingIntent::Perceptual);
+    const auto hdrToSdr = ColorPipeline::create(hdrColor(1000), sdrColor(), RenderingIntent::Perceptual);
+    const auto merged = sdrToHdr.merged(hdrToSdr);
+    QCOMPARE_LE(merged.ops.size(), sdrToHdr.ops.size() + hdrToSdr.ops.size());
+    for (const QVector3D &color : colorCube(9)) {
+        QVERIFY(compareVectors(merged.evaluate(color), hdrToSdr.evaluate(sdrToHdr.evaluate(color)), s_resolution10bit));
+    }
+}
+
+void TestColorspaces::testColorLut3D()
+{
+    const ColorLUT3D lut(gammaTransformation(2.2), 17, 9, 5);
+    const std::vector<QVector3D> samples = lut.samples();
+    QCOMPARE(samples.size(), size_t(17 * 9 * 5));
+
+    // x is the innermost dimension
+    for (size_t z = 0; z < lut.zSize(); z++) {
+        for (size_t y = 0; y < lut.ySize(); y++) {
+            for (size_t x = 0; x < lut.xSize(); x++) {
+                const QVector3D expected(std::pow(x / 16.0, 2.2), std::pow(y / 8.0, 2.2), std::pow(z / 4.0, 2.2));
+                QVERIFY(compareVectors(samples[x + y * lut.xSize() + z * lut.xSize() * lut.ySize()], expected, s_resolution10bit));
+            }
+        }
+    }
+
+    // sampling in batches has to give the same results as sampling color by color
+    std::vector<QVector3D> batch = colorCube(5);
+    const std::vector<QVector3D> input = batch;
+    lut.sample(batch);
+    const auto transformation = gammaTransformation(2.2);
+    for (size_t i = 0; i < batch.size(); i++) {
+        QVERIFY(compareVectors(batch[i], transformation->transform(input[i]), s_resolution10bit));
+    }
+}
+
+void TestColorspaces::benchmarkPipelineCreate_data()
+{
+    QTest::addColumn<std::shared_ptr<ColorDescription>>("srcColor");
+    QTest::addColumn<std::shared_ptr<ColorDescription>>("dstColor");
+    QTest::addColumn<RenderingIntent>("intent");
+
+    QTest::addRow("sRGB on sRGB") << sdrColor() << sdrColor() << RenderingIntent::Perceptual;
+    QTest::addRow("sRGB on HDR") << sdrColor() << hdrColor(1000) << RenderingIntent::Perceptual;
+    QTest::addRow("HDR on sRGB, tone mapped") << hdrColor(1000) << sdrColor() << RenderingIntent::Perceptual;
+    QTest::addRow("HDR on HDR, relative colorimetric") << hdrColor(4000) << hdrColor(600) << RenderingIntent::RelativeColorimetric;
+}
+
+void TestColorspaces::benchmarkPipelineCreate()
+{
+    QFETCH(std::shared_ptr<ColorDescription>, srcColor);
+    QFETCH(std::shared_ptr<ColorDescription>, dstColor);
+    QFETCH(RenderingIntent, intent);
+
+    QBENCHMARK {
+        const auto pipeline = ColorPipeline::create(srcColor, dstColor, intent);
+        Q_UNUSED(pipeline)
+    }
+}
+
+void TestColorspaces::benchmarkPipelineMerged()
+{
+    // what the compositor does with the pipelines of a window and of the output it's shown on
+    const auto window = ColorPipeline::create(hdrColor(1000), sdrColor(), RenderingIntent::Perceptual);
+    const auto output = ColorPipeline::create(sdrColor(), hdrColor(600), RenderingIntent::RelativeColorimetric);
+    QBENCHMARK {
+        const auto merged = window.merged(output);
+        Q_UNUSED(merged)
+    }
+}
+
+void TestColorspaces::benchmarkPipelineEvaluate_data()
+{
+    QTest::addColumn<std::shared_ptr<ColorDescription>>("srcColor");
+    QTest::addColumn<std::shared_ptr<ColorDescription>>("dstColor");
+
+    QTest::addRow("sRGB on HDR") << sdrColor() << hdrColor(1000);
+    QTest::addRow("HDR on sRGB, tone mapped") << hdrColor(1000) << sdrColor();
+}
+
+void TestColorspaces::benchmarkPipelineEvaluate()
+{
+    QFETCH(std::shared_ptr<ColorDescription>, srcColor);
+    QFETCH(std::shared_ptr<ColorDescription>, dstColor);
+
+    const auto pipeline = ColorPipeline::create(srcColor, dstColor, RenderingIntent::Perceptual);
+    std::vector<ColorOp::Operation> operations;
+    for (const ColorOp &op : pipeline.ops) {
+        operations.push_back(op.operation);
+    }
+    // 64³ colors, about an eighth of a 1080p frame
+    const std::vector<QVector3D> input = colorCube(64);
+    std::vector<QVector3D> colors;
+    QBENCHMARK {
+        colors = input;
+        ColorOp::applyOperations(operations, colors);
+    }
+}
+
+void TestColorspaces::benchmarkLutBaking_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::addRow("17³") << 17;
+    QTest::addRow("33³") << 33;
+    QTest::addRow("65³") << 65;
+}
+
+void TestColorspaces::benchmarkLutBaking()
+{
+    QFETCH(int, size);
+
+    const ColorLUT3D lut(gammaTransformation(2.2), size, size, size);
+    QBENCHMARK {
+        const auto samples = lut.samples();
+        Q_UNUSED(samples)
+    }
+}
+
+void TestColorspaces::benchmarkShader_data()
+{
+    QTest::addColumn<std::shared_ptr<ColorDescription>>("srcColor");
+    QTest::addColumn<std::shared_ptr<ColorDescription>>("dstColor");
+    QTest::addColumn<QString>("iccProfilePath");
+
+    QTest::addRow("sRGB on sRGB") << sdrColor() << sdrColor() << QString();
+    QTest::addRow("sRGB on HDR") << sdrColor() << hdrColor(1000) << QString();
+    QTest::addRow("HDR on sRGB, tone mapped") << hdrColor(1000) << sdrColor() << QString();
+    QTest::addRow("sRGB on ICC profile") << sdrColor() << sdrColor() << QFINDTESTDATA("data/Framework 13.icc");
+}
+
+void TestColorspaces::benchmarkShader()
+{
+    QFETCH(std::shared_ptr<ColorDescription>, srcColor);
+    QFETCH(std::shared_ptr<ColorDescription>, dstColor);
+    QFETCH(QString, iccProfilePath);
+
+    const auto display = EglDisplay::create(eglGetDisplay(EGL_DEFAULT_DISPLAY));
+    const auto context = EglContext::create(display.get(), EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT);
+
+    const QSize size(1920, 1080);
+    const auto source = GLTexture::upload(gradient(size));
+    const auto target = GLTexture::allocate(GL_RGBA8, size);
+    GLFramebuffer buffer(target.get());
+    QMatrix4x4 proj;
+    proj.ortho(QRectF(QPointF(0, 0), size));
+
+    std::unique_ptr<IccShader> iccShader;
+    std::optional<ShaderBinder> binder;
+    if (iccProfilePath.isEmpty()) {
+        binder.emplace(ShaderTrait::MapTexture | ShaderTrait::TransformColorspace);
+        binder->shader()->setColorspaceUniforms(srcColor, dstColor, RenderingIntent::Perceptual);
+    } else {
+        const std::shared_ptr<IccProfile> profile = IccProfile::load(iccProfilePath).value_or(nullptr);
+        QVERIFY(profile);
+        iccShader = std::make_unique<IccShader>();
+        binder.emplace(iccShader->shader());
+        iccShader->setUniforms(profile, srcColor, RenderingIntent::RelativeColorimetric);
+    }
+    binder->shader()->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, proj);
+
+    context->pushFramebuffer(&buffer);
+    QBENCHMARK {
+        source->render(size);
+        // the frame has to be done to be measured
+        glFinish();
+    }
+    context->popFramebuffer();
+}
+
 QTEST_MAIN(TestColorspaces)
 
 #include "test_colorspaces.moc"
@@ -0,0 +1,137 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "utils/damagejournal.h"
+
+using namespace KWin;
+
+class TestDamageJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestDamageJournal() = default;
+
+private Q_SLOTS:
+    void accumulate();
+    void ringBuffer();
+    void setCapacity();
+    void clear();
+    void maximumRectCount();
+    void minimumFillRatio();
+};
+
+static const QRegion s_fallback = QRegion(0, 0, 1000, 1000);
+
+void TestDamageJournal::accumulate()
+{
+    DamageJournal journal;
+    journal.setMinimumFillRatio(0);
+
+    journal.add(QRegion(0, 0, 10, 10));
+    journal.add(QRegion(100, 0, 10, 10));
+    journal.add(QRegion(200, 0, 10, 10));
+
+    QCOMPARE(journal.accumulate(0, s_fallback), s_fallback);
+    QCOMPARE(journal.accumulate(1, s_fallback), QRegion());
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(200, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(200, 0, 10, 10) | QRegion(100, 0, 10, 10));
+    QCOMPARE(journal.accumulate(4, s_fallback), s_fallback);
+    QCOMPARE(journal.lastDamage(), QRegion(200, 0, 10, 10));
+
+    // The cached results must be invalidated when new damage is added.
+    journal.add(QRegion(300, 0, 10, 10));
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(300, 0, 10, 10));
+    QCOMPARE(journal.accumulate(4, s_fallback), QRegion(300, 0, 10, 10) | QRegion(200, 0, 10, 10) | QRegion(100, 0, 10, 10));
+}
+
+void TestDamageJournal::ringBuffer()
+{
+    DamageJournal journal;
+    journal.setCapacity(3);
+    journal.setMinimumFillRatio(0);
+
+    for (int i = 0; i < 10; ++i) {
+        journal.add(QRegion(i * 100, 0, 10, 10));
+    }
+
+    QCOMPARE(journal.lastDamage(), QRegion(900, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(900, 0, 10, 10) | QRegion(800, 0, 10, 10));
+    QCOMPARE(journal.accumulate(4, s_fallback), s_fallback);
+}
+
+void TestDamageJournal::setCapacity()
+{
+    DamageJournal journal;
+    journal.setMinimumFillRatio(0);
+
+    for (int i = 0; i < 5; ++i) {
+        journal.add(QRegion(i * 100, 0, 10, 10));
+    }
+
+    journal.setCapacity(2);
+    QCOMPARE(journal.capacity(), 2);
+    QCOMPARE(journal.lastDamage(), QRegion(400, 0, 10, 10));
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(400, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, s_fallback), s_fallback);
+
+    journal.setCapacity(4);
+    journal.add(QRegion(500, 0, 10, 10));
+    QCOMPARE(journal.accumulate(4, s_fallback), QRegion(500, 0, 10, 10) | QRegion(400, 0, 10, 10) | QRegion(300, 0, 10, 10));
+    QCOMPARE(journal.accumulate(5, s_fallback), s_fallback);
+}
+
+void TestDamageJournal::clear()
+{
+    DamageJournal journal;
+    journal.add(QRegion(0, 0, 10, 10));
+    journal.add(QRegion(0, 0, 10, 10));
+    journal.clear();
+
+    QCOMPARE(journal.accumulate(1, s_fallback), s_fallback);
+
+    journal.add(QRegion(0, 0, 10, 10));
+    QCOMPARE(journal.accumulate(1, s_fallback), QRegion());
+}
+
+void TestDamageJournal::maximumRectCount()
+{
+    DamageJournal journal;
+    journal.setMaximumRectCount(4);
+    journal.setMinimumFillRatio(0);
+
+    for (int i = 0; i < 4; ++i) {
+        journal.add(QRegion(i * 20, i * 20, 10, 10));
+    }
+    QCOMPARE(journal.accumulate(5, s_fallback).rectCount(), 4);
+
+    journal.add(QRegion(80, 80, 10, 10));
+    QCOMPARE(journal.accumulate(5, s_fallback).rectCount(), 4);
+    QCOMPARE(journal.accumulate(6, s_fallback), QRegion(0, 0, 90, 90));
+}
+
+void TestDamageJournal::minimumFillRatio()
+{
+    DamageJournal journal;
+    journal.setMaximumRectCount(0);
+    journal.setMinimumFillRatio(0.9);
+
+    // Two 10x10 squares with a gap; they cover half of the bounding rect.
+    journal.add(QRegion(0, 0, 10, 10));
+    journal.add(QRegion(20, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(0, 0, 10, 10) | QRegion(20, 0, 10, 10));
+
+    // Almost the whole bounding rect is covered, so it's used instead.
+    journal.add(QRegion(0, 0, 100, 99));
+    journal.add(QRegion(0, 99, 50, 1));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(0, 0, 100, 100));
+}
+
+QTEST_GUILESS_MAIN(TestDamageJournal)
+
+#include "test_damagejournal.moc"
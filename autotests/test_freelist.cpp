@@ -0,0 +1,60 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "utils/freelist.h"
+
+using namespace KWin;
+
+class TestFreeList : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFreeList() = default;
+
+private Q_SLOTS:
+    void reuse();
+    void capacity();
+};
+
+struct Object
+{
+    int value[4];
+};
+
+void TestFreeList::reuse()
+{
+    FreeList<Object, 2> freeList;
+
+    void *first = freeList.allocate();
+    void *second = freeList.allocate();
+    QVERIFY(first != second);
+
+    freeList.release(first);
+    QCOMPARE(freeList.size(), size_t(1));
+    QCOMPARE(freeList.allocate(), first);
+    QCOMPARE(freeList.size(), size_t(0));
+
+    freeList.release(first);
+    freeList.release(second);
+}
+
+void TestFreeList::capacity()
+{
+    FreeList<Object, 2> freeList;
+
+    void *slots[] = {freeList.allocate(), freeList.allocate(), freeList.allocate()};
+    for (void *slot : slots) {
+        freeList.release(slot);
+    }
+    QCOMPARE(freeList.size(), size_t(2));
+}
+
+QTEST_GUILESS_MAIN(TestFreeList)
+
+#include "test_freelist.moc"
@@ -12,6 +12,7 @@
 #include <QTest>
 #include <QtWidgets/qaction.h>
 #include <iostream>
+#include <vector>
 
 using namespace KWin;
 
@@ -33,6 +34,8 @@ private Q_SLOTS:
     void testMinimumDeltaReached_data();
     void testMinimumDeltaReached();
     void testNotEmitCallbacksBeforeDirectionDecided();
+    void testOnlyMatchingFingerCountStarts();
+    void benchmarkSwipeUpdate();
 };
 
 void GestureTest::testMinimumDeltaReached_data()
@@ -305,5 +308,62 @@ void GestureTest::testNotEmitCallbacksBeforeDirectionDecided()
     QCOMPARE(contractSpy.count(), 1);
 }
 
+void GestureTest::testOnlyMatchingFingerCountStarts()
+{
+    GestureRecognizer recognizer;
+    SwipeGesture three(3);
+    SwipeGesture four(4);
+    three.setDirection(SwipeDirection::Left);
+    four.setDirection(SwipeDirection::Left);
+    recognizer.registerSwipeGesture(&three);
+    recognizer.registerSwipeGesture(&four);
+    QSignalSpy threeStartedSpy(&three, &SwipeGesture::started);
+    QSignalSpy fourStartedSpy(&four, &SwipeGesture::started);
+    QSignalSpy fourProgressSpy(&four, &SwipeGesture::progress);
+
+    QCOMPARE(recognizer.startSwipeGesture(4), 1);
+    QCOMPARE(threeStartedSpy.count(), 0);
+    QCOMPARE(fourStartedSpy.count(), 1);
+
+    // further updates in the same direction only report the progress
+    for (int i = 0; i < 10; ++i) {
+        recognizer.updateSwipeGesture(QPointF(-10, 0));
+    }
+    QCOMPARE(fourStartedSpy.count(), 1);
+    QCOMPARE(fourProgressSpy.count(), 10);
+    recognizer.endSwipeGesture();
+
+    // unregistered gestures are not started anymore
+    recognizer.unregisterSwipeGesture(&four);
+    QCOMPARE(recognizer.startSwipeGesture(4), 0);
+    recognizer.cancelSwipeGesture();
+}
+
+void GestureTest::benchmarkSwipeUpdate()
+{
+    // plenty of gestures, like when scripts and effects register their own, of which only a
+    // few match the fingers on the touchpad
+    GestureRecognizer recognizer;
+    std::vector<std::unique_ptr<SwipeGesture>> gestures;
+    for (uint fingerCount = 1; fingerCount <= 5; ++fingerCount) {
+        for (int i = 0; i < 50; ++i) {
+            for (SwipeDirection direction : {SwipeDirection::Up, SwipeDirection::Down, SwipeDirection::Left, SwipeDirection::Right}) {
+                auto gesture = std::make_unique<SwipeGesture>(fingerCount);
+                gesture->setDirection(direction);
+                recognizer.registerSwipeGesture(gesture.get());
+                gestures.push_back(std::move(gesture));
+            }
+        }
+    }
+
+    QBENCHMARK {
+        recognizer.startSwipeGesture(3);
+        for (int i = 0; i < 120; ++i) {
+            recognizer.updateSwipeGesture(QPointF(2, 0.5));
+        }
+        recognizer.endSwipeGesture();
+    }
+}
+
 QTEST_MAIN(GestureTest)
 #include "test_gestures.moc"
@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <algorithm>
+
+#include "core/gpumemory.h"
+
+using namespace KWin;
+
+class TestGpuMemory : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void attributeToScope();
+    void moveAllocation();
+    void trim();
+};
+
+static uint64_t byteSize(const GpuMemoryOwner &owner, GpuMemoryCategory category)
+{
+    const auto usage = GpuMemoryAccounting::self()->usage();
+    const auto it = std::ranges::find_if(usage, [&owner](const GpuMemoryAccounting::Usage &entry) {
+        return entry.owner == owner;
+    });
+    return it != usage.end() ? it->byteSize[size_t(category)] : 0;
+}
+
+void TestGpuMemory::attributeToScope()
+{
+    const GpuMemoryOwner compositor;
+    const GpuMemoryOwner output{
+        .kind = GpuMemoryOwner::Kind::Output,
+        .name = QStringLiteral("DP-1"),
+    };
+    const GpuMemoryOwner effect{
+        .kind = GpuMemoryOwner::Kind::Effect,
+        .name = QStringLiteral("blur"),
+    };
+
+    GpuMemoryAllocation unscoped(GpuMemoryCategory::Texture, 100);
+    QCOMPARE(byteSize(compositor, GpuMemoryCategory::Texture), uint64_t(100));
+    {
+        GpuMemoryOwnerScope outputScope(&output);
+        GpuMemoryAllocation swapchain(GpuMemoryCategory::Swapchain, 1000);
+        {
+            GpuMemoryOwnerScope effectScope(&effect);
+            GpuMemoryAllocation texture(GpuMemoryCategory::Texture, 10);
+            QCOMPARE(byteSize(effect, GpuMemoryCategory::Texture), uint64_t(10));
+        }
+        QCOMPARE(byteSize(output, GpuMemoryCategory::Swapchain), uint64_t(1000));
+        QCOMPARE(byteSize(output, GpuMemoryCategory::Texture), uint64_t(0));
+        QCOMPARE(byteSize(effect, GpuMemoryCategory::Texture), uint64_t(0));
+    }
+    QCOMPARE(GpuMemoryAccounting::self()->totalByteSize(), uint64_t(100));
+}
+
+void TestGpuMemory::moveAllocation()
+{
+    GpuMemoryAllocation first(GpuMemoryCategory::Renderbuffer, 64);
+    GpuMemoryAllocation second = std::move(first);
+    QCOMPARE(GpuMemoryAccounting::self()->totalByteSize(), uint64_t(64));
+    second = GpuMemoryAllocation(GpuMemoryCategory::Renderbuffer, 32);
+    QCOMPARE(GpuMemoryAccounting::self()->totalByteSize(), uint64_t(32));
+    second = GpuMemoryAllocation();
+    QCOMPARE(GpuMemoryAccounting::self()->totalByteSize(), uint64_t(0));
+    QVERIFY(GpuMemoryAccounting::self()->usage().empty());
+}
+
+void TestGpuMemory::trim()
+{
+    QSignalSpy trimSpy(GpuMemoryAccounting::self(), &GpuMemoryAccounting::trimRequested);
+    GpuMemoryAccounting::self()->trim();
+    QCOMPARE(trimSpy.count(), 1);
+}
+
+QTEST_GUILESS_MAIN(TestGpuMemory)
+#include "test_gpumemory.moc"
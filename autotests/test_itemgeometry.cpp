@@ -0,0 +1,158 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "scene/itemgeometry.h"
+
+using namespace KWin;
+
+static qreal area(const RenderGeometry &geometry)
+{
+    qreal area = 0;
+    for (qsizetype i = 0; i < geometry.size(); i += 6) {
+        const QVector2D size = geometry[i + 5].position - geometry[i].position;
+        area += size.x() * size.y();
+    }
+    return area;
+}
+
+static RenderGeometry quadGeometry(const QRectF &rect, const QRectF &texture)
+{
+    WindowQuad quad;
+    quad[0] = WindowVertex(rect.topLeft(), texture.topLeft());
+    quad[1] = WindowVertex(rect.topRight(), texture.topRight());
+    quad[2] = WindowVertex(rect.bottomRight(), texture.bottomRight());
+    quad[3] = WindowVertex(rect.bottomLeft(), texture.bottomLeft());
+
+    RenderGeometry geometry;
+    geometry.appendWindowQuad(quad, 1.0);
+    return geometry;
+}
+
+class TestItemGeometry : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void splitRoundedRect();
+    void splitRoundedRectOutsideBox();
+    void splitRoundedRectTextureCoordinates();
+    void splitRoundedRectRejectsUnalignedQuads();
+    void appendWindowQuads();
+};
+
+void TestItemGeometry::splitRoundedRect()
+{
+    const QRectF box(0, 0, 100, 80);
+    const RenderGeometry geometry = quadGeometry(box, box);
+
+    RenderGeometry interior;
+    RenderGeometry corners;
+    QVERIFY(geometry.splitRoundedRect(box, QVector4D(10, 10, 20, 0), &interior, &corners));
+    QCOMPARE(area(corners), 10.0 * 10 + 10 * 10 + 20 * 20);
+    QCOMPARE(area(interior) + area(corners), box.width() * box.height());
+
+    // a quad away from the corners is left untouched
+    const RenderGeometry middle = quadGeometry(QRectF(20, 20, 40, 40), QRectF(0, 0, 1, 1));
+    interior.clear();
+    corners.clear();
+    QVERIFY(middle.splitRoundedRect(box, QVector4D(10, 10, 10, 10), &interior, &corners));
+    QVERIFY(corners.isEmpty());
+    QCOMPARE(interior.size(), middle.size());
+    QCOMPARE(area(interior), 40.0 * 40);
+}
+
+void TestItemGeometry::splitRoundedRectOutsideBox()
+{
+    // the parts outside of the box must be clipped as well
+    const RenderGeometry geometry = quadGeometry(QRectF(-10, 0, 120, 50), QRectF(0, 0, 1, 1));
+
+    RenderGeometry interior;
+    RenderGeometry corners;
+    QVERIFY(geometry.splitRoundedRect(QRectF(0, 0, 100, 100), QVector4D(10, 10, 10, 10), &interior, &corners));
+    QCOMPARE(area(interior), 100.0 * 50 - 2 * 10 * 10);
+    QCOMPARE(area(corners), 2.0 * 10 * 50 + 2 * 10 * 10);
+}
+
+void TestItemGeometry::splitRoundedRectTextureCoordinates()
+{
+    const RenderGeometry geometry = quadGeometry(QRectF(0, 0, 100, 100), QRectF(0, 0, 1, 1));
+
+    RenderGeometry interior;
+    RenderGeometry corners;
+    QVERIFY(geometry.splitRoundedRect(QRectF(0, 0, 100, 100), QVector4D(10, 10, 10, 10), &interior, &corners));
+    for (const RenderGeometry *part : {&interior, &corners}) {
+        for (const GLVertex2D &vertex : *part) {
+            QCOMPARE(vertex.texcoord.x(), vertex.position.x() / 100);
+            QCOMPARE(vertex.texcoord.y(), vertex.position.y() / 100);
+        }
+    }
+}
+
+void TestItemGeometry::splitRoundedRectRejectsUnalignedQuads()
+{
+    RenderGeometry geometry;
+    geometry.append(GLVertex2D{.position = QVector2D(0, 0)});
+    geometry.append(GLVertex2D{.position = QVector2D(10, 100)});
+    geometry.append(GLVertex2D{.position = QVector2D(100, 0)});
+    geometry.append(GLVertex2D{.position = QVector2D(100, 0)});
+    geometry.append(GLVertex2D{.position = QVector2D(10, 100)});
+    geometry.append(GLVertex2D{.position = QVector2D(100, 100)});
+
+    RenderGeometry interior;
+    RenderGeometry corners;
+    QVERIFY(!geometry.splitRoundedRect(QRectF(0, 0, 100, 100), QVector4D(10, 10, 10, 10), &interior, &corners));
+    QVERIFY(interior.isEmpty());
+    QVERIFY(corners.isEmpty());
+}
+
+void TestItemGeometry::appendWindowQuads()
+{
+    WindowQuadList quads;
+    for (int i = 0; i < 2; ++i) {
+        const QRectF rect(i * 10.3, 0, 10.3, 20.5);
+        WindowQuad quad;
+        quad[0] = WindowVertex(rect.topLeft(), QPointF(i, 0));
+        quad[1] = WindowVertex(rect.topRight(), QPointF(i + 1, 0));
+        quad[2] = WindowVertex(rect.bottomRight(), QPointF(i + 1, 1));
+        quad[3] = WindowVertex(rect.bottomLeft(), QPointF(i, 1));
+        quads.append(quad);
+    }
+
+    RenderGeometry geometry;
+    geometry.appendWindowQuads(quads, 2.0);
+    QCOMPARE(geometry.size(), 12);
+
+    // top-left, bottom-left, top-right, top-right, bottom-left, bottom-right, snapped to device pixels
+    const QList<QVector2D> positions{
+        QVector2D(0, 0),
+        QVector2D(0, 41),
+        QVector2D(21, 0),
+        QVector2D(21, 0),
+        QVector2D(0, 41),
+        QVector2D(21, 41),
+        QVector2D(21, 0),
+        QVector2D(21, 41),
+        QVector2D(41, 0),
+        QVector2D(41, 0),
+        QVector2D(21, 41),
+        QVector2D(41, 41),
+    };
+    for (qsizetype i = 0; i < positions.size(); ++i) {
+        QCOMPARE(geometry[i].position, positions[i]);
+    }
+    QCOMPARE(geometry[5].texcoord, QVector2D(1, 1));
+    QCOMPARE(geometry[6].texcoord, QVector2D(1, 0));
+
+    RenderGeometry unsnapped;
+    unsnapped.setVertexSnappingMode(RenderGeometry::VertexSnappingMode::None);
+    unsnapped.appendWindowQuads(quads, 2.0);
+    QCOMPARE(unsnapped[5].position, QVector2D(20.6, 41));
+}
+
+QTEST_GUILESS_MAIN(TestItemGeometry)
+#include "test_itemgeometry.moc"
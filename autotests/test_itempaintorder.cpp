@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "scene/item.h"
+
+using namespace KWin;
+
+using Kind = Item::PaintStep::Kind;
+
+static QList<std::pair<Item *, Kind>> steps(const Item &item)
+{
+    QList<std::pair<Item *, Kind>> ret;
+    const auto paintOrder = item.paintOrder();
+    for (const Item::PaintStep &step : paintOrder) {
+        ret.append({step.item, step.kind});
+    }
+    return ret;
+}
+
+class TestItemPaintOrder : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void paintOrder();
+    void invalidation();
+};
+
+void TestItemPaintOrder::paintOrder()
+{
+    Item root;
+    Item above(&root);
+    above.setZ(1);
+    Item below(&root);
+    below.setZ(-1);
+    Item child(&below);
+    Item hidden(&root);
+    hidden.setVisible(false);
+
+    const QList<std::pair<Item *, Kind>> expected{
+        {&root, Kind::Enter},
+        {&below, Kind::Enter},
+        {&below, Kind::Paint},
+        {&child, Kind::Enter},
+        {&child, Kind::Paint},
+        {&child, Kind::Leave},
+        {&below, Kind::Leave},
+        {&root, Kind::Paint},
+        {&above, Kind::Enter},
+        {&above, Kind::Paint},
+        {&above, Kind::Leave},
+        {&root, Kind::Leave},
+    };
+    QCOMPARE(steps(root), expected);
+
+    // entering an item tells where its subtree ends
+    const auto paintOrder = root.paintOrder();
+    for (qsizetype i = 0; i < paintOrder.size(); ++i) {
+        if (paintOrder[i].kind == Kind::Enter) {
+            QCOMPARE(paintOrder[paintOrder[i].leave].item, paintOrder[i].item);
+            QCOMPARE(paintOrder[paintOrder[i].leave].kind, Kind::Leave);
+        }
+    }
+}
+
+void TestItemPaintOrder::invalidation()
+{
+    Item root;
+    Item parent(&root);
+    QCOMPARE(root.paintOrder().size(), 6);
+
+    // changes deep in the tree reach the steps of every ancestor
+    auto child = std::make_unique<Item>(&parent);
+    QCOMPARE(root.paintOrder().size(), 9);
+    child->setVisible(false);
+    QCOMPARE(root.paintOrder().size(), 6);
+    child->setVisible(true);
+    QCOMPARE(parent.paintOrder().size(), 6);
+    QCOMPARE(root.paintOrder().size(), 9);
+
+    Item sibling(&parent);
+    child->setZ(1);
+    QCOMPARE(parent.paintOrder()[5].item, child.get());
+    child->setZ(-1);
+    QCOMPARE(parent.paintOrder()[1].item, child.get());
+
+    child.reset();
+    QCOMPARE(root.paintOrder().size(), 9);
+}
+
+QTEST_MAIN(TestItemPaintOrder)
+#include "test_itempaintorder.moc"
@@ -0,0 +1,98 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "utils/motionresampler.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestMotionResampler : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void empty();
+    void interpolate();
+    void extrapolate();
+    void limitPrediction();
+    void olderThanSamples();
+    void timestampsGoBackwards();
+};
+
+void TestMotionResampler::empty()
+{
+    MotionResampler resampler;
+    QVERIFY(resampler.isEmpty());
+    QCOMPARE(resampler.positionAt(10ms, 8ms), QPointF());
+
+    resampler.addSample(QPointF(10, 20), 10ms);
+    QVERIFY(!resampler.isEmpty());
+    QCOMPARE(resampler.positionAt(20ms, 8ms), QPointF(10, 20));
+
+    resampler.reset();
+    QVERIFY(resampler.isEmpty());
+}
+
+void TestMotionResampler::interpolate()
+{
+    MotionResampler resampler;
+    resampler.addSample(QPointF(0, 0), 0ms);
+    resampler.addSample(QPointF(10, 0), 10ms);
+    resampler.addSample(QPointF(10, 20), 20ms);
+
+    QCOMPARE(resampler.positionAt(5ms, 8ms), QPointF(5, 0));
+    QCOMPARE(resampler.positionAt(10ms, 8ms), QPointF(10, 0));
+    QCOMPARE(resampler.positionAt(15ms, 8ms), QPointF(10, 10));
+    QCOMPARE(resampler.positionAt(20ms, 8ms), QPointF(10, 20));
+}
+
+void TestMotionResampler::extrapolate()
+{
+    MotionResampler resampler;
+    resampler.addSample(QPointF(0, 0), 0ms);
+    resampler.addSample(QPointF(10, 20), 10ms);
+
+    QCOMPARE(resampler.positionAt(12ms, 8ms), QPointF(12, 24));
+    QCOMPARE(resampler.lastPosition(), QPointF(10, 20));
+    QCOMPARE(resampler.lastTime(), 10ms);
+}
+
+void TestMotionResampler::limitPrediction()
+{
+    MotionResampler resampler;
+    resampler.addSample(QPointF(0, 0), 0ms);
+    resampler.addSample(QPointF(10, 0), 10ms);
+
+    // not further than the maximum prediction
+    QCOMPARE(resampler.positionAt(30ms, 2ms), QPointF(12, 0));
+    // and not further than half of the time between the last samples
+    QCOMPARE(resampler.positionAt(30ms, 20ms), QPointF(15, 0));
+}
+
+void TestMotionResampler::olderThanSamples()
+{
+    MotionResampler resampler;
+    for (int i = 1; i <= 6; ++i) {
+        resampler.addSample(QPointF(i, 0), std::chrono::milliseconds(i));
+    }
+    // only the last few samples are kept
+    QCOMPARE(resampler.positionAt(0ms, 8ms), QPointF(3, 0));
+}
+
+void TestMotionResampler::timestampsGoBackwards()
+{
+    MotionResampler resampler;
+    resampler.addSample(QPointF(0, 0), 100ms);
+    resampler.addSample(QPointF(10, 0), 110ms);
+    resampler.addSample(QPointF(50, 50), 5ms);
+
+    QCOMPARE(resampler.positionAt(10ms, 8ms), QPointF(50, 50));
+}
+
+QTEST_GUILESS_MAIN(TestMotionResampler)
+#include "test_motionresampler.moc"
@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "wayland/surface.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestPresentationStatistics : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void countModes();
+    void latencyWindow();
+};
+
+void TestPresentationStatistics::countModes()
+{
+    PresentationStatistics statistics;
+    QCOMPARE(statistics.latency(50), 0ns);
+    QCOMPARE(statistics.lastLatency(), 0ns);
+
+    statistics.addPresented(1ms, PresentationMode::VSync, true);
+    statistics.addPresented(1ms, PresentationMode::AdaptiveSync, true);
+    statistics.addPresented(1ms, PresentationMode::Async, false);
+    statistics.addPresented(1ms, PresentationMode::AdaptiveAsync, true);
+    statistics.addPresented(1ms, PresentationMode::VSync, false);
+    statistics.addDiscarded();
+
+    QCOMPARE(statistics.presented, quint64(5));
+    QCOMPARE(statistics.discarded, quint64(1));
+    QCOMPARE(statistics.vsync, quint64(3));
+    QCOMPARE(statistics.async, quint64(2));
+    QCOMPARE(statistics.zeroCopy, quint64(3));
+    QCOMPARE(statistics.composited, quint64(2));
+    QCOMPARE(statistics.zeroCopyExits, quint64(2));
+}
+
+void TestPresentationStatistics::latencyWindow()
+{
+    PresentationStatistics statistics;
+    for (int i = 1; i <= 100; ++i) {
+        statistics.addPresented(std::chrono::milliseconds(i), PresentationMode::VSync, false);
+    }
+    QCOMPARE(statistics.latency(0), std::chrono::nanoseconds(1ms));
+    QCOMPARE(statistics.latency(50), std::chrono::nanoseconds(51ms));
+    QCOMPARE(statistics.latency(100), std::chrono::nanoseconds(100ms));
+    QCOMPARE(statistics.lastLatency(), std::chrono::nanoseconds(100ms));
+
+    // only the most recent latencies are kept
+    for (size_t i = 0; i < PresentationStatistics::s_latencyCount; ++i) {
+        statistics.addPresented(2ms, PresentationMode::VSync, false);
+    }
+    QCOMPARE(statistics.latency(0), std::chrono::nanoseconds(2ms));
+    QCOMPARE(statistics.latency(100), std::chrono::nanoseconds(2ms));
+    QCOMPARE(statistics.presented, quint64(100 + PresentationStatistics::s_latencyCount));
+}
+
+QTEST_GUILESS_MAIN(TestPresentationStatistics)
+
+#include "test_presentationstatistics.moc"
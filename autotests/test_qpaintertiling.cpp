@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/rendertarget.h"
+#include "core/renderviewport.h"
+#include "effect/effect.h"
+#include "scene/imageitem.h"
+#include "scene/itemrenderer_qpainter.h"
+
+using namespace KWin;
+
+static QImage gradient(const QSize &size, int alpha)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            image.setPixel(x, y, qPremultiply(qRgba(x % 256, y % 256, (x + y) % 256, alpha)));
+        }
+    }
+    return image;
+}
+
+static QImage render(bool tiled, Item *item, const QRegion &region)
+{
+    qputenv("KWIN_QPAINTER_TILED", tiled ? QByteArrayLiteral("1") : QByteArrayLiteral("0"));
+    ItemRendererQPainter renderer;
+
+    QImage image(QSize(700, 500), QImage::Format_RGB32);
+    image.fill(Qt::black);
+    RenderTarget renderTarget(&image);
+    RenderViewport viewport(QRectF(0, 0, 700, 500), 1, renderTarget);
+
+    renderer.beginFrame(renderTarget, viewport);
+    renderer.renderBackground(renderTarget, viewport, QRect(0, 0, 300, 200));
+    renderer.renderItem(renderTarget, viewport, item, 0, region, WindowPaintData{}, {}, {});
+    renderer.endFrame();
+
+    qunsetenv("KWIN_QPAINTER_TILED");
+    return image;
+}
+
+class TestQPainterTiling : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void compareWithUntiled();
+};
+
+void TestQPainterTiling::compareWithUntiled()
+{
+    Item root;
+    root.setSize(QSizeF(700, 500));
+
+    ImageItem background(&root);
+    background.setSize(QSizeF(600, 450));
+    background.setImage(gradient(QSize(600, 450), 255));
+
+    ImageItem translucent(&root);
+    translucent.setPosition(QPointF(37, 81));
+    translucent.setSize(QSizeF(340, 270));
+    translucent.setImage(gradient(QSize(340, 270), 128));
+
+    ImageItem faded(&translucent);
+    faded.setPosition(QPointF(250, 100));
+    faded.setSize(QSizeF(300, 300));
+    faded.setOpacity(0.4);
+    faded.setImage(gradient(QSize(300, 300), 200));
+
+    // drawn by QPainter rather than blitted
+    ImageItem scaled(&root);
+    scaled.setPosition(QPointF(400, 20));
+    scaled.setSize(QSizeF(250, 180));
+    scaled.setImage(gradient(QSize(100, 90), 255));
+
+    const QRegion region = QRegion(0, 0, 700, 500) - QRegion(300, 200, 120, 90);
+    QCOMPARE(render(true, &root, region), render(false, &root, region));
+}
+
+QTEST_MAIN(TestQPainterTiling)
+#include "test_qpaintertiling.moc"
@@ -0,0 +1,276 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/region.h"
+
+using namespace KWin;
+
+class TestRegion : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRegion() = default;
+
+private Q_SLOTS:
+    void empty();
+    void fromQRegion_data();
+    void fromQRegion();
+    void united_data();
+    void united();
+    void intersected_data();
+    void intersected();
+    void subtracted_data();
+    void subtracted();
+    void xored_data();
+    void xored();
+    void containsPoint_data();
+    void containsPoint();
+    void containsRect_data();
+    void containsRect();
+    void intersectsRect_data();
+    void intersectsRect();
+    void translated();
+    void coalesce();
+    void accumulate();
+};
+
+static QRegion makeRegion(std::initializer_list<QRect> rects)
+{
+    QRegion region;
+    for (const QRect &rect : rects) {
+        region += rect;
+    }
+    return region;
+}
+
+static void addOperands()
+{
+    QTest::addColumn<QRegion>("a");
+    QTest::addColumn<QRegion>("b");
+
+    QTest::addRow("empty - empty") << QRegion() << QRegion();
+    QTest::addRow("empty - 0,0 10x10") << QRegion() << QRegion(0, 0, 10, 10);
+    QTest::addRow("0,0 10x10 - empty") << QRegion(0, 0, 10, 10) << QRegion();
+    QTest::addRow("same") << QRegion(0, 0, 10, 10) << QRegion(0, 0, 10, 10);
+    QTest::addRow("overlapping") << QRegion(0, 0, 10, 10) << QRegion(5, 5, 10, 10);
+    QTest::addRow("touching horizontally") << QRegion(0, 0, 10, 10) << QRegion(10, 0, 10, 10);
+    QTest::addRow("touching vertically") << QRegion(0, 0, 10, 10) << QRegion(0, 10, 10, 10);
+    QTest::addRow("disjoint") << QRegion(0, 0, 10, 10) << QRegion(20, 20, 10, 10);
+    QTest::addRow("contained") << QRegion(0, 0, 100, 100) << QRegion(10, 10, 10, 10);
+    QTest::addRow("container") << QRegion(10, 10, 10, 10) << QRegion(0, 0, 100, 100);
+    QTest::addRow("lines - column")
+        << makeRegion({QRect(0, 0, 80, 16), QRect(0, 32, 40, 16), QRect(0, 64, 120, 16)})
+        << QRegion(20, 0, 10, 100);
+    QTest::addRow("checkerboard - checkerboard")
+        << makeRegion({QRect(0, 0, 10, 10), QRect(20, 0, 10, 10), QRect(10, 10, 10, 10), QRect(30, 10, 10, 10)})
+        << makeRegion({QRect(10, 0, 10, 10), QRect(30, 0, 10, 10), QRect(0, 10, 10, 10), QRect(20, 10, 10, 10)});
+    QTest::addRow("ring - hole")
+        << QRegion(0, 0, 30, 30).subtracted(QRegion(10, 10, 10, 10))
+        << QRegion(5, 5, 20, 20);
+}
+
+void TestRegion::empty()
+{
+    QVERIFY(Region().isEmpty());
+    QVERIFY(Region(Rect()).isEmpty());
+    QVERIFY(Region(0, 0, 0, 10).isEmpty());
+    QVERIFY(Region(QRegion()).isEmpty());
+    QCOMPARE(Region().rectCount(), 0);
+    QCOMPARE(Region().boundingRect(), Rect());
+    QCOMPARE(QRegion(Region()), QRegion());
+}
+
+void TestRegion::fromQRegion_data()
+{
+    addOperands();
+}
+
+void TestRegion::fromQRegion()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    const QRegion expected = a.united(b);
+    const Region region(expected);
+    QCOMPARE(QRegion(region), expected);
+    QCOMPARE(region.rectCount(), expected.rectCount());
+    QCOMPARE(region.boundingRect(), Rect(expected.boundingRect()));
+}
+
+void TestRegion::united_data()
+{
+    addOperands();
+}
+
+void TestRegion::united()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    const Region result = Region(a).united(Region(b));
+    QCOMPARE(QRegion(result), a.united(b));
+    QCOMPARE(result, Region(a.united(b)));
+    QCOMPARE(Region(a) | Region(b), result);
+}
+
+void TestRegion::intersected_data()
+{
+    addOperands();
+}
+
+void TestRegion::intersected()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    const Region result = Region(a).intersected(Region(b));
+    QCOMPARE(QRegion(result), a.intersected(b));
+    QCOMPARE(result, Region(a.intersected(b)));
+    QCOMPARE(Region(a).intersects(Region(b)), a.intersects(b));
+}
+
+void TestRegion::subtracted_data()
+{
+    addOperands();
+}
+
+void TestRegion::subtracted()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    const Region result = Region(a).subtracted(Region(b));
+    QCOMPARE(QRegion(result), a.subtracted(b));
+    QCOMPARE(result, Region(a.subtracted(b)));
+}
+
+void TestRegion::xored_data()
+{
+    addOperands();
+}
+
+void TestRegion::xored()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    const Region result = Region(a).xored(Region(b));
+    QCOMPARE(QRegion(result), a.xored(b));
+    QCOMPARE(result, Region(a.xored(b)));
+}
+
+void TestRegion::containsPoint_data()
+{
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<QPoint>("point");
+    QTest::addColumn<bool>("contains");
+
+    const QRegion lShape = makeRegion({QRect(0, 0, 10, 20), QRect(10, 10, 10, 10)});
+
+    QTest::addRow("empty") << QRegion() << QPoint(0, 0) << false;
+    QTest::addRow("top left") << lShape << QPoint(0, 0) << true;
+    QTest::addRow("bottom right") << lShape << QPoint(19, 19) << true;
+    QTest::addRow("outside bottom right") << lShape << QPoint(20, 20) << false;
+    QTest::addRow("notch") << lShape << QPoint(15, 5) << false;
+}
+
+void TestRegion::containsPoint()
+{
+    QFETCH(QRegion, region);
+    QFETCH(QPoint, point);
+
+    QTEST(Region(region).contains(point), "contains");
+}
+
+void TestRegion::containsRect_data()
+{
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<Rect>("rect");
+    QTest::addColumn<bool>("contains");
+
+    const QRegion lShape = makeRegion({QRect(0, 0, 10, 20), QRect(10, 10, 10, 10)});
+
+    QTest::addRow("empty") << QRegion() << Rect(0, 0, 1, 1) << false;
+    QTest::addRow("empty rect") << lShape << Rect() << false;
+    QTest::addRow("single band") << lShape << Rect(0, 0, 10, 10) << true;
+    QTest::addRow("spanning bands") << lShape << Rect(5, 5, 2, 10) << true;
+    QTest::addRow("spanning rects") << lShape << Rect(5, 12, 10, 5) << true;
+    QTest::addRow("notch") << lShape << Rect(5, 5, 10, 10) << false;
+}
+
+void TestRegion::containsRect()
+{
+    QFETCH(QRegion, region);
+    QFETCH(Rect, rect);
+
+    QTEST(Region(region).contains(rect), "contains");
+}
+
+void TestRegion::intersectsRect_data()
+{
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<Rect>("rect");
+    QTest::addColumn<bool>("intersects");
+
+    const QRegion lShape = makeRegion({QRect(0, 0, 10, 20), QRect(10, 10, 10, 10)});
+
+    QTest::addRow("empty") << QRegion() << Rect(0, 0, 1, 1) << false;
+    QTest::addRow("notch") << lShape << Rect(10, 0, 10, 10) << false;
+    QTest::addRow("touching") << lShape << Rect(20, 10, 10, 10) << false;
+    QTest::addRow("overlapping") << lShape << Rect(15, 5, 10, 10) << true;
+}
+
+void TestRegion::intersectsRect()
+{
+    QFETCH(QRegion, region);
+    QFETCH(Rect, rect);
+
+    QTEST(Region(region).intersects(rect), "intersects");
+}
+
+void TestRegion::translated()
+{
+    const QRegion region = makeRegion({QRect(0, 0, 10, 20), QRect(10, 10, 10, 10)});
+
+    const Region translated = Region(region).translated(QPoint(5, -5));
+    QCOMPARE(QRegion(translated), region.translated(5, -5));
+    QCOMPARE(translated.boundingRect(), Rect(5, -5, 20, 20));
+}
+
+void TestRegion::coalesce()
+{
+    // Regions that cover the same pixels must have the same representation.
+    Region region;
+    for (int y = 0; y < 10; ++y) {
+        region += Region(0, y, 5, 1);
+        region += Region(5, y, 5, 1);
+    }
+    QCOMPARE(region.rectCount(), 1);
+    QCOMPARE(region, Region(0, 0, 10, 10));
+}
+
+void TestRegion::accumulate()
+{
+    // Emulate a terminal that damages a few cells per line.
+    QRegion expected;
+    Region region;
+    for (int line = 0; line < 40; ++line) {
+        for (int column = 0; column < 8; column += 3) {
+            const QRect cell(column * 10 + line % 3, line * 16, 10, 16);
+            expected += cell;
+            region += Region(cell);
+        }
+    }
+    QCOMPARE(QRegion(region), expected);
+    QCOMPARE(region.boundingRect(), Rect(expected.boundingRect()));
+}
+
+QTEST_MAIN(TestRegion)
+
+#include "test_region.moc"
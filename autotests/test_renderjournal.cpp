@@ -0,0 +1,187 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/renderjournal.h"
+#include "utils/framecounters.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestRenderJournal : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void histogramBuckets();
+    void histogramPercentile();
+    void journalWrapsAround();
+    void percentileNeedsSamples();
+    void percentileIgnoresOutliers();
+    void missedDeadlineCounters();
+    void frameCounterJournalWrapsAround();
+    void renderQualityController();
+};
+
+void TestRenderJournal::histogramBuckets()
+{
+    for (int i = 0; i < FrameTimingHistogram::s_bucketCount - 1; i++) {
+        const auto upperBound = FrameTimingHistogram::bucketUpperBound(i);
+        QCOMPARE(FrameTimingHistogram::bucketIndex(upperBound - 1ns), i);
+        QCOMPARE(FrameTimingHistogram::bucketIndex(upperBound), i + 1);
+    }
+    QCOMPARE(FrameTimingHistogram::bucketIndex(-1ms), 0);
+    QCOMPARE(FrameTimingHistogram::bucketIndex(1h), FrameTimingHistogram::s_bucketCount - 1);
+}
+
+void TestRenderJournal::histogramPercentile()
+{
+    FrameTimingHistogram histogram;
+    QCOMPARE(histogram.percentile(50), 0ns);
+    for (int i = 1; i <= 100; i++) {
+        histogram.add(std::chrono::microseconds(i * 100));
+    }
+    QCOMPARE(histogram.count(), uint64_t(100));
+    QCOMPARE(histogram.max(), 10ms);
+    QCOMPARE(histogram.percentile(100), 10ms);
+    // buckets have a relative error of at most 1/8
+    const auto median = histogram.percentile(50);
+    QVERIFY(median >= 5ms);
+    QVERIFY(median <= 5ms * 9 / 8);
+}
+
+void TestRenderJournal::journalWrapsAround()
+{
+    FrameTimingJournal journal;
+    const size_t total = FrameTimingJournal::s_capacity + 10;
+    for (size_t i = 0; i < total; i++) {
+        journal.add(FrameTimingRecord{
+            .renderStart = 1ms,
+            .renderEnd = 1ms + std::chrono::microseconds(i + 1),
+        });
+    }
+    const auto records = journal.records();
+    QCOMPARE(records.size(), FrameTimingJournal::s_capacity);
+    QCOMPARE(records.front().renderEnd, 1ms + std::chrono::microseconds(11));
+    QCOMPARE(records.back().renderEnd, 1ms + std::chrono::microseconds(total));
+    QCOMPARE(journal.histograms().renderTime.count(), FrameTimingJournal::s_capacity);
+}
+
+void TestRenderJournal::percentileNeedsSamples()
+{
+    PercentileRenderJournal journal;
+    for (size_t i = 0; i < PercentileRenderJournal::s_minimumSamples - 1; i++) {
+        journal.add(2ms);
+        QVERIFY(!journal.result().has_value());
+    }
+    journal.add(2ms);
+    QCOMPARE(journal.result(), std::optional(2ms));
+}
+
+void TestRenderJournal::percentileIgnoresOutliers()
+{
+    PercentileRenderJournal journal(95);
+    for (size_t i = 0; i < PercentileRenderJournal::s_windowSize; i++) {
+        journal.add(i % 50 == 0 ? 12ms : 3ms);
+    }
+    // less than 5% of the frames are slow
+    QCOMPARE(journal.result(), std::optional(3ms));
+
+    // once the slow frames make up more than 5% of the window, they're taken into account
+    for (size_t i = 0; i < PercentileRenderJournal::s_windowSize / 10; i++) {
+        journal.add(12ms);
+    }
+    QCOMPARE(journal.result(), std::optional(12ms));
+
+    // and they slide out of the window again
+    for (size_t i = 0; i < PercentileRenderJournal::s_windowSize; i++) {
+        journal.add(3ms);
+    }
+    QCOMPARE(journal.result(), std::optional(3ms));
+}
+
+void TestRenderJournal::missedDeadlineCounters()
+{
+    MissedDeadlineCounters counters;
+    QCOMPARE(counters.total(), uint64_t(0));
+    counters.add(MissedDeadlineReason::LateSubmission);
+    counters.add(MissedDeadlineReason::LateSubmission);
+    counters.add(MissedDeadlineReason::PageflipTimeout);
+    QCOMPARE(counters.count(MissedDeadlineReason::LateSubmission), uint64_t(2));
+    QCOMPARE(counters.count(MissedDeadlineReason::CommitRejected), uint64_t(0));
+    QCOMPARE(counters.count(MissedDeadlineReason::PageflipTimeout), uint64_t(1));
+    QCOMPARE(counters.total(), uint64_t(3));
+}
+
+void TestRenderJournal::frameCounterJournalWrapsAround()
+{
+    FrameCounterJournal journal;
+    QVERIFY(journal.records().empty());
+    const size_t total = FrameCounterJournal::s_capacity + 10;
+    for (size_t i = 0; i < total; i++) {
+        FrameCounterRecord record{
+            .timestamp = std::chrono::milliseconds(i + 1),
+        };
+        record.values[size_t(FrameCounters::Counter::Allocations)] = i + 1;
+        journal.add(record);
+    }
+    const auto records = journal.records();
+    QCOMPARE(records.size(), FrameCounterJournal::s_capacity);
+    QCOMPARE(records.front().timestamp, 11ms);
+    QCOMPARE(records.back().values[size_t(FrameCounters::Counter::Allocations)], total);
+}
+
+void TestRenderJournal::renderQualityController()
+{
+    RenderQualityController controller;
+    QCOMPARE(controller.quality(), 1.0);
+
+    // frames that fit don't raise the quality above 1
+    for (int i = 0; i < RenderQualityController::s_recoveryFrameCount * 2; i++) {
+        QVERIFY(!controller.add(1ms, 10ms, false));
+    }
+
+    QVERIFY(controller.add(1ms, 10ms, true));
+    QCOMPARE(controller.quality(), 0.8);
+    QVERIFY(controller.add(12ms, 10ms, false));
+    QCOMPARE(controller.quality(), 0.8 * 0.8);
+
+    // the quality doesn't drop below the minimum
+    for (int i = 0; i < 20; i++) {
+        controller.add(12ms, 10ms, true);
+    }
+    QCOMPARE(controller.quality(), RenderQualityController::s_minQuality);
+    QVERIFY(!controller.add(12ms, 10ms, true));
+
+    // frames that barely fit keep the quality where it is
+    for (int i = 0; i < RenderQualityController::s_recoveryFrameCount * 2; i++) {
+        QVERIFY(!controller.add(7ms, 10ms, false));
+    }
+    QCOMPARE(controller.quality(), RenderQualityController::s_minQuality);
+
+    // frames with room to spare raise it again, after a while
+    for (int i = 1; i < RenderQualityController::s_recoveryFrameCount; i++) {
+        QVERIFY(!controller.add(2ms, 10ms, false));
+    }
+    QVERIFY(controller.add(2ms, 10ms, false));
+    QCOMPARE(controller.quality(), RenderQualityController::s_minQuality + 0.05);
+    for (int i = 1; i < RenderQualityController::s_recoveryStepFrameCount; i++) {
+        QVERIFY(!controller.add(2ms, 10ms, false));
+    }
+    QVERIFY(controller.add(2ms, 10ms, false));
+    QCOMPARE(controller.quality(), RenderQualityController::s_minQuality + 0.1);
+
+    // a single late frame interrupts the recovery
+    QVERIFY(!controller.add(7ms, 10ms, false));
+    for (int i = 1; i < RenderQualityController::s_recoveryFrameCount; i++) {
+        QVERIFY(!controller.add(2ms, 10ms, false));
+    }
+    QVERIFY(controller.add(2ms, 10ms, false));
+}
+
+QTEST_GUILESS_MAIN(TestRenderJournal)
+#include "test_renderjournal.moc"
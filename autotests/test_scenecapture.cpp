@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "scene/imageitem.h"
+#include "scene/scenecapture.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestSceneCapture : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void captureTree();
+    void roundTrip();
+};
+
+void TestSceneCapture::captureTree()
+{
+    Item root;
+    root.setSize(QSizeF(100, 100));
+    Item top(&root);
+    top.setZ(1);
+    ImageItem bottom(&root);
+    bottom.setPosition(QPointF(10, 20));
+    bottom.setOpacity(0.5);
+    bottom.setImage(QImage(QSize(30, 40), QImage::Format_ARGB32_Premultiplied));
+    Item child(&bottom);
+    child.setVisible(false);
+
+    SceneCapture capture(2);
+    const SceneCaptureFrame frame = capture.captureFrame({&root}, nullptr, QStringLiteral("output"), 1ms);
+    QCOMPARE(frame.items.size(), 4);
+
+    // parents come first, siblings in paint order
+    QCOMPARE(frame.items[0].parentId, 0u);
+    QCOMPARE(frame.items[0].size, QSizeF(100, 100));
+    QCOMPARE(frame.items[1].parentId, frame.items[0].id);
+    QCOMPARE(frame.items[1].type, QByteArray("KWin::ImageItem"));
+    QCOMPARE(frame.items[1].position, QPointF(10, 20));
+    QCOMPARE(frame.items[1].opacity, 0.5);
+    QCOMPARE(frame.items[1].textureSize, QSize(30, 40));
+    QVERIFY(frame.items[1].textureHasAlpha);
+    QCOMPARE(frame.items[2].parentId, frame.items[1].id);
+    QVERIFY(!frame.items[2].visible);
+    QCOMPARE(frame.items[3].parentId, frame.items[0].id);
+    QCOMPARE(frame.items[3].z, 1);
+
+    // the ids stay the same across frames
+    top.setZ(-1);
+    const SceneCaptureFrame next = capture.captureFrame({&root}, nullptr, QStringLiteral("output"), 2ms);
+    QCOMPARE(next.items[1].id, frame.items[3].id);
+    QCOMPARE(next.items[2].id, frame.items[1].id);
+}
+
+void TestSceneCapture::roundTrip()
+{
+    Item root;
+    Item child(&root);
+    child.setTransform(QTransform::fromScale(2, 3));
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath(QStringLiteral("capture"));
+    const int frameCount = 3;
+    QList<SceneCaptureFrame> frames;
+    {
+        SceneCapture capture(frameCount);
+        QVERIFY(capture.open(fileName));
+        for (int i = 0; !capture.isFinished(); ++i) {
+            child.setPosition(QPointF(i, i));
+            frames.append(capture.captureFrame({&root}, nullptr, QStringLiteral("output"), std::chrono::milliseconds(i)));
+            capture.addFrame(frames.last());
+        }
+        // frames past the end are dropped
+        capture.addFrame(frames.last());
+    }
+    QCOMPARE(frames.size(), frameCount);
+
+    SceneCaptureReader reader;
+    QVERIFY(reader.open(fileName));
+    for (const SceneCaptureFrame &frame : std::as_const(frames)) {
+        const auto read = reader.readFrame();
+        QVERIFY(read);
+        QCOMPARE(*read, frame);
+    }
+    QVERIFY(!reader.readFrame());
+}
+
+QTEST_MAIN(TestSceneCapture)
+#include "test_scenecapture.moc"
@@ -0,0 +1,101 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QPainter>
+#include <QTest>
+
+#include "utils/softwareblend.h"
+
+using namespace KWin;
+
+static QImage pattern(const QSize &size, QImage::Format format, int seed)
+{
+    QImage image(size, format);
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            const int alpha = format == QImage::Format_RGB32 ? 255 : (x * 7 + y * 3 + seed) % 256;
+            image.setPixel(x, y, qPremultiply(qRgba((x + seed) % 256, (y * 5) % 256, (x * y + seed) % 256, alpha)));
+        }
+    }
+    return image;
+}
+
+static int maxDifference(const QImage &one, const QImage &two)
+{
+    int ret = 0;
+    for (int y = 0; y < one.height(); ++y) {
+        for (int x = 0; x < one.width(); ++x) {
+            const QRgb a = one.pixel(x, y);
+            const QRgb b = two.pixel(x, y);
+            ret = std::max({ret, std::abs(qRed(a) - qRed(b)), std::abs(qGreen(a) - qGreen(b)), std::abs(qBlue(a) - qBlue(b)), std::abs(qAlpha(a) - qAlpha(b))});
+        }
+    }
+    return ret;
+}
+
+class TestSoftwareBlend : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void compareWithQPainter_data();
+    void compareWithQPainter();
+    void clipToTarget();
+};
+
+void TestSoftwareBlend::compareWithQPainter_data()
+{
+    QTest::addColumn<QImage::Format>("sourceFormat");
+    QTest::addColumn<QImage::Format>("targetFormat");
+    QTest::addColumn<qreal>("opacity");
+    QTest::addColumn<QSize>("size");
+
+    QTest::addRow("opaque copy") << QImage::Format_RGB32 << QImage::Format_RGB32 << 1.0 << QSize(67, 45);
+    QTest::addRow("opaque with opacity") << QImage::Format_RGB32 << QImage::Format_ARGB32_Premultiplied << 0.5 << QSize(67, 45);
+    QTest::addRow("translucent") << QImage::Format_ARGB32_Premultiplied << QImage::Format_RGB32 << 1.0 << QSize(67, 45);
+    QTest::addRow("translucent with opacity") << QImage::Format_ARGB32_Premultiplied << QImage::Format_ARGB32_Premultiplied << 0.3 << QSize(67, 45);
+    QTest::addRow("threaded") << QImage::Format_ARGB32_Premultiplied << QImage::Format_ARGB32_Premultiplied << 0.7 << QSize(1024, 600);
+}
+
+void TestSoftwareBlend::compareWithQPainter()
+{
+    QFETCH(QImage::Format, sourceFormat);
+    QFETCH(QImage::Format, targetFormat);
+    QFETCH(qreal, opacity);
+    QFETCH(QSize, size);
+
+    const QImage source = pattern(size, sourceFormat, 1);
+    const QImage background = pattern(size + QSize(20, 20), targetFormat, 2);
+    const QRect sourceRect(QPoint(3, 2), size - QSize(6, 4));
+    const QPoint position(10, 12);
+
+    QImage expected = background;
+    {
+        QPainter painter(&expected);
+        painter.setOpacity(opacity);
+        painter.drawImage(position, source, sourceRect);
+    }
+    QImage blended = background;
+    blendImage(blended, position, source, sourceRect, opacity);
+
+    // QPainter rounds a little differently
+    QCOMPARE_LE(maxDifference(blended, expected), 2);
+}
+
+void TestSoftwareBlend::clipToTarget()
+{
+    const QImage source = pattern(QSize(50, 50), QImage::Format_RGB32, 1);
+    QImage target(QSize(40, 40), QImage::Format_RGB32);
+    target.fill(Qt::black);
+    blendImage(target, QPoint(-10, 20), source, source.rect(), 1.0);
+
+    QCOMPARE(target.pixel(0, 19), qRgb(0, 0, 0));
+    QCOMPARE(target.pixel(0, 20), source.pixel(10, 0));
+    QCOMPARE(target.pixel(39, 39), source.pixel(49, 19));
+}
+
+QTEST_MAIN(TestSoftwareBlend)
+#include "test_softwareblend.moc"
@@ -0,0 +1,82 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "effect/globals.h"
+#include "utils/softwarevsyncmonitor.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestSoftwareVsyncMonitor : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void phase();
+    void latency();
+    void adaptive();
+};
+
+static std::chrono::nanoseconds now()
+{
+    return std::chrono::steady_clock::now().time_since_epoch();
+}
+
+void TestSoftwareVsyncMonitor::phase()
+{
+    auto monitor = SoftwareVsyncMonitor::create();
+    monitor->setRefreshRate(100000);
+    monitor->setPhase(3ms);
+    QSignalSpy vblankSpy(monitor.get(), &VsyncMonitor::vblankOccurred);
+
+    monitor->arm();
+    QVERIFY(vblankSpy.wait());
+    const auto timestamp = vblankSpy.last().at(0).value<std::chrono::nanoseconds>();
+    QCOMPARE(timestamp % 10ms, 3ms);
+}
+
+void TestSoftwareVsyncMonitor::latency()
+{
+    auto monitor = SoftwareVsyncMonitor::create();
+    monitor->setRefreshRate(100000);
+    monitor->setLatency(25ms);
+    QSignalSpy vblankSpy(monitor.get(), &VsyncMonitor::vblankOccurred);
+
+    const auto armTime = now();
+    monitor->arm();
+    QVERIFY(vblankSpy.wait());
+    const auto timestamp = vblankSpy.last().at(0).value<std::chrono::nanoseconds>();
+    QCOMPARE(timestamp % 10ms, 0ms);
+    QVERIFY(timestamp >= armTime + 25ms);
+    QVERIFY(timestamp < armTime + 35ms);
+}
+
+void TestSoftwareVsyncMonitor::adaptive()
+{
+    auto monitor = SoftwareVsyncMonitor::create();
+    monitor->setRefreshRate(60000);
+    QSignalSpy vblankSpy(monitor.get(), &VsyncMonitor::vblankOccurred);
+
+    // the first frame isn't held back by a previous refresh
+    const auto armTime = now();
+    monitor->armAdaptive(50000);
+    QVERIFY(vblankSpy.wait());
+    const auto first = vblankSpy.last().at(0).value<std::chrono::nanoseconds>();
+    QVERIFY(first >= armTime);
+    QVERIFY(first < armTime + 5ms);
+
+    // but the next one can't come sooner than the shortest refresh interval
+    monitor->armAdaptive(50000);
+    QVERIFY(vblankSpy.wait());
+    const auto second = vblankSpy.last().at(0).value<std::chrono::nanoseconds>();
+    QVERIFY(second >= first + 20ms);
+}
+
+QTEST_GUILESS_MAIN(TestSoftwareVsyncMonitor)
+#include "test_softwarevsyncmonitor.moc"
@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "utils/spscqueue.h"
+
+#include <thread>
+
+using namespace KWin;
+
+class TestSpscQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSpscQueue() = default;
+
+private Q_SLOTS:
+    void order();
+    void full();
+    void threads();
+};
+
+void TestSpscQueue::order()
+{
+    SpscQueue<int, 4> queue;
+    QVERIFY(!queue.pop());
+
+    QVERIFY(queue.push(1));
+    QVERIFY(queue.push(2));
+    QCOMPARE(queue.pop().value_or(0), 1);
+    QVERIFY(queue.push(3));
+    QCOMPARE(queue.pop().value_or(0), 2);
+    QCOMPARE(queue.pop().value_or(0), 3);
+    QVERIFY(!queue.pop());
+}
+
+void TestSpscQueue::full()
+{
+    SpscQueue<int, 2> queue;
+    QVERIFY(queue.push(1));
+    QVERIFY(queue.push(2));
+    QVERIFY(!queue.push(3));
+
+    QCOMPARE(queue.pop().value_or(0), 1);
+    QVERIFY(queue.push(3));
+    QCOMPARE(queue.pop().value_or(0), 2);
+    QCOMPARE(queue.pop().value_or(0), 3);
+}
+
+void TestSpscQueue::threads()
+{
+    SpscQueue<int, 16> queue;
+    const int count = 100000;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < count; ++i) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < count) {
+        if (const auto value = queue.pop()) {
+            QCOMPARE(*value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    QVERIFY(!queue.pop());
+}
+
+QTEST_GUILESS_MAIN(TestSpscQueue)
+
+#include "test_spscqueue.moc"
@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include <thread>
+
+#include "startuptimeline.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestStartupTimeline : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void recordPhases();
+    void ignorePhasesAfterFinish();
+};
+
+void TestStartupTimeline::recordPhases()
+{
+    StartupTimeline timeline;
+    {
+        StartupPhase outer(&timeline, "outer");
+        {
+            StartupPhase inner(&timeline, "inner");
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    std::thread([&timeline]() {
+        StartupPhase phase(&timeline, "thread");
+    }).join();
+
+    const auto phases = timeline.phases();
+    QCOMPARE(phases.size(), 3);
+    QCOMPARE(phases[0].name, "inner");
+    QCOMPARE(phases[1].name, "outer");
+    QCOMPARE(phases[2].name, "thread");
+    QVERIFY(phases[0].duration >= 1ms);
+    QVERIFY(phases[1].start <= phases[0].start);
+    QVERIFY(phases[1].duration >= phases[0].duration);
+    QVERIFY(phases[2].start >= phases[1].start + phases[1].duration);
+}
+
+void TestStartupTimeline::ignorePhasesAfterFinish()
+{
+    StartupTimeline timeline;
+    {
+        StartupPhase phase(&timeline, "before");
+    }
+    QVERIFY(!timeline.isFinished());
+    QCOMPARE(timeline.totalDuration(), 0ns);
+
+    timeline.finish();
+    QVERIFY(timeline.isFinished());
+    QVERIFY(timeline.totalDuration() > 0ns);
+    {
+        StartupPhase phase(&timeline, "after");
+    }
+    QCOMPARE(timeline.phases().size(), 1);
+}
+
+QTEST_GUILESS_MAIN(TestStartupTimeline)
+
+#include "test_startuptimeline.moc"
@@ -0,0 +1,119 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "stateexport.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace KWin;
+
+class TestStateExport : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void publishAndRead();
+    void rejectUnknownLayout();
+    void rejectConcurrentWrite();
+};
+
+static StateExportSegment *mapSegment(const QString &fileName, int *fd)
+{
+    *fd = open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+    if (*fd < 0) {
+        return nullptr;
+    }
+    void *data = mmap(nullptr, sizeof(StateExportSegment), PROT_READ, MAP_SHARED, *fd, 0);
+    return data == MAP_FAILED ? nullptr : static_cast<StateExportSegment *>(data);
+}
+
+void TestStateExport::publishAndRead()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath(QStringLiteral("state"));
+    auto buffer = StateExportBuffer::create(fileName);
+    QVERIFY(buffer);
+
+    auto snapshot = std::make_unique<StateExportSnapshot>();
+    snapshot->timestamp = 42;
+    snapshot->compositingActive = 1;
+    snapshot->outputCount = 1;
+    std::strcpy(snapshot->outputs[0].name, "DP-1");
+    snapshot->outputs[0].width = 1920;
+    snapshot->outputs[0].refreshRate = 60000;
+    snapshot->windowCount = 2;
+    std::strcpy(snapshot->windows[0].caption, "first");
+    std::strcpy(snapshot->windows[1].caption, "second");
+    snapshot->windows[1].flags = StateExportWindowActive;
+    buffer->publish(*snapshot);
+
+    int fd;
+    const StateExportSegment *segment = mapSegment(fileName, &fd);
+    QVERIFY(segment);
+    QCOMPARE(segment->sequence.load(), uint64_t(2));
+
+    auto read = std::make_unique<StateExportSnapshot>();
+    QVERIFY(StateExportBuffer::read(segment, read.get()));
+    QCOMPARE(read->timestamp, int64_t(42));
+    QCOMPARE(read->outputCount, 1u);
+    QCOMPARE(QByteArray(read->outputs[0].name), QByteArrayLiteral("DP-1"));
+    QCOMPARE(read->outputs[0].width, 1920);
+    QCOMPARE(read->outputs[0].refreshRate, 60000u);
+    QCOMPARE(read->windowCount, 2u);
+    QCOMPARE(QByteArray(read->windows[0].caption), QByteArrayLiteral("first"));
+    QCOMPARE(QByteArray(read->windows[1].caption), QByteArrayLiteral("second"));
+    QCOMPARE(read->windows[1].flags, uint32_t(StateExportWindowActive));
+
+    // fewer windows leave the stale entries in place, but they are not reported
+    snapshot->windowCount = 1;
+    buffer->publish(*snapshot);
+    QVERIFY(StateExportBuffer::read(segment, read.get()));
+    QCOMPARE(read->windowCount, 1u);
+    QCOMPARE(segment->sequence.load(), uint64_t(4));
+
+    munmap(const_cast<StateExportSegment *>(segment), sizeof(StateExportSegment));
+    close(fd);
+
+    buffer.reset();
+    QVERIFY(!QFile::exists(fileName));
+}
+
+void TestStateExport::rejectUnknownLayout()
+{
+    auto segment = std::make_unique<StateExportSegment>();
+    segment->magic = s_stateExportMagic;
+    segment->version = s_stateExportVersion + 1;
+    segment->size = sizeof(StateExportSegment);
+
+    auto snapshot = std::make_unique<StateExportSnapshot>();
+    QVERIFY(!StateExportBuffer::read(segment.get(), snapshot.get()));
+
+    segment->version = s_stateExportVersion;
+    QVERIFY(StateExportBuffer::read(segment.get(), snapshot.get()));
+}
+
+void TestStateExport::rejectConcurrentWrite()
+{
+    auto segment = std::make_unique<StateExportSegment>();
+    segment->magic = s_stateExportMagic;
+    segment->version = s_stateExportVersion;
+    segment->size = sizeof(StateExportSegment);
+    // an odd sequence means that the writer is in the middle of an update
+    segment->sequence = 1;
+
+    auto snapshot = std::make_unique<StateExportSnapshot>();
+    QVERIFY(!StateExportBuffer::read(segment.get(), snapshot.get()));
+}
+
+QTEST_GUILESS_MAIN(TestStateExport)
+#include "test_stateexport.moc"
@@ -0,0 +1,96 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTemporaryFile>
+#include <QTest>
+
+#include "tracing.h"
+
+class TestTracing : public QObject
+{
+    Q_OBJECT
+public:
+    TestTracing();
+private Q_SLOTS:
+    void benchmarkScopeOff();
+    void parseCategories();
+    void record();
+    void disabledCategory();
+};
+
+TestTracing::TestTracing()
+{
+    KWin::Tracer::create();
+}
+
+void TestTracing::benchmarkScopeOff()
+{
+    // a disabled span should cost next to nothing
+    QBENCHMARK {
+        traceScope(Scene, "bench");
+    }
+}
+
+void TestTracing::parseCategories()
+{
+    QCOMPARE(KWin::Tracer::parseCategories(QStringLiteral("scene, drm")), uint32_t(KWin::TraceCategory::Scene) | uint32_t(KWin::TraceCategory::Drm));
+    QCOMPARE(KWin::Tracer::parseCategories(QStringLiteral("all")), 0xffffffffu);
+    QCOMPARE(KWin::Tracer::parseCategories(QStringLiteral("foo")), 0u);
+}
+
+void TestTracing::record()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    QVERIFY(KWin::Tracer::self()->start(QStringLiteral("all")));
+    QVERIFY(KWin::Tracer::isEnabled(KWin::TraceCategory::Wayland));
+    {
+        traceScope(Scene, "outer");
+        traceScope(Wayland, "inner");
+    }
+    QVERIFY(KWin::Tracer::self()->stop(file.fileName()));
+    QVERIFY(!KWin::Tracer::isEnabled(KWin::TraceCategory::Wayland));
+
+    const QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value(QStringLiteral("traceEvents")).toArray();
+    QCOMPARE(events.size(), 4);
+    QCOMPARE(events[0].toObject().value(QStringLiteral("name")).toString(), QStringLiteral("outer"));
+    QCOMPARE(events[0].toObject().value(QStringLiteral("cat")).toString(), QStringLiteral("scene"));
+    QCOMPARE(events[0].toObject().value(QStringLiteral("ph")).toString(), QStringLiteral("B"));
+    QCOMPARE(events[1].toObject().value(QStringLiteral("name")).toString(), QStringLiteral("inner"));
+    QCOMPARE(events[2].toObject().value(QStringLiteral("name")).toString(), QStringLiteral("inner"));
+    QCOMPARE(events[2].toObject().value(QStringLiteral("ph")).toString(), QStringLiteral("E"));
+    QCOMPARE(events[3].toObject().value(QStringLiteral("name")).toString(), QStringLiteral("outer"));
+    QVERIFY(events[0].toObject().value(QStringLiteral("ts")).toDouble() <= events[3].toObject().value(QStringLiteral("ts")).toDouble());
+}
+
+void TestTracing::disabledCategory()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    QVERIFY(KWin::Tracer::self()->start(QStringLiteral("drm")));
+    {
+        traceScope(Scene, "ignored");
+        traceScope(Drm, "recorded");
+    }
+    QVERIFY(KWin::Tracer::self()->stop(file.fileName()));
+
+    const QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value(QStringLiteral("traceEvents")).toArray();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events[0].toObject().value(QStringLiteral("name")).toString(), QStringLiteral("recorded"));
+}
+
+QTEST_MAIN(TestTracing)
+
+#include "test_tracing.moc"
@@ -1947,10 +1947,24 @@ void TestWaylandSeat::testKeymap()
     QVERIFY(fd != -1);
     // Account for null terminator.
     QCOMPARE(keymapChangedSpy.first().last().value<quint32>(), 4u);
-    QVERIFY(file.open(fd, QIODevice::ReadWrite));
+    // The keymap is shared between clients, so it can't be mapped for writing
+    QVERIFY(file.open(fd, QIODevice::ReadOnly));
     address = reinterpret_cast<char *>(file.map(0, keymapChangedSpy.first().last().value<quint32>()));
     QVERIFY(address);
     QCOMPARE(qstrcmp(address, "bar"), 0);
+    file.close();
+
+    // switch back to the previous keymap
+    keymapChangedSpy.clear();
+    m_seatInterface->keyboard()->setKeymap(QByteArrayLiteral("foo"));
+    QVERIFY(keymapChangedSpy.wait());
+    fd = keymapChangedSpy.first().first().toInt();
+    QVERIFY(fd != -1);
+    QCOMPARE(keymapChangedSpy.first().last().value<quint32>(), 4u);
+    QVERIFY(file.open(fd, QIODevice::ReadOnly));
+    address = reinterpret_cast<char *>(file.map(0, keymapChangedSpy.first().last().value<quint32>()));
+    QVERIFY(address);
+    QCOMPARE(qstrcmp(address, "foo"), 0);
 }
 
 QTEST_GUILESS_MAIN(TestWaylandSeat)
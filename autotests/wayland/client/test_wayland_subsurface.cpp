@@ -40,6 +40,7 @@ private Q_SLOTS:
     void testMode();
     void testPosition_data();
     void testPosition();
+    void testSubSurfaceTreeChanged();
     void testPlaceAbove();
     void testPlaceBelow();
     void testSyncMode();
@@ -331,6 +332,38 @@ void TestSubSurface::testPosition()
     QCOMPARE(serverSubSurface->position(), QPoint(20, 30));
 }
 
+void TestSubSurface::testSubSurfaceTreeChanged()
+{
+    using namespace KWin;
+    std::unique_ptr<KWayland::Client::Surface> surface1(m_compositor->createSurface());
+    std::unique_ptr<KWayland::Client::Surface> surface2(m_compositor->createSurface());
+    std::unique_ptr<KWayland::Client::Surface> parent(m_compositor->createSurface());
+
+    QSignalSpy subSurfaceCreatedSpy(m_subcompositorInterface, &KWin::SubCompositorInterface::subSurfaceCreated);
+    std::unique_ptr<KWayland::Client::SubSurface> subSurface1(m_subCompositor->createSubSurface(surface1.get(), parent.get()));
+    std::unique_ptr<KWayland::Client::SubSurface> subSurface2(m_subCompositor->createSubSurface(surface2.get(), parent.get()));
+    QVERIFY(subSurfaceCreatedSpy.wait());
+    if (subSurfaceCreatedSpy.count() < 2) {
+        QVERIFY(subSurfaceCreatedSpy.wait());
+    }
+    SurfaceInterface *serverParent = subSurfaceCreatedSpy.first().first().value<KWin::SubSurfaceInterface *>()->parentSurface();
+    QVERIFY(serverParent);
+
+    // moving both sub-surfaces at once is reported once
+    QSignalSpy treeChangedSpy(serverParent, &SurfaceInterface::subSurfaceTreeChanged);
+    QSignalSpy parentCommittedSpy(serverParent, &SurfaceInterface::committed);
+    subSurface1->setPosition(QPoint(10, 20));
+    subSurface2->setPosition(QPoint(30, 40));
+    parent->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+    QCOMPARE(treeChangedSpy.count(), 1);
+
+    // committing without changing the tree isn't reported
+    parent->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+    QCOMPARE(treeChangedSpy.count(), 1);
+}
+
 void TestSubSurface::testPlaceAbove()
 {
     using namespace KWin;
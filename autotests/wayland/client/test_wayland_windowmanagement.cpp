@@ -58,6 +58,7 @@ private Q_SLOTS:
     void testIcon();
     void testPid();
     void testApplicationMenu();
+    void testCoalescedChanges();
 
     void cleanup();
 
@@ -601,5 +602,27 @@ void TestWindowManagement::testApplicationMenu()
     QCOMPARE(m_window->applicationMenuObjectPath(), objectPath);
 }
 
+void TestWindowManagement::testCoalescedChanges()
+{
+    // changes made in one go reach the client once, with the final values
+    QSignalSpy titleSpy(m_window, &KWayland::Client::PlasmaWindow::titleChanged);
+    QSignalSpy minimizedSpy(m_window, &KWayland::Client::PlasmaWindow::minimizedChanged);
+    QSignalSpy activeSpy(m_window, &KWayland::Client::PlasmaWindow::activeChanged);
+    m_windowInterface->setTitle(QStringLiteral("first"));
+    m_windowInterface->setMinimized(true);
+    m_windowInterface->setTitle(QStringLiteral("second"));
+    m_windowInterface->setActive(true);
+    m_windowInterface->setMinimized(false);
+    m_windowInterface->setTitle(QStringLiteral("third"));
+
+    QVERIFY(titleSpy.wait());
+    QCOMPARE(titleSpy.count(), 1);
+    QCOMPARE(m_window->title(), QStringLiteral("third"));
+    QCOMPARE(activeSpy.count(), 1);
+    QVERIFY(m_window->isActive());
+    QCOMPARE(minimizedSpy.count(), 0);
+    QVERIFY(!m_window->isMinimized());
+}
+
 QTEST_MAIN(TestWindowManagement)
 #include "test_wayland_windowmanagement.moc"
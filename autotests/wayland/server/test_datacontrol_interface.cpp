@@ -18,6 +18,7 @@
 #include "wayland/datacontrolsource_v1.h"
 #include "wayland/display.h"
 #include "wayland/seat.h"
+#include "utils/pipe.h"
 
 #include <KWayland/Client/compositor.h>
 #include <KWayland/Client/connection_thread.h>
@@ -27,6 +28,9 @@
 
 #include "qwayland-ext-data-control-v1.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 using namespace KWin;
 
 // Faux-client API for tests
@@ -128,6 +132,33 @@ public:
     }
 };
 
+class CountingDataSource : public TestDataSource
+{
+    Q_OBJECT
+public:
+    void requestData(const QString &mimeType, FileDescriptor fd) override
+    {
+        requestCount++;
+        const QByteArray data = mimeType.toUtf8().repeated(1024);
+        QVERIFY(write(fd.get(), data.constData(), data.size()) == data.size());
+    }
+
+    int requestCount = 0;
+};
+
+static bool readUntilEndOfFile(int fd, QByteArray *data)
+{
+    char buffer[4096];
+    while (true) {
+        const ssize_t readSize = read(fd, buffer, sizeof(buffer));
+        if (readSize > 0) {
+            data->append(buffer, readSize);
+        } else {
+            return readSize == 0;
+        }
+    }
+}
+
 // The test itself
 
 class DataControlInterfaceTest : public QObject
@@ -143,6 +174,7 @@ private Q_SLOTS:
     void testCopyFromControl();
     void testCopyFromControlPrimarySelection();
     void testKlipperCase();
+    void testSelectionCache();
 
 private:
     KWayland::Client::ConnectionThread *m_connection;
@@ -166,6 +198,7 @@ static const QString s_socketName = QStringLiteral("kwin-wayland-datacontrol-tes
 
 void DataControlInterfaceTest::initTestCase()
 {
+    qputenv("KWIN_WAYLAND_SELECTION_CACHE", "1");
     qRegisterMetaType<::ext_data_control_offer_v1 *>();
 }
 
@@ -386,6 +419,50 @@ void DataControlInterfaceTest::testKlipperCase()
     QCOMPARE(m_seat->selection(), testSelection2.get());
 }
 
+void DataControlInterfaceTest::testSelectionCache()
+{
+    // two clipboard managers read the same selection, the source must be asked only once
+
+    std::unique_ptr<DataControlDevice> firstDevice(new DataControlDevice);
+    firstDevice->init(m_dataControlDeviceManager->get_data_device(*m_clientSeat));
+    QSignalSpy firstOfferSpy(firstDevice.get(), &DataControlDevice::dataControlOffer);
+    QSignalSpy firstSelectionSpy(firstDevice.get(), &DataControlDevice::selection);
+
+    std::unique_ptr<DataControlDevice> secondDevice(new DataControlDevice);
+    secondDevice->init(m_dataControlDeviceManager->get_data_device(*m_clientSeat));
+    QSignalSpy secondOfferSpy(secondDevice.get(), &DataControlDevice::dataControlOffer);
+    QSignalSpy secondSelectionSpy(secondDevice.get(), &DataControlDevice::selection);
+
+    std::unique_ptr<CountingDataSource> testSelection(new CountingDataSource);
+    m_seat->setSelection(testSelection.get(), m_display->nextSerial());
+    QVERIFY(firstSelectionSpy.wait());
+    if (secondSelectionSpy.isEmpty()) {
+        QVERIFY(secondSelectionSpy.wait());
+    }
+
+    std::unique_ptr<DataControlOffer> firstOffer(firstOfferSpy.first().first().value<DataControlOffer *>());
+    std::unique_ptr<DataControlOffer> secondOffer(secondOfferSpy.first().first().value<DataControlOffer *>());
+
+    std::optional<Pipe> firstPipe = Pipe::create(O_CLOEXEC | O_NONBLOCK);
+    QVERIFY(firstPipe);
+    std::optional<Pipe> secondPipe = Pipe::create(O_CLOEXEC | O_NONBLOCK);
+    QVERIFY(secondPipe);
+    firstOffer->receive(QStringLiteral("text/test1"), firstPipe->writeEndpoint.get());
+    secondOffer->receive(QStringLiteral("text/test1"), secondPipe->writeEndpoint.get());
+    m_connection->flush();
+    firstPipe->writeEndpoint.reset();
+    secondPipe->writeEndpoint.reset();
+
+    const QByteArray expected = QByteArrayLiteral("text/test1").repeated(1024);
+    QByteArray firstData;
+    QTRY_VERIFY(readUntilEndOfFile(firstPipe->readEndpoint.get(), &firstData));
+    QCOMPARE(firstData, expected);
+    QByteArray secondData;
+    QTRY_VERIFY(readUntilEndOfFile(secondPipe->readEndpoint.get(), &secondData));
+    QCOMPARE(secondData, expected);
+    QCOMPARE(testSelection->requestCount, 1);
+}
+
 QTEST_GUILESS_MAIN(DataControlInterfaceTest)
 
 #include "test_datacontrol_interface.moc"
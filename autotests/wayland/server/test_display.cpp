@@ -10,6 +10,7 @@
 #include "wayland/clientconnection.h"
 #include "wayland/display.h"
 // Wayland
+#include <wayland-client.h>
 #include <wayland-server.h>
 // system
 #include <sys/socket.h>
@@ -27,6 +28,7 @@ private Q_SLOTS:
     void testClientConnection();
     void testConnectNoSocket();
     void testAutoSocketName();
+    void testClientStatistics();
 };
 
 void TestWaylandServerDisplay::testSocketName()
@@ -168,5 +170,38 @@ void TestWaylandServerDisplay::testAutoSocketName()
     QCOMPARE(socketNameChangedSpy1.count(), 1);
 }
 
+void TestWaylandServerDisplay::testClientStatistics()
+{
+    KWin::Display display;
+    display.start();
+    QVERIFY(display.isRunning());
+
+    int sv[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) >= 0);
+    ClientConnection *connection = display.createClient(sv[0]);
+    QVERIFY(connection);
+    QCOMPARE(display.clients(), QList<ClientConnection *>{connection});
+    QCOMPARE(connection->statistics().requests, quint64(0));
+
+    wl_display *clientDisplay = wl_display_connect_to_fd(sv[1]);
+    QVERIFY(clientDisplay);
+    wl_callback *callback = wl_display_sync(clientDisplay);
+    QVERIFY(wl_display_flush(clientDisplay) > 0);
+    display.dispatchEvents();
+
+    // wl_display.sync has a header and a new_id argument
+    const ClientConnection::Statistics statistics = connection->statistics();
+    QCOMPARE(statistics.requests, quint64(1));
+    QCOMPARE(statistics.bytesReceived, quint64(12));
+    QCOMPARE(statistics.bufferCommits, quint64(0));
+    QCOMPARE(statistics.damagedPixels, quint64(0));
+    QVERIFY(!connection->isThrottled());
+
+    wl_callback_destroy(callback);
+    wl_display_disconnect(clientDisplay);
+    connection->destroy();
+    QVERIFY(display.clients().isEmpty());
+}
+
 QTEST_GUILESS_MAIN(TestWaylandServerDisplay)
 #include "test_display.moc"
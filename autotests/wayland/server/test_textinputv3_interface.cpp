@@ -349,6 +349,19 @@ void TestTextInputV3Interface::testEvents()
     // zwp_text_input_v3.done event have serial of total commits
     QCOMPARE(doneSpy.last().at(0).value<quint32>(), m_totalCommits);
 
+    // resending the same preedit changes nothing and isn't sent
+    m_serverTextInputV3->sendPreEditString("Hello KDE community!", 1, 2);
+    m_serverTextInputV3->done();
+    // but it is sent along with other events, the client would drop it otherwise
+    m_serverTextInputV3->sendPreEditString("Hello KDE community!", 1, 2);
+    m_serverTextInputV3->commitString("Wayland");
+    m_serverTextInputV3->done();
+
+    QVERIFY(doneSpy.wait());
+    QCOMPARE(doneSpy.count(), 3);
+    QCOMPARE(preEditSpy.count(), 2);
+    QCOMPARE(commitStringSpy.count(), 2);
+
     // Now disable the textInput
     m_clientTextInputV3->disable();
     m_clientTextInputV3->commit();
@@ -399,9 +399,9 @@ void Workspace::resetFocus()
 
 Window *Workspace::windowUnderMouse(LogicalOutput *output) const
 {
-    auto it = stackingOrder().constEnd();
-    while (it != stackingOrder().constBegin()) {
-        auto window = *(--it);
+    const QPointF pos = Cursors::self()->mouse()->pos();
+    const QList<Window *> candidates = windowsAt(pos);
+    for (Window *window : candidates) {
         if (!window->isClient()) {
             continue;
         }
@@ -412,7 +412,7 @@ Window *Workspace::windowUnderMouse(LogicalOutput *output) const
             continue;
         }
 
-        if (exclusiveContains(window->frameGeometry(), Cursors::self()->mouse()->pos())) {
+        if (exclusiveContains(window->frameGeometry(), pos)) {
             return window;
         }
     }
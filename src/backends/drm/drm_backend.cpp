@@ -217,7 +217,7 @@ void DrmBackend::handleUdevEvent()
             }
             if (gpu && gpu->isActive()) {
                 qCDebug(KWIN_DRM) << "Received change event for monitored drm device" << gpu->drmDevice()->path();
-                updateOutputs();
+                gpu->scheduleOutputUpdate();
             }
         }
     }
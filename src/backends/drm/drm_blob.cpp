@@ -32,11 +32,43 @@ uint32_t DrmBlob::blobId() const
 
 std::shared_ptr<DrmBlob> DrmBlob::create(DrmGpu *gpu, const void *data, uint32_t dataSize)
 {
+    return gpu->blobCache()->create(gpu, data, dataSize);
+}
+
+// Big enough for the color pipelines and modes of a few outputs
+static const size_t s_blobCacheSize = 32;
+
+std::shared_ptr<DrmBlob> DrmBlobCache::create(DrmGpu *gpu, const void *data, uint32_t dataSize)
+{
+    const QByteArrayView contents(static_cast<const char *>(data), dataSize);
+    const size_t hash = qHash(contents);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->hash == hash && it->data == contents) {
+            Entry entry = std::move(*it);
+            m_entries.erase(it);
+            m_entries.push_back(std::move(entry));
+            return m_entries.back().blob;
+        }
+    }
+
     uint32_t id = 0;
-    if (drmModeCreatePropertyBlob(gpu->fd(), data, dataSize, &id) == 0) {
-        return std::make_shared<DrmBlob>(gpu, id);
-    } else {
+    if (drmModeCreatePropertyBlob(gpu->fd(), data, dataSize, &id) != 0) {
         return nullptr;
     }
+    auto blob = std::make_shared<DrmBlob>(gpu, id);
+    if (m_entries.size() >= s_blobCacheSize) {
+        m_entries.pop_front();
+    }
+    m_entries.push_back(Entry{
+        .hash = hash,
+        .data = contents.toByteArray(),
+        .blob = blob,
+    });
+    return blob;
+}
+
+void DrmBlobCache::clear()
+{
+    m_entries.clear();
 }
 }
@@ -7,6 +7,9 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #pragma once
+#include <QByteArray>
+
+#include <deque>
 #include <memory>
 #include <stdint.h>
 
@@ -23,6 +26,9 @@ public:
 
     uint32_t blobId() const;
 
+    /**
+     * Returns a blob with the given contents, which may be shared with other users.
+     */
     static std::shared_ptr<DrmBlob> create(DrmGpu *gpu, const void *data, uint32_t dataSize);
 
 protected:
@@ -30,4 +36,27 @@ protected:
     const uint32_t m_blobId;
 };
 
+/**
+ * The DrmBlobCache class keeps the most recently created blobs of a gpu around, so that
+ * blobs with the same contents, like the LUTs of outputs with the same color settings or the
+ * ones of a color transition going back and forth, are shared rather than created again.
+ */
+class DrmBlobCache
+{
+public:
+    std::shared_ptr<DrmBlob> create(DrmGpu *gpu, const void *data, uint32_t dataSize);
+    void clear();
+
+private:
+    struct Entry
+    {
+        size_t hash;
+        QByteArray data;
+        std::shared_ptr<DrmBlob> blob;
+    };
+
+    // sorted from the least to the most recently used one
+    std::deque<Entry> m_entries;
+};
+
 }
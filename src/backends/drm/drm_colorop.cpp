@@ -13,6 +13,7 @@
 #include "drm_object.h"
 #include "utils/envvar.h"
 
+#include <algorithm>
 #include <ranges>
 
 namespace KWin
@@ -51,6 +52,15 @@ QString DrmAbstractColorOp::name() const
     return m_name;
 }
 
+std::shared_ptr<DrmBlob> DrmAbstractColorOp::cachedBlob(std::span<const ColorOp::Operation> operations, const std::function<std::shared_ptr<DrmBlob>()> &create)
+{
+    if (!m_blob || !std::ranges::equal(operations, m_blobOperations)) {
+        m_blob = create();
+        m_blobOperations.assign(operations.begin(), operations.end());
+    }
+    return m_blob;
+}
+
 bool DrmAbstractColorOp::matchPipeline(DrmAtomicCommit *commit, const ColorPipeline &pipeline)
 {
     if (m_cachedPipeline && *m_cachedPipeline == pipeline) {
@@ -68,6 +78,53 @@ bool DrmAbstractColorOp::matchPipeline(DrmAtomicCommit *commit, const ColorPipel
         return true;
     }
 
+    // first, only check if the pipeline can be programmed in the first place
+    // don't calculate LUTs just yet
+    const auto assignments = assign(pipeline);
+    if (!assignments) {
+        return false;
+    }
+
+    // now actually program the properties
+    m_cache = std::make_unique<DrmAtomicCommit>(commit->gpu());
+    DrmAbstractColorOp *currentOp = this;
+    while (currentOp) {
+        const auto it = assignments->find(currentOp);
+        if (it != assignments->end()) {
+            const auto &[op, program] = *it;
+            currentOp->program(m_cache.get(), program);
+        } else {
+            currentOp->bypass(m_cache.get());
+        }
+        currentOp = currentOp->next();
+    }
+    commit->merge(m_cache.get());
+    m_cachedPipeline = pipeline;
+    return true;
+}
+
+bool DrmAbstractColorOp::canProgram(const ColorPipeline &pipeline)
+{
+    if (pipeline.isIdentity() || (m_cachedPipeline && *m_cachedPipeline == pipeline)) {
+        return true;
+    }
+    return assign(pipeline).has_value();
+}
+
+std::optional<DrmAbstractColorOp::Assignments> DrmAbstractColorOp::assign(const ColorPipeline &pipeline)
+{
+    if (m_cachedPipelineFail && *m_cachedPipelineFail == pipeline) {
+        return std::nullopt;
+    }
+    auto ret = doAssign(pipeline);
+    if (!ret) {
+        m_cachedPipelineFail = pipeline;
+    }
+    return ret;
+}
+
+std::optional<DrmAbstractColorOp::Assignments> DrmAbstractColorOp::doAssign(const ColorPipeline &pipeline)
+{
     DrmAbstractColorOp *currentOp = this;
     const auto needsLimitedRange = [](const ColorOp &op) {
         // KMS LUTs have an input and output range of [0, 1]
@@ -75,10 +132,7 @@ bool DrmAbstractColorOp::matchPipeline(DrmAtomicCommit *commit, const ColorPipel
             || std::holds_alternative<InverseColorTransferFunction>(op.operation);
     };
 
-    // first, only check if the pipeline can be programmed in the first place
-    // don't calculate LUTs just yet
-
-    std::unordered_map<DrmAbstractColorOp *, std::vector<ColorOp::Operation>> assignments;
+    Assignments assignments;
 
     double valueScaling = 1;
     if (!pipeline.ops.empty() && needsLimitedRange(pipeline.ops.front()) && pipeline.ops.front().input.max > 1) {
@@ -95,7 +149,7 @@ bool DrmAbstractColorOp::matchPipeline(DrmAtomicCommit *commit, const ColorPipel
             currentOp = currentOp->next();
         }
         if (!currentOp) {
-            return false;
+            return std::nullopt;
         }
         assignments[currentOp].push_back(initialOp.operation);
     }
@@ -105,7 +159,7 @@ bool DrmAbstractColorOp::matchPipeline(DrmAtomicCommit *commit, const ColorPipel
             currentOp = currentOp->next();
         }
         if (!currentOp) {
-            return false;
+            return std::nullopt;
         }
         auto &hwOps = assignments[currentOp];
         if (valueScaling != 1) {
@@ -122,24 +176,19 @@ bool DrmAbstractColorOp::matchPipeline(DrmAtomicCommit *commit, const ColorPipel
         }
         ops = ops.subspan(1);
     }
+    return assignments;
+}
 
-    // now actually program the properties
-    currentOp = this;
-    m_cache = std::make_unique<DrmAtomicCommit>(commit->gpu());
-    currentOp = this;
-    while (currentOp) {
-        const auto it = assignments.find(currentOp);
-        if (it != assignments.end()) {
-            const auto &[op, program] = *it;
-            currentOp->program(m_cache.get(), program);
-        } else {
-            currentOp->bypass(m_cache.get());
-        }
-        currentOp = currentOp->next();
+static std::vector<QVector3D> sample1DLut(std::span<const ColorOp::Operation> operations, uint32_t size)
+{
+    std::vector<QVector3D> ret;
+    ret.reserve(size);
+    for (uint32_t i = 0; i < size; i++) {
+        const double input = i / double(size - 1);
+        ret.emplace_back(input, input, input);
     }
-    commit->merge(m_cache.get());
-    m_cachedPipeline = pipeline;
-    return true;
+    ColorOp::applyOperations(operations, ret);
+    return ret;
 }
 
 DrmLutColorOp16::DrmLutColorOp16(DrmAbstractColorOp *next, DrmProperty *prop, DrmEnumProperty<Lut1DInterpolation> *interpolation, uint32_t maxSize, DrmProperty *bypass)
@@ -172,20 +221,19 @@ bool DrmLutColorOp16::canBeUsedFor(const ColorOp &op, bool normalizedInput)
 
 void DrmLutColorOp16::program(DrmAtomicCommit *commit, std::span<const ColorOp::Operation> operations)
 {
-    for (uint32_t i = 0; i < m_maxSize; i++) {
-        const double input = i / double(m_maxSize - 1);
-        QVector3D output(input, input, input);
-        for (const auto &op : operations) {
-            output = ColorOp::applyOperation(op, output);
+    commit->addBlob(*m_prop, cachedBlob(operations, [this, operations]() {
+        const std::vector<QVector3D> outputs = sample1DLut(operations, m_maxSize);
+        for (uint32_t i = 0; i < m_maxSize; i++) {
+            const QVector3D &output = outputs[i];
+            m_components[i] = {
+                .red = uint16_t(std::round(std::clamp(output.x(), 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max())),
+                .green = uint16_t(std::round(std::clamp(output.y(), 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max())),
+                .blue = uint16_t(std::round(std::clamp(output.z(), 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max())),
+                .reserved = 0,
+            };
         }
-        m_components[i] = {
-            .red = uint16_t(std::round(std::clamp(output.x(), 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max())),
-            .green = uint16_t(std::round(std::clamp(output.y(), 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max())),
-            .blue = uint16_t(std::round(std::clamp(output.z(), 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max())),
-            .reserved = 0,
-        };
-    }
-    commit->addBlob(*m_prop, DrmBlob::create(m_prop->drmObject()->gpu(), m_components.data(), sizeof(drm_color_lut) * m_maxSize));
+        return DrmBlob::create(m_prop->drmObject()->gpu(), m_components.data(), sizeof(drm_color_lut) * m_maxSize);
+    }));
     if (m_bypass) {
         commit->addProperty(*m_bypass, 0);
     }
@@ -229,20 +277,19 @@ bool DrmLutColorOp32::canBeUsedFor(const ColorOp &op, bool normalizedInput)
 
 void DrmLutColorOp32::program(DrmAtomicCommit *commit, std::span<const ColorOp::Operation> operations)
 {
-    for (uint32_t i = 0; i < m_maxSize; i++) {
-        const double input = i / double(m_maxSize - 1);
-        QVector3D output(input, input, input);
-        for (const auto &op : operations) {
-            output = ColorOp::applyOperation(op, output);
+    commit->addBlob(*m_prop, cachedBlob(operations, [this, operations]() {
+        const std::vector<QVector3D> outputs = sample1DLut(operations, m_maxSize);
+        for (uint32_t i = 0; i < m_maxSize; i++) {
+            const QVector3D &output = outputs[i];
+            m_components[i] = {
+                .red = uint32_t(std::round(std::clamp<double>(output.x(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
+                .green = uint32_t(std::round(std::clamp<double>(output.y(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
+                .blue = uint32_t(std::round(std::clamp<double>(output.z(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
+                .reserved = 0,
+            };
         }
-        m_components[i] = {
-            .red = uint32_t(std::round(std::clamp<double>(output.x(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
-            .green = uint32_t(std::round(std::clamp<double>(output.y(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
-            .blue = uint32_t(std::round(std::clamp<double>(output.z(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
-            .reserved = 0,
-        };
-    }
-    commit->addBlob(*m_prop, DrmBlob::create(m_prop->drmObject()->gpu(), m_components.data(), sizeof(LutComponent32) * m_maxSize));
+        return DrmBlob::create(m_prop->drmObject()->gpu(), m_components.data(), sizeof(LutComponent32) * m_maxSize);
+    }));
     if (m_bypass) {
         commit->addProperty(*m_bypass, 0);
     }
@@ -401,24 +448,29 @@ DrmLut3DColorOp::DrmLut3DColorOp(DrmAbstractColorOp *next, DrmProperty *value, D
 
 void DrmLut3DColorOp::program(DrmAtomicCommit *commit, std::span<const ColorOp::Operation> operations)
 {
-    for (size_t r = 0; r < m_size; r++) {
-        for (size_t g = 0; g < m_size; g++) {
-            for (size_t b = 0; b < m_size; b++) {
-                QVector3D output = QVector3D(r, g, b) / float(m_size - 1);
-                for (const auto &op : operations) {
-                    output = ColorOp::applyOperation(op, output);
+    commit->addBlob(*m_value, cachedBlob(operations, [this, operations]() {
+        // The entries are ordered with red being the innermost dimension
+        std::vector<QVector3D> outputs;
+        outputs.reserve(m_components.size());
+        for (size_t b = 0; b < m_size; b++) {
+            for (size_t g = 0; g < m_size; g++) {
+                for (size_t r = 0; r < m_size; r++) {
+                    outputs.push_back(QVector3D(r, g, b) / float(m_size - 1));
                 }
-                const size_t index = b * m_size * m_size + g * m_size + r;
-                m_components[index] = LutComponent32{
-                    .red = uint32_t(std::round(std::clamp<double>(output.x(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
-                    .green = uint32_t(std::round(std::clamp<double>(output.y(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
-                    .blue = uint32_t(std::round(std::clamp<double>(output.z(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
-                    .reserved = 0,
-                };
             }
         }
-    }
-    commit->addBlob(*m_value, DrmBlob::create(m_value->drmObject()->gpu(), m_components.data(), m_components.size() * sizeof(LutComponent32)));
+        ColorOp::applyOperations(operations, outputs);
+        for (size_t i = 0; i < outputs.size(); i++) {
+            const QVector3D &output = outputs[i];
+            m_components[i] = LutComponent32{
+                .red = uint32_t(std::round(std::clamp<double>(output.x(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
+                .green = uint32_t(std::round(std::clamp<double>(output.y(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
+                .blue = uint32_t(std::round(std::clamp<double>(output.z(), 0.0, 1.0) * std::numeric_limits<uint32_t>::max())),
+                .reserved = 0,
+            };
+        }
+        return DrmBlob::create(m_value->drmObject()->gpu(), m_components.data(), m_components.size() * sizeof(LutComponent32));
+    }));
     if (m_bypass) {
         commit->addProperty(*m_bypass, 0);
     }
@@ -13,8 +13,12 @@
 #include <QObject>
 #include <deque>
 #include <drm.h>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <span>
+#include <unordered_map>
+#include <vector>
 
 namespace KWin
 {
@@ -42,6 +46,11 @@ public:
     virtual ~DrmAbstractColorOp();
 
     bool matchPipeline(DrmAtomicCommit *commit, const ColorPipeline &pipeline);
+    /**
+     * Returns whether matchPipeline() can succeed for the @a pipeline, without computing any
+     * of the properties.
+     */
+    bool canProgram(const ColorPipeline &pipeline);
     virtual void program(DrmAtomicCommit *commit, std::span<const ColorOp::Operation> operations) = 0;
     virtual void bypass(DrmAtomicCommit *commit) = 0;
     virtual bool canBeUsedFor(const ColorOp &op, bool normalizedInput) = 0;
@@ -52,6 +61,19 @@ public:
     QString name() const;
 
 protected:
+    using Assignments = std::unordered_map<DrmAbstractColorOp *, std::vector<ColorOp::Operation>>;
+
+    std::optional<Assignments> assign(const ColorPipeline &pipeline);
+    std::optional<Assignments> doAssign(const ColorPipeline &pipeline);
+
+    /**
+     * Returns the blob that has been created for the same @a operations last time, or creates
+     * a new one with @a create. Parts of the pipeline that stay the same when another one
+     * changes, like the transfer functions around the night light matrix, are then neither
+     * computed nor uploaded again.
+     */
+    std::shared_ptr<DrmBlob> cachedBlob(std::span<const ColorOp::Operation> operations, const std::function<std::shared_ptr<DrmBlob>()> &create);
+
     DrmAbstractColorOp *const m_next;
     const Features m_features;
     const QString m_name;
@@ -59,6 +81,9 @@ protected:
     std::optional<ColorPipeline> m_cachedPipeline;
     std::optional<ColorPipeline> m_cachedPipelineFail;
     std::unique_ptr<DrmAtomicCommit> m_cache;
+
+    std::vector<ColorOp::Operation> m_blobOperations;
+    std::shared_ptr<DrmBlob> m_blob;
 };
 
 enum class Lut1DInterpolation {
@@ -25,6 +25,9 @@ using namespace std::chrono_literals;
 namespace KWin
 {
 
+// drivers walk the clips one by one, past this many a single bounding rect is cheaper
+static constexpr int s_maxDamageClips = 16;
+
 DrmCommit::DrmCommit(DrmGpu *gpu)
     : m_gpu(gpu)
 {
@@ -45,6 +48,12 @@ void DrmCommit::setDefunct()
     m_defunct = true;
 }
 
+bool DrmCommit::pageflipEventReceived()
+{
+    Q_ASSERT(m_pendingPageflipEvents > 0);
+    return --m_pendingPageflipEvents == 0;
+}
+
 DrmAtomicCommit::DrmAtomicCommit(DrmGpu *gpu)
     : DrmCommit(gpu)
 {
@@ -91,6 +100,26 @@ void DrmAtomicCommit::addBuffer(DrmPlane *plane, const std::shared_ptr<DrmFrameb
     }
 }
 
+void DrmAtomicCommit::addDamageClips(DrmPlane *plane, const QRegion &damage)
+{
+    if (!plane->fbDamageClips.isValid() || damage.isEmpty()) {
+        return;
+    }
+    std::vector<drm_mode_rect> clips;
+    if (damage.rectCount() > s_maxDamageClips) {
+        const QRect bounds = damage.boundingRect();
+        clips.push_back(drm_mode_rect{bounds.left(), bounds.top(), bounds.right() + 1, bounds.bottom() + 1});
+    } else {
+        clips.reserve(damage.rectCount());
+        for (const QRect &rect : damage) {
+            clips.push_back(drm_mode_rect{rect.left(), rect.top(), rect.right() + 1, rect.bottom() + 1});
+        }
+    }
+    if (auto blob = DrmBlob::create(m_gpu, clips.data(), sizeof(drm_mode_rect) * clips.size())) {
+        addBlob(plane->fbDamageClips, blob);
+    }
+}
+
 void DrmAtomicCommit::setVrr(DrmCrtc *crtc, bool vrr)
 {
     addProperty(crtc->vrrEnabled, vrr ? 1 : 0);
@@ -122,7 +151,39 @@ bool DrmAtomicCommit::commit()
     if (isTearing()) {
         flags |= DRM_MODE_PAGE_FLIP_ASYNC;
     }
-    return doCommit(flags);
+    // commits of synchronized outputs contain multiple CRTCs, one per pipeline
+    m_pendingPageflipEvents = std::max<uint32_t>(1, m_pipelines.size());
+    // the out fences signal once the new state is latched, that is when the buffers this commit
+    // replaces aren't read anymore. They're only requested for this very ioctl, as the pointers
+    // would be dangling in commits that get merged or copied from this one
+    const bool requestOutFences = !isTearing() && !m_pipelines.isEmpty() && std::ranges::all_of(m_pipelines, [](DrmPipeline *pipeline) {
+        return pipeline->crtc() && pipeline->crtc()->outFencePtr.isValid();
+    });
+    std::vector<int32_t> outFences(requestOutFences ? m_pipelines.size() : 0, -1);
+    for (size_t i = 0; i < outFences.size(); i++) {
+        addProperty(m_pipelines[i]->crtc()->outFencePtr, reinterpret_cast<uint64_t>(&outFences[i]));
+    }
+    const bool success = doCommit(flags);
+    for (size_t i = 0; i < outFences.size(); i++) {
+        const auto &property = m_pipelines[i]->crtc()->outFencePtr;
+        m_properties[property.drmObject()->id()].erase(property.propId());
+    }
+    if (!success) {
+        return false;
+    }
+    m_outFences.clear();
+    for (int32_t fd : outFences) {
+        if (fd >= 0) {
+            m_outFences.emplace_back(fd);
+        }
+    }
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto &[plane, frame] : m_frames) {
+        if (frame) {
+            frame->setCommitTime(now);
+        }
+    }
+    return true;
 }
 
 bool DrmAtomicCommit::commitModeset()
@@ -187,7 +248,9 @@ void DrmAtomicCommit::pageFlipped(std::chrono::nanoseconds timestamp)
         frame->presented(timestamp, m_mode);
     }
     m_frames.clear();
-    for (const auto pipeline : std::as_const(m_pipelines)) {
+    // DrmPipeline::pageFlipped may delete this commit
+    const auto pipelines = m_pipelines;
+    for (const auto pipeline : pipelines) {
         pipeline->pageFlipped(timestamp);
     }
 }
@@ -221,6 +284,12 @@ const std::unordered_set<DrmPlane *> &DrmAtomicCommit::modifiedPlanes() const
 
 void DrmAtomicCommit::merge(DrmAtomicCommit *onTop)
 {
+    std::vector<DrmPlane *> replacedBuffers;
+    for (const auto &[plane, buffer] : onTop->m_buffers) {
+        if (plane->fbDamageClips.isValid() && m_buffers.contains(plane)) {
+            replacedBuffers.push_back(plane);
+        }
+    }
     for (const auto &[obj, properties] : onTop->m_properties) {
         auto &ownProperties = m_properties[obj];
         for (const auto &[prop, value] : properties) {
@@ -235,6 +304,11 @@ void DrmAtomicCommit::merge(DrmAtomicCommit *onTop)
     for (const auto &[prop, blob] : onTop->m_blobs) {
         m_blobs[prop] = blob;
     }
+    for (DrmPlane *plane : replacedBuffers) {
+        // the damage of either commit alone is less than what changed compared
+        // to the buffer on the screen, fall back to full damage
+        addBlob(plane->fbDamageClips, nullptr);
+    }
     if (onTop->m_vrr) {
         m_vrr = onTop->m_vrr;
     }
@@ -243,6 +317,11 @@ void DrmAtomicCommit::merge(DrmAtomicCommit *onTop)
     } else if (onTop->m_targetPageflipTime) {
         *m_targetPageflipTime = std::min(*m_targetPageflipTime, *onTop->m_targetPageflipTime);
     }
+    for (const auto pipeline : std::as_const(onTop->m_pipelines)) {
+        if (!m_pipelines.contains(pipeline)) {
+            m_pipelines.push_back(pipeline);
+        }
+    }
     if (m_allowedVrrDelay && onTop->m_allowedVrrDelay) {
         *m_allowedVrrDelay = std::min(*m_allowedVrrDelay, *onTop->m_allowedVrrDelay);
     } else {
@@ -250,6 +329,16 @@ void DrmAtomicCommit::merge(DrmAtomicCommit *onTop)
     }
 }
 
+void DrmAtomicCommit::removePipeline(DrmPipeline *pipeline)
+{
+    m_pipelines.removeOne(pipeline);
+}
+
+const QList<DrmPipeline *> &DrmAtomicCommit::pipelines() const
+{
+    return m_pipelines;
+}
+
 void DrmAtomicCommit::setAllowedVrrDelay(std::optional<std::chrono::nanoseconds> allowedDelay)
 {
     m_allowedVrrDelay = allowedDelay;
@@ -276,6 +365,31 @@ bool DrmAtomicCommit::isTearing() const
     return m_mode == PresentationMode::Async || m_mode == PresentationMode::AdaptiveAsync;
 }
 
+void DrmAtomicCommit::releaseReplacedBuffers()
+{
+    Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+    if (m_outFences.empty() || m_defunct) {
+        return;
+    }
+    for (const auto &[plane, buffer] : m_buffers) {
+        const auto replaced = plane->currentBuffer();
+        // once the pageflip has been processed, the plane already shows the new buffer
+        if (!replaced || replaced == buffer || !replaced->buffer()) {
+            continue;
+        }
+        // a client that doesn't use explicit sync would consider the buffer free
+        // to be written into immediately, so it has to be kept until the pageflip
+        if (!replaced->buffer()->hasReleasePoints()) {
+            continue;
+        }
+        for (const FileDescriptor &fence : m_outFences) {
+            replaced->buffer()->addReleaseFence(fence);
+        }
+        replaced->releaseBuffer();
+    }
+    m_outFences.clear();
+}
+
 DrmLegacyCommit::DrmLegacyCommit(DrmPipeline *pipeline, const std::shared_ptr<DrmFramebuffer> &buffer, const std::shared_ptr<OutputFrame> &frame)
     : DrmCommit(pipeline->gpu())
     , m_pipeline(pipeline)
@@ -303,7 +417,13 @@ bool DrmLegacyCommit::doPageflip(PresentationMode mode)
     if (mode == PresentationMode::Async || mode == PresentationMode::AdaptiveAsync) {
         flags |= DRM_MODE_PAGE_FLIP_ASYNC;
     }
-    return drmModePageFlip(gpu()->fd(), m_crtc->id(), m_buffer->framebufferId(), flags, this) == 0;
+    if (drmModePageFlip(gpu()->fd(), m_crtc->id(), m_buffer->framebufferId(), flags, this) != 0) {
+        return false;
+    }
+    if (m_frame) {
+        m_frame->setCommitTime(std::chrono::steady_clock::now());
+    }
+    return true;
 }
 
 void DrmLegacyCommit::pageFlipped(std::chrono::nanoseconds timestamp)
@@ -12,13 +12,16 @@
 #include <xf86drmMode.h>
 
 #include <QHash>
+#include <QRegion>
 #include <chrono>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "core/renderloop.h"
 #include "drm_pointer.h"
 #include "drm_property.h"
+#include "utils/filedescriptor.h"
 
 namespace KWin
 {
@@ -43,11 +46,18 @@ public:
     virtual void pageFlipped(std::chrono::nanoseconds timestamp) = 0;
     void setDefunct();
 
+    /**
+     * The kernel sends one pageflip event for each CRTC in a commit
+     * @returns true if this event was the last one the commit still waited for
+     */
+    bool pageflipEventReceived();
+
 protected:
     DrmCommit(DrmGpu *gpu);
 
     DrmGpu *const m_gpu;
     bool m_defunct = false;
+    uint32_t m_pendingPageflipEvents = 1;
 };
 
 class DrmAtomicCommit : public DrmCommit
@@ -65,6 +75,11 @@ public:
     }
     void addBlob(const DrmProperty &prop, const std::shared_ptr<DrmBlob> &blob);
     void addBuffer(DrmPlane *plane, const std::shared_ptr<DrmFramebuffer> &buffer, const std::shared_ptr<OutputFrame> &frame);
+    /**
+     * Tells the driver which part of the buffer on @p plane differs from the previous one, in buffer
+     * coordinates. Does nothing if the plane doesn't support FB_DAMAGE_CLIPS or @p damage is empty
+     */
+    void addDamageClips(DrmPlane *plane, const QRegion &damage);
     void setVrr(DrmCrtc *crtc, bool vrr);
     void setPresentationMode(PresentationMode mode);
 
@@ -81,6 +96,11 @@ public:
     const std::unordered_set<DrmPlane *> &modifiedPlanes() const;
 
     void merge(DrmAtomicCommit *onTop);
+    /**
+     * Makes the commit not call into @p pipeline anymore once its pageflip is done
+     */
+    void removePipeline(DrmPipeline *pipeline);
+    const QList<DrmPipeline *> &pipelines() const;
 
     void setAllowedVrrDelay(std::optional<std::chrono::nanoseconds> allowedDelay);
     std::optional<std::chrono::nanoseconds> allowedVrrDelay() const;
@@ -89,10 +109,18 @@ public:
     bool isReadyFor(std::chrono::steady_clock::time_point pageflipTarget) const;
     bool isTearing() const;
 
+    /**
+     * Adds the out fence of this commit to the release points of the client buffers it
+     * replaces and drops the references to them, so that the clients can reuse them as
+     * soon as the display engine stops reading them instead of once the pageflip event
+     * has been processed. Must be called on the main thread while the commit is pending.
+     */
+    void releaseReplacedBuffers();
+
 private:
     bool doCommit(uint32_t flags);
 
-    const QList<DrmPipeline *> m_pipelines;
+    QList<DrmPipeline *> m_pipelines;
     std::optional<std::chrono::steady_clock::time_point> m_targetPageflipTime;
     std::optional<std::chrono::nanoseconds> m_allowedVrrDelay;
     std::unordered_map<const DrmProperty *, std::shared_ptr<DrmBlob>> m_blobs;
@@ -103,6 +131,7 @@ private:
     std::unordered_map<uint32_t /* object */, std::unordered_map<uint32_t /* property */, uint64_t /* value */>> m_properties;
     bool m_modeset = false;
     PresentationMode m_mode = PresentationMode::VSync;
+    std::vector<FileDescriptor> m_outFences;
 };
 
 class DrmLegacyCommit : public DrmCommit
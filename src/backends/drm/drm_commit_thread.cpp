@@ -10,20 +10,35 @@
 #include "drm_commit.h"
 #include "drm_gpu.h"
 #include "drm_logging.h"
+#include "ftrace.h"
+#include "tracing.h"
 #include "utils/envvar.h"
+#include "utils/framecounters.h"
 #include "utils/realtime.h"
 
 #include <ranges>
 #include <span>
 #include <thread>
+#include <xf86drm.h>
 
 using namespace std::chrono_literals;
 
 namespace KWin
 {
 
+/**
+ * Limits how often tearing commits may flip, in flips per second. Zero means no limit
+ */
+static const uint32_t s_maxTearingFlipRate = std::max(environmentVariableIntValue("KWIN_DRM_TEARING_MAX_FLIP_RATE").value_or(0), 0);
+/**
+ * Tearing commits that would flip less than this long before the next vblank wait for it
+ * instead, which moves the tear line from the bottom of the screen into the blanking period
+ */
+static const std::chrono::microseconds s_tearingVblankSnap{environmentVariableIntValue("KWIN_DRM_TEARING_VBLANK_SNAP_US").value_or(0)};
+
 DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
     : m_gpu(gpu)
+    , m_name(name)
     , m_targetPageflipTime(std::chrono::steady_clock::now())
 {
     if (!gpu->atomicModeSetting()) {
@@ -64,6 +79,7 @@ DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
                         }
                         qCCritical(KWIN_DRM, "With the output of 'sudo dmesg' and 'journalctl --user-unit plasma-kwin_wayland --boot 0'");
                         m_pageflipTimeoutDetected = true;
+                        reportMissedDeadline(MissedDeadlineReason::PageflipTimeout, DrmGpu::s_pageflipTimeout);
                     } else {
                         qCWarning(KWIN_DRM, "The main thread was hanging temporarily!");
                     }
@@ -91,6 +107,11 @@ DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
                 if (m_vrr || m_tearing) {
                     m_targetPageflipTime += 50us;
                 } else {
+                    const auto commitTarget = m_commits.front()->targetPageflipTime();
+                    if (!m_commits.front()->areBuffersReadable() && (!commitTarget || *commitTarget < m_targetPageflipTime + m_minVblankInterval / 2)) {
+                        // the commit was meant for this vblank, but rendering isn't done yet
+                        reportMissedDeadline(MissedDeadlineReason::FenceNotSignaled, m_minVblankInterval);
+                    }
                     m_targetPageflipTime += m_minVblankInterval;
                 }
                 continue;
@@ -131,6 +152,17 @@ DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
                     continue;
                 }
             }
+            if (m_tearing && m_commits.front()->isTearing() && s_tearingVblankSnap > 0us) {
+                const auto vblank = nextVblank();
+                if (vblank && *vblank - std::chrono::steady_clock::now() < s_tearingVblankSnap) {
+                    lock.unlock();
+                    std::this_thread::sleep_until(*vblank);
+                    lock.lock();
+                    if (m_commits.empty()) {
+                        continue;
+                    }
+                }
+            }
             submit();
         }
     }));
@@ -140,6 +172,7 @@ DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
 
 void DrmCommitThread::submit()
 {
+    traceScope(Drm, "commit");
     DrmAtomicCommit *commit = m_commits.front().get();
     const auto vrr = commit->isVrr();
     const bool success = commit->commit();
@@ -153,11 +186,13 @@ void DrmCommitThread::submit()
         // after we return from the commit ioctl, but we don't have any better
         // way to know when it's done
         m_lastCommitTime = std::chrono::steady_clock::now();
+        m_committedPageflipTarget = m_targetPageflipTime;
         // this is when we wanted to have completed the commit
         const auto targetTimestamp = m_targetPageflipTime - m_baseSafetyMargin;
         // this is how much safety we need to add or remove to achieve that next time
         const auto safetyDifference = targetTimestamp - m_lastCommitTime;
         if (safetyDifference < std::chrono::nanoseconds::zero()) {
+            reportMissedDeadline(MissedDeadlineReason::LateSubmission, -safetyDifference);
             // the commit was done later than desired, immediately add the
             // required difference to make sure that it doesn't happen again
             m_additionalSafetyMargin -= safetyDifference;
@@ -169,6 +204,14 @@ void DrmCommitThread::submit()
         const auto maximumReasonableMargin = std::min<std::chrono::nanoseconds>(3ms, m_minVblankInterval / 2);
         m_additionalSafetyMargin = std::clamp(m_additionalSafetyMargin, 0ns, maximumReasonableMargin);
         m_safetyMargin = m_baseSafetyMargin + m_additionalSafetyMargin;
+
+        // hand the buffers that this commit replaces back to their clients without waiting for the pageflip
+        QMetaObject::invokeMethod(this, [this, commit]() {
+            auto lock = FrameCounters::lock(m_mutex);
+            if (m_committed.get() == commit) {
+                commit->releaseReplacedBuffers();
+            }
+        }, Qt::ConnectionType::QueuedConnection);
     } else {
         if (m_commits.size() > 1) {
             // the failure may have been because of the reordering of commits
@@ -190,6 +233,8 @@ void DrmCommitThread::submit()
         }
         m_commits.clear();
         qCWarning(KWIN_DRM) << "atomic commit failed:" << strerror(errno);
+        reportMissedDeadline(MissedDeadlineReason::CommitRejected, std::chrono::nanoseconds::zero());
+        QMetaObject::invokeMethod(this, &DrmCommitThread::commitFailed, Qt::ConnectionType::QueuedConnection);
     }
     QMetaObject::invokeMethod(this, &DrmCommitThread::clearDroppedCommits, Qt::ConnectionType::QueuedConnection);
 }
@@ -316,7 +361,7 @@ DrmCommitThread::~DrmCommitThread()
 {
     if (m_thread) {
         {
-            std::unique_lock lock(m_mutex);
+            auto lock = FrameCounters::lock(m_mutex);
             m_thread->requestInterruption();
             m_commitPending.notify_all();
             m_ping = true;
@@ -332,12 +377,15 @@ DrmCommitThread::~DrmCommitThread()
 
 void DrmCommitThread::addCommit(std::unique_ptr<DrmAtomicCommit> &&commit)
 {
-    std::unique_lock lock(m_mutex);
+    auto lock = FrameCounters::lock(m_mutex);
     m_commits.push_back(std::move(commit));
     const auto now = std::chrono::steady_clock::now();
     TimePoint newTarget;
     if (m_tearing) {
         newTarget = now;
+        if (s_maxTearingFlipRate > 0) {
+            newTarget = std::max(newTarget, m_lastPageflip + std::chrono::nanoseconds(1'000'000'000) / s_maxTearingFlipRate);
+        }
     } else if (m_vrr && now >= m_lastPageflip + m_minVblankInterval) {
         newTarget = now;
     } else {
@@ -353,9 +401,30 @@ void DrmCommitThread::setPendingCommit(std::unique_ptr<DrmLegacyCommit> &&commit
     m_committed = std::move(commit);
 }
 
+void DrmCommitThread::removePipeline(DrmPipeline *pipeline)
+{
+    auto lock = FrameCounters::lock(m_mutex);
+    for (const auto &commit : m_commits) {
+        commit->removePipeline(pipeline);
+    }
+    // commits that were only for this pipeline aren't needed anymore
+    std::erase_if(m_commits, [](const auto &commit) {
+        return commit->pipelines().isEmpty();
+    });
+    if (m_committed && m_gpu->atomicModeSetting()) {
+        const auto committed = static_cast<DrmAtomicCommit *>(m_committed.get());
+        committed->removePipeline(pipeline);
+        if (committed->pipelines().isEmpty()) {
+            // no pipeline would notify us about the pageflip anymore
+            m_committed->setDefunct();
+            m_gpu->addDefunctCommit(std::move(m_committed));
+        }
+    }
+}
+
 void DrmCommitThread::clearDroppedCommits()
 {
-    std::unique_lock lock(m_mutex);
+    auto lock = FrameCounters::lock(m_mutex);
     m_commitsToDelete.clear();
 }
 
@@ -365,22 +434,74 @@ static const std::chrono::microseconds s_safetyMarginMinimum{environmentVariable
 
 void DrmCommitThread::setModeInfo(uint32_t maximum, std::chrono::nanoseconds vblankTime)
 {
-    std::unique_lock lock(m_mutex);
+    auto lock = FrameCounters::lock(m_mutex);
     m_minVblankInterval = std::chrono::nanoseconds(1'000'000'000'000ull / maximum);
     // the kernel rejects commits that happen during vblank
     // the 1.5ms on top of that was chosen experimentally, for the time it takes to commit + scheduling inaccuracies
     m_baseSafetyMargin = vblankTime + s_safetyMarginMinimum;
     m_safetyMargin = m_baseSafetyMargin + m_additionalSafetyMargin;
+    updateVrrHoldDuration();
+}
+
+void DrmCommitThread::setMinVrrRefreshRate(std::optional<uint32_t> refreshRateHz)
+{
+    auto lock = FrameCounters::lock(m_mutex);
+    m_minVrrRefreshRate = refreshRateHz;
+    updateVrrHoldDuration();
+}
+
+void DrmCommitThread::updateVrrHoldDuration()
+{
+    // stay a bit above the minimum refresh rate, so that slight timing differences don't
+    // make the display drop below it. The duration is a whole number of refresh cycles
+    // of the mode, which keeps the refresh rate of the display steady while holding and
+    // avoids the flicker that varying refresh rates cause on many panels
+    const uint32_t minimumRate = m_minVrrRefreshRate.value_or(30) + 2;
+    const auto longestInterval = std::chrono::nanoseconds(1'000'000'000) / minimumRate;
+    m_vrrHoldDuration = m_minVblankInterval * std::max<int64_t>(1, longestInterval / m_minVblankInterval);
+}
+
+void DrmCommitThread::setCrtcId(uint32_t crtcId)
+{
+    auto lock = FrameCounters::lock(m_mutex);
+    m_crtcId = crtcId;
+}
+
+std::optional<TimePoint> DrmCommitThread::nextVblank() const
+{
+    // with tearing, pageflip timestamps don't say anything about where the vblanks are
+    uint64_t sequence = 0;
+    uint64_t timestampNs = 0;
+    if (!m_crtcId || drmCrtcGetSequence(m_gpu->fd(), m_crtcId, &sequence, &timestampNs) != 0) {
+        return std::nullopt;
+    }
+    const TimePoint lastVblank{std::chrono::nanoseconds(timestampNs)};
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t vblanksSince = now >= lastVblank ? (now - lastVblank) / m_minVblankInterval : 0;
+    return lastVblank + m_minVblankInterval * (vblanksSince + 1);
+}
+
+std::chrono::nanoseconds DrmCommitThread::vrrHoldDuration() const
+{
+    auto lock = FrameCounters::lock(m_mutex);
+    return m_vrrHoldDuration;
 }
 
 void DrmCommitThread::pageFlipped(std::chrono::nanoseconds timestamp)
 {
-    std::unique_lock lock(m_mutex);
+    auto lock = FrameCounters::lock(m_mutex);
     if (m_pageflipTimeoutDetected) {
         qCCritical(KWIN_DRM, "Pageflip arrived after all, %lums after the commit", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_lastCommitTime).count());
         m_pageflipTimeoutDetected = false;
     }
     m_lastPageflip = TimePoint(timestamp);
+    if (m_committedPageflipTarget && !m_vrr && !m_tearing) {
+        const auto error = m_lastPageflip - *m_committedPageflipTarget;
+        if (std::chrono::abs(error) > m_minVblankInterval / 2) {
+            reportMissedDeadline(MissedDeadlineReason::VblankDrift, error);
+        }
+    }
+    m_committedPageflipTarget.reset();
     m_committed.reset();
     if (!m_commits.empty()) {
         m_targetPageflipTime = estimateNextVblank(std::chrono::steady_clock::now());
@@ -390,7 +511,7 @@ void DrmCommitThread::pageFlipped(std::chrono::nanoseconds timestamp)
 
 bool DrmCommitThread::pageflipsPending()
 {
-    std::unique_lock lock(m_mutex);
+    auto lock = FrameCounters::lock(m_mutex);
     return !m_commits.empty() || m_committed;
 }
 
@@ -406,11 +527,38 @@ std::chrono::nanoseconds DrmCommitThread::safetyMargin() const
     return m_safetyMargin;
 }
 
+static const char *reasonName(MissedDeadlineReason reason)
+{
+    switch (reason) {
+    case MissedDeadlineReason::LateSubmission:
+        return "late submission";
+    case MissedDeadlineReason::CommitRejected:
+        return "commit rejected";
+    case MissedDeadlineReason::FenceNotSignaled:
+        return "fence not signaled";
+    case MissedDeadlineReason::VblankDrift:
+        return "vblank drift";
+    case MissedDeadlineReason::PageflipTimeout:
+        return "pageflip timeout";
+    }
+    Q_UNREACHABLE();
+}
+
+void DrmCommitThread::reportMissedDeadline(MissedDeadlineReason reason, std::chrono::nanoseconds error)
+{
+    fTrace("Missed deadline (", m_name, "): ", reasonName(reason),
+           " error_us=", std::chrono::duration_cast<std::chrono::microseconds>(error).count(),
+           " safety_margin_us=", std::chrono::duration_cast<std::chrono::microseconds>(m_safetyMargin).count());
+    QMetaObject::invokeMethod(this, [this, reason]() {
+        Q_EMIT deadlineMissed(reason);
+    }, Qt::ConnectionType::QueuedConnection);
+}
+
 void DrmCommitThread::handlePing()
 {
     // this will process the pageflip and call pageFlipped if there is one
     m_gpu->dispatchEvents();
-    std::unique_lock lock(m_mutex);
+    auto lock = FrameCounters::lock(m_mutex);
     m_ping = true;
     m_pong.notify_one();
 }
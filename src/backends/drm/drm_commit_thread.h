@@ -8,6 +8,8 @@
 */
 #pragma once
 
+#include "core/renderjournal.h"
+
 #include <QObject>
 #include <QThread>
 #include <condition_variable>
@@ -21,6 +23,7 @@ class DrmGpu;
 class DrmCommit;
 class DrmAtomicCommit;
 class DrmLegacyCommit;
+class DrmPipeline;
 
 using TimePoint = std::chrono::steady_clock::time_point;
 
@@ -33,8 +36,23 @@ public:
 
     void addCommit(std::unique_ptr<DrmAtomicCommit> &&commit);
     void setPendingCommit(std::unique_ptr<DrmLegacyCommit> &&commit);
+    /**
+     * Makes the queued and pending commits not reference @p pipeline anymore.
+     * This is needed when multiple pipelines share one commit thread
+     */
+    void removePipeline(DrmPipeline *pipeline);
 
     void setModeInfo(uint32_t maximum, std::chrono::nanoseconds vblankTime);
+    void setMinVrrRefreshRate(std::optional<uint32_t> refreshRateHz);
+    /**
+     * Sets the crtc whose vblanks tearing commits are timed against, zero if there is none
+     */
+    void setCrtcId(uint32_t crtcId);
+    /**
+     * @returns how long a commit that doesn't change what's on the screen should hold the
+     *          current frame when VRR is active, to be used as its allowed VRR delay
+     */
+    std::chrono::nanoseconds vrrHoldDuration() const;
     void pageFlipped(std::chrono::nanoseconds timestamp);
     bool pageflipsPending();
     /**
@@ -43,24 +61,42 @@ public:
      */
     std::chrono::nanoseconds safetyMargin() const;
 
+Q_SIGNALS:
+    /**
+     * Emitted on the main thread when an atomic commit failed despite being tested before
+     */
+    void commitFailed();
+    /**
+     * Emitted on the main thread when a commit wasn't presented at the vblank it was meant for
+     */
+    void deadlineMissed(MissedDeadlineReason reason);
+
 private:
     void clearDroppedCommits();
     TimePoint estimateNextVblank(TimePoint now) const;
     void optimizeCommits(TimePoint pageflipTarget);
     void submit();
     void handlePing();
+    void reportMissedDeadline(MissedDeadlineReason reason, std::chrono::nanoseconds error);
+    void updateVrrHoldDuration();
+    std::optional<TimePoint> nextVblank() const;
 
     DrmGpu *const m_gpu;
+    const QString m_name;
     std::unique_ptr<DrmCommit> m_committed;
     std::vector<std::unique_ptr<DrmAtomicCommit>> m_commits;
     std::unique_ptr<QThread> m_thread;
-    std::mutex m_mutex;
+    mutable std::mutex m_mutex;
     std::condition_variable m_commitPending;
     std::condition_variable m_pong;
     TimePoint m_lastPageflip;
     TimePoint m_targetPageflipTime;
     TimePoint m_lastCommitTime;
+    std::optional<TimePoint> m_committedPageflipTarget;
     std::chrono::nanoseconds m_minVblankInterval;
+    std::optional<uint32_t> m_minVrrRefreshRate;
+    std::chrono::nanoseconds m_vrrHoldDuration{0};
+    uint32_t m_crtcId = 0;
     std::vector<std::unique_ptr<DrmAtomicCommit>> m_commitsToDelete;
     bool m_vrr = false;
     bool m_tearing = false;
@@ -164,9 +164,9 @@ DrmConnector::DrmConnector(DrmGpu *gpu, uint32_t connectorId)
 {
 }
 
-bool DrmConnector::init()
+bool DrmConnector::init(Probe &&probe)
 {
-    if (!updateProperties()) {
+    if (!updateProperties(std::move(probe))) {
         return false;
     }
 
@@ -247,18 +247,37 @@ BackendOutput::SubPixel DrmConnector::subpixel() const
     }
 }
 
-bool DrmConnector::updateProperties()
+DrmConnector::Probe DrmConnector::probe(int fd, uint32_t connectorId)
 {
-    if (auto connector = drmModeGetConnector(gpu()->fd(), id())) {
-        m_conn.reset(connector);
-    } else {
+    Probe ret;
+    ret.connector.reset(drmModeGetConnector(fd, connectorId));
+    if (!ret.connector) {
         qCWarning(KWIN_DRM) << "drmModeGetConnector() failed:" << strerror(errno);
     }
+    ret.properties = queryProperties(fd, connectorId, DRM_MODE_OBJECT_CONNECTOR);
+    if (const auto blobId = ret.properties.value(QByteArrayLiteral("EDID")); blobId && *blobId != 0) {
+        if (DrmUniquePtr<drmModePropertyBlobRes> blob{drmModeGetPropertyBlob(fd, *blobId)}) {
+            ret.edid = Edid(blob->data, blob->length);
+        }
+    }
+    return ret;
+}
+
+bool DrmConnector::updateProperties()
+{
+    return updateProperties(probe(gpu()->fd(), id()));
+}
+
+bool DrmConnector::updateProperties(Probe &&probe)
+{
+    if (probe.connector) {
+        m_conn = std::move(probe.connector);
+    }
 
     if (!m_conn) {
         return false;
     }
-    DrmPropertyList props = queryProperties();
+    DrmPropertyList props = std::move(probe.properties);
     crtcId.update(props);
     nonDesktop.update(props);
     dpms.update(props);
@@ -283,9 +302,8 @@ bool DrmConnector::updateProperties()
         return false;
     }
 
-    // parse edid
-    if (edidProp.immutableBlob()) {
-        m_edid = Edid(edidProp.immutableBlob()->data, edidProp.immutableBlob()->length);
+    if (probe.edid) {
+        m_edid = std::move(*probe.edid);
         if (!m_edid.isValid()) {
             qCWarning(KWIN_DRM) << "Couldn't parse EDID for connector" << this;
         }
@@ -52,9 +52,25 @@ class DrmConnector : public DrmObject
 public:
     DrmConnector(DrmGpu *gpu, uint32_t connectorId);
 
-    bool init();
+    /**
+     * The state of a connector as read from the kernel. Reading it makes the driver probe
+     * the connector, which can take a long time, so this is done on a worker thread on hotplug
+     */
+    struct Probe
+    {
+        DrmUniquePtr<drmModeConnector> connector;
+        DrmPropertyList properties;
+        /**
+         * The parsed EDID, std::nullopt if the connector has none
+         */
+        std::optional<Edid> edid;
+    };
+    static Probe probe(int fd, uint32_t connectorId);
+
+    bool init(Probe &&probe);
 
     bool updateProperties() override;
+    bool updateProperties(Probe &&probe);
     void disable(DrmAtomicCommit *commit) override;
 
     bool isCrtcSupported(DrmCrtc *crtc) const;
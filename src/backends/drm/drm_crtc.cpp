@@ -28,6 +28,7 @@ DrmCrtc::DrmCrtc(DrmGpu *gpu, uint32_t crtcId, int pipeIndex, DrmPlane *primaryP
     , degammaLut(this, QByteArrayLiteral("DEGAMMA_LUT"))
     , degammaLutSize(this, QByteArrayLiteral("DEGAMMA_LUT_SIZE"))
     , sharpnessStrength(this, QByteArrayLiteral("SHARPNESS_STRENGTH"))
+    , outFencePtr(this, QByteArrayLiteral("OUT_FENCE_PTR"))
     , m_crtc(drmModeGetCrtc(gpu->fd(), crtcId))
     , m_pipeIndex(pipeIndex)
     , m_primaryPlane(primaryPlane)
@@ -54,6 +55,7 @@ bool DrmCrtc::updateProperties()
     degammaLut.update(props);
     degammaLutSize.update(props);
     sharpnessStrength.update(props);
+    outFencePtr.update(props);
 
     if (!postBlendingPipeline) {
         DrmAbstractColorOp *next = nullptr;
@@ -52,22 +52,32 @@ EglGbmLayer::EglGbmLayer(EglGbmBackend *eglBackend, DrmGpu *gpu, DrmPlane::TypeI
 
 std::optional<OutputLayerBeginFrameInfo> EglGbmLayer::doBeginFrame()
 {
+    m_currentDamage.reset();
     m_scanoutBuffer.reset();
-    return m_surface.startRendering(targetRect().size(),
-                                    drmOutput()->transform().combine(OutputTransform::FlipY),
-                                    supportedDrmFormats(),
-                                    drmOutput()->blendingColor(),
-                                    drmOutput()->layerBlendingColor(),
-                                    drmOutput()->needsShadowBuffer() ? pipeline()->iccProfile() : nullptr,
-                                    drmOutput()->scale(),
-                                    drmOutput()->colorPowerTradeoff(),
-                                    drmOutput()->needsShadowBuffer(),
-                                    m_requiredAlphaBits);
+    auto ret = m_surface.startRendering(targetRect().size(),
+                                        drmOutput()->transform().combine(OutputTransform::FlipY),
+                                        supportedDrmFormats(),
+                                        drmOutput()->blendingColor(),
+                                        drmOutput()->layerBlendingColor(),
+                                        drmOutput()->needsShadowBuffer() ? pipeline()->iccProfile() : nullptr,
+                                        drmOutput()->scale(),
+                                        drmOutput()->colorPowerTradeoff(),
+                                        drmOutput()->needsShadowBuffer(),
+                                        m_requiredAlphaBits);
+    // if the buffer contents are unknown, what's on the screen may not be the previous frame either
+    m_fullDamage = !ret || ret->repaint == infiniteRegion();
+    return ret;
 }
 
 bool EglGbmLayer::doEndFrame(const QRegion &renderedDeviceRegion, const QRegion &damagedDeviceRegion, OutputFrame *frame)
 {
-    return m_surface.endRendering(damagedDeviceRegion, frame);
+    if (!m_surface.endRendering(damagedDeviceRegion, frame)) {
+        return false;
+    }
+    if (!m_fullDamage) {
+        m_currentDamage = m_surface.mapToBuffer(damagedDeviceRegion);
+    }
+    return true;
 }
 
 bool EglGbmLayer::preparePresentationTest()
@@ -76,12 +86,14 @@ bool EglGbmLayer::preparePresentationTest()
         return false;
     }
     m_scanoutBuffer.reset();
+    m_currentDamage.reset();
     return m_surface.renderTestBuffer(targetRect().size(), supportedDrmFormats(), drmOutput()->colorPowerTradeoff(), m_requiredAlphaBits) != nullptr;
 }
 
 bool EglGbmLayer::importScanoutBuffer(GraphicsBuffer *buffer, const std::shared_ptr<OutputFrame> &frame)
 {
     static const bool directScanoutDisabled = environmentVariableBoolValue("KWIN_DRM_NO_DIRECT_SCANOUT").value_or(false);
+    static const bool secondaryGpuScanout = environmentVariableBoolValue("KWIN_DRM_SECONDARY_GPU_SCANOUT").value_or(false);
     if (directScanoutDisabled) {
         return false;
     }
@@ -99,14 +111,20 @@ bool EglGbmLayer::importScanoutBuffer(GraphicsBuffer *buffer, const std::shared_
         return false;
     }
     if (gpu() != gpu()->platform()->primaryGpu()) {
-        // Disable direct scanout between GPUs, as
+        // Disable direct scanout between GPUs by default, as
         // - there are some significant driver bugs with direct scanout from other GPUs,
         //   like https://gitlab.freedesktop.org/drm/amd/-/issues/2075
         // - with implicit modifiers, direct scanout on secondary GPUs
         //   is also very unlikely to yield the correct results.
         // TODO once we know what buffer a GPU is meant for, loosen this check again
-        // Right now this just assumes all buffers are on the primary GPU
-        return false;
+        // Right now this just assumes all buffers are on the primary GPU, unless the user opts
+        // into trusting buffers with explicit modifiers. The scanout feedback of this layer
+        // asks clients to allocate them for this GPU, so e.g. a game rendered on the discrete
+        // GPU can be shown on its outputs without any copies over PCIe
+        const auto attrs = buffer->dmabufAttributes();
+        if (!secondaryGpuScanout || !attrs || attrs->modifier == DRM_FORMAT_MOD_INVALID) {
+            return false;
+        }
     }
     if (!m_colorPipeline.isIdentity() && drmOutput()->colorPowerTradeoff() == BackendOutput::ColorPowerTradeoff::PreferAccuracy) {
         return false;
@@ -121,6 +139,7 @@ bool EglGbmLayer::importScanoutBuffer(GraphicsBuffer *buffer, const std::shared_
         return false;
     }
     m_scanoutBuffer = gpu()->importBuffer(buffer, FileDescriptor{});
+    m_currentDamage.reset();
     if (m_scanoutBuffer) {
         m_surface.forgetDamage(); // TODO: Use absolute frame sequence numbers for indexing the DamageJournal. It's more flexible and less error-prone
     }
@@ -132,9 +151,24 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayer::currentBuffer() const
     return m_scanoutBuffer ? m_scanoutBuffer : m_surface.currentBuffer();
 }
 
+std::optional<QRegion> EglGbmLayer::currentBufferDamage() const
+{
+    return m_currentDamage;
+}
+
 void EglGbmLayer::releaseBuffers()
 {
     m_scanoutBuffer.reset();
+    m_currentDamage.reset();
     m_surface.destroyResources();
 }
+
+bool EglGbmLayer::canOffloadColorPipeline(const ColorPipeline &pipeline) const
+{
+    if (!m_plane) {
+        // the legacy API only has the gamma ramp of the crtc
+        return pipeline.isIdentity();
+    }
+    return m_plane->canProgramColorPipeline(pipeline);
+}
 }
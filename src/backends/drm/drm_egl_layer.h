@@ -33,13 +33,17 @@ public:
     bool doEndFrame(const QRegion &renderedDeviceRegion, const QRegion &damagedDeviceRegion, OutputFrame *frame) override;
     bool preparePresentationTest() override;
     std::shared_ptr<DrmFramebuffer> currentBuffer() const override;
+    std::optional<QRegion> currentBufferDamage() const override;
     void releaseBuffers() override;
+    bool canOffloadColorPipeline(const ColorPipeline &pipeline) const override;
 
 private:
     bool importScanoutBuffer(GraphicsBuffer *buffer, const std::shared_ptr<OutputFrame> &frame) override;
 
     EglGbmLayerSurface m_surface;
     std::shared_ptr<DrmFramebuffer> m_scanoutBuffer;
+    std::optional<QRegion> m_currentDamage;
+    bool m_fullDamage = true;
 };
 
 }
@@ -19,12 +19,15 @@
 #include "opengl/eglnativefence.h"
 #include "opengl/eglswapchain.h"
 #include "opengl/gllut.h"
+#include "opengl/glpassprofiler.h"
 #include "opengl/glrendertimequery.h"
 #include "opengl/icc_shader.h"
 #include "qpainter/qpainterswapchain.h"
 #include "utils/drm_format_helper.h"
 #include "utils/envvar.h"
 
+#include <QtConcurrentMap>
+#include <algorithm>
 #include <drm_fourcc.h>
 #include <errno.h>
 #include <gbm.h>
@@ -230,6 +233,7 @@ bool EglGbmLayerSurface::endRendering(const QRegion &damagedDeviceRegion, Output
         const QSize rotatedSize = mapping.map(m_surface->gbmSwapchain->size());
         const QRegion repaint = mapping.map(deviceRepaint & QRect(QPoint(), rotatedSize), rotatedSize);
 
+        GLPassScope passScope(u"color management");
         GLFramebuffer *fbo = m_surface->currentSlot->framebuffer();
         GLFramebuffer::pushFramebuffer(fbo);
         ShaderBinder binder = m_surface->iccShader ? ShaderBinder(m_surface->iccShader->shader()) : ShaderBinder(ShaderTrait::MapTexture | ShaderTrait::TransformColorspace);
@@ -264,7 +268,7 @@ bool EglGbmLayerSurface::endRendering(const QRegion &damagedDeviceRegion, Output
     if (!sourceFence.isValid() || s_forcePresentSync) {
         // llvmpipe doesn't do synchronization properly: https://gitlab.freedesktop.org/mesa/mesa/-/issues/9375
         // and NVidia doesn't support implicit sync
-        glFinish();
+        EglContext::finish();
     }
     m_surface->gbmSwapchain->release(m_surface->currentSlot, sourceFence.fileDescriptor().duplicate());
     const auto buffer = importBuffer(m_surface.get(), m_surface->currentSlot.get(), sourceFence.takeFileDescriptor(), frame, damagedDeviceRegion);
@@ -286,6 +290,22 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::currentBuffer() const
     return m_surface ? m_surface->currentFramebuffer : nullptr;
 }
 
+QRegion EglGbmLayerSurface::mapToBuffer(const QRegion &deviceRegion) const
+{
+    if (!m_surface || !m_surface->currentSlot) {
+        return QRegion();
+    }
+    return mapToBuffer(deviceRegion, m_surface->currentSlot->framebuffer()->colorAttachment()->contentTransform(), m_surface->gbmSwapchain->size());
+}
+
+QRegion EglGbmLayerSurface::mapToBuffer(const QRegion &deviceRegion, OutputTransform contentTransform, const QSize &bufferSize)
+{
+    // same as for painting the shadow buffer, the render target is y-flipped and rotated compared to the buffer
+    const auto mapping = contentTransform.combine(OutputTransform::FlipY);
+    const QSize rotatedSize = mapping.map(bufferSize);
+    return mapping.map(deviceRegion & QRect(QPoint(), rotatedSize), rotatedSize) & QRect(QPoint(), bufferSize);
+}
+
 const std::shared_ptr<ColorDescription> &EglGbmLayerSurface::colorDescription() const
 {
     if (m_surface) {
@@ -559,7 +579,7 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::doRenderTestBuffer(Surface *
 std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importBuffer(Surface *surface, EglSwapchainSlot *slot, FileDescriptor &&readFence, OutputFrame *frame, const QRegion &damagedDeviceRegion) const
 {
     if (surface->bufferTarget == BufferTarget::Dumb || surface->importMode == MultiGpuImportMode::DumbBuffer) {
-        return importWithCpu(surface, slot, frame);
+        return importWithCpu(surface, slot, frame, damagedDeviceRegion);
     } else if (surface->importMode == MultiGpuImportMode::Egl) {
         return importWithEgl(surface, slot, std::move(readFence), frame, damagedDeviceRegion);
     } else {
@@ -578,7 +598,7 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithEgl(Surface *surfa
     const auto display = m_eglBackend->displayForGpu(m_gpu);
     // older versions of the NVidia proprietary driver support neither implicit sync nor EGL_ANDROID_native_fence_sync
     if (!readFence.isValid() || !display->supportsNativeFence() || s_forceMGPUSync) {
-        glFinish();
+        EglContext::finish();
     }
 
     if (!surface->importContext->makeCurrent()) {
@@ -651,7 +671,7 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithEgl(Surface *surfa
     glFlush();
     EGLNativeFence endFence(display);
     if (!endFence.isValid() || s_forcePresentSync) {
-        glFinish();
+        EglContext::finish();
     }
     surface->importGbmSwapchain->release(slot, endFence.fileDescriptor().duplicate());
     if (frame) {
@@ -662,7 +682,41 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithEgl(Surface *surfa
     return m_gpu->importBuffer(slot->buffer(), endFence.takeFileDescriptor());
 }
 
-std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithCpu(Surface *surface, EglSwapchainSlot *source, OutputFrame *frame) const
+namespace
+{
+struct RowSpan
+{
+    int begin;
+    int end;
+};
+}
+
+// Copying smaller spans on other threads costs more than it saves
+static const qsizetype s_minimumThreadedCopySize = 1024 * 1024;
+static const int s_threadedCopyRows = 64;
+
+/**
+ * Returns the rows of a buffer with the given @a size that the @a region touches, sorted
+ * from top to bottom and merged where they overlap.
+ */
+static std::vector<RowSpan> rowSpans(const QRegion &region, const QSize &size)
+{
+    std::vector<RowSpan> ret;
+    for (const QRect &rect : region & QRect(QPoint(), size)) {
+        // the rects of a region are sorted by their y coordinate
+        if (!ret.empty() && rect.top() <= ret.back().end) {
+            ret.back().end = std::max(ret.back().end, rect.bottom() + 1);
+        } else {
+            ret.push_back(RowSpan{
+                .begin = rect.top(),
+                .end = rect.bottom() + 1,
+            });
+        }
+    }
+    return ret;
+}
+
+std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithCpu(Surface *surface, EglSwapchainSlot *source, OutputFrame *frame, const QRegion &damagedDeviceRegion) const
 {
     std::unique_ptr<CpuRenderTimeQuery> copyTime;
     if (frame) {
@@ -676,19 +730,53 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithCpu(Surface *surfa
     }
     const auto size = source->buffer()->size();
     const qsizetype srcStride = 4 * size.width();
+
+    // the dumb buffer still has the contents of the frame it was last used for, so only the
+    // rows that changed since then need to be read back
+    const QRegion deviceRepaint = damagedDeviceRegion | surface->importDamageJournal.accumulate(slot->age(), infiniteRegion());
+    surface->importDamageJournal.add(damagedDeviceRegion);
+    const auto mapping = source->texture()->contentTransform().combine(OutputTransform::FlipY);
+    const QSize rotatedSize = mapping.map(size);
+    const std::vector<RowSpan> spans = rowSpans(mapping.map(deviceRepaint & QRect(QPoint(), rotatedSize), rotatedSize), size);
+
     EglContext *context = m_eglBackend->openglContext();
     GLFramebuffer::pushFramebuffer(source->framebuffer());
     QImage *const dst = slot->view()->image();
     if (dst->bytesPerLine() == srcStride) {
-        context->glReadnPixels(0, 0, dst->width(), dst->height(), GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, dst->sizeInBytes(), dst->bits());
+        for (const RowSpan &span : spans) {
+            context->glReadnPixels(0, span.begin, dst->width(), span.end - span.begin, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, (span.end - span.begin) * srcStride, dst->scanLine(span.begin));
+        }
     } else {
         // there's padding, need to copy line by line
         if (surface->cpuCopyCache.size() != dst->size()) {
             surface->cpuCopyCache = QImage(dst->size(), QImage::Format_RGBA8888);
         }
-        context->glReadnPixels(0, 0, dst->width(), dst->height(), GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, surface->cpuCopyCache.sizeInBytes(), surface->cpuCopyCache.bits());
-        for (int i = 0; i < dst->height(); i++) {
-            std::memcpy(dst->scanLine(i), surface->cpuCopyCache.scanLine(i), srcStride);
+        qsizetype copySize = 0;
+        std::vector<RowSpan> chunks;
+        for (const RowSpan &span : spans) {
+            context->glReadnPixels(0, span.begin, dst->width(), span.end - span.begin, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, (span.end - span.begin) * srcStride, surface->cpuCopyCache.scanLine(span.begin));
+            copySize += (span.end - span.begin) * srcStride;
+            for (int row = span.begin; row < span.end; row += s_threadedCopyRows) {
+                chunks.push_back(RowSpan{
+                    .begin = row,
+                    .end = std::min(row + s_threadedCopyRows, span.end),
+                });
+            }
+        }
+        // QImage::scanLine() may detach, don't call it from the worker threads
+        uchar *const dstBits = dst->bits();
+        const qsizetype dstStride = dst->bytesPerLine();
+        const uchar *const cacheBits = surface->cpuCopyCache.constBits();
+        const qsizetype cacheStride = surface->cpuCopyCache.bytesPerLine();
+        const auto copyRows = [dstBits, dstStride, cacheBits, cacheStride, srcStride](const RowSpan &chunk) {
+            for (int i = chunk.begin; i < chunk.end; i++) {
+                std::memcpy(dstBits + i * dstStride, cacheBits + i * cacheStride, srcStride);
+            }
+        };
+        if (copySize >= s_minimumThreadedCopySize) {
+            QtConcurrent::blockingMap(chunks, copyRows);
+        } else {
+            std::ranges::for_each(chunks, copyRows);
         }
     }
     GLFramebuffer::popFramebuffer();
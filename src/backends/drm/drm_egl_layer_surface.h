@@ -61,6 +61,12 @@ public:
 
     std::shared_ptr<DrmFramebuffer> currentBuffer() const;
     const std::shared_ptr<ColorDescription> &colorDescription() const;
+    /**
+     * Maps @p deviceRegion from the render target of the last frame to the coordinates of the buffer that gets scanned out
+     */
+    QRegion mapToBuffer(const QRegion &deviceRegion) const;
+
+    static QRegion mapToBuffer(const QRegion &deviceRegion, OutputTransform contentTransform, const QSize &bufferSize);
 
 private:
     enum class MultiGpuImportMode {
@@ -115,7 +121,7 @@ private:
     std::shared_ptr<DrmFramebuffer> doRenderTestBuffer(Surface *surface) const;
     std::shared_ptr<DrmFramebuffer> importBuffer(Surface *surface, EglSwapchainSlot *source, FileDescriptor &&readFence, OutputFrame *frame, const QRegion &damagedDeviceRegion) const;
     std::shared_ptr<DrmFramebuffer> importWithEgl(Surface *surface, EglSwapchainSlot *source, FileDescriptor &&readFence, OutputFrame *frame, const QRegion &damagedDeviceRegion) const;
-    std::shared_ptr<DrmFramebuffer> importWithCpu(Surface *surface, EglSwapchainSlot *source, OutputFrame *frame) const;
+    std::shared_ptr<DrmFramebuffer> importWithCpu(Surface *surface, EglSwapchainSlot *source, OutputFrame *frame, const QRegion &damagedDeviceRegion) const;
 
     std::unique_ptr<Surface> m_surface;
     std::unique_ptr<Surface> m_oldSurface;
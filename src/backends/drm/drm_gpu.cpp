@@ -24,10 +24,13 @@
 #include "drm_output.h"
 #include "drm_pipeline.h"
 #include "drm_plane.h"
+#include "drm_test_thread.h"
 #include "drm_virtual_output.h"
 #include "utils/envvar.h"
 
 #include <QFile>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <algorithm>
 #include <cstdint>
 #include <drm_fourcc.h>
@@ -56,6 +59,31 @@ using namespace std::chrono_literals;
 namespace KWin
 {
 
+/**
+ * Connectors whose outputs should be presented in lockstep, for example for
+ * video walls made of genlocked displays. Outputs with the same refresh rate
+ * share one commit thread, so that their updates get merged into one atomic
+ * commit targeting the same vblank
+ */
+static const QStringList s_synchronizedConnectors = qEnvironmentVariable("KWIN_DRM_SYNCHRONIZED_OUTPUTS").split(QLatin1Char(','), Qt::SkipEmptyParts);
+
+static QThreadPool *probeThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(2);
+        pool->setObjectName(QStringLiteral("KWin connector probing"));
+        return pool;
+    }();
+    return pool;
+}
+
+struct DrmGpu::OutputProbe
+{
+    DrmUniquePtr<drmModeRes> resources;
+    std::unordered_map<uint32_t, DrmConnector::Probe> connectors;
+};
+
 DrmGpu::DrmGpu(DrmBackend *backend, int fd, std::unique_ptr<DrmDevice> &&device)
     : m_fd(fd)
     , m_drmDevice(std::move(device))
@@ -115,9 +143,28 @@ DrmGpu::DrmGpu(DrmBackend *backend, int fd, std::unique_ptr<DrmDevice> &&device)
 
     m_colorPipelineSupported = drmSetClientCap(fd, DRM_CLIENT_CAP_PLANE_COLOR_PIPELINE, 1) == 0;
 
+    if (m_atomicModeSetting) {
+        m_testThread = std::make_unique<DrmTestThread>();
+        if (!s_synchronizedConnectors.isEmpty()) {
+            m_synchronizedCommitThread = std::make_unique<DrmCommitThread>(this, QStringLiteral("synchronized outputs"));
+        }
+    }
+
     m_delayedModesetTimer.setInterval(0);
     m_delayedModesetTimer.setSingleShot(true);
     connect(&m_delayedModesetTimer, &QTimer::timeout, this, &DrmGpu::doModeset);
+    connect(&m_outputProbeWatcher, &QFutureWatcherBase::finished, this, [this]() {
+        if (!std::exchange(m_outputProbeSuperseded, false)) {
+            m_outputProbe = m_outputProbeWatcher.result();
+        }
+        if (std::exchange(m_outputProbeOutdated, false)) {
+            scheduleOutputUpdate();
+        }
+        if (m_outputProbe) {
+            // updating the outputs may delete this gpu
+            QTimer::singleShot(0, m_platform, &DrmBackend::updateOutputs);
+        }
+    });
     m_sharpnessSupported = std::ranges::all_of(m_crtcs, [](const std::unique_ptr<DrmCrtc> &crtc) {
         return crtc->sharpnessStrength.isValid();
     });
@@ -125,11 +172,15 @@ DrmGpu::DrmGpu(DrmBackend *backend, int fd, std::unique_ptr<DrmDevice> &&device)
 
 DrmGpu::~DrmGpu()
 {
+    m_outputProbeWatcher.waitForFinished();
+    m_testThread.reset();
+    m_synchronizedCommitThread.reset();
     removeOutputs();
     m_eglDisplay.reset();
     m_crtcs.clear();
     m_connectors.clear();
     m_planes.clear();
+    m_blobCache.clear();
     m_socketNotifier.reset();
     m_platform->session()->closeRestricted(m_fd);
 }
@@ -232,16 +283,49 @@ void DrmGpu::initDrmResources()
     }
 }
 
+std::shared_ptr<DrmGpu::OutputProbe> DrmGpu::probeOutputs(int fd)
+{
+    auto ret = std::make_shared<OutputProbe>();
+    ret->resources.reset(drmModeGetResources(fd));
+    if (!ret->resources) {
+        qCWarning(KWIN_DRM) << "drmModeGetResources failed:" << strerror(errno);
+        return nullptr;
+    }
+    for (const uint32_t connectorId : std::span(ret->resources->connectors, ret->resources->count_connectors)) {
+        ret->connectors.emplace(connectorId, DrmConnector::probe(fd, connectorId));
+    }
+    return ret;
+}
+
+void DrmGpu::scheduleOutputUpdate()
+{
+    if (m_outputProbeWatcher.isRunning()) {
+        // the connectors may have changed after they've been probed, check again afterwards
+        m_outputProbeOutdated = true;
+        return;
+    }
+    m_outputProbeWatcher.setFuture(QtConcurrent::run(probeThreadPool(), &DrmGpu::probeOutputs, m_fd));
+}
+
 bool DrmGpu::updateOutputs()
 {
+    std::shared_ptr<OutputProbe> probe = std::exchange(m_outputProbe, nullptr);
     if (!m_isActive) {
         return false;
     }
-    DrmUniquePtr<drmModeRes> resources(drmModeGetResources(m_fd));
-    if (!resources) {
-        qCWarning(KWIN_DRM) << "drmModeGetResources failed:" << strerror(errno);
-        return false;
+    if (!probe) {
+        if (m_outputProbeWatcher.isRunning()) {
+            // the result of the pending probe is older than this one
+            m_outputProbeSuperseded = true;
+        }
+        probe = probeOutputs(m_fd);
+        if (!probe) {
+            return false;
+        }
     }
+    const drmModeRes *resources = probe->resources.get();
+    // bandwidth and plane assignment constraints may be different with the new set of outputs
+    m_planeTestResults.clear();
 
     // In principle these things are supposed to be detected through the wayland protocol.
     // In practice SteamVR doesn't always behave correctly
@@ -279,14 +363,14 @@ bool DrmGpu::updateOutputs()
         });
         if (it == m_connectors.end()) {
             auto conn = std::make_shared<DrmConnector>(this, currentConnector);
-            if (!conn->init()) {
+            if (!conn->init(std::move(probe->connectors[currentConnector]))) {
                 continue;
             }
             existing.push_back(conn.get());
             m_allObjects.push_back(conn.get());
             m_connectors.push_back(std::move(conn));
         } else {
-            (*it)->updateProperties();
+            (*it)->updateProperties(std::move(probe->connectors[currentConnector]));
             existing.push_back(it->get());
         }
     }
@@ -540,6 +624,10 @@ static std::chrono::nanoseconds convertTimestamp(clockid_t sourceClock, clockid_
 void DrmGpu::pageFlipHandler(int fd, unsigned int sequence, unsigned int sec, unsigned int usec, unsigned int crtc_id, void *user_data)
 {
     const auto commit = static_cast<DrmCommit *>(user_data);
+    if (!commit->pageflipEventReceived()) {
+        // the commit still waits for other CRTCs to flip
+        return;
+    }
     const auto gpu = commit->gpu();
     const bool defunct = std::erase_if(gpu->m_defunctCommits, [commit](const auto &defunct) {
         return defunct.get() == commit;
@@ -584,6 +672,30 @@ void DrmGpu::addDefunctCommit(std::unique_ptr<DrmCommit> &&commit)
     m_defunctCommits.push_back(std::move(commit));
 }
 
+DrmTestThread *DrmGpu::testThread() const
+{
+    return m_testThread.get();
+}
+
+std::optional<bool> DrmGpu::planeTestResult(const DrmPipeline::PlaneConfiguration &plane) const
+{
+    const auto it = m_planeTestResults.find(plane);
+    if (it == m_planeTestResults.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void DrmGpu::setPlaneTestResult(const DrmPipeline::PlaneConfiguration &plane, bool accepted)
+{
+    // sizes change constantly for some clients, don't let this grow indefinitely
+    static constexpr size_t s_maxPlaneTestResults = 256;
+    if (m_planeTestResults.size() >= s_maxPlaneTestResults) {
+        m_planeTestResults.clear();
+    }
+    m_planeTestResults[plane] = accepted;
+}
+
 void DrmGpu::removeOutput(DrmOutput *output)
 {
     qCDebug(KWIN_DRM) << "Removing output" << output;
@@ -827,6 +939,7 @@ void DrmGpu::doModeset()
         return;
     }
     m_inModeset = true;
+    m_planeTestResults.clear();
     const DrmPipeline::Error err = DrmPipeline::commitPipelines(pipelines, DrmPipeline::CommitMode::CommitModeset, unusedModesetObjects());
     for (DrmPipeline *pipeline : std::as_const(pipelines)) {
         if (pipeline->modesetPresentPending()) {
@@ -1051,6 +1164,32 @@ QList<OutputLayer *> DrmGpu::compatibleOutputLayers(BackendOutput *output) const
     return static_cast<DrmOutput *>(output)->pipeline()->layers() | std::ranges::to<QList<OutputLayer *>>();
 }
 
+DrmCommitThread *DrmGpu::synchronizedCommitThread() const
+{
+    return m_synchronizedCommitThread.get();
+}
+
+static bool canBeSynchronized(const DrmPipeline *pipeline)
+{
+    return pipeline->activePending() && s_synchronizedConnectors.contains(pipeline->connector()->connectorName());
+}
+
+bool DrmGpu::isSynchronized(const DrmPipeline *pipeline) const
+{
+    if (!m_synchronizedCommitThread || !canBeSynchronized(pipeline)) {
+        return false;
+    }
+    // presenting outputs with different refresh rates in lockstep would slow down the faster ones
+    return std::ranges::any_of(m_pipelines, [pipeline](const DrmPipeline *other) {
+        return other != pipeline && canBeSynchronized(other) && other->mode()->refreshRate() == pipeline->mode()->refreshRate();
+    });
+}
+
+DrmBlobCache *DrmGpu::blobCache()
+{
+    return &m_blobCache;
+}
+
 DrmLease::DrmLease(DrmGpu *gpu, FileDescriptor &&fd, uint32_t lesseeId, const QList<DrmOutput *> &outputs)
     : m_gpu(gpu)
     , m_fd(std::move(fd))
@@ -9,11 +9,13 @@
 #pragma once
 
 #include "core/drmdevice.h"
+#include "drm_blob.h"
 #include "drm_buffer.h"
 #include "drm_pipeline.h"
 #include "utils/filedescriptor.h"
 #include "utils/version.h"
 
+#include <QFutureWatcher>
 #include <QList>
 #include <QPointer>
 #include <QSize>
@@ -41,6 +43,8 @@ class GraphicsBuffer;
 class GraphicsBufferAllocator;
 class OutputFrame;
 class DrmCommit;
+class DrmCommitThread;
+class DrmTestThread;
 
 class DrmLease : public QObject
 {
@@ -111,6 +115,11 @@ public:
 
     bool updateOutputs();
     void removeOutputs();
+    /**
+     * Probes the connectors on a worker thread and updates the outputs once that's done,
+     * so that slow connector probing doesn't block the compositor on hotplug
+     */
+    void scheduleOutputUpdate();
 
     DrmPipeline::Error testPendingConfiguration();
     void releaseUnusedBuffers();
@@ -129,6 +138,31 @@ public:
     void dispatchEvents();
 
     void addDefunctCommit(std::unique_ptr<DrmCommit> &&commit);
+    /**
+     * The thread speculative atomic tests are run on. nullptr without atomic modesetting
+     */
+    DrmTestThread *testThread() const;
+
+    /**
+     * Returns whether the kernel accepted @p plane in the currently known
+     * state of the GPU, or std::nullopt if that isn't known yet.
+     * Results are forgotten on hotplug and modesets
+     */
+    std::optional<bool> planeTestResult(const DrmPipeline::PlaneConfiguration &plane) const;
+    void setPlaneTestResult(const DrmPipeline::PlaneConfiguration &plane, bool accepted);
+
+    /**
+     * The commit thread shared by all synchronized outputs, see KWIN_DRM_SYNCHRONIZED_OUTPUTS.
+     * nullptr if output synchronization isn't enabled
+     */
+    DrmCommitThread *synchronizedCommitThread() const;
+    /**
+     * @returns whether the pending state of @p pipeline should be presented in lockstep
+     *          with the other synchronized outputs, with one atomic commit for all of them
+     */
+    bool isSynchronized(const DrmPipeline *pipeline) const;
+
+    DrmBlobCache *blobCache();
 
 Q_SIGNALS:
     void activeChanged(bool active);
@@ -136,6 +170,9 @@ Q_SIGNALS:
     void outputRemoved(DrmAbstractOutput *output);
 
 private:
+    struct OutputProbe;
+
+    static std::shared_ptr<OutputProbe> probeOutputs(int fd);
     DrmOutput *findOutput(quint32 connector);
     void removeOutput(DrmOutput *output);
     void initDrmResources();
@@ -187,11 +224,19 @@ private:
 
     std::unique_ptr<QSocketNotifier> m_socketNotifier;
     QSize m_cursorSize;
+    DrmBlobCache m_blobCache;
     std::unordered_map<DrmPipeline *, std::shared_ptr<OutputFrame>> m_pendingModesetFrames;
     bool m_inModeset = false;
     QHash<GraphicsBuffer *, std::weak_ptr<DrmFramebufferData>> m_fbCache;
     std::vector<std::unique_ptr<DrmCommit>> m_defunctCommits;
+    std::unique_ptr<DrmTestThread> m_testThread;
+    std::unique_ptr<DrmCommitThread> m_synchronizedCommitThread;
+    std::map<DrmPipeline::PlaneConfiguration, bool> m_planeTestResults;
     QTimer m_delayedModesetTimer;
+    QFutureWatcher<std::shared_ptr<OutputProbe>> m_outputProbeWatcher;
+    std::shared_ptr<OutputProbe> m_outputProbe;
+    bool m_outputProbeOutdated = false;
+    bool m_outputProbeSuperseded = false;
 };
 
 }
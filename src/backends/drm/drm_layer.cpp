@@ -142,6 +142,11 @@ QHash<uint32_t, QList<uint64_t>> DrmPipelineLayer::supportedAsyncDrmFormats() co
     }
 }
 
+std::optional<QRegion> DrmPipelineLayer::currentBufferDamage() const
+{
+    return std::nullopt;
+}
+
 QList<QSize> DrmPipelineLayer::recommendedSizes() const
 {
     if (m_plane) {
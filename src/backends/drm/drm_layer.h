@@ -44,6 +44,11 @@ public:
     QHash<uint32_t, QList<uint64_t>> supportedAsyncDrmFormats() const override;
 
     virtual std::shared_ptr<DrmFramebuffer> currentBuffer() const = 0;
+    /**
+     * The part of the current buffer that differs from the previous one, in buffer
+     * coordinates. If it's not known, the whole buffer is assumed to be damaged.
+     */
+    virtual std::optional<QRegion> currentBufferDamage() const;
 
     DrmPlane *plane() const;
 
@@ -27,16 +27,21 @@ DrmObject::DrmObject(DrmGpu *gpu, uint32_t objectId, uint32_t objectType)
 
 DrmPropertyList DrmObject::queryProperties() const
 {
-    DrmUniquePtr<drmModeObjectProperties> properties(drmModeObjectGetProperties(m_gpu->fd(), m_id, m_objectType));
+    return queryProperties(m_gpu->fd(), m_id, m_objectType);
+}
+
+DrmPropertyList DrmObject::queryProperties(int fd, uint32_t objectId, uint32_t objectType)
+{
+    DrmUniquePtr<drmModeObjectProperties> properties(drmModeObjectGetProperties(fd, objectId, objectType));
     if (!properties) {
-        qCWarning(KWIN_DRM) << "Failed to get properties for object" << m_id;
+        qCWarning(KWIN_DRM) << "Failed to get properties for object" << objectId;
         return {};
     }
     DrmPropertyList ret;
     for (uint32_t i = 0; i < properties->count_props; i++) {
-        DrmUniquePtr<drmModePropertyRes> prop(drmModeGetProperty(m_gpu->fd(), properties->props[i]));
+        DrmUniquePtr<drmModePropertyRes> prop(drmModeGetProperty(fd, properties->props[i]));
         if (!prop) {
-            qCWarning(KWIN_DRM, "Getting property %d of object %d failed!", properties->props[i], m_id);
+            qCWarning(KWIN_DRM, "Getting property %d of object %d failed!", properties->props[i], objectId);
             continue;
         }
         ret.addProperty(std::move(prop), properties->prop_values[i]);
@@ -91,6 +96,18 @@ std::optional<std::pair<DrmUniquePtr<drmModePropertyRes>, uint64_t>> DrmProperty
         return std::nullopt;
     }
 }
+
+std::optional<uint64_t> DrmPropertyList::value(const QByteArray &name) const
+{
+    const auto it = std::ranges::find_if(m_properties, [&name](const auto &pair) {
+        return pair.first->name == name;
+    });
+    if (it != m_properties.end()) {
+        return it->second;
+    } else {
+        return std::nullopt;
+    }
+}
 }
 
 QDebug operator<<(QDebug s, const KWin::DrmObject *obj)
@@ -33,6 +33,7 @@ class DrmPropertyList
 public:
     void addProperty(DrmUniquePtr<drmModePropertyRes> &&prop, uint64_t value);
     std::optional<std::pair<DrmUniquePtr<drmModePropertyRes>, uint64_t>> takeProperty(const QByteArray &name);
+    std::optional<uint64_t> value(const QByteArray &name) const;
 
 private:
     std::vector<std::pair<DrmUniquePtr<drmModePropertyRes>, uint64_t>> m_properties;
@@ -60,6 +61,11 @@ protected:
     DrmObject(DrmGpu *gpu, uint32_t objectId, uint32_t objectType);
 
     DrmPropertyList queryProperties() const;
+    /**
+     * Queries the properties of a drm object without touching any state, so that it can
+     * be used on other threads
+     */
+    static DrmPropertyList queryProperties(int fd, uint32_t objectId, uint32_t objectType);
 
 private:
     DrmGpu *m_gpu;
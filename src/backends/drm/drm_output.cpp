@@ -679,10 +679,16 @@ void DrmOutput::tryKmsColorOffloading(State &next)
         || !colorPipeline.isIdentity();
 }
 
+static bool isSameColor(const std::shared_ptr<ColorDescription> &one, const std::shared_ptr<ColorDescription> &other)
+{
+    return one == other || (one && other && *one == *other);
+}
+
 void DrmOutput::maybeScheduleRepaints(const State &next)
 {
     // TODO move the output layers to BackendOutput, and have it take care of this when updating State
-    if (next.blendingColor != m_state.blendingColor || next.layerBlendingColor != m_state.layerBlendingColor) {
+    // the descriptions are created anew on every state change, only repaint if they really differ
+    if (!isSameColor(next.blendingColor, m_state.blendingColor) || !isSameColor(next.layerBlendingColor, m_state.layerBlendingColor)) {
         const auto layers = m_pipeline->layers();
         for (const auto &layer : layers) {
             layer->addDeviceRepaint(infiniteRegion());
@@ -25,26 +25,59 @@
 #include "drm_logging.h"
 #include "drm_output.h"
 #include "drm_plane.h"
+#include "drm_test_thread.h"
 #include "utils/drm_format_helper.h"
 #include "utils/envvar.h"
 #include "utils/kernel.h"
 
 #include <drm_fourcc.h>
 #include <gbm.h>
+#include <ranges>
 
 using namespace std::literals;
 
 namespace KWin
 {
 
+static const bool s_vrrHold = environmentVariableBoolValue("KWIN_DRM_VRR_HOLD").value_or(true);
+
 DrmPipeline::DrmPipeline(DrmConnector *conn)
     : m_connector(conn)
     , m_commitThread(std::make_unique<DrmCommitThread>(conn->gpu(), conn->connectorName()))
 {
+    // a failed commit means that (at least) one of the cached test results is wrong
+    QObject::connect(m_commitThread.get(), &DrmCommitThread::commitFailed, m_commitThread.get(), [this]() {
+        clearTestResults();
+    });
+    QObject::connect(m_commitThread.get(), &DrmCommitThread::deadlineMissed, m_commitThread.get(), [this](MissedDeadlineReason reason) {
+        if (!m_synchronized) {
+            notifyDeadlineMissed(reason);
+        }
+    });
+    if (DrmCommitThread *synchronizedThread = gpu()->synchronizedCommitThread()) {
+        QObject::connect(synchronizedThread, &DrmCommitThread::commitFailed, m_commitThread.get(), [this]() {
+            if (m_synchronized) {
+                clearTestResults();
+            }
+        });
+        QObject::connect(synchronizedThread, &DrmCommitThread::deadlineMissed, m_commitThread.get(), [this](MissedDeadlineReason reason) {
+            if (m_synchronized) {
+                notifyDeadlineMissed(reason);
+            }
+        });
+    }
 }
 
 DrmPipeline::~DrmPipeline()
 {
+    if (DrmTestThread *testThread = gpu()->testThread()) {
+        testThread->cancel(this);
+    }
+    if (m_synchronized) {
+        if (DrmCommitThread *synchronizedThread = gpu()->synchronizedCommitThread()) {
+            synchronizedThread->removePipeline(this);
+        }
+    }
     // the commit thread may still access the pipeline until it's stopped
     // so it must be deleted before everything else
     m_commitThread.reset();
@@ -57,8 +90,142 @@ DrmPipeline::Error DrmPipeline::testPresent(const std::shared_ptr<OutputFrame> &
         // the compositor will have to do a fallback for when the real present fails
         return Error::None;
     }
+    const auto configuration = layerConfiguration();
+    if (configuration) {
+        const auto it = m_testResults.find(*configuration);
+        if (it != m_testResults.end()) {
+            return it->second ? Error::None : Error::InvalidArguments;
+        }
+        if (hasRejectedPlane(*configuration)) {
+            return Error::InvalidArguments;
+        }
+        if (canTestSpeculatively()) {
+            return testSpeculatively(*configuration);
+        }
+    }
     // test the full state with all planes, to take pending commits into account
-    return DrmPipeline::commitPipelinesAtomic({this}, CommitMode::Test, frame, {});
+    const Error err = DrmPipeline::commitPipelinesAtomic({this}, CommitMode::Test, frame, {});
+    if (configuration && (err == Error::None || err == Error::InvalidArguments)) {
+        storeTestResult(*configuration, err == Error::None);
+    }
+    return err;
+}
+
+void DrmPipeline::storeTestResult(const LayerConfiguration &configuration, bool success)
+{
+    // with constantly changing buffer sizes, this could otherwise grow indefinitely
+    static constexpr size_t s_maxTestResults = 64;
+    if (m_testResults.size() >= s_maxTestResults) {
+        m_testResults.clear();
+    }
+    m_testResults[configuration] = success;
+
+    // remember which individual planes the kernel accepts, so that other layer
+    // configurations (on all outputs of the GPU) containing them can be skipped
+    if (success) {
+        for (const PlaneConfiguration &plane : configuration.planes) {
+            gpu()->setPlaneTestResult(plane, true);
+        }
+    } else {
+        // a failure can only be attributed to a plane if everything else is known to work
+        const auto unknown = configuration.planes | std::views::filter([this](const PlaneConfiguration &plane) {
+            return gpu()->planeTestResult(plane) != true;
+        });
+        const auto first = unknown.begin();
+        if (first != unknown.end() && std::next(first) == unknown.end() && !first->primary) {
+            gpu()->setPlaneTestResult(*first, false);
+        }
+    }
+}
+
+bool DrmPipeline::hasRejectedPlane(const LayerConfiguration &configuration) const
+{
+    return std::ranges::any_of(configuration.planes, [this](const PlaneConfiguration &plane) {
+        return gpu()->planeTestResult(plane) == false;
+    });
+}
+
+std::optional<DrmPipeline::LayerConfiguration> DrmPipeline::layerConfiguration() const
+{
+    if (!activePending() || needsModeset() || m_pending.needsModesetProperties) {
+        return std::nullopt;
+    }
+    LayerConfiguration ret{
+        .presentationMode = m_pending.presentationMode,
+    };
+    const QRect crtcRect(QPoint(), m_pending.mode->size());
+    for (DrmPipelineLayer *layer : m_pending.layers) {
+        if (!layer->isEnabled() || !layer->plane()) {
+            continue;
+        }
+        const auto fb = layer->currentBuffer();
+        const DmaBufAttributes *attributes = fb && fb->buffer() ? fb->buffer()->dmabufAttributes() : nullptr;
+        if (!attributes || !layer->colorPipeline().isIdentity()) {
+            // color pipelines can't be compared cheaply, just always test them
+            return std::nullopt;
+        }
+        const QRect source = layer->sourceRect().toRect();
+        const QRect target = layer->targetRect();
+        const auto rotation = layer->plane()->planeTransformation(layer->offloadTransform()).value_or(DrmPlane::outputTransformToPlaneTransform(layer->offloadTransform()));
+        ret.planes.push_back(PlaneConfiguration{
+            .plane = layer->plane()->id(),
+            .primary = layer->type() == OutputLayerType::Primary,
+            .format = attributes->format,
+            .modifier = attributes->modifier,
+            .sourceWidth = uint32_t(source.width()),
+            .sourceHeight = uint32_t(source.height()),
+            .targetWidth = uint32_t(target.width()),
+            .targetHeight = uint32_t(target.height()),
+            .rotation = uint32_t(rotation.toInt()),
+            .zpos = layer->zpos(),
+            .clipped = !crtcRect.contains(target),
+            .yuvCoefficients = int(layer->colorDescription()->yuvCoefficients()),
+            .encodingRange = int(layer->colorDescription()->range()),
+        });
+    }
+    return ret;
+}
+
+bool DrmPipeline::canTestSpeculatively() const
+{
+    // only overlays and underlays are optional enough that using them
+    // can be delayed by a frame without the user noticing
+    return m_output && gpu()->testThread() && std::ranges::any_of(m_pending.layers, [](DrmPipelineLayer *layer) {
+        return layer->isEnabled() && (layer->type() == OutputLayerType::GenericLayer || layer->type() == OutputLayerType::EfficientOverlay);
+    });
+}
+
+DrmPipeline::Error DrmPipeline::testSpeculatively(const LayerConfiguration &configuration)
+{
+    if (m_speculativeTests.contains(configuration)) {
+        return Error::FramePending;
+    }
+    auto commit = std::make_unique<DrmAtomicCommit>(QList<DrmPipeline *>{this});
+    // the frame isn't passed on, as the commit may outlive it
+    if (Error err = prepareAtomicCommit(commit.get(), CommitMode::Test, nullptr); err != Error::None) {
+        storeTestResult(configuration, false);
+        return err;
+    }
+    m_speculativeTests.insert(configuration);
+    gpu()->testThread()->test(this, std::move(commit), [this, configuration](bool success) {
+        if (!m_speculativeTests.erase(configuration)) {
+            // the pipeline state changed in the meantime
+            return;
+        }
+        storeTestResult(configuration, success);
+        if (success) {
+            // the next frame can use the tested configuration
+            m_output->renderLoop()->scheduleRepaint();
+        }
+    });
+    // until the result is known, the compositor has to use a configuration that's already been tested
+    return Error::FramePending;
+}
+
+void DrmPipeline::clearTestResults()
+{
+    m_testResults.clear();
+    m_speculativeTests.clear();
 }
 
 DrmPipeline::Error DrmPipeline::present(const QList<OutputLayer *> &layersToUpdate, const std::shared_ptr<OutputFrame> &frame)
@@ -83,12 +250,17 @@ DrmPipeline::Error DrmPipeline::present(const QList<OutputLayer *> &layersToUpda
             if (Error err = prepareAtomicPlane(partialUpdate.get(), m_pending.layers.front()->plane(), m_pending.layers.front(), frame); err != Error::None) {
                 return err;
             }
+            if (s_vrrHold && !m_pending.needsModesetProperties) {
+                // nothing on the screen changes, this commit only provides presentation feedback.
+                // With VRR, hold the current frame instead of making the display refresh early
+                partialUpdate->setAllowedVrrDelay(commitThread()->vrrHoldDuration());
+            }
         }
         if (m_pending.needsModesetProperties && !prepareAtomicModeset(partialUpdate.get())) {
             return Error::InvalidArguments;
         }
         m_next.needsModesetProperties = m_pending.needsModesetProperties = false;
-        m_commitThread->addCommit(std::move(partialUpdate));
+        commitThread()->addCommit(std::move(partialUpdate));
         return Error::None;
     } else {
         return presentLegacy(layersToUpdate, frame);
@@ -240,19 +412,19 @@ DrmPipeline::Error DrmPipeline::prepareAtomicPlane(DrmAtomicCommit *commit, DrmP
     if (!fb) {
         return Error::InvalidArguments;
     }
-    const auto transform = layer->offloadTransform();
-    const auto planeTransform = DrmPlane::outputTransformToPlaneTransform(transform);
-    if (plane->rotation.isValid()) {
-        if (!plane->rotation.hasEnum(planeTransform)) {
-            return Error::InvalidArguments;
-        }
-        commit->addEnum(plane->rotation, planeTransform);
-    } else if (planeTransform != DrmPlane::Transformation::Rotate0) {
+    const auto planeTransform = plane->planeTransformation(layer->offloadTransform());
+    if (!planeTransform) {
         return Error::InvalidArguments;
     }
+    if (plane->rotation.isValid()) {
+        commit->addEnum(plane->rotation, *planeTransform);
+    }
     commit->addProperty(plane->crtcId, m_pending.crtc->id());
     commit->addBuffer(plane, fb, frame);
     plane->set(commit, layer->sourceRect().toRect(), layer->targetRect());
+    if (const auto damage = layer->currentBufferDamage()) {
+        commit->addDamageClips(plane, *damage);
+    }
     if (plane->vmHotspotX.isValid() && plane->vmHotspotY.isValid()) {
         commit->addProperty(plane->vmHotspotX, std::round(layer->hotspot().x()));
         commit->addProperty(plane->vmHotspotY, std::round(layer->hotspot().y()));
@@ -463,7 +635,7 @@ bool DrmPipeline::presentAsync(OutputLayer *layer, std::optional<std::chrono::na
         auto partialUpdate = std::make_unique<DrmAtomicCommit>(QList<DrmPipeline *>{this});
         prepareAtomicPlane(partialUpdate.get(), drmLayer->plane(), drmLayer, nullptr);
         partialUpdate->setAllowedVrrDelay(allowedVrrDelay);
-        m_commitThread->addCommit(std::move(partialUpdate));
+        commitThread()->addCommit(std::move(partialUpdate));
         return true;
     } else {
         return setCursorLegacy(drmLayer);
@@ -472,10 +644,14 @@ bool DrmPipeline::presentAsync(OutputLayer *layer, std::optional<std::chrono::na
 
 void DrmPipeline::applyPendingChanges()
 {
+    clearTestResults();
     const bool layersChanged = m_next.layers != m_pending.layers;
     m_next = m_pending;
-    m_commitThread->setModeInfo(m_pending.mode->refreshRate(), m_pending.mode->vblankTime());
-    m_output->renderLoop()->setPresentationSafetyMargin(m_commitThread->safetyMargin());
+    updateSynchronization();
+    commitThread()->setModeInfo(m_pending.mode->refreshRate(), m_pending.mode->vblankTime());
+    commitThread()->setMinVrrRefreshRate(m_output->minVrrRefreshRateHz());
+    commitThread()->setCrtcId(m_pending.crtc ? m_pending.crtc->id() : 0);
+    m_output->renderLoop()->setPresentationSafetyMargin(commitThread()->safetyMargin());
     m_output->renderLoop()->setRefreshRate(m_pending.mode->refreshRate());
     if (layersChanged) {
         Q_EMIT m_output->outputLayersChanged();
@@ -495,14 +671,21 @@ DrmGpu *DrmPipeline::gpu() const
 void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp)
 {
     RenderLoopPrivate::get(m_output->renderLoop())->notifyVblank(timestamp);
-    m_commitThread->pageFlipped(timestamp);
+    commitThread()->pageFlipped(timestamp);
     // the commit thread adjusts the safety margin on every commit
-    m_output->renderLoop()->setPresentationSafetyMargin(m_commitThread->safetyMargin());
+    m_output->renderLoop()->setPresentationSafetyMargin(commitThread()->safetyMargin());
     if (gpu()->needsModeset()) {
         gpu()->maybeModeset(nullptr, nullptr);
     }
 }
 
+void DrmPipeline::notifyDeadlineMissed(MissedDeadlineReason reason)
+{
+    if (m_output) {
+        RenderLoopPrivate::get(m_output->renderLoop())->notifyDeadlineMissed(reason);
+    }
+}
+
 void DrmPipeline::setOutput(DrmOutput *output)
 {
     m_output = output;
@@ -533,7 +716,21 @@ void DrmPipeline::revertPendingChanges()
 
 DrmCommitThread *DrmPipeline::commitThread() const
 {
-    return m_commitThread.get();
+    return m_synchronized ? gpu()->synchronizedCommitThread() : m_commitThread.get();
+}
+
+void DrmPipeline::updateSynchronization()
+{
+    const bool synchronized = gpu()->isSynchronized(this);
+    if (synchronized == m_synchronized) {
+        return;
+    }
+    // pageflips must be delivered to the commit thread they were committed on
+    if (m_commitThread->pageflipsPending() || gpu()->synchronizedCommitThread()->pageflipsPending()) {
+        return;
+    }
+    m_synchronized = synchronized;
+    qCDebug(KWIN_DRM) << "Synchronized presentation for" << m_connector->connectorName() << (synchronized ? "enabled" : "disabled");
 }
 
 bool DrmPipeline::modesetPresentPending() const
@@ -719,6 +916,6 @@ std::shared_ptr<DrmBlob> DrmPipeline::createHdrMetadata(TransferFunction::Type t
 
 std::chrono::nanoseconds DrmPipeline::presentationDeadline() const
 {
-    return m_commitThread->safetyMargin();
+    return commitThread()->safetyMargin();
 }
 }
@@ -14,6 +14,9 @@
 #include <QSize>
 
 #include <chrono>
+#include <compare>
+#include <map>
+#include <set>
 #include <xf86drmMode.h>
 
 #include "core/colorpipeline.h"
@@ -117,10 +120,47 @@ public:
     Q_ENUM(CommitMode)
     static Error commitPipelines(const QList<DrmPipeline *> &pipelines, CommitMode mode, const QList<DrmObject *> &unusedObjects = {});
 
+    /**
+     * The properties of a plane that decide whether or not the kernel accepts it
+     */
+    struct PlaneConfiguration
+    {
+        uint32_t plane = 0;
+        bool primary = false;
+        uint32_t format = 0;
+        uint64_t modifier = 0;
+        uint32_t sourceWidth = 0;
+        uint32_t sourceHeight = 0;
+        uint32_t targetWidth = 0;
+        uint32_t targetHeight = 0;
+        uint32_t rotation = 0;
+        int zpos = 0;
+        bool clipped = false;
+        int yuvCoefficients = 0;
+        int encodingRange = 0;
+
+        auto operator<=>(const PlaneConfiguration &other) const = default;
+    };
+    struct LayerConfiguration
+    {
+        std::vector<PlaneConfiguration> planes;
+        PresentationMode presentationMode = PresentationMode::VSync;
+
+        auto operator<=>(const LayerConfiguration &other) const = default;
+    };
+
 private:
     bool isBufferForDirectScanout() const;
     uint32_t calculateUnderscan();
     static Error errnoToError();
+    std::optional<LayerConfiguration> layerConfiguration() const;
+    bool canTestSpeculatively() const;
+    Error testSpeculatively(const LayerConfiguration &configuration);
+    void storeTestResult(const LayerConfiguration &configuration, bool success);
+    bool hasRejectedPlane(const LayerConfiguration &configuration) const;
+    void clearTestResults();
+    void updateSynchronization();
+    void notifyDeadlineMissed(MissedDeadlineReason reason);
     std::shared_ptr<DrmBlob> createHdrMetadata(TransferFunction::Type transferFunction) const;
 
     // legacy only
@@ -172,6 +212,12 @@ private:
     State m_next;
 
     std::unique_ptr<DrmCommitThread> m_commitThread;
+    // whether this pipeline uses the commit thread shared by all synchronized outputs
+    bool m_synchronized = false;
+
+    // results of test commits for the current pipeline state, by layer configuration
+    std::map<LayerConfiguration, bool> m_testResults;
+    std::set<LayerConfiguration> m_speculativeTests;
 };
 
 }
@@ -18,6 +18,7 @@
 #include "drm_pointer.h"
 #include "utils/drm_format_helper.h"
 
+#include <algorithm>
 #include <drm_fourcc.h>
 #include <ranges>
 #include <span>
@@ -73,6 +74,7 @@ DrmPlane::DrmPlane(DrmGpu *gpu, uint32_t planeId)
     , inFormatsForTearing(this, QByteArrayLiteral("IN_FORMATS_ASYNC"))
     , zpos(this, QByteArrayLiteral("zpos"))
     , colorPipeline(this, QByteArrayLiteral("COLOR_PIPELINE"))
+    , fbDamageClips(this, QByteArrayLiteral("FB_DAMAGE_CLIPS"))
 {
 }
 
@@ -113,6 +115,7 @@ bool DrmPlane::updateProperties()
     inFormatsForTearing.update(props);
     zpos.update(props);
     colorPipeline.update(props);
+    fbDamageClips.update(props);
 
     if (!type.isValid() || !srcX.isValid() || !srcY.isValid() || !srcW.isValid() || !srcH.isValid()
         || !crtcX.isValid() || !crtcY.isValid() || !crtcW.isValid() || !crtcH.isValid() || !fbId.isValid()) {
@@ -290,9 +293,53 @@ DrmPlane::Transformations DrmPlane::outputTransformToPlaneTransform(OutputTransf
     Q_UNREACHABLE();
 }
 
+static DrmPlane::Transformations rotatedBy180(DrmPlane::Transformations transformations)
+{
+    using Transformation = DrmPlane::Transformation;
+    DrmPlane::Transformations ret = transformations & (Transformation::ReflectX | Transformation::ReflectY);
+    if (transformations & Transformation::Rotate0) {
+        ret |= Transformation::Rotate180;
+    } else if (transformations & Transformation::Rotate90) {
+        ret |= Transformation::Rotate270;
+    } else if (transformations & Transformation::Rotate180) {
+        ret |= Transformation::Rotate0;
+    } else if (transformations & Transformation::Rotate270) {
+        ret |= Transformation::Rotate90;
+    }
+    return ret;
+}
+
+std::optional<DrmPlane::Transformations> DrmPlane::planeTransformation(OutputTransform transform) const
+{
+    const Transformations canonical = outputTransformToPlaneTransform(transform);
+    if (!rotation.isValid()) {
+        if (canonical == Transformation::Rotate0) {
+            return canonical;
+        }
+        return std::nullopt;
+    }
+    if (rotation.hasEnum(canonical)) {
+        return canonical;
+    }
+    if (canonical == Transformation::Rotate180) {
+        // reflecting along both axes is the same as rotating by 180°
+        const Transformations reflected = Transformation::Rotate0 | Transformation::ReflectX | Transformation::ReflectY;
+        if (rotation.hasEnum(reflected)) {
+            return reflected;
+        }
+    } else if (canonical & Transformation::ReflectY) {
+        // reflecting along the other axis and rotating by another 180° is the same as well
+        const Transformations reflected = rotatedBy180(canonical & ~Transformations(Transformation::ReflectY)) | Transformation::ReflectX;
+        if (rotation.hasEnum(reflected)) {
+            return reflected;
+        }
+    }
+    return std::nullopt;
+}
+
 bool DrmPlane::supportsTransformation(OutputTransform transform) const
 {
-    return rotation.isValid() && rotation.hasEnum(outputTransformToPlaneTransform(transform));
+    return planeTransformation(transform).has_value();
 }
 
 QList<QSize> DrmPlane::recommendedSizes() const
@@ -304,6 +351,16 @@ QList<DrmColorOp *> DrmPlane::colorPipelines() const
 {
     return m_colorPipelines;
 }
+
+bool DrmPlane::canProgramColorPipeline(const ColorPipeline &pipeline) const
+{
+    if (pipeline.isIdentity()) {
+        return true;
+    }
+    return std::ranges::any_of(m_colorPipelines, [&pipeline](DrmColorOp *colorPipeline) {
+        return colorPipeline->colorOp()->canProgram(pipeline);
+    });
+}
 }
 
 #include "moc_drm_plane.cpp"
@@ -17,6 +17,7 @@
 #include <QPoint>
 #include <QSize>
 #include <memory>
+#include <optional>
 #include <qobjectdefs.h>
 
 namespace KWin
@@ -51,6 +52,10 @@ public:
 
     QList<QSize> recommendedSizes() const;
     QList<DrmColorOp *> colorPipelines() const;
+    /**
+     * Returns whether one of the color pipelines of the plane can apply @a pipeline
+     */
+    bool canProgramColorPipeline(const ColorPipeline &pipeline) const;
 
     enum class TypeIndex : uint64_t {
         Overlay = 0,
@@ -68,6 +73,12 @@ public:
     Q_ENUM(Transformation)
     Q_DECLARE_FLAGS(Transformations, Transformation)
     static Transformations outputTransformToPlaneTransform(OutputTransform transform);
+    /**
+     * Returns the value of the rotation property that applies @a transform, or @c std::nullopt
+     * if the plane can't apply it. Drivers don't support all combinations of rotations and
+     * reflections, so an equivalent combination is used if the canonical one isn't supported.
+     */
+    std::optional<Transformations> planeTransformation(OutputTransform transform) const;
     enum class PixelBlendMode : uint64_t {
         None,
         PreMultiplied,
@@ -107,6 +118,7 @@ public:
     DrmProperty inFormatsForTearing;
     DrmProperty zpos;
     DrmProperty colorPipeline;
+    DrmProperty fbDamageClips;
 
 private:
     std::shared_ptr<DrmFramebuffer> m_current;
@@ -46,6 +46,8 @@ std::optional<OutputLayerBeginFrameInfo> DrmQPainterLayer::doBeginFrame()
 
     m_renderTime = std::make_unique<CpuRenderTimeQuery>();
     const QRegion repaint = m_damageJournal.accumulate(m_currentBuffer->age(), infiniteRegion());
+    // if the buffer contents are unknown, what's on the screen may not be the previous frame either
+    m_fullDamage = repaint == infiniteRegion();
     return OutputLayerBeginFrameInfo{
         .renderTarget = RenderTarget(m_currentBuffer->view()->image()),
         .repaint = repaint,
@@ -59,6 +61,11 @@ bool DrmQPainterLayer::doEndFrame(const QRegion &renderedDeviceRegion, const QRe
         frame->addRenderTimeQuery(std::move(m_renderTime));
     }
     m_currentFramebuffer = gpu()->importBuffer(m_currentBuffer->buffer(), FileDescriptor{});
+    if (m_fullDamage) {
+        m_currentDamage.reset();
+    } else {
+        m_currentDamage = damagedDeviceRegion & QRect(QPoint(), m_swapchain->size());
+    }
     m_damageJournal.add(damagedDeviceRegion);
     m_swapchain->release(m_currentBuffer);
     if (!m_currentFramebuffer) {
@@ -72,6 +79,7 @@ bool DrmQPainterLayer::preparePresentationTest()
     if (!doesSwapchainFit()) {
         m_swapchain = std::make_shared<QPainterSwapchain>(scanoutDevice()->allocator(), targetRect().size(), supportedDrmFormats().contains(DRM_FORMAT_ARGB8888) ? DRM_FORMAT_ARGB8888 : DRM_FORMAT_XRGB8888);
         m_currentBuffer = m_swapchain->acquire();
+        m_currentDamage.reset();
         if (m_currentBuffer) {
             m_currentFramebuffer = gpu()->importBuffer(m_currentBuffer->buffer(), FileDescriptor{});
             m_swapchain->release(m_currentBuffer);
@@ -95,6 +103,11 @@ std::shared_ptr<DrmFramebuffer> DrmQPainterLayer::currentBuffer() const
     return m_currentFramebuffer;
 }
 
+std::optional<QRegion> DrmQPainterLayer::currentBufferDamage() const
+{
+    return m_currentDamage;
+}
+
 void DrmQPainterLayer::releaseBuffers()
 {
     m_swapchain.reset();
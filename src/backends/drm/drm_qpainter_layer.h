@@ -33,6 +33,7 @@ public:
     bool doEndFrame(const QRegion &renderedDeviceRegion, const QRegion &damagedDeviceRegion, OutputFrame *frame) override;
     bool preparePresentationTest() override;
     std::shared_ptr<DrmFramebuffer> currentBuffer() const override;
+    std::optional<QRegion> currentBufferDamage() const override;
     void releaseBuffers() override;
 
 private:
@@ -41,6 +42,8 @@ private:
     std::shared_ptr<QPainterSwapchain> m_swapchain;
     std::shared_ptr<QPainterSwapchainSlot> m_currentBuffer;
     std::shared_ptr<DrmFramebuffer> m_currentFramebuffer;
+    std::optional<QRegion> m_currentDamage;
+    bool m_fullDamage = true;
     DamageJournal m_damageJournal;
     std::unique_ptr<CpuRenderTimeQuery> m_renderTime;
 };
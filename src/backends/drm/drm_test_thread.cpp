@@ -0,0 +1,98 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "drm_test_thread.h"
+#include "drm_commit.h"
+
+namespace KWin
+{
+
+DrmTestThread::DrmTestThread()
+{
+    m_thread.reset(QThread::create([this]() {
+        const auto thread = QThread::currentThread();
+        while (true) {
+            std::unique_lock lock(m_mutex);
+            while (m_pending.empty() && !thread->isInterruptionRequested()) {
+                m_jobPending.wait(lock);
+            }
+            if (thread->isInterruptionRequested()) {
+                return;
+            }
+            Job job = std::move(m_pending.front());
+            m_pending.pop_front();
+            m_currentPipeline = job.pipeline;
+            m_currentCancelled = false;
+            lock.unlock();
+
+            job.success = job.commit->test();
+
+            lock.lock();
+            if (m_currentCancelled) {
+                // the pipeline is gone, but the commit still has to be deleted on the main thread
+                job.pipeline = nullptr;
+                job.callback = nullptr;
+            }
+            m_currentPipeline = nullptr;
+            m_finished.push_back(std::move(job));
+            QMetaObject::invokeMethod(this, &DrmTestThread::deliverResults, Qt::ConnectionType::QueuedConnection);
+        }
+    }));
+    m_thread->setObjectName(QStringLiteral("kwin_drm_test"));
+    m_thread->start(QThread::LowPriority);
+}
+
+DrmTestThread::~DrmTestThread()
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_thread->requestInterruption();
+        m_jobPending.notify_all();
+    }
+    m_thread->wait();
+}
+
+void DrmTestThread::test(DrmPipeline *pipeline, std::unique_ptr<DrmAtomicCommit> &&commit, Callback &&callback)
+{
+    std::unique_lock lock(m_mutex);
+    m_pending.push_back(Job{
+        .pipeline = pipeline,
+        .commit = std::move(commit),
+        .callback = std::move(callback),
+    });
+    m_jobPending.notify_all();
+}
+
+void DrmTestThread::cancel(DrmPipeline *pipeline)
+{
+    std::unique_lock lock(m_mutex);
+    const auto belongsToPipeline = [pipeline](const Job &job) {
+        return job.pipeline == pipeline;
+    };
+    std::erase_if(m_pending, belongsToPipeline);
+    std::erase_if(m_finished, belongsToPipeline);
+    if (m_currentPipeline == pipeline) {
+        m_currentCancelled = true;
+    }
+}
+
+void DrmTestThread::deliverResults()
+{
+    std::vector<Job> finished;
+    {
+        std::unique_lock lock(m_mutex);
+        std::swap(finished, m_finished);
+    }
+    for (Job &job : finished) {
+        if (job.callback) {
+            job.callback(job.success);
+        }
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace KWin
+{
+
+class DrmAtomicCommit;
+class DrmPipeline;
+
+/**
+ * The DrmTestThread class runs atomic test commits on a worker thread, so that
+ * speculatively probing plane configurations doesn't block compositing.
+ *
+ * Commits are only ever created and destroyed on the main thread, the worker
+ * just does the test ioctl.
+ */
+class DrmTestThread : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DrmTestThread();
+    ~DrmTestThread();
+
+    using Callback = std::function<void(bool success)>;
+    /**
+     * Queues a test of @p commit on behalf of @p pipeline. @p callback
+     * is invoked on the main thread once the test is done, unless the
+     * pipeline cancels its tests before that
+     */
+    void test(DrmPipeline *pipeline, std::unique_ptr<DrmAtomicCommit> &&commit, Callback &&callback);
+    void cancel(DrmPipeline *pipeline);
+
+private:
+    struct Job
+    {
+        DrmPipeline *pipeline = nullptr;
+        std::unique_ptr<DrmAtomicCommit> commit;
+        Callback callback;
+        bool success = false;
+    };
+
+    void deliverResults();
+
+    std::unique_ptr<QThread> m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_jobPending;
+    std::deque<Job> m_pending;
+    std::vector<Job> m_finished;
+    DrmPipeline *m_currentPipeline = nullptr;
+    bool m_currentCancelled = false;
+};
+
+}
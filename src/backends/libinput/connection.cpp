@@ -30,8 +30,13 @@
 #include <QMutexLocker>
 #include <QSocketNotifier>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <libinput.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
 
 namespace KWin
 {
@@ -103,6 +108,7 @@ Connection::Connection(std::unique_ptr<Context> &&input)
     : m_notifier(nullptr)
     , m_connectionAdaptor(std::make_unique<ConnectionAdaptor>(this))
     , m_input(std::move(input))
+    , m_wakeupFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
 {
     Q_ASSERT(m_input);
     // need to connect to KGlobalSettings as the mouse KCM does not emit a dedicated signal
@@ -116,6 +122,10 @@ Connection::~Connection()
         Q_EMIT deviceRemoved(device);
     }
 
+    while (const auto event = m_pendingEvents.pop()) {
+        delete *event;
+    }
+    m_overflowEvents.clear();
     m_eventQueue.clear();
     qDeleteAll(m_devices);
     qDeleteAll(m_tools);
@@ -159,21 +169,71 @@ void Connection::deactivate()
 
 void Connection::handleEvent()
 {
-    QMutexLocker locker(&m_mutex);
-    const bool wasEmpty = m_eventQueue.empty();
+    bool received = false;
+    bool urgent = false;
+    auto enqueue = [&](std::unique_ptr<Event> &&event) {
+        received = true;
+        urgent |= event->type() != LIBINPUT_EVENT_POINTER_MOTION;
+        if (m_overflowEvents.empty() && m_pendingEvents.push(event.get())) {
+            event.release();
+        } else {
+            m_overflowEvents.push_back(std::move(event));
+            m_overflowed = true;
+        }
+    };
+
+    auto overflowEvents = std::exchange(m_overflowEvents, {});
+    for (auto &event : overflowEvents) {
+        enqueue(std::move(event));
+    }
+
     do {
         m_input->dispatch();
         std::unique_ptr<Event> event = m_input->event();
         if (!event) {
             break;
         }
-        m_eventQueue.push_back(std::move(event));
+        enqueue(std::move(event));
     } while (true);
-    if (wasEmpty && !m_eventQueue.empty()) {
-        Q_EMIT eventsRead();
+
+    if (received && (!m_wakeupPending.exchange(true) || (urgent && m_pointerMotionCoalescing))) {
+        const uint64_t value = 1;
+        if (write(m_wakeupFd.get(), &value, sizeof(value)) != sizeof(value)) {
+            qCWarning(KWIN_LIBINPUT) << "Failed to wake up the main thread:" << strerror(errno);
+        }
+    }
+}
+
+int Connection::wakeupFileDescriptor() const
+{
+    return m_wakeupFd.get();
+}
+
+void Connection::acknowledgeWakeup()
+{
+    uint64_t value;
+    [[maybe_unused]] const ssize_t size = read(m_wakeupFd.get(), &value, sizeof(value));
+}
+
+void Connection::receiveEvents()
+{
+    while (const auto event = m_pendingEvents.pop()) {
+        m_eventQueue.emplace_back(*event);
+    }
+    if (m_overflowed.exchange(false)) {
+        // There is room for the events that didn't fit now
+        QMetaObject::invokeMethod(this, &Connection::handleEvent, Qt::QueuedConnection);
     }
 }
 
+bool Connection::hasOnlyPointerMotion()
+{
+    receiveEvents();
+    return !m_eventQueue.empty() && std::all_of(m_eventQueue.cbegin(), m_eventQueue.cend(), [](const std::unique_ptr<Event> &event) {
+        return event->type() == LIBINPUT_EVENT_POINTER_MOTION;
+    });
+}
+
 #ifndef KWIN_BUILD_TESTING
 QPointF devicePointToGlobalPosition(const QPointF &devicePos, const LogicalOutput *output)
 {
@@ -241,6 +301,9 @@ TabletTool *Connection::getOrCreateTool(libinput_tablet_tool *handle)
 void Connection::processEvents()
 {
     QMutexLocker locker(&m_mutex);
+    // Events that are read from now on need another wakeup
+    m_wakeupPending = false;
+    receiveEvents();
     while (m_eventQueue.size() != 0) {
         std::unique_ptr<Event> event = std::move(m_eventQueue.front());
         m_eventQueue.pop_front();
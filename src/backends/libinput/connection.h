@@ -9,6 +9,8 @@
 #pragma once
 
 #include "effect/globals.h"
+#include "utils/filedescriptor.h"
+#include "utils/spscqueue.h"
 
 #include <KSharedConfig>
 
@@ -18,6 +20,7 @@
 #include <QRecursiveMutex>
 #include <QSize>
 #include <QStringList>
+#include <atomic>
 #include <deque>
 
 class QSocketNotifier;
@@ -57,6 +60,29 @@ public:
     void deactivate();
     void processEvents();
 
+    /**
+     * Returns @c true if there are queued events and all of them are pointer motion events,
+     * which are merged into one when they are processed.
+     */
+    bool hasOnlyPointerMotion();
+
+    /**
+     * Returns the file descriptor that becomes readable when new events have been read and
+     * processEvents() should be called. It must be reset with acknowledgeWakeup().
+     */
+    int wakeupFileDescriptor() const;
+    void acknowledgeWakeup();
+
+    /**
+     * Sets whether the processing of pointer motion may be deferred in order to merge more
+     * events. If enabled, the wakeup file descriptor is also signaled when other events arrive
+     * while events are queued already, so that they don't have to wait.
+     */
+    void setPointerMotionCoalescing(bool enabled)
+    {
+        m_pointerMotionCoalescing = enabled;
+    }
+
     QStringList devicesSysNames() const;
 
     static Connection *create(Session *session);
@@ -65,14 +91,13 @@ Q_SIGNALS:
     void deviceAdded(KWin::LibInput::Device *);
     void deviceRemoved(KWin::LibInput::Device *);
 
-    void eventsRead();
-
 private Q_SLOTS:
     void slotKGlobalSettingsNotifyChange(int type, int arg);
 
 private:
     Connection(std::unique_ptr<Context> &&input);
     void handleEvent();
+    void receiveEvents();
     void applyDeviceConfig(Device *device);
     void applyScreenToDevice(Device *device);
     void doSetup();
@@ -80,6 +105,16 @@ private:
 
     std::unique_ptr<QSocketNotifier> m_notifier;
     QRecursiveMutex m_mutex;
+
+    // Events are passed from the connection thread to the main thread without locking. The
+    // connection thread keeps the events that don't fit until the main thread catches up.
+    SpscQueue<Event *, 1024> m_pendingEvents;
+    std::deque<std::unique_ptr<Event>> m_overflowEvents;
+    std::atomic<bool> m_overflowed = false;
+    FileDescriptor m_wakeupFd;
+    std::atomic<bool> m_wakeupPending = false;
+
+    // The events the main thread has received, but not processed yet
     std::deque<std::unique_ptr<Event>> m_eventQueue;
     QList<Device *> m_devices;
     QList<TabletTool *> m_tools;
@@ -87,6 +122,7 @@ private:
     std::unique_ptr<ConnectionAdaptor> m_connectionAdaptor;
     std::unique_ptr<Context> m_input;
     std::unique_ptr<Udev> m_udev;
+    bool m_pointerMotionCoalescing = false;
 };
 
 }
@@ -8,9 +8,23 @@
 #include "connection.h"
 #include "device.h"
 
+#include "core/output.h"
+#include "utils/envvar.h"
+#include "wayland/pointer.h"
+#include "wayland/seat.h"
+#include "wayland/surface.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
 namespace KWin
 {
 
+/**
+ * Whether pointer motion is merged until the next frame for clients that don't use relative
+ * pointer motion, e.g. to handle mice with very high report rates more efficiently.
+ */
+static const bool s_coalescePointerMotion = environmentVariableBoolValue("KWIN_COALESCE_POINTER_MOTION").value_or(false);
+
 LibinputBackend::LibinputBackend(Session *session, QObject *parent)
     : InputBackend(parent)
 {
@@ -18,13 +32,20 @@ LibinputBackend::LibinputBackend(Session *session, QObject *parent)
     m_thread.start();
 
     m_connection = LibInput::Connection::create(session);
+    m_connection->setPointerMotionCoalescing(s_coalescePointerMotion);
     m_connection->moveToThread(&m_thread);
 
-    connect(
-        m_connection, &LibInput::Connection::eventsRead, this, [this]() {
+    m_wakeupNotifier = std::make_unique<QSocketNotifier>(m_connection->wakeupFileDescriptor(), QSocketNotifier::Read);
+    connect(m_wakeupNotifier.get(), &QSocketNotifier::activated, this, [this]() {
+        m_connection->acknowledgeWakeup();
+        processEvents();
+    });
+
+    m_pointerMotionTimer.setSingleShot(true);
+    m_pointerMotionTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_pointerMotionTimer, &QTimer::timeout, this, [this]() {
         m_connection->processEvents();
-    },
-        Qt::QueuedConnection);
+    });
 
     // Direct connection because the deviceAdded() and the deviceRemoved() signals are emitted
     // from the main thread.
@@ -36,6 +57,7 @@ LibinputBackend::LibinputBackend(Session *session, QObject *parent)
 
 LibinputBackend::~LibinputBackend()
 {
+    m_wakeupNotifier.reset();
     m_connection->deleteLater();
 
     m_thread.quit();
@@ -48,6 +70,35 @@ void LibinputBackend::initialize()
     m_connection->setup();
 }
 
+void LibinputBackend::processEvents()
+{
+    if (s_coalescePointerMotion && m_connection->hasOnlyPointerMotion() && canCoalescePointerMotion()) {
+        if (!m_pointerMotionTimer.isActive()) {
+            uint32_t refreshRate = 60000;
+            if (workspace()) {
+                const auto outputs = workspace()->outputs();
+                for (LogicalOutput *output : outputs) {
+                    refreshRate = std::max(refreshRate, output->refreshRate());
+                }
+            }
+            m_pointerMotionTimer.start(std::chrono::milliseconds(std::max<uint32_t>(1'000'000 / refreshRate, 1)));
+        }
+        return;
+    }
+
+    // Other events are never deferred, any motion queued before them is processed with them
+    m_pointerMotionTimer.stop();
+    m_connection->processEvents();
+}
+
+bool LibinputBackend::canCoalescePointerMotion() const
+{
+    // Relative pointer motion is usually consumed by games, which want every event
+    SeatInterface *seat = waylandServer()->seat();
+    SurfaceInterface *surface = seat->focusedPointerSurface();
+    return !surface || !seat->pointer() || !seat->pointer()->hasRelativePointer(surface->client());
+}
+
 void LibinputBackend::updateScreens()
 {
     m_connection->updateScreens();
@@ -8,7 +8,11 @@
 
 #include "core/inputbackend.h"
 
+#include <QSocketNotifier>
 #include <QThread>
+#include <QTimer>
+
+#include <memory>
 
 namespace KWin
 {
@@ -32,8 +36,13 @@ public:
     void updateScreens() override;
 
 private:
+    void processEvents();
+    bool canCoalescePointerMotion() const;
+
     QThread m_thread;
     LibInput::Connection *m_connection = nullptr;
+    std::unique_ptr<QSocketNotifier> m_wakeupNotifier;
+    QTimer m_pointerMotionTimer;
 };
 
 } // namespace KWin
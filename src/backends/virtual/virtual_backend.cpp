@@ -137,6 +137,7 @@ VirtualOutput *VirtualBackend::createOutput(const OutputInfo &info)
 {
     VirtualOutput *output = new VirtualOutput(this, info.internal, info.physicalSizeInMM, info.panelOrientation, info.edid, info.edidIdentifierOverride, info.connectorName, info.mstPath);
     output->init(info.geometry.topLeft(), info.geometry.size() * info.scale, info.scale, info.modes);
+    output->setSimulatedTiming(info.minVrrRefreshRateHz, info.vblankPhase, info.vblankJitter, info.commitLatency);
     m_outputs.append(output);
     Q_EMIT outputAdded(output);
     return output;
@@ -14,6 +14,8 @@
 
 #include <QRect>
 
+#include <chrono>
+
 namespace KWin
 {
 class VirtualBackend;
@@ -48,6 +50,12 @@ public:
         std::optional<QByteArray> edidIdentifierOverride;
         std::optional<QString> connectorName;
         std::optional<QByteArray> mstPath;
+        // the outputs are simulated to be variable refresh rate capable down to this refresh rate
+        std::optional<uint32_t> minVrrRefreshRateHz;
+        // the timing of the simulated vblanks, see SoftwareVsyncMonitor
+        std::chrono::nanoseconds vblankPhase = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds vblankJitter = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds commitLatency = std::chrono::nanoseconds::zero();
     };
     BackendOutput *addOutput(const OutputInfo &info);
     void setVirtualOutputs(const QList<OutputInfo> &infos);
@@ -56,7 +56,13 @@ bool VirtualOutput::testPresentation(const std::shared_ptr<OutputFrame> &frame)
 bool VirtualOutput::present(const QList<OutputLayer *> &layersToUpdate, const std::shared_ptr<OutputFrame> &frame)
 {
     m_frame = frame;
-    m_vsyncMonitor->arm();
+    m_presentationMode = frame->presentationMode();
+    if (m_presentationMode == PresentationMode::AdaptiveSync && (capabilities() & Capability::Vrr)) {
+        m_vsyncMonitor->armAdaptive(m_state.currentMode->refreshRate());
+    } else {
+        m_presentationMode = PresentationMode::VSync;
+        m_vsyncMonitor->arm();
+    }
     return true;
 }
 
@@ -81,6 +87,18 @@ void VirtualOutput::init(const QPoint &logicalPosition, const QSize &pixelSize,
     });
 }
 
+void VirtualOutput::setSimulatedTiming(std::optional<uint32_t> minVrrRefreshRateHz, std::chrono::nanoseconds phase, std::chrono::nanoseconds jitter, std::chrono::nanoseconds latency)
+{
+    Information info = m_information;
+    info.minVrrRefreshRateHz = minVrrRefreshRateHz;
+    info.capabilities.setFlag(Capability::Vrr, minVrrRefreshRateHz.has_value());
+    setInformation(info);
+
+    m_vsyncMonitor->setPhase(phase);
+    m_vsyncMonitor->setJitter(jitter);
+    m_vsyncMonitor->setLatency(latency);
+}
+
 void VirtualOutput::applyChanges(const OutputConfiguration &config)
 {
     auto props = config.constChangeSet(this);
@@ -103,6 +121,7 @@ void VirtualOutput::applyChanges(const OutputConfiguration &config)
     next.uuid = props->uuid.value_or(m_state.uuid);
     next.replicationSource = props->replicationSource.value_or(m_state.replicationSource);
     next.priority = props->priority.value_or(m_state.priority);
+    next.vrrPolicy = props->vrrPolicy.value_or(m_state.vrrPolicy);
     setState(next);
     m_renderLoop->setRefreshRate(next.currentMode->refreshRate());
     m_vsyncMonitor->setRefreshRate(next.currentMode->refreshRate());
@@ -113,7 +132,7 @@ void VirtualOutput::applyChanges(const OutputConfiguration &config)
 void VirtualOutput::vblank(std::chrono::nanoseconds timestamp)
 {
     if (m_frame) {
-        m_frame->presented(timestamp, PresentationMode::VSync);
+        m_frame->presented(timestamp, m_presentationMode);
         m_frame.reset();
     }
 }
@@ -36,6 +36,8 @@ public:
 
     void applyChanges(const OutputConfiguration &config) override;
 
+    void setSimulatedTiming(std::optional<uint32_t> minVrrRefreshRateHz, std::chrono::nanoseconds phase, std::chrono::nanoseconds jitter, std::chrono::nanoseconds latency);
+
     void setOutputLayer(std::unique_ptr<OutputLayer> &&layer);
     OutputLayer *outputLayer() const;
 
@@ -52,6 +54,7 @@ private:
     bool m_gammaResult = true;
     int m_identifier;
     std::shared_ptr<OutputFrame> m_frame;
+    PresentationMode m_presentationMode = PresentationMode::VSync;
 };
 
 } // namespace KWin
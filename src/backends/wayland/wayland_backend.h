@@ -192,6 +192,11 @@ struct WaylandBackendOptions
     qreal outputScale = 1;
     QSize outputSize = QSize(1024, 768);
     bool fullscreen = false;
+    /**
+     * Whether client buffers are handed to the host compositor as subsurfaces whenever
+     * possible, so that the host does the compositing like with hardware overlay planes
+     */
+    bool forwardSurfaces = false;
 };
 
 /**
@@ -221,6 +226,10 @@ public:
     {
         return m_seat.get();
     }
+    bool forwardsSurfaces() const
+    {
+        return m_options.forwardSurfaces;
+    }
 
     bool supportsPointerLock();
     void togglePointerLock();
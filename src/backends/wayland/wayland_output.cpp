@@ -301,6 +301,11 @@ WaylandOutput::FrameData::~FrameData()
     }
 }
 
+bool WaylandOutput::overlayLayersRecommended() const
+{
+    return m_backend->forwardsSurfaces();
+}
+
 bool WaylandOutput::present(const QList<OutputLayer *> &layersToUpdate, const std::shared_ptr<OutputFrame> &frame)
 {
     auto cursorLayers = layersToUpdate | std::views::filter([](OutputLayer *layer) {
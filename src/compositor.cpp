@@ -13,6 +13,7 @@
 #include "core/backendoutput.h"
 #include "core/brightnessdevice.h"
 #include "core/drmdevice.h"
+#include "core/gpumemory.h"
 #include "core/graphicsbufferview.h"
 #include "core/outputbackend.h"
 #include "core/outputlayer.h"
@@ -22,18 +23,22 @@
 #include "cursorsource.h"
 #include "dbusinterface.h"
 #include "effect/effecthandler.h"
-#include "ftrace.h"
 #include "opengl/eglbackend.h"
+#include "opengl/glpassprofiler.h"
 #include "opengl/glplatform.h"
 #include "qpainter/qpainterbackend.h"
 #include "renderloopdrivenqanimationdriver.h"
 #include "scene/itemrenderer_opengl.h"
 #include "scene/itemrenderer_qpainter.h"
+#include "scene/scenecapture.h"
 #include "scene/surfaceitem.h"
 #include "scene/surfaceitem_wayland.h"
 #include "scene/workspacescene.h"
+#include "tracing.h"
 #include "utils/common.h"
 #include "utils/envvar.h"
+#include "utils/framecounters.h"
+#include "wayland/clientconnection.h"
 #include "wayland/surface.h"
 #include "wayland_server.h"
 #include "window.h"
@@ -84,8 +89,6 @@ Compositor::Compositor(QObject *workspace)
             loop->scheduleRepaint();
         }
     });
-
-    FTraceLogger::create();
 }
 
 Compositor::~Compositor()
@@ -132,6 +135,20 @@ bool Compositor::isActive()
     return m_state == State::On;
 }
 
+bool Compositor::startSceneCapture(const QString &fileName, int frameCount)
+{
+    if (frameCount <= 0) {
+        return false;
+    }
+    auto capture = std::make_unique<SceneCapture>(frameCount);
+    if (!capture->open(fileName)) {
+        qCWarning(KWIN_CORE) << "Failed to open the scene capture file" << fileName;
+        return false;
+    }
+    m_sceneCapture = std::move(capture);
+    return true;
+}
+
 static QVariantHash collectCrashInformation(const EglBackend *backend)
 {
     const GLPlatform *glPlatform = backend->openglContext()->glPlatform();
@@ -435,7 +452,7 @@ static bool prepareDirectScanout(RenderView *view, BackendOutput *output, const
     layer->setSourceRect(candidate->bufferSourceBox());
     layer->setBufferTransform(candidate->bufferTransform());
     layer->setOffloadTransform(candidate->bufferTransform().combine(output->transform().inverted()));
-    layer->setColor(candidate->colorDescription(), candidate->renderingIntent(), ColorPipeline::create(candidate->colorDescription(), output->layerBlendingColor(), candidate->renderingIntent()));
+    layer->setColor(candidate->colorDescription(), candidate->renderingIntent(), ColorConversionCache::lookup(candidate->colorDescription(), output->layerBlendingColor(), candidate->renderingIntent())->pipeline);
     const bool ret = layer->importScanoutBuffer(candidate->buffer(), frame);
     if (ret) {
         candidate->resetDamage();
@@ -491,12 +508,40 @@ static OutputLayer *findLayer(std::span<OutputLayer *const> layers, OutputLayerT
     return it == layers.end() ? nullptr : *it;
 }
 
+static bool fitsRecommendedSizes(OutputLayer *layer, const QSizeF &deviceSize)
+{
+    const auto sizes = layer->recommendedSizes();
+    return sizes.isEmpty() || std::ranges::any_of(sizes, [deviceSize](const QSize &size) {
+        return size.width() >= deviceSize.width() && size.height() >= deviceSize.height();
+    });
+}
+
+static SceneClass currentSceneClass()
+{
+    if (!effects) {
+        return SceneClass::Plain;
+    }
+    if (effects->activeFullScreenEffect()) {
+        return SceneClass::Effect;
+    }
+    if (effects->isEffectActive(QStringLiteral("blur"))) {
+        return SceneClass::Blur;
+    }
+    return SceneClass::Plain;
+}
+
 static const bool s_forceSoftwareCursor = environmentVariableBoolValue("KWIN_FORCE_SW_CURSOR").value_or(false);
 
+static bool canOffloadColor(OutputLayer *layer, SurfaceItem *item, BackendOutput *output)
+{
+    const auto conversion = ColorConversionCache::lookup(item->colorDescription(), output->layerBlendingColor(), item->renderingIntent());
+    return layer->canOffloadColorPipeline(conversion->pipeline);
+}
+
 /**
  * items and layers need to be sorted top to bottom
  */
-static std::unordered_map<SurfaceItem *, OutputLayer *> assignOverlays(RenderView *sceneView, std::span<SurfaceItem *const> underlays, std::span<SurfaceItem *const> overlays, std::span<OutputLayer *const> layers)
+static std::unordered_map<SurfaceItem *, OutputLayer *> assignOverlays(RenderView *sceneView, BackendOutput *output, std::span<SurfaceItem *const> underlays, std::span<SurfaceItem *const> overlays, std::span<OutputLayer *const> layers)
 {
     if (layers.empty() || (underlays.empty() && overlays.empty())) {
         return {};
@@ -536,6 +581,12 @@ static std::unordered_map<SurfaceItem *, OutputLayer *> assignOverlays(RenderVie
                 continue;
             }
         }
+        if (!canOffloadColor(layer, item, output)) {
+            // the plane can't convert the item to the blending color space, e.g. HDR
+            // video on a plane without a color pipeline; maybe the next one can
+            layerIt++;
+            continue;
+        }
         layer->setZpos(nextZpos);
         ret[item] = layer;
         overlaysIt++;
@@ -580,6 +631,12 @@ static std::unordered_map<SurfaceItem *, OutputLayer *> assignOverlays(RenderVie
                 continue;
             }
         }
+        if (!canOffloadColor(layer, item, output)) {
+            // the plane can't convert the item to the blending color space, e.g. HDR
+            // video on a plane without a color pipeline; maybe the next one can
+            layerIt++;
+            continue;
+        }
         layer->setZpos(nextZpos);
         ret[item] = layer;
         underlaysIt++;
@@ -610,7 +667,13 @@ void Compositor::composite(RenderLoop *renderLoop)
     BackendOutput *output = findOutput(renderLoop);
     LogicalOutput *logical = findLogicalOutput(output);
     const auto primaryView = m_primaryViews[renderLoop].get();
-    fTraceDuration("Paint (", output->name(), ")");
+    traceScope(Scene, "paint");
+    const FrameCounters::Values countersBefore = FrameCounters::snapshot();
+    const GpuMemoryOwner memoryOwner{
+        .kind = GpuMemoryOwner::Kind::Output,
+        .name = output->name(),
+    };
+    GpuMemoryOwnerScope memoryScope(&memoryOwner);
 
     QList<OutputLayer *> toUpdate;
 
@@ -619,6 +682,11 @@ void Compositor::composite(RenderLoop *renderLoop)
     auto frame = std::make_shared<OutputFrame>(renderLoop, std::chrono::nanoseconds(1'000'000'000'000 / output->refreshRate()));
     std::optional<double> desiredArtificalHdrHeadroom;
 
+    // the next frames will most likely contain the same kind of content as this one
+    const SceneClass sceneClass = currentSceneClass();
+    frame->setSceneClass(sceneClass);
+    renderLoop->setSceneClass(sceneClass);
+
     // brightness animations should be skipped when
     // - the output is new, and we didn't have the output configuration applied yet
     // - there's not enough steps to do a smooth animation
@@ -661,6 +729,13 @@ void Compositor::composite(RenderLoop *renderLoop)
     QList<LayerData> layers;
 
     primaryView->prePaint();
+    if (m_sceneCapture) {
+        // the damage is only known between prePaint() and collectDamage()
+        m_sceneCapture->addFrame(m_sceneCapture->captureFrame({m_scene->containerItem(), m_scene->overlayItem()}, primaryView, output->name(), std::chrono::steady_clock::now().time_since_epoch()));
+        if (m_sceneCapture->isFinished()) {
+            m_sceneCapture.reset();
+        }
+    }
     layers.push_back(LayerData{
         .view = primaryView,
         .directScanout = false,
@@ -710,11 +785,15 @@ void Compositor::composite(RenderLoop *renderLoop)
         if (!cursorLayer) {
             cursorLayer = findLayer(unusedOutputLayers, OutputLayerType::GenericLayer, primaryView->layer()->zpos() + 1);
         }
+        if (cursorLayer && !fitsRecommendedSizes(cursorLayer, cursorItem->boundingRect().size() * output->scale())) {
+            // e.g. a big drag and drop icon that moves with the cursor, render it with the scene instead
+            cursorLayer = nullptr;
+        }
         if (cursorLayer) {
             auto &view = m_overlayViews[renderLoop][cursorLayer];
             if (!view || view->item() != cursorItem) {
                 view = std::make_unique<ItemTreeView>(primaryView, cursorItem, logical, cursorLayer);
-                connect(cursorLayer, &OutputLayer::repaintScheduled, view.get(), [output, cursorView = view.get()]() {
+                connect(cursorLayer, &OutputLayer::repaintScheduled, view.get(), [output, cursorView = view.get(), presentedRect = std::optional<QRect>()]() mutable {
                     // this just deals with moving the plane asynchronously, for improved latency.
                     // enabling, disabling and updating the cursor image still happen in composite()
                     const auto outputLayer = cursorView->layer();
@@ -736,12 +815,22 @@ void Compositor::composite(RenderLoop *renderLoop)
                     }
                     const QRectF outputLocalRect = output->mapFromGlobal(cursorView->viewport());
                     const QRectF nativeCursorRect = output->transform().map(QRectF(outputLocalRect.topLeft() * output->scale(), outputLayer->targetRect().size()), output->pixelSize());
-                    outputLayer->setTargetRect(QRect(nativeCursorRect.topLeft().toPoint(), outputLayer->targetRect().size()));
+                    const QRect targetRect(nativeCursorRect.topLeft().toPoint(), outputLayer->targetRect().size());
+                    if (targetRect == presentedRect && targetRect == outputLayer->targetRect()) {
+                        // a move gets announced both before and after the position changes, and once
+                        // for every child of the cursor item, only the actual change needs a commit
+                        outputLayer->resetRepaints();
+                        return;
+                    }
+                    outputLayer->setTargetRect(targetRect);
                     outputLayer->setEnabled(true);
                     if (output->presentAsync(outputLayer, maxVrrCursorDelay)) {
                         // prevent composite() from also pushing an update with the cursor layer
                         // to avoid adding cursor updates that are synchronized with primary layer updates
                         outputLayer->resetRepaints();
+                        presentedRect = targetRect;
+                    } else {
+                        presentedRect.reset();
                     }
                 });
             }
@@ -774,8 +863,8 @@ void Compositor::composite(RenderLoop *renderLoop)
     });
     const auto [overlayCandidates, underlayCandidates] = m_scene->overlayCandidates(specialLayers.size(), maxOverlayCount, maxUnderlayCount);
     std::unordered_map<SurfaceItem *, OutputLayer *> overlayAssignments;
-    if (m_allowOverlaysEnv.value_or(!output->overlayLayersLikelyBroken() && PROJECT_VERSION_PATCH >= 80)) {
-        overlayAssignments = assignOverlays(primaryView, underlayCandidates, overlayCandidates, specialLayers);
+    if (m_allowOverlaysEnv.value_or(output->overlayLayersRecommended() || (!output->overlayLayersLikelyBroken() && PROJECT_VERSION_PATCH >= 80))) {
+        overlayAssignments = assignOverlays(primaryView, output, underlayCandidates, overlayCandidates, specialLayers);
     }
     for (const auto &[item, layer] : overlayAssignments) {
         auto &view = m_overlayViews[output->renderLoop()][layer];
@@ -873,6 +962,14 @@ void Compositor::composite(RenderLoop *renderLoop)
         // Note that effects may schedule repaints while rendering
         renderLoop->newFramePrepared();
 
+        GLPassProfiler *profiler = nullptr;
+        if (auto eglBackend = qobject_cast<EglBackend *>(m_backend.get())) {
+            profiler = eglBackend->openglContext()->passProfiler();
+        }
+        if (profiler) {
+            profiler->beginFrame(output->name());
+        }
+
         for (auto &layer : layers) {
             if (!layer.view->layer()->needsRepaint()) {
                 continue;
@@ -889,6 +986,10 @@ void Compositor::composite(RenderLoop *renderLoop)
                 }
             }
         }
+
+        if (profiler) {
+            profiler->endFrame();
+        }
     } else {
         renderLoop->newFramePrepared();
     }
@@ -910,6 +1011,7 @@ void Compositor::composite(RenderLoop *renderLoop)
         });
         auto &primary = layers.front();
         if (primary.directScanout || !toDisable.empty()) {
+            primary.directScanout = false;
             for (const auto &layer : toDisable) {
                 layer.view->layer()->setEnabled(false);
                 layer.view->setExclusive(false);
@@ -945,6 +1047,25 @@ void Compositor::composite(RenderLoop *renderLoop)
         }
     }
 
+    if (result && tearing) {
+        if (auto wayland = qobject_cast<SurfaceItemWayland *>(activeFullscreenItem); wayland && wayland->surface()) {
+            wayland->surface()->client()->addTearingPresentation();
+        }
+    }
+
+    if (result) {
+        // let the clients know which of their buffers are shown without being composited
+        for (const auto &layer : layers) {
+            if (!layer.directScanout || !layer.view->layer()->isEnabled()) {
+                continue;
+            }
+            const auto candidates = layer.view->scanoutCandidates(1);
+            if (auto wayland = qobject_cast<SurfaceItemWayland *>(candidates.value(0)); wayland && wayland->surface()) {
+                wayland->surface()->markZeroCopy();
+            }
+        }
+    }
+
     for (auto &layer : layers) {
         layer.view->postPaint();
         if (layer.view->layer()->isEnabled()) {
@@ -964,6 +1085,17 @@ void Compositor::composite(RenderLoop *renderLoop)
         output->repairPresentation();
     }
 
+    if constexpr (FrameCounters::isCompiledIn()) {
+        FrameCounterRecord record{
+            .timestamp = std::chrono::steady_clock::now().time_since_epoch(),
+            .values = FrameCounters::snapshot(),
+        };
+        for (size_t i = 0; i < FrameCounters::s_counterCount; ++i) {
+            record.values[i] -= countersBefore[i];
+        }
+        renderLoop->addFrameCounters(record);
+    }
+
     const bool forceRepaintForBrightness = (frame->brightness() && std::abs(*frame->brightness() - output->brightnessSetting() * output->dimming()) > 0.001)
         || (desiredArtificalHdrHeadroom && frame->artificialHdrHeadroom() && std::abs(*frame->artificialHdrHeadroom() - *desiredArtificalHdrHeadroom) > 0.001);
 
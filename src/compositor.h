@@ -35,6 +35,7 @@ class OutputFrame;
 class SceneView;
 class ItemView;
 class RenderLoopDrivenQAnimationDriver;
+class SceneCapture;
 
 class KWIN_EXPORT Compositor : public QObject
 {
@@ -78,6 +79,12 @@ public:
 
     void createRenderer();
 
+    /**
+     * Writes the item trees of the next @a frameCount frames to @a fileName, so that they can
+     * be replayed with kwin_replay. Returns false if the file can't be written.
+     */
+    bool startSceneCapture(const QString &fileName, int frameCount);
+
 Q_SIGNALS:
     void compositingToggled(bool active);
     void aboutToDestroy();
@@ -116,6 +123,7 @@ protected:
     std::unordered_set<RenderLoop *> m_brokenCursors;
     std::optional<bool> m_allowOverlaysEnv;
     RenderLoopDrivenQAnimationDriver *m_renderLoopDrivenAnimationDriver;
+    std::unique_ptr<SceneCapture> m_sceneCapture;
 };
 
 } // namespace KWin
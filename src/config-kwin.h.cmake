@@ -13,6 +13,7 @@
 #cmakedefine01 KWIN_BUILD_GLOBALSHORTCUTS
 #cmakedefine01 KWIN_BUILD_X11
 #cmakedefine01 KWIN_BUILD_QACCESSIBILITYCLIENT
+#cmakedefine01 KWIN_BUILD_FRAME_COUNTERS
 constexpr QLatin1String KWIN_CONFIG("kwinrc");
 constexpr QLatin1String KWIN_VERSION_STRING("${PROJECT_VERSION}");
 constexpr QLatin1String XCB_VERSION_STRING("${XCB_VERSION}");
@@ -607,6 +607,11 @@ bool BackendOutput::overlayLayersLikelyBroken() const
     return false;
 }
 
+bool BackendOutput::overlayLayersRecommended() const
+{
+    return false;
+}
+
 QRect BackendOutput::rect() const
 {
     return QRect(QPoint(0, 0), geometry().size());
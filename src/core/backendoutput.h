@@ -296,6 +296,12 @@ public:
      */
     virtual bool overlayLayersLikelyBroken() const;
 
+    /**
+     * Can be used by the backend to ask the compositor to use overlay planes
+     * whenever possible, even where they are not used by default
+     */
+    virtual bool overlayLayersRecommended() const;
+
     /**
      * The color space in which the scene is blended
      */
@@ -47,4 +47,24 @@ QVector3D ColorLUT3D::sample(size_t x, size_t y, size_t z)
     return m_transformation->transform(QVector3D(x / double(m_xSize - 1), y / double(m_ySize - 1), z / double(m_zSize - 1)));
 }
 
+void ColorLUT3D::sample(std::span<QVector3D> colors) const
+{
+    m_transformation->transform(colors);
+}
+
+std::vector<QVector3D> ColorLUT3D::samples() const
+{
+    std::vector<QVector3D> ret;
+    ret.reserve(m_xSize * m_ySize * m_zSize);
+    for (size_t z = 0; z < m_zSize; z++) {
+        for (size_t y = 0; y < m_ySize; y++) {
+            for (size_t x = 0; x < m_xSize; x++) {
+                ret.emplace_back(x / double(m_xSize - 1), y / double(m_ySize - 1), z / double(m_zSize - 1));
+            }
+        }
+    }
+    m_transformation->transform(ret);
+    return ret;
+}
+
 }
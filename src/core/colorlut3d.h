@@ -10,6 +10,8 @@
 
 #include <QVector>
 #include <memory>
+#include <span>
+#include <vector>
 
 #include "kwin_export.h"
 
@@ -32,6 +34,16 @@ public:
     QVector3D sample(const QVector3D &rgb);
     QVector3D sample(size_t x, size_t y, size_t z);
 
+    /**
+     * Samples all @a colors in place.
+     */
+    void sample(std::span<QVector3D> colors) const;
+
+    /**
+     * Returns all entries of the lookup table, with x being the innermost dimension.
+     */
+    std::vector<QVector3D> samples() const;
+
 private:
     const std::unique_ptr<ColorTransformation> m_transformation;
     const size_t m_xSize;
@@ -79,6 +79,61 @@ ColorPipeline ColorPipeline::create(const std::shared_ptr<ColorDescription> &fro
     return ret;
 }
 
+namespace
+{
+struct ColorConversionSlot
+{
+    std::weak_ptr<ColorDescription> from;
+    std::weak_ptr<ColorDescription> to;
+    RenderingIntent intent;
+    std::shared_ptr<const ColorConversionCache::Entry> entry;
+};
+}
+
+// A scene rarely has more than a handful of distinct conversions, e.g. from SDR and HDR
+// windows to every output
+static const size_t s_colorConversionCacheSize = 16;
+static thread_local std::vector<ColorConversionSlot> s_colorConversionSlots;
+
+std::shared_ptr<const ColorConversionCache::Entry> ColorConversionCache::lookup(const std::shared_ptr<ColorDescription> &from, const std::shared_ptr<ColorDescription> &to, RenderingIntent intent)
+{
+    // An expired slot may refer to an address that has been reused by another description
+    std::erase_if(s_colorConversionSlots, [](const ColorConversionSlot &slot) {
+        return slot.from.expired() || slot.to.expired();
+    });
+
+    for (const ColorConversionSlot &slot : s_colorConversionSlots) {
+        if (slot.intent == intent && slot.from.lock() == from && slot.to.lock() == to) {
+            return slot.entry;
+        }
+    }
+
+    std::shared_ptr<const Entry> entry;
+    for (const ColorConversionSlot &slot : s_colorConversionSlots) {
+        if (slot.intent == intent && *slot.from.lock() == *from && *slot.to.lock() == *to) {
+            entry = slot.entry;
+            break;
+        }
+    }
+    if (!entry) {
+        entry = std::make_shared<const Entry>(Entry{
+            .pipeline = ColorPipeline::create(from, to, intent),
+            .toOther = from->toOther(*to, intent),
+        });
+    }
+
+    if (s_colorConversionSlots.size() >= s_colorConversionCacheSize) {
+        s_colorConversionSlots.erase(s_colorConversionSlots.begin());
+    }
+    s_colorConversionSlots.push_back(ColorConversionSlot{
+        .from = from,
+        .to = to,
+        .intent = intent,
+        .entry = entry,
+    });
+    return entry;
+}
+
 ColorPipeline::ColorPipeline()
     : inputRange(ValueRange{
           .min = 0,
@@ -166,6 +221,24 @@ void ColorPipeline::addTransferFunction(TransferFunction tf, ColorspaceType outp
                 ops.erase(ops.end() - 1);
                 return;
             }
+            // encoding with a transfer function and decoding with another one of the same type
+            // only remaps the luminance range, as long as nothing gets clipped by the encoding
+            const TransferFunction encoding = invTf->tf;
+            const ValueRange input = ops.back().input;
+            if (encoding.type == tf.type && encoding.hasLinearMinLuminance() && tf.hasLinearMinLuminance()
+                && input.min >= encoding.minLuminance - s_maxResolution && input.max <= encoding.maxLuminance * (1 + s_maxResolution)) {
+                QMatrix4x4 mat;
+                mat.translate(tf.minLuminance, tf.minLuminance, tf.minLuminance);
+                mat.scale((tf.maxLuminance - tf.minLuminance) / (encoding.maxLuminance - encoding.minLuminance));
+                mat.translate(-encoding.minLuminance, -encoding.minLuminance, -encoding.minLuminance);
+                ops.erase(ops.end() - 1);
+                addMatrix(mat, ValueRange{
+                                   .min = (mat * QVector3D(input.min, 0, 0)).x(),
+                                   .max = (mat * QVector3D(input.max, 0, 0)).x(),
+                               },
+                          outputType);
+                return;
+            }
         }
     }
     if (tf.type == TransferFunction::linear) {
@@ -199,6 +272,17 @@ void ColorPipeline::addInverseTransferFunction(TransferFunction tf, ColorspaceTy
                 ops.erase(ops.end() - 1);
                 return;
             }
+            // decoding and encoding again with pure power functions of different brightness
+            // only scales the encoded values, as long as nothing gets clipped by the encoding
+            const TransferFunction decoding = otherTf->tf;
+            const ValueRange input = ops.back().input;
+            if (decoding.type == TransferFunction::gamma22 && tf.type == TransferFunction::gamma22
+                && std::abs(decoding.minLuminance) < s_maxResolution && std::abs(tf.minLuminance) < s_maxResolution
+                && input.min >= 0 && decoding.encodedToNits(input.max) <= tf.maxLuminance * (1 + s_maxResolution)) {
+                ops.erase(ops.end() - 1);
+                addMultiplier(std::pow(decoding.maxLuminance / tf.maxLuminance, 1.0 / 2.2));
+                return;
+            }
         }
     }
     if (tf.type == TransferFunction::linear) {
@@ -445,6 +529,39 @@ QVector3D ColorOp::applyOperation(const ColorOp::Operation &operation, const QVe
     }
 }
 
+void ColorOp::applyOperations(std::span<const ColorOp::Operation> operations, std::span<QVector3D> colors)
+{
+    for (const Operation &operation : operations) {
+        if (const auto mat = std::get_if<ColorMatrix>(&operation)) {
+            for (QVector3D &color : colors) {
+                color = mat->mat * color;
+            }
+        } else if (const auto mult = std::get_if<ColorMultiplier>(&operation)) {
+            for (QVector3D &color : colors) {
+                color *= mult->factors;
+            }
+        } else if (const auto tf = std::get_if<ColorTransferFunction>(&operation)) {
+            for (QVector3D &color : colors) {
+                color = tf->tf.encodedToNits(color);
+            }
+        } else if (const auto tf = std::get_if<InverseColorTransferFunction>(&operation)) {
+            for (QVector3D &color : colors) {
+                color = tf->tf.nitsToEncoded(color);
+            }
+        } else if (const auto tonemap = std::get_if<ColorTonemapper>(&operation)) {
+            for (QVector3D &color : colors) {
+                color.setX(tonemap->map(color.x()));
+            }
+        } else if (const auto transform1D = std::get_if<std::shared_ptr<ColorTransformation>>(&operation)) {
+            (*transform1D)->transform(colors);
+        } else if (const auto transform3D = std::get_if<std::shared_ptr<ColorLUT3D>>(&operation)) {
+            (*transform3D)->sample(colors);
+        } else {
+            Q_UNREACHABLE();
+        }
+    }
+}
+
 ColorTransferFunction::ColorTransferFunction(TransferFunction tf)
     : tf(tf)
 {
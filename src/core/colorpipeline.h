@@ -102,6 +102,11 @@ public:
     bool operator==(const ColorOp &) const = default;
     QVector3D apply(const QVector3D input) const;
     static QVector3D applyOperation(const ColorOp::Operation &operation, const QVector3D &input);
+    /**
+     * Applies the @a operations to all @a colors in place, one operation after the other. This
+     * is a lot faster than applying them to every color separately when baking lookup tables.
+     */
+    static void applyOperations(std::span<const ColorOp::Operation> operations, std::span<QVector3D> colors);
 };
 
 class KWIN_EXPORT ColorPipeline
@@ -142,6 +147,29 @@ public:
     std::vector<ColorOp> ops;
 };
 
+/**
+ * The ColorConversionCache class remembers how to convert between recently used pairs of
+ * color descriptions, so the pipelines and shader parameters don't have to be built again in
+ * every frame.
+ *
+ * Descriptions are looked up by identity first and by value second, so equal descriptions
+ * held by different objects share one entry. The cache is per thread.
+ */
+class KWIN_EXPORT ColorConversionCache
+{
+public:
+    struct Entry
+    {
+        ColorPipeline pipeline;
+        /**
+         * The colorimetry transformation from ColorDescription::toOther(), as used by shaders.
+         */
+        QMatrix4x4 toOther;
+    };
+
+    static std::shared_ptr<const Entry> lookup(const std::shared_ptr<ColorDescription> &from, const std::shared_ptr<ColorDescription> &to, RenderingIntent intent);
+};
+
 KWIN_EXPORT bool isFuzzyIdentity(const QMatrix4x4 &mat);
 }
 
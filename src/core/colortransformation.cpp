@@ -9,6 +9,9 @@
 #include "colortransformation.h"
 #include "colorpipelinestage.h"
 
+#include <QVector3D>
+#include <QtConcurrentMap>
+
 #include <lcms2.h>
 
 #include "utils/common.h"
@@ -78,6 +81,32 @@ QVector3D ColorTransformation::transform(QVector3D in) const
     return ret;
 }
 
+// Evaluating the pipeline takes in the order of a microsecond per color, a batch has to be
+// about this big to be worth handing over to another thread
+static const size_t s_minimumBatchSize = 4096;
+
+void ColorTransformation::transform(std::span<QVector3D> colors) const
+{
+    const auto evaluate = [this](std::span<QVector3D> batch) {
+        for (QVector3D &color : batch) {
+            QVector3D in = color;
+            cmsPipelineEvalFloat(&in[0], &color[0], m_pipeline);
+        }
+    };
+
+    if (colors.size() < 2 * s_minimumBatchSize) {
+        evaluate(colors);
+        return;
+    }
+
+    std::vector<std::span<QVector3D>> batches;
+    batches.reserve(colors.size() / s_minimumBatchSize + 1);
+    for (size_t offset = 0; offset < colors.size(); offset += s_minimumBatchSize) {
+        batches.push_back(colors.subspan(offset, std::min(s_minimumBatchSize, colors.size() - offset)));
+    }
+    QtConcurrent::blockingMap(batches, evaluate);
+}
+
 std::unique_ptr<ColorTransformation> ColorTransformation::createScalingTransform(const QVector3D &scale)
 {
     std::array<double, 3> curveParams = {1.0, scale.x(), 0.0};
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <stdint.h>
 #include <tuple>
 #include <vector>
@@ -36,6 +37,12 @@ public:
     std::tuple<uint16_t, uint16_t, uint16_t> transform(uint16_t r, uint16_t g, uint16_t b) const;
     QVector3D transform(QVector3D in) const;
 
+    /**
+     * Transforms all @a colors in place. Big batches are split up across the threads of the
+     * global thread pool.
+     */
+    void transform(std::span<QVector3D> colors) const;
+
     static std::unique_ptr<ColorTransformation> createScalingTransform(const QVector3D &scale);
 
 private:
@@ -0,0 +1,184 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "core/gpumemory.h"
+
+#include <map>
+#include <utility>
+#include <mutex>
+#include <numeric>
+
+namespace KWin
+{
+
+struct GpuMemoryAccountingEntry
+{
+    GpuMemoryOwner owner;
+    std::array<uint64_t, s_gpuMemoryCategoryCount> byteSize{};
+    uint64_t allocationCount = 0;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::map<GpuMemoryOwner, GpuMemoryAccountingEntry> entries;
+};
+
+static Registry &registry()
+{
+    // leaked on purpose, textures of static objects may be released after everything else
+    static Registry *registry = new Registry();
+    return *registry;
+}
+
+static const GpuMemoryOwner s_compositorOwner{
+    .kind = GpuMemoryOwner::Kind::Compositor,
+    .name = QString(),
+};
+static thread_local const GpuMemoryOwner *s_currentOwner = &s_compositorOwner;
+
+GpuMemoryOwnerScope::GpuMemoryOwnerScope(const GpuMemoryOwner *owner)
+    : m_previous(std::exchange(s_currentOwner, owner))
+{
+}
+
+GpuMemoryOwnerScope::~GpuMemoryOwnerScope()
+{
+    s_currentOwner = m_previous;
+}
+
+GpuMemoryAllocation::GpuMemoryAllocation(GpuMemoryCategory category, uint64_t byteSize)
+    : m_category(category)
+    , m_byteSize(byteSize)
+{
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+    auto it = reg.entries.find(*s_currentOwner);
+    if (it == reg.entries.end()) {
+        it = reg.entries.emplace(*s_currentOwner, GpuMemoryAccountingEntry{.owner = *s_currentOwner}).first;
+    }
+    m_entry = &it->second;
+    m_entry->byteSize[size_t(category)] += byteSize;
+    m_entry->allocationCount++;
+}
+
+GpuMemoryAllocation::GpuMemoryAllocation(GpuMemoryAllocation &&other)
+    : m_entry(std::exchange(other.m_entry, nullptr))
+    , m_category(other.m_category)
+    , m_byteSize(std::exchange(other.m_byteSize, 0))
+{
+}
+
+GpuMemoryAllocation &GpuMemoryAllocation::operator=(GpuMemoryAllocation &&other)
+{
+    if (this != &other) {
+        release();
+        m_entry = std::exchange(other.m_entry, nullptr);
+        m_category = other.m_category;
+        m_byteSize = std::exchange(other.m_byteSize, 0);
+    }
+    return *this;
+}
+
+GpuMemoryAllocation::~GpuMemoryAllocation()
+{
+    release();
+}
+
+uint64_t GpuMemoryAllocation::byteSize() const
+{
+    return m_byteSize;
+}
+
+void GpuMemoryAllocation::release()
+{
+    if (!m_entry) {
+        return;
+    }
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+    m_entry->byteSize[size_t(m_category)] -= m_byteSize;
+    if (--m_entry->allocationCount == 0) {
+        const GpuMemoryOwner owner = m_entry->owner;
+        reg.entries.erase(owner);
+    }
+    m_entry = nullptr;
+    m_byteSize = 0;
+}
+
+GpuMemoryAccounting *GpuMemoryAccounting::self()
+{
+    static GpuMemoryAccounting accounting;
+    return &accounting;
+}
+
+std::vector<GpuMemoryAccounting::Usage> GpuMemoryAccounting::usage() const
+{
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+    std::vector<Usage> ret;
+    ret.reserve(reg.entries.size());
+    for (const auto &[owner, entry] : reg.entries) {
+        ret.push_back(Usage{
+            .owner = owner,
+            .byteSize = entry.byteSize,
+        });
+    }
+    return ret;
+}
+
+uint64_t GpuMemoryAccounting::totalByteSize() const
+{
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+    uint64_t ret = 0;
+    for (const auto &[owner, entry] : reg.entries) {
+        ret = std::accumulate(entry.byteSize.begin(), entry.byteSize.end(), ret);
+    }
+    return ret;
+}
+
+void GpuMemoryAccounting::trim()
+{
+    Q_EMIT trimRequested();
+}
+
+QString GpuMemoryAccounting::ownerKindName(GpuMemoryOwner::Kind kind)
+{
+    switch (kind) {
+    case GpuMemoryOwner::Kind::Compositor:
+        return QStringLiteral("compositor");
+    case GpuMemoryOwner::Kind::Output:
+        return QStringLiteral("output");
+    case GpuMemoryOwner::Kind::Window:
+        return QStringLiteral("window");
+    case GpuMemoryOwner::Kind::Effect:
+        return QStringLiteral("effect");
+    }
+    Q_UNREACHABLE();
+}
+
+QString GpuMemoryAccounting::categoryName(GpuMemoryCategory category)
+{
+    switch (category) {
+    case GpuMemoryCategory::Texture:
+        return QStringLiteral("textures");
+    case GpuMemoryCategory::Renderbuffer:
+        return QStringLiteral("renderbuffers");
+    case GpuMemoryCategory::Swapchain:
+        return QStringLiteral("swapchains");
+    case GpuMemoryCategory::ScreenCast:
+        return QStringLiteral("screencasts");
+    }
+    Q_UNREACHABLE();
+}
+
+} // namespace KWin
+
+#include "moc_gpumemory.cpp"
@@ -0,0 +1,138 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QObject>
+#include <QString>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace KWin
+{
+
+enum class GpuMemoryCategory {
+    Texture,
+    Renderbuffer,
+    Swapchain,
+    ScreenCast,
+};
+static constexpr size_t s_gpuMemoryCategoryCount = size_t(GpuMemoryCategory::ScreenCast) + 1;
+
+/**
+ * The GpuMemoryOwner struct describes what GPU memory has been allocated for.
+ */
+struct GpuMemoryOwner
+{
+    enum class Kind {
+        Compositor,
+        Output,
+        Window,
+        Effect,
+    };
+
+    Kind kind = Kind::Compositor;
+    QString name;
+
+    bool operator==(const GpuMemoryOwner &other) const
+    {
+        return kind == other.kind && name == other.name;
+    }
+    bool operator<(const GpuMemoryOwner &other) const
+    {
+        return kind != other.kind ? kind < other.kind : name < other.name;
+    }
+};
+
+struct GpuMemoryAccountingEntry;
+
+/**
+ * The GpuMemoryOwnerScope class attributes all GPU memory that is allocated on the current
+ * thread while it exists to the given owner. Scopes can be nested, the innermost one wins.
+ * Memory allocated outside of any scope belongs to the compositor.
+ *
+ * The @a owner must outlive the scope.
+ */
+class KWIN_EXPORT GpuMemoryOwnerScope
+{
+public:
+    explicit GpuMemoryOwnerScope(const GpuMemoryOwner *owner);
+    ~GpuMemoryOwnerScope();
+
+    GpuMemoryOwnerScope(const GpuMemoryOwnerScope &) = delete;
+    GpuMemoryOwnerScope &operator=(const GpuMemoryOwnerScope &) = delete;
+
+private:
+    const GpuMemoryOwner *m_previous;
+};
+
+/**
+ * The GpuMemoryAllocation class accounts for a piece of GPU memory while it exists. It's
+ * meant to live next to the handle of the memory, e.g. as a member of the texture.
+ */
+class KWIN_EXPORT GpuMemoryAllocation
+{
+public:
+    GpuMemoryAllocation() = default;
+    GpuMemoryAllocation(GpuMemoryCategory category, uint64_t byteSize);
+    GpuMemoryAllocation(GpuMemoryAllocation &&other);
+    GpuMemoryAllocation &operator=(GpuMemoryAllocation &&other);
+    ~GpuMemoryAllocation();
+
+    uint64_t byteSize() const;
+
+private:
+    void release();
+
+    GpuMemoryAccountingEntry *m_entry = nullptr;
+    GpuMemoryCategory m_category = GpuMemoryCategory::Texture;
+    uint64_t m_byteSize = 0;
+};
+
+/**
+ * The GpuMemoryAccounting class keeps track of how much GPU memory KWin holds, by owner
+ * and category. The numbers only cover the memory that KWin allocates itself, client
+ * buffers are owned by the clients.
+ */
+class KWIN_EXPORT GpuMemoryAccounting : public QObject
+{
+    Q_OBJECT
+
+public:
+    static GpuMemoryAccounting *self();
+
+    struct Usage
+    {
+        GpuMemoryOwner owner;
+        std::array<uint64_t, s_gpuMemoryCategoryCount> byteSize{};
+    };
+    /**
+     * Returns the memory held by every owner that holds any.
+     */
+    std::vector<Usage> usage() const;
+    uint64_t totalByteSize() const;
+
+    /**
+     * Asks everything that caches GPU memory to release what isn't needed right now,
+     * e.g. because an allocation failed.
+     */
+    void trim();
+
+    static QString ownerKindName(GpuMemoryOwner::Kind kind);
+    static QString categoryName(GpuMemoryCategory category);
+
+Q_SIGNALS:
+    void trimRequested();
+};
+
+} // namespace KWin
@@ -5,6 +5,7 @@
 */
 
 #include "core/graphicsbuffer.h"
+#include "core/syncobjtimeline.h"
 #include "utils/drm_format_helper.h"
 
 #include <QCoreApplication>
@@ -93,6 +94,18 @@ void GraphicsBuffer::addReleasePoint(const std::shared_ptr<SyncReleasePoint> &re
     m_releasePoints.push_back(releasePoint);
 }
 
+bool GraphicsBuffer::hasReleasePoints() const
+{
+    return !m_releasePoints.empty();
+}
+
+void GraphicsBuffer::addReleaseFence(const FileDescriptor &fence)
+{
+    for (const auto &releasePoint : m_releasePoints) {
+        releasePoint->addReleaseFence(fence);
+    }
+}
+
 bool GraphicsBuffer::alphaChannelFromDrmFormat(uint32_t format)
 {
     const auto info = FormatInfo::get(format);
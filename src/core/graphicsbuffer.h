@@ -95,6 +95,11 @@ public:
      * the added release point will be referenced as long as this buffer is referenced
      */
     void addReleasePoint(const std::shared_ptr<SyncReleasePoint> &releasePoint);
+    bool hasReleasePoints() const;
+    /**
+     * makes all release points of this buffer wait for @p fence before they signal
+     */
+    void addReleaseFence(const FileDescriptor &fence);
 
     static bool alphaChannelFromDrmFormat(uint32_t format);
 
@@ -10,7 +10,14 @@
 #include "utils/common.h"
 
 #include <KLocalizedString>
+#include <QCryptographicHash>
+#include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 #include <lcms2.h>
 #include <span>
 #include <tuple>
@@ -323,18 +330,11 @@ static constexpr XYZ D50{
     .Z = 0.8249,
 };
 
-std::expected<std::unique_ptr<IccProfile>, QString> IccProfile::load(const QString &path)
+static std::expected<std::unique_ptr<IccProfile>, QString> parseProfile(const QString &path, const QByteArray &data)
 {
-    if (path.isEmpty()) {
-        return nullptr;
-    }
-    cmsHPROFILE handle = cmsOpenProfileFromFile(path.toUtf8(), "r");
+    cmsHPROFILE handle = cmsOpenProfileFromMem(data.constData(), data.size());
     if (!handle) {
-        if (QFileInfo::exists(path)) {
-            return std::unexpected(i18n("Failed to open ICC profile \"%1\"", path));
-        } else {
-            return std::unexpected(i18n("ICC profile \"%1\" doesn't exist", path));
-        }
+        return std::unexpected(i18n("Failed to open ICC profile \"%1\"", path));
     }
     if (cmsGetDeviceClass(handle) != cmsSigDisplayClass) {
         return std::unexpected(i18n("ICC profile \"%1\" is not usable for displays", path));
@@ -515,4 +515,95 @@ std::expected<std::unique_ptr<IccProfile>, QString> IccProfile::load(const QStri
     return std::make_unique<IccProfile>(handle, Colorimetry(red, green, blue, white), std::move(bToA0), std::move(bToA1), inverseEOTF, xyzMatrix, vcgt, relativeBlackPoint, maxFALL, maxCLL);
 }
 
+namespace
+{
+struct CachedProfile
+{
+    QByteArray hash;
+    std::shared_ptr<IccProfile> profile;
+};
+}
+
+// Parsed profiles are kept around for as long as KWin runs, so that enabling an output again
+// or applying a configuration that doesn't change the profile doesn't parse it again. The
+// same file is also shared by all outputs that use it
+static QMutex s_profileCacheMutex;
+static QHash<QString, CachedProfile> s_profileCache;
+static QHash<QString, QFuture<void>> s_pendingPreloads;
+
+static QThreadPool *profileThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(1);
+        pool->setObjectName(QStringLiteral("KWin color profile loading"));
+        return pool;
+    }();
+    return pool;
+}
+
+static std::expected<std::shared_ptr<IccProfile>, QString> loadCached(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (QFileInfo::exists(path)) {
+            return std::unexpected(i18n("Failed to open ICC profile \"%1\"", path));
+        } else {
+            return std::unexpected(i18n("ICC profile \"%1\" doesn't exist", path));
+        }
+    }
+    const QByteArray data = file.readAll();
+    // the file may have been replaced with a new version of the profile under the same name
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    {
+        QMutexLocker locker(&s_profileCacheMutex);
+        const auto it = s_profileCache.constFind(path);
+        if (it != s_profileCache.constEnd() && it->hash == hash) {
+            return it->profile;
+        }
+    }
+
+    auto profile = parseProfile(path, data);
+    if (!profile) {
+        return std::unexpected(profile.error());
+    }
+    std::shared_ptr<IccProfile> ret = std::move(*profile);
+    QMutexLocker locker(&s_profileCacheMutex);
+    s_profileCache[path] = CachedProfile{
+        .hash = hash,
+        .profile = ret,
+    };
+    return ret;
+}
+
+std::expected<std::shared_ptr<IccProfile>, QString> IccProfile::load(const QString &path)
+{
+    if (path.isEmpty()) {
+        return nullptr;
+    }
+    QFuture<void> preload;
+    {
+        QMutexLocker locker(&s_profileCacheMutex);
+        preload = s_pendingPreloads.take(path);
+    }
+    // with large LUT based profiles, parsing takes a while; let a preload that's already
+    // running finish instead of doing the same work twice
+    preload.waitForFinished();
+    return loadCached(path);
+}
+
+void IccProfile::preload(const QString &path)
+{
+    if (path.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&s_profileCacheMutex);
+    if (const auto it = s_pendingPreloads.constFind(path); it != s_pendingPreloads.constEnd() && !it->isFinished()) {
+        return;
+    }
+    s_pendingPreloads[path] = QtConcurrent::run(profileThreadPool(), [path]() {
+        std::ignore = loadCached(path);
+    });
+}
+
 }
@@ -57,7 +57,16 @@ public:
     std::optional<double> maxFALL() const;
     std::optional<double> maxCLL() const;
 
-    static std::expected<std::unique_ptr<IccProfile>, QString> load(const QString &path);
+    /**
+     * Loads the profile at @a path. Profiles are cached, loading the same unchanged file again
+     * returns the same object.
+     */
+    static std::expected<std::shared_ptr<IccProfile>, QString> load(const QString &path);
+    /**
+     * Starts loading the profile at @a path on a worker thread, so that a later load() of
+     * the same file doesn't have to parse it.
+     */
+    static void preload(const QString &path);
     static const ColorDescription s_connectionSpace;
 
 private:
@@ -79,10 +79,12 @@ void OutputLayer::scheduleRepaint(Item *item)
         return;
     }
     m_repaintScheduled = true;
-    if (m_renderLoop) {
+    Q_EMIT repaintScheduled();
+    // The repaint may have been presented right away, e.g. when only the cursor plane has moved,
+    // then there is no need to schedule a frame for it
+    if (m_repaintScheduled && m_renderLoop) {
         m_renderLoop->scheduleRepaint(item, this);
     }
-    Q_EMIT repaintScheduled();
 }
 
 void OutputLayer::addDeviceRepaint(const QRegion &region)
@@ -204,6 +206,11 @@ RenderingIntent OutputLayer::renderIntent() const
     return m_renderingIntent;
 }
 
+bool OutputLayer::canOffloadColorPipeline(const ColorPipeline &) const
+{
+    return true;
+}
+
 void OutputLayer::setColor(const std::shared_ptr<ColorDescription> &color, RenderingIntent intent, const ColorPipeline &pipeline)
 {
     m_color = color;
@@ -136,6 +136,11 @@ public:
     const std::shared_ptr<ColorDescription> &colorDescription() const;
     RenderingIntent renderIntent() const;
     void setColor(const std::shared_ptr<ColorDescription> &color, RenderingIntent intent, const ColorPipeline &pipeline);
+    /**
+     * Returns whether the layer may be able to apply @a pipeline to a buffer in hardware.
+     * A presentation test is still needed to find out if it actually works.
+     */
+    virtual bool canOffloadColorPipeline(const ColorPipeline &pipeline) const;
 
     /**
      * Set the required bits for compositing on this plane. Direct scanout is not affected.
@@ -0,0 +1,449 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "core/region.h"
+
+#include <QDebugStateSaver>
+#include <QSpan>
+
+#include <algorithm>
+#include <climits>
+
+namespace KWin
+{
+
+enum class RegionOperation {
+    Union,
+    Intersection,
+    Subtraction,
+    Xor,
+};
+
+static bool evaluate(RegionOperation operation, bool a, bool b)
+{
+    switch (operation) {
+    case RegionOperation::Union:
+        return a || b;
+    case RegionOperation::Intersection:
+        return a && b;
+    case RegionOperation::Subtraction:
+        return a && !b;
+    case RegionOperation::Xor:
+        return a != b;
+    }
+    Q_UNREACHABLE();
+}
+
+static qsizetype bandEnd(std::span<const Rect> rects, qsizetype start)
+{
+    qsizetype end = start + 1;
+    while (end < qsizetype(rects.size()) && rects[end].top() == rects[start].top()) {
+        ++end;
+    }
+    return end;
+}
+
+/**
+ * Merges the band that starts at @a bandStart with the previous band if they touch and
+ * have identical spans. Returns the index of the last band in @a rects.
+ */
+static qsizetype coalesceBand(Region::RectList &rects, qsizetype previousBand, qsizetype bandStart)
+{
+    const qsizetype bandSize = rects.size() - bandStart;
+    if (bandSize == 0) {
+        return previousBand;
+    }
+    if (previousBand == -1 || bandStart - previousBand != bandSize || rects[previousBand].bottom() != rects[bandStart].top()) {
+        return bandStart;
+    }
+    for (qsizetype i = 0; i < bandSize; ++i) {
+        const Rect &previous = rects[previousBand + i];
+        const Rect &current = rects[bandStart + i];
+        if (previous.left() != current.left() || previous.right() != current.right()) {
+            return bandStart;
+        }
+    }
+    const int bottom = rects[bandStart].bottom();
+    for (qsizetype i = previousBand; i < bandStart; ++i) {
+        rects[i].setBottom(bottom);
+    }
+    rects.resize(bandStart);
+    return previousBand;
+}
+
+/**
+ * Sweeps over the vertical edges of the spans @a a and @a b and appends the spans where
+ * the @a operation holds to @a out. Both span lists must be sorted and must not contain
+ * touching or overlapping spans.
+ */
+static void combineSpans(RegionOperation operation, std::span<const Rect> a, std::span<const Rect> b, int top, int bottom, Region::RectList &out)
+{
+    const size_t edgeCountA = a.size() * 2;
+    const size_t edgeCountB = b.size() * 2;
+
+    size_t i = 0;
+    size_t j = 0;
+    bool insideA = false;
+    bool insideB = false;
+    bool inside = false;
+    int start = 0;
+
+    while (i < edgeCountA || j < edgeCountB) {
+        const int edgeA = i < edgeCountA ? (i % 2 ? a[i / 2].right() : a[i / 2].left()) : INT_MAX;
+        const int edgeB = j < edgeCountB ? (j % 2 ? b[j / 2].right() : b[j / 2].left()) : INT_MAX;
+        const int x = std::min(edgeA, edgeB);
+        if (edgeA == x) {
+            insideA = !insideA;
+            ++i;
+        }
+        if (edgeB == x) {
+            insideB = !insideB;
+            ++j;
+        }
+
+        const bool covered = evaluate(operation, insideA, insideB);
+        if (covered == inside) {
+            continue;
+        }
+        if (covered) {
+            start = x;
+        } else if (x > start) {
+            out.append(Rect(start, top, x - start, bottom - top));
+        }
+        inside = covered;
+    }
+}
+
+static Region::RectList combine(RegionOperation operation, std::span<const Rect> a, std::span<const Rect> b)
+{
+    Region::RectList out;
+    qsizetype previousBand = -1;
+
+    qsizetype i = 0;
+    qsizetype j = 0;
+    int y = INT_MIN;
+
+    const qsizetype countA = a.size();
+    const qsizetype countB = b.size();
+
+    while (i < countA || j < countB) {
+        const int topA = i < countA ? std::max(a[i].top(), y) : INT_MAX;
+        const int topB = j < countB ? std::max(b[j].top(), y) : INT_MAX;
+        const int top = std::min(topA, topB);
+        const bool activeA = topA == top;
+        const bool activeB = topB == top;
+
+        int bottom = INT_MAX;
+        if (i < countA) {
+            bottom = std::min(bottom, activeA ? a[i].bottom() : topA);
+        }
+        if (j < countB) {
+            bottom = std::min(bottom, activeB ? b[j].bottom() : topB);
+        }
+
+        const qsizetype endA = i < countA ? bandEnd(a, i) : countA;
+        const qsizetype endB = j < countB ? bandEnd(b, j) : countB;
+
+        // If only one of the bands covers the current slab, the result is either empty
+        // or a copy of that band, no need to go through the spans in the latter case.
+        if ((activeA && activeB) || evaluate(operation, activeA, activeB)) {
+            const qsizetype bandStart = out.size();
+            combineSpans(operation,
+                         activeA ? a.subspan(i, endA - i) : std::span<const Rect>(),
+                         activeB ? b.subspan(j, endB - j) : std::span<const Rect>(),
+                         top, bottom, out);
+            previousBand = coalesceBand(out, previousBand, bandStart);
+        }
+
+        y = bottom;
+        if (i < countA && a[i].bottom() <= y) {
+            i = endA;
+        }
+        if (j < countB && b[j].bottom() <= y) {
+            j = endB;
+        }
+    }
+
+    return out;
+}
+
+Region::Region(int x, int y, int width, int height)
+    : Region(Rect(x, y, width, height))
+{
+}
+
+Region::Region(const Rect &rect)
+{
+    if (!rect.isEmpty()) {
+        m_rects.append(rect);
+        m_boundingRect = rect;
+    }
+}
+
+Region::Region(const QRect &rect)
+    : Region(Rect(rect))
+{
+}
+
+Region::Region(const QRegion &region)
+{
+    // QRegion keeps its rectangles y-x banded too, but it's not guaranteed to merge
+    // vertically adjacent bands, so coalesce them while copying.
+    m_rects.reserve(region.rectCount());
+    qsizetype previousBand = -1;
+    qsizetype bandStart = 0;
+    for (const QRect &rect : region) {
+        if (!m_rects.isEmpty() && m_rects.constLast().top() != rect.top()) {
+            previousBand = coalesceBand(m_rects, previousBand, bandStart);
+            bandStart = m_rects.size();
+        }
+        m_rects.append(Rect(rect));
+    }
+    coalesceBand(m_rects, previousBand, bandStart);
+    updateBoundingRect();
+}
+
+Region::Region(RectList &&rects)
+    : m_rects(std::move(rects))
+{
+    updateBoundingRect();
+}
+
+void Region::updateBoundingRect()
+{
+    if (m_rects.isEmpty()) {
+        m_boundingRect = Rect();
+        return;
+    }
+
+    int left = INT_MAX;
+    int right = INT_MIN;
+    for (const Rect &rect : std::as_const(m_rects)) {
+        left = std::min(left, rect.left());
+        right = std::max(right, rect.right());
+    }
+
+    m_boundingRect.setCoords(left, m_rects.constFirst().top(), right, m_rects.constLast().bottom());
+}
+
+bool Region::contains(const QPoint &point) const
+{
+    if (!m_boundingRect.contains(point)) {
+        return false;
+    }
+    for (const Rect &rect : m_rects) {
+        if (rect.top() > point.y()) {
+            break;
+        }
+        if (rect.contains(point)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Region::contains(const Rect &rect) const
+{
+    if (rect.isEmpty() || !m_boundingRect.contains(rect)) {
+        return false;
+    }
+    for (const Rect &candidate : m_rects) {
+        if (candidate.contains(rect)) {
+            return true;
+        }
+    }
+    return Region(rect).subtracted(*this).isEmpty();
+}
+
+bool Region::intersects(const Rect &rect) const
+{
+    if (!m_boundingRect.intersects(rect)) {
+        return false;
+    }
+    for (const Rect &candidate : m_rects) {
+        if (candidate.top() >= rect.bottom()) {
+            break;
+        }
+        if (candidate.intersects(rect)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Region::intersects(const Region &other) const
+{
+    if (!m_boundingRect.intersects(other.m_boundingRect)) {
+        return false;
+    }
+    if (m_rects.size() == 1) {
+        return other.intersects(m_rects.constFirst());
+    }
+    if (other.m_rects.size() == 1) {
+        return intersects(other.m_rects.constFirst());
+    }
+    return !intersected(other).isEmpty();
+}
+
+Region Region::united(const Region &other) const
+{
+    if (other.isEmpty()) {
+        return *this;
+    } else if (isEmpty()) {
+        return other;
+    } else if (m_rects.size() == 1 && m_boundingRect.contains(other.m_boundingRect)) {
+        return *this;
+    } else if (other.m_rects.size() == 1 && other.m_boundingRect.contains(m_boundingRect)) {
+        return other;
+    }
+    return Region(combine(RegionOperation::Union, rects(), other.rects()));
+}
+
+Region Region::intersected(const Region &other) const
+{
+    if (!m_boundingRect.intersects(other.m_boundingRect)) {
+        return Region();
+    } else if (m_rects.size() == 1 && m_boundingRect.contains(other.m_boundingRect)) {
+        return other;
+    } else if (other.m_rects.size() == 1 && other.m_boundingRect.contains(m_boundingRect)) {
+        return *this;
+    }
+    return Region(combine(RegionOperation::Intersection, rects(), other.rects()));
+}
+
+Region Region::subtracted(const Region &other) const
+{
+    if (!m_boundingRect.intersects(other.m_boundingRect)) {
+        return *this;
+    } else if (other.m_rects.size() == 1 && other.m_boundingRect.contains(m_boundingRect)) {
+        return Region();
+    }
+    return Region(combine(RegionOperation::Subtraction, rects(), other.rects()));
+}
+
+Region Region::xored(const Region &other) const
+{
+    if (other.isEmpty()) {
+        return *this;
+    } else if (isEmpty()) {
+        return other;
+    }
+    return Region(combine(RegionOperation::Xor, rects(), other.rects()));
+}
+
+void Region::translate(int dx, int dy)
+{
+    if (isEmpty() || (dx == 0 && dy == 0)) {
+        return;
+    }
+    for (Rect &rect : m_rects) {
+        rect.translate(dx, dy);
+    }
+    m_boundingRect.translate(dx, dy);
+}
+
+void Region::translate(const QPoint &offset)
+{
+    translate(offset.x(), offset.y());
+}
+
+Region Region::translated(int dx, int dy) const
+{
+    Region region = *this;
+    region.translate(dx, dy);
+    return region;
+}
+
+Region Region::translated(const QPoint &offset) const
+{
+    return translated(offset.x(), offset.y());
+}
+
+Region Region::operator|(const Region &other) const
+{
+    return united(other);
+}
+
+Region Region::operator+(const Region &other) const
+{
+    return united(other);
+}
+
+Region Region::operator&(const Region &other) const
+{
+    return intersected(other);
+}
+
+Region Region::operator-(const Region &other) const
+{
+    return subtracted(other);
+}
+
+Region Region::operator^(const Region &other) const
+{
+    return xored(other);
+}
+
+Region &Region::operator|=(const Region &other)
+{
+    return *this = united(other);
+}
+
+Region &Region::operator+=(const Region &other)
+{
+    return *this = united(other);
+}
+
+Region &Region::operator&=(const Region &other)
+{
+    return *this = intersected(other);
+}
+
+Region &Region::operator-=(const Region &other)
+{
+    return *this = subtracted(other);
+}
+
+Region &Region::operator^=(const Region &other)
+{
+    return *this = xored(other);
+}
+
+bool Region::operator==(const Region &other) const
+{
+    return m_boundingRect == other.m_boundingRect && std::ranges::equal(rects(), other.rects());
+}
+
+Region::operator QRegion() const
+{
+    if (m_rects.size() <= 1) {
+        return m_rects.isEmpty() ? QRegion() : QRegion(QRect(m_rects.constFirst()));
+    }
+
+    QVarLengthArray<QRect, 8> rects;
+    rects.reserve(m_rects.size());
+    for (const Rect &rect : m_rects) {
+        rects.append(rect);
+    }
+
+    QRegion region;
+    region.setRects(QSpan<const QRect>(rects.constData(), rects.size()));
+    return region;
+}
+
+} // namespace KWin
+
+QDebug operator<<(QDebug dbg, const KWin::Region &region)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace();
+    dbg << "KWin::Region(";
+    for (const KWin::Rect &rect : region) {
+        dbg << rect.x() << "," << rect.y() << " " << rect.width() << "x" << rect.height() << " ";
+    }
+    dbg << ")";
+    return dbg;
+}
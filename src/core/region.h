@@ -0,0 +1,121 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "core/rect.h"
+
+#include <QRegion>
+#include <QVarLengthArray>
+
+#include <span>
+
+namespace KWin
+{
+
+/**
+ * The Region type represents a set of pixels as a list of rectangles.
+ *
+ * The rectangles are stored flat and y-x banded: they are sorted by their top and then
+ * by their left edge, the rectangles in a band share the same top and bottom edges, the
+ * rectangles in a band neither overlap nor touch, and vertically adjacent bands with
+ * identical spans are merged. This is the same canonical form as used by QRegion, which
+ * makes converting between the two types a plain copy.
+ *
+ * Unlike QRegion, the Region type is not implicitly shared and stores a few rectangles
+ * inline, so accumulating small damage regions doesn't allocate.
+ */
+class KWIN_EXPORT Region
+{
+public:
+    using RectList = QVarLengthArray<Rect, 8>;
+
+    Region() = default;
+    Region(int x, int y, int width, int height);
+    Region(const Rect &rect);
+    Region(const QRect &rect);
+    Region(const QRegion &region);
+
+    bool isEmpty() const;
+    int rectCount() const;
+    Rect boundingRect() const;
+    std::span<const Rect> rects() const;
+
+    const Rect *begin() const;
+    const Rect *end() const;
+
+    bool contains(const QPoint &point) const;
+    bool contains(const Rect &rect) const;
+    bool intersects(const Rect &rect) const;
+    bool intersects(const Region &other) const;
+
+    Region united(const Region &other) const;
+    Region intersected(const Region &other) const;
+    Region subtracted(const Region &other) const;
+    Region xored(const Region &other) const;
+
+    void translate(int dx, int dy);
+    void translate(const QPoint &offset);
+    Region translated(int dx, int dy) const;
+    Region translated(const QPoint &offset) const;
+
+    Region operator|(const Region &other) const;
+    Region operator+(const Region &other) const;
+    Region operator&(const Region &other) const;
+    Region operator-(const Region &other) const;
+    Region operator^(const Region &other) const;
+    Region &operator|=(const Region &other);
+    Region &operator+=(const Region &other);
+    Region &operator&=(const Region &other);
+    Region &operator-=(const Region &other);
+    Region &operator^=(const Region &other);
+
+    bool operator==(const Region &other) const;
+
+    operator QRegion() const;
+
+private:
+    explicit Region(RectList &&rects);
+
+    void updateBoundingRect();
+
+    RectList m_rects;
+    Rect m_boundingRect;
+};
+
+inline bool Region::isEmpty() const
+{
+    return m_rects.isEmpty();
+}
+
+inline int Region::rectCount() const
+{
+    return m_rects.size();
+}
+
+inline Rect Region::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+inline std::span<const Rect> Region::rects() const
+{
+    return std::span<const Rect>(m_rects.constData(), m_rects.size());
+}
+
+inline const Rect *Region::begin() const
+{
+    return m_rects.constData();
+}
+
+inline const Rect *Region::end() const
+{
+    return m_rects.constData() + m_rects.size();
+}
+
+} // namespace KWin
+
+KWIN_EXPORT QDebug operator<<(QDebug dbg, const KWin::Region &region);
@@ -24,6 +24,11 @@ RenderTimeSpan RenderTimeSpan::operator|(const RenderTimeSpan &other) const
     };
 }
 
+std::optional<std::chrono::nanoseconds> RenderTimeQuery::gpuTime() const
+{
+    return std::nullopt;
+}
+
 CpuRenderTimeQuery::CpuRenderTimeQuery()
     : m_start(std::chrono::steady_clock::now())
 {
@@ -84,12 +89,26 @@ std::optional<RenderTimeSpan> OutputFrame::queryRenderTime() const
     return ret;
 }
 
+std::optional<std::chrono::nanoseconds> OutputFrame::queryGpuTime() const
+{
+    std::optional<std::chrono::nanoseconds> ret;
+    for (const auto &query : m_renderTimeQueries) {
+        if (const auto time = query->gpuTime()) {
+            ret = ret.value_or(std::chrono::nanoseconds::zero()) + *time;
+        }
+    }
+    return ret;
+}
+
 void OutputFrame::presented(std::chrono::nanoseconds timestamp, PresentationMode mode)
 {
     Q_ASSERT(!m_presented);
     m_presented = true;
 
     const auto renderTime = queryRenderTime();
+    if (renderTime) {
+        m_gpuTime = queryGpuTime();
+    }
     if (m_loop) {
         RenderLoopPrivate::get(m_loop)->notifyFrameCompleted(timestamp, renderTime, mode, this);
     }
@@ -158,6 +177,35 @@ void OutputFrame::setArtificialHdrHeadroom(double edr)
     m_artificialHdrHeadroom = edr;
 }
 
+void OutputFrame::setCommitTime(std::chrono::steady_clock::time_point time)
+{
+    m_commitTime.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+std::optional<std::chrono::steady_clock::time_point> OutputFrame::commitTime() const
+{
+    const int64_t time = m_commitTime.load(std::memory_order_relaxed);
+    if (!time) {
+        return std::nullopt;
+    }
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(time));
+}
+
+std::optional<std::chrono::nanoseconds> OutputFrame::gpuTime() const
+{
+    return m_gpuTime;
+}
+
+void OutputFrame::setSceneClass(SceneClass sceneClass)
+{
+    m_sceneClass = sceneClass;
+}
+
+SceneClass OutputFrame::sceneClass() const
+{
+    return m_sceneClass;
+}
+
 bool RenderBackend::checkGraphicsReset()
 {
     return false;
@@ -6,12 +6,14 @@
 
 #pragma once
 
+#include "core/renderjournal.h"
 #include "core/rendertarget.h"
 #include "effect/globals.h"
 #include "utils/filedescriptor.h"
 
 #include <QObject>
 #include <QPointer>
+#include <atomic>
 #include <memory>
 
 namespace KWin
@@ -49,6 +51,11 @@ class KWIN_EXPORT RenderTimeQuery
 public:
     virtual ~RenderTimeQuery() = default;
     virtual std::optional<RenderTimeSpan> query() = 0;
+    /**
+     * @returns the time the GPU spent executing the commands, if known.
+     * Only valid after query() returned a result
+     */
+    virtual std::optional<std::chrono::nanoseconds> gpuTime() const;
 };
 
 class KWIN_EXPORT CpuRenderTimeQuery : public RenderTimeQuery
@@ -96,8 +103,22 @@ public:
     std::optional<double> artificialHdrHeadroom() const;
     void setArtificialHdrHeadroom(double edr);
 
+    /**
+     * Marks the time the frame was handed to the display hardware. May be called from any thread
+     */
+    void setCommitTime(std::chrono::steady_clock::time_point time);
+    std::optional<std::chrono::steady_clock::time_point> commitTime() const;
+    /**
+     * @returns the accumulated GPU time of the render time queries. Only available once the frame has been presented
+     */
+    std::optional<std::chrono::nanoseconds> gpuTime() const;
+
+    void setSceneClass(SceneClass sceneClass);
+    SceneClass sceneClass() const;
+
 private:
     std::optional<RenderTimeSpan> queryRenderTime() const;
+    std::optional<std::chrono::nanoseconds> queryGpuTime() const;
 
     const QPointer<RenderLoop> m_loop;
     const std::chrono::nanoseconds m_refreshDuration;
@@ -110,6 +131,9 @@ private:
     bool m_presented = false;
     std::optional<double> m_brightness;
     std::optional<double> m_artificialHdrHeadroom;
+    std::atomic<int64_t> m_commitTime{0};
+    std::optional<std::chrono::nanoseconds> m_gpuTime;
+    SceneClass m_sceneClass = SceneClass::Plain;
 };
 
 /**
@@ -7,7 +7,9 @@
 #include "renderjournal.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
+#include <numeric>
 
 using namespace std::chrono_literals;
 
@@ -43,4 +45,199 @@ std::chrono::nanoseconds RenderJournal::result() const
     return m_result + m_variance * 2;
 }
 
+PercentileRenderJournal::PercentileRenderJournal(double percentile)
+    : m_percentile(std::clamp(percentile, 0.0, 100.0))
+{
+}
+
+void PercentileRenderJournal::add(std::chrono::nanoseconds renderTime)
+{
+    m_samples[m_next] = renderTime;
+    m_next = (m_next + 1) % s_windowSize;
+    m_count = std::min(m_count + 1, s_windowSize);
+
+    // the window is small enough that a partial sort on every frame is cheap
+    std::array<std::chrono::nanoseconds, s_windowSize> sorted = m_samples;
+    const auto end = sorted.begin() + m_count;
+    const size_t rank = std::max<size_t>(std::ceil(m_count * m_percentile / 100.0), 1);
+    const auto nth = sorted.begin() + std::min(rank - 1, m_count - 1);
+    std::nth_element(sorted.begin(), nth, end);
+    m_result = *nth;
+}
+
+std::optional<std::chrono::nanoseconds> PercentileRenderJournal::result() const
+{
+    if (m_count < s_minimumSamples) {
+        return std::nullopt;
+    }
+    return m_result;
+}
+
+int FrameTimingHistogram::bucketIndex(std::chrono::nanoseconds duration)
+{
+    // the first magnitude covers everything below 1µs with linear 1/8µs steps
+    const uint64_t value = std::max<int64_t>(duration.count(), 0) >> (10 - s_subBucketBits);
+    if (value < uint64_t(s_subBucketCount)) {
+        return value;
+    }
+    const int magnitude = std::bit_width(value) - s_subBucketBits;
+    if (magnitude >= s_magnitudeCount) {
+        return s_bucketCount - 1;
+    }
+    const int subBucket = (value >> (magnitude - 1)) & (s_subBucketCount - 1);
+    return magnitude * s_subBucketCount + subBucket;
+}
+
+std::chrono::nanoseconds FrameTimingHistogram::bucketUpperBound(int index)
+{
+    const int magnitude = index / s_subBucketCount;
+    const uint64_t subBucket = index % s_subBucketCount;
+    uint64_t value;
+    if (magnitude == 0) {
+        value = subBucket + 1;
+    } else {
+        value = (s_subBucketCount + subBucket + 1) << (magnitude - 1);
+    }
+    return std::chrono::nanoseconds(value << (10 - s_subBucketBits));
+}
+
+void FrameTimingHistogram::add(std::chrono::nanoseconds duration)
+{
+    m_buckets[bucketIndex(duration)]++;
+    m_count++;
+    m_max = std::max(m_max, duration);
+}
+
+uint64_t FrameTimingHistogram::count() const
+{
+    return m_count;
+}
+
+std::chrono::nanoseconds FrameTimingHistogram::max() const
+{
+    return m_max;
+}
+
+uint64_t FrameTimingHistogram::bucketCount(int index) const
+{
+    return m_buckets[index];
+}
+
+std::chrono::nanoseconds FrameTimingHistogram::percentile(double percentile) const
+{
+    if (!m_count) {
+        return 0ns;
+    }
+    const uint64_t target = std::max<uint64_t>(std::ceil(m_count * std::clamp(percentile, 0.0, 100.0) / 100.0), 1);
+    uint64_t seen = 0;
+    for (int i = 0; i < s_bucketCount; i++) {
+        seen += m_buckets[i];
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+void FrameTimingJournal::add(const FrameTimingRecord &record)
+{
+    const uint64_t index = m_writeIndex.load(std::memory_order_relaxed);
+    Slot &slot = m_slots[index % s_capacity];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = record;
+    slot.sequence.store(index + 1, std::memory_order_release);
+    m_writeIndex.store(index + 1, std::memory_order_release);
+}
+
+std::vector<FrameTimingRecord> FrameTimingJournal::records() const
+{
+    const uint64_t end = m_writeIndex.load(std::memory_order_acquire);
+    const uint64_t begin = end > s_capacity ? end - s_capacity : 0;
+    std::vector<FrameTimingRecord> ret;
+    ret.reserve(end - begin);
+    for (uint64_t index = begin; index < end; index++) {
+        const Slot &slot = m_slots[index % s_capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        const FrameTimingRecord record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+            // overwritten while we were reading it
+            continue;
+        }
+        ret.push_back(record);
+    }
+    return ret;
+}
+
+FrameTimingJournal::Histograms FrameTimingJournal::histograms() const
+{
+    Histograms ret;
+    for (const FrameTimingRecord &record : records()) {
+        if (record.renderEnd > record.renderStart) {
+            ret.renderTime.add(record.renderEnd - record.renderStart);
+        }
+        if (record.gpuTime > 0ns) {
+            ret.gpuTime.add(record.gpuTime);
+        }
+        if (record.commitTime > 0ns && record.renderEnd > 0ns) {
+            ret.commitLatency.add(std::max(record.commitTime - record.renderEnd, 0ns));
+        }
+        if (record.targetPresentation > 0ns) {
+            const auto delay = std::max(record.presentation - record.targetPresentation, 0ns);
+            ret.presentationDelay.add(delay);
+            if (record.refreshDuration > 0ns && delay > record.refreshDuration / 2) {
+                ret.missedFrames++;
+            }
+        }
+    }
+    return ret;
+}
+
+void MissedDeadlineCounters::add(MissedDeadlineReason reason)
+{
+    m_counts[size_t(reason)]++;
+}
+
+uint64_t MissedDeadlineCounters::count(MissedDeadlineReason reason) const
+{
+    return m_counts[size_t(reason)];
+}
+
+uint64_t MissedDeadlineCounters::total() const
+{
+    return std::accumulate(m_counts.begin(), m_counts.end(), uint64_t(0));
+}
+
+bool RenderQualityController::add(std::chrono::nanoseconds renderTime, std::chrono::nanoseconds budget, bool missed)
+{
+    if (missed || renderTime > budget) {
+        m_roomyFrameCount = 0;
+        const double quality = std::max(s_minQuality, m_quality * 0.8);
+        if (quality == m_quality) {
+            return false;
+        }
+        m_quality = quality;
+        return true;
+    }
+
+    if (renderTime * 10 > budget * 6) {
+        m_roomyFrameCount = 0;
+        return false;
+    }
+    if (m_quality == 1.0 || ++m_roomyFrameCount < s_recoveryFrameCount) {
+        return false;
+    }
+    m_roomyFrameCount -= s_recoveryStepFrameCount;
+    m_quality = std::min(1.0, m_quality + 0.05);
+    return true;
+}
+
+double RenderQualityController::quality() const
+{
+    return m_quality;
+}
+
 } // namespace KWin
@@ -7,8 +7,11 @@
 #pragma once
 #include "kwin_export.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <optional>
+#include <vector>
 
 namespace KWin
 {
@@ -32,4 +35,201 @@ private:
     std::optional<std::chrono::nanoseconds> m_lastAdd;
 };
 
+/**
+ * Describes what kind of content a frame contains, so that render times of
+ * frames with very different costs can be estimated separately.
+ */
+enum class SceneClass {
+    Plain, ///< only windows and their decorations
+    Blur, ///< the blur effect is active
+    Effect, ///< a fullscreen effect, like the overview, is active
+};
+
+/**
+ * The PercentileRenderJournal class estimates the render time of the next frame as a
+ * high percentile of the render times in a sliding window. Unlike RenderJournal it is
+ * not pulled up by occasional outliers for long, which allows starting to composite
+ * later on steady workloads.
+ */
+class KWIN_EXPORT PercentileRenderJournal
+{
+public:
+    static constexpr size_t s_windowSize = 128;
+    /**
+     * The minimum amount of samples required before result() returns an estimate
+     */
+    static constexpr size_t s_minimumSamples = 16;
+
+    explicit PercentileRenderJournal(double percentile = 95);
+
+    void add(std::chrono::nanoseconds renderTime);
+
+    std::optional<std::chrono::nanoseconds> result() const;
+
+private:
+    const double m_percentile;
+    std::array<std::chrono::nanoseconds, s_windowSize> m_samples{};
+    size_t m_count = 0;
+    size_t m_next = 0;
+    std::chrono::nanoseconds m_result{0};
+};
+
+/**
+ * The timings of a single presented frame. All timestamps are sourced from the
+ * monotonic clock; fields that the backend couldn't provide are left at zero.
+ */
+struct FrameTimingRecord
+{
+    std::chrono::nanoseconds targetPresentation{0};
+    std::chrono::nanoseconds renderStart{0};
+    std::chrono::nanoseconds renderEnd{0};
+    std::chrono::nanoseconds gpuTime{0};
+    std::chrono::nanoseconds commitTime{0};
+    std::chrono::nanoseconds presentation{0};
+    std::chrono::nanoseconds refreshDuration{0};
+};
+
+/**
+ * The FrameTimingHistogram class is a log-linear histogram of durations, similar to
+ * an HDR histogram. Every power of two between 1µs and ~1s is split into a fixed
+ * number of linear sub-buckets, which keeps the relative error below 1/s_subBucketCount
+ * while using a small, constant amount of memory.
+ */
+class KWIN_EXPORT FrameTimingHistogram
+{
+public:
+    static constexpr int s_subBucketBits = 3;
+    static constexpr int s_subBucketCount = 1 << s_subBucketBits;
+    static constexpr int s_magnitudeCount = 21;
+    static constexpr int s_bucketCount = s_magnitudeCount * s_subBucketCount;
+
+    void add(std::chrono::nanoseconds duration);
+
+    uint64_t count() const;
+    std::chrono::nanoseconds max() const;
+    /**
+     * Returns the upper bound of the bucket that contains the @a percentile (0-100) sample.
+     */
+    std::chrono::nanoseconds percentile(double percentile) const;
+
+    uint64_t bucketCount(int index) const;
+    /**
+     * Returns the exclusive upper bound of the bucket with the given @a index.
+     */
+    static std::chrono::nanoseconds bucketUpperBound(int index);
+    static int bucketIndex(std::chrono::nanoseconds duration);
+
+private:
+    std::array<uint64_t, s_bucketCount> m_buckets{};
+    uint64_t m_count = 0;
+    std::chrono::nanoseconds m_max{0};
+};
+
+/**
+ * The FrameTimingJournal class keeps the timings of the most recently presented frames
+ * in a fixed-size ring buffer. Adding a record never allocates or locks, so the journal
+ * can be kept enabled in production.
+ *
+ * There must be only one writer. Readers may run concurrently with the writer; records
+ * that are overwritten while being read are detected and skipped.
+ */
+class KWIN_EXPORT FrameTimingJournal
+{
+public:
+    static constexpr size_t s_capacity = 512;
+
+    void add(const FrameTimingRecord &record);
+
+    /**
+     * Returns the recorded frames, oldest first.
+     */
+    std::vector<FrameTimingRecord> records() const;
+
+    struct Histograms
+    {
+        FrameTimingHistogram renderTime;
+        FrameTimingHistogram gpuTime;
+        FrameTimingHistogram commitLatency;
+        FrameTimingHistogram presentationDelay;
+        uint64_t missedFrames = 0;
+    };
+    /**
+     * Builds histograms for the render time, the GPU time, the time between render end
+     * and the commit and the delay of the actual presentation relative to the target.
+     */
+    Histograms histograms() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        FrameTimingRecord record;
+    };
+    std::array<Slot, s_capacity> m_slots;
+    std::atomic<uint64_t> m_writeIndex{0};
+};
+
+/**
+ * The reasons for why a frame wasn't presented at the vblank it was queued for
+ */
+enum class MissedDeadlineReason {
+    /// the commit reached the kernel later than the safety margin allows for
+    LateSubmission,
+    /// the kernel rejected a commit that had been tested before
+    CommitRejected,
+    /// the GPU wasn't done rendering the frame by the deadline
+    FenceNotSignaled,
+    /// the pageflip happened at a different vblank than the estimated one
+    VblankDrift,
+    /// the kernel didn't deliver the pageflip event in time
+    PageflipTimeout,
+};
+
+/**
+ * The MissedDeadlineCounters class counts the missed presentation deadlines of an output
+ * by their reason.
+ */
+class KWIN_EXPORT MissedDeadlineCounters
+{
+public:
+    static constexpr size_t s_reasonCount = size_t(MissedDeadlineReason::PageflipTimeout) + 1;
+
+    void add(MissedDeadlineReason reason);
+
+    uint64_t count(MissedDeadlineReason reason) const;
+    uint64_t total() const;
+
+private:
+    std::array<uint64_t, s_reasonCount> m_counts{};
+};
+
+/**
+ * The RenderQualityController class decides how much of their usual cost effects may spend
+ * on a frame. The quality drops quickly while frames miss their deadline or don't fit into
+ * their budget, and only recovers once frames have fit with room to spare for a while, so
+ * that it doesn't flip back and forth under a steady load.
+ */
+class KWIN_EXPORT RenderQualityController
+{
+public:
+    static constexpr double s_minQuality = 0.25;
+    static constexpr int s_recoveryFrameCount = 120;
+    static constexpr int s_recoveryStepFrameCount = 15;
+
+    /**
+     * Adds a frame that is expected to take @a renderTime out of the @a budget, and whether
+     * the frame has @a missed its deadline. Returns true if the quality has changed.
+     */
+    bool add(std::chrono::nanoseconds renderTime, std::chrono::nanoseconds budget, bool missed);
+
+    /**
+     * Returns the quality, between s_minQuality and 1.
+     */
+    double quality() const;
+
+private:
+    double m_quality = 1.0;
+    int m_roomyFrameCount = 0;
+};
+
 } // namespace KWin
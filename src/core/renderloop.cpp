@@ -9,6 +9,7 @@
 #include "options.h"
 #include "renderloop_p.h"
 #include "scene/surfaceitem.h"
+#include "tracing.h"
 #include "utils/common.h"
 #include "window.h"
 #include "workspace.h"
@@ -27,12 +28,31 @@ RenderLoopPrivate *RenderLoopPrivate::get(RenderLoop *loop)
 
 static const bool s_printDebugInfo = qEnvironmentVariableIntValue("KWIN_LOG_PERFORMANCE_DATA") != 0;
 
+static RenderLoop::RenderTimeEstimator defaultRenderTimeEstimator()
+{
+    if (qEnvironmentVariable("KWIN_RENDER_TIME_ESTIMATOR") == QLatin1StringView("percentile")) {
+        return RenderLoop::RenderTimeEstimator::Percentile;
+    }
+    return RenderLoop::RenderTimeEstimator::Average;
+}
+
 RenderLoopPrivate::RenderLoopPrivate(RenderLoop *q, BackendOutput *output)
     : q(q)
     , output(output)
+    , renderTimeEstimator(defaultRenderTimeEstimator())
 {
 }
 
+std::chrono::nanoseconds RenderLoopPrivate::predictRenderTime() const
+{
+    if (renderTimeEstimator == RenderLoop::RenderTimeEstimator::Percentile) {
+        if (const auto estimate = percentileJournals[size_t(sceneClass)].result()) {
+            return *estimate;
+        }
+    }
+    return renderJournal.result();
+}
+
 void RenderLoopPrivate::scheduleNextRepaint()
 {
     if (kwinApp()->isTerminating() || compositeTimer.isActive() || preparingNewFrame) {
@@ -49,7 +69,7 @@ void RenderLoopPrivate::scheduleRepaint(std::chrono::nanoseconds lastTargetTimes
 
     // Estimate when it's a good time to perform the next compositing cycle.
     // the 1ms on top of the safety margin is required for timer and scheduler inaccuracies
-    std::chrono::nanoseconds expectedCompositingTime = std::min(renderJournal.result() + safetyMargin + 1ms, 2 * vblankInterval);
+    std::chrono::nanoseconds expectedCompositingTime = std::min(predictRenderTime() + safetyMargin + 1ms, 2 * vblankInterval);
 
     if (presentationMode == PresentationMode::VSync) {
         // normal presentation: pageflips only happen at vblank
@@ -146,9 +166,27 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp,
 
     notifyVblank(timestamp);
 
+    bool renderQualityChanged = false;
     if (renderTime) {
         renderJournal.add(renderTime->end - renderTime->start, timestamp);
+        percentileJournals[size_t(frame->sceneClass())].add(renderTime->end - renderTime->start);
+
+        const uint64_t missedDeadlineCount = missedDeadlines.total();
+        const bool missed = missedDeadlineCount != seenMissedDeadlines
+            || timestamp > frame->targetPageflipTime().time_since_epoch() + frame->refreshDuration() / 2;
+        seenMissedDeadlines = missedDeadlineCount;
+        renderQualityChanged = renderQuality.add(predictRenderTime(), frame->refreshDuration() - safetyMargin, missed);
     }
+    const auto commitTime = frame->commitTime();
+    frameTimings.add(FrameTimingRecord{
+        .targetPresentation = frame->targetPageflipTime().time_since_epoch(),
+        .renderStart = renderTime ? renderTime->start.time_since_epoch() : 0ns,
+        .renderEnd = renderTime ? renderTime->end.time_since_epoch() : 0ns,
+        .gpuTime = frame->gpuTime().value_or(0ns),
+        .commitTime = commitTime ? commitTime->time_since_epoch() : 0ns,
+        .presentation = timestamp,
+        .refreshDuration = frame->refreshDuration(),
+    });
     if (compositeTimer.isActive()) {
         // reschedule to match the new timestamp and render time
         scheduleRepaint(lastPresentationTimestamp);
@@ -157,6 +195,9 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp,
         scheduleNextRepaint();
     }
 
+    if (renderQualityChanged) {
+        Q_EMIT q->renderQualityChanged();
+    }
     Q_EMIT q->framePresented(q, timestamp, mode);
 }
 
@@ -173,6 +214,11 @@ void RenderLoopPrivate::notifyVblank(std::chrono::nanoseconds timestamp)
     }
 }
 
+void RenderLoopPrivate::notifyDeadlineMissed(MissedDeadlineReason reason)
+{
+    missedDeadlines.add(reason);
+}
+
 void RenderLoop::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == d->compositeTimer.timerId()) {
@@ -188,6 +234,7 @@ void RenderLoop::timerEvent(QTimerEvent *event)
 
 void RenderLoopPrivate::dispatch()
 {
+    traceScope(RenderLoop, "dispatch");
     Q_EMIT q->frameRequested(q);
 }
 
@@ -253,8 +300,14 @@ void RenderLoop::setPresentationSafetyMargin(std::chrono::nanoseconds safetyMarg
     d->safetyMargin = safetyMargin;
 }
 
+std::chrono::nanoseconds RenderLoop::presentationSafetyMargin() const
+{
+    return d->safetyMargin;
+}
+
 void RenderLoop::scheduleRepaint(Item *item, OutputLayer *outputLayer)
 {
+    traceScope(RenderLoop, "scheduleRepaint");
     const bool vrr = d->presentationMode == PresentationMode::AdaptiveSync || d->presentationMode == PresentationMode::AdaptiveAsync;
     const bool tearing = d->presentationMode == PresentationMode::Async || d->presentationMode == PresentationMode::AdaptiveAsync;
     if ((vrr || tearing) && workspace() && workspace()->activeWindow() && d->output) {
@@ -310,7 +363,47 @@ void RenderLoop::setMaxPendingFrameCount(uint32_t maxCount)
 
 std::chrono::nanoseconds RenderLoop::predictedRenderTime() const
 {
-    return d->renderJournal.result();
+    return d->predictRenderTime();
+}
+
+void RenderLoop::setRenderTimeEstimator(RenderTimeEstimator estimator)
+{
+    d->renderTimeEstimator = estimator;
+}
+
+RenderLoop::RenderTimeEstimator RenderLoop::renderTimeEstimator() const
+{
+    return d->renderTimeEstimator;
+}
+
+void RenderLoop::setSceneClass(SceneClass sceneClass)
+{
+    d->sceneClass = sceneClass;
+}
+
+const FrameTimingJournal &RenderLoop::frameTimings() const
+{
+    return d->frameTimings;
+}
+
+const FrameCounterJournal &RenderLoop::frameCounters() const
+{
+    return d->frameCounters;
+}
+
+void RenderLoop::addFrameCounters(const FrameCounterRecord &record)
+{
+    d->frameCounters.add(record);
+}
+
+const MissedDeadlineCounters &RenderLoop::missedDeadlines() const
+{
+    return d->missedDeadlines;
+}
+
+qreal RenderLoop::renderQuality() const
+{
+    return d->renderQuality.quality();
 }
 
 } // namespace KWin
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include "core/renderjournal.h"
 #include "effect/globals.h"
+#include "utils/framecounters.h"
 
 #include <QObject>
 
@@ -32,6 +34,21 @@ class KWIN_EXPORT RenderLoop : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * Describes how the render time of the next frame is estimated.
+     */
+    enum class RenderTimeEstimator {
+        /**
+         * A running average of recent render times, plus a multiple of their variance
+         */
+        Average,
+        /**
+         * A high percentile of the render times in a sliding window, tracked separately
+         * for each SceneClass. Falls back to Average until enough frames have been rendered
+         */
+        Percentile,
+    };
+
     explicit RenderLoop(BackendOutput *output);
     ~RenderLoop() override;
 
@@ -72,6 +89,7 @@ public:
     void setRefreshRate(int refreshRate);
 
     void setPresentationSafetyMargin(std::chrono::nanoseconds safetyMargin);
+    std::chrono::nanoseconds presentationSafetyMargin() const;
 
     /**
      * Schedules a compositing cycle at the next available moment.
@@ -100,6 +118,40 @@ public:
      */
     std::chrono::nanoseconds predictedRenderTime() const;
 
+    void setRenderTimeEstimator(RenderTimeEstimator estimator);
+    RenderTimeEstimator renderTimeEstimator() const;
+
+    /**
+     * Sets the kind of content that is currently being rendered. It is used to pick
+     * the render time estimate for the next frames.
+     */
+    void setSceneClass(SceneClass sceneClass);
+
+    /**
+     * Returns the timings of the most recently presented frames.
+     */
+    const FrameTimingJournal &frameTimings() const;
+
+    /**
+     * Returns the allocation and lock counters of the most recently painted frames. The
+     * journal stays empty unless KWin is built with KWIN_BUILD_FRAME_COUNTERS.
+     */
+    const FrameCounterJournal &frameCounters() const;
+    void addFrameCounters(const FrameCounterRecord &record);
+
+    /**
+     * Returns how often frames missed their presentation deadline, by reason.
+     */
+    const MissedDeadlineCounters &missedDeadlines() const;
+
+    /**
+     * Returns how much of their usual cost effects should spend on rendering, between 0.25
+     * and 1. It goes down while frames miss their deadline or are expected to take longer
+     * than a refresh cycle, and back up once there is room again. Effects that can trade
+     * quality for speed, e.g. by blurring with fewer passes, may opt into following it.
+     */
+    qreal renderQuality() const;
+
     // TODO integrate cursor updates into the render loop / frame scheduling somehow?
     // and then remove this again
     bool activeWindowControlsVrrRefreshRate() const;
@@ -111,6 +163,10 @@ Q_SIGNALS:
      * This signal is emitted when the refresh rate of this RenderLoop has changed.
      */
     void refreshRateChanged();
+    /**
+     * This signal is emitted when the render quality of this RenderLoop has changed.
+     */
+    void renderQualityChanged();
     /**
      * This signal is emitted when a frame has been actually presented on the screen.
      * @a timestamp indicates the time when it took place.
@@ -36,6 +36,8 @@ public:
     void notifyFrameDropped();
     void notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::optional<RenderTimeSpan> renderTime, PresentationMode mode, OutputFrame *frame);
     void notifyVblank(std::chrono::nanoseconds timestamp);
+    void notifyDeadlineMissed(MissedDeadlineReason reason);
+    std::chrono::nanoseconds predictRenderTime() const;
 
     RenderLoop *const q;
     BackendOutput *const output;
@@ -46,6 +48,14 @@ public:
     int doubleBufferingCounter = 0;
     QBasicTimer compositeTimer;
     RenderJournal renderJournal;
+    std::array<PercentileRenderJournal, 3> percentileJournals;
+    RenderLoop::RenderTimeEstimator renderTimeEstimator;
+    SceneClass sceneClass = SceneClass::Plain;
+    FrameTimingJournal frameTimings;
+    FrameCounterJournal frameCounters;
+    MissedDeadlineCounters missedDeadlines;
+    RenderQualityController renderQuality;
+    uint64_t seenMissedDeadlines = 0;
     int refreshRate = 60000;
     int pendingFrameCount = 0;
     bool preparingNewFrame = false;
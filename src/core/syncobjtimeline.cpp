@@ -8,9 +8,11 @@
 #include <cerrno>
 #include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <vector>
 #include <xf86drm.h>
 
 #if defined(Q_OS_LINUX)
+#include <linux/dma-buf.h>
 #include <linux/sync_file.h>
 #else
 struct sync_merge_data
@@ -109,18 +111,46 @@ SyncTimeline::~SyncTimeline()
     drmSyncobjDestroy(m_drmFd, m_handle);
 }
 
+// clients that use explicit sync wait for a timeline point with every commit, only used on
+// the main thread
+static std::vector<FileDescriptor> s_eventFdPool;
+static constexpr size_t s_maxPooledEventFds = 32;
+
 FileDescriptor SyncTimeline::eventFd(uint64_t timelinePoint) const
 {
-    FileDescriptor ret{eventfd(0, EFD_CLOEXEC)};
-    if (!ret.isValid()) {
-        return {};
+    FileDescriptor ret;
+    if (!s_eventFdPool.empty()) {
+        ret = std::move(s_eventFdPool.back());
+        s_eventFdPool.pop_back();
+    } else {
+        ret = FileDescriptor{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+        if (!ret.isValid()) {
+            return {};
+        }
     }
     if (drmSyncobjEventfd(m_drmFd, m_handle, timelinePoint, ret.get(), 0) != 0) {
+        // nothing has been registered, the event fd is still clean
+        if (s_eventFdPool.size() < s_maxPooledEventFds) {
+            s_eventFdPool.push_back(std::move(ret));
+        }
         return {};
     }
     return ret;
 }
 
+void SyncTimeline::recycleEventFd(FileDescriptor &&fd)
+{
+    if (!fd.isValid() || s_eventFdPool.size() >= s_maxPooledEventFds) {
+        return;
+    }
+    // reading resets the counter, and fails if the event fd hasn't been signalled yet
+    eventfd_t value;
+    if (eventfd_read(fd.get(), &value) != 0) {
+        return;
+    }
+    s_eventFdPool.push_back(std::move(fd));
+}
+
 void SyncTimeline::signal(uint64_t timelinePoint)
 {
     drmSyncobjTimelineSignal(m_drmFd, &m_handle, &timelinePoint, 1);
@@ -157,4 +187,16 @@ bool SyncTimeline::isMaterialized(uint64_t timelinePoint)
                                    nullptr)
             == 0);
 }
+bool importDmaBufWriteFence(const FileDescriptor &dmabuf, const FileDescriptor &fence)
+{
+#if defined(Q_OS_LINUX) && defined(DMA_BUF_IOCTL_IMPORT_SYNC_FILE)
+    dma_buf_import_sync_file request{
+        .flags = DMA_BUF_SYNC_WRITE,
+        .fd = fence.get(),
+    };
+    return drmIoctl(dmabuf.get(), DMA_BUF_IOCTL_IMPORT_SYNC_FILE, &request) == 0;
+#else
+    return false;
+#endif
+}
 }
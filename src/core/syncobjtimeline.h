@@ -48,8 +48,16 @@ public:
 
     /**
      * @returns an event fd that gets signalled when the timeline point gets signalled
+     *
+     * The event fd is non-blocking. Once it has been signalled, it can be handed back with
+     * recycleEventFd() so that the next wait doesn't need a new one.
      */
     FileDescriptor eventFd(uint64_t timelinePoint) const;
+    /**
+     * Resets @p fd and keeps it around for the next eventFd() call. Event fds that haven't
+     * been signalled yet are closed instead, the kernel would still signal them later.
+     */
+    static void recycleEventFd(FileDescriptor &&fd);
 
     const FileDescriptor &fileDescriptor();
     void signal(uint64_t timelinePoint);
@@ -62,4 +70,12 @@ private:
     uint32_t m_handle = 0;
     FileDescriptor m_fileDescriptor;
 };
+
+/**
+ * Adds @p fence as a write fence to the dma-buf @p dmabuf, so that consumers which rely on
+ * implicit synchronization wait for it, even if the driver that rendered into the buffer
+ * doesn't do implicit synchronization by itself
+ * @returns false if the kernel can't import fences into dma-bufs
+ */
+KWIN_EXPORT bool importDmaBufWriteFence(const FileDescriptor &dmabuf, const FileDescriptor &fence);
 }
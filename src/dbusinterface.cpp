@@ -15,14 +15,23 @@
 
 // kwin
 #include "compositor.h"
+#include "core/backendoutput.h"
+#include "core/gpumemory.h"
 #include "core/output.h"
+#include "core/outputbackend.h"
 #include "core/renderbackend.h"
+#include "core/renderjournal.h"
+#include "core/renderloop.h"
 #include "debug_console.h"
 #include "kwinadaptor.h"
 #include "main.h"
+#include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "opengl/glpassprofiler.h"
 #include "placement.h"
 #include "pluginmanager.h"
 #include "virtualdesktops.h"
+#include "wayland/surface.h"
 #include "window.h"
 #include "workspace.h"
 #if KWIN_BUILD_ACTIVITIES
@@ -33,6 +42,8 @@
 #include <QDBusConnection>
 #include <QOpenGLContext>
 
+#include <utility>
+
 namespace KWin
 {
 
@@ -222,11 +233,27 @@ void DBusInterface::onShowingDesktopChanged(bool show, bool /*animated*/)
     Q_EMIT showingDesktopChanged(show);
 }
 
+static GLPassProfiler *passProfiler(Compositor *compositor)
+{
+    if (auto eglBackend = qobject_cast<EglBackend *>(compositor->backend())) {
+        return eglBackend->openglContext()->passProfiler();
+    }
+    return nullptr;
+}
+
 CompositorDBusInterface::CompositorDBusInterface(Compositor *parent)
     : QObject(parent)
     , m_compositor(parent)
 {
     connect(m_compositor, &Compositor::compositingToggled, this, &CompositorDBusInterface::compositingToggled);
+    connect(m_compositor, &Compositor::compositingToggled, this, [this](bool active) {
+        // The profiler goes away together with the OpenGL context
+        if (active && m_gpuPassProfiling) {
+            if (GLPassProfiler *profiler = passProfiler(m_compositor)) {
+                profiler->ref();
+            }
+        }
+    });
     new CompositingAdaptor(this);
     QDBusConnection dbus = QDBusConnection::sessionBus();
     dbus.registerObject(QStringLiteral("/Compositor"), this);
@@ -286,6 +313,160 @@ QStringList CompositorDBusInterface::supportedOpenGLPlatformInterfaces() const
     return {QStringLiteral("egl")};
 }
 
+static QVariantMap histogramToVariant(const FrameTimingHistogram &histogram)
+{
+    QVariantList bounds;
+    QVariantList counts;
+    for (int i = 0; i < FrameTimingHistogram::s_bucketCount; i++) {
+        if (const uint64_t count = histogram.bucketCount(i)) {
+            bounds.append(qlonglong(FrameTimingHistogram::bucketUpperBound(i).count()));
+            counts.append(qulonglong(count));
+        }
+    }
+    return QVariantMap{
+        {QStringLiteral("count"), qulonglong(histogram.count())},
+        {QStringLiteral("p50"), qlonglong(histogram.percentile(50).count())},
+        {QStringLiteral("p90"), qlonglong(histogram.percentile(90).count())},
+        {QStringLiteral("p99"), qlonglong(histogram.percentile(99).count())},
+        {QStringLiteral("max"), qlonglong(histogram.max().count())},
+        {QStringLiteral("bucketUpperBounds"), bounds},
+        {QStringLiteral("bucketCounts"), counts},
+    };
+}
+
+QVariantMap CompositorDBusInterface::frameTimingHistogram(const QString &outputName) const
+{
+    const auto outputs = kwinApp()->outputBackend()->outputs();
+    const auto it = std::ranges::find_if(outputs, [&outputName](BackendOutput *output) {
+        return output->name() == outputName;
+    });
+    if (it == outputs.end() || !(*it)->renderLoop()) {
+        return QVariantMap{};
+    }
+    const auto histograms = (*it)->renderLoop()->frameTimings().histograms();
+    return QVariantMap{
+        {QStringLiteral("renderTime"), histogramToVariant(histograms.renderTime)},
+        {QStringLiteral("gpuTime"), histogramToVariant(histograms.gpuTime)},
+        {QStringLiteral("commitLatency"), histogramToVariant(histograms.commitLatency)},
+        {QStringLiteral("presentationDelay"), histogramToVariant(histograms.presentationDelay)},
+        {QStringLiteral("missedFrames"), qulonglong(histograms.missedFrames)},
+    };
+}
+
+QVariantMap CompositorDBusInterface::missedDeadlines(const QString &outputName) const
+{
+    const auto outputs = kwinApp()->outputBackend()->outputs();
+    const auto it = std::ranges::find_if(outputs, [&outputName](BackendOutput *output) {
+        return output->name() == outputName;
+    });
+    if (it == outputs.end() || !(*it)->renderLoop()) {
+        return QVariantMap{};
+    }
+    const RenderLoop *renderLoop = (*it)->renderLoop();
+    const MissedDeadlineCounters &counters = renderLoop->missedDeadlines();
+    return QVariantMap{
+        {QStringLiteral("lateSubmission"), qulonglong(counters.count(MissedDeadlineReason::LateSubmission))},
+        {QStringLiteral("commitRejected"), qulonglong(counters.count(MissedDeadlineReason::CommitRejected))},
+        {QStringLiteral("fenceNotSignaled"), qulonglong(counters.count(MissedDeadlineReason::FenceNotSignaled))},
+        {QStringLiteral("vblankDrift"), qulonglong(counters.count(MissedDeadlineReason::VblankDrift))},
+        {QStringLiteral("pageflipTimeout"), qulonglong(counters.count(MissedDeadlineReason::PageflipTimeout))},
+        {QStringLiteral("total"), qulonglong(counters.total())},
+        {QStringLiteral("safetyMargin"), qlonglong(renderLoop->presentationSafetyMargin().count())},
+    };
+}
+
+QVariantList CompositorDBusInterface::gpuMemoryUsage() const
+{
+    QVariantList ret;
+    const auto usage = GpuMemoryAccounting::self()->usage();
+    for (const GpuMemoryAccounting::Usage &entry : usage) {
+        QVariantMap map{
+            {QStringLiteral("kind"), GpuMemoryAccounting::ownerKindName(entry.owner.kind)},
+            {QStringLiteral("name"), entry.owner.name},
+        };
+        for (size_t i = 0; i < s_gpuMemoryCategoryCount; ++i) {
+            map.insert(GpuMemoryAccounting::categoryName(GpuMemoryCategory(i)), qulonglong(entry.byteSize[i]));
+        }
+        ret.append(map);
+    }
+    return ret;
+}
+
+void CompositorDBusInterface::trimGpuMemory()
+{
+    GpuMemoryAccounting::self()->trim();
+}
+
+QVariantList CompositorDBusInterface::presentationStatistics() const
+{
+    QVariantList ret;
+    const auto windows = workspace()->windows();
+    for (const Window *window : windows) {
+        const SurfaceInterface *surface = window->surface();
+        if (!surface) {
+            continue;
+        }
+        const PresentationStatistics &statistics = surface->presentationStatistics();
+        if (!statistics.presented && !statistics.discarded) {
+            continue;
+        }
+        ret.append(QVariantMap{
+            {QStringLiteral("uuid"), window->internalId().toString()},
+            {QStringLiteral("caption"), window->caption()},
+            {QStringLiteral("resourceClass"), window->resourceClass()},
+            {QStringLiteral("presented"), qulonglong(statistics.presented)},
+            {QStringLiteral("discarded"), qulonglong(statistics.discarded)},
+            {QStringLiteral("vsync"), qulonglong(statistics.vsync)},
+            {QStringLiteral("async"), qulonglong(statistics.async)},
+            {QStringLiteral("zeroCopy"), qulonglong(statistics.zeroCopy)},
+            {QStringLiteral("composited"), qulonglong(statistics.composited)},
+            {QStringLiteral("zeroCopyExits"), qulonglong(statistics.zeroCopyExits)},
+            {QStringLiteral("latencyP50"), qlonglong(statistics.latency(50).count())},
+            {QStringLiteral("latencyP99"), qlonglong(statistics.latency(99).count())},
+            {QStringLiteral("latencyMax"), qlonglong(statistics.latency(100).count())},
+        });
+    }
+    return ret;
+}
+
+bool CompositorDBusInterface::captureScene(const QString &fileName, int frameCount)
+{
+    return m_compositor->startSceneCapture(fileName, frameCount);
+}
+
+QVariantList CompositorDBusInterface::gpuPasses(const QString &frameName) const
+{
+    const GLPassProfiler *profiler = passProfiler(m_compositor);
+    if (!profiler) {
+        return QVariantList{};
+    }
+    QVariantList ret;
+    const auto passes = profiler->passes(frameName);
+    for (const GLPassProfiler::Pass &pass : passes) {
+        ret.append(QVariantMap{
+            {QStringLiteral("name"), pass.name},
+            {QStringLiteral("depth"), pass.depth},
+            {QStringLiteral("duration"), qlonglong(pass.duration.count())},
+        });
+    }
+    return ret;
+}
+
+void CompositorDBusInterface::setGpuPassProfilingEnabled(bool enabled)
+{
+    if (m_gpuPassProfiling == enabled) {
+        return;
+    }
+    m_gpuPassProfiling = enabled;
+    if (GLPassProfiler *profiler = passProfiler(m_compositor)) {
+        if (enabled) {
+            profiler->ref();
+        } else {
+            profiler->unref();
+        }
+    }
+}
+
 VirtualDesktopManagerDBusInterface::VirtualDesktopManagerDBusInterface(VirtualDesktopManager *parent)
     : QObject(parent)
     , m_manager(parent)
@@ -298,55 +479,134 @@ VirtualDesktopManagerDBusInterface::VirtualDesktopManagerDBusInterface(VirtualDe
                                                  QStringLiteral("org.kde.KWin.VirtualDesktopManager"),
                                                  this);
 
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(0);
+    connect(&m_flushTimer, &QTimer::timeout, this, &VirtualDesktopManagerDBusInterface::flush);
+
     connect(m_manager, &VirtualDesktopManager::currentChanged, this, [this]() {
-        Q_EMIT currentChanged(m_manager->currentDesktop()->id());
+        m_currentChanged = true;
+        scheduleFlush();
     });
 
-    connect(m_manager, &VirtualDesktopManager::countChanged, this, [this](uint previousCount, uint newCount) {
-        Q_EMIT countChanged(newCount);
-        Q_EMIT desktopsChanged(desktops());
+    connect(m_manager, &VirtualDesktopManager::countChanged, this, [this]() {
+        m_countChanged = true;
+        scheduleFlush();
     });
 
     connect(m_manager, &VirtualDesktopManager::navigationWrappingAroundChanged, this, [this]() {
-        Q_EMIT navigationWrappingAroundChanged(isNavigationWrappingAround());
+        m_navigationWrappingAroundChanged = true;
+        scheduleFlush();
     });
 
-    connect(m_manager, &VirtualDesktopManager::rowsChanged, this, &VirtualDesktopManagerDBusInterface::rowsChanged);
+    connect(m_manager, &VirtualDesktopManager::rowsChanged, this, [this]() {
+        m_rowsChanged = true;
+        scheduleFlush();
+    });
 
     const QList<VirtualDesktop *> allDesks = m_manager->desktops();
     for (auto *vd : allDesks) {
-        connect(vd, &VirtualDesktop::x11DesktopNumberChanged, this, [this, vd]() {
-            DBusDesktopDataStruct data{.position = vd->x11DesktopNumber() - 1, .id = vd->id(), .name = vd->name()};
-            Q_EMIT desktopDataChanged(vd->id(), data);
-            Q_EMIT desktopsChanged(desktops());
-        });
-        connect(vd, &VirtualDesktop::nameChanged, this, [this, vd]() {
-            DBusDesktopDataStruct data{.position = vd->x11DesktopNumber() - 1, .id = vd->id(), .name = vd->name()};
-            Q_EMIT desktopDataChanged(vd->id(), data);
-            Q_EMIT desktopsChanged(desktops());
-        });
+        watchDesktop(vd);
     }
     connect(m_manager, &VirtualDesktopManager::desktopAdded, this, [this](VirtualDesktop *vd) {
-        connect(vd, &VirtualDesktop::x11DesktopNumberChanged, this, [this, vd]() {
-            DBusDesktopDataStruct data{.position = vd->x11DesktopNumber() - 1, .id = vd->id(), .name = vd->name()};
-            Q_EMIT desktopDataChanged(vd->id(), data);
-            Q_EMIT desktopsChanged(desktops());
-        });
-        connect(vd, &VirtualDesktop::nameChanged, this, [this, vd]() {
-            DBusDesktopDataStruct data{.position = vd->x11DesktopNumber() - 1, .id = vd->id(), .name = vd->name()};
-            Q_EMIT desktopDataChanged(vd->id(), data);
-            Q_EMIT desktopsChanged(desktops());
-        });
-        DBusDesktopDataStruct data{.position = vd->x11DesktopNumber() - 1, .id = vd->id(), .name = vd->name()};
-        Q_EMIT desktopCreated(vd->id(), data);
-        Q_EMIT desktopsChanged(desktops());
+        watchDesktop(vd);
+        m_createdDesktops.append(vd->id());
+        scheduleFlush();
     });
     connect(m_manager, &VirtualDesktopManager::desktopRemoved, this, [this](VirtualDesktop *vd) {
-        Q_EMIT desktopRemoved(vd->id());
-        Q_EMIT desktopsChanged(desktops());
+        m_changedDesktops.removeOne(vd->id());
+        if (!m_createdDesktops.removeOne(vd->id())) {
+            m_removedDesktops.append(vd->id());
+        }
+        scheduleFlush();
     });
 }
 
+void VirtualDesktopManagerDBusInterface::watchDesktop(VirtualDesktop *vd)
+{
+    const auto markChanged = [this, vd]() {
+        if (!m_changedDesktops.contains(vd->id()) && !m_createdDesktops.contains(vd->id())) {
+            m_changedDesktops.append(vd->id());
+        }
+        scheduleFlush();
+    };
+    connect(vd, &VirtualDesktop::x11DesktopNumberChanged, this, markChanged);
+    connect(vd, &VirtualDesktop::nameChanged, this, markChanged);
+}
+
+void VirtualDesktopManagerDBusInterface::scheduleFlush()
+{
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void VirtualDesktopManagerDBusInterface::flush()
+{
+    // Bulk operations, e.g. changing the number of desktops, renumber every desktop. The changes
+    // are collected during an event loop turn so that every listener wakes up once for them
+    const QStringList removed = std::exchange(m_removedDesktops, {});
+    const QStringList created = std::exchange(m_createdDesktops, {});
+    const QStringList changed = std::exchange(m_changedDesktops, {});
+    QVariantMap diff;
+
+    for (const QString &id : removed) {
+        Q_EMIT desktopRemoved(id);
+    }
+    if (!removed.isEmpty()) {
+        diff.insert(QStringLiteral("removed"), removed);
+    }
+
+    const auto desktopData = [](const VirtualDesktop *vd) {
+        return DBusDesktopDataStruct{.position = vd->x11DesktopNumber() - 1, .id = vd->id(), .name = vd->name()};
+    };
+    QVariantList createdData;
+    for (const QString &id : created) {
+        if (const VirtualDesktop *vd = m_manager->desktopForId(id)) {
+            const DBusDesktopDataStruct data = desktopData(vd);
+            Q_EMIT desktopCreated(id, data);
+            createdData.append(QVariant::fromValue(data));
+        }
+    }
+    if (!createdData.isEmpty()) {
+        diff.insert(QStringLiteral("created"), createdData);
+    }
+    QVariantList changedData;
+    for (const QString &id : changed) {
+        if (const VirtualDesktop *vd = m_manager->desktopForId(id)) {
+            const DBusDesktopDataStruct data = desktopData(vd);
+            Q_EMIT desktopDataChanged(id, data);
+            changedData.append(QVariant::fromValue(data));
+        }
+    }
+    if (!changedData.isEmpty()) {
+        diff.insert(QStringLiteral("changed"), changedData);
+    }
+
+    if (std::exchange(m_countChanged, false)) {
+        Q_EMIT countChanged(count());
+        diff.insert(QStringLiteral("count"), count());
+    }
+    if (std::exchange(m_rowsChanged, false)) {
+        Q_EMIT rowsChanged(rows());
+        diff.insert(QStringLiteral("rows"), rows());
+    }
+    if (std::exchange(m_currentChanged, false)) {
+        Q_EMIT currentChanged(current());
+        diff.insert(QStringLiteral("current"), current());
+    }
+    if (std::exchange(m_navigationWrappingAroundChanged, false)) {
+        Q_EMIT navigationWrappingAroundChanged(isNavigationWrappingAround());
+        diff.insert(QStringLiteral("navigationWrappingAround"), isNavigationWrappingAround());
+    }
+
+    if (!removed.isEmpty() || !createdData.isEmpty() || !changedData.isEmpty()) {
+        Q_EMIT desktopsChanged(desktops());
+    }
+    if (!diff.isEmpty()) {
+        Q_EMIT stateChanged(diff);
+    }
+}
+
 uint VirtualDesktopManagerDBusInterface::count() const
 {
     return m_manager->count();
@@ -12,6 +12,7 @@
 #include <QDBusContext>
 #include <QDBusMessage>
 #include <QObject>
+#include <QTimer>
 
 #include "virtualdesktopsdbustypes.h"
 
@@ -20,6 +21,7 @@ namespace KWin
 
 class Compositor;
 class PluginManager;
+class VirtualDesktop;
 class VirtualDesktopManager;
 
 /**
@@ -165,11 +167,59 @@ public Q_SLOTS:
      */
     void reinitialize();
 
+    /**
+     * @brief Returns histograms of the timings of the most recently presented frames on the
+     * output with the given @p outputName.
+     *
+     * The map contains one entry per measured stage (renderTime, gpuTime, commitLatency and
+     * presentationDelay), each being a map with the sample count, a few percentiles and
+     * the non-empty histogram buckets, all in nanoseconds.
+     */
+    QVariantMap frameTimingHistogram(const QString &outputName) const;
+    /**
+     * Returns how often frames on the output with the given @p outputName missed their
+     * presentation deadline, by reason, together with the current presentation safety
+     * margin in nanoseconds.
+     */
+    QVariantMap missedDeadlines(const QString &outputName) const;
+    /**
+     * Returns the GPU time of the passes of the most recently measured frame with the given
+     * @p frameName, usually the name of an output. Every pass is a map with its name, the
+     * number of passes that enclose it and its duration in nanoseconds.
+     *
+     * The passes are only measured while enabled with setGpuPassProfilingEnabled().
+     */
+    QVariantList gpuPasses(const QString &frameName) const;
+    void setGpuPassProfilingEnabled(bool enabled);
+    /**
+     * Returns the GPU memory that KWin holds, as one map per owner with its kind (compositor,
+     * output, window or effect), its name and the byte size of each category of memory.
+     */
+    QVariantList gpuMemoryUsage() const;
+    /**
+     * Drops the GPU memory that's cached but not needed right now.
+     */
+    void trimGpuMemory();
+    /**
+     * Returns how the frames of the windows that use presentation feedback are presented, as
+     * one map per window with its uuid, caption and resource class, the number of presented
+     * and discarded frames, how many of them were presented with vsync or asynchronously and
+     * with or without compositing, how often the window fell off direct scanout and a few
+     * percentiles of the commit-to-present latency of the recent frames in nanoseconds.
+     */
+    QVariantList presentationStatistics() const;
+    /**
+     * Writes the item trees of the next @p frameCount frames to @p fileName, to be replayed
+     * with kwin_replay. Returns false if the capture could not be started.
+     */
+    bool captureScene(const QString &fileName, int frameCount);
+
 Q_SIGNALS:
     void compositingToggled(bool active);
 
 private:
     Compositor *m_compositor;
+    bool m_gpuPassProfiling = false;
 };
 
 // TODO: disable all of this in case of kiosk?
@@ -231,6 +281,13 @@ Q_SIGNALS:
     void desktopDataChanged(const QString &id, KWin::DBusDesktopDataStruct);
     void desktopCreated(const QString &id, KWin::DBusDesktopDataStruct);
     void desktopRemoved(const QString &id);
+    /**
+     * Emitted once per event loop turn with everything that has changed since the last time,
+     * in addition to the individual signals. Only the keys of the changed state are present:
+     * "removed" (ids), "created" and "changed" (desktop data), "count", "rows", "current" and
+     * "navigationWrappingAround".
+     */
+    void stateChanged(const QVariantMap &diff);
 
 public Q_SLOTS:
     /**
@@ -242,7 +299,19 @@ public Q_SLOTS:
     void removeDesktop(const QString &id);
 
 private:
+    void watchDesktop(VirtualDesktop *vd);
+    void scheduleFlush();
+    void flush();
+
     VirtualDesktopManager *m_manager;
+    QTimer m_flushTimer;
+    QStringList m_createdDesktops;
+    QStringList m_removedDesktops;
+    QStringList m_changedDesktops;
+    bool m_countChanged = false;
+    bool m_rowsChanged = false;
+    bool m_currentChanged = false;
+    bool m_navigationWrappingAroundChanged = false;
 };
 
 class PluginManagerDBusInterface : public QObject
@@ -8,7 +8,12 @@
 */
 #include "debug_console.h"
 #include "compositor.h"
+#include "core/backendoutput.h"
+#include "core/gpumemory.h"
 #include "core/inputdevice.h"
+#include "core/outputbackend.h"
+#include "core/renderjournal.h"
+#include "core/renderloop.h"
 #include "effect/effecthandler.h"
 #include "input_event.h"
 #include "internalwindow.h"
@@ -21,6 +26,7 @@
 #include "tiles/customtile.h"
 #include "tiles/tile.h"
 #include "utils/filedescriptor.h"
+#include "utils/framecounters.h"
 #include "utils/pipe.h"
 #include "virtualdesktops.h"
 #include "wayland/abstract_data_source.h"
@@ -35,7 +41,10 @@
 #include "waylandwindow.h"
 #include "workspace.h"
 #include "xkb.h"
+#include <algorithm>
 #include <cerrno>
+#include <cmath>
+#include <map>
 #if KWIN_BUILD_X11
 #include "x11window.h"
 #endif
@@ -45,8 +54,11 @@
 // frameworks
 #include <KLocalizedString>
 // Qt
+#include <QFileInfo>
 #include <QFont>
 #include <QFutureWatcher>
+#include <QHeaderView>
+#include <QLocale>
 #include <QMetaProperty>
 #include <QMetaType>
 #include <QMouseEvent>
@@ -66,6 +78,7 @@
 #include <fcntl.h>
 #include <functional>
 #include <sys/poll.h>
+#include <utility>
 
 namespace KWin
 {
@@ -713,11 +726,26 @@ DebugConsole::DebugConsole()
 
     m_ui->clipboardContent->setModel(new DataSourceModel(this));
     m_ui->primaryContent->setModel(new DataSourceModel(this));
-    m_ui->inputDevicesView->setModel(new InputDeviceModel(this));
+    auto inputDevicesModel = new InputDeviceModel(this);
+    m_ui->inputDevicesView->setModel(inputDevicesModel);
+    connect(m_ui->inputDevicesView, &QTreeView::expanded, inputDevicesModel, [inputDevicesModel](const QModelIndex &index) {
+        inputDevicesModel->setObserved(index, true);
+    });
+    connect(m_ui->inputDevicesView, &QTreeView::collapsed, inputDevicesModel, [inputDevicesModel](const QModelIndex &index) {
+        inputDevicesModel->setObserved(index, false);
+    });
     m_ui->inputDevicesView->setItemDelegate(new DebugConsoleDelegate(this));
     m_ui->tabWidget->setTabIcon(0, QIcon::fromTheme(QStringLiteral("view-list-tree")));
 
     m_ui->tabWidget->addTab(new DebugConsoleEffectsTab(), i18nc("@label", "Effects"));
+    m_ui->tabWidget->addTab(new DebugConsoleFrameTimingsTab(), i18nc("@label", "Frame Timings"));
+    if constexpr (FrameCounters::isCompiledIn()) {
+        m_ui->tabWidget->addTab(new DebugConsoleFrameCountersTab(), i18nc("@label", "Frame Counters"));
+    }
+    m_ui->tabWidget->addTab(new DebugConsoleGpuMemoryTab(), i18nc("@label", "GPU Memory"));
+    if (waylandServer()) {
+        m_ui->tabWidget->addTab(new DebugConsoleClientsTab(), i18nc("@label", "Wayland Clients"));
+    }
 
     connect(m_ui->tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
         // delay creation of input event filter until the tab is selected
@@ -1150,11 +1178,43 @@ template<class T>
 int DebugConsoleModel::propertyCount(const QModelIndex &parent, T *(DebugConsoleModel::*filter)(const QModelIndex &) const) const
 {
     if (T *t = (this->*filter)(parent)) {
-        return t->metaObject()->propertyCount();
+        // the last row shows the memory footprint
+        return t->metaObject()->propertyCount() + 1;
     }
     return 0;
 }
 
+/**
+ * Returns a rough estimate of the memory held by the @a window object itself and the strings
+ * it owns, not including its items or the buffers of the client.
+ */
+static qsizetype windowMemoryFootprint(Window *window)
+{
+    qsizetype size = sizeof(Window);
+#if KWIN_BUILD_X11
+    if (qobject_cast<X11Window *>(window)) {
+        size = sizeof(X11Window);
+    }
+#endif
+    if (qobject_cast<InternalWindow *>(window)) {
+        size = sizeof(InternalWindow);
+    } else if (qobject_cast<WaylandWindow *>(window)) {
+        size = sizeof(WaylandWindow);
+    }
+    const QString strings[] = {
+        window->captionNormal(),
+        window->resourceName(),
+        window->resourceClass(),
+        window->windowRole(),
+        window->desktopFileName(),
+        window->colorScheme(),
+    };
+    for (const QString &string : strings) {
+        size += string.capacity() * sizeof(QChar);
+    }
+    return size;
+}
+
 int DebugConsoleModel::rowCount(const QModelIndex &parent) const
 {
     if (!parent.isValid()) {
@@ -1216,7 +1276,7 @@ template<class T>
 QModelIndex DebugConsoleModel::indexForProperty(int row, int column, const QModelIndex &parent, T *(DebugConsoleModel::*filter)(const QModelIndex &) const) const
 {
     if (T *t = (this->*filter)(parent)) {
-        if (row >= t->metaObject()->propertyCount()) {
+        if (row > t->metaObject()->propertyCount()) {
             return QModelIndex();
         }
         return createIndex(row, column, quint32(row + 1) << 16 | parent.internalId());
@@ -1306,6 +1366,15 @@ QModelIndex DebugConsoleModel::parent(const QModelIndex &child) const
 
 QVariant DebugConsoleModel::propertyData(KWin::Window *window, const QModelIndex &index, int role) const
 {
+    if (index.row() == window->metaObject()->propertyCount()) {
+        if (role != Qt::DisplayRole) {
+            return QVariant();
+        }
+        if (index.column() == 0) {
+            return QStringLiteral("memoryFootprint");
+        }
+        return QLocale().formattedDataSize(windowMemoryFootprint(window));
+    }
     const auto property = window->metaObject()->property(index.row());
     if (role == Qt::DisplayRole) {
         if (index.column() == 0) {
@@ -1517,14 +1586,14 @@ InputDeviceModel::InputDeviceModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_devices(input()->devices())
 {
-    for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
-        setupDeviceConnections(*it);
-    }
+    // some properties, e.g. of touchpads, change with every event, don't repaint the view for each
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(std::chrono::milliseconds(100));
+    connect(&m_updateTimer, &QTimer::timeout, this, &InputDeviceModel::emitPendingChanges);
 
     connect(input(), &InputRedirection::deviceAdded, this, [this](InputDevice *d) {
         beginInsertRows(QModelIndex(), m_devices.count(), m_devices.count());
         m_devices << d;
-        setupDeviceConnections(d);
         endInsertRows();
     });
     connect(input(), &InputRedirection::deviceRemoved, this, [this](InputDevice *d) {
@@ -1532,6 +1601,8 @@ InputDeviceModel::InputDeviceModel(QObject *parent)
         if (index == -1) {
             return;
         }
+        disconnect(d, nullptr, this, nullptr);
+        m_pendingChanges.remove(d);
         beginRemoveRows(QModelIndex(), index, index);
         m_devices.removeAt(index);
         endRemoveRows();
@@ -1613,6 +1684,20 @@ QModelIndex InputDeviceModel::parent(const QModelIndex &child) const
     return QModelIndex();
 }
 
+void InputDeviceModel::setObserved(const QModelIndex &index, bool observed)
+{
+    if (!index.isValid() || index.parent().isValid() || index.row() >= m_devices.count()) {
+        return;
+    }
+    InputDevice *device = m_devices.at(index.row());
+    disconnect(device, nullptr, this, nullptr);
+    if (observed) {
+        setupDeviceConnections(device);
+    } else {
+        m_pendingChanges.remove(device);
+    }
+}
+
 void InputDeviceModel::slotPropertyChanged()
 {
     const auto device = static_cast<InputDevice *>(sender());
@@ -1620,11 +1705,28 @@ void InputDeviceModel::slotPropertyChanged()
     for (int i = 0; i < device->metaObject()->propertyCount(); ++i) {
         const QMetaProperty metaProperty = device->metaObject()->property(i);
         if (metaProperty.notifySignalIndex() == senderSignalIndex()) {
-            const QModelIndex parent = index(m_devices.indexOf(device), 0, QModelIndex());
-            const QModelIndex child = index(i, 1, parent);
-            Q_EMIT dataChanged(child, child, QList<int>{Qt::DisplayRole});
+            auto it = m_pendingChanges.find(device);
+            if (it == m_pendingChanges.end()) {
+                m_pendingChanges.insert(device, std::make_pair(i, i));
+            } else {
+                it->first = std::min(it->first, i);
+                it->second = std::max(it->second, i);
+            }
         }
     }
+
+    if (!m_pendingChanges.isEmpty() && !m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+void InputDeviceModel::emitPendingChanges()
+{
+    const auto changes = std::exchange(m_pendingChanges, {});
+    for (auto it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        const QModelIndex parent = index(m_devices.indexOf(it.key()), 0, QModelIndex());
+        Q_EMIT dataChanged(index(it->first, 1, parent), index(it->second, 1, parent), QList<int>{Qt::DisplayRole});
+    }
 }
 
 void InputDeviceModel::setupDeviceConnections(InputDevice *device)
@@ -1853,6 +1955,275 @@ DebugConsoleEffectsTab::DebugConsoleEffectsTab(QWidget *parent)
     }
 }
 
+DebugConsoleFrameTimingsTab::DebugConsoleFrameTimingsTab(QWidget *parent)
+    : QTreeWidget(parent)
+{
+    setHeaderLabels({
+        i18nc("@title:column", "Stage"),
+        i18nc("@title:column", "Frames"),
+        i18nc("@title:column", "p50 (ms)"),
+        i18nc("@title:column", "p90 (ms)"),
+        i18nc("@title:column", "p99 (ms)"),
+        i18nc("@title:column", "Max (ms)"),
+    });
+    m_updateTimer.setInterval(std::chrono::seconds(1));
+    connect(&m_updateTimer, &QTimer::timeout, this, &DebugConsoleFrameTimingsTab::updateTimings);
+}
+
+void DebugConsoleFrameTimingsTab::showEvent(QShowEvent *event)
+{
+    QTreeWidget::showEvent(event);
+    updateTimings();
+    m_updateTimer.start();
+}
+
+void DebugConsoleFrameTimingsTab::hideEvent(QHideEvent *event)
+{
+    m_updateTimer.stop();
+    QTreeWidget::hideEvent(event);
+}
+
+void DebugConsoleFrameTimingsTab::updateTimings()
+{
+    const auto toMilliseconds = [](std::chrono::nanoseconds duration) {
+        return QString::number(duration.count() / 1'000'000.0, 'f', 2);
+    };
+    const auto addStage = [&toMilliseconds](QTreeWidgetItem *parent, const QString &name, const FrameTimingHistogram &histogram) {
+        new QTreeWidgetItem(parent, {
+                                        name,
+                                        QString::number(histogram.count()),
+                                        toMilliseconds(histogram.percentile(50)),
+                                        toMilliseconds(histogram.percentile(90)),
+                                        toMilliseconds(histogram.percentile(99)),
+                                        toMilliseconds(histogram.max()),
+                                    });
+    };
+
+    clear();
+    const auto outputs = kwinApp()->outputBackend()->outputs();
+    for (BackendOutput *output : outputs) {
+        if (!output->renderLoop()) {
+            continue;
+        }
+        const auto histograms = output->renderLoop()->frameTimings().histograms();
+        auto outputItem = new QTreeWidgetItem(this, {output->name(), QString::number(histograms.presentationDelay.count())});
+        outputItem->setToolTip(0, i18ncp("@info:tooltip", "%1 missed frame", "%1 missed frames", qulonglong(histograms.missedFrames)));
+        addStage(outputItem, i18nc("@item:intable", "Render time"), histograms.renderTime);
+        addStage(outputItem, i18nc("@item:intable", "GPU time"), histograms.gpuTime);
+        addStage(outputItem, i18nc("@item:intable", "Commit latency"), histograms.commitLatency);
+        addStage(outputItem, i18nc("@item:intable", "Presentation delay"), histograms.presentationDelay);
+        outputItem->setExpanded(true);
+    }
+}
+
+DebugConsoleFrameCountersTab::DebugConsoleFrameCountersTab(QWidget *parent)
+    : QTreeWidget(parent)
+{
+    setHeaderLabels({
+        i18nc("@title:column", "Frame"),
+        i18nc("@title:column", "Allocations"),
+        i18nc("@title:column", "Allocated (KiB)"),
+        i18nc("@title:column", "Lock waits"),
+        i18nc("@title:column", "Lock wait time (µs)"),
+    });
+    m_updateTimer.setInterval(std::chrono::seconds(1));
+    connect(&m_updateTimer, &QTimer::timeout, this, &DebugConsoleFrameCountersTab::updateCounters);
+}
+
+void DebugConsoleFrameCountersTab::showEvent(QShowEvent *event)
+{
+    QTreeWidget::showEvent(event);
+    updateCounters();
+    m_updateTimer.start();
+}
+
+void DebugConsoleFrameCountersTab::hideEvent(QHideEvent *event)
+{
+    m_updateTimer.stop();
+    QTreeWidget::hideEvent(event);
+}
+
+void DebugConsoleFrameCountersTab::updateCounters()
+{
+    // only the most recent frames, newest first
+    constexpr size_t frameCount = 60;
+    const auto value = [](const FrameCounterRecord &record, FrameCounters::Counter counter) {
+        return record.values[size_t(counter)];
+    };
+
+    clear();
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    const auto outputs = kwinApp()->outputBackend()->outputs();
+    for (BackendOutput *output : outputs) {
+        if (!output->renderLoop()) {
+            continue;
+        }
+        const auto records = output->renderLoop()->frameCounters().records();
+        auto outputItem = new QTreeWidgetItem(this, {output->name()});
+        for (auto it = records.rbegin(); it != records.rend() && std::distance(records.rbegin(), it) < ptrdiff_t(frameCount); ++it) {
+            new QTreeWidgetItem(outputItem, {
+                                                i18nc("@item:intable how long ago a frame was painted", "%1 ms ago", std::chrono::duration_cast<std::chrono::milliseconds>(now - it->timestamp).count()),
+                                                QString::number(value(*it, FrameCounters::Counter::Allocations)),
+                                                QString::number(value(*it, FrameCounters::Counter::AllocatedBytes) / 1024.0, 'f', 1),
+                                                QString::number(value(*it, FrameCounters::Counter::MutexWaits)),
+                                                QString::number(value(*it, FrameCounters::Counter::MutexWaitNanoseconds) / 1000.0, 'f', 1),
+                                            });
+        }
+        outputItem->setExpanded(true);
+    }
+}
+
+DebugConsoleGpuMemoryTab::DebugConsoleGpuMemoryTab(QWidget *parent)
+    : QTreeWidget(parent)
+{
+    setSortingEnabled(true);
+    setHeaderLabels({
+        i18nc("@title:column", "Owner"),
+        i18nc("@title:column", "Textures (MiB)"),
+        i18nc("@title:column", "Renderbuffers (MiB)"),
+        i18nc("@title:column", "Swapchains (MiB)"),
+        i18nc("@title:column", "Screencasts (MiB)"),
+        i18nc("@title:column", "Total (MiB)"),
+    });
+    m_updateTimer.setInterval(std::chrono::seconds(1));
+    connect(&m_updateTimer, &QTimer::timeout, this, &DebugConsoleGpuMemoryTab::updateUsage);
+}
+
+void DebugConsoleGpuMemoryTab::showEvent(QShowEvent *event)
+{
+    QTreeWidget::showEvent(event);
+    updateUsage();
+    m_updateTimer.start();
+}
+
+void DebugConsoleGpuMemoryTab::hideEvent(QHideEvent *event)
+{
+    m_updateTimer.stop();
+    QTreeWidget::hideEvent(event);
+}
+
+void DebugConsoleGpuMemoryTab::updateUsage()
+{
+    const auto toMebibytes = [](uint64_t byteSize) {
+        return QString::number(byteSize / (1024.0 * 1024.0), 'f', 2);
+    };
+    const auto kindName = [](GpuMemoryOwner::Kind kind) {
+        switch (kind) {
+        case GpuMemoryOwner::Kind::Compositor:
+            return i18nc("@item:intable", "Compositor");
+        case GpuMemoryOwner::Kind::Output:
+            return i18nc("@item:intable", "Outputs");
+        case GpuMemoryOwner::Kind::Window:
+            return i18nc("@item:intable", "Windows");
+        case GpuMemoryOwner::Kind::Effect:
+            return i18nc("@item:intable", "Effects");
+        }
+        Q_UNREACHABLE();
+    };
+    const auto setColumns = [&toMebibytes](QTreeWidgetItem *item, const std::array<uint64_t, s_gpuMemoryCategoryCount> &byteSize) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < s_gpuMemoryCategoryCount; ++i) {
+            item->setText(i + 1, toMebibytes(byteSize[i]));
+            total += byteSize[i];
+        }
+        item->setText(s_gpuMemoryCategoryCount + 1, toMebibytes(total));
+    };
+
+    clear();
+    std::map<GpuMemoryOwner::Kind, std::pair<QTreeWidgetItem *, std::array<uint64_t, s_gpuMemoryCategoryCount>>> kinds;
+    const auto usage = GpuMemoryAccounting::self()->usage();
+    for (const GpuMemoryAccounting::Usage &entry : usage) {
+        auto &[kindItem, kindByteSize] = kinds[entry.owner.kind];
+        if (!kindItem) {
+            kindItem = new QTreeWidgetItem(this, {kindName(entry.owner.kind)});
+            kindItem->setExpanded(true);
+            kindByteSize = {};
+        }
+        auto item = new QTreeWidgetItem(kindItem, {entry.owner.name.isEmpty() ? i18nc("@item:intable", "Other") : entry.owner.name});
+        setColumns(item, entry.byteSize);
+        for (size_t i = 0; i < s_gpuMemoryCategoryCount; ++i) {
+            kindByteSize[i] += entry.byteSize[i];
+        }
+    }
+    for (const auto &[kind, data] : kinds) {
+        setColumns(data.first, data.second);
+    }
+}
+
+DebugConsoleClientsTab::DebugConsoleClientsTab(QWidget *parent)
+    : QTreeWidget(parent)
+{
+    setRootIsDecorated(false);
+    setSortingEnabled(true);
+    setHeaderLabels({
+        i18nc("@title:column", "Client"),
+        i18nc("@title:column", "PID"),
+        i18nc("@title:column", "Requests/s"),
+        i18nc("@title:column", "KiB/s"),
+        i18nc("@title:column", "Dispatch (ms/s)"),
+        i18nc("@title:column", "Commits/s"),
+        i18nc("@title:column", "Damage (Mpx/s)"),
+        i18nc("@title:column", "Tearing flips/s"),
+        i18nc("@title:column", "Throttled"),
+    });
+    m_updateTimer.setInterval(std::chrono::seconds(1));
+    connect(&m_updateTimer, &QTimer::timeout, this, &DebugConsoleClientsTab::updateStatistics);
+}
+
+void DebugConsoleClientsTab::showEvent(QShowEvent *event)
+{
+    QTreeWidget::showEvent(event);
+    m_lastStatistics.clear();
+    updateStatistics();
+    m_updateTimer.start();
+}
+
+void DebugConsoleClientsTab::hideEvent(QHideEvent *event)
+{
+    m_updateTimer.stop();
+    QTreeWidget::hideEvent(event);
+}
+
+void DebugConsoleClientsTab::updateStatistics()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - m_lastUpdate).count();
+    m_lastUpdate = now;
+
+    const int sortColumn = header()->sortIndicatorSection();
+    const Qt::SortOrder sortOrder = header()->sortIndicatorOrder();
+
+    clear();
+    QHash<ClientConnection *, ClientConnection::Statistics> statistics;
+    const auto clients = waylandServer()->display()->clients();
+    for (ClientConnection *client : clients) {
+        const ClientConnection::Statistics current = client->statistics();
+        statistics.insert(client, current);
+
+        auto item = new QTreeWidgetItem(this);
+        item->setText(0, QFileInfo(client->executablePath()).fileName());
+        item->setToolTip(0, client->executablePath());
+        item->setData(1, Qt::DisplayRole, int(client->processId()));
+
+        // Rates need two samples, a new client shows up with empty columns first
+        if (const auto previous = m_lastStatistics.constFind(client); previous != m_lastStatistics.constEnd()) {
+            const auto setRate = [item, seconds](int column, double value) {
+                item->setData(column, Qt::DisplayRole, std::round(value / seconds * 10) / 10);
+            };
+            setRate(2, current.requests - previous->requests);
+            setRate(3, (current.bytesReceived - previous->bytesReceived) / 1024.0);
+            setRate(4, std::chrono::duration<double, std::milli>(current.dispatchTime - previous->dispatchTime).count());
+            setRate(5, current.bufferCommits - previous->bufferCommits);
+            setRate(6, (current.damagedPixels - previous->damagedPixels) / 1'000'000.0);
+            setRate(7, current.tearingPresentations - previous->tearingPresentations);
+        }
+        item->setText(8, client->isThrottled() ? i18nc("@item:intable", "Yes") : QString());
+    }
+    m_lastStatistics = statistics;
+
+    sortItems(sortColumn, sortOrder);
+}
+
 } // namespace KWin
 
 #include "moc_debug_console.cpp"
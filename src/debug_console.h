@@ -12,15 +12,21 @@
 
 #include "input.h"
 #include "input_event_spy.h"
+#include "wayland/clientconnection.h"
 #include <kwin_export.h>
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QList>
 #include <QListWidget>
 #include <QStyledItemDelegate>
+#include <QTimer>
+#include <QTreeWidget>
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <utility>
 
 class QLabel;
 class QPushButton;
@@ -168,12 +174,22 @@ public:
     int rowCount(const QModelIndex &parent) const override;
     QModelIndex parent(const QModelIndex &child) const override;
 
+    /**
+     * Property changes are only tracked for the devices whose properties are shown, that is
+     * which are expanded in a view. The properties of other devices are read when asked for.
+     */
+    void setObserved(const QModelIndex &index, bool observed);
+
 private Q_SLOTS:
     void slotPropertyChanged();
 
 private:
     void setupDeviceConnections(InputDevice *device);
+    void emitPendingChanges();
     QList<InputDevice *> m_devices;
+    // the range of changed property rows of every device, reported altogether by m_updateTimer
+    QHash<InputDevice *, std::pair<int, int>> m_pendingChanges;
+    QTimer m_updateTimer;
 };
 
 class DataSourceModel : public QAbstractItemModel
@@ -222,4 +238,74 @@ public:
     explicit DebugConsoleEffectsTab(QWidget *parent = nullptr);
 };
 
+class DebugConsoleFrameTimingsTab : public QTreeWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DebugConsoleFrameTimingsTab(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void updateTimings();
+
+    QTimer m_updateTimer;
+};
+
+class DebugConsoleFrameCountersTab : public QTreeWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DebugConsoleFrameCountersTab(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void updateCounters();
+
+    QTimer m_updateTimer;
+};
+
+class DebugConsoleGpuMemoryTab : public QTreeWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DebugConsoleGpuMemoryTab(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void updateUsage();
+
+    QTimer m_updateTimer;
+};
+
+class DebugConsoleClientsTab : public QTreeWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DebugConsoleClientsTab(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void updateStatistics();
+
+    QTimer m_updateTimer;
+    std::chrono::steady_clock::time_point m_lastUpdate;
+    QHash<ClientConnection *, ClientConnection::Statistics> m_lastStatistics;
+};
+
 } // namespace KWin
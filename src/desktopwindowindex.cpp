@@ -0,0 +1,116 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "desktopwindowindex.h"
+#include "window.h"
+
+namespace KWin
+{
+
+template<typename Key>
+static void removeFromBuckets(QHash<Key, QList<Window *>> &buckets, QList<Window *> &everywhere, const QList<Key> &keys, Window *window)
+{
+    if (keys.isEmpty()) {
+        everywhere.removeOne(window);
+        return;
+    }
+    for (const Key &key : keys) {
+        if (auto it = buckets.find(key); it != buckets.end()) {
+            it->removeOne(window);
+            if (it->isEmpty()) {
+                buckets.erase(it);
+            }
+        }
+    }
+}
+
+template<typename Key>
+static void insertIntoBuckets(QHash<Key, QList<Window *>> &buckets, QList<Window *> &everywhere, const QList<Key> &keys, Window *window)
+{
+    if (keys.isEmpty()) {
+        everywhere.append(window);
+        return;
+    }
+    for (const Key &key : keys) {
+        buckets[key].append(window);
+    }
+}
+
+void DesktopWindowIndex::add(Window *window)
+{
+    if (m_windows.contains(window)) {
+        return;
+    }
+    connect(window, &Window::desktopsChanged, this, [this, window]() {
+        updateDesktops(window);
+    });
+    connect(window, &Window::activitiesChanged, this, [this, window]() {
+        updateActivities(window);
+    });
+
+    Entry &entry = m_windows[window];
+    entry.desktops = window->desktops();
+    entry.activities = window->activities();
+    insertIntoBuckets(m_desktops, m_onAllDesktops, entry.desktops, window);
+    insertIntoBuckets(m_activities, m_onAllActivities, entry.activities, window);
+}
+
+void DesktopWindowIndex::remove(Window *window)
+{
+    disconnect(window, nullptr, this, nullptr);
+    if (auto it = m_windows.find(window); it != m_windows.end()) {
+        removeFromBuckets(m_desktops, m_onAllDesktops, it->desktops, window);
+        removeFromBuckets(m_activities, m_onAllActivities, it->activities, window);
+        m_windows.erase(it);
+    }
+}
+
+void DesktopWindowIndex::updateDesktops(Window *window)
+{
+    auto it = m_windows.find(window);
+    if (it == m_windows.end()) {
+        return;
+    }
+    const QList<VirtualDesktop *> desktops = window->desktops();
+    if (it->desktops == desktops) {
+        return;
+    }
+    removeFromBuckets(m_desktops, m_onAllDesktops, it->desktops, window);
+    it->desktops = desktops;
+    insertIntoBuckets(m_desktops, m_onAllDesktops, it->desktops, window);
+}
+
+void DesktopWindowIndex::updateActivities(Window *window)
+{
+    auto it = m_windows.find(window);
+    if (it == m_windows.end()) {
+        return;
+    }
+    const QStringList activities = window->activities();
+    if (it->activities == activities) {
+        return;
+    }
+    removeFromBuckets(m_activities, m_onAllActivities, it->activities, window);
+    it->activities = activities;
+    insertIntoBuckets(m_activities, m_onAllActivities, it->activities, window);
+}
+
+QList<Window *> DesktopWindowIndex::windowsOnDesktop(VirtualDesktop *desktop) const
+{
+    return m_desktops.value(desktop) + m_onAllDesktops;
+}
+
+QList<Window *> DesktopWindowIndex::windowsOnActivity(const QString &activity) const
+{
+    return m_activities.value(activity) + m_onAllActivities;
+}
+
+} // namespace KWin
+
+#include "moc_desktopwindowindex.cpp"
@@ -0,0 +1,63 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+namespace KWin
+{
+
+class VirtualDesktop;
+class Window;
+
+/**
+ * The DesktopWindowIndex class keeps track of the windows on every virtual desktop and every
+ * activity, so that the windows of a desktop can be looked at without filtering all windows.
+ *
+ * The windows are not in the stacking order.
+ */
+class DesktopWindowIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    void add(Window *window);
+    void remove(Window *window);
+
+    /**
+     * Returns the windows on the given @a desktop, including the windows on all desktops.
+     */
+    QList<Window *> windowsOnDesktop(VirtualDesktop *desktop) const;
+    /**
+     * Returns the windows on the given @a activity, including the windows on all activities.
+     */
+    QList<Window *> windowsOnActivity(const QString &activity) const;
+
+private:
+    void updateDesktops(Window *window);
+    void updateActivities(Window *window);
+
+    struct Entry
+    {
+        QList<VirtualDesktop *> desktops;
+        QStringList activities;
+    };
+
+    QHash<Window *, Entry> m_windows;
+    QHash<VirtualDesktop *, QList<Window *>> m_desktops;
+    QList<Window *> m_onAllDesktops;
+    QHash<QString, QList<Window *>> m_activities;
+    QList<Window *> m_onAllActivities;
+};
+
+} // namespace KWin
@@ -24,7 +24,7 @@ namespace KWin
 {
 
 DpmsInputEventFilter::DpmsInputEventFilter()
-    : InputEventFilter(InputFilterOrder::Dpms)
+    : InputEventFilter(InputFilterOrder::Dpms, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Tablet)
 {
     KSharedConfig::Ptr kwinSettings = kwinApp()->config();
     m_enableDoubleTap = kwinSettings->group(QStringLiteral("Wayland")).readEntry<bool>("DoubleTapWakeup", true);
@@ -40,7 +40,11 @@ public:
         m_animationsTouched = m_isInitialized = false;
         m_justEndedAnimation = 0;
     }
+    std::pair<EffectWindow *, AniData *> findAnimation(quint64 animationId);
+
     AnimationEffect::AniMap m_animations;
+    // The windows of the animations by animation id, scripts refer to animations by id a lot
+    std::unordered_map<quint64, EffectWindow *> m_animationWindows;
     static quint64 m_animCounter;
     quint64 m_justEndedAnimation; // protect against cancel
     std::weak_ptr<FullScreenEffectLock> m_fullScreenEffectLock;
@@ -49,6 +53,22 @@ public:
 
 quint64 AnimationEffectPrivate::m_animCounter = 0;
 
+std::pair<EffectWindow *, AniData *> AnimationEffectPrivate::findAnimation(quint64 animationId)
+{
+    const auto window = m_animationWindows.find(animationId);
+    if (window == m_animationWindows.end()) {
+        return {nullptr, nullptr};
+    }
+    const auto entry = m_animations.find(window->second);
+    Q_ASSERT(entry != m_animations.end());
+    auto &animations = entry->second.first;
+    const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
+        return anim.id == animationId;
+    });
+    Q_ASSERT(anim != animations.end());
+    return {window->second, &*anim};
+}
+
 AnimationEffect::AnimationEffect()
     : CrossFadeEffect()
     , d(std::make_unique<AnimationEffectPrivate>())
@@ -225,6 +245,7 @@ quint64 AnimationEffect::p_animate(EffectWindow *w, Attribute a, uint meta, int
         connect(w, &EffectWindow::windowExpandedGeometryChanged,
                 this, &AnimationEffect::_windowExpandedGeometryChanged);
         it = d->m_animations.emplace(std::make_pair(w, std::pair<std::vector<AniData>, QRect>{})).first;
+        setWindowSelected(w, true);
     }
     auto &[animations, rect] = it->second;
 
@@ -255,6 +276,7 @@ quint64 AnimationEffect::p_animate(EffectWindow *w, Attribute a, uint meta, int
     const quint64 ret_id = ++d->m_animCounter;
     AniData &animation = animations.back();
     animation.id = ret_id;
+    d->m_animationWindows[ret_id] = w;
 
     animation.visibleRef = EffectWindowVisibleRef(w, EffectWindow::PAINT_DISABLED_BY_MINIMIZE | EffectWindow::PAINT_DISABLED_BY_DESKTOP | EffectWindow::PAINT_DISABLED);
     animation.timeLine.setDirection(TimeLine::Forward);
@@ -293,29 +315,25 @@ bool AnimationEffect::retarget(quint64 animationId, FPx2 newTarget, int newRemai
     if (animationId == d->m_justEndedAnimation) {
         return false; // this is just ending, do not try to retarget it
     }
-    for (auto &[window, pair] : d->m_animations) {
-        auto &[animations, rect] = pair;
-        const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
-            return anim.id == animationId;
-        });
-        if (anim != animations.end()) {
-            anim->from.set(interpolated(*anim, 0), interpolated(*anim, 1));
-            validate(anim->attribute, anim->meta, nullptr, &newTarget, window);
-            anim->to.set(newTarget[0], newTarget[1]);
+    const auto [window, anim] = d->findAnimation(animationId);
+    if (!anim) {
+        return false;
+    }
 
-            anim->timeLine.setDirection(TimeLine::Forward);
-            anim->timeLine.setDuration(std::chrono::milliseconds(newRemainingTime));
-            anim->timeLine.reset();
+    anim->from.set(interpolated(*anim, 0), interpolated(*anim, 1));
+    validate(anim->attribute, anim->meta, nullptr, &newTarget, window);
+    anim->to.set(newTarget[0], newTarget[1]);
 
-            if (anim->attribute == CrossFadePrevious) {
-                CrossFadeEffect::redirect(window);
-            }
+    anim->timeLine.setDirection(TimeLine::Forward);
+    anim->timeLine.setDuration(std::chrono::milliseconds(newRemainingTime));
+    anim->timeLine.reset();
 
-            triggerRepaint();
-            return true;
-        }
+    if (anim->attribute == CrossFadePrevious) {
+        CrossFadeEffect::redirect(window);
     }
-    return false;
+
+    triggerRepaint();
+    return true;
 }
 
 bool AnimationEffect::freezeInTime(quint64 animationId, qint64 frozenTime)
@@ -323,20 +341,16 @@ bool AnimationEffect::freezeInTime(quint64 animationId, qint64 frozenTime)
     if (animationId == d->m_justEndedAnimation) {
         return false; // this is just ending, do not try to retarget it
     }
-    for (auto &[window, pair] : d->m_animations) {
-        auto &[animations, rect] = pair;
-        const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
-            return anim.id == animationId;
-        });
-        if (anim != animations.end()) {
-            if (frozenTime >= 0) {
-                anim->timeLine.setElapsed(std::chrono::milliseconds(frozenTime));
-            }
-            anim->frozenTime = frozenTime;
-            return true;
-        }
+    const auto [window, anim] = d->findAnimation(animationId);
+    if (!anim) {
+        return false;
     }
-    return false;
+
+    if (frozenTime >= 0) {
+        anim->timeLine.setElapsed(std::chrono::milliseconds(frozenTime));
+    }
+    anim->frozenTime = frozenTime;
+    return true;
 }
 
 bool AnimationEffect::redirect(quint64 animationId, Direction direction, TerminationFlags terminationFlags)
@@ -344,25 +358,21 @@ bool AnimationEffect::redirect(quint64 animationId, Direction direction, Termina
     if (animationId == d->m_justEndedAnimation) {
         return false;
     }
-    for (auto &[window, pair] : d->m_animations) {
-        auto &[animations, rect] = pair;
-        const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
-            return anim.id == animationId;
-        });
-        if (anim != animations.end()) {
-            switch (direction) {
-            case Backward:
-                anim->timeLine.setDirection(TimeLine::Backward);
-                break;
-            case Forward:
-                anim->timeLine.setDirection(TimeLine::Forward);
-                break;
-            }
-            anim->terminationFlags = terminationFlags & ~TerminateAtTarget;
-            return true;
-        }
+    const auto [window, anim] = d->findAnimation(animationId);
+    if (!anim) {
+        return false;
     }
-    return false;
+
+    switch (direction) {
+    case Backward:
+        anim->timeLine.setDirection(TimeLine::Backward);
+        break;
+    case Forward:
+        anim->timeLine.setDirection(TimeLine::Forward);
+        break;
+    }
+    anim->terminationFlags = terminationFlags & ~TerminateAtTarget;
+    return true;
 }
 
 bool AnimationEffect::complete(quint64 animationId)
@@ -370,18 +380,14 @@ bool AnimationEffect::complete(quint64 animationId)
     if (animationId == d->m_justEndedAnimation) {
         return false;
     }
-    for (auto &[window, pair] : d->m_animations) {
-        auto &[animations, rect] = pair;
-        const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
-            return anim.id == animationId;
-        });
-        if (anim != animations.end()) {
-            anim->timeLine.setElapsed(anim->timeLine.duration());
-            unredirect(window);
-            return true;
-        }
+    const auto [window, anim] = d->findAnimation(animationId);
+    if (!anim) {
+        return false;
     }
-    return false;
+
+    anim->timeLine.setElapsed(anim->timeLine.duration());
+    unredirect(window);
+    return true;
 }
 
 bool AnimationEffect::cancel(quint64 animationId)
@@ -389,29 +395,34 @@ bool AnimationEffect::cancel(quint64 animationId)
     if (animationId == d->m_justEndedAnimation) {
         return true; // this is just ending, do not try to cancel it but fake success
     }
-    for (auto &[window, pair] : d->m_animations) {
-        auto &[animations, rect] = pair;
-        const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
-            return anim.id == animationId;
-        });
-        if (anim != animations.end()) {
-            EffectWindowDeletedRef ref = std::move(anim->deletedRef); // delete window once we're done updating m_animations
-            if (std::ranges::none_of(animations, [animationId](const auto &anim) {
-                return anim.id != animationId && (anim.shader || anim.attribute == AnimationEffect::CrossFadePrevious);
-            })) {
-                unredirect(window);
-            }
-            animations.erase(anim);
-            if (animations.empty()) { // no other animations on the window, release it.
-                disconnect(window, &EffectWindow::windowExpandedGeometryChanged,
-                           this, &AnimationEffect::_windowExpandedGeometryChanged);
-                d->m_animations.erase(window);
-            }
-            d->m_animationsTouched = true; // could be called from animationEnded
-            return true;
-        }
+    const auto windowIt = d->m_animationWindows.find(animationId);
+    if (windowIt == d->m_animationWindows.end()) {
+        return false;
     }
-    return false;
+    EffectWindow *window = windowIt->second;
+    d->m_animationWindows.erase(windowIt);
+
+    auto &animations = d->m_animations.at(window).first;
+    const auto anim = std::ranges::find_if(animations, [animationId](const auto &anim) {
+        return anim.id == animationId;
+    });
+    Q_ASSERT(anim != animations.end());
+
+    EffectWindowDeletedRef ref = std::move(anim->deletedRef); // delete window once we're done updating m_animations
+    if (std::ranges::none_of(animations, [animationId](const auto &anim) {
+        return anim.id != animationId && (anim.shader || anim.attribute == AnimationEffect::CrossFadePrevious);
+    })) {
+        unredirect(window);
+    }
+    animations.erase(anim);
+    if (animations.empty()) { // no other animations on the window, release it.
+        disconnect(window, &EffectWindow::windowExpandedGeometryChanged,
+                   this, &AnimationEffect::_windowExpandedGeometryChanged);
+        setWindowSelected(window, false);
+        d->m_animations.erase(window);
+    }
+    d->m_animationsTouched = true; // could be called from animationEnded
+    return true;
 }
 
 void AnimationEffect::animationEnded(EffectWindow *w, Attribute a, uint meta)
@@ -471,8 +482,9 @@ void AnimationEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPr
     if (entry != d->m_animations.end()) {
         auto &[window, pair] = *entry;
         auto &[list, rect] = pair;
+        const qint64 now = clock();
         for (auto &anim : list) {
-            if (anim.startTime > clock() && !anim.waitAtSource) {
+            if (anim.startTime > now && !anim.waitAtSource) {
                 continue;
             }
 
@@ -511,33 +523,41 @@ void AnimationEffect::paintWindow(const RenderTarget &renderTarget, const Render
     QRegion effectiveDeviceRegion = deviceRegion;
     auto &[window, pair] = *it;
     auto &[list, rect] = pair;
+    const qint64 now = clock();
     for (auto &anim : list) {
-        if (anim.startTime > clock() && !anim.waitAtSource) {
+        if (anim.startTime > now && !anim.waitAtSource) {
             continue;
         }
 
+        // Evaluate the easing curve once, all attributes below are derived from its value
+        const float value = anim.timeLine.value();
+        const float animationProgress = anim.startTime < now ? value : 0.0;
+        const auto interpolatedValue = [&anim, value](int i = 0) {
+            return anim.from[i] + value * (anim.to[i] - anim.from[i]);
+        };
+
         switch (anim.attribute) {
         case Opacity:
-            data.multiplyOpacity(interpolated(anim));
+            data.multiplyOpacity(interpolatedValue());
             break;
         case Brightness:
-            data.multiplyBrightness(interpolated(anim));
+            data.multiplyBrightness(interpolatedValue());
             break;
         case Saturation:
-            data.multiplySaturation(interpolated(anim));
+            data.multiplySaturation(interpolatedValue());
             break;
         case Scale: {
             const QSizeF sz = w->frameGeometry().size();
             float f1(1.0), f2(0.0);
             if (anim.from[0] >= 0.0 && anim.to[0] >= 0.0) { // scale x
-                f1 = interpolated(anim, 0);
+                f1 = interpolatedValue(0);
                 f2 = geometryCompensation(anim.meta & AnimationEffect::Horizontal, f1);
                 data.translate(f2 * sz.width());
                 data.setXScale(data.xScale() * f1);
             }
             if (anim.from[1] >= 0.0 && anim.to[1] >= 0.0) { // scale y
                 if (!anim.isOneDimensional()) {
-                    f1 = interpolated(anim, 1);
+                    f1 = interpolatedValue(1);
                     f2 = geometryCompensation(anim.meta & AnimationEffect::Vertical, f1);
                 } else if (((anim.meta & AnimationEffect::Vertical) >> 1) != (anim.meta & AnimationEffect::Horizontal)) {
                     f2 = geometryCompensation(anim.meta & AnimationEffect::Vertical, f1);
@@ -551,10 +571,10 @@ void AnimationEffect::paintWindow(const RenderTarget &renderTarget, const Render
             effectiveDeviceRegion &= viewport.mapToDeviceCoordinatesAligned(clipRect(w->expandedGeometry().toAlignedRect(), anim));
             break;
         case Translation:
-            data += QPointF(interpolated(anim, 0), interpolated(anim, 1));
+            data += QPointF(interpolatedValue(0), interpolatedValue(1));
             break;
         case Size: {
-            FPx2 dest = anim.from + progress(anim) * (anim.to - anim.from);
+            FPx2 dest = anim.from + animationProgress * (anim.to - anim.from);
             const QSizeF sz = w->frameGeometry().size();
             float f;
             if (anim.from[0] >= 0.0 && anim.to[0] >= 0.0) { // resize x
@@ -571,15 +591,15 @@ void AnimationEffect::paintWindow(const RenderTarget &renderTarget, const Render
         }
         case Position: {
             const QRectF geo = w->frameGeometry();
-            const float prgrs = progress(anim);
+            const float prgrs = animationProgress;
             if (anim.from[0] >= 0.0 && anim.to[0] >= 0.0) {
-                float dest = interpolated(anim, 0);
+                float dest = interpolatedValue(0);
                 const qreal x[2] = {xCoord(geo, metaData(SourceAnchor, anim.meta)),
                                     xCoord(geo, metaData(TargetAnchor, anim.meta))};
                 data.translate(dest - (x[0] + prgrs * (x[1] - x[0])));
             }
             if (anim.from[1] >= 0.0 && anim.to[1] >= 0.0) {
-                float dest = interpolated(anim, 1);
+                float dest = interpolatedValue(1);
                 const qreal y[2] = {yCoord(geo, metaData(SourceAnchor, anim.meta)),
                                     yCoord(geo, metaData(TargetAnchor, anim.meta))};
                 data.translate(0.0, dest - (y[0] + prgrs * (y[1] - y[0])));
@@ -588,7 +608,7 @@ void AnimationEffect::paintWindow(const RenderTarget &renderTarget, const Render
         }
         case Rotation: {
             data.setRotationAxis((Qt::Axis)metaData(Axis, anim.meta));
-            const float prgrs = progress(anim);
+            const float prgrs = animationProgress;
             data.setRotationAngle(anim.from[0] + prgrs * (anim.to[0] - anim.from[0]));
 
             const QRect geo = w->rect().toRect();
@@ -604,23 +624,23 @@ void AnimationEffect::paintWindow(const RenderTarget &renderTarget, const Render
             break;
         }
         case Generic:
-            genericAnimation(w, data, progress(anim), anim.meta);
+            genericAnimation(w, data, animationProgress, anim.meta);
             break;
         case CrossFadePrevious:
-            data.setCrossFadeProgress(progress(anim));
+            data.setCrossFadeProgress(animationProgress);
             break;
         case Shader:
             if (anim.shader && anim.shader->isValid()) {
                 ShaderBinder binder{anim.shader};
-                anim.shader->setUniform("animationProgress", progress(anim));
+                anim.shader->setUniform("animationProgress", animationProgress);
                 setShader(w, anim.shader);
             }
             break;
         case ShaderUniform:
             if (anim.shader && anim.shader->isValid()) {
                 ShaderBinder binder{anim.shader};
-                anim.shader->setUniform("animationProgress", progress(anim));
-                anim.shader->setUniform(anim.meta, interpolated(anim));
+                anim.shader->setUniform("animationProgress", animationProgress);
+                anim.shader->setUniform(anim.meta, interpolatedValue());
                 setShader(w, anim.shader);
             }
             break;
@@ -673,6 +693,7 @@ void AnimationEffect::postPaintScreen()
             if (!anim->deletedRef.isNull()) {
                 zombies.emplace_back(std::move(anim->deletedRef));
             }
+            d->m_animationWindows.erase(anim->id);
             anim = entry->second.first.erase(anim);
             invalidateLayerRect = damageDirty = true;
         }
@@ -680,6 +701,7 @@ void AnimationEffect::postPaintScreen()
             disconnect(window, &EffectWindow::windowExpandedGeometryChanged,
                        this, &AnimationEffect::_windowExpandedGeometryChanged);
             effects->addRepaint(entry->second.second);
+            setWindowSelected(window, false);
             entry = d->m_animations.erase(entry);
         } else {
             if (invalidateLayerRect) {
@@ -959,7 +981,13 @@ void AnimationEffect::_windowClosed(EffectWindow *w)
 
 void AnimationEffect::_windowDeleted(EffectWindow *w)
 {
-    d->m_animations.erase(w);
+    setWindowSelected(w, false);
+    if (const auto entry = d->m_animations.find(w); entry != d->m_animations.end()) {
+        for (const AniData &anim : entry->second.first) {
+            d->m_animationWindows.erase(anim.id);
+        }
+        d->m_animations.erase(entry);
+    }
 }
 
 QString AnimationEffect::debug(const QString &parameter) const
@@ -525,6 +525,37 @@ bool Effect::blocksDirectScanout() const
     return true;
 }
 
+bool Effect::paintsSelectedWindowsOnly() const
+{
+    return m_paintsSelectedWindowsOnly;
+}
+
+void Effect::setPaintsSelectedWindowsOnly(bool only)
+{
+    if (m_paintsSelectedWindowsOnly != only) {
+        m_paintsSelectedWindowsOnly = only;
+        effects->invalidateWindowPaintChains();
+    }
+}
+
+bool Effect::isWindowSelected(const EffectWindow *w) const
+{
+    return m_selectedWindows.contains(w);
+}
+
+void Effect::setWindowSelected(const EffectWindow *w, bool selected)
+{
+    const bool changed = selected ? !m_selectedWindows.contains(w) : m_selectedWindows.remove(w);
+    if (changed) {
+        if (selected) {
+            m_selectedWindows.insert(w);
+        }
+        if (m_paintsSelectedWindowsOnly) {
+            effects->invalidateWindowPaintChains();
+        }
+    }
+}
+
 EffectPluginFactory::EffectPluginFactory()
 {
 }
@@ -12,6 +12,7 @@
 #include "effect/globals.h"
 
 #include <QRegion>
+#include <QSet>
 
 #include <KPluginFactory>
 #include <KSharedConfig>
@@ -906,8 +907,43 @@ public:
      */
     virtual bool blocksDirectScanout() const;
 
+    /**
+     * Returns @c true if prePaintWindow(), paintWindow() and drawWindow() are called only for
+     * the windows that have been selected with setWindowSelected(); otherwise returns @c false,
+     * which is the default.
+     *
+     * @see setPaintsSelectedWindowsOnly()
+     */
+    bool paintsSelectedWindowsOnly() const;
+
+    /**
+     * Returns @c true if the window @a w has been selected with setWindowSelected().
+     */
+    bool isWindowSelected(const EffectWindow *w) const;
+
 public Q_SLOTS:
     virtual bool borderActivated(ElectricBorder border);
+
+protected:
+    /**
+     * Makes the window painting methods of the effect be called only for the windows that have
+     * been selected with setWindowSelected(). The other windows are painted as if the effect
+     * didn't exist, which is much cheaper for effects that change only a few windows.
+     */
+    void setPaintsSelectedWindowsOnly(bool only);
+
+    /**
+     * Selects or unselects the window @a w for painting by the effect.
+     *
+     * @see setPaintsSelectedWindowsOnly()
+     */
+    void setWindowSelected(const EffectWindow *w, bool selected);
+
+private:
+    friend class EffectsHandler;
+
+    QSet<const EffectWindow *> m_selectedWindows;
+    bool m_paintsSelectedWindowsOnly = false;
 };
 
 template<typename T>
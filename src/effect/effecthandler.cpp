@@ -14,9 +14,11 @@
 #include "config-kwin.h"
 
 #include "compositor.h"
+#include "core/backendoutput.h"
 #include "core/inputdevice.h"
 #include "core/output.h"
 #include "core/renderbackend.h"
+#include "core/renderloop.h"
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
 #include "decorations/decorationbridge.h"
@@ -70,6 +72,9 @@
 #include <QWindow>
 #include <QtMath>
 
+#include <algorithm>
+#include <utility>
+
 namespace KWin
 {
 #if KWIN_BUILD_X11
@@ -184,6 +189,10 @@ EffectsHandler::EffectsHandler(Compositor *compositor, WorkspaceScene *scene)
     });
     connect(ws, &Workspace::deletedRemoved, this, [this](KWin::Window *d) {
         Q_EMIT windowDeleted(d->effectWindow());
+        m_windowPaintChains.erase(d->effectWindow());
+        for (const EffectPair &effect : std::as_const(loaded_effects)) {
+            effect.second->setWindowSelected(d->effectWindow(), false);
+        }
     });
     connect(ws->sessionManager(), &SessionManager::stateChanged, this, &KWin::EffectsHandler::sessionStateChanged);
     connect(vds, &VirtualDesktopManager::layoutChanged, this, [this](int width, int height) {
@@ -332,6 +341,7 @@ EglContext *EffectsHandler::openglContext() const
 void EffectsHandler::unloadAllEffects()
 {
     m_activeEffects.clear();
+    m_activeEffectOwners.clear();
     effect_order.clear();
     m_effectLoader->clear();
 
@@ -361,6 +371,7 @@ void EffectsHandler::reconfigure()
 void EffectsHandler::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        GpuMemoryOwnerScope memoryScope(&m_activeEffectOwners[m_currentPaintScreenIterator - m_activeEffects.constBegin()]);
         (*m_currentPaintScreenIterator++)->prePaintScreen(data, presentTime);
         --m_currentPaintScreenIterator;
     }
@@ -370,36 +381,78 @@ void EffectsHandler::prePaintScreen(ScreenPrePaintData &data, std::chrono::milli
 void EffectsHandler::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        GpuMemoryOwnerScope memoryScope(&m_activeEffectOwners[m_currentPaintScreenIterator - m_activeEffects.constBegin()]);
         (*m_currentPaintScreenIterator++)->paintScreen(renderTarget, viewport, mask, deviceRegion, screen);
         --m_currentPaintScreenIterator;
     } else {
+        const auto start = std::chrono::steady_clock::now();
         m_scene->finalPaintScreen(renderTarget, viewport, mask, deviceRegion, screen);
+        m_scenePaintDuration = std::chrono::steady_clock::now() - start;
     }
 }
 
+std::chrono::nanoseconds EffectsHandler::scenePaintDuration() const
+{
+    return m_scenePaintDuration;
+}
+
 void EffectsHandler::postPaintScreen()
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        GpuMemoryOwnerScope memoryScope(&m_activeEffectOwners[m_currentPaintScreenIterator - m_activeEffects.constBegin()]);
         (*m_currentPaintScreenIterator++)->postPaintScreen();
         --m_currentPaintScreenIterator;
     }
     // no special final code
 }
 
+int EffectsHandler::nextWindowPaintEffect(const EffectWindow *w, int position)
+{
+    if (!m_haveSelectiveActiveEffects) {
+        return position < m_activeEffects.size() ? position : -1;
+    }
+
+    WindowPaintChain &chain = m_windowPaintChains[w];
+    if (chain.serial != m_windowPaintChainSerial) {
+        chain.effects.clear();
+        for (int i = 0; i < m_activeEffects.size(); ++i) {
+            const Effect *effect = m_activeEffects[i];
+            if (!effect->paintsSelectedWindowsOnly() || effect->isWindowSelected(w)) {
+                chain.effects.push_back(i);
+            }
+        }
+        chain.serial = m_windowPaintChainSerial;
+    }
+
+    // An effect may paint another window from its paint methods, that goes on with the effects
+    // that come after it in the chain
+    const auto it = std::lower_bound(chain.effects.cbegin(), chain.effects.cend(), position);
+    return it != chain.effects.cend() ? *it : -1;
+}
+
+void EffectsHandler::invalidateWindowPaintChains()
+{
+    m_windowPaintChainSerial++;
+}
+
 void EffectsHandler::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->prePaintWindow(view, w, data, presentTime);
-        --m_currentPaintWindowIterator;
+    if (const int index = nextWindowPaintEffect(w, m_currentPaintWindowPosition); index != -1) {
+        const int previous = std::exchange(m_currentPaintWindowPosition, index + 1);
+        GpuMemoryOwnerScope memoryScope(&m_activeEffectOwners[index]);
+        m_activeEffects[index]->prePaintWindow(view, w, data, presentTime);
+        m_currentPaintWindowPosition = previous;
     }
     // no special final code
 }
 
 void EffectsHandler::paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->paintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
-        --m_currentPaintWindowIterator;
+    if (const int index = nextWindowPaintEffect(w, m_currentPaintWindowPosition); index != -1) {
+        const int previous = std::exchange(m_currentPaintWindowPosition, index + 1);
+        GpuMemoryOwnerScope memoryScope(&m_activeEffectOwners[index]);
+        m_activeEffects[index]->paintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
+        m_currentPaintWindowPosition = previous;
     } else {
         m_scene->finalPaintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
     }
@@ -417,9 +470,11 @@ Effect *EffectsHandler::provides(Effect::Feature ef)
 
 void EffectsHandler::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
 {
-    if (m_currentDrawWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentDrawWindowIterator++)->drawWindow(renderTarget, viewport, w, mask, deviceRegion, data);
-        --m_currentDrawWindowIterator;
+    if (const int index = nextWindowPaintEffect(w, m_currentDrawWindowPosition); index != -1) {
+        const int previous = std::exchange(m_currentDrawWindowPosition, index + 1);
+        GpuMemoryOwnerScope memoryScope(&m_activeEffectOwners[index]);
+        m_activeEffects[index]->drawWindow(renderTarget, viewport, w, mask, deviceRegion, data);
+        m_currentDrawWindowPosition = previous;
     } else {
         m_scene->finalDrawWindow(renderTarget, viewport, w, mask, deviceRegion, data);
     }
@@ -443,15 +498,30 @@ bool EffectsHandler::decorationsHaveAlpha() const
 // start another painting pass
 void EffectsHandler::startPaint()
 {
-    m_activeEffects.clear();
+    const EffectsList previousActiveEffects = std::exchange(m_activeEffects, EffectsList());
     m_activeEffects.reserve(loaded_effects.count());
+    m_haveSelectiveActiveEffects = false;
     for (QList<KWin::EffectPair>::const_iterator it = loaded_effects.constBegin(); it != loaded_effects.constEnd(); ++it) {
         if (it->second->isActive()) {
             m_activeEffects << it->second;
+            m_haveSelectiveActiveEffects |= it->second->paintsSelectedWindowsOnly();
         }
     }
-    m_currentDrawWindowIterator = m_activeEffects.constBegin();
-    m_currentPaintWindowIterator = m_activeEffects.constBegin();
+    if (m_activeEffects != previousActiveEffects) {
+        invalidateWindowPaintChains();
+        m_activeEffectOwners.clear();
+        m_activeEffectOwners.reserve(m_activeEffects.count());
+        for (const auto &[name, effect] : std::as_const(loaded_effects)) {
+            if (m_activeEffects.contains(effect)) {
+                m_activeEffectOwners.append(GpuMemoryOwner{
+                    .kind = GpuMemoryOwner::Kind::Effect,
+                    .name = name,
+                });
+            }
+        }
+    }
+    m_currentDrawWindowPosition = 0;
+    m_currentPaintWindowPosition = 0;
     m_currentPaintScreenIterator = m_activeEffects.constBegin();
 }
 
@@ -1317,6 +1387,7 @@ void EffectsHandler::effectsChanged()
 {
     loaded_effects.clear();
     m_activeEffects.clear(); // it's possible to have a reconfigure and a quad rebuild between two paint cycles - bug #308201
+    m_activeEffectOwners.clear();
 
     loaded_effects.reserve(effect_order.count());
     std::copy(effect_order.constBegin(), effect_order.constEnd(),
@@ -1325,8 +1396,10 @@ void EffectsHandler::effectsChanged()
     m_activeEffects.reserve(loaded_effects.count());
 
     m_currentPaintScreenIterator = m_activeEffects.constBegin();
-    m_currentPaintWindowIterator = m_activeEffects.constBegin();
-    m_currentDrawWindowIterator = m_activeEffects.constBegin();
+    m_currentPaintWindowPosition = 0;
+    m_currentDrawWindowPosition = 0;
+    m_haveSelectiveActiveEffects = false;
+    invalidateWindowPaintChains();
 }
 
 QStringList EffectsHandler::activeEffects() const
@@ -1590,6 +1663,16 @@ QList<LogicalOutput *> EffectsHandler::screens() const
     return Workspace::self()->outputs();
 }
 
+qreal EffectsHandler::renderQuality() const
+{
+    qreal quality = 1.0;
+    const auto outputs = Workspace::self()->outputs();
+    for (LogicalOutput *output : outputs) {
+        quality = std::min(quality, output->backendOutput()->renderLoop()->renderQuality());
+    }
+    return quality;
+}
+
 LogicalOutput *EffectsHandler::screenAt(const QPoint &point) const
 {
     return Workspace::self()->outputAt(point);
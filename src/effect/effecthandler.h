@@ -13,6 +13,7 @@
 #pragma once
 
 #include "config-kwin.h"
+#include "core/gpumemory.h"
 #include "effect/effect.h"
 #include "effect/effectwindow.h"
 
@@ -31,6 +32,8 @@
 #include <KConfigWatcher>
 
 #include <functional>
+#include <unordered_map>
+#include <vector>
 
 #if KWIN_BUILD_X11
 #include <xcb/xcb.h>
@@ -174,6 +177,11 @@ public:
     void prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime);
     void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen);
     void postPaintScreen();
+    /**
+     * Returns how long the scene took to paint the screen in the last paintScreen() call, not
+     * including the time spent in the effects. This is measured on the CPU.
+     */
+    std::chrono::nanoseconds scenePaintDuration() const;
     void prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime);
     void paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data);
     void drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data);
@@ -731,6 +739,14 @@ public:
     KWin::EffectWindow *inputPanel() const;
     bool isInputPanelOverlay() const;
 
+    /**
+     * Returns how much of their usual cost effects should spend on rendering, between 0.25
+     * and 1. It is the lowest render quality of all screens, see RenderLoop::renderQuality().
+     * Effects that can render more cheaply at a lower quality may follow it, e.g. by
+     * blurring with fewer passes.
+     */
+    qreal renderQuality() const;
+
     QQmlEngine *qmlEngine() const;
 
     /**
@@ -1086,6 +1102,18 @@ protected:
     typedef QList<Effect *> EffectsList;
     typedef EffectsList::const_iterator EffectsIterator;
 
+    /**
+     * The positions in m_activeEffects of the effects that paint a window.
+     */
+    struct WindowPaintChain
+    {
+        std::vector<int> effects;
+        quint64 serial = 0;
+    };
+
+    int nextWindowPaintEffect(const EffectWindow *w, int position);
+    void invalidateWindowPaintChains();
+
     struct
     {
         QPointF position;
@@ -1102,9 +1130,16 @@ protected:
     QList<EffectPair> loaded_effects;
     CompositingType compositing_type;
     EffectsList m_activeEffects;
-    EffectsIterator m_currentDrawWindowIterator;
-    EffectsIterator m_currentPaintWindowIterator;
+    // the owners of the GPU memory that the active effects allocate, in the same order
+    QList<GpuMemoryOwner> m_activeEffectOwners;
+    std::chrono::nanoseconds m_scenePaintDuration = std::chrono::nanoseconds::zero();
+    int m_currentDrawWindowPosition = 0;
+    int m_currentPaintWindowPosition = 0;
     EffectsIterator m_currentPaintScreenIterator;
+    // Most effects paint all windows, the chains are needed only if some active effect is picky
+    bool m_haveSelectiveActiveEffects = false;
+    quint64 m_windowPaintChainSerial = 1;
+    std::unordered_map<const EffectWindow *, WindowPaintChain> m_windowPaintChains;
     typedef QHash<QByteArray, QList<Effect *>> PropertyEffectMap;
 #if KWIN_BUILD_X11
     PropertyEffectMap m_propertiesForEffects;
@@ -392,14 +392,64 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
 }
 
 void PluginEffectLoader::queryAndLoadAll()
+{
+    if (m_queryConnection) {
+        return;
+    }
+    // KConfig may only be used on the main thread, tell the thread which effects are configured
+    QSet<QString> enabled;
+    QSet<QString> disabled;
+    const KConfigGroup plugins(m_config, QStringLiteral("Plugins"));
+    const QStringList keys = plugins.keyList();
+    for (const QString &key : keys) {
+        if (key.endsWith(QLatin1String("Enabled"))) {
+            const QString name = key.chopped(7);
+            if (plugins.readEntry(key, false)) {
+                enabled.insert(name);
+            } else {
+                disabled.insert(name);
+            }
+        }
+    }
+
+    // perform querying for the plugins and loading the libraries in a thread, the effects
+    // have to be created on the main thread in the order they were found though
+    QFutureWatcher<QList<KPluginMetaData>> *watcher = new QFutureWatcher<QList<KPluginMetaData>>(this);
+    m_queryConnection = connect(
+        watcher, &QFutureWatcher<QList<KPluginMetaData>>::finished, this, [this, watcher]() {
+            const auto effects = watcher->result();
+            watcher->deleteLater();
+            m_queryConnection = QMetaObject::Connection();
+            for (const auto &effect : effects) {
+                const LoadEffectFlags flags = readConfig(effect.pluginId(), effect.isEnabledByDefault());
+                if (flags.testFlag(LoadEffectFlag::Load)) {
+                    loadEffect(effect, flags);
+                }
+            }
+        },
+        Qt::QueuedConnection);
+    watcher->setFuture(QtConcurrent::run(&PluginEffectLoader::findAndPreloadEffects, this, enabled, disabled));
+}
+
+QList<KPluginMetaData> PluginEffectLoader::findAndPreloadEffects(const QSet<QString> &enabled, const QSet<QString> &disabled) const
 {
     const auto effects = findAllEffects();
     for (const auto &effect : effects) {
-        const LoadEffectFlags flags = readConfig(effect.pluginId(), effect.isEnabledByDefault());
-        if (flags.testFlag(LoadEffectFlag::Load)) {
-            loadEffect(effect, flags);
+        if (effect.isStaticPlugin()) {
+            continue;
+        }
+        const QString name = effect.pluginId();
+        if (!enabled.contains(name) && (disabled.contains(name) || !effect.isEnabledByDefault())) {
+            continue;
+        }
+        // the library stays loaded after the loader is gone, factory() only has to
+        // instantiate the plugin, which must happen on the main thread
+        QPluginLoader loader(effect.fileName());
+        if (loader.metaData().value("IID").toString() == QLatin1String(EffectPluginFactory_iid)) {
+            loader.load();
         }
     }
+    return effects;
 }
 
 QList<KPluginMetaData> PluginEffectLoader::findAllEffects() const
@@ -414,6 +464,8 @@ void PluginEffectLoader::setPluginSubDirectory(const QString &directory)
 
 void PluginEffectLoader::clear()
 {
+    disconnect(m_queryConnection);
+    m_queryConnection = QMetaObject::Connection();
 }
 
 EffectLoader::EffectLoader(QObject *parent)
@@ -17,6 +17,7 @@
 #include <QObject>
 #include <QPair>
 #include <QQueue>
+#include <QSet>
 #include <QStaticPlugin>
 
 namespace KWin
@@ -327,9 +328,11 @@ public:
 
 private:
     QList<KPluginMetaData> findAllEffects() const;
+    QList<KPluginMetaData> findAndPreloadEffects(const QSet<QString> &enabled, const QSet<QString> &disabled) const;
     EffectPluginFactory *factory(const KPluginMetaData &info) const;
     QStringList m_loadedEffects;
     QString m_pluginSubDirectory;
+    QMetaObject::Connection m_queryConnection;
 };
 
 class KWIN_EXPORT EffectLoader : public AbstractEffectLoader
@@ -23,6 +23,7 @@ struct OffscreenData
 public:
     virtual ~OffscreenData();
     void setDirty();
+    void addDamage(EffectWindow *window, const QRegion &region);
     void setShader(GLShader *newShader);
     void setVertexSnappingMode(RenderGeometry::VertexSnappingMode mode);
 
@@ -34,6 +35,9 @@ public:
     std::unique_ptr<GLTexture> m_texture;
     std::unique_ptr<GLFramebuffer> m_fbo;
     bool m_isDirty = true;
+    // The damage since the texture has been rendered, relative to the position of the window
+    QRegion m_damage;
+    qreal m_scale = 1.0;
     GLShader *m_shader = nullptr;
     RenderGeometry::VertexSnappingMode m_vertexSnappingMode = RenderGeometry::VertexSnappingMode::Round;
     QMetaObject::Connection m_windowDamagedConnection;
@@ -71,7 +75,9 @@ void OffscreenEffect::redirect(EffectWindow *window)
     offscreenData->setVertexSnappingMode(d->vertexSnappingMode);
     offscreenData->m_windowEffect = ItemEffect(window->windowItem());
     offscreenData->m_windowDamagedConnection =
-        connect(window, &EffectWindow::windowDamaged, this, &OffscreenEffect::handleWindowDamaged);
+        connect(window->windowItem(), &WindowItem::damaged, this, [data = offscreenData.get(), window](const QRegion &region) {
+            data->addDamage(window, region);
+        });
 
     if (d->windows.size() == 1) {
         setupConnections();
@@ -127,23 +133,54 @@ void OffscreenData::maybeRender(EffectWindow *window)
         m_fbo = std::make_unique<GLFramebuffer>(m_texture.get());
         m_isDirty = true;
     }
+    if (m_scale != scale) {
+        m_scale = scale;
+        m_isDirty = true;
+    }
 
+    RenderTarget renderTarget(m_fbo.get());
+    RenderViewport viewport(logicalGeometry, scale, renderTarget);
+
+    // Animations only change how the texture is mapped, so it needs to be updated only where
+    // the window itself has changed
+    QRegion deviceRegion;
     if (m_isDirty) {
-        RenderTarget renderTarget(m_fbo.get());
-        RenderViewport viewport(logicalGeometry, scale, renderTarget);
-        GLFramebuffer::pushFramebuffer(m_fbo.get());
-        glClearColor(0.0, 0.0, 0.0, 0.0);
+        deviceRegion = renderTarget.transformedRect();
+    } else if (!m_damage.isEmpty()) {
+        QRegion logicalDamage;
+        for (const QRect &rect : std::as_const(m_damage)) {
+            logicalDamage += QRectF(rect).translated(window->pos()).toAlignedRect();
+        }
+        deviceRegion = viewport.mapToDeviceCoordinatesAligned(logicalDamage) & renderTarget.transformedRect();
+    }
+    m_isDirty = false;
+    m_damage = QRegion();
+    if (deviceRegion.isEmpty()) {
+        return;
+    }
+
+    GLFramebuffer::pushFramebuffer(m_fbo.get());
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    if (deviceRegion == renderTarget.transformedRect()) {
         glClear(GL_COLOR_BUFFER_BIT);
+    } else {
+        glEnable(GL_SCISSOR_TEST);
+        const QSize targetSize = renderTarget.size();
+        for (const QRect &deviceRect : deviceRegion) {
+            const QRect bufferRect = viewport.transform().map(deviceRect, renderTarget.transformedSize());
+            glScissor(bufferRect.x(), targetSize.height() - (bufferRect.y() + bufferRect.height()), bufferRect.width(), bufferRect.height());
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        glDisable(GL_SCISSOR_TEST);
+    }
 
-        WindowPaintData data;
-        data.setOpacity(1.0);
+    WindowPaintData data;
+    data.setOpacity(1.0);
 
-        const int mask = Effect::PAINT_WINDOW_TRANSFORMED | Effect::PAINT_WINDOW_TRANSLUCENT;
-        effects->drawWindow(renderTarget, viewport, window, mask, infiniteRegion(), data);
+    const int mask = Effect::PAINT_WINDOW_TRANSFORMED | Effect::PAINT_WINDOW_TRANSLUCENT;
+    effects->drawWindow(renderTarget, viewport, window, mask, deviceRegion == renderTarget.transformedRect() ? infiniteRegion() : deviceRegion, data);
 
-        GLFramebuffer::popFramebuffer();
-        m_isDirty = false;
-    }
+    GLFramebuffer::popFramebuffer();
 }
 
 OffscreenData::~OffscreenData()
@@ -156,6 +193,21 @@ void OffscreenData::setDirty()
     m_isDirty = true;
 }
 
+void OffscreenData::addDamage(EffectWindow *window, const QRegion &region)
+{
+    if (m_isDirty) {
+        return;
+    }
+    if (region == infiniteRegion()) {
+        setDirty();
+        return;
+    }
+    // The window may move before the texture is updated
+    for (const QRect &rect : region) {
+        m_damage += QRectF(rect).translated(-window->pos()).toAlignedRect();
+    }
+}
+
 void OffscreenData::setShader(GLShader *newShader)
 {
     m_shader = newShader;
@@ -183,9 +235,7 @@ void OffscreenData::paint(const RenderTarget &renderTarget, const RenderViewport
 
     RenderGeometry geometry;
     geometry.setVertexSnappingMode(m_vertexSnappingMode);
-    for (auto &quad : quads) {
-        geometry.appendWindowQuad(quad, scale);
-    }
+    geometry.appendWindowQuads(quads, scale);
     geometry.postProcessTextureCoordinates(m_texture->matrix(NormalizedCoordinates));
 
     const auto map = vbo->map<GLVertex2D>(geometry.size());
@@ -261,13 +311,6 @@ void OffscreenEffect::drawWindow(const RenderTarget &renderTarget, const RenderV
     offscreenData->paint(renderTarget, viewport, window, deviceRegion, data, quads);
 }
 
-void OffscreenEffect::handleWindowDamaged(EffectWindow *window)
-{
-    if (const auto it = d->windows.find(window); it != d->windows.end()) {
-        it->second->setDirty();
-    }
-}
-
 void OffscreenEffect::handleWindowDeleted(EffectWindow *window)
 {
     unredirect(window);
@@ -75,7 +75,6 @@ protected:
     bool blocksDirectScanout() const override;
 
 private Q_SLOTS:
-    void handleWindowDamaged(EffectWindow *window);
     void handleWindowDeleted(EffectWindow *window);
 
 private:
@@ -32,16 +32,53 @@
 #include <QTimer>
 #include <private/qeventpoint_p.h> // for QMutableEventPoint
 
+#include <utility>
+
 namespace KWin
 {
 
+/**
+ * The OpenGL context that offscreen views render with. Creating a context is expensive and
+ * views are created often, e.g. every time an on-screen display is shown, so all views with
+ * the same format share one.
+ */
+struct OffscreenQuickContext
+{
+    std::unique_ptr<QOpenGLContext> context;
+    std::unique_ptr<QOffscreenSurface> surface;
+};
+
+static std::shared_ptr<OffscreenQuickContext> acquireOffscreenQuickContext(const QSurfaceFormat &format)
+{
+    static std::weak_ptr<OffscreenQuickContext> s_contexts[2];
+    std::weak_ptr<OffscreenQuickContext> &slot = s_contexts[format.alphaBufferSize() > 0];
+    if (auto context = slot.lock()) {
+        return context;
+    }
+
+    auto context = std::make_shared<OffscreenQuickContext>();
+    context->context = std::make_unique<QOpenGLContext>();
+    context->context->setShareContext(QOpenGLContext::globalShareContext());
+    context->context->setFormat(format);
+    context->context->create();
+
+    // and the offscreen surface
+    context->surface = std::make_unique<QOffscreenSurface>();
+    context->surface->setFormat(context->context->format());
+    context->surface->create();
+
+    slot = context;
+    return context;
+}
+
 class Q_DECL_HIDDEN OffscreenQuickView::Private
 {
 public:
     std::unique_ptr<QQuickWindow> m_view;
     std::unique_ptr<QQuickRenderControl> m_renderControl;
-    std::unique_ptr<QOffscreenSurface> m_offscreenSurface;
-    std::unique_ptr<QOpenGLContext> m_glcontext;
+    std::shared_ptr<OffscreenQuickContext> m_context;
+    QOffscreenSurface *m_offscreenSurface = nullptr;
+    QOpenGLContext *m_glcontext = nullptr;
     std::unique_ptr<QOpenGLFramebufferObject> m_fbo;
 
     std::unique_ptr<QTimer> m_repaintTimer;
@@ -53,6 +90,9 @@ public:
     bool m_visible = true;
     bool m_hasAlphaChannel = true;
     bool m_automaticRepaint = true;
+    // Whether the scene has changed since the last update, otherwise the scene graph only
+    // needs to be rendered again, e.g. to advance an animated shader
+    bool m_syncRequested = true;
 
     std::optional<qreal> m_explicitDpr;
 
@@ -116,20 +156,18 @@ OffscreenQuickView::OffscreenQuickView(ExportMode exportMode, bool alpha)
         d->m_view->setFormat(format);
 
         auto shareContext = QOpenGLContext::globalShareContext();
-        d->m_glcontext = std::make_unique<QOpenGLContext>();
-        d->m_glcontext->setShareContext(shareContext);
-        d->m_glcontext->setFormat(format);
-        d->m_glcontext->create();
-
-        // and the offscreen surface
-        d->m_offscreenSurface = std::make_unique<QOffscreenSurface>();
-        d->m_offscreenSurface->setFormat(d->m_glcontext->format());
-        d->m_offscreenSurface->create();
-
-        d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
-        d->m_view->setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(d->m_glcontext.get()));
+        d->m_context = acquireOffscreenQuickContext(format);
+        d->m_glcontext = d->m_context->context.get();
+        d->m_offscreenSurface = d->m_context->surface.get();
+
+        EglContext *previousContext = EglContext::currentContext();
+        d->m_glcontext->makeCurrent(d->m_offscreenSurface);
+        d->m_view->setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(d->m_glcontext));
         d->m_renderControl->initialize();
         d->m_glcontext->doneCurrent();
+        if (previousContext) {
+            previousContext->makeCurrent();
+        }
 
         // On Wayland, contexts are implicitly shared and QOpenGLContext::globalShareContext() is null.
         if (shareContext && !d->m_glcontext->shareContext()) {
@@ -162,13 +200,23 @@ OffscreenQuickView::~OffscreenQuickView()
     disconnect(d->m_renderControl.get(), &QQuickRenderControl::renderRequested, this, &OffscreenQuickView::handleRenderRequested);
     disconnect(d->m_renderControl.get(), &QQuickRenderControl::sceneChanged, this, &OffscreenQuickView::handleSceneChanged);
 
+    EglContext *previousContext = EglContext::currentContext();
     if (d->m_glcontext) {
         // close the view whilst we have an active GL context
-        d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
+        d->m_glcontext->makeCurrent(d->m_offscreenSurface);
     }
 
     d->m_view.reset();
     d->m_renderControl.reset();
+    d->m_fbo.reset();
+
+    if (d->m_glcontext) {
+        // the context is shared with other views and outlives this one
+        d->m_glcontext->doneCurrent();
+        if (previousContext) {
+            previousContext->makeCurrent();
+        }
+    }
 }
 
 bool OffscreenQuickView::automaticRepaint() const
@@ -195,6 +243,7 @@ void OffscreenQuickView::setDevicePixelRatio(qreal dpr)
 
 void OffscreenQuickView::handleSceneChanged()
 {
+    d->m_syncRequested = true;
     if (d->m_automaticRepaint) {
         d->m_repaintTimer->start();
     }
@@ -222,7 +271,7 @@ void OffscreenQuickView::update()
     EglContext *previousContext = EglContext::currentContext();
 
     if (usingGl) {
-        if (!d->m_glcontext->makeCurrent(d->m_offscreenSurface.get())) {
+        if (!d->m_glcontext->makeCurrent(d->m_offscreenSurface)) {
             // probably a context loss event, kwin is about to reset all the effects anyway
             return;
         }
@@ -247,6 +296,7 @@ void OffscreenQuickView::update()
                 qCWarning(LIBKWINEFFECTS, "Creating FBO for OffscreenQuickView failed!");
                 return;
             }
+            d->m_syncRequested = true;
         }
 
         QQuickRenderTarget renderTarget = QQuickRenderTarget::fromOpenGLTexture(d->m_fbo->texture(), d->m_fbo->size());
@@ -254,11 +304,17 @@ void OffscreenQuickView::update()
         d->m_view->setRenderTarget(renderTarget);
     }
 
-    d->m_renderControl->polishItems();
+    // Polishing and synchronizing walk the whole item tree, skip them if no item has changed
+    const bool sync = std::exchange(d->m_syncRequested, false);
+    if (sync) {
+        d->m_renderControl->polishItems();
+    }
     if (usingGl) {
         d->m_renderControl->beginFrame();
     }
-    d->m_renderControl->sync();
+    if (sync) {
+        d->m_renderControl->sync();
+    }
     d->m_renderControl->render();
     if (usingGl) {
         d->m_renderControl->endFrame();
@@ -515,12 +571,14 @@ void OffscreenQuickView::setGeometry(const QRect &rect)
 void OffscreenQuickView::Private::releaseResources()
 {
     if (m_glcontext) {
-        m_glcontext->makeCurrent(m_offscreenSurface.get());
+        m_glcontext->makeCurrent(m_offscreenSurface);
         m_view->releaseResources();
         m_glcontext->doneCurrent();
     } else {
         m_view->releaseResources();
     }
+    // The scene graph may have dropped nodes, it needs to be synchronized from scratch
+    m_syncRequested = true;
 }
 
 void OffscreenQuickView::Private::updateTouchState(Qt::TouchPointState state, qint32 id, const QPointF &pos)
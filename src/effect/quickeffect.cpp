@@ -10,11 +10,13 @@
 
 #include "logging_p.h"
 
+#include <QElapsedTimer>
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QQmlIncubator>
 #include <QQuickItem>
 #include <QQuickWindow>
+#include <QTimer>
 #include <qpa/qwindowsysteminterface.h>
 
 namespace KWin
@@ -22,6 +24,10 @@ namespace KWin
 
 static QHash<QQuickWindow *, QuickSceneView *> s_views;
 
+// How long to wait before the delegate is compiled in the background, so it doesn't compete
+// with the start up of the session
+static constexpr std::chrono::milliseconds s_preloadDelay(5000);
+
 class QuickSceneViewIncubator : public QQmlIncubator
 {
 public:
@@ -65,6 +71,8 @@ public:
         return effect->d.get();
     }
     bool isItemOnScreen(QQuickItem *item, LogicalOutput *screen) const;
+    bool loadDelegate(QuickSceneEffect *effect, QQmlComponent::CompilationMode mode);
+    void schedulePreload(QuickSceneEffect *effect);
 
     QPointer<QQmlComponent> delegate;
     QUrl source;
@@ -78,8 +86,62 @@ public:
     std::map<LogicalOutput *, std::unique_ptr<QuickSceneView>> views;
     QPointer<QuickSceneView> mouseImplicitGrab;
     bool running = false;
+    bool startPending = false;
+    QElapsedTimer activationTimer;
 };
 
+bool QuickSceneEffectPrivate::loadDelegate(QuickSceneEffect *effect, QQmlComponent::CompilationMode mode)
+{
+    delegate = new QQmlComponent(effects->qmlEngine(), effect);
+
+    if (mode == QQmlComponent::Asynchronous) {
+        QQmlComponent *component = delegate;
+        QObject::connect(component, &QQmlComponent::statusChanged, effect, [this, effect, component](QQmlComponent::Status status) {
+            if (status == QQmlComponent::Loading || delegate != component) {
+                return;
+            }
+            if (status == QQmlComponent::Error) {
+                qCWarning(LIBKWINEFFECTS) << "Failed to load" << (source.isEmpty() ? loadInfo.uri + u'.' + loadInfo.typeName : source.toString()) << component->errors();
+                delegate.clear();
+                component->deleteLater();
+            }
+            if (std::exchange(startPending, false)) {
+                effect->startInternal();
+            }
+        });
+    }
+
+    if (!source.isEmpty()) {
+        delegate->loadUrl(source, mode);
+        if (delegate->isError()) {
+            qWarning().nospace() << "Failed to load " << source << ": " << delegate->errors();
+            delegate.clear();
+            return false;
+        }
+    } else {
+        delegate->loadFromModule(loadInfo.uri, loadInfo.typeName, mode);
+        if (delegate->isError()) {
+            qWarning().nospace() << "Failed to load " << (loadInfo.uri + u'.' + loadInfo.typeName) << delegate->errors();
+            delegate.clear();
+            return false;
+        }
+    }
+
+    Q_EMIT effect->delegateChanged();
+    return true;
+}
+
+void QuickSceneEffectPrivate::schedulePreload(QuickSceneEffect *effect)
+{
+    // Compile the delegate ahead of time on the loader thread of the engine so the first
+    // activation of the effect doesn't have to wait for it
+    QTimer::singleShot(s_preloadDelay, effect, [this, effect]() {
+        if (!delegate && !running && (!source.isEmpty() || !loadInfo.uri.isEmpty())) {
+            loadDelegate(effect, QQmlComponent::Asynchronous);
+        }
+    });
+}
+
 bool QuickSceneEffectPrivate::isItemOnScreen(QQuickItem *item, LogicalOutput *screen) const
 {
     if (!item || !screen) {
@@ -232,6 +294,9 @@ bool QuickSceneEffect::isRunning() const
 
 void QuickSceneEffect::setRunning(bool running)
 {
+    if (!running) {
+        d->startPending = false;
+    }
     if (d->running != running) {
         if (running) {
             startInternal();
@@ -256,6 +321,7 @@ void QuickSceneEffect::setSource(const QUrl &url)
         d->source = url;
         d->delegate.clear();
         d->loadInfo = {};
+        d->schedulePreload(this);
     }
 }
 
@@ -275,6 +341,7 @@ void QuickSceneEffect::loadFromModule(const QString &uri, const QString &typeNam
         d->source = QUrl();
         d->loadInfo.uri = uri;
         d->loadInfo.typeName = typeName;
+        d->schedulePreload(this);
     }
 }
 
@@ -405,6 +472,11 @@ void QuickSceneEffect::paintScreen(const RenderTarget &renderTarget, const Rende
             screenView->update();
         }
         effects->renderOffscreenQuickView(renderTarget, viewport, screenView.get());
+
+        if (d->activationTimer.isValid()) {
+            qCDebug(LIBKWINEFFECTS) << metaObject()->className() << "painted its first frame" << d->activationTimer.elapsed() << "ms after activation";
+            d->activationTimer.invalidate();
+        }
     }
 }
 
@@ -487,25 +559,15 @@ void QuickSceneEffect::startInternal()
             return;
         }
 
-        d->delegate = new QQmlComponent(effects->qmlEngine(), this);
-
-        if (!d->source.isEmpty()) {
-            d->delegate->loadUrl(d->source);
-            if (d->delegate->isError()) {
-                qWarning().nospace() << "Failed to load " << d->source << ": " << d->delegate->errors();
-                d->delegate.clear();
-                return;
-            }
-        } else {
-            d->delegate->loadFromModule(d->loadInfo.uri, d->loadInfo.typeName);
-            if (d->delegate->isError()) {
-                qWarning().nospace() << "Failed to load " << (d->loadInfo.uri + u'.' + d->loadInfo.typeName) << d->delegate->errors();
-                d->delegate.clear();
-                return;
-            }
+        if (!d->loadDelegate(this, QQmlComponent::PreferSynchronous)) {
+            return;
         }
+    }
 
-        Q_EMIT delegateChanged();
+    if (d->delegate->isLoading()) {
+        // The delegate is still being compiled in the background, start once it's done
+        d->startPending = true;
+        return;
     }
 
     if (!d->delegate->isReady()) {
@@ -520,6 +582,7 @@ void QuickSceneEffect::startInternal()
 
     effects->setActiveFullScreenEffect(this);
     d->running = true;
+    d->activationTimer.start();
 
     // Install an event filter to monitor cursor shape changes.
     qApp->installEventFilter(this);
@@ -545,6 +608,7 @@ void QuickSceneEffect::stopInternal()
     d->views.clear();
     d->contexts.clear();
     d->running = false;
+    d->activationTimer.invalidate();
     qApp->removeEventFilter(this);
     effects->ungrabKeyboard();
     effects->stopMouseInterception(this);
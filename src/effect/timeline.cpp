@@ -21,6 +21,13 @@ public:
     bool done = false;
     RedirectMode sourceRedirectMode = RedirectMode::Relaxed;
     RedirectMode targetRedirectMode = RedirectMode::Strict;
+
+    // Evaluating the easing curve is not free and effects tend to ask for the value several
+    // times per frame, remember the last one along with the state it has been computed for
+    mutable std::optional<qreal> cachedValue;
+    mutable std::chrono::milliseconds cachedElapsed;
+    mutable std::chrono::milliseconds cachedDuration;
+    mutable Direction cachedDirection;
 };
 
 TimeLine::TimeLine(std::chrono::milliseconds duration, Direction direction)
@@ -45,9 +52,16 @@ qreal TimeLine::progress() const
 
 qreal TimeLine::value() const
 {
+    if (d->cachedValue && d->cachedElapsed == d->elapsed && d->cachedDuration == d->duration && d->cachedDirection == d->direction) {
+        return *d->cachedValue;
+    }
     const qreal t = progress();
-    return d->easingCurve.valueForProgress(
+    d->cachedValue = d->easingCurve.valueForProgress(
         d->direction == Backward ? 1.0 - t : t);
+    d->cachedElapsed = d->elapsed;
+    d->cachedDuration = d->duration;
+    d->cachedDirection = d->direction;
+    return *d->cachedValue;
 }
 
 void TimeLine::advance(std::chrono::milliseconds timestamp)
@@ -155,11 +169,13 @@ QEasingCurve TimeLine::easingCurve() const
 void TimeLine::setEasingCurve(const QEasingCurve &easingCurve)
 {
     d->easingCurve = easingCurve;
+    d->cachedValue.reset();
 }
 
 void TimeLine::setEasingCurve(QEasingCurve::Type type)
 {
     d->easingCurve.setType(type);
+    d->cachedValue.reset();
 }
 
 bool TimeLine::running() const
@@ -318,13 +318,13 @@ bool X11Window::windowEvent(xcb_generic_event_t *e)
     info->event(e, &dirtyProperties, &dirtyProperties2); // pass through the NET stuff
 
     if ((dirtyProperties & NET::WMName) != 0) {
-        fetchName();
+        schedulePropertyUpdate(NameUpdate);
     }
     if ((dirtyProperties & NET::WMIconName) != 0) {
-        fetchIconicName();
+        schedulePropertyUpdate(IconicNameUpdate);
     }
     if ((dirtyProperties & NET::WMIcon) != 0) {
-        getIcons();
+        schedulePropertyUpdate(IconUpdate);
     }
     if ((dirtyProperties2 & NET::WM2UserTime) != 0) {
         updateUserTime(info->userTime());
@@ -436,7 +436,9 @@ void X11Window::destroyNotifyEvent(xcb_destroy_notify_event_t *e)
 void X11Window::clientMessageEvent(xcb_client_message_event_t *e)
 {
     if (e->type == atoms->wl_surface_serial) {
-        m_surfaceSerial = (uint64_t(e->data.data32[1]) << 32) | e->data.data32[0];
+        const quint64 serial = (uint64_t(e->data.data32[1]) << 32) | e->data.data32[0];
+        workspace()->setX11WindowSurfaceSerial(this, serial);
+        m_surfaceSerial = serial;
         if (XwaylandSurfaceV1Interface *xwaylandSurface = waylandServer()->xwaylandShell()->findSurface(m_surfaceSerial)) {
             associate(xwaylandSurface);
         }
@@ -521,16 +523,16 @@ void X11Window::propertyNotifyEvent(xcb_property_notify_event_t *e)
         getWmNormalHints();
         break;
     case XCB_ATOM_WM_NAME:
-        fetchName();
+        schedulePropertyUpdate(NameUpdate);
         break;
     case XCB_ATOM_WM_ICON_NAME:
-        fetchIconicName();
+        schedulePropertyUpdate(IconicNameUpdate);
         break;
     case XCB_ATOM_WM_TRANSIENT_FOR:
         readTransient();
         break;
     case XCB_ATOM_WM_HINTS:
-        getIcons(); // because KWin::icon() uses WMHints as fallback
+        schedulePropertyUpdate(IconUpdate); // because KWin::icon() uses WMHints as fallback
         break;
     default:
         if (e->atom == atoms->motif_wm_hints) {
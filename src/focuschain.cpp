@@ -21,11 +21,22 @@ void FocusChain::remove(Window *window)
         it.value().removeAll(window);
     }
     m_mostRecentlyUsed.removeAll(window);
+
+    if (auto it = m_windowOutputs.find(window); it != m_windowOutputs.end()) {
+        disconnect(window, &Window::outputChanged, this, nullptr);
+        for (auto &outputChains : m_outputFocusChains) {
+            if (auto chainIt = outputChains.find(it.value()); chainIt != outputChains.end()) {
+                chainIt->removeOne(window);
+            }
+        }
+        m_windowOutputs.erase(it);
+    }
 }
 
 void FocusChain::addDesktop(VirtualDesktop *desktop)
 {
     m_desktopFocusChains.insert(desktop, Chain());
+    m_outputFocusChains.insert(desktop, QHash<LogicalOutput *, Chain>());
 }
 
 void FocusChain::removeDesktop(VirtualDesktop *desktop)
@@ -34,6 +45,7 @@ void FocusChain::removeDesktop(VirtualDesktop *desktop)
         m_currentDesktop = nullptr;
     }
     m_desktopFocusChains.remove(desktop);
+    m_outputFocusChains.remove(desktop);
 }
 
 Window *FocusChain::getForActivation(VirtualDesktop *desktop) const
@@ -43,16 +55,29 @@ Window *FocusChain::getForActivation(VirtualDesktop *desktop) const
 
 Window *FocusChain::getForActivation(VirtualDesktop *desktop, LogicalOutput *output) const
 {
-    auto it = m_desktopFocusChains.constFind(desktop);
-    if (it == m_desktopFocusChains.constEnd()) {
-        return nullptr;
+    const Chain *chain = nullptr;
+    if (m_separateScreenFocus) {
+        // Only windows on the output can be activated, so only its part of the chain is searched
+        auto it = m_outputFocusChains.constFind(desktop);
+        if (it == m_outputFocusChains.constEnd()) {
+            return nullptr;
+        }
+        auto outputIt = it->constFind(output);
+        if (outputIt == it->constEnd()) {
+            return nullptr;
+        }
+        chain = &outputIt.value();
+    } else {
+        auto it = m_desktopFocusChains.constFind(desktop);
+        if (it == m_desktopFocusChains.constEnd()) {
+            return nullptr;
+        }
+        chain = &it.value();
     }
-    const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto tmp = chain.at(i);
+    for (int i = chain->size() - 1; i >= 0; --i) {
+        auto tmp = chain->at(i);
         // TODO: move the check into Window
-        if (tmp->isShown() && tmp->isOnCurrentActivity()
-            && (!m_separateScreenFocus || tmp->output() == output)) {
+        if (tmp->isShown() && tmp->isOnCurrentActivity()) {
             return tmp;
         }
     }
@@ -101,6 +126,7 @@ void FocusChain::update(Window *window, FocusChain::Change change)
 
     // add for most recently used chain
     updateWindowInChain(window, change, m_mostRecentlyUsed);
+    updateOutputChains(window);
 }
 
 void FocusChain::updateWindowInChain(Window *window, FocusChain::Change change, Chain &chain)
@@ -152,6 +178,7 @@ void FocusChain::moveAfterWindow(Window *window, Window *reference)
         moveAfterWindowInChain(window, reference, it.value());
     }
     moveAfterWindowInChain(window, reference, m_mostRecentlyUsed);
+    updateOutputChains(window);
 }
 
 void FocusChain::moveBeforeWindow(Window *window, Window *reference)
@@ -175,6 +202,50 @@ void FocusChain::moveBeforeWindow(Window *window, Window *reference)
         moveBeforeWindowInChain(window, reference, it.value());
     }
     moveBeforeWindowInChain(window, reference, m_mostRecentlyUsed);
+    updateOutputChains(window);
+}
+
+void FocusChain::updateOutputChains(Window *window)
+{
+    if (window->isDeleted()) {
+        return;
+    }
+    auto it = m_windowOutputs.find(window);
+    if (it == m_windowOutputs.end()) {
+        connect(window, &Window::outputChanged, this, [this, window]() {
+            updateOutputChains(window);
+        });
+        it = m_windowOutputs.insert(window, window->output());
+    } else {
+        for (auto &outputChains : m_outputFocusChains) {
+            if (auto chainIt = outputChains.find(it.value()); chainIt != outputChains.end()) {
+                chainIt->removeOne(window);
+            }
+        }
+        it.value() = window->output();
+    }
+
+    LogicalOutput *output = it.value();
+    for (auto desktopIt = m_desktopFocusChains.cbegin(); desktopIt != m_desktopFocusChains.cend(); ++desktopIt) {
+        const Chain &chain = desktopIt.value();
+        const int index = chain.indexOf(window);
+        if (index == -1) {
+            continue;
+        }
+        Chain &outputChain = m_outputFocusChains[desktopIt.key()][output];
+        // Put it in front of the next window in the desktop chain that is on the same output
+        qsizetype position = outputChain.size();
+        for (int i = index + 1; i < chain.size(); ++i) {
+            if (m_windowOutputs.value(chain.at(i)) != output) {
+                continue;
+            }
+            if (const qsizetype next = outputChain.indexOf(chain.at(i)); next != -1) {
+                position = next;
+                break;
+            }
+        }
+        outputChain.insert(position, window);
+    }
 }
 
 void FocusChain::moveAfterWindowInChain(Window *window, Window *reference, Chain &chain)
@@ -247,7 +318,12 @@ Window *FocusChain::nextMostRecentlyUsed(Window *reference) const
 // copied from activation.cpp
 bool FocusChain::isUsableFocusCandidate(Window *c, Window *prev) const
 {
-    return c != prev && c->isShown() && c->isOnCurrentDesktop() && c->isOnCurrentActivity() && (!m_separateScreenFocus || c->isOnOutput(prev ? prev->output() : workspace()->activeOutput()));
+    return isUsableFocusCandidate(c, prev, m_separateScreenFocus ? (prev ? prev->output() : workspace()->activeOutput()) : nullptr);
+}
+
+bool FocusChain::isUsableFocusCandidate(Window *c, Window *prev, LogicalOutput *output) const
+{
+    return c != prev && c->isShown() && c->isOnCurrentDesktop() && (!output || c->isOnOutput(output)) && c->isOnCurrentActivity();
 }
 
 Window *FocusChain::nextForDesktop(Window *reference, VirtualDesktop *desktop) const
@@ -256,10 +332,12 @@ Window *FocusChain::nextForDesktop(Window *reference, VirtualDesktop *desktop) c
     if (it == m_desktopFocusChains.constEnd()) {
         return nullptr;
     }
+    // Look up the output only once rather than for every window in the chain
+    LogicalOutput *output = m_separateScreenFocus ? (reference ? reference->output() : workspace()->activeOutput()) : nullptr;
     const auto &chain = it.value();
     for (int i = chain.size() - 1; i >= 0; --i) {
         auto window = chain.at(i);
-        if (isUsableFocusCandidate(window, reference)) {
+        if (isUsableFocusCandidate(window, reference, output)) {
             return window;
         }
     }
@@ -31,7 +31,9 @@ class VirtualDesktop;
  * last item of the list, that is a LIFO like structure.
  *
  * In addition there is one chain for each virtual desktop which is used to determine which Window
- * should get activated when the user switches to another virtual desktop.
+ * should get activated when the user switches to another virtual desktop. Each of these chains is
+ * also kept split up by output, so that separate screen focus does not need to filter the whole
+ * chain.
  *
  * Furthermore this class contains various helper methods for the two different kind of chains.
  */
@@ -182,6 +184,7 @@ public Q_SLOTS:
 
 private:
     using Chain = QList<Window *>;
+    bool isUsableFocusCandidate(Window *window, Window *prev, LogicalOutput *output) const;
     /**
      * @brief Makes @p window the first Window in the given focus @p chain.
      *
@@ -208,8 +211,24 @@ private:
     void moveBeforeWindowInChain(Window *window, Window *reference, Chain &chain);
     void updateWindowInChain(Window *window, Change change, Chain &chain);
     void insertWindowIntoChain(Window *window, Chain &chain);
+    /**
+     * @brief Moves @p window to the per output focus chains of its current output.
+     *
+     * The position of @p window in the per output chain of every virtual desktop follows its
+     * position in the focus chain of that desktop, so it has to be called whenever @p window
+     * is moved in a desktop chain or moved to another output.
+     *
+     * @param window The Window whose per output chains should be updated
+     * @return void
+     */
+    void updateOutputChains(Window *window);
     Chain m_mostRecentlyUsed;
     QHash<VirtualDesktop *, Chain> m_desktopFocusChains;
+    /**
+     * The windows of every per desktop focus chain split up by their output, in the same order.
+     */
+    QHash<VirtualDesktop *, QHash<LogicalOutput *, Chain>> m_outputFocusChains;
+    QHash<Window *, LogicalOutput *> m_windowOutputs;
     bool m_separateScreenFocus = false;
     Window *m_activeWindow = nullptr;
     VirtualDesktop *m_currentDesktop = nullptr;
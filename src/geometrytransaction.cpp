@@ -0,0 +1,110 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "geometrytransaction.h"
+#include "core/backendoutput.h"
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "window.h"
+
+using namespace std::chrono_literals;
+
+namespace KWin
+{
+
+GeometryTransaction::GeometryTransaction(QObject *parent)
+    : QObject(parent)
+{
+    m_timeout.setSingleShot(true);
+    m_timeout.setInterval(100ms);
+    connect(&m_timeout, &QTimer::timeout, this, &GeometryTransaction::finish);
+}
+
+GeometryTransaction::~GeometryTransaction()
+{
+    for (RenderLoop *renderLoop : std::as_const(m_inhibitedRenderLoops)) {
+        if (renderLoop) {
+            renderLoop->uninhibit();
+        }
+    }
+}
+
+void GeometryTransaction::add(Window *window)
+{
+    // Interactive resizes are paced by the client already, holding back frames would only
+    // make the cursor stutter
+    if (m_committed || window->isInteractiveMoveResize() || m_windows.contains(window)) {
+        return;
+    }
+    m_windows.insert(window);
+
+    connect(window, &Window::geometryUpdateApplied, this, &GeometryTransaction::tryFinish);
+    connect(window, &Window::closed, this, [this, window]() {
+        m_windows.remove(window);
+        tryFinish();
+    });
+}
+
+void GeometryTransaction::commit()
+{
+    Q_ASSERT(!m_committed);
+    m_committed = true;
+
+    QSet<RenderLoop *> renderLoops;
+    for (Window *window : std::as_const(m_windows)) {
+        // The window may be leaving one output for another
+        for (LogicalOutput *output : {window->output(), window->moveResizeOutput()}) {
+            if (output) {
+                renderLoops.insert(output->backendOutput()->renderLoop());
+            }
+        }
+    }
+    for (RenderLoop *renderLoop : std::as_const(renderLoops)) {
+        renderLoop->inhibit();
+        m_inhibitedRenderLoops.append(renderLoop);
+    }
+
+    m_timeout.start();
+    tryFinish();
+}
+
+void GeometryTransaction::tryFinish()
+{
+    if (!m_committed) {
+        return;
+    }
+    for (Window *window : std::as_const(m_windows)) {
+        if (window->isWaitingForGeometryUpdate()) {
+            return;
+        }
+    }
+    finish();
+}
+
+void GeometryTransaction::finish()
+{
+    m_timeout.stop();
+    for (Window *window : std::as_const(m_windows)) {
+        disconnect(window, nullptr, this, nullptr);
+    }
+    m_windows.clear();
+
+    for (RenderLoop *renderLoop : std::as_const(m_inhibitedRenderLoops)) {
+        if (renderLoop) {
+            renderLoop->uninhibit();
+        }
+    }
+    m_inhibitedRenderLoops.clear();
+
+    deleteLater();
+}
+
+} // namespace KWin
+
+#include "moc_geometrytransaction.cpp"
@@ -0,0 +1,57 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+
+namespace KWin
+{
+
+class RenderLoop;
+class Window;
+
+/**
+ * The GeometryTransaction class presents the new geometry of several windows together.
+ *
+ * Windows that are moved or resized while a transaction is open are added to it. Once the
+ * transaction is committed, the outputs that show these windows stop repainting until every
+ * window has applied its new geometry, or until a timeout if some client is too slow to
+ * respond. So re-tiling a bunch of windows appears in one frame rather than as a cascade of
+ * windows resizing one after another.
+ *
+ * A committed transaction deletes itself when it's finished.
+ */
+class KWIN_EXPORT GeometryTransaction : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GeometryTransaction(QObject *parent = nullptr);
+    ~GeometryTransaction() override;
+
+    void add(Window *window);
+    void commit();
+
+private:
+    void tryFinish();
+    void finish();
+
+    QSet<Window *> m_windows;
+    QList<QPointer<RenderLoop>> m_inhibitedRenderLoops;
+    QTimer m_timeout;
+    bool m_committed = false;
+};
+
+} // namespace KWin
@@ -74,10 +74,10 @@ GestureRecognizer::~GestureRecognizer() = default;
 
 void GestureRecognizer::registerSwipeGesture(KWin::SwipeGesture *gesture)
 {
-    Q_ASSERT(!m_swipeGestures.contains(gesture));
+    Q_ASSERT(!m_swipeGestures.value(gesture->fingerCount()).contains(gesture));
     auto connection = connect(gesture, &QObject::destroyed, this, std::bind(&GestureRecognizer::unregisterSwipeGesture, this, gesture));
     m_destroyConnections.insert(gesture, connection);
-    m_swipeGestures << gesture;
+    m_swipeGestures[gesture->fingerCount()] << gesture;
 }
 
 void GestureRecognizer::unregisterSwipeGesture(KWin::SwipeGesture *gesture)
@@ -87,7 +87,12 @@ void GestureRecognizer::unregisterSwipeGesture(KWin::SwipeGesture *gesture)
         disconnect(it.value());
         m_destroyConnections.erase(it);
     }
-    m_swipeGestures.removeAll(gesture);
+    if (auto it = m_swipeGestures.find(gesture->fingerCount()); it != m_swipeGestures.end()) {
+        it->removeAll(gesture);
+        if (it->isEmpty()) {
+            m_swipeGestures.erase(it);
+        }
+    }
     if (m_activeSwipeGestures.removeOne(gesture)) {
         Q_EMIT gesture->cancelled();
     }
@@ -95,10 +100,10 @@ void GestureRecognizer::unregisterSwipeGesture(KWin::SwipeGesture *gesture)
 
 void GestureRecognizer::registerPinchGesture(KWin::PinchGesture *gesture)
 {
-    Q_ASSERT(!m_pinchGestures.contains(gesture));
+    Q_ASSERT(!m_pinchGestures.value(gesture->fingerCount()).contains(gesture));
     auto connection = connect(gesture, &QObject::destroyed, this, std::bind(&GestureRecognizer::unregisterPinchGesture, this, gesture));
     m_destroyConnections.insert(gesture, connection);
-    m_pinchGestures << gesture;
+    m_pinchGestures[gesture->fingerCount()] << gesture;
 }
 
 void GestureRecognizer::unregisterPinchGesture(KWin::PinchGesture *gesture)
@@ -108,7 +113,12 @@ void GestureRecognizer::unregisterPinchGesture(KWin::PinchGesture *gesture)
         disconnect(it.value());
         m_destroyConnections.erase(it);
     }
-    m_pinchGestures.removeAll(gesture);
+    if (auto it = m_pinchGestures.find(gesture->fingerCount()); it != m_pinchGestures.end()) {
+        it->removeAll(gesture);
+        if (it->isEmpty()) {
+            m_pinchGestures.erase(it);
+        }
+    }
     if (m_activePinchGestures.removeOne(gesture)) {
         Q_EMIT gesture->cancelled();
     }
@@ -120,12 +130,12 @@ int GestureRecognizer::startSwipeGesture(uint fingerCount, const QPointF &startP
     if (!m_activeSwipeGestures.isEmpty() || !m_activePinchGestures.isEmpty()) {
         return 0;
     }
+    const auto candidates = m_swipeGestures.find(fingerCount);
+    if (candidates == m_swipeGestures.end()) {
+        return 0;
+    }
     int count = 0;
-    for (SwipeGesture *gesture : std::as_const(m_swipeGestures)) {
-        if (gesture->fingerCount() != fingerCount) {
-            continue;
-        }
-
+    for (SwipeGesture *gesture : std::as_const(*candidates)) {
         // Only add gestures who's direction aligns with current swipe axis
         switch (gesture->direction()) {
         case SwipeDirection::Up:
@@ -188,23 +198,27 @@ void GestureRecognizer::updateSwipeGesture(const QPointF &delta)
         Q_UNREACHABLE();
     }
 
-    // Eliminate wrong gestures (takes two iterations)
-    for (int i = 0; i < 2; i++) {
+    // Eliminate wrong gestures (takes two iterations). The gestures that are left match the
+    // direction until it changes
+    if (m_lastSwipeDirection != direction) {
+        m_lastSwipeDirection = direction;
+        for (int i = 0; i < 2; i++) {
 
-        if (m_activeSwipeGestures.isEmpty()) {
-            startSwipeGesture(m_currentFingerCount);
-        }
+            if (m_activeSwipeGestures.isEmpty()) {
+                startSwipeGesture(m_currentFingerCount);
+            }
 
-        for (auto it = m_activeSwipeGestures.begin(); it != m_activeSwipeGestures.end();) {
-            auto g = static_cast<SwipeGesture *>(*it);
+            for (auto it = m_activeSwipeGestures.begin(); it != m_activeSwipeGestures.end();) {
+                auto g = static_cast<SwipeGesture *>(*it);
 
-            if (g->direction() != direction) {
-                Q_EMIT g->cancelled();
-                it = m_activeSwipeGestures.erase(it);
-                continue;
-            }
+                if (g->direction() != direction) {
+                    Q_EMIT g->cancelled();
+                    it = m_activeSwipeGestures.erase(it);
+                    continue;
+                }
 
-            it++;
+                it++;
+            }
         }
     }
 
@@ -228,6 +242,8 @@ void GestureRecognizer::cancelActiveGestures()
     m_currentScale = 0;
     m_currentDelta = QPointF(0, 0);
     m_currentSwipeAxis = Axis::None;
+    m_lastSwipeDirection.reset();
+    m_lastPinchDirection.reset();
 }
 
 void GestureRecognizer::cancelSwipeGesture()
@@ -252,6 +268,7 @@ void GestureRecognizer::endSwipeGesture()
     m_currentFingerCount = 0;
     m_currentDelta = QPointF(0, 0);
     m_currentSwipeAxis = Axis::None;
+    m_lastSwipeDirection.reset();
 }
 
 int GestureRecognizer::startPinchGesture(uint fingerCount)
@@ -261,11 +278,11 @@ int GestureRecognizer::startPinchGesture(uint fingerCount)
     if (!m_activeSwipeGestures.isEmpty() || !m_activePinchGestures.isEmpty()) {
         return 0;
     }
-    for (PinchGesture *gesture : std::as_const(m_pinchGestures)) {
-        if (gesture->fingerCount() != fingerCount) {
-            continue;
-        }
-
+    const auto candidates = m_pinchGestures.find(fingerCount);
+    if (candidates == m_pinchGestures.end()) {
+        return 0;
+    }
+    for (PinchGesture *gesture : std::as_const(*candidates)) {
         // direction doesn't matter yet
         m_activePinchGestures << gesture;
         count++;
@@ -287,20 +304,23 @@ void GestureRecognizer::updatePinchGesture(qreal scale, qreal angleDelta, const
     }
 
     // Eliminate wrong gestures (takes two iterations)
-    for (int i = 0; i < 2; i++) {
-        if (m_activePinchGestures.isEmpty()) {
-            startPinchGesture(m_currentFingerCount);
-        }
+    if (m_lastPinchDirection != direction) {
+        m_lastPinchDirection = direction;
+        for (int i = 0; i < 2; i++) {
+            if (m_activePinchGestures.isEmpty()) {
+                startPinchGesture(m_currentFingerCount);
+            }
 
-        for (auto it = m_activePinchGestures.begin(); it != m_activePinchGestures.end();) {
-            auto g = static_cast<PinchGesture *>(*it);
+            for (auto it = m_activePinchGestures.begin(); it != m_activePinchGestures.end();) {
+                auto g = static_cast<PinchGesture *>(*it);
 
-            if (g->direction() != direction) {
-                Q_EMIT g->cancelled();
-                it = m_activePinchGestures.erase(it);
-                continue;
+                if (g->direction() != direction) {
+                    Q_EMIT g->cancelled();
+                    it = m_activePinchGestures.erase(it);
+                    continue;
+                }
+                it++;
             }
-            it++;
         }
     }
 
@@ -331,6 +351,7 @@ void GestureRecognizer::endPinchGesture() // because fingers up
     m_currentScale = 1;
     m_currentFingerCount = 0;
     m_currentSwipeAxis = Axis::None;
+    m_lastPinchDirection.reset();
 }
 
 uint32_t SwipeGesture::fingerCount() const
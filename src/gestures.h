@@ -11,11 +11,14 @@
 #include "effect/globals.h"
 #include <kwin_export.h>
 
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QObject>
 #include <QPointF>
 
+#include <optional>
+
 namespace KWin
 {
 
@@ -142,8 +145,9 @@ private:
         None,
     };
     int startSwipeGesture(uint fingerCount, const QPointF &startPos);
-    QList<SwipeGesture *> m_swipeGestures;
-    QList<PinchGesture *> m_pinchGestures;
+    // by finger count, so that starting a gesture only looks at the candidates
+    QHash<uint32_t, QList<SwipeGesture *>> m_swipeGestures;
+    QHash<uint32_t, QList<PinchGesture *>> m_pinchGestures;
     QList<SwipeGesture *> m_activeSwipeGestures;
     QList<PinchGesture *> m_activePinchGestures;
     QMap<Gesture *, QMetaObject::Connection> m_destroyConnections;
@@ -152,6 +156,9 @@ private:
     qreal m_currentScale = 1; // For Pinch Gesture recognition
     uint m_currentFingerCount = 0;
     Axis m_currentSwipeAxis = Axis::None;
+    // the active gestures only need to be sorted out again when the direction changes
+    std::optional<SwipeDirection> m_lastSwipeDirection;
+    std::optional<PinchDirection> m_lastPinchDirection;
 };
 
 }
@@ -116,6 +116,26 @@ void GlobalShortcutsManager::objectDeleted(QObject *object)
             ++it;
         }
     }
+    rebuildLookupTables();
+}
+
+static quint64 lookupKey(Qt::KeyboardModifiers modifiers, quint32 value)
+{
+    return (quint64(modifiers.toInt()) << 32) | value;
+}
+
+void GlobalShortcutsManager::rebuildLookupTables()
+{
+    m_pointerButtonShortcuts.clear();
+    m_pointerAxisShortcuts.clear();
+    // walk backwards, so that the shortcut registered first wins if there are several
+    for (auto it = m_shortcuts.rbegin(); it != m_shortcuts.rend(); ++it) {
+        if (const auto button = std::get_if<PointerButtonShortcut>(&it->shortcut())) {
+            m_pointerButtonShortcuts.insert(lookupKey(button->pointerModifiers, button->pointerButtons.toInt()), &*it);
+        } else if (const auto axis = std::get_if<PointerAxisShortcut>(&it->shortcut())) {
+            m_pointerAxisShortcuts.insert(lookupKey(axis->axisModifiers, quint32(axis->axisDirection)), &*it);
+        }
+    }
 }
 
 bool GlobalShortcutsManager::add(GlobalShortcut sc, DeviceType device)
@@ -128,6 +148,7 @@ bool GlobalShortcutsManager::add(GlobalShortcut sc, DeviceType device)
     }
     connect(sc.action(), &QAction::destroyed, this, &GlobalShortcutsManager::objectDeleted);
     m_shortcuts.push_back(std::move(sc));
+    rebuildLookupTables();
     return true;
 }
 
@@ -183,6 +204,7 @@ void GlobalShortcutsManager::forceRegisterTouchscreenSwipe(SwipeDirection direct
     m_touchscreenGestureRecognizer->registerSwipeGesture(shortcut.swipeGesture());
     connect(shortcut.action(), &QAction::destroyed, this, &GlobalShortcutsManager::objectDeleted);
     m_shortcuts.push_back(std::move(shortcut));
+    rebuildLookupTables();
 }
 
 bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, int keyQt, KeyboardKeyState state)
@@ -222,20 +244,6 @@ bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, int keyQt, K
     return false;
 }
 
-template<typename ShortcutKind, typename... Args>
-GlobalShortcut *match(QList<GlobalShortcut> &shortcuts, Args... args)
-{
-    for (auto &sc : shortcuts) {
-        if (std::holds_alternative<ShortcutKind>(sc.shortcut())) {
-            if (std::get<ShortcutKind>(sc.shortcut()) == ShortcutKind{args...}) {
-                return &sc;
-            }
-        }
-    }
-    return nullptr;
-}
-
-// TODO(C++20): use ranges for a nicer way of filtering by shortcut type
 bool GlobalShortcutsManager::processPointerPressed(Qt::KeyboardModifiers mods, Qt::MouseButtons pointerButtons)
 {
 #if KWIN_BUILD_GLOBALSHORTCUTS
@@ -248,7 +256,7 @@ bool GlobalShortcutsManager::processPointerPressed(Qt::KeyboardModifiers mods, Q
                                   Q_ARG(Qt::MouseButtons, pointerButtons));
     }
 #endif
-    GlobalShortcut *shortcut = match<PointerButtonShortcut>(m_shortcuts, mods, pointerButtons);
+    GlobalShortcut *shortcut = m_pointerButtonShortcuts.value(lookupKey(mods, pointerButtons.toInt()));
     if (shortcut) {
         shortcut->invoke();
     }
@@ -267,7 +275,7 @@ bool GlobalShortcutsManager::processAxis(Qt::KeyboardModifiers mods, PointerAxis
                                   Q_ARG(int, axis));
     }
 #endif
-    GlobalShortcut *shortcut = match<PointerAxisShortcut>(m_shortcuts, mods, axis);
+    GlobalShortcut *shortcut = m_pointerAxisShortcuts.value(lookupKey(mods, quint32(axis)));
     if (shortcut && std::abs(delta) >= 1.0f) {
         shortcut->invoke();
     }
@@ -12,6 +12,7 @@
 // Qt
 #include "core/inputdevice.h"
 
+#include <QHash>
 #include <QKeySequence>
 
 #include <memory>
@@ -114,8 +115,13 @@ public:
 private:
     void objectDeleted(QObject *object);
     bool add(GlobalShortcut sc, DeviceType device = DeviceType::Touchpad);
+    void rebuildLookupTables();
 
     QList<GlobalShortcut> m_shortcuts;
+    // the first pointer button and axis shortcut for every combination of modifiers and
+    // buttons or axis, pointing into m_shortcuts
+    QHash<quint64, GlobalShortcut *> m_pointerButtonShortcuts;
+    QHash<quint64, GlobalShortcut *> m_pointerAxisShortcuts;
 
 #if KWIN_BUILD_GLOBALSHORTCUTS
     std::unique_ptr<KGlobalAccelD> m_kglobalAccel;
@@ -0,0 +1,231 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "backends/virtual/virtual_backend.h"
+#include "core/renderviewport.h"
+#include "effect/effect.h"
+#include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "opengl/glframebuffer.h"
+#include "opengl/glrendertimequery.h"
+#include "opengl/gltexture.h"
+#include "scene/imageitem.h"
+#include "scene/itemrenderer_opengl.h"
+#include "scene/scenecapture.h"
+
+#include <QCommandLineParser>
+#include <QGuiApplication>
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+static double toMilliseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static std::chrono::nanoseconds percentile(std::vector<std::chrono::nanoseconds> samples, double rank)
+{
+    if (samples.empty()) {
+        return 0ns;
+    }
+    std::ranges::sort(samples);
+    const size_t index = std::min<size_t>(samples.size() - 1, samples.size() * rank / 100);
+    return samples[index];
+}
+
+/**
+ * Rebuilds the captured item trees frame by frame. The items are kept across frames, so that
+ * the renderer sees the same kind of updates as in the compositor. The contents of the
+ * textures aren't captured, textured items get a solid color of the same size and alpha.
+ */
+class ReplayScene
+{
+public:
+    explicit ReplayScene(ItemRenderer *renderer)
+        : m_renderer(renderer)
+        , m_root(std::make_unique<Item>())
+    {
+    }
+
+    Item *root() const
+    {
+        return m_root.get();
+    }
+
+    void update(const SceneCaptureFrame &frame)
+    {
+        std::unordered_map<quint32, std::unique_ptr<Item>> previous = std::move(m_items);
+        m_items.clear();
+        for (const SceneCaptureItem &captured : frame.items) {
+            Item *parent = m_root.get();
+            if (captured.parentId) {
+                const auto parentIt = m_items.find(captured.parentId);
+                if (parentIt == m_items.end()) {
+                    continue;
+                }
+                parent = parentIt->second.get();
+            }
+
+            std::unique_ptr<Item> item;
+            if (auto it = previous.find(captured.id); it != previous.end()) {
+                item = std::move(it->second);
+                previous.erase(it);
+                if (item->parentItem() != parent) {
+                    item->setParentItem(parent);
+                }
+            } else if (captured.textureSize.isEmpty()) {
+                item = std::make_unique<Item>(parent);
+            } else {
+                item = m_renderer->createImageItem(parent);
+            }
+
+            if (auto imageItem = qobject_cast<ImageItem *>(item.get())) {
+                if (imageItem->image().size() != captured.textureSize || imageItem->image().hasAlphaChannel() != captured.textureHasAlpha) {
+                    QImage image(captured.textureSize, captured.textureHasAlpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+                    image.fill(QColor::fromHsv((captured.id * 47) % 360, 160, 220, captured.textureHasAlpha ? 200 : 255));
+                    imageItem->setImage(image);
+                }
+            }
+            item->setPosition(captured.position);
+            item->setSize(captured.size);
+            item->setTransform(captured.transform);
+            item->setOpacity(captured.opacity);
+            item->setZ(captured.z);
+            item->setVisible(captured.visible);
+            m_items[captured.id] = std::move(item);
+        }
+        destroyItems(previous);
+    }
+
+    ~ReplayScene()
+    {
+        destroyItems(m_items);
+    }
+
+private:
+    static void destroyItems(std::unordered_map<quint32, std::unique_ptr<Item>> &items)
+    {
+        // items don't own their children, so the children have to go first
+        while (!items.empty()) {
+            std::erase_if(items, [](const auto &entry) {
+                return entry.second->childItems().isEmpty();
+            });
+        }
+    }
+
+    ItemRenderer *m_renderer;
+    std::unique_ptr<Item> m_root;
+    std::unordered_map<quint32, std::unique_ptr<Item>> m_items;
+};
+
+int main(int argc, char **argv)
+{
+    QGuiApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("offscreen"));
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replays a scene captured with org.kde.kwin.Compositing.captureScene"));
+    parser.addHelpOption();
+    const QCommandLineOption fullRepaintOption(QStringLiteral("full-repaint"), QStringLiteral("Repaint every frame entirely instead of only the captured damage"));
+    const QCommandLineOption loopOption(QStringLiteral("loops"), QStringLiteral("How many times the capture is replayed"), QStringLiteral("count"), QStringLiteral("1"));
+    parser.addOption(fullRepaintOption);
+    parser.addOption(loopOption);
+    parser.addPositionalArgument(QStringLiteral("file"), QStringLiteral("The capture to replay"));
+    parser.process(app);
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+    const QString fileName = parser.positionalArguments().constFirst();
+    const bool fullRepaint = parser.isSet(fullRepaintOption);
+    const int loops = std::max(1, parser.value(loopOption).toInt());
+
+    VirtualBackend backend;
+    if (!backend.initialize()) {
+        std::cerr << "Failed to initialize the virtual backend" << std::endl;
+        return 1;
+    }
+    std::unique_ptr<EglBackend> renderBackend = backend.createOpenGLBackend();
+    renderBackend->init();
+    if (renderBackend->isFailed() || !renderBackend->openglContext()->makeCurrent()) {
+        std::cerr << "Failed to create an OpenGL context" << std::endl;
+        return 1;
+    }
+
+    ItemRendererOpenGL renderer(renderBackend->eglDisplayObject());
+    ReplayScene scene(&renderer);
+    std::unique_ptr<GLTexture> texture;
+    std::unique_ptr<GLFramebuffer> framebuffer;
+
+    std::vector<std::chrono::nanoseconds> cpuTimes;
+    std::vector<std::chrono::nanoseconds> gpuTimes;
+    int frameCount = 0;
+    for (int loop = 0; loop < loops; ++loop) {
+        SceneCaptureReader reader;
+        if (!reader.open(fileName)) {
+            std::cerr << "Failed to open " << qPrintable(fileName) << std::endl;
+            return 1;
+        }
+        while (const auto frame = reader.readFrame()) {
+            const QSize size = (frame->viewport.size() * frame->scale).toSize();
+            if (size.isEmpty()) {
+                continue;
+            }
+            bool repaintAll = fullRepaint;
+            if (!texture || texture->size() != size) {
+                framebuffer.reset();
+                texture = GLTexture::allocate(GL_RGBA8, size);
+                if (!texture) {
+                    std::cerr << "Failed to allocate the render target" << std::endl;
+                    return 1;
+                }
+                framebuffer = std::make_unique<GLFramebuffer>(texture.get());
+                repaintAll = true;
+            }
+
+            scene.update(*frame);
+            QRegion damage;
+            for (const SceneCaptureItem &item : frame->items) {
+                damage += item.damage;
+            }
+            if (repaintAll) {
+                damage = QRect(QPoint(), size);
+            }
+
+            const RenderTarget renderTarget(framebuffer.get());
+            const RenderViewport viewport(frame->viewport, frame->scale, renderTarget);
+            GLRenderTimeQuery query(renderBackend->openglContextRef());
+            query.begin();
+            const auto cpuStart = std::chrono::steady_clock::now();
+            renderer.beginFrame(renderTarget, viewport);
+            renderer.renderBackground(renderTarget, viewport, damage);
+            renderer.renderItem(renderTarget, viewport, scene.root(), 0, damage, WindowPaintData{}, {}, {});
+            renderer.endFrame();
+            cpuTimes.push_back(std::chrono::steady_clock::now() - cpuStart);
+            query.end();
+            // waits for the gpu to finish the frame
+            if (query.query()) {
+                if (const auto gpuTime = query.gpuTime()) {
+                    gpuTimes.push_back(*gpuTime);
+                }
+            }
+            frameCount++;
+        }
+    }
+
+    std::cout << "frames: " << frameCount << '\n';
+    std::cout << "cpu time: p50 " << toMilliseconds(percentile(cpuTimes, 50)) << "ms, p95 " << toMilliseconds(percentile(cpuTimes, 95)) << "ms\n";
+    std::cout << "gpu time: p50 " << toMilliseconds(percentile(gpuTimes, 50)) << "ms, p95 " << toMilliseconds(percentile(gpuTimes, 95)) << "ms\n";
+    return 0;
+}
@@ -15,10 +15,10 @@ namespace KWin
 IdleDetector::IdleDetector(std::chrono::milliseconds timeout, OperatingMode mode, QObject *parent)
     : QObject(parent)
     , m_timeout(timeout)
+    , m_start(std::chrono::steady_clock::now())
     , m_mode(mode)
 {
     Q_ASSERT(timeout >= 0ms);
-    m_timer.start(timeout, this);
 
     input()->addIdleDetector(this);
 }
@@ -30,14 +30,6 @@ IdleDetector::~IdleDetector()
     }
 }
 
-void IdleDetector::timerEvent(QTimerEvent *event)
-{
-    if (event->timerId() == m_timer.timerId()) {
-        m_timer.stop();
-        markAsIdle();
-    }
-}
-
 IdleDetector::OperatingMode IdleDetector::mode() const
 {
     return m_mode;
@@ -58,17 +50,37 @@ void IdleDetector::setInhibited(bool inhibited)
         return;
     }
     m_isInhibited = inhibited;
-    if (inhibited) {
-        m_timer.stop();
-    } else {
-        m_timer.start(m_timeout, this);
+    if (!inhibited) {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+bool IdleDetector::isIdle() const
+{
+    return m_isIdle;
+}
+
+std::optional<std::chrono::steady_clock::time_point> IdleDetector::deadline(std::chrono::steady_clock::time_point lastActivity) const
+{
+    if (m_isIdle || m_isInhibited) {
+        return std::nullopt;
+    }
+    return std::max(m_start, lastActivity) + m_timeout;
+}
+
+bool IdleDetector::check(std::chrono::steady_clock::time_point lastActivity, std::chrono::steady_clock::time_point now)
+{
+    const auto idleDeadline = deadline(lastActivity);
+    if (!idleDeadline || *idleDeadline > now) {
+        return false;
     }
+    markAsIdle();
+    return true;
 }
 
 void IdleDetector::activity()
 {
     if (!m_isInhibited) {
-        m_timer.start(m_timeout, this);
         markAsResumed();
     }
 }
@@ -8,12 +8,21 @@
 
 #include <kwin_export.h>
 
-#include <QBasicTimer>
 #include <QObject>
 
+#include <chrono>
+#include <optional>
+
 namespace KWin
 {
 
+/**
+ * The IdleDetector class notifies when there has been no user activity for a given time.
+ *
+ * The detectors don't run timers of their own. InputRedirection records when the last user
+ * activity happened and checks the deadlines of all detectors with one timer, so that an
+ * input event costs the same no matter how many detectors there are.
+ */
 class KWIN_EXPORT IdleDetector : public QObject
 {
     Q_OBJECT
@@ -27,6 +36,10 @@ public:
     explicit IdleDetector(std::chrono::milliseconds timeout, OperatingMode mode, QObject *parent = nullptr);
     ~IdleDetector() override;
 
+    /**
+     * Resumes the detector if it's idle. The time of the activity is tracked by
+     * InputRedirection.
+     */
     void activity();
 
     OperatingMode mode() const;
@@ -34,19 +47,31 @@ public:
     bool isInhibited() const;
     void setInhibited(bool inhibited);
 
+    bool isIdle() const;
+
+    /**
+     * Returns when the detector becomes idle if the last user activity happened at
+     * @a lastActivity, or std::nullopt if it's idle or inhibited.
+     */
+    std::optional<std::chrono::steady_clock::time_point> deadline(std::chrono::steady_clock::time_point lastActivity) const;
+
+    /**
+     * Marks the detector as idle if its deadline is not after @a now. Returns true if the
+     * detector has become idle.
+     */
+    bool check(std::chrono::steady_clock::time_point lastActivity, std::chrono::steady_clock::time_point now);
+
 Q_SIGNALS:
     void idle();
     void resumed();
 
-protected:
-    void timerEvent(QTimerEvent *event) override;
-
 private:
     void markAsIdle();
     void markAsResumed();
 
-    QBasicTimer m_timer;
     std::chrono::milliseconds m_timeout;
+    // the timeout counts from the last activity, but not from before this point in time
+    std::chrono::steady_clock::time_point m_start;
     bool m_isIdle = false;
     bool m_isInhibited = false;
     OperatingMode m_mode = OperatingMode::FollowsInhibitors;
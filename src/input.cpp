@@ -36,14 +36,17 @@
 #if KWIN_BUILD_TABBOX
 #include "tabbox/tabbox.h"
 #endif
+#include "core/backendoutput.h"
 #include "core/output.h"
 #include "core/outputbackend.h"
+#include "core/renderloop.h"
 #include "cursor.h"
 #include "cursorsource.h"
 #include "internalwindow.h"
 #include "popup_input_filter.h"
 #include "screenedge.h"
 #include "screenedgegestures.h"
+#include "utils/envvar.h"
 #include "virtualdesktops.h"
 #include "wayland/display.h"
 #include "wayland/inputmethod_v1.h"
@@ -74,6 +77,7 @@
 
 #include "osd.h"
 #include "wayland/xdgshell.h"
+#include <algorithm>
 #include <cmath>
 #include <linux/input.h>
 
@@ -82,8 +86,9 @@ using namespace std::literals;
 namespace KWin
 {
 
-InputEventFilter::InputEventFilter(InputFilterOrder::Order weight)
+InputEventFilter::InputEventFilter(InputFilterOrder::Order weight, InputEventKinds kinds)
     : m_weight(weight)
+    , m_kinds(kinds)
 {
 }
 
@@ -99,6 +104,26 @@ int InputEventFilter::weight() const
     return m_weight;
 }
 
+InputEventKinds InputEventFilter::kinds() const
+{
+    return m_kinds;
+}
+
+bool InputEventFilter::isEnabled() const
+{
+    return m_enabled;
+}
+
+void InputEventFilter::setEnabled(bool enabled)
+{
+    if (m_enabled != enabled) {
+        m_enabled = enabled;
+        if (input()) {
+            input()->updateInputEventFilters();
+        }
+    }
+}
+
 bool InputEventFilter::pointerMotion(PointerMotionEvent *event)
 {
     return false;
@@ -272,7 +297,7 @@ class VirtualTerminalFilter : public InputEventFilter
 {
 public:
     VirtualTerminalFilter()
-        : InputEventFilter(InputFilterOrder::VirtualTerminal)
+        : InputEventFilter(InputFilterOrder::VirtualTerminal, InputEventKind::Keyboard)
     {
     }
     bool keyboardKey(KeyboardKeyEvent *event) override
@@ -294,7 +319,7 @@ class LockScreenFilter : public InputEventFilter
 {
 public:
     LockScreenFilter()
-        : InputEventFilter(InputFilterOrder::LockScreen)
+        : InputEventFilter(InputFilterOrder::LockScreen, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Gesture)
     {
     }
     bool pointerMotion(PointerMotionEvent *event) override
@@ -533,7 +558,7 @@ class EffectsFilter : public InputEventFilter
 {
 public:
     EffectsFilter()
-        : InputEventFilter(InputFilterOrder::Effects)
+        : InputEventFilter(InputFilterOrder::Effects, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Tablet)
     {
     }
     bool pointerMotion(PointerMotionEvent *event) override
@@ -690,7 +715,7 @@ class MoveResizeFilter : public InputEventFilter
 {
 public:
     MoveResizeFilter()
-        : InputEventFilter(InputFilterOrder::InteractiveMoveResize)
+        : InputEventFilter(InputFilterOrder::InteractiveMoveResize, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Tablet)
     {
     }
     bool pointerMotion(PointerMotionEvent *event) override
@@ -819,8 +844,9 @@ class WindowSelectorFilter : public InputEventFilter
 {
 public:
     WindowSelectorFilter()
-        : InputEventFilter(InputFilterOrder::WindowSelector)
+        : InputEventFilter(InputFilterOrder::WindowSelector, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Tablet)
     {
+        setEnabled(false);
     }
     bool pointerMotion(PointerMotionEvent *event) override
     {
@@ -945,6 +971,7 @@ public:
     {
         Q_ASSERT(!m_active);
         m_active = true;
+        setEnabled(true);
         m_callback = callback;
         input()->keyboard()->update();
         input()->touch()->cancel();
@@ -953,6 +980,7 @@ public:
     {
         Q_ASSERT(!m_active);
         m_active = true;
+        setEnabled(true);
         m_pointSelectionFallback = callback;
         input()->keyboard()->update();
         input()->touch()->cancel();
@@ -962,6 +990,7 @@ private:
     void deactivate()
     {
         m_active = false;
+        setEnabled(false);
         m_callback = std::function<void(Window *)>();
         m_pointSelectionFallback = std::function<void(const QPoint &)>();
         input()->pointer()->removeWindowSelectionCursor();
@@ -1024,7 +1053,7 @@ class GlobalShortcutFilter : public InputEventFilter
 {
 public:
     GlobalShortcutFilter()
-        : InputEventFilter(InputFilterOrder::GlobalShortcut)
+        : InputEventFilter(InputFilterOrder::GlobalShortcut, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Gesture)
     {
         m_powerDown.setSingleShot(true);
         m_powerDown.setInterval(1000);
@@ -1205,7 +1234,7 @@ public:
             if (m_touchPoints.count() >= 3 && !m_gestureCancelled) {
                 m_gestureTaken = true;
                 m_syntheticCancel = true;
-                input()->processFilters(&InputEventFilter::touchCancel);
+                input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchCancel);
                 m_syntheticCancel = false;
                 input()->shortcuts()->processSwipeStart(DeviceType::Touchscreen, m_touchPoints.count());
                 return true;
@@ -1360,7 +1389,7 @@ class InternalWindowEventFilter : public InputEventFilter
 {
 public:
     InternalWindowEventFilter()
-        : InputEventFilter(InputFilterOrder::InternalWindow)
+        : InputEventFilter(InputFilterOrder::InternalWindow, InputEventKind::Pointer | InputEventKind::Touch | InputEventKind::Tablet)
     {
         m_touchDevice = std::make_unique<QPointingDevice>(QLatin1String("some touchscreen"), 0, QInputDevice::DeviceType::TouchScreen,
                                                           QPointingDevice::PointerType::Finger, QInputDevice::Capability::Position,
@@ -1569,7 +1598,7 @@ class DecorationEventFilter : public InputEventFilter
 {
 public:
     DecorationEventFilter()
-        : InputEventFilter(InputFilterOrder::Decoration)
+        : InputEventFilter(InputFilterOrder::Decoration, InputEventKind::Pointer | InputEventKind::Touch | InputEventKind::Tablet)
     {
     }
     bool pointerMotion(PointerMotionEvent *event) override
@@ -1810,7 +1839,7 @@ class TabBoxInputFilter : public InputEventFilter
 {
 public:
     TabBoxInputFilter()
-        : InputEventFilter(InputFilterOrder::TabBox)
+        : InputEventFilter(InputFilterOrder::TabBox, InputEventKind::Pointer | InputEventKind::Keyboard)
     {
     }
     bool pointerMotion(PointerMotionEvent *event) override
@@ -1880,7 +1909,7 @@ class ScreenEdgeInputFilter : public InputEventFilter
 {
 public:
     ScreenEdgeInputFilter()
-        : InputEventFilter(InputFilterOrder::ScreenEdge)
+        : InputEventFilter(InputFilterOrder::ScreenEdge, InputEventKind::Pointer | InputEventKind::Touch)
     {
     }
     bool pointerMotion(PointerMotionEvent *event) override
@@ -1916,7 +1945,7 @@ class WindowActionInputFilter : public InputEventFilter
 {
 public:
     WindowActionInputFilter()
-        : InputEventFilter(InputFilterOrder::WindowAction)
+        : InputEventFilter(InputFilterOrder::WindowAction, InputEventKind::Pointer | InputEventKind::Touch | InputEventKind::Tablet)
     {
     }
     bool pointerButton(PointerButtonEvent *event) override
@@ -2038,7 +2067,7 @@ class InputMethodEventFilter : public InputEventFilter
 {
 public:
     InputMethodEventFilter()
-        : InputEventFilter(InputFilterOrder::InputMethod)
+        : InputEventFilter(InputFilterOrder::InputMethod, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch)
     {
     }
 
@@ -2562,7 +2591,7 @@ class DragAndDropInputFilter : public QObject, public InputEventFilter
     Q_OBJECT
 public:
     DragAndDropInputFilter()
-        : InputEventFilter(InputFilterOrder::DragAndDrop)
+        : InputEventFilter(InputFilterOrder::DragAndDrop, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Tablet)
     {
         connect(waylandServer()->seat(), &SeatInterface::dragRequested, this, [](AbstractDataSource *source, SurfaceInterface *origin, quint32 serial, DragAndDropIcon *dragIcon) {
             if (auto window = waylandServer()->findWindow(origin->mainSurface())) {
@@ -2922,6 +2951,9 @@ InputRedirection::InputRedirection(QObject *parent)
 {
     setupInputBackends();
 
+    m_idleTimer.setSingleShot(true);
+    connect(&m_idleTimer, &QTimer::timeout, this, &InputRedirection::checkIdleDetectors);
+
     connect(kwinApp(), &Application::workspaceCreated, this, &InputRedirection::setupWorkspace);
 }
 
@@ -2941,11 +2973,28 @@ void InputRedirection::installInputEventFilter(InputEventFilter *filter)
         return a->weight() < b->weight();
     });
     m_filters.insert(it, filter);
+    updateInputEventFilters();
 }
 
 void InputRedirection::uninstallInputEventFilter(InputEventFilter *filter)
 {
-    m_filters.removeOne(filter);
+    if (m_filters.removeOne(filter)) {
+        updateInputEventFilters();
+    }
+}
+
+void InputRedirection::updateInputEventFilters()
+{
+    for (size_t i = 0; i < m_filtersByKind.size(); ++i) {
+        const InputEventKind kind = InputEventKind(1 << i);
+        QList<InputEventFilter *> filters;
+        for (InputEventFilter *filter : std::as_const(m_filters)) {
+            if (filter->isEnabled() && filter->kinds().testFlag(kind)) {
+                filters.append(filter);
+            }
+        }
+        m_filtersByKind[i] = filters;
+    }
 }
 
 void InputRedirection::installInputEventSpy(InputEventSpy *spy)
@@ -3268,7 +3317,7 @@ void InputRedirection::addInputDevice(InputDevice *device)
             .timestamp = time,
         };
         processSpies(&InputEventSpy::switchEvent, &event);
-        processFilters(&InputEventFilter::switchEvent, &event);
+        processFilters(InputEventKind::Switch, &InputEventFilter::switchEvent, &event);
     });
 
     connect(device, &InputDevice::tabletToolAxisEvent,
@@ -3383,10 +3432,25 @@ Qt::MouseButtons InputRedirection::qtButtonStates() const
 
 void InputRedirection::simulateUserActivity()
 {
-    const auto idleDetectors = m_idleDetectors; // the detector list can potentially change
-    for (IdleDetector *idleDetector : idleDetectors) {
-        idleDetector->activity();
+    // The detectors that are still counting down look at the time of the last activity when
+    // their deadline comes, restarting their timers on every event would be too expensive
+    m_lastUserActivity = std::chrono::steady_clock::now();
+    if (m_idlingDetectors.isEmpty()) {
+        return;
+    }
+
+    const auto idlingDetectors = std::exchange(m_idlingDetectors, {}); // the detector list can potentially change
+    for (IdleDetector *idleDetector : idlingDetectors) {
+        if (idleDetector->isInhibited()) {
+            m_idlingDetectors.append(idleDetector);
+        }
     }
+    for (IdleDetector *idleDetector : idlingDetectors) {
+        if (m_idleDetectors.contains(idleDetector)) {
+            idleDetector->activity();
+        }
+    }
+    scheduleIdleCheck();
 }
 
 void InputRedirection::addIdleDetector(IdleDetector *detector)
@@ -3394,11 +3458,41 @@ void InputRedirection::addIdleDetector(IdleDetector *detector)
     Q_ASSERT(!m_idleDetectors.contains(detector));
     detector->setInhibited(!m_idleInhibitors.isEmpty());
     m_idleDetectors.append(detector);
+    scheduleIdleCheck();
 }
 
 void InputRedirection::removeIdleDetector(IdleDetector *detector)
 {
     m_idleDetectors.removeOne(detector);
+    m_idlingDetectors.removeOne(detector);
+}
+
+void InputRedirection::checkIdleDetectors()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto idleDetectors = m_idleDetectors; // the detector list can potentially change
+    for (IdleDetector *idleDetector : idleDetectors) {
+        if (m_idleDetectors.contains(idleDetector) && idleDetector->check(m_lastUserActivity, now)) {
+            m_idlingDetectors.append(idleDetector);
+        }
+    }
+    scheduleIdleCheck();
+}
+
+void InputRedirection::scheduleIdleCheck()
+{
+    std::optional<std::chrono::steady_clock::time_point> nextDeadline;
+    for (const IdleDetector *idleDetector : std::as_const(m_idleDetectors)) {
+        if (const auto deadline = idleDetector->deadline(m_lastUserActivity)) {
+            nextDeadline = nextDeadline ? std::min(*nextDeadline, *deadline) : *deadline;
+        }
+    }
+    if (!nextDeadline) {
+        m_idleTimer.stop();
+        return;
+    }
+    const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(*nextDeadline - std::chrono::steady_clock::now());
+    m_idleTimer.start(std::max(timeout, std::chrono::milliseconds::zero()));
 }
 
 QList<Window *> InputRedirection::idleInhibitors() const
@@ -3422,6 +3516,7 @@ void InputRedirection::removeIdleInhibitor(Window *inhibitor)
         for (IdleDetector *idleDetector : std::as_const(m_idleDetectors)) {
             idleDetector->setInhibited(false);
         }
+        scheduleIdleCheck();
     }
 }
 
@@ -3437,14 +3532,8 @@ Window *InputRedirection::findToplevel(const QPointF &pos)
             return nullptr;
         }
     }
-    const QList<Window *> &stacking = Workspace::self()->stackingOrder();
-    if (stacking.isEmpty()) {
-        return nullptr;
-    }
-    auto it = stacking.end();
-    do {
-        --it;
-        Window *window = (*it);
+    const QList<Window *> candidates = Workspace::self()->windowsAt(pos);
+    for (Window *window : candidates) {
         if (window->isDeleted()) {
             // a deleted window doesn't get mouse events
             continue;
@@ -3463,7 +3552,7 @@ Window *InputRedirection::findToplevel(const QPointF &pos)
         if (window->hitTest(pos)) {
             return window;
         }
-    } while (it != stacking.begin());
+    }
     return nullptr;
 }
 
@@ -3581,6 +3670,36 @@ InputDeviceHandler::InputDeviceHandler(InputRedirection *input)
 
 InputDeviceHandler::~InputDeviceHandler() = default;
 
+static const bool s_resampleMotion = environmentVariableBoolValue("KWIN_INPUT_RESAMPLING").value_or(false);
+static const std::chrono::microseconds s_motionPrediction = std::chrono::milliseconds(std::clamp(environmentVariableIntValue("KWIN_INPUT_PREDICTION").value_or(0), 0, 20));
+// resampled positions lag behind a bit, so that they can be interpolated most of the time
+static constexpr std::chrono::microseconds s_resamplingLatency = std::chrono::milliseconds(5);
+
+bool InputDeviceHandler::resamplesMotion()
+{
+    return s_resampleMotion;
+}
+
+std::chrono::milliseconds InputDeviceHandler::timeUntilNextRefreshCycle(const QPointF &pos)
+{
+    LogicalOutput *output = workspace()->outputAt(pos);
+    RenderLoop *renderLoop = output ? output->backendOutput()->renderLoop() : nullptr;
+    if (!renderLoop || renderLoop->refreshRate() <= 0) {
+        return std::chrono::milliseconds::zero();
+    }
+    const std::chrono::nanoseconds interval(1'000'000'000'000ull / renderLoop->refreshRate());
+    const std::chrono::nanoseconds now = std::chrono::steady_clock::now().time_since_epoch();
+    const std::chrono::nanoseconds sinceLastPresentation = std::max(now - renderLoop->lastPresentationTimestamp(), std::chrono::nanoseconds::zero());
+    const std::chrono::nanoseconds untilNext = interval - sinceLastPresentation % interval;
+    return std::chrono::ceil<std::chrono::milliseconds>(untilNext);
+}
+
+std::chrono::microseconds InputDeviceHandler::resamplingTime()
+{
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    return now - s_resamplingLatency + s_motionPrediction;
+}
+
 void InputDeviceHandler::init()
 {
     connect(workspace(), &Workspace::stackingOrderChanged, this, &InputDeviceHandler::update);
@@ -12,14 +12,18 @@
 #include "config-kwin.h"
 
 #include "core/inputdevice.h"
+#include "tracing.h"
 #include <QObject>
 #include <QPoint>
 #include <QPointer>
+#include <QTimer>
 
 #include <KConfigWatcher>
 #include <KSharedConfig>
 #include <QSet>
 
+#include <array>
+#include <bit>
 #include <functional>
 
 class KGlobalAccelInterface;
@@ -79,6 +83,23 @@ class DecoratedWindowImpl;
 class InputBackend;
 class InputDevice;
 
+/**
+ * The kinds of events that are passed through InputEventFilters.
+ */
+enum class InputEventKind {
+    Pointer = 1 << 0,
+    Keyboard = 1 << 1,
+    Touch = 1 << 2,
+    Gesture = 1 << 3,
+    Switch = 1 << 4,
+    Tablet = 1 << 5,
+};
+Q_DECLARE_FLAGS(InputEventKinds, InputEventKind)
+Q_DECLARE_OPERATORS_FOR_FLAGS(InputEventKinds)
+
+static constexpr InputEventKinds AllInputEventKinds = InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch
+    | InputEventKind::Gesture | InputEventKind::Switch | InputEventKind::Tablet;
+
 /**
  * @brief This class is responsible for redirecting incoming input to the surface which currently
  * has input or send enter/leave events.
@@ -143,25 +164,34 @@ public:
     }
 
     /**
-     * Sends an event through all InputFilters.
-     * The method is invoked on each input filter. Processing is stopped if
+     * Sends an event through all InputFilters that are enabled and handle events of the given
+     * @a kind. The method is invoked on each of these input filters. Processing is stopped if
      * a filter returns @c true for it
      */
-    void processFilters(auto method, const auto &...args)
+    void processFilters(InputEventKind kind, auto method, const auto &...args)
     {
-        for (const auto filter : std::as_const(m_filters)) {
+        traceScope(Input, "filters");
+        // A filter may be installed or uninstalled while the event is being processed
+        const QList<InputEventFilter *> filters = m_filtersByKind[std::countr_zero(uint(kind))];
+        for (const auto filter : filters) {
             if ((filter->*method)(args...)) {
                 return;
             }
         }
     }
 
+    /**
+     * Must be called after an installed filter has been enabled or disabled.
+     */
+    void updateInputEventFilters();
+
     /**
      * Sends an event through all input event spies.
      * The method is invoked on each InputEventSpy.
      */
     void processSpies(auto method, const auto &...args)
     {
+        traceScope(Input, "spies");
         for (const auto spy : std::as_const(m_spies)) {
             (spy->*method)(args...);
         }
@@ -265,6 +295,8 @@ private:
     void setupInputFilters();
     void updateLeds(LEDs leds);
     void updateAvailableInputDevices();
+    void checkIdleDetectors();
+    void scheduleIdleCheck();
     KeyboardInputRedirection *m_keyboard;
     PointerInputRedirection *m_pointer;
     TabletInputRedirection *m_tablet;
@@ -278,10 +310,15 @@ private:
     QList<InputDevice *> m_inputDevices;
 
     QList<IdleDetector *> m_idleDetectors;
+    // the detectors that are idle, only those need to hear about user activity
+    QList<IdleDetector *> m_idlingDetectors;
+    std::chrono::steady_clock::time_point m_lastUserActivity;
+    QTimer m_idleTimer;
     QList<Window *> m_idleInhibitors;
     std::unique_ptr<WindowSelectorFilter> m_windowSelector;
 
     QList<InputEventFilter *> m_filters;
+    std::array<QList<InputEventFilter *>, 6> m_filtersByKind;
     QList<InputEventSpy *> m_spies;
     KConfigWatcher::Ptr m_inputConfigWatcher;
 
@@ -375,7 +412,7 @@ public:
      * @param weight The position in the input chain, lower values come first.
      * @note the filter is not installed automatically
      */
-    InputEventFilter(InputFilterOrder::Order weight);
+    InputEventFilter(InputFilterOrder::Order weight, InputEventKinds kinds = AllInputEventKinds);
     /**
      * @brief ~InputEventFilter
      * This will uninstall the event filter if needed
@@ -387,6 +424,17 @@ public:
      */
     int weight() const;
 
+    /**
+     * The kinds of events the filter handles. The filter is only invoked for these.
+     */
+    InputEventKinds kinds() const;
+
+    /**
+     * Whether the filter wants to see events at all. A disabled filter is skipped as if it
+     * had returned @c false.
+     */
+    bool isEnabled() const;
+
     virtual bool pointerMotion(PointerMotionEvent *event);
     virtual bool pointerButton(PointerButtonEvent *event);
     virtual bool pointerFrame();
@@ -437,9 +485,12 @@ public:
 
 protected:
     bool passToInputMethod(KeyboardKeyEvent *event);
+    void setEnabled(bool enabled);
 
 private:
     int m_weight = 0;
+    InputEventKinds m_kinds;
+    bool m_enabled = true;
 };
 
 class KWIN_EXPORT InputDeviceHandler : public QObject
@@ -503,6 +554,22 @@ protected:
         return false;
     }
 
+    /**
+     * Whether touch and stylus motion is held back until the next refresh cycle and resampled
+     * to it, so that clients get at most one motion per frame. Enabled with
+     * KWIN_INPUT_RESAMPLING=1, KWIN_INPUT_PREDICTION sets how many milliseconds ahead the
+     * positions are predicted.
+     */
+    static bool resamplesMotion();
+    /**
+     * Returns how long it takes until the output at @a pos starts its next refresh cycle.
+     */
+    static std::chrono::milliseconds timeUntilNextRefreshCycle(const QPointF &pos);
+    /**
+     * Returns the time that motion which is sent now is resampled to.
+     */
+    static std::chrono::microseconds resamplingTime();
+
     inline bool inited() const
     {
         return m_inited;
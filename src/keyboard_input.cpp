@@ -324,7 +324,7 @@ void KeyboardInputRedirection::processKey(uint32_t key, KeyboardKeyState state,
     }
 
     m_input->processSpies(&InputEventSpy::keyboardKey, &event);
-    m_input->processFilters(&InputEventFilter::keyboardKey, &event);
+    m_input->processFilters(InputEventKind::Keyboard, &InputEventFilter::keyboardKey, &event);
 
     if (state == KeyboardKeyState::Released) {
         m_filteredKeys.removeOne(key);
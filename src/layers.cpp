@@ -83,6 +83,7 @@
 #include <array>
 
 #include <QDebug>
+#include <QSet>
 
 namespace KWin
 {
@@ -150,10 +151,31 @@ void Workspace::propagateWindows(bool propagate_new_windows)
         newWindowStack << window->window();
     }
 
-    // TODO isn't it too inefficient to restack always all windows?
     // TODO don't restack not visible windows?
     Q_ASSERT(newWindowStack.at(0) == rootInfo()->supportWindow());
-    Xcb::restackWindows(newWindowStack);
+    if (m_x11WindowStack.isEmpty() || m_x11WindowStack.constFirst() != newWindowStack.constFirst()) {
+        // Nothing is known about the current order, e.g. Xwayland has just been started
+        Xcb::restackWindows(newWindowStack);
+    } else {
+        // Only restack the windows that are not below the right window already. Usually only
+        // a window and its transients have been moved, so this saves restacking everything.
+        const QSet<xcb_window_t> present(newWindowStack.constBegin(), newWindowStack.constEnd());
+        QList<xcb_window_t> currentStack = m_x11WindowStack;
+        currentStack.removeIf([&present](xcb_window_t window) {
+            return !present.contains(window);
+        });
+        // The windows above the i-th one are in the right order at this point, so it's in
+        // the right place if it comes next in the current order too
+        for (int i = 1; i < newWindowStack.size(); ++i) {
+            if (currentStack.value(i) == newWindowStack.at(i)) {
+                continue;
+            }
+            currentStack.removeOne(newWindowStack.at(i));
+            currentStack.insert(i, newWindowStack.at(i));
+            Xcb::restackWindows({newWindowStack.at(i - 1), newWindowStack.at(i)});
+        }
+    }
+    m_x11WindowStack = newWindowStack;
 
     QList<xcb_window_t> cl;
     if (propagate_new_windows) {
@@ -344,6 +366,7 @@ void Workspace::lowerWindow(Window *window, bool nogroup)
     if (nogroup || (!window->isTransient() && window->transients().isEmpty())) {
         unconstrained_stacking_order.removeAll(window);
         unconstrained_stacking_order.prepend(window);
+        lowerInLayerStackingOrder(window);
     } else {
         auto mainWindows = window->allMainWindows();
         Window *parent;
@@ -393,6 +416,7 @@ void Workspace::lowerWindowWithinApplication(Window *window)
     if (!lowered) {
         unconstrained_stacking_order.prepend(window);
     }
+    m_layerStackingOrderValid = false;
     // ignore mainwindows
 }
 
@@ -420,6 +444,7 @@ void Workspace::raiseWindow(Window *window, bool nogroup)
 
     unconstrained_stacking_order.removeAll(window);
     unconstrained_stacking_order.append(window);
+    raiseInLayerStackingOrder(window);
 }
 
 void Workspace::raiseWindowWithinApplication(Window *window)
@@ -446,6 +471,7 @@ void Workspace::raiseWindowWithinApplication(Window *window)
         if (Window::belongToSameApplication(other, window)) {
             unconstrained_stacking_order.removeAll(window);
             unconstrained_stacking_order.insert(unconstrained_stacking_order.indexOf(other) + 1, window); // insert after the found one
+            m_layerStackingOrderValid = false;
             break;
         }
     }
@@ -490,6 +516,7 @@ void Workspace::stackBelow(Window *window, Window *reference)
 
     unconstrained_stacking_order.removeAll(window);
     unconstrained_stacking_order.insert(unconstrained_stacking_order.indexOf(reference), window);
+    m_layerStackingOrderValid = false;
 
     m_focusChain->moveAfterWindow(window, reference);
     updateStackingOrder();
@@ -509,6 +536,7 @@ void Workspace::stackAbove(Window *window, Window *reference)
 
     unconstrained_stacking_order.removeAll(window);
     unconstrained_stacking_order.insert(unconstrained_stacking_order.indexOf(reference) + 1, window);
+    m_layerStackingOrderValid = false;
 
     m_focusChain->moveBeforeWindow(window, reference);
     updateStackingOrder();
@@ -543,6 +571,7 @@ void Workspace::restoreSessionStackingOrder(X11Window *window)
         return;
     }
     StackingUpdatesBlocker blocker(this);
+    m_layerStackingOrderValid = false;
     unconstrained_stacking_order.removeAll(window);
     for (auto it = unconstrained_stacking_order.begin(); it != unconstrained_stacking_order.end(); ++it) {
         X11Window *current = qobject_cast<X11Window *>(*it);
@@ -563,18 +592,28 @@ void Workspace::restoreSessionStackingOrder(X11Window *window)
  */
 QList<Window *> Workspace::constrainedStackingOrder()
 {
-    // Sort the windows based on their layers while preserving their relative order in the
-    // unconstrained stacking order.
-    std::array<QList<Window *>, NumLayers> windows;
-    for (Window *window : std::as_const(unconstrained_stacking_order)) {
-        const Layer layer = computeLayer(window);
-        windows[layer] << window;
+    // The windows sorted by their layers, preserving their relative order in the unconstrained
+    // stacking order, are usually known already. An X11 window can get promoted to the active
+    // layer with its group without its own layer changing though, so check those.
+#if KWIN_BUILD_X11
+    if (m_layerStackingOrderValid) {
+        for (X11Window *window : std::as_const(m_x11WindowsById)) {
+            const auto it = m_stackingLayers.constFind(window);
+            if (it != m_stackingLayers.constEnd() && it.value() != computeLayer(window)) {
+                m_layerStackingOrderValid = false;
+                break;
+            }
+        }
+    }
+#endif
+    if (!m_layerStackingOrderValid) {
+        rebuildLayerStackingOrder();
     }
 
     QList<Window *> stacking;
     stacking.reserve(unconstrained_stacking_order.count());
     for (uint layer = FirstLayer; layer < NumLayers; ++layer) {
-        stacking += windows[layer];
+        stacking += m_layerStackingOrder[layer];
     }
 
     // Apply the stacking order constraints. First, we enqueue the root constraints, i.e.
@@ -626,6 +665,55 @@ QList<Window *> Workspace::constrainedStackingOrder()
     return stacking;
 }
 
+void Workspace::rebuildLayerStackingOrder()
+{
+    for (QList<Window *> &windows : m_layerStackingOrder) {
+        windows.clear();
+    }
+    m_stackingLayers.clear();
+    for (Window *window : std::as_const(unconstrained_stacking_order)) {
+        const Layer layer = computeLayer(window);
+        m_layerStackingOrder[layer] << window;
+        m_stackingLayers.insert(window, layer);
+    }
+    m_layerStackingOrderValid = true;
+}
+
+void Workspace::raiseInLayerStackingOrder(Window *window)
+{
+    if (!m_layerStackingOrderValid) {
+        return;
+    }
+    const auto it = m_stackingLayers.constFind(window);
+    if (it == m_stackingLayers.constEnd()) {
+        m_layerStackingOrderValid = false;
+        return;
+    }
+    QList<Window *> &windows = m_layerStackingOrder[it.value()];
+    windows.removeOne(window);
+    windows.append(window);
+}
+
+void Workspace::lowerInLayerStackingOrder(Window *window)
+{
+    if (!m_layerStackingOrderValid) {
+        return;
+    }
+    const auto it = m_stackingLayers.constFind(window);
+    if (it == m_stackingLayers.constEnd()) {
+        m_layerStackingOrderValid = false;
+        return;
+    }
+    QList<Window *> &windows = m_layerStackingOrder[it.value()];
+    windows.removeOne(window);
+    windows.prepend(window);
+}
+
+void Workspace::invalidateStackingLayers()
+{
+    m_layerStackingOrderValid = false;
+}
+
 void Workspace::blockStackingUpdates(bool block)
 {
     if (block) {
@@ -700,6 +788,7 @@ bool Workspace::updateXStackingOrder()
         if (window) {
             unconstrained_stacking_order.removeAll(window);
             unconstrained_stacking_order.append(window);
+            raiseInLayerStackingOrder(window);
             changed = true;
         }
     }
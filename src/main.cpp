@@ -34,6 +34,7 @@
 #include "screenedge.h"
 #include "sm.h"
 #include "tabletmodemanager.h"
+#include "tracing.h"
 #include "wayland/surface.h"
 #include "workspace.h"
 
@@ -124,6 +125,9 @@ void Application::start()
         m_inputConfig = KSharedConfig::openConfig(QStringLiteral("kcminputrc"), KConfig::NoGlobals);
     }
 
+    // created before anything else so that the startup can be traced
+    Tracer::create(this);
+
     performStartup();
 }
 
@@ -357,12 +361,29 @@ void Application::applyXwaylandScale()
 }
 
 #if KWIN_BUILD_X11
+static uint32_t genericEventFilterKey(int extension, int eventType)
+{
+    return uint32_t(extension) << 16 | uint16_t(eventType);
+}
+
 void Application::registerEventFilter(X11EventFilter *filter)
 {
+    // a filter that is interested in several event types is shared by their lists
+    auto container = new X11EventFilterContainer(filter);
     if (filter->isGenericEvent()) {
-        m_genericEventFilters.append(new X11EventFilterContainer(filter));
+        const QList<int> eventTypes = filter->genericEventTypes();
+        for (int eventType : eventTypes) {
+            m_genericEventFilters[genericEventFilterKey(filter->extension(), eventType)].append(container);
+        }
     } else {
-        m_eventFilters.append(new X11EventFilterContainer(filter));
+        const QList<int> eventTypes = filter->eventTypes();
+        for (int eventType : eventTypes) {
+            if (eventType < 0 || eventType >= int(m_eventFilters.size())) {
+                qCWarning(KWIN_CORE) << "Ignoring an X11 event filter for the invalid event type" << eventType;
+                continue;
+            }
+            m_eventFilters[eventType].append(container);
+        }
     }
 }
 
@@ -382,9 +403,28 @@ void Application::unregisterEventFilter(X11EventFilter *filter)
 {
     X11EventFilterContainer *container = nullptr;
     if (filter->isGenericEvent()) {
-        container = takeEventFilter(filter, m_genericEventFilters);
+        const QList<int> eventTypes = filter->genericEventTypes();
+        for (int eventType : eventTypes) {
+            auto it = m_genericEventFilters.find(genericEventFilterKey(filter->extension(), eventType));
+            if (it == m_genericEventFilters.end()) {
+                continue;
+            }
+            if (X11EventFilterContainer *taken = takeEventFilter(filter, *it)) {
+                container = taken;
+            }
+            if (it->isEmpty()) {
+                m_genericEventFilters.erase(it);
+            }
+        }
     } else {
-        container = takeEventFilter(filter, m_eventFilters);
+        const QList<int> eventTypes = filter->eventTypes();
+        for (int eventType : eventTypes) {
+            if (eventType >= 0 && eventType < int(m_eventFilters.size())) {
+                if (X11EventFilterContainer *taken = takeEventFilter(filter, m_eventFilters[eventType])) {
+                    container = taken;
+                }
+            }
+        }
     }
     delete container;
 }
@@ -447,28 +487,20 @@ bool Application::dispatchEvent(xcb_generic_event_t *event)
 
         // We need to make a shadow copy of the event filter list because an activated event
         // filter may mutate it by removing or installing another event filter.
-        const auto eventFilters = m_genericEventFilters;
+        const auto eventFilters = m_genericEventFilters.value(genericEventFilterKey(ge->extension, ge->event_type));
 
         for (X11EventFilterContainer *container : eventFilters) {
-            if (!container) {
-                continue;
-            }
-            X11EventFilter *filter = container->filter();
-            if (filter->extension() == ge->extension && filter->genericEventTypes().contains(ge->event_type) && filter->event(event)) {
+            if (container && container->filter()->event(event)) {
                 return true;
             }
         }
     } else {
         // We need to make a shadow copy of the event filter list because an activated event
         // filter may mutate it by removing or installing another event filter.
-        const auto eventFilters = m_eventFilters;
+        const auto eventFilters = m_eventFilters[x11EventType];
 
         for (X11EventFilterContainer *container : eventFilters) {
-            if (!container) {
-                continue;
-            }
-            X11EventFilter *filter = container->filter();
-            if (filter->eventTypes().contains(x11EventType) && filter->event(event)) {
+            if (container && container->filter()->event(event)) {
                 return true;
             }
         }
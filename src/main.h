@@ -15,10 +15,12 @@
 #include "effect/globals.h"
 
 #include <KSharedConfig>
+#include <array>
 #include <memory>
 // Qt
 #include <QAbstractNativeEventFilter>
 #include <QApplication>
+#include <QHash>
 #include <QProcessEnvironment>
 
 #if KWIN_BUILD_X11
@@ -321,8 +323,10 @@ protected:
 
 private:
 #if KWIN_BUILD_X11
-    QList<QPointer<X11EventFilterContainer>> m_eventFilters;
-    QList<QPointer<X11EventFilterContainer>> m_genericEventFilters;
+    // indexed by the event type, and by the extension and the event type for generic events,
+    // so that dispatching an event only visits the filters that are interested in it
+    std::array<QList<QPointer<X11EventFilterContainer>>, 128> m_eventFilters;
+    QHash<uint32_t, QList<QPointer<X11EventFilterContainer>>> m_genericEventFilters;
     std::unique_ptr<XcbEventFilter> m_eventFilter;
 #endif
     bool m_followLocale1 = false;
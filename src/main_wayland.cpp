@@ -14,11 +14,16 @@
 #include "backends/virtual/virtual_backend.h"
 #include "backends/wayland/wayland_backend.h"
 #include "compositor.h"
+#include "core/backendoutput.h"
 #include "core/outputbackend.h"
+#include "core/renderloop.h"
 #include "core/session.h"
 #include "effect/effecthandler.h"
 #include "inputmethod.h"
+#include "startuptimeline.h"
 #include "tabletmodemanager.h"
+#include "utils/envvar.h"
+#include "utils/framecounters.h"
 #include "utils/realtime.h"
 #include "wayland/display.h"
 #include "wayland/seat.h"
@@ -35,6 +40,7 @@
 #include <KCrash>
 #include <KDesktopFile>
 #include <KLocalizedString>
+#include <KPluginMetaData>
 #include <KShell>
 #include <KSignalHandler>
 
@@ -44,6 +50,7 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QProcess>
+#include <QThreadPool>
 #include <QWindow>
 #include <QtPlugin>
 #include <qplatformdefs.h>
@@ -51,8 +58,12 @@
 #include <sched.h>
 #include <sys/resource.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <new>
 
 Q_IMPORT_PLUGIN(KWinIntegrationPlugin)
 #if KWIN_BUILD_GLOBALSHORTCUTS
@@ -61,6 +72,24 @@ Q_IMPORT_PLUGIN(KGlobalAccelImpl)
 Q_IMPORT_PLUGIN(KWindowSystemKWinPlugin)
 Q_IMPORT_PLUGIN(KWinIdleTimePoller)
 
+#if KWIN_BUILD_FRAME_COUNTERS
+// The other forms of operator new and delete are implemented on top of these two
+void *operator new(std::size_t size)
+{
+    KWin::FrameCounters::add(KWin::FrameCounters::Counter::Allocations, 1);
+    KWin::FrameCounters::add(KWin::FrameCounters::Counter::AllocatedBytes, size);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
 namespace KWin
 {
 
@@ -131,31 +160,72 @@ ApplicationWayland::~ApplicationWayland()
 
 void ApplicationWayland::performStartup()
 {
-    createOptions();
+    // Reading the plugin metadata can take a while on a cold boot. Do it while the backend
+    // is being initialized, so that the plugins and effects can be loaded from the page
+    // cache later. The objects themselves have to be created on the main thread.
+    QThreadPool::globalInstance()->start([this]() {
+        StartupPhase phase(&m_startupTimeline, "prefetch plugins");
+        KPluginMetaData::findPlugins(QStringLiteral("kwin/plugins"));
+        KPluginMetaData::findPlugins(QStringLiteral("kwin/effects/plugins"));
+    });
+
+    {
+        StartupPhase phase(&m_startupTimeline, "options");
+        createOptions();
+    }
 
-    if (!outputBackend()->initialize()) {
-        std::exit(1);
+    {
+        StartupPhase phase(&m_startupTimeline, "backend");
+        if (!outputBackend()->initialize()) {
+            std::exit(1);
+        }
     }
 
-    createInput();
-    createInputMethod();
-    createTabletModeManager();
+    {
+        StartupPhase phase(&m_startupTimeline, "input");
+        createInput();
+        createInputMethod();
+        createTabletModeManager();
+    }
 
-    auto compositor = Compositor::create();
-    compositor->createRenderer();
-    createWorkspace();
-    createColorManager();
-    createPlugins();
+    Compositor *compositor;
+    {
+        StartupPhase phase(&m_startupTimeline, "renderer");
+        compositor = Compositor::create();
+        compositor->createRenderer();
+    }
+    {
+        StartupPhase phase(&m_startupTimeline, "workspace");
+        createWorkspace();
+        createColorManager();
+    }
+    {
+        StartupPhase phase(&m_startupTimeline, "plugins");
+        createPlugins();
+    }
 
-    compositor->start();
+    {
+        StartupPhase phase(&m_startupTimeline, "scene and effects");
+        compositor->start();
+    }
+    const auto outputs = outputBackend()->outputs();
+    for (BackendOutput *output : outputs) {
+        connect(output->renderLoop(), &RenderLoop::framePresented, this, [this]() {
+            m_startupTimeline.finish();
+        }, Qt::SingleShotConnection);
+    }
 
     // Note that we start accepting client connections after creating the Workspace.
-    if (!waylandServer()->start()) {
-        qFatal("Failed to initialize the Wayland server, exiting now");
+    {
+        StartupPhase phase(&m_startupTimeline, "wayland server");
+        if (!waylandServer()->start()) {
+            qFatal("Failed to initialize the Wayland server, exiting now");
+        }
     }
 
 #if KWIN_BUILD_X11
     if (m_startXWayland) {
+        StartupPhase phase(&m_startupTimeline, "xwayland");
         setXwaylandScale(config()->group(QStringLiteral("Xwayland")).readEntry("Scale", 1.0));
 
         m_xwayland = std::make_unique<Xwl::Xwayland>(this);
@@ -168,7 +238,13 @@ void ApplicationWayland::performStartup()
         connect(m_xwayland.get(), &Xwl::Xwayland::started, this, &ApplicationWayland::applyXwaylandScale);
     }
 #endif
-    startSession();
+    {
+        StartupPhase phase(&m_startupTimeline, "session");
+        startSession();
+    }
+    if (outputs.isEmpty()) {
+        m_startupTimeline.finish();
+    }
 }
 
 void ApplicationWayland::refreshSettings(const KConfigGroup &group, const QByteArrayList &names)
@@ -322,6 +398,9 @@ int main(int argc, char *argv[])
                                         i18n("Whether or not to make windowed mode fullscreen"),
                                         QStringLiteral("fullscreen"));
 
+    QCommandLineOption forwardSurfacesOption(QStringLiteral("forward-surfaces"),
+                                             i18n("Pass client buffers to the host compositor as subsurfaces where possible in windowed mode on platform Wayland."));
+
     QCommandLineOption scaleOption(QStringLiteral("scale"),
                                    i18n("The scale for windowed mode. Default value is 1."),
                                    QStringLiteral("scale"));
@@ -377,6 +456,7 @@ int main(int argc, char *argv[])
     parser.addOption(drmOption);
     parser.addOption(locale1Option);
     parser.addOption(fullscreenOption);
+    parser.addOption(forwardSurfacesOption);
 
     QCommandLineOption inputMethodOption(QStringLiteral("inputmethod"),
                                          i18n("Input method that KWin starts."),
@@ -515,11 +595,36 @@ int main(int argc, char *argv[])
         break;
     case BackendType::Virtual: {
         auto outputBackend = std::make_unique<KWin::VirtualBackend>();
+        // Simulated display timing, to see how the compositor copes with many outputs that
+        // don't refresh in lockstep. The refresh rates are in Hz and used round-robin.
+        const QStringList refreshRates = qEnvironmentVariable("KWIN_VIRTUAL_REFRESH_RATES").split(QLatin1Char(','), Qt::SkipEmptyParts);
+        const std::optional<int> minVrrRefreshRate = KWin::environmentVariableIntValue("KWIN_VIRTUAL_VRR_MIN_HZ");
+        const std::chrono::microseconds vblankJitter(KWin::environmentVariableIntValue("KWIN_VIRTUAL_VBLANK_JITTER_US").value_or(0));
+        const std::chrono::microseconds commitLatency(KWin::environmentVariableIntValue("KWIN_VIRTUAL_COMMIT_LATENCY_US").value_or(0));
+        const bool simulatedTiming = !refreshRates.isEmpty() || minVrrRefreshRate || vblankJitter.count() || commitLatency.count();
         for (int i = 0; i < outputCount; ++i) {
-            outputBackend->addOutput(KWin::VirtualBackend::OutputInfo{
+            KWin::VirtualBackend::OutputInfo info{
                 .geometry = QRect(QPoint(), initialWindowSize),
                 .scale = outputScale,
-            });
+            };
+            if (simulatedTiming) {
+                uint64_t refreshRate = 60000;
+                if (!refreshRates.isEmpty()) {
+                    refreshRate = std::max(1.0, std::round(refreshRates[i % refreshRates.size()].toDouble() * 1000));
+                }
+                info.modes = {
+                    std::make_tuple(initialWindowSize * outputScale, refreshRate, KWin::OutputMode::Flag::Preferred),
+                };
+                if (minVrrRefreshRate) {
+                    info.minVrrRefreshRateHz = *minVrrRefreshRate;
+                }
+                // spread the vblanks of the outputs over the refresh cycle
+                const std::chrono::nanoseconds refreshInterval(1'000'000'000'000ull / refreshRate);
+                info.vblankPhase = refreshInterval * i / outputCount;
+                info.vblankJitter = vblankJitter;
+                info.commitLatency = commitLatency;
+            }
+            outputBackend->addOutput(info);
         }
         a.setSession(KWin::Session::create(KWin::Session::Type::Noop));
         a.setOutputBackend(std::move(outputBackend));
@@ -553,6 +658,7 @@ int main(int argc, char *argv[])
             .outputScale = outputScale,
             .outputSize = initialWindowSize,
             .fullscreen = fullscreen,
+            .forwardSurfaces = parser.isSet(forwardSurfacesOption),
         }));
         break;
     }
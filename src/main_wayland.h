@@ -8,6 +8,7 @@
 */
 #pragma once
 #include "main.h"
+#include "startuptimeline.h"
 #include <KConfigWatcher>
 #include <QTimer>
 
@@ -90,6 +91,7 @@ private:
     std::vector<FileDescriptor> m_xwaylandFds;
 #endif
     KConfigWatcher::Ptr m_settingsWatcher;
+    StartupTimeline m_startupTimeline;
 };
 
 }
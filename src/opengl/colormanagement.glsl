@@ -29,6 +29,15 @@ uniform float maxDestinationLuminance;
 uniform mat4 destinationToLMS;
 uniform mat4 lmsToDestination;
 
+/**
+ * maps PQ encoded intensity to the tone mapped intensity
+ */
+uniform sampler2D tonemappingLut;
+/**
+ * the number of entries in tonemappingLut, 0 if the curve is computed per pixel instead
+ */
+uniform int tonemappingLutSize;
+
 vec3 linearToPq(vec3 linear) {
     const float c1 = 0.8359375;
     const float c2 = 18.8515625;
@@ -117,18 +126,28 @@ vec3 doTonemapping(vec3 color) {
     vec3 lms = (destinationToLMS * vec4(color, 1.0)).rgb;
     vec3 lms_PQ = linearToPq(lms / 10000.0);
     vec3 ICtCp = toICtCp * lms_PQ;
-    float luminance = singlePqToLinear(ICtCp.r) * 10000.0;
-
-    // apply tone mapping operation (modified Reinhart)
-    float relativeLuminance = max(luminance / destinationReferenceLuminance, 0.0);
-    float inputRange = maxTonemappingLuminance / destinationReferenceLuminance;
-    float outputRange = maxDestinationLuminance / destinationReferenceLuminance;
-    float v = (outputRange * (1.0 + inputRange) - inputRange) / pow(inputRange, 2.0);
-    relativeLuminance = relativeLuminance * (1.0 + relativeLuminance * v) / (1.0 + relativeLuminance);
-    luminance = relativeLuminance * destinationReferenceLuminance;
+    if (tonemappingLutSize > 0) {
+        float size = float(tonemappingLutSize);
+        vec2 lutCoordinate = vec2((clamp(ICtCp.r, 0.0, 1.0) * (size - 1.0) + 0.5) / size, 0.5);
+#if __VERSION__ >= 130
+        ICtCp.r = texture(tonemappingLut, lutCoordinate).r;
+#else
+        ICtCp.r = texture2D(tonemappingLut, lutCoordinate).r;
+#endif
+    } else {
+        float luminance = singlePqToLinear(ICtCp.r) * 10000.0;
+
+        // apply tone mapping operation (modified Reinhart)
+        float relativeLuminance = max(luminance / destinationReferenceLuminance, 0.0);
+        float inputRange = maxTonemappingLuminance / destinationReferenceLuminance;
+        float outputRange = maxDestinationLuminance / destinationReferenceLuminance;
+        float v = (outputRange * (1.0 + inputRange) - inputRange) / pow(inputRange, 2.0);
+        relativeLuminance = relativeLuminance * (1.0 + relativeLuminance * v) / (1.0 + relativeLuminance);
+        luminance = relativeLuminance * destinationReferenceLuminance;
+        ICtCp.r = singleLinearToPq(luminance / 10000.0);
+    }
 
     // convert back to rgb
-    ICtCp.r = singleLinearToPq(luminance / 10000.0);
     color = (lmsToDestination * vec4(pqToLinear(fromICtCp * ICtCp), 1.0)).rgb * 10000.0;
     // and clip, to ensure out-of-gamut values are clipped to the correct white point
     return clamp(color, vec3(0.0), vec3(maxDestinationLuminance));
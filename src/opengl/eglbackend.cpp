@@ -14,6 +14,7 @@
 #include "main.h"
 #include "opengl/eglimagetexture.h"
 #include "opengl/eglutils_p.h"
+#include "opengl/glshadermanager.h"
 #include "utils/common.h"
 #include "utils/drm_format_helper.h"
 #include "wayland/drmclientbuffer.h"
@@ -268,7 +269,11 @@ bool EglBackend::createContext(EGLConfig config)
         return false;
     }
     m_context = EglContext::create(m_display, config, s_globalShareContext ? s_globalShareContext->handle() : EGL_NO_CONTEXT);
-    return m_context != nullptr;
+    if (!m_context) {
+        return false;
+    }
+    m_context->shaderManager()->warmCache();
+    return true;
 }
 
 QList<LinuxDmaBufV1Feedback::Tranche> EglBackend::tranches() const
@@ -320,6 +325,70 @@ EGLImageKHR EglBackend::importBufferAsImage(GraphicsBuffer *buffer)
     return image;
 }
 
+static std::optional<DmaBufAttributes> wrapShmBuffer(const ShmAttributes &attributes)
+{
+#if defined(Q_OS_LINUX)
+    static const FileDescriptor device(open("/dev/udmabuf", O_RDWR | O_CLOEXEC));
+    if (!device.isValid()) {
+        return std::nullopt;
+    }
+
+    // The udmabuf must start at a page boundary, the buffer doesn't have to
+    const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    const uint64_t start = attributes.offset & ~(pageSize - 1);
+    const uint64_t end = attributes.offset + uint64_t(attributes.stride) * attributes.size.height();
+    udmabuf_create request{
+        .memfd = uint32_t(attributes.fd.get()),
+        .flags = UDMABUF_FLAGS_CLOEXEC,
+        .offset = start,
+        .size = (end - start + pageSize - 1) & ~(pageSize - 1),
+    };
+    FileDescriptor fd(ioctl(device.get(), UDMABUF_CREATE, &request));
+    if (!fd.isValid()) {
+        return std::nullopt;
+    }
+
+    DmaBufAttributes dmabuf{
+        .planeCount = 1,
+        .width = attributes.size.width(),
+        .height = attributes.size.height(),
+        .format = attributes.format,
+        .modifier = DRM_FORMAT_MOD_LINEAR,
+    };
+    dmabuf.fd[0] = std::move(fd);
+    dmabuf.offset[0] = attributes.offset - start;
+    dmabuf.pitch[0] = attributes.stride;
+    return dmabuf;
+#else
+    return std::nullopt;
+#endif
+}
+
+EGLImageKHR EglBackend::importShmBufferAsImage(GraphicsBuffer *buffer)
+{
+    auto key = std::pair(buffer, 0);
+    auto it = m_importedBuffers.constFind(key);
+    if (Q_LIKELY(it != m_importedBuffers.constEnd())) {
+        return *it;
+    }
+
+    Q_ASSERT(buffer->shmAttributes());
+    const auto dmabuf = wrapShmBuffer(*buffer->shmAttributes());
+    if (!dmabuf) {
+        return EGL_NO_IMAGE_KHR;
+    }
+
+    EGLImageKHR image = importDmaBufAsImage(*dmabuf);
+    if (image != EGL_NO_IMAGE_KHR) {
+        m_importedBuffers[key] = image;
+        connect(buffer, &QObject::destroyed, this, [this, key]() {
+            m_display->destroyImage(m_importedBuffers.take(key));
+        });
+    }
+
+    return image;
+}
+
 EGLImageKHR EglBackend::importDmaBufAsImage(const DmaBufAttributes &dmabuf) const
 {
     return m_display->importDmaBufAsImage(dmabuf);
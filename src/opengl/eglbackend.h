@@ -82,6 +82,12 @@ public:
     EGLImageKHR importDmaBufAsImage(const DmaBufAttributes &attributes, int plane, int format, const QSize &size) const;
     EGLImageKHR importBufferAsImage(GraphicsBuffer *buffer);
     EGLImageKHR importBufferAsImage(GraphicsBuffer *buffer, int plane, int format, const QSize &size);
+    /**
+     * Imports the memory of the shm @a buffer with udmabuf so it can be sampled without
+     * copying it to a texture first. This works only if the pool of the buffer is a memfd
+     * that can't shrink, and if the driver supports linear buffers of that format.
+     */
+    EGLImageKHR importShmBufferAsImage(GraphicsBuffer *buffer);
 
 protected:
     EglBackend();
@@ -7,13 +7,17 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "eglcontext.h"
+#include "core/gpumemory.h"
 #include "core/graphicsbuffer.h"
 #include "egldisplay.h"
 #include "eglimagetexture.h"
+#include "eglswapchain.h"
 #include "glframebuffer.h"
+#include "glpassprofiler.h"
 #include "glplatform.h"
 #include "glshader.h"
 #include "glshadermanager.h"
+#include "gluploadbuffer.h"
 #include "glvertexbuffer.h"
 #include "glvertexbuffer_p.h"
 #include "opengl/egl_context_attribute_builder.h"
@@ -23,12 +27,14 @@
 #include "utils/drm_format_helper.h"
 
 #include <QOpenGLContext>
+#include <atomic>
 #include <drm_fourcc.h>
 
 namespace KWin
 {
 
 EglContext *EglContext::s_currentContext = nullptr;
+static std::atomic<uint64_t> s_blockingWaits = 0;
 
 std::unique_ptr<EglContext> EglContext::create(EglDisplay *display, EGLConfig config, ::EGLContext sharedContext)
 {
@@ -127,6 +133,7 @@ EglContext::EglContext(EglDisplay *display, EGLConfig config, ::EGLContext conte
     , m_haveSyncFences((m_isOpenglES && hasVersion(Version(3, 0))) || (!m_isOpenglES && hasVersion(Version(3, 2))) || hasOpenglExtension(QByteArrayLiteral("GL_ARB_sync")))
     , m_supportsIndexedQuads(checkIndexedQuads(this))
     , m_supportsPackInvert(hasOpenglExtension(QByteArrayLiteral("GL_MESA_pack_invert")))
+    , m_supportsComputeShaders((m_isOpenglES ? hasVersion(Version(3, 1)) : hasVersion(Version(4, 3))) || (hasOpenglExtension(QByteArrayLiteral("GL_ARB_compute_shader")) && hasOpenglExtension(QByteArrayLiteral("GL_ARB_shader_image_load_store"))))
     , m_glPlatform(std::make_unique<GLPlatform>(m_versionString, m_glslVersionString, m_renderer, m_vendor))
     , m_display(display)
     , m_handle(context)
@@ -134,6 +141,7 @@ EglContext::EglContext(EglDisplay *display, EGLConfig config, ::EGLContext conte
     , m_shaderManager(std::make_unique<ShaderManager>())
     , m_streamingBuffer(std::make_unique<GLVertexBuffer>(GLVertexBuffer::Stream))
     , m_indexBuffer(std::make_unique<IndexBuffer>())
+    , m_swapchainPool(std::make_unique<EglSwapchainPool>())
 {
     glResolveFunctions(&getProcAddress);
     initDebugOutput();
@@ -141,6 +149,14 @@ EglContext::EglContext(EglDisplay *display, EGLConfig config, ::EGLContext conte
         if (qgetenv("KWIN_PERSISTENT_VBO") != QByteArrayLiteral("0")) {
             m_streamingBuffer->setPersistent();
         }
+        // Pixel unpack buffers are not available in OpenGL ES 2.0
+        const bool havePixelBuffers = !isOpenGLES() || hasVersion(Version(3, 0));
+        if (havePixelBuffers && qgetenv("KWIN_PERSISTENT_PBO") != QByteArrayLiteral("0")) {
+            m_uploadBuffer = std::make_unique<GLUploadBuffer>();
+        }
+    }
+    if (m_supportsTimerQueries) {
+        m_passProfiler = std::make_unique<GLPassProfiler>(this);
     }
     // It is not legal to not have a vertex array object bound in a core context
     // to make code handling old and new OpenGL versions easier, bind a dummy vao that's used for everything
@@ -148,10 +164,20 @@ EglContext::EglContext(EglDisplay *display, EGLConfig config, ::EGLContext conte
         glGenVertexArrays(1, &m_vao);
         glBindVertexArray(m_vao);
     }
+    m_trimConnection = QObject::connect(GpuMemoryAccounting::self(), &GpuMemoryAccounting::trimRequested, [this]() {
+        EglContext *previous = currentContext();
+        if (makeCurrent()) {
+            m_swapchainPool->clear();
+            if (previous && previous != this) {
+                previous->makeCurrent();
+            }
+        }
+    });
 }
 
 EglContext::~EglContext()
 {
+    QObject::disconnect(m_trimConnection);
     const bool current = makeCurrent();
     if (m_vao && current) {
         glDeleteVertexArrays(1, &m_vao);
@@ -159,6 +185,9 @@ EglContext::~EglContext()
     m_shaderManager.reset();
     m_streamingBuffer.reset();
     m_indexBuffer.reset();
+    m_uploadBuffer.reset();
+    m_passProfiler.reset();
+    m_swapchainPool.reset();
     doneCurrent();
     eglDestroyContext(m_display->handle(), m_handle);
 }
@@ -219,11 +248,16 @@ static inline bool shouldUseOpenGLES()
     return QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES;
 }
 
-::EGLContext EglContext::createContext(EglDisplay *display, EGLConfig config, ::EGLContext sharedContext)
+::EGLContext EglContext::createSharedContext() const
+{
+    return createContext(m_display, m_config, m_handle, false);
+}
+
+::EGLContext EglContext::createContext(EglDisplay *display, EGLConfig config, ::EGLContext sharedContext, bool highPriority)
 {
     const bool haveRobustness = display->hasExtension(QByteArrayLiteral("EGL_EXT_create_context_robustness"));
     const bool haveCreateContext = display->hasExtension(QByteArrayLiteral("EGL_KHR_create_context"));
-    const bool haveContextPriority = display->hasExtension(QByteArrayLiteral("EGL_IMG_context_priority"));
+    const bool haveContextPriority = highPriority && display->hasExtension(QByteArrayLiteral("EGL_IMG_context_priority"));
     const bool haveResetOnVideoMemoryPurge = display->hasExtension(QByteArrayLiteral("EGL_NV_robustness_video_memory_purge"));
 
     std::vector<std::unique_ptr<AbstractOpenGLContextAttributeBuilder>> candidates;
@@ -456,6 +490,11 @@ bool EglContext::supportsPackInvert() const
     return m_supportsPackInvert;
 }
 
+bool EglContext::supportsComputeShaders() const
+{
+    return m_supportsComputeShaders;
+}
+
 ShaderManager *EglContext::shaderManager() const
 {
     return m_shaderManager.get();
@@ -471,6 +510,21 @@ IndexBuffer *EglContext::indexBuffer() const
     return m_indexBuffer.get();
 }
 
+GLUploadBuffer *EglContext::uploadBuffer() const
+{
+    return m_uploadBuffer.get();
+}
+
+GLPassProfiler *EglContext::passProfiler() const
+{
+    return m_passProfiler.get();
+}
+
+EglSwapchainPool *EglContext::swapchainPool() const
+{
+    return m_swapchainPool.get();
+}
+
 GLPlatform *EglContext::glPlatform() const
 {
     return m_glPlatform.get();
@@ -503,6 +557,17 @@ EglContext *EglContext::currentContext()
     return s_currentContext;
 }
 
+void EglContext::finish()
+{
+    s_blockingWaits++;
+    glFinish();
+}
+
+uint64_t EglContext::blockingWaitCount()
+{
+    return s_blockingWaits;
+}
+
 void EglContext::glResolveFunctions(const std::function<resolveFuncPtr(const char *)> &resolveFunction)
 {
     const bool haveArbRobustness = hasOpenglExtension(QByteArrayLiteral("GL_ARB_robustness"));
@@ -13,6 +13,7 @@
 
 #include <QByteArray>
 #include <QList>
+#include <QMetaObject>
 #include <QStack>
 #include <epoxy/egl.h>
 
@@ -22,6 +23,9 @@ namespace KWin
 class EglDisplay;
 class ShaderManager;
 class IndexBuffer;
+class GLUploadBuffer;
+class GLPassProfiler;
+class EglSwapchainPool;
 class GLPlatform;
 class GLFramebuffer;
 struct DmaBufAttributes;
@@ -73,9 +77,13 @@ public:
     bool haveBufferStorage() const;
     bool haveSyncFences() const;
     bool supportsPackInvert() const;
+    bool supportsComputeShaders() const;
     ShaderManager *shaderManager() const;
     GLVertexBuffer *streamingVbo() const;
     IndexBuffer *indexBuffer() const;
+    GLUploadBuffer *uploadBuffer() const;
+    GLPassProfiler *passProfiler() const;
+    EglSwapchainPool *swapchainPool() const;
     GLPlatform *glPlatform() const;
     QSet<QByteArray> openglExtensions() const;
 
@@ -93,11 +101,25 @@ public:
     GLFramebuffer *popFramebuffer();
     GLFramebuffer *currentFramebuffer();
 
+    /**
+     * Creates a bare context with normal priority that shares objects with this context, for
+     * example to do work on another thread. The caller takes ownership of the context.
+     */
+    ::EGLContext createSharedContext() const;
+
+    /**
+     * Blocks until the GPU has finished all work of the current context. This is the last
+     * resort when there is no fence to synchronize with, every call is counted so that the
+     * remaining stalls can be found in the support information.
+     */
+    static void finish();
+    static uint64_t blockingWaitCount();
+
     static EglContext *currentContext();
     static std::unique_ptr<EglContext> create(EglDisplay *display, EGLConfig config, ::EGLContext sharedContext);
 
 private:
-    static ::EGLContext createContext(EglDisplay *display, EGLConfig config, ::EGLContext sharedContext);
+    static ::EGLContext createContext(EglDisplay *display, EGLConfig config, ::EGLContext sharedContext, bool highPriority = true);
     bool checkTimerQuerySupport() const;
     void setShaderManager(ShaderManager *manager);
     void setStreamingBuffer(GLVertexBuffer *vbo);
@@ -130,6 +152,7 @@ private:
     const bool m_haveSyncFences;
     const bool m_supportsIndexedQuads;
     const bool m_supportsPackInvert;
+    const bool m_supportsComputeShaders;
     const std::unique_ptr<GLPlatform> m_glPlatform;
     glGetGraphicsResetStatus_func m_glGetGraphicsResetStatus = nullptr;
     glReadnPixels_func m_glReadnPixels = nullptr;
@@ -142,6 +165,10 @@ private:
     std::unique_ptr<ShaderManager> m_shaderManager;
     std::unique_ptr<GLVertexBuffer> m_streamingBuffer;
     std::unique_ptr<IndexBuffer> m_indexBuffer;
+    std::unique_ptr<GLUploadBuffer> m_uploadBuffer;
+    std::unique_ptr<GLPassProfiler> m_passProfiler;
+    std::unique_ptr<EglSwapchainPool> m_swapchainPool;
+    QMetaObject::Connection m_trimConnection;
     QStack<GLFramebuffer *> m_fbos;
     uint32_t m_vao = 0;
 };
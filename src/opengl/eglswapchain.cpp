@@ -20,10 +20,26 @@
 namespace KWin
 {
 
+static qsizetype bufferByteSize(const GraphicsBuffer *buffer)
+{
+    const DmaBufAttributes *attributes = buffer->dmabufAttributes();
+    qsizetype ret = 0;
+    for (int i = 0; i < attributes->planeCount; i++) {
+        ret += qsizetype(attributes->pitch[i]) * attributes->height;
+    }
+    return ret;
+}
+
+static qsizetype slotByteSize(const EglSwapchainSlot *slot)
+{
+    return bufferByteSize(slot->buffer());
+}
+
 EglSwapchainSlot::EglSwapchainSlot(GraphicsBuffer *buffer, std::unique_ptr<GLFramebuffer> &&framebuffer, const std::shared_ptr<GLTexture> &texture)
     : m_buffer(buffer)
     , m_framebuffer(std::move(framebuffer))
     , m_texture(texture)
+    , m_allocation(GpuMemoryCategory::Swapchain, bufferByteSize(buffer))
 {
 }
 
@@ -90,6 +106,9 @@ EglSwapchain::EglSwapchain(GraphicsBufferAllocator *allocator, EglContext *conte
 
 EglSwapchain::~EglSwapchain()
 {
+    for (const auto &slot : std::as_const(m_slots)) {
+        m_context->swapchainPool()->add(m_allocator, slot);
+    }
 }
 
 QSize EglSwapchain::size() const
@@ -116,22 +135,36 @@ std::shared_ptr<EglSwapchainSlot> EglSwapchain::acquire()
         return *it;
     }
 
-    GraphicsBuffer *buffer = m_allocator->allocate(GraphicsBufferOptions{
+    auto slot = allocateSlot();
+    if (!slot) {
+        return nullptr;
+    }
+    m_slots.append(slot);
+    return slot;
+}
+
+std::shared_ptr<EglSwapchainSlot> EglSwapchain::allocateSlot()
+{
+    if (auto slot = m_context->swapchainPool()->take(m_allocator, m_size, m_format, {m_modifier})) {
+        return slot;
+    }
+
+    const GraphicsBufferOptions options{
         .size = m_size,
         .format = m_format,
         .modifiers = {m_modifier},
-    });
+    };
+    GraphicsBuffer *buffer = m_allocator->allocate(options);
     if (!buffer) {
-        qCWarning(KWIN_OPENGL) << "Failed to allocate an egl gbm swapchain graphics buffer";
-        return nullptr;
+        // try again after dropping whatever caches hold on to
+        GpuMemoryAccounting::self()->trim();
+        buffer = m_allocator->allocate(options);
     }
-
-    auto slot = EglSwapchainSlot::create(m_context, buffer);
-    if (!slot) {
+    if (!buffer) {
+        qCWarning(KWIN_OPENGL) << "Failed to allocate an egl gbm swapchain graphics buffer";
         return nullptr;
     }
-    m_slots.append(slot);
-    return slot;
+    return EglSwapchainSlot::create(m_context, buffer);
 }
 
 void EglSwapchain::release(std::shared_ptr<EglSwapchainSlot> slot, FileDescriptor &&releaseFence)
@@ -159,6 +192,10 @@ std::shared_ptr<EglSwapchain> EglSwapchain::create(GraphicsBufferAllocator *allo
         return nullptr;
     }
 
+    if (const auto slot = context->swapchainPool()->take(allocator, size, format, modifiers)) {
+        return std::make_shared<EglSwapchain>(allocator, context, size, format, slot->buffer()->dmabufAttributes()->modifier, slot);
+    }
+
     // The seed graphics buffer is used to fixate modifiers.
     GraphicsBuffer *seed = allocator->allocate(GraphicsBufferOptions{
         .size = size,
@@ -180,4 +217,53 @@ std::shared_ptr<EglSwapchain> EglSwapchain::create(GraphicsBufferAllocator *allo
                                           first);
 }
 
+// Enough for a few 4K buffers in both an SDR and an HDR format
+static const qsizetype s_swapchainPoolBudget = 256 * 1024 * 1024;
+
+void EglSwapchainPool::add(GraphicsBufferAllocator *allocator, const std::shared_ptr<EglSwapchainSlot> &slot)
+{
+    const qsizetype byteSize = slotByteSize(slot.get());
+    if (byteSize > s_swapchainPoolBudget) {
+        return;
+    }
+    // The contents won't match whatever is going to be painted next
+    slot->m_age = 0;
+    m_entries.push_back(Entry{
+        .allocator = allocator,
+        .slot = slot,
+        .byteSize = byteSize,
+    });
+    m_byteSize += byteSize;
+    while (m_byteSize > s_swapchainPoolBudget) {
+        m_byteSize -= m_entries.front().byteSize;
+        m_entries.pop_front();
+    }
+}
+
+std::shared_ptr<EglSwapchainSlot> EglSwapchainPool::take(GraphicsBufferAllocator *allocator, const QSize &size, uint32_t format, const QList<uint64_t> &modifiers)
+{
+    // Prefer the most recently returned slots, they're the most likely to be still cached
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        const DmaBufAttributes *attributes = it->slot->buffer()->dmabufAttributes();
+        if (it->allocator != allocator
+            || it->slot->buffer()->size() != size
+            || attributes->format != format
+            || !modifiers.contains(attributes->modifier)
+            || it->slot->isBusy()) {
+            continue;
+        }
+        auto slot = std::move(it->slot);
+        m_byteSize -= it->byteSize;
+        m_entries.erase(std::next(it).base());
+        return slot;
+    }
+    return nullptr;
+}
+
+void EglSwapchainPool::clear()
+{
+    m_entries.clear();
+    m_byteSize = 0;
+}
+
 } // namespace KWin
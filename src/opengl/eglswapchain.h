@@ -8,6 +8,7 @@
 */
 #pragma once
 
+#include "core/gpumemory.h"
 #include "kwin_export.h"
 #include "utils/filedescriptor.h"
 
@@ -15,6 +16,7 @@
 #include <QSize>
 
 #include <cstdint>
+#include <deque>
 #include <epoxy/egl.h>
 #include <memory>
 
@@ -48,7 +50,9 @@ private:
     std::shared_ptr<GLTexture> m_texture;
     int m_age = 0;
     FileDescriptor m_releaseFd;
+    GpuMemoryAllocation m_allocation;
     friend class EglSwapchain;
+    friend class EglSwapchainPool;
 };
 
 class KWIN_EXPORT EglSwapchain
@@ -69,6 +73,8 @@ public:
     static std::shared_ptr<EglSwapchain> create(GraphicsBufferAllocator *allocator, EglContext *context, const QSize &size, uint32_t format, const QList<uint64_t> &modifiers);
 
 private:
+    std::shared_ptr<EglSwapchainSlot> allocateSlot();
+
     GraphicsBufferAllocator *m_allocator;
     EglContext *m_context;
     QSize m_size;
@@ -77,4 +83,36 @@ private:
     QList<std::shared_ptr<EglSwapchainSlot>> m_slots;
 };
 
+/**
+ * The EglSwapchainPool class keeps the slots of destroyed swapchains of a context around, so
+ * that switching back and forth between sizes, formats or modifiers, e.g. when toggling HDR or
+ * changing the mode, doesn't have to allocate and import new buffers every time.
+ *
+ * The least recently returned slots are dropped once the pool exceeds its memory budget.
+ */
+class KWIN_EXPORT EglSwapchainPool
+{
+public:
+    void add(GraphicsBufferAllocator *allocator, const std::shared_ptr<EglSwapchainSlot> &slot);
+    /**
+     * Returns an idle slot with the given properties and one of the @a modifiers, if there's one.
+     */
+    std::shared_ptr<EglSwapchainSlot> take(GraphicsBufferAllocator *allocator, const QSize &size, uint32_t format, const QList<uint64_t> &modifiers);
+    /**
+     * Drops all slots, e.g. when running out of GPU memory.
+     */
+    void clear();
+
+private:
+    struct Entry
+    {
+        GraphicsBufferAllocator *allocator;
+        std::shared_ptr<EglSwapchainSlot> slot;
+        qsizetype byteSize;
+    };
+
+    std::deque<Entry> m_entries;
+    qsizetype m_byteSize = 0;
+};
+
 } // namespace KWin
@@ -0,0 +1,138 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "glasyncupload.h"
+#include "gltexture.h"
+
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include <cstring>
+
+namespace KWin
+{
+
+// Smaller updates are copied on the compositor thread when the texture is updated.
+static const qsizetype s_minimumAsyncUploadSize = 1024 * 1024;
+
+static QThreadPool *uploadThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(2);
+        pool->setObjectName(QStringLiteral("KWin texture upload"));
+        return pool;
+    }();
+    return pool;
+}
+
+static qsizetype alignedChunkSize(const QRect &rect, int bytesPerPixel)
+{
+    return (qsizetype(rect.width()) * bytesPerPixel * rect.height() + 63) & ~qsizetype(63);
+}
+
+GLAsyncUpload::GLAsyncUpload(GLUploadBuffer *buffer, const GLUploadBuffer::Range &range)
+    : m_buffer(buffer)
+    , m_range(range)
+{
+}
+
+GLAsyncUpload::~GLAsyncUpload()
+{
+    m_copy.waitForFinished();
+    if (!m_finished) {
+        m_buffer->fence(m_range);
+    }
+}
+
+std::unique_ptr<GLAsyncUpload> GLAsyncUpload::start(const QImage &image, const QRegion &region)
+{
+    GLUploadBuffer *buffer = GLUploadBuffer::streamingBuffer();
+    if (!buffer || image.isNull()) {
+        return nullptr;
+    }
+
+    const GLTexture::UploadFormat format = GLTexture::uploadFormat(image.format());
+    if (format.imageFormat != image.format()) {
+        return nullptr;
+    }
+
+    const int bytesPerPixel = image.depth() / 8;
+    qsizetype size = 0;
+    for (const QRect &rect : region) {
+        size += alignedChunkSize(rect, bytesPerPixel);
+    }
+    if (size < s_minimumAsyncUploadSize) {
+        return nullptr;
+    }
+
+    const auto range = buffer->map(size);
+    if (!range) {
+        return nullptr;
+    }
+
+    std::unique_ptr<GLAsyncUpload> upload(new GLAsyncUpload(buffer, *range));
+    upload->m_region = region;
+    upload->m_format = format.format;
+    upload->m_type = format.type;
+
+    qsizetype offset = 0;
+    for (const QRect &rect : region) {
+        upload->m_chunks.append(Chunk{
+            .rect = rect,
+            .offset = offset,
+        });
+        offset += alignedChunkSize(rect, bytesPerPixel);
+    }
+
+    upload->m_copy = QtConcurrent::run(uploadThreadPool(), [image, chunks = upload->m_chunks, data = range->data, bytesPerPixel]() {
+        for (const Chunk &chunk : chunks) {
+            const qsizetype rowSize = qsizetype(chunk.rect.width()) * bytesPerPixel;
+            uint8_t *dst = data + chunk.offset;
+            const uchar *src = image.constScanLine(chunk.rect.y()) + qsizetype(chunk.rect.x()) * bytesPerPixel;
+            for (int y = 0; y < chunk.rect.height(); ++y) {
+                std::memcpy(dst, src, rowSize);
+                dst += rowSize;
+                src += image.bytesPerLine();
+            }
+        }
+    });
+
+    return upload;
+}
+
+QRegion GLAsyncUpload::region() const
+{
+    return m_region;
+}
+
+void GLAsyncUpload::finish(GLTexture *texture, const QPoint &offset)
+{
+    if (m_finished) {
+        return;
+    }
+
+    m_copy.waitForFinished();
+    m_finished = true;
+
+    texture->bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    m_buffer->bind();
+
+    for (const Chunk &chunk : std::as_const(m_chunks)) {
+        glTexSubImage2D(texture->target(), 0, offset.x() + chunk.rect.x(), offset.y() + chunk.rect.y(), chunk.rect.width(), chunk.rect.height(),
+                        m_format, m_type, reinterpret_cast<const GLvoid *>(m_range.offset + chunk.offset));
+    }
+
+    m_buffer->unbind();
+    m_buffer->fence(m_range);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    texture->unbind();
+}
+
+} // namespace KWin
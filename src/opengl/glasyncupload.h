@@ -0,0 +1,73 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "opengl/gluploadbuffer.h"
+
+#include <QFuture>
+#include <QImage>
+#include <QList>
+#include <QRegion>
+
+#include <memory>
+
+namespace KWin
+{
+
+class GLTexture;
+
+/**
+ * The GLAsyncUpload class copies pixels of an image into the upload buffer on a worker
+ * thread, so that a texture can later be updated from them without touching the image.
+ *
+ * This is meant for big updates of client buffers in shared memory, where copying the
+ * pixels takes a noticeable amount of time. The copy is started when the buffer is
+ * committed and the texture is updated when the next frame is prepared.
+ */
+class KWIN_EXPORT GLAsyncUpload
+{
+public:
+    ~GLAsyncUpload();
+
+    /**
+     * Starts copying the @a region of @a image. The pixels of the image must stay valid until
+     * the upload is finished or destroyed.
+     *
+     * Returns @c null if the image can't be uploaded without a conversion, the region is too
+     * small to be worth it, or the upload buffer is not available.
+     */
+    static std::unique_ptr<GLAsyncUpload> start(const QImage &image, const QRegion &region);
+
+    QRegion region() const;
+
+    /**
+     * Waits until the pixels have been copied and updates the @a texture with them.
+     */
+    void finish(GLTexture *texture, const QPoint &offset = QPoint());
+
+private:
+    struct Chunk
+    {
+        QRect rect;
+        intptr_t offset;
+    };
+
+    GLAsyncUpload(GLUploadBuffer *buffer, const GLUploadBuffer::Range &range);
+
+    GLUploadBuffer *m_buffer;
+    GLUploadBuffer::Range m_range;
+    QRegion m_region;
+    QList<Chunk> m_chunks;
+    GLenum m_format = 0;
+    GLenum m_type = 0;
+    QFuture<void> m_copy;
+    bool m_finished = false;
+};
+
+} // namespace KWin
@@ -163,6 +163,7 @@ void GLFramebuffer::initDepthStencilAttachment()
         } else {
             m_depthBuffer = buffer;
             m_stencilBuffer = buffer;
+            m_depthStencilAllocation = GpuMemoryAllocation(GpuMemoryCategory::Renderbuffer, uint64_t(m_size.width()) * m_size.height() * 4);
             return;
         }
     }
@@ -188,6 +189,7 @@ void GLFramebuffer::initDepthStencilAttachment()
     } else {
         m_depthBuffer = buffer;
     }
+    uint64_t byteSize = m_depthBuffer ? uint64_t(m_size.width()) * m_size.height() * (depthFormat == GL_DEPTH_COMPONENT16 ? 2 : 4) : 0;
 
     // Try to attach a stencil attachment separately.
     GLenum stencilFormat;
@@ -205,6 +207,10 @@ void GLFramebuffer::initDepthStencilAttachment()
         glDeleteRenderbuffers(1, &buffer);
     } else {
         m_stencilBuffer = buffer;
+        byteSize += uint64_t(m_size.width()) * m_size.height();
+    }
+    if (byteSize) {
+        m_depthStencilAllocation = GpuMemoryAllocation(GpuMemoryCategory::Renderbuffer, byteSize);
     }
 }
 
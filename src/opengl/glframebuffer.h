@@ -9,6 +9,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #pragma once
+#include "core/gpumemory.h"
 #include "kwin_export.h"
 
 #include <QRect>
@@ -123,6 +124,7 @@ protected:
     GLuint m_handle = 0;
     GLuint m_depthBuffer = 0;
     GLuint m_stencilBuffer = 0;
+    GpuMemoryAllocation m_depthStencilAllocation;
     QSize m_size;
     bool m_valid = false;
     bool m_foreign = false;
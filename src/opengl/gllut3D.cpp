@@ -59,6 +59,21 @@ void GlLookUpTable3D::bind()
 
 std::unique_ptr<GlLookUpTable3D> GlLookUpTable3D::create(const std::function<QVector3D(size_t x, size_t y, size_t z)> &mapping, size_t xSize, size_t ySize, size_t zSize)
 {
+    std::vector<QVector3D> samples;
+    samples.reserve(xSize * ySize * zSize);
+    for (size_t z = 0; z < zSize; z++) {
+        for (size_t y = 0; y < ySize; y++) {
+            for (size_t x = 0; x < xSize; x++) {
+                samples.push_back(mapping(x, y, z));
+            }
+        }
+    }
+    return create(samples, xSize, ySize, zSize);
+}
+
+std::unique_ptr<GlLookUpTable3D> GlLookUpTable3D::create(std::span<const QVector3D> samples, size_t xSize, size_t ySize, size_t zSize)
+{
+    Q_ASSERT(samples.size() == xSize * ySize * zSize);
     GLuint handle = 0;
     glGenTextures(1, &handle);
     if (!handle) {
@@ -74,17 +89,12 @@ std::unique_ptr<GlLookUpTable3D> GlLookUpTable3D::create(const std::function<QVe
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     QVector<float> data;
-    data.reserve(4 * xSize * ySize * zSize);
-    for (size_t z = 0; z < zSize; z++) {
-        for (size_t y = 0; y < ySize; y++) {
-            for (size_t x = 0; x < xSize; x++) {
-                const auto color = mapping(x, y, z);
-                data.push_back(color.x());
-                data.push_back(color.y());
-                data.push_back(color.z());
-                data.push_back(1);
-            }
-        }
+    data.reserve(4 * samples.size());
+    for (const QVector3D &color : samples) {
+        data.push_back(color.x());
+        data.push_back(color.y());
+        data.push_back(color.z());
+        data.push_back(1);
     }
     glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, xSize, ySize, zSize, 0, GL_RGBA, GL_FLOAT, data.data());
     glBindTexture(GL_TEXTURE_3D, 0);
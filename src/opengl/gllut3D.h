@@ -15,6 +15,7 @@
 #include <epoxy/gl.h>
 #include <functional>
 #include <memory>
+#include <span>
 
 namespace KWin
 {
@@ -33,6 +34,10 @@ public:
     void bind();
 
     static std::unique_ptr<GlLookUpTable3D> create(const std::function<QVector3D(size_t x, size_t y, size_t z)> &mapping, size_t xSize, size_t ySize, size_t zSize);
+    /**
+     * Creates a lookup table from the given @a samples, with x being the innermost dimension.
+     */
+    static std::unique_ptr<GlLookUpTable3D> create(std::span<const QVector3D> samples, size_t xSize, size_t ySize, size_t zSize);
 
 private:
     const GLuint m_handle;
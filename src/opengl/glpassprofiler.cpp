@@ -0,0 +1,221 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "glpassprofiler.h"
+#include "eglcontext.h"
+#include "utils/common.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// Frames whose results haven't arrived after this many newer frames are dropped, so that a
+// busy GPU doesn't make the pool grow without bounds.
+static const size_t s_maxPendingFrames = 4;
+
+GLPassProfiler::GLPassProfiler(EglContext *context)
+    : m_context(context)
+{
+}
+
+GLPassProfiler::~GLPassProfiler()
+{
+    if (m_queries.empty()) {
+        return;
+    }
+    if (EglContext::currentContext() != m_context) {
+        qCWarning(KWIN_OPENGL, "Could not delete timestamp queries because the context is not current");
+        return;
+    }
+    glDeleteQueries(m_queries.size(), m_queries.data());
+}
+
+void GLPassProfiler::ref()
+{
+    ++m_users;
+}
+
+void GLPassProfiler::unref()
+{
+    Q_ASSERT(m_users > 0);
+    if (--m_users == 0) {
+        m_results.clear();
+    }
+}
+
+bool GLPassProfiler::isEnabled() const
+{
+    return m_users > 0;
+}
+
+GLuint GLPassProfiler::acquireQuery()
+{
+    if (!m_freeQueries.empty()) {
+        const GLuint query = m_freeQueries.back();
+        m_freeQueries.pop_back();
+        return query;
+    }
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    m_queries.push_back(query);
+    return query;
+}
+
+void GLPassProfiler::releaseQueries(const Frame &frame)
+{
+    for (const Record &record : frame.records) {
+        m_freeQueries.push_back(record.begin);
+        m_freeQueries.push_back(record.end);
+    }
+}
+
+void GLPassProfiler::beginFrame(const QString &name)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    if (m_frame) {
+        endFrame();
+    }
+    m_frame = Frame{
+        .name = name,
+    };
+}
+
+void GLPassProfiler::endFrame()
+{
+    if (!m_frame) {
+        return;
+    }
+    while (!m_openPasses.empty()) {
+        Record &record = m_frame->records[m_openPasses.back()];
+        qCWarning(KWIN_OPENGL) << "GPU pass" << record.name << "has not been ended";
+        record.end = acquireQuery();
+        glQueryCounter(record.end, GL_TIMESTAMP);
+        m_frame->lastQuery = record.end;
+        m_openPasses.pop_back();
+    }
+
+    Frame frame = std::move(*m_frame);
+    m_frame.reset();
+    if (!frame.records.empty()) {
+        m_pendingFrames.push_back(std::move(frame));
+        if (m_pendingFrames.size() > s_maxPendingFrames) {
+            releaseQueries(m_pendingFrames.front());
+            m_pendingFrames.pop_front();
+        }
+    }
+
+    // Another context may have been made current while drawing the frame
+    if (EglContext::currentContext() == m_context) {
+        collectResults();
+    }
+}
+
+void GLPassProfiler::beginPass(QStringView name, QStringView detail)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    if (!m_frame) {
+        m_frame = Frame{
+            .name = name.toString(),
+            .implicit = true,
+        };
+    }
+
+    const GLuint query = acquireQuery();
+    glQueryCounter(query, GL_TIMESTAMP);
+
+    m_openPasses.push_back(m_frame->records.size());
+    m_frame->records.push_back(Record{
+        .name = detail.isEmpty() ? name.toString() : name.toString() + QLatin1Char(' ') + detail,
+        .depth = int(m_openPasses.size()) - 1,
+        .begin = query,
+    });
+}
+
+void GLPassProfiler::endPass()
+{
+    if (!m_frame || m_openPasses.empty()) {
+        return;
+    }
+
+    const GLuint query = acquireQuery();
+    glQueryCounter(query, GL_TIMESTAMP);
+
+    m_frame->records[m_openPasses.back()].end = query;
+    m_frame->lastQuery = query;
+    m_openPasses.pop_back();
+
+    if (m_frame->implicit && m_openPasses.empty()) {
+        endFrame();
+    }
+}
+
+void GLPassProfiler::collectResults()
+{
+    while (!m_pendingFrames.empty()) {
+        const Frame &frame = m_pendingFrames.front();
+
+        // Timestamps are written in order, once the last one is available all of them are
+        GLint available = 0;
+        glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+
+        QList<Pass> passes;
+        passes.reserve(frame.records.size());
+        for (const Record &record : frame.records) {
+            GLint64 begin = 0;
+            GLint64 end = 0;
+            glGetQueryObjecti64v(record.begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjecti64v(record.end, GL_QUERY_RESULT, &end);
+            passes.append(Pass{
+                .name = record.name,
+                .depth = record.depth,
+                .duration = std::chrono::nanoseconds(std::max<GLint64>(end - begin, 0)),
+            });
+        }
+        m_results[frame.name] = passes;
+
+        releaseQueries(frame);
+        m_pendingFrames.pop_front();
+    }
+}
+
+QList<GLPassProfiler::Pass> GLPassProfiler::passes(const QString &frameName) const
+{
+    return m_results.value(frameName);
+}
+
+GLPassProfiler *GLPassProfiler::current()
+{
+    const EglContext *context = EglContext::currentContext();
+    return context ? context->passProfiler() : nullptr;
+}
+
+GLPassScope::GLPassScope(QStringView name, QStringView detail)
+{
+    GLPassProfiler *profiler = GLPassProfiler::current();
+    if (profiler && profiler->isEnabled()) {
+        m_profiler = profiler;
+        m_profiler->beginPass(name, detail);
+    }
+}
+
+GLPassScope::~GLPassScope()
+{
+    if (m_profiler) {
+        m_profiler->endPass();
+    }
+}
+
+} // namespace KWin
@@ -0,0 +1,128 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <epoxy/gl.h>
+
+#include <chrono>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace KWin
+{
+
+class EglContext;
+
+/**
+ * The GLPassProfiler class measures how much GPU time the individual passes of a frame take,
+ * such as painting the background, a window or blurring the area behind it.
+ *
+ * Every pass is surrounded by a pair of timestamp queries taken from a pool. The results are
+ * read back a few frames later, once the GPU is done with them, so measuring never stalls the
+ * compositor. Passes can be nested, but must end in the opposite order they have begun.
+ *
+ * The profiler does nothing unless somebody enabled it with ref().
+ */
+class KWIN_EXPORT GLPassProfiler
+{
+public:
+    struct Pass
+    {
+        QString name;
+        /**
+         * The number of passes that enclose this one.
+         */
+        int depth = 0;
+        std::chrono::nanoseconds duration{0};
+    };
+
+    explicit GLPassProfiler(EglContext *context);
+    ~GLPassProfiler();
+
+    /**
+     * Enables the profiler until unref() has been called as many times.
+     */
+    void ref();
+    void unref();
+    bool isEnabled() const;
+
+    /**
+     * Starts measuring a frame with the given @a name, usually the name of an output. Passes
+     * that begin outside a frame are measured as a frame of their own.
+     */
+    void beginFrame(const QString &name);
+    void endFrame();
+
+    void beginPass(QStringView name, QStringView detail = {});
+    void endPass();
+
+    /**
+     * Returns the passes of the most recent frame with the given @a name whose results have
+     * arrived, in the order they have begun.
+     */
+    QList<Pass> passes(const QString &frameName) const;
+
+    /**
+     * Returns the profiler of the current context, or @c null if timer queries are not
+     * supported.
+     */
+    static GLPassProfiler *current();
+
+private:
+    struct Record
+    {
+        QString name;
+        int depth;
+        GLuint begin;
+        GLuint end = 0;
+    };
+
+    struct Frame
+    {
+        QString name;
+        std::vector<Record> records;
+        GLuint lastQuery = 0;
+        bool implicit = false;
+    };
+
+    GLuint acquireQuery();
+    void releaseQueries(const Frame &frame);
+    void collectResults();
+
+    EglContext *const m_context;
+    int m_users = 0;
+    std::vector<GLuint> m_queries;
+    std::vector<GLuint> m_freeQueries;
+    std::optional<Frame> m_frame;
+    std::vector<size_t> m_openPasses;
+    std::deque<Frame> m_pendingFrames;
+    QHash<QString, QList<Pass>> m_results;
+};
+
+/**
+ * Measures the enclosing scope as a pass of the current profiler, if it's enabled.
+ */
+class KWIN_EXPORT GLPassScope
+{
+public:
+    explicit GLPassScope(QStringView name, QStringView detail = {});
+    ~GLPassScope();
+
+private:
+    GLPassProfiler *m_profiler = nullptr;
+};
+
+} // namespace KWin
@@ -9,11 +9,15 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "glshader.h"
+#include "core/colorpipeline.h"
+#include "gllut.h"
 #include "glplatform.h"
 #include "glutils.h"
 #include "utils/common.h"
+#include "utils/envvar.h"
 
 #include <QFile>
+#include <algorithm>
 
 namespace KWin
 {
@@ -95,7 +99,7 @@ bool GLShader::link()
     return m_valid;
 }
 
-const QByteArray GLShader::prepareSource(GLenum shaderType, const QByteArray &source) const
+QByteArray GLShader::prepareSource(GLenum shaderType, const QByteArray &source)
 {
     // Prepare the source code
     QByteArray ba;
@@ -107,6 +111,9 @@ const QByteArray GLShader::prepareSource(GLenum shaderType, const QByteArray &so
     if (context->isOpenGLES() && context->glslVersion() >= Version(3, 0)) {
         ba.replace("#version 140", "#version 300 es\n\nprecision highp float;\n");
     }
+    if (context->isOpenGLES() && context->glslVersion() >= Version(3, 1)) {
+        ba.replace("#version 430", "#version 310 es\n\nprecision highp float;\n");
+    }
 
     return ba;
 }
@@ -134,7 +141,7 @@ bool GLShader::compile(GLuint program, GLenum shaderType, const QByteArray &sour
     glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 
     if (status == 0) {
-        const char *typeName = (shaderType == GL_VERTEX_SHADER ? "vertex" : "fragment");
+        const char *typeName = shaderType == GL_VERTEX_SHADER ? "vertex" : (shaderType == GL_COMPUTE_SHADER ? "compute" : "fragment");
         qCCritical(KWIN_OPENGL) << "Failed to compile" << typeName << "shader:"
                                 << "\n"
                                 << log;
@@ -155,6 +162,40 @@ bool GLShader::compile(GLuint program, GLenum shaderType, const QByteArray &sour
     return status != 0;
 }
 
+bool GLShader::loadBinary(const GLProgramBinary &binary)
+{
+    m_valid = false;
+
+    glProgramBinary(m_program, binary.format, binary.data.constData(), binary.data.size());
+
+    // The driver may reject the binary, e.g. after it has been updated
+    int status;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    m_valid = status != 0;
+
+    return m_valid;
+}
+
+std::optional<GLProgramBinary> GLShader::binary() const
+{
+    if (!m_valid) {
+        return std::nullopt;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return std::nullopt;
+    }
+
+    GLProgramBinary binary;
+    binary.data.resize(length);
+    glGetProgramBinary(m_program, length, &length, &binary.format, binary.data.data());
+    binary.data.resize(length);
+
+    return binary;
+}
+
 bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSource)
 {
     m_valid = false;
@@ -185,6 +226,17 @@ bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSo
     return link();
 }
 
+bool GLShader::loadCompute(const QByteArray &computeSource)
+{
+    m_valid = false;
+
+    if (!compile(m_program, GL_COMPUTE_SHADER, computeSource)) {
+        return false;
+    }
+
+    return link();
+}
+
 void GLShader::bindAttributeLocation(const char *name, int index)
 {
     glBindAttribLocation(m_program, index, name);
@@ -250,6 +302,8 @@ void GLShader::resolveLocations()
     m_intLocations[IntUniform::SourceNamedTransferFunction] = uniformLocation("sourceNamedTransferFunction");
     m_intLocations[IntUniform::DestinationNamedTransferFunction] = uniformLocation("destinationNamedTransferFunction");
     m_intLocations[IntUniform::Thickness] = uniformLocation("thickness");
+    m_intLocations[IntUniform::TonemappingLut] = uniformLocation("tonemappingLut");
+    m_intLocations[IntUniform::TonemappingLutSize] = uniformLocation("tonemappingLutSize");
 
     m_locationsResolved = true;
 }
@@ -481,10 +535,45 @@ QMatrix4x4 GLShader::getUniformMatrix4x4(const char *name)
 }
 
 static bool s_disableTonemapping = qEnvironmentVariableIntValue("KWIN_DISABLE_TONEMAPPING") == 1;
+// Sampling the tone mapping curve from a LUT saves a bunch of transcendental functions per pixel,
+// which adds up on big HDR screens with integrated GPUs, at the cost of a tiny loss of precision
+static const bool s_useTonemappingLut = environmentVariableBoolValue("KWIN_GL_TONEMAPPING_LUT").value_or(false);
+static const size_t s_tonemappingLutSize = 1024;
+// high enough to not interfere with the textures of the shader itself, like the ICC profile LUTs
+static const int s_tonemappingLutTextureUnit = 5;
+static const size_t s_maxTonemappingLuts = 4;
+
+GlLookUpTable *GLShader::tonemappingLut(double referenceLuminance, double maxInputLuminance, double maxOutputLuminance)
+{
+    const QVector3D parameters(referenceLuminance, maxInputLuminance, maxOutputLuminance);
+    const auto it = std::ranges::find_if(m_tonemappingLuts, [&parameters](const TonemappingLut &lut) {
+        return lut.parameters == parameters;
+    });
+    if (it != m_tonemappingLuts.end()) {
+        return it->lut.get();
+    }
+    // the LUT maps PQ encoded intensity to tone mapped PQ encoded intensity, like ColorTonemapper
+    const ColorTonemapper tonemapper(referenceLuminance, maxInputLuminance, maxOutputLuminance);
+    auto lut = GlLookUpTable::create([&tonemapper](size_t index) {
+        const float mapped = tonemapper.map(index / double(s_tonemappingLutSize - 1));
+        return QVector3D(mapped, mapped, mapped);
+    }, s_tonemappingLutSize);
+    if (!lut) {
+        return nullptr;
+    }
+    if (m_tonemappingLuts.size() >= s_maxTonemappingLuts) {
+        m_tonemappingLuts.erase(m_tonemappingLuts.begin());
+    }
+    m_tonemappingLuts.push_back(TonemappingLut{
+        .parameters = parameters,
+        .lut = std::move(lut),
+    });
+    return m_tonemappingLuts.back().lut.get();
+}
 
 void GLShader::setColorspaceUniforms(const std::shared_ptr<ColorDescription> &src, const std::shared_ptr<ColorDescription> &dst, RenderingIntent intent)
 {
-    setUniform(Mat4Uniform::ColorimetryTransformation, src->toOther(*dst, intent));
+    setUniform(Mat4Uniform::ColorimetryTransformation, ColorConversionCache::lookup(src, dst, intent)->toOther);
     setUniform(IntUniform::SourceNamedTransferFunction, src->transferFunction().type);
     if (src->transferFunction().type == TransferFunction::BT1886) {
         setUniform(Vec2Uniform::SourceTransferFunctionParams, QVector2D(src->transferFunction().bt1886B(), src->transferFunction().bt1886A()));
@@ -499,13 +588,30 @@ void GLShader::setColorspaceUniforms(const std::shared_ptr<ColorDescription> &sr
         setUniform(Vec2Uniform::DestinationTransferFunctionParams, QVector2D(dst->transferFunction().minLuminance, dst->transferFunction().maxLuminance - dst->transferFunction().minLuminance));
     }
     setUniform(FloatUniform::DestinationReferenceLuminance, dst->referenceLuminance());
-    setUniform(FloatUniform::MaxDestinationLuminance, dst->maxHdrLuminance().value_or(10'000));
+    const double maxDestinationLuminance = dst->maxHdrLuminance().value_or(10'000);
+    setUniform(FloatUniform::MaxDestinationLuminance, maxDestinationLuminance);
+    double maxTonemappingLuminance = maxDestinationLuminance;
     if (!s_disableTonemapping && intent == RenderingIntent::Perceptual) {
-        setUniform(FloatUniform::MaxTonemappingLuminance, src->maxHdrLuminance().value_or(src->referenceLuminance()) * dst->referenceLuminance() / src->referenceLuminance());
-    } else {
-        setUniform(FloatUniform::MaxTonemappingLuminance, dst->maxHdrLuminance().value_or(10'000));
+        maxTonemappingLuminance = src->maxHdrLuminance().value_or(src->referenceLuminance()) * dst->referenceLuminance() / src->referenceLuminance();
     }
+    setUniform(FloatUniform::MaxTonemappingLuminance, maxTonemappingLuminance);
     setUniform(Mat4Uniform::DestinationToLMS, dst->containerColorimetry().toLMS());
     setUniform(Mat4Uniform::LMSToDestination, dst->containerColorimetry().fromLMS());
+
+    resolveLocations();
+    GlLookUpTable *lut = nullptr;
+    // same condition as in the shader, with less headroom than that clipping is enough
+    if (s_useTonemappingLut && m_intLocations[IntUniform::TonemappingLutSize] != -1 && maxTonemappingLuminance >= maxDestinationLuminance * 1.01) {
+        lut = tonemappingLut(dst->referenceLuminance(), maxTonemappingLuminance, maxDestinationLuminance);
+    }
+    if (lut) {
+        glActiveTexture(GL_TEXTURE0 + s_tonemappingLutTextureUnit);
+        lut->bind();
+        glActiveTexture(GL_TEXTURE0);
+        setUniform(IntUniform::TonemappingLut, s_tonemappingLutTextureUnit);
+        setUniform(IntUniform::TonemappingLutSize, int(lut->size()));
+    } else {
+        setUniform(IntUniform::TonemappingLutSize, 0);
+    }
 }
 }
@@ -19,9 +19,24 @@
 #include <QVector3D>
 #include <epoxy/gl.h>
 
+#include <memory>
+#include <optional>
+#include <vector>
+
 namespace KWin
 {
 
+class GlLookUpTable;
+
+/**
+ * A linked program as retrieved with glGetProgramBinary().
+ */
+struct GLProgramBinary
+{
+    GLenum format = 0;
+    QByteArray data;
+};
+
 class KWIN_EXPORT GLShader
 {
 public:
@@ -127,6 +142,8 @@ public:
         Sampler,
         Sampler1,
         Thickness,
+        TonemappingLut,
+        TonemappingLutSize,
         IntUniformCount
     };
 
@@ -151,13 +168,25 @@ protected:
     GLShader(unsigned int flags = NoFlags);
     bool loadFromFiles(const QString &vertexfile, const QString &fragmentfile);
     bool load(const QByteArray &vertexSource, const QByteArray &fragmentSource);
-    const QByteArray prepareSource(GLenum shaderType, const QByteArray &sourceCode) const;
+    bool loadCompute(const QByteArray &computeSource);
+    static QByteArray prepareSource(GLenum shaderType, const QByteArray &sourceCode);
     bool compile(GLuint program, GLenum shaderType, const QByteArray &sourceCode) const;
+    bool loadBinary(const GLProgramBinary &binary);
+    std::optional<GLProgramBinary> binary() const;
     void bind();
     void unbind();
     void resolveLocations();
 
 private:
+    GlLookUpTable *tonemappingLut(double referenceLuminance, double maxInputLuminance, double maxOutputLuminance);
+
+    struct TonemappingLut
+    {
+        // reference, max input and max output luminance
+        QVector3D parameters;
+        std::unique_ptr<GlLookUpTable> lut;
+    };
+
     unsigned int m_program;
     bool m_valid : 1;
     bool m_locationsResolved : 1;
@@ -170,6 +199,7 @@ private:
     QHash<FloatUniform, int> m_floatLocations;
     QHash<IntUniform, int> m_intLocations;
     QHash<ColorUniform, int> m_colorLocations;
+    std::vector<TonemappingLut> m_tonemappingLuts;
 
     friend class ShaderManager;
 };
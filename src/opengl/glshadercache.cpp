@@ -0,0 +1,453 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "glshadercache.h"
+#include "eglcontext.h"
+#include "egldisplay.h"
+#include "utils/common.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+static const quint32 s_programMagic = 0x4b575343; // KWSC
+static const quint32 s_programVersion = 1;
+static const quint32 s_sourceMagic = 0x4b575353; // KWSS
+static const quint32 s_sourceVersion = 1;
+
+// Programs that were not used in this many sessions are dropped from the profile
+static const int s_profileWindow = 16;
+// The maximum number of built-in and custom programs each that are warmed at startup
+static const int s_hotSetSize = 32;
+
+static bool supportsProgramBinaries(EglContext *context)
+{
+    const bool supported = context->isOpenGLES()
+        ? context->hasVersion(Version(3, 0))
+        : context->hasVersion(Version(4, 1)) || context->hasOpenglExtension(QByteArrayLiteral("GL_ARB_get_program_binary"));
+    if (!supported) {
+        return false;
+    }
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+ShaderCache::ShaderCache(EglContext *context)
+{
+    if (qEnvironmentVariable("KWIN_SHADER_CACHE") == QLatin1String("0") || !supportsProgramBinaries(context)) {
+        return;
+    }
+
+    QCryptographicHash driver(QCryptographicHash::Sha1);
+    driver.addData(context->vendor());
+    driver.addData(context->renderer());
+    driver.addData(context->openglVersionString());
+    driver.addData(context->glslVersionString());
+
+    m_baseDirectory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kwin/shaders");
+    m_programDirectory = m_baseDirectory + QLatin1Char('/') + QString::fromLatin1(driver.result().toHex().left(16));
+    if (!QDir().mkpath(m_programDirectory)) {
+        qCWarning(KWIN_OPENGL) << "Failed to create shader cache directory" << m_programDirectory;
+        return;
+    }
+
+    if (!QDir().mkpath(m_baseDirectory + QLatin1String("/sources"))) {
+        qCWarning(KWIN_OPENGL) << "Failed to create shader cache directory" << m_baseDirectory;
+        return;
+    }
+
+    loadProfile();
+    m_session++;
+
+    m_valid = true;
+}
+
+ShaderCache::~ShaderCache()
+{
+    if (m_thread) {
+        m_thread->requestInterruption();
+        m_thread->wait();
+    }
+}
+
+bool ShaderCache::isValid() const
+{
+    return m_valid;
+}
+
+QByteArray ShaderCache::key(const QByteArray &vertexSource, const QByteArray &fragmentSource, std::span<const GLAttributeLocation> attributeLocations) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(vertexSource);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(fragmentSource);
+    for (const GLAttributeLocation &location : attributeLocations) {
+        hash.addData(QByteArrayView("\0", 1));
+        hash.addData(location.name);
+        hash.addData(QByteArray::number(location.index));
+    }
+    return hash.result().toHex();
+}
+
+QString ShaderCache::programFilePath(const QByteArray &key) const
+{
+    return m_programDirectory + QLatin1Char('/') + QString::fromLatin1(key) + QLatin1String(".bin");
+}
+
+QString ShaderCache::sourceFilePath(const QByteArray &key) const
+{
+    return m_baseDirectory + QLatin1String("/sources/") + QString::fromLatin1(key);
+}
+
+void ShaderCache::loadProfile()
+{
+    QFile file(m_baseDirectory + QLatin1String("/profile"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split(' ');
+        if (fields.size() == 2 && fields[0] == "session") {
+            m_session = fields[1].toInt();
+        } else if (fields.size() == 4) {
+            const Usage usage{
+                .sessions = fields[2].toInt(),
+                .lastSession = fields[3].toInt(),
+            };
+            if (fields[0] == "traits") {
+                m_traitsUsage.insert(fields[1].toInt(), usage);
+            } else if (fields[0] == "program") {
+                m_programUsage.insert(fields[1], usage);
+            }
+        }
+    }
+}
+
+void ShaderCache::saveProfile() const
+{
+    QByteArray contents = "session " + QByteArray::number(m_session) + '\n';
+    for (const auto &[traits, usage] : m_traitsUsage.asKeyValueRange()) {
+        if (m_session - usage.lastSession < s_profileWindow) {
+            contents += "traits " + QByteArray::number(traits) + ' ' + QByteArray::number(usage.sessions) + ' ' + QByteArray::number(usage.lastSession) + '\n';
+        }
+    }
+    for (const auto &[key, usage] : m_programUsage.asKeyValueRange()) {
+        if (m_session - usage.lastSession < s_profileWindow) {
+            contents += "program " + key + ' ' + QByteArray::number(usage.sessions) + ' ' + QByteArray::number(usage.lastSession) + '\n';
+        }
+    }
+
+    QSaveFile file(m_baseDirectory + QLatin1String("/profile"));
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size() || !file.commit()) {
+        qCWarning(KWIN_OPENGL) << "Failed to store the shader usage profile";
+    }
+}
+
+template<typename T>
+QList<T> ShaderCache::hotSet(const QHash<T, Usage> &usage) const
+{
+    QList<std::pair<T, Usage>> candidates;
+    for (const auto &[id, entry] : usage.asKeyValueRange()) {
+        if (m_session - entry.lastSession < s_profileWindow) {
+            candidates.append(std::pair(id, entry));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) {
+        if (a.second.sessions != b.second.sessions) {
+            return a.second.sessions > b.second.sessions;
+        }
+        return a.second.lastSession > b.second.lastSession;
+    });
+
+    QList<T> ret;
+    for (const auto &[id, entry] : candidates) {
+        if (ret.size() == s_hotSetSize) {
+            break;
+        }
+        ret.append(id);
+    }
+    return ret;
+}
+
+bool ShaderCache::recordUsage(Usage &usage)
+{
+    if (usage.lastSession == m_session) {
+        return false;
+    }
+    usage.sessions++;
+    usage.lastSession = m_session;
+    return true;
+}
+
+std::optional<GLProgramBinary> ShaderCache::readProgram(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    quint32 format;
+    QByteArray data;
+    stream >> magic >> version >> format >> data;
+    if (stream.status() != QDataStream::Ok || magic != s_programMagic || version != s_programVersion || data.isEmpty()) {
+        return std::nullopt;
+    }
+
+    return GLProgramBinary{
+        .format = format,
+        .data = data,
+    };
+}
+
+bool ShaderCache::writeProgram(const QString &filePath, const GLProgramBinary &binary)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << s_programMagic << s_programVersion << quint32(binary.format) << binary.data;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+std::optional<GLProgramBinary> ShaderCache::load(const QByteArray &key)
+{
+    if (!m_valid) {
+        return std::nullopt;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (auto it = m_preloaded.find(key); it != m_preloaded.end()) {
+            return it.value();
+        }
+    }
+
+    return readProgram(programFilePath(key));
+}
+
+void ShaderCache::store(const QByteArray &key, const GLProgramBinary &binary)
+{
+    if (!m_valid) {
+        return;
+    }
+    if (!writeProgram(programFilePath(key), binary)) {
+        qCWarning(KWIN_OPENGL) << "Failed to store program binary" << key;
+    }
+}
+
+QList<ShaderTraits> ShaderCache::hotTraits() const
+{
+    QList<ShaderTraits> traits;
+    const QList<int> values = hotSet(m_traitsUsage);
+    for (int value : values) {
+        traits.append(ShaderTraits::fromInt(value));
+    }
+    return traits;
+}
+
+QList<ShaderCache::Program> ShaderCache::hotPrograms() const
+{
+    QList<Program> programs;
+    const QList<QByteArray> keys = hotSet(m_programUsage);
+    for (const QByteArray &key : keys) {
+        QFile file(sourceFilePath(key));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        QDataStream stream(&file);
+        quint32 magic;
+        quint32 version;
+        Program program{
+            .key = key,
+        };
+        quint32 attributeCount = 0;
+        stream >> magic >> version >> program.vertexSource >> program.fragmentSource >> attributeCount;
+        for (quint32 i = 0; i < attributeCount && stream.status() == QDataStream::Ok; ++i) {
+            GLAttributeLocation location;
+            qint32 index;
+            stream >> location.name >> index;
+            location.index = index;
+            program.attributeLocations.append(location);
+        }
+        if (stream.status() == QDataStream::Ok && magic == s_sourceMagic && version == s_sourceVersion) {
+            programs.append(program);
+        }
+    }
+    return programs;
+}
+
+void ShaderCache::recordTraits(ShaderTraits traits)
+{
+    if (m_valid && recordUsage(m_traitsUsage[traits.toInt()])) {
+        saveProfile();
+    }
+}
+
+void ShaderCache::recordProgram(const QByteArray &key, const QByteArray &vertexSource, const QByteArray &fragmentSource, std::span<const GLAttributeLocation> attributeLocations)
+{
+    if (!m_valid || !recordUsage(m_programUsage[key])) {
+        return;
+    }
+
+    const QString filePath = sourceFilePath(key);
+    if (!QFile::exists(filePath)) {
+        QSaveFile file(filePath);
+        if (file.open(QIODevice::WriteOnly)) {
+            QDataStream stream(&file);
+            stream << s_sourceMagic << s_sourceVersion << vertexSource << fragmentSource << quint32(attributeLocations.size());
+            for (const GLAttributeLocation &location : attributeLocations) {
+                stream << location.name << qint32(location.index);
+            }
+            file.commit();
+        }
+    }
+
+    saveProfile();
+}
+
+static GLuint compileStage(GLenum type, const QByteArray &source)
+{
+    const GLuint shader = glCreateShader(type);
+    const char *src = source.constData();
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    GLint status = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status) {
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+std::optional<GLProgramBinary> ShaderCache::compileProgram(const Job &job)
+{
+    const GLuint program = glCreateProgram();
+
+    bool compiled = true;
+    for (const auto &[type, source] : {std::pair(GLenum(GL_VERTEX_SHADER), job.vertexSource), std::pair(GLenum(GL_FRAGMENT_SHADER), job.fragmentSource)}) {
+        if (source.isEmpty()) {
+            continue;
+        }
+        const GLuint shader = compileStage(type, source);
+        if (!shader) {
+            compiled = false;
+            break;
+        }
+        glAttachShader(program, shader);
+        glDeleteShader(shader);
+    }
+
+    std::optional<GLProgramBinary> binary;
+    if (compiled) {
+        for (const GLAttributeLocation &location : job.attributeLocations) {
+            glBindAttribLocation(program, location.index, location.name.constData());
+        }
+        if (job.bindFragDataLocation) {
+            glBindFragDataLocation(program, 0, "fragColor");
+        }
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+
+        GLint status = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (status && length > 0) {
+            binary = GLProgramBinary{};
+            binary->data.resize(length);
+            glGetProgramBinary(program, length, &length, &binary->format, binary->data.data());
+            binary->data.resize(length);
+        }
+    }
+
+    glDeleteProgram(program);
+    return binary;
+}
+
+void ShaderCache::warm(EglContext *context, const QList<Job> &jobs)
+{
+    if (!m_valid || m_thread || jobs.isEmpty()) {
+        return;
+    }
+
+    // Only the programs that are missing on disk need a context, the rest are just read.
+    QList<Job> compileJobs;
+    QList<QByteArray> readJobs;
+    for (const Job &job : jobs) {
+        if (QFile::exists(programFilePath(job.key))) {
+            readJobs.append(job.key);
+        } else {
+            compileJobs.append(job);
+        }
+    }
+
+    ::EGLDisplay display = context->displayObject()->handle();
+    ::EGLContext workerContext = EGL_NO_CONTEXT;
+    if (!compileJobs.isEmpty()) {
+        workerContext = context->createSharedContext();
+        if (workerContext == EGL_NO_CONTEXT) {
+            qCWarning(KWIN_OPENGL) << "Failed to create a context to warm the shader cache";
+            compileJobs.clear();
+        }
+    }
+
+    m_thread.reset(QThread::create([this, display, workerContext, compileJobs, readJobs]() {
+        for (const QByteArray &key : readJobs) {
+            if (QThread::currentThread()->isInterruptionRequested()) {
+                return;
+            }
+            if (const auto binary = readProgram(programFilePath(key))) {
+                QMutexLocker locker(&m_mutex);
+                m_preloaded.insert(key, *binary);
+            }
+        }
+
+        if (workerContext == EGL_NO_CONTEXT) {
+            return;
+        }
+        if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, workerContext)) {
+            for (const Job &job : compileJobs) {
+                if (QThread::currentThread()->isInterruptionRequested()) {
+                    break;
+                }
+                if (const auto binary = compileProgram(job)) {
+                    writeProgram(programFilePath(job.key), *binary);
+                    QMutexLocker locker(&m_mutex);
+                    m_preloaded.insert(job.key, *binary);
+                }
+            }
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+        eglDestroyContext(display, workerContext);
+    }));
+    m_thread->setObjectName(QStringLiteral("KWin shader cache"));
+    m_thread->start(QThread::LowestPriority);
+}
+
+} // namespace KWin
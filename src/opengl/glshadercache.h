@@ -0,0 +1,146 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "opengl/glshader.h"
+#include "opengl/glshadermanager.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include <memory>
+#include <span>
+
+class QThread;
+
+namespace KWin
+{
+
+class EglContext;
+
+struct GLAttributeLocation
+{
+    QByteArray name;
+    int index;
+};
+
+/**
+ * The ShaderCache class stores linked shader programs on disk, so that they don't have
+ * to be compiled again in later sessions.
+ *
+ * Program binaries are specific to the driver, so they are stored per vendor, renderer
+ * and version string, and keyed by the hash of the sources and the attribute bindings.
+ * The cache also keeps a usage profile of the programs that were linked in recent sessions,
+ * so that the most used ones can be prepared on a worker thread at startup before they are
+ * needed. Built-in shaders are recorded by their traits, because their sources depend on
+ * the context; custom shaders, e.g. the ICC shader, are recorded along with their sources.
+ */
+class KWIN_EXPORT ShaderCache
+{
+public:
+    /**
+     * A program that should be compiled and stored in the cache in the background.
+     */
+    struct Job
+    {
+        QByteArray key;
+        QByteArray vertexSource;
+        QByteArray fragmentSource;
+        QList<GLAttributeLocation> attributeLocations;
+        bool bindFragDataLocation = false;
+    };
+
+    /**
+     * A custom program whose sources were recorded in the usage profile.
+     */
+    struct Program
+    {
+        QByteArray key;
+        QByteArray vertexSource;
+        QByteArray fragmentSource;
+        QList<GLAttributeLocation> attributeLocations;
+    };
+
+    explicit ShaderCache(EglContext *context);
+    ~ShaderCache();
+
+    /**
+     * Returns @c true if the driver supports program binaries and the cache directory
+     * is usable.
+     */
+    bool isValid() const;
+
+    QByteArray key(const QByteArray &vertexSource, const QByteArray &fragmentSource, std::span<const GLAttributeLocation> attributeLocations) const;
+
+    std::optional<GLProgramBinary> load(const QByteArray &key);
+    void store(const QByteArray &key, const GLProgramBinary &binary);
+
+    /**
+     * Returns the shader traits in the hot set, i.e. the ones that were used in the most
+     * recent sessions, ordered from the most to the least used.
+     */
+    QList<ShaderTraits> hotTraits() const;
+
+    /**
+     * Returns the custom programs in the hot set, ordered from the most to the least used.
+     */
+    QList<Program> hotPrograms() const;
+
+    /**
+     * Records that a built-in shader with the given @a traits is used in this session.
+     */
+    void recordTraits(ShaderTraits traits);
+
+    /**
+     * Records that the custom program identified by @a key is used in this session.
+     */
+    void recordProgram(const QByteArray &key, const QByteArray &vertexSource, const QByteArray &fragmentSource, std::span<const GLAttributeLocation> attributeLocations);
+
+    /**
+     * Loads or compiles the programs described by @a jobs on a worker thread with a context
+     * that shares objects with @a context. Programs that are already stored on disk are
+     * only read into memory.
+     */
+    void warm(EglContext *context, const QList<Job> &jobs);
+
+private:
+    struct Usage
+    {
+        int sessions = 0;
+        int lastSession = 0;
+    };
+
+    template<typename T>
+    QList<T> hotSet(const QHash<T, Usage> &usage) const;
+    bool recordUsage(Usage &usage);
+    void loadProfile();
+    void saveProfile() const;
+
+    QString programFilePath(const QByteArray &key) const;
+    QString sourceFilePath(const QByteArray &key) const;
+    static std::optional<GLProgramBinary> readProgram(const QString &filePath);
+    static bool writeProgram(const QString &filePath, const GLProgramBinary &binary);
+    static std::optional<GLProgramBinary> compileProgram(const Job &job);
+
+    bool m_valid = false;
+    QString m_baseDirectory;
+    QString m_programDirectory;
+    int m_session = 0;
+    QHash<int, Usage> m_traitsUsage;
+    QHash<QByteArray, Usage> m_programUsage;
+
+    QMutex m_mutex;
+    QHash<QByteArray, GLProgramBinary> m_preloaded;
+
+    std::unique_ptr<QThread> m_thread;
+};
+
+} // namespace KWin
@@ -12,6 +12,7 @@
 #include "eglcontext.h"
 #include "glplatform.h"
 #include "glshader.h"
+#include "glshadercache.h"
 #include "glvertexbuffer.h"
 #include "utils/common.h"
 
@@ -37,6 +38,32 @@ ShaderManager::~ShaderManager()
     }
 }
 
+ShaderCache *ShaderManager::cache()
+{
+    // The shader manager is created before the context is fully initialized
+    if (!m_cache) {
+        auto cache = std::make_unique<ShaderCache>(EglContext::currentContext());
+        m_cache = cache->isValid() ? std::move(cache) : nullptr;
+    }
+    return m_cache->get();
+}
+
+static bool supportsFragDataLocation()
+{
+    const auto context = EglContext::currentContext();
+    return !context->isOpenGLES() && (context->hasVersion(Version(3, 0)) || context->hasOpenglExtension(QByteArrayLiteral("GL_EXT_gpu_shader4")));
+}
+
+static const GLAttributeLocation s_traitsAttributeLocations[] = {
+    {QByteArrayLiteral("position"), VA_Position},
+    {QByteArrayLiteral("texcoord"), VA_TexCoord},
+};
+
+static const GLAttributeLocation s_customAttributeLocations[] = {
+    {QByteArrayLiteral("vertex"), VA_Position},
+    {QByteArrayLiteral("texCoord"), VA_TexCoord},
+};
+
 QByteArray ShaderManager::generateVertexSource(ShaderTraits traits) const
 {
     QByteArray source;
@@ -273,14 +300,47 @@ std::unique_ptr<GLShader> ShaderManager::generateCustomShader(ShaderTraits trait
         return nullptr;
     }
 
+    // Only the generated shaders can be recorded by their traits
+    const bool builtin = vertexSource.isEmpty() && fragmentSource.isEmpty();
+    return linkShader(*vertex, *fragment, s_traitsAttributeLocations, builtin ? std::optional(traits) : std::nullopt);
+}
+
+std::unique_ptr<GLShader> ShaderManager::linkShader(const QByteArray &vertexSource, const QByteArray &fragmentSource, std::span<const GLAttributeLocation> attributeLocations, std::optional<ShaderTraits> traits)
+{
     std::unique_ptr<GLShader> shader{new GLShader(GLShader::ExplicitLinking)};
-    shader->load(*vertex, *fragment);
 
-    shader->bindAttributeLocation("position", VA_Position);
-    shader->bindAttributeLocation("texcoord", VA_TexCoord);
-    shader->bindFragDataLocation("fragColor", 0);
+    ShaderCache *cache = this->cache();
+    QByteArray key;
+    if (cache) {
+        key = cache->key(vertexSource, fragmentSource, attributeLocations);
+        if (traits) {
+            cache->recordTraits(*traits);
+        } else {
+            cache->recordProgram(key, vertexSource, fragmentSource, attributeLocations);
+        }
+        if (const auto binary = cache->load(key)) {
+            if (shader->loadBinary(*binary)) {
+                return shader;
+            }
+            // The binary is stale, compile the program from scratch
+            shader.reset(new GLShader(GLShader::ExplicitLinking));
+        }
+    }
+
+    shader->load(vertexSource, fragmentSource);
+    for (const GLAttributeLocation &location : attributeLocations) {
+        shader->bindAttributeLocation(location.name.constData(), location.index);
+    }
+    bindFragDataLocations(shader.get());
 
-    shader->link();
+    if (cache) {
+        glProgramParameteri(shader->m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    if (shader->link() && cache) {
+        if (const auto binary = shader->binary()) {
+            cache->store(key, *binary);
+        }
+    }
     return shader;
 }
 
@@ -344,6 +404,50 @@ GLShader *ShaderManager::shader(ShaderTraits traits)
     return shader.get();
 }
 
+void ShaderManager::warmCache()
+{
+    ShaderCache *cache = this->cache();
+    if (!cache) {
+        return;
+    }
+
+    const bool bindFragDataLocation = supportsFragDataLocation();
+
+    // The sources depend on the current context, so they have to be generated here
+    QList<ShaderCache::Job> jobs;
+    const QList<ShaderTraits> hotTraits = cache->hotTraits();
+    for (const ShaderTraits traits : hotTraits) {
+        if (m_shaderHash.contains(traits)) {
+            continue;
+        }
+        const auto vertex = preprocess(generateVertexSource(traits));
+        const auto fragment = preprocess(generateFragmentSource(traits));
+        if (!vertex || !fragment) {
+            continue;
+        }
+        jobs.append(ShaderCache::Job{
+            .key = cache->key(*vertex, *fragment, s_traitsAttributeLocations),
+            .vertexSource = GLShader::prepareSource(GL_VERTEX_SHADER, *vertex),
+            .fragmentSource = GLShader::prepareSource(GL_FRAGMENT_SHADER, *fragment),
+            .attributeLocations = QList<GLAttributeLocation>(std::begin(s_traitsAttributeLocations), std::end(s_traitsAttributeLocations)),
+            .bindFragDataLocation = bindFragDataLocation,
+        });
+    }
+
+    const QList<ShaderCache::Program> hotPrograms = cache->hotPrograms();
+    for (const ShaderCache::Program &program : hotPrograms) {
+        jobs.append(ShaderCache::Job{
+            .key = program.key,
+            .vertexSource = GLShader::prepareSource(GL_VERTEX_SHADER, program.vertexSource),
+            .fragmentSource = GLShader::prepareSource(GL_FRAGMENT_SHADER, program.fragmentSource),
+            .attributeLocations = program.attributeLocations,
+            .bindFragDataLocation = bindFragDataLocation,
+        });
+    }
+
+    cache->warm(EglContext::currentContext(), jobs);
+}
+
 GLShader *ShaderManager::getBoundShader() const
 {
     if (m_boundShaders.isEmpty()) {
@@ -394,19 +498,15 @@ void ShaderManager::bindFragDataLocations(GLShader *shader)
     shader->bindFragDataLocation("fragColor", 0);
 }
 
-void ShaderManager::bindAttributeLocations(GLShader *shader) const
+std::unique_ptr<GLShader> ShaderManager::loadShaderFromCode(const QByteArray &vertexSource, const QByteArray &fragmentSource)
 {
-    shader->bindAttributeLocation("vertex", VA_Position);
-    shader->bindAttributeLocation("texCoord", VA_TexCoord);
+    return linkShader(vertexSource, fragmentSource, s_customAttributeLocations, std::nullopt);
 }
 
-std::unique_ptr<GLShader> ShaderManager::loadShaderFromCode(const QByteArray &vertexSource, const QByteArray &fragmentSource)
+std::unique_ptr<GLShader> ShaderManager::loadComputeShaderFromCode(const QByteArray &computeSource)
 {
-    std::unique_ptr<GLShader> shader{new GLShader(GLShader::ExplicitLinking)};
-    shader->load(vertexSource, fragmentSource);
-    bindAttributeLocations(shader.get());
-    bindFragDataLocations(shader.get());
-    shader->link();
+    std::unique_ptr<GLShader> shader(new GLShader());
+    shader->loadCompute(computeSource);
     return shader;
 }
 
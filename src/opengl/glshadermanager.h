@@ -16,11 +16,15 @@
 #include <QStack>
 #include <map>
 #include <memory>
+#include <optional>
+#include <span>
 
 namespace KWin
 {
 
 class GLShader;
+class ShaderCache;
+struct GLAttributeLocation;
 
 enum class ShaderTrait {
     MapTexture = (1 << 0),
@@ -102,6 +106,14 @@ public:
      */
     std::unique_ptr<GLShader> loadShaderFromCode(const QByteArray &vertexSource, const QByteArray &fragmentSource);
 
+    /**
+     * Creates a compute shader with the specified source. Check EglContext::supportsComputeShaders()
+     * before using it.
+     * @param computeSource The source code of the compute shader
+     * @return The created shader
+     */
+    std::unique_ptr<GLShader> loadComputeShaderFromCode(const QByteArray &computeSource);
+
     /**
      * Creates a custom shader with the given @p traits and custom @p vertexSource and or @p fragmentSource.
      * If the @p vertexSource is empty a vertex shader with the given @p traits is generated.
@@ -147,17 +159,26 @@ public:
      */
     static ShaderManager *instance();
 
+    /**
+     * Prepares the programs that were used the most in recent sessions, both built-in and
+     * custom ones, on a worker thread, so that they can be loaded from the program cache
+     * instead of being compiled when they are needed for the first time.
+     */
+    void warmCache();
+
 private:
     void bindFragDataLocations(GLShader *shader);
-    void bindAttributeLocations(GLShader *shader) const;
 
     std::optional<QByteArray> preprocess(const QByteArray &src, int recursionDepth = 0) const;
     QByteArray generateVertexSource(ShaderTraits traits) const;
     QByteArray generateFragmentSource(ShaderTraits traits) const;
     std::unique_ptr<GLShader> generateShader(ShaderTraits traits);
+    std::unique_ptr<GLShader> linkShader(const QByteArray &vertexSource, const QByteArray &fragmentSource, std::span<const GLAttributeLocation> attributeLocations, std::optional<ShaderTraits> traits);
+    ShaderCache *cache();
 
     QStack<GLShader *> m_boundShaders;
     std::map<ShaderTraits, std::unique_ptr<GLShader>> m_shaderHash;
+    std::optional<std::unique_ptr<ShaderCache>> m_cache;
 };
 
 /**
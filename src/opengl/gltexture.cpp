@@ -12,6 +12,7 @@
 #include "gltexture_p.h"
 #include "opengl/glframebuffer.h"
 #include "opengl/glplatform.h"
+#include "opengl/gluploadbuffer.h"
 #include "opengl/glutils.h"
 #include "utils/common.h"
 
@@ -21,6 +22,9 @@
 #include <QVector3D>
 #include <QVector4D>
 
+#include <algorithm>
+#include <cstring>
+
 namespace KWin
 {
 
@@ -149,41 +153,49 @@ void GLTexture::setSize(const QSize &size)
     d->updateMatrix();
 }
 
-void GLTexture::update(const QImage &image, const QRegion &region, const QPoint &offset)
+GLTexture::UploadFormat GLTexture::uploadFormat(QImage::Format format)
 {
-    if (image.isNull() || isNull()) {
-        return;
-    }
-
-    Q_ASSERT(d->m_owning);
-
     const auto context = EglContext::currentContext();
-    GLenum glFormat;
-    GLenum type;
-    QImage::Format uploadFormat;
     if (!context->isOpenGLES()) {
-        const QImage::Format index = image.format();
-
-        if (index < sizeof(formatTable) / sizeof(formatTable[0]) && formatTable[index].internalFormat) {
-            glFormat = formatTable[index].format;
-            type = formatTable[index].type;
-            uploadFormat = index;
+        if (format < sizeof(formatTable) / sizeof(formatTable[0]) && formatTable[format].internalFormat) {
+            return UploadFormat{
+                .format = formatTable[format].format,
+                .type = formatTable[format].type,
+                .imageFormat = format,
+            };
         } else {
-            glFormat = GL_BGRA;
-            type = GL_UNSIGNED_INT_8_8_8_8_REV;
-            uploadFormat = QImage::Format_ARGB32_Premultiplied;
+            return UploadFormat{
+                .format = GL_BGRA,
+                .type = GL_UNSIGNED_INT_8_8_8_8_REV,
+                .imageFormat = QImage::Format_ARGB32_Premultiplied,
+            };
         }
     } else {
         if (context->supportsARGB32Textures()) {
-            glFormat = GL_BGRA_EXT;
-            type = GL_UNSIGNED_BYTE;
-            uploadFormat = QImage::Format_ARGB32_Premultiplied;
+            return UploadFormat{
+                .format = GL_BGRA_EXT,
+                .type = GL_UNSIGNED_BYTE,
+                .imageFormat = QImage::Format_ARGB32_Premultiplied,
+            };
         } else {
-            glFormat = GL_RGBA;
-            type = GL_UNSIGNED_BYTE;
-            uploadFormat = QImage::Format_RGBA8888_Premultiplied;
+            return UploadFormat{
+                .format = GL_RGBA,
+                .type = GL_UNSIGNED_BYTE,
+                .imageFormat = QImage::Format_RGBA8888_Premultiplied,
+            };
         }
     }
+}
+
+void GLTexture::update(const QImage &image, const QRegion &region, const QPoint &offset)
+{
+    if (image.isNull() || isNull()) {
+        return;
+    }
+
+    Q_ASSERT(d->m_owning);
+
+    const auto [glFormat, type, uploadFormat] = GLTexture::uploadFormat(image.format());
 
     QImage im = image;
     if (im.format() != uploadFormat) {
@@ -192,8 +204,13 @@ void GLTexture::update(const QImage &image, const QRegion &region, const QPoint
 
     bind();
 
+    Q_ASSERT(im.depth() % 8 == 0);
+    if (uploadFromBuffer(im, region, offset, glFormat, type)) {
+        unbind();
+        return;
+    }
+
     for (const QRect &rect : region) {
-        Q_ASSERT(im.depth() % 8 == 0);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, im.bytesPerLine() / (im.depth() / 8));
         glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x());
         glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y());
@@ -208,6 +225,58 @@ void GLTexture::update(const QImage &image, const QRegion &region, const QPoint
     unbind();
 }
 
+// Small updates, e.g. of cursors or blinking text cursors, are cheaper to submit directly.
+static const qsizetype s_minimumBufferedUploadSize = 64 * 1024;
+
+bool GLTexture::uploadFromBuffer(const QImage &image, const QRegion &region, const QPoint &offset, GLenum format, GLenum type)
+{
+    GLUploadBuffer *buffer = GLUploadBuffer::streamingBuffer();
+    if (!buffer) {
+        return false;
+    }
+
+    const int bytesPerPixel = image.depth() / 8;
+    qsizetype size = 0;
+    for (const QRect &rect : region) {
+        // Each rect starts at an aligned offset
+        size += (qsizetype(rect.width()) * bytesPerPixel * rect.height() + 63) & ~qsizetype(63);
+    }
+    if (size < s_minimumBufferedUploadSize) {
+        return false;
+    }
+
+    const auto range = buffer->map(size);
+    if (!range) {
+        return false;
+    }
+
+    // Copy only the damaged rows into the buffer, tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    buffer->bind();
+
+    qsizetype rangeOffset = 0;
+    for (const QRect &rect : region) {
+        const qsizetype rowSize = qsizetype(rect.width()) * bytesPerPixel;
+        uint8_t *dst = range->data + rangeOffset;
+        const uchar *src = image.constScanLine(rect.y()) + qsizetype(rect.x()) * bytesPerPixel;
+        for (int y = 0; y < rect.height(); ++y) {
+            memcpy(dst, src, rowSize);
+            dst += rowSize;
+            src += image.bytesPerLine();
+        }
+
+        glTexSubImage2D(d->m_target, 0, offset.x() + rect.x(), offset.y() + rect.y(), rect.width(), rect.height(), format, type,
+                        reinterpret_cast<const GLvoid *>(range->offset + rangeOffset));
+        rangeOffset += (rowSize * rect.height() + 63) & ~qsizetype(63);
+    }
+
+    buffer->unbind();
+    buffer->fence(*range);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    return true;
+}
+
 void GLTexture::bind()
 {
     Q_ASSERT(d->m_texture);
@@ -471,6 +540,35 @@ QImage GLTexture::toImage()
     return ret;
 }
 
+static uint64_t textureByteSize(GLenum internalFormat, const QSize &size, int levels)
+{
+    uint64_t bytesPerPixel;
+    switch (internalFormat) {
+    case GL_R8:
+        bytesPerPixel = 1;
+        break;
+    case GL_R16:
+    case GL_RG8:
+        bytesPerPixel = 2;
+        break;
+    case GL_RGBA16:
+    case GL_RGBA16F:
+        bytesPerPixel = 8;
+        break;
+    case GL_RGBA32F:
+        bytesPerPixel = 16;
+        break;
+    default:
+        bytesPerPixel = 4;
+        break;
+    }
+    uint64_t ret = 0;
+    for (int level = 0; level < levels; level++) {
+        ret += uint64_t(std::max(size.width() >> level, 1)) * std::max(size.height() >> level, 1) * bytesPerPixel;
+    }
+    return ret;
+}
+
 std::unique_ptr<GLTexture> GLTexture::createNonOwningWrapper(GLuint textureId, GLenum internalFormat, const QSize &size)
 {
     return std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, textureId, internalFormat, size, 1, false, OutputTransform{}));
@@ -507,7 +605,9 @@ std::unique_ptr<GLTexture> GLTexture::allocate(GLenum internalFormat, const QSiz
         // internalFormat() won't need to be specialized for GLES2.
     }
     glBindTexture(GL_TEXTURE_2D, 0);
-    return std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, texture, internalFormat, size, levels, true, OutputTransform{}));
+    auto ret = std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, texture, internalFormat, size, levels, true, OutputTransform{}));
+    ret->d->m_allocation = GpuMemoryAllocation(GpuMemoryCategory::Texture, textureByteSize(internalFormat, size, levels));
+    return ret;
 }
 
 std::unique_ptr<GLTexture> GLTexture::upload(const QImage &image)
@@ -575,7 +675,9 @@ std::unique_ptr<GLTexture> GLTexture::upload(const QImage &image)
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    return std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, texture, internalFormat, image.size(), 1, true, OutputTransform::FlipY));
+    auto ret = std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, texture, internalFormat, image.size(), 1, true, OutputTransform::FlipY));
+    ret->d->m_allocation = GpuMemoryAllocation(GpuMemoryCategory::Texture, textureByteSize(internalFormat, image.size(), 1));
+    return ret;
 }
 
 std::unique_ptr<GLTexture> GLTexture::upload(const QPixmap &pixmap)
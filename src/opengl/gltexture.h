@@ -13,13 +13,13 @@
 #include "core/output.h"
 
 #include <QExplicitlySharedDataPointer>
+#include <QImage>
 #include <QMatrix4x4>
 #include <QRegion>
 #include <QSize>
 
 #include <epoxy/gl.h>
 
-class QImage;
 class QPixmap;
 
 /** @addtogroup kwineffects */
@@ -121,6 +121,19 @@ public:
      */
     static bool supportsFormatRG();
 
+    struct UploadFormat
+    {
+        GLenum format;
+        GLenum type;
+        QImage::Format imageFormat;
+    };
+
+    /**
+     * Returns the pixel format and type that are used to upload images with the given
+     * @a format, and the image format the pixels have to be converted to beforehand.
+     */
+    static UploadFormat uploadFormat(QImage::Format format);
+
     static std::unique_ptr<GLTexture> createNonOwningWrapper(GLuint textureId, GLenum internalFormat, const QSize &size);
     static std::unique_ptr<GLTexture> allocate(GLenum internalFormat, const QSize &size, int levels = 1);
     static std::unique_ptr<GLTexture> upload(const QImage &image);
@@ -130,6 +143,9 @@ protected:
     explicit GLTexture(GLenum target, GLuint textureId, GLenum internalFormat, const QSize &size, int levels, bool owning, OutputTransform transform);
 
     const std::unique_ptr<GLTexturePrivate> d;
+
+private:
+    bool uploadFromBuffer(const QImage &image, const QRegion &region, const QPoint &offset, GLenum format, GLenum type);
 };
 
 } // namespace
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "core/gpumemory.h"
 #include "opengl/glutils.h"
 
 #include <QImage>
@@ -54,6 +55,7 @@ public:
     QSizeF m_cachedSize;
     QRectF m_cachedSource;
     OutputTransform m_cachedContentTransform;
+    GpuMemoryAllocation m_allocation;
 
     Q_DISABLE_COPY(GLTexturePrivate)
 };
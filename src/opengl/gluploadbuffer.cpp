@@ -0,0 +1,214 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "gluploadbuffer.h"
+#include "eglcontext.h"
+#include "utils/common.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+static const size_t s_initialBufferSize = 4 * 1024 * 1024;
+static const size_t s_maximumBufferSize = 64 * 1024 * 1024;
+
+// Uploads start at an offset that is suitably aligned for any pixel format.
+static const size_t s_rangeAlignment = 64;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+GLUploadBuffer::GLUploadBuffer()
+{
+    reallocate(s_initialBufferSize);
+}
+
+GLUploadBuffer::~GLUploadBuffer()
+{
+    if (!EglContext::currentContext()) {
+        qCWarning(KWIN_OPENGL, "Could not delete upload buffer because no context is current");
+        return;
+    }
+    for (const Fence &fence : m_fences) {
+        glDeleteSync(fence.sync);
+    }
+    if (m_buffer) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+void GLUploadBuffer::reallocate(size_t size)
+{
+    for (const Fence &fence : m_fences) {
+        glDeleteSync(fence.sync);
+    }
+    m_fences.clear();
+
+    // The driver keeps the old storage alive until the GPU is done with it
+    if (m_buffer) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, access);
+    m_map = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    m_size = m_map ? size : 0;
+    m_head = 0;
+    m_tail = 0;
+    m_reserved.clear();
+    ++m_statistics.reallocations;
+    qCDebug(KWIN_OPENGL) << "Allocated a pixel upload buffer of" << m_size << "bytes";
+}
+
+void GLUploadBuffer::retireSignaledFences()
+{
+    while (!m_fences.empty()) {
+        const Fence &fence = m_fences.front();
+        GLint value;
+        glGetSynciv(fence.sync, GL_SYNC_STATUS, 1, nullptr, &value);
+        if (value != GL_SIGNALED) {
+            break;
+        }
+        glDeleteSync(fence.sync);
+        m_tail = fence.end;
+        m_fences.pop_front();
+    }
+}
+
+bool GLUploadBuffer::awaitFence()
+{
+    if (m_fences.empty()) {
+        return false;
+    }
+
+    qCDebug(KWIN_OPENGL) << "Stalling on pixel upload buffer fence";
+    ++m_statistics.stalls;
+
+    const Fence fence = m_fences.front();
+    m_fences.pop_front();
+    const GLenum ret = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    glDeleteSync(fence.sync);
+    if (ret == GL_TIMEOUT_EXPIRED || ret == GL_WAIT_FAILED) {
+        qCCritical(KWIN_OPENGL) << "Wait failed";
+        return false;
+    }
+
+    m_tail = fence.end;
+    return true;
+}
+
+std::optional<GLUploadBuffer::Range> GLUploadBuffer::map(size_t size)
+{
+    if (size > s_maximumBufferSize / 2) {
+        return std::nullopt;
+    }
+
+    retireSignaledFences();
+
+    // Keep room for at least two uploads of this size, so that one can be written while the
+    // other is being transferred.
+    if (size * 2 > m_size) {
+        if (!m_reserved.empty()) {
+            return std::nullopt;
+        }
+        reallocate(std::min(alignUp(size * 2, s_initialBufferSize), uint64_t(s_maximumBufferSize)));
+    }
+    if (!m_map) {
+        return std::nullopt;
+    }
+
+    auto allocate = [this, size]() {
+        uint64_t start = alignUp(m_head, s_rangeAlignment);
+        if (start % m_size + size > m_size) {
+            // The range can't wrap around the end of the buffer
+            start = alignUp(start, m_size);
+        }
+        return start;
+    };
+
+    uint64_t start = allocate();
+    while (start + size - m_tail > m_size) {
+        // The GPU is still reading from the range. Rather than waiting for it, switch to a
+        // bigger buffer, like the streaming vertex buffer does.
+        if (m_size < s_maximumBufferSize && m_reserved.empty()) {
+            reallocate(std::min(m_size * 2, s_maximumBufferSize));
+            if (!m_map) {
+                return std::nullopt;
+            }
+        } else if (!awaitFence()) {
+            return std::nullopt;
+        }
+        start = allocate();
+    }
+
+    m_head = start + size;
+    m_reserved.push_back(start);
+    m_statistics.uploadedBytes += size;
+
+    return Range{
+        .offset = intptr_t(start % m_size),
+        .data = m_map + start % m_size,
+        .start = start,
+    };
+}
+
+void GLUploadBuffer::bind()
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+}
+
+void GLUploadBuffer::unbind()
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void GLUploadBuffer::fence(const Range &range)
+{
+    const auto it = std::find(m_reserved.begin(), m_reserved.end(), range.start);
+    if (it == m_reserved.end()) {
+        // The range belongs to a buffer that has been reallocated in the meantime
+        return;
+    }
+    m_reserved.erase(it);
+
+    // The fence must not release the ranges that are still reserved. Ranges are reserved in
+    // order, so the fences stay sorted.
+    const uint64_t end = m_reserved.empty() ? m_head : m_reserved.front();
+    if (auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) {
+        m_fences.push_back(Fence{
+            .sync = sync,
+            .end = end,
+        });
+    } else {
+        // Without a fence there is no way to tell when the data has been read
+        EglContext::finish();
+        m_tail = end;
+    }
+}
+
+GLUploadBuffer::Statistics GLUploadBuffer::statistics() const
+{
+    Statistics statistics = m_statistics;
+    statistics.bufferSize = m_size;
+    return statistics;
+}
+
+GLUploadBuffer *GLUploadBuffer::streamingBuffer()
+{
+    return EglContext::currentContext()->uploadBuffer();
+}
+
+} // namespace KWin
@@ -0,0 +1,112 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "kwin_export.h"
+
+#include <epoxy/gl.h>
+
+#include <deque>
+#include <optional>
+
+namespace KWin
+{
+
+/**
+ * The GLUploadBuffer class is a persistently mapped pixel unpack buffer that is used to
+ * stream texture data to the GPU.
+ *
+ * The data for an upload is written into a range of the mapped buffer and the texture is
+ * updated from the buffer, so glTexSubImage2D() returns without copying or synchronizing;
+ * the GPU transfers the pixels asynchronously. Every upload is guarded with a fence, and
+ * its range is not reused until the fence has been signaled. Commands that sample the
+ * texture are ordered after the transfer by the context, so no explicit wait is needed.
+ *
+ * A mapped range stays reserved until fence() is called for it, so it can be written on
+ * another thread while the buffer is used for other uploads. The buffer doesn't grow while
+ * any range is reserved, because that would unmap it.
+ */
+class KWIN_EXPORT GLUploadBuffer
+{
+public:
+    struct Range
+    {
+        /**
+         * The offset of the range in the buffer, to be passed as the pixel pointer.
+         */
+        intptr_t offset;
+        uint8_t *data;
+        /**
+         * Identifies the range in the ring.
+         */
+        uint64_t start;
+    };
+
+    struct Statistics
+    {
+        size_t bufferSize = 0;
+        uint64_t uploadedBytes = 0;
+        uint64_t reallocations = 0;
+        uint64_t stalls = 0;
+    };
+
+    explicit GLUploadBuffer();
+    ~GLUploadBuffer();
+
+    /**
+     * Returns a mapped range of @a size bytes that is not used by the GPU anymore, or
+     * @c std::nullopt if the upload doesn't fit in the buffer. The range is reserved
+     * until fence() is called for it.
+     */
+    std::optional<Range> map(size_t size);
+
+    /**
+     * Binds the buffer to GL_PIXEL_UNPACK_BUFFER.
+     */
+    void bind();
+    void unbind();
+
+    /**
+     * Inserts a fence after the commands that read the given @a range and releases the
+     * reservation of the range.
+     */
+    void fence(const Range &range);
+
+    Statistics statistics() const;
+
+    /**
+     * Returns the upload buffer of the current context, or @c null if persistently mapped
+     * pixel buffers are not supported.
+     */
+    static GLUploadBuffer *streamingBuffer();
+
+private:
+    struct Fence
+    {
+        GLsync sync;
+        uint64_t end;
+    };
+
+    void reallocate(size_t size);
+    void retireSignaledFences();
+    bool awaitFence();
+
+    GLuint m_buffer = 0;
+    uint8_t *m_map = nullptr;
+    size_t m_size = 0;
+    // The head and the tail are virtual offsets that only grow; the offset in the buffer is
+    // the remainder of the division by the buffer size.
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    std::deque<Fence> m_fences;
+    std::deque<uint64_t> m_reserved;
+    Statistics m_statistics;
+};
+
+} // namespace KWin
@@ -18,6 +18,7 @@
 #include "utils/common.h"
 
 #include <QVector4D>
+#include <algorithm>
 #include <bitset>
 #include <deque>
 
@@ -89,6 +90,9 @@ struct VertexAttrib
 
 // ------------------------------------------------------------------
 
+// The persistent buffer grows instead of stalling on a fence until it reaches this size.
+static const size_t s_maximumPersistentBufferSize = 64 * 1024 * 1024;
+
 struct BufferFence
 {
     GLsync sync;
@@ -137,6 +141,11 @@ public:
         return sum / Count;
     }
 
+    size_t peak() const
+    {
+        return *std::max_element(m_array.begin(), m_array.end());
+    }
+
 private:
     std::array<size_t, Count> m_array;
     int m_index = 0;
@@ -193,6 +202,7 @@ public:
     void reallocateBuffer(size_t size);
     GLvoid *mapNextFreeRange(size_t size);
     void reallocatePersistentBuffer(size_t size);
+    bool releaseSignaledRange(intptr_t end);
     bool awaitFence(intptr_t offset);
     GLvoid *getIdleRange(size_t size);
 
@@ -209,7 +219,8 @@ public:
     intptr_t baseAddress;
     uint8_t *map;
     std::deque<BufferFence> fences;
-    FrameSizesArray<4> frameSizes;
+    FrameSizesArray<16> frameSizes;
+    GLVertexBuffer::Statistics statistics;
     std::array<VertexAttrib, VertexAttributeCount> attrib;
     size_t attribStride = 0;
     std::bitset<32> enabledArrays;
@@ -251,9 +262,13 @@ void GLVertexBufferPrivate::reallocatePersistentBuffer(size_t size)
         glGenBuffers(1, &buffer);
     }
 
-    // Round the size up to 64 kb
-    size_t minSize = std::max<size_t>(frameSizes.average() * 3, 128 * 1024);
-    bufferSize = std::max(size, minSize);
+    // Make room for three frames worth of data, so that the range that is written in
+    // the current frame is not used by the previous two frames that may still be in flight.
+    // Round the size up to 64 kb.
+    const size_t minSize = std::max<size_t>(frameSizes.peak() * 3, 128 * 1024);
+    bufferSize = align(std::max(size, minSize), 64 * 1024);
+    ++statistics.reallocations;
+    qCDebug(KWIN_OPENGL) << "Allocated a persistent streaming buffer of" << bufferSize << "bytes";
 
     const GLbitfield storage = GL_DYNAMIC_STORAGE_BIT;
     const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
@@ -267,6 +282,26 @@ void GLVertexBufferPrivate::reallocatePersistentBuffer(size_t size)
     bufferEnd = bufferSize;
 }
 
+bool GLVertexBufferPrivate::releaseSignaledRange(intptr_t end)
+{
+    // The fences are signaled in order, so it's enough to check the first fence that
+    // guards the requested range.
+    const auto it = std::find_if(fences.begin(), fences.end(), [end](const BufferFence &fence) {
+        return fence.nextEnd >= end;
+    });
+    if (it == fences.end() || !it->signaled()) {
+        return false;
+    }
+
+    bufferEnd = it->nextEnd;
+    for (auto fence = fences.begin(); fence != std::next(it); ++fence) {
+        glDeleteSync(fence->sync);
+    }
+    fences.erase(fences.begin(), std::next(it));
+
+    return true;
+}
+
 bool GLVertexBufferPrivate::awaitFence(intptr_t end)
 {
     // Skip fences until we reach the end offset
@@ -282,6 +317,7 @@ bool GLVertexBufferPrivate::awaitFence(intptr_t end)
 
     if (!fence.signaled()) {
         qCDebug(KWIN_OPENGL) << "Stalling on VBO fence";
+        ++statistics.stalls;
         const GLenum ret = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
 
         if (ret == GL_TIMEOUT_EXPIRED || ret == GL_WAIT_FAILED) {
@@ -322,8 +358,12 @@ GLvoid *GLVertexBufferPrivate::getIdleRange(size_t size)
         }
     }
 
-    if (nextOffset + intptr_t(size) > bufferEnd) {
-        if (!awaitFence(nextOffset + size)) {
+    if (nextOffset + intptr_t(size) > bufferEnd && !releaseSignaledRange(nextOffset + size)) {
+        // The GPU is still reading from the range. Rather than waiting for it, switch to a
+        // bigger buffer, the driver will release the old one once the GPU is done with it.
+        if (bufferSize < s_maximumPersistentBufferSize) {
+            reallocatePersistentBuffer(bufferSize * 2);
+        } else if (!awaitFence(nextOffset + size)) {
             return nullptr;
         }
     }
@@ -540,11 +580,14 @@ void GLVertexBuffer::endOfFrame()
     // Emit a fence if we have uploaded data
     if (d->frameSize > 0) {
         d->frameSizes.push(d->frameSize);
+        d->statistics.frameSize = d->frameSize;
+        d->statistics.peakFrameSize = d->frameSizes.peak();
         d->frameSize = 0;
 
-        // Force the buffer to be reallocated at the beginning of the next frame
-        // if the average frame size is greater than half the size of the buffer
-        if (d->frameSizes.average() > d->bufferSize / 2) {
+        // Force the buffer to be reallocated at the beginning of the next frame if three
+        // frames don't fit in it anymore, so it's done between frames rather than when
+        // map() runs out of space in the middle of a frame.
+        if (d->frameSizes.peak() * 3 > d->bufferSize) {
             deleteAll(d->fences);
             glDeleteBuffers(1, &d->buffer);
 
@@ -588,4 +631,11 @@ void GLVertexBuffer::setPersistent()
     d->persistent = true;
 }
 
+GLVertexBuffer::Statistics GLVertexBuffer::statistics() const
+{
+    Statistics statistics = d->statistics;
+    statistics.bufferSize = d->bufferSize;
+    return statistics;
+}
+
 }
@@ -243,6 +243,36 @@ public:
 
     void setPersistent();
 
+    struct Statistics
+    {
+        /**
+         * The size of the buffer object, in bytes.
+         */
+        size_t bufferSize = 0;
+        /**
+         * The amount of data that was uploaded during the last frame, in bytes.
+         */
+        size_t frameSize = 0;
+        /**
+         * The largest amount of data that was uploaded during one of the recent frames, in bytes.
+         */
+        size_t peakFrameSize = 0;
+        /**
+         * The number of times the persistent buffer storage was (re)allocated.
+         */
+        uint64_t reallocations = 0;
+        /**
+         * The number of times map() had to wait for the GPU to finish reading a range.
+         */
+        uint64_t stalls = 0;
+    };
+
+    /**
+     * Returns the usage statistics of a persistent buffer. They can be used to check whether
+     * the buffer is sized accordingly.
+     */
+    Statistics statistics() const;
+
     /**
      * @return A shared VBO for streaming data
      * @since 4.7
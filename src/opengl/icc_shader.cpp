@@ -111,10 +111,7 @@ bool IccShader::setProfile(const std::shared_ptr<IccProfile> &profile, const std
             }
             if (it != tag->ops.end() && std::holds_alternative<std::shared_ptr<ColorLUT3D>>(it->operation)) {
                 const auto &op = std::get<std::shared_ptr<ColorLUT3D>>(it->operation);
-                const auto sample = [op](size_t x, size_t y, size_t z) {
-                    return op->sample(x, y, z);
-                };
-                C = GlLookUpTable3D::create(sample, op->xSize(), op->ySize(), op->zSize());
+                C = GlLookUpTable3D::create(op->samples(), op->xSize(), op->ySize(), op->zSize());
                 if (!C) {
                     return false;
                 }
@@ -55,6 +55,8 @@ Options::Options(QObject *parent)
     , m_xwaylandEavesdrops(Options::defaultXwaylandEavesdrops())
     , m_xwaylandEavesdropsMouse(Options::defaultXwaylandEavesdropsMouse())
     , m_xwaylandEisNoPrompt(Options::defaultXwaylandEisNoPrompt())
+    , m_xwaylandIdleTimeout(Options::defaultXwaylandIdleTimeout())
+    , m_xwaylandPrewarm(Options::defaultXwaylandPrewarm())
     , m_compositingMode(Options::defaultCompositingMode())
     , OpTitlebarDblClick(Options::defaultOperationTitlebarDblClick())
     , CmdActiveTitlebar1(Options::defaultCommandActiveTitlebar1())
@@ -166,6 +168,24 @@ void Options::setXWaylandEisNoPrompt(bool doNotPrompt)
     Q_EMIT xwaylandEisNoPromptChanged();
 }
 
+void Options::setXwaylandIdleTimeout(int timeout)
+{
+    if (m_xwaylandIdleTimeout == timeout) {
+        return;
+    }
+    m_xwaylandIdleTimeout = timeout;
+    Q_EMIT xwaylandIdleTimeoutChanged();
+}
+
+void Options::setXwaylandPrewarm(bool prewarm)
+{
+    if (m_xwaylandPrewarm == prewarm) {
+        return;
+    }
+    m_xwaylandPrewarm = prewarm;
+    Q_EMIT xwaylandPrewarmChanged();
+}
+
 void Options::setClickRaise(bool clickRaise)
 {
     if (m_autoRaise) {
@@ -716,6 +736,8 @@ void Options::syncFromKcfgc()
     setXwaylandEavesdrops(XwaylandEavesdropsMode(m_settings->xwaylandEavesdrops()));
     setXwaylandEavesdropsMouse(m_settings->xwaylandEavesdropsMouse());
     setXWaylandEisNoPrompt(m_settings->xwaylandEisNoPrompt());
+    setXwaylandIdleTimeout(m_settings->xwaylandIdleTimeout());
+    setXwaylandPrewarm(m_settings->xwaylandPrewarm());
     setPlacement(m_settings->placement());
     setAutoRaise(m_settings->autoRaise());
     setAutoRaiseInterval(m_settings->autoRaiseInterval());
@@ -73,6 +73,8 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(FocusPolicy focusPolicy READ focusPolicy WRITE setFocusPolicy NOTIFY focusPolicyChanged)
     Q_PROPERTY(XwaylandCrashPolicy xwaylandCrashPolicy READ xwaylandCrashPolicy WRITE setXwaylandCrashPolicy NOTIFY xwaylandCrashPolicyChanged)
     Q_PROPERTY(int xwaylandMaxCrashCount READ xwaylandMaxCrashCount WRITE setXwaylandMaxCrashCount NOTIFY xwaylandMaxCrashCountChanged)
+    Q_PROPERTY(int xwaylandIdleTimeout READ xwaylandIdleTimeout WRITE setXwaylandIdleTimeout NOTIFY xwaylandIdleTimeoutChanged)
+    Q_PROPERTY(bool xwaylandPrewarm READ xwaylandPrewarm WRITE setXwaylandPrewarm NOTIFY xwaylandPrewarmChanged)
     Q_PROPERTY(bool nextFocusPrefersMouse READ isNextFocusPrefersMouse WRITE setNextFocusPrefersMouse NOTIFY nextFocusPrefersMouseChanged)
     /**
      * Whether clicking on a window raises it in FocusFollowsMouse
@@ -257,6 +259,22 @@ public:
     {
         return m_xwaylandEisNoPrompt;
     }
+    /**
+     * The number of seconds the Xwayland server keeps running without any X11 clients
+     * before it is stopped, or 0 to keep it running. It is started again on demand.
+     */
+    int xwaylandIdleTimeout() const
+    {
+        return m_xwaylandIdleTimeout;
+    }
+    /**
+     * Whether the Xwayland server is started at login if X11 clients have been used in
+     * one of the previous sessions, instead of waiting for the first X11 client.
+     */
+    bool xwaylandPrewarm() const
+    {
+        return m_xwaylandPrewarm;
+    }
 
     /**
      * Whether clicking on a window raises it in FocusFollowsMouse
@@ -643,6 +661,8 @@ public:
     void setXwaylandEavesdrops(XwaylandEavesdropsMode mode);
     void setXwaylandEavesdropsMouse(bool eavesdropsMouse);
     void setXWaylandEisNoPrompt(bool doNotPrompt);
+    void setXwaylandIdleTimeout(int timeout);
+    void setXwaylandPrewarm(bool prewarm);
     void setNextFocusPrefersMouse(bool nextFocusPrefersMouse);
     void setClickRaise(bool clickRaise);
     void setAutoRaise(bool autoRaise);
@@ -795,6 +815,14 @@ public:
     {
         return false;
     }
+    static int defaultXwaylandIdleTimeout()
+    {
+        return 0;
+    }
+    static bool defaultXwaylandPrewarm()
+    {
+        return false;
+    }
     static ActivationDesktopPolicy defaultActivationDesktopPolicy()
     {
         return ActivationDesktopPolicy::SwitchToOtherDesktop;
@@ -815,6 +843,8 @@ Q_SIGNALS:
     void xwaylandEavesdropsChanged();
     void xwaylandEavesdropsMouseChanged();
     void xwaylandEisNoPromptChanged();
+    void xwaylandIdleTimeoutChanged();
+    void xwaylandPrewarmChanged();
     void nextFocusPrefersMouseChanged();
     void clickRaiseChanged();
     void autoRaiseChanged();
@@ -895,6 +925,8 @@ private:
     XwaylandEavesdropsMode m_xwaylandEavesdrops;
     bool m_xwaylandEavesdropsMouse;
     bool m_xwaylandEisNoPrompt;
+    int m_xwaylandIdleTimeout;
+    bool m_xwaylandPrewarm;
 
     CompositingType m_compositingMode;
     WindowOperation OpTitlebarDblClick;
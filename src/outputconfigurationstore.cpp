@@ -22,19 +22,64 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QOrientationReading>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrentRun>
 #include <ranges>
 
 namespace KWin
 {
 
+static QThreadPool *writerThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(1);
+        pool->setObjectName(QStringLiteral("KWin output config writer"));
+        return pool;
+    }();
+    return pool;
+}
+
+static QString configFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/kwinoutputconfig.json";
+}
+
+static void writeConfigFile(const QString &path, const QByteArray &data)
+{
+    // Write a new file and rename it over the old one, so the config is never left half written
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qCWarning(KWIN_OUTPUT_CONFIG, "Couldn't open output config file %s", qPrintable(path));
+        return;
+    }
+    f.write(data);
+    if (!f.commit()) {
+        qCWarning(KWIN_OUTPUT_CONFIG, "Couldn't write output config file %s", qPrintable(path));
+    }
+}
+
 OutputConfigurationStore::OutputConfigurationStore()
+    : m_saveTimer(std::make_unique<QTimer>())
 {
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(1000);
+    m_saveTimer->callOnTimeout([this]() {
+        writeFile();
+    });
     load();
 }
 
 OutputConfigurationStore::~OutputConfigurationStore()
 {
     save();
+    m_saveTimer->stop();
+    m_pendingWrite.waitForFinished();
+    if (!m_pendingData.isNull()) {
+        writeConfigFile(configFilePath(), m_pendingData);
+    }
 }
 
 std::optional<std::pair<OutputConfiguration, OutputConfigurationStore::ConfigType>> OutputConfigurationStore::queryConfig(const QList<BackendOutput *> &outputs, bool isLidClosed, QOrientationReading *orientation, bool isTabletMode)
@@ -800,11 +845,15 @@ void OutputConfigurationStore::load()
         return;
     }
     QJsonParseError error;
-    const auto doc = QJsonDocument::fromJson(f.readAll(), &error);
+    const QByteArray data = f.readAll();
+    const auto doc = QJsonDocument::fromJson(data, &error);
     if (error.error != QJsonParseError::NoError) {
         qCWarning(KWIN_OUTPUT_CONFIG) << "Failed to parse" << jsonPath << error.errorString();
         return;
     }
+    if (jsonPath == configFilePath()) {
+        m_writtenData = data;
+    }
     const auto array = doc.array();
     std::vector<QJsonObject> objects;
     std::transform(array.begin(), array.end(), std::back_inserter(objects), [](const auto &json) {
@@ -955,6 +1004,8 @@ void OutputConfigurationStore::load()
         }
         if (const auto it = data.find("iccProfilePath"); it != data.end()) {
             state.iccProfilePath = it->toString();
+            // outputs are most likely going to be configured with the profile soon
+            IccProfile::preload(*state.iccProfilePath);
         }
         if (const auto it = data.find("maxPeakBrightnessOverride"); it != data.end() && it->isDouble()) {
             state.maxPeakBrightnessOverride = it->toDouble();
@@ -1352,15 +1403,30 @@ void OutputConfigurationStore::save()
     setups["data"] = setupData;
     array.append(setups);
 
-    const QString path = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/kwinoutputconfig.json";
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly)) {
-        qCWarning(KWIN_OUTPUT_CONFIG, "Couldn't open output config file %s", qPrintable(path));
+    document.setArray(array);
+    QByteArray data = document.toJson();
+    if (data == (m_pendingData.isNull() ? m_writtenData : m_pendingData)) {
         return;
     }
-    document.setArray(array);
-    f.write(document.toJson());
-    f.flush();
+    if (data == m_writtenData) {
+        // The configuration has gone back to what's on disk already
+        m_pendingData = QByteArray();
+        m_saveTimer->stop();
+        return;
+    }
+    m_pendingData = std::move(data);
+    m_saveTimer->start();
+}
+
+void OutputConfigurationStore::writeFile()
+{
+    if (m_pendingData.isNull()) {
+        return;
+    }
+    // The writes must reach the disk in order
+    m_pendingWrite.waitForFinished();
+    m_writtenData = std::exchange(m_pendingData, QByteArray());
+    m_pendingWrite = QtConcurrent::run(writerThreadPool(), writeConfigFile, configFilePath(), m_writtenData);
 }
 
 bool OutputConfigurationStore::isAutoRotateActive(const QList<BackendOutput *> &outputs, bool isTabletMode) const
@@ -10,6 +10,7 @@
 
 #include "core/backendoutput.h"
 
+#include <QFuture>
 #include <QList>
 #include <QPoint>
 #include <QSize>
@@ -19,6 +20,7 @@
 #include <unordered_map>
 
 class QOrientationReading;
+class QTimer;
 
 namespace KWin
 {
@@ -50,6 +52,7 @@ private:
     double chooseScale(BackendOutput *output, OutputMode *mode) const;
     void load();
     void save();
+    void writeFile();
 
     struct ModeData
     {
@@ -111,5 +114,12 @@ private:
 
     QList<OutputState> m_outputs;
     QList<Setup> m_setups;
+
+    // Hotplugging stores the configuration many times in a row, it's written out only once
+    // things have settled down, and off the main thread
+    std::unique_ptr<QTimer> m_saveTimer;
+    QByteArray m_writtenData;
+    QByteArray m_pendingData;
+    QFuture<void> m_pendingWrite;
 };
 }
@@ -15,7 +15,7 @@ namespace KWin
 {
 
 PlaceholderInputEventFilter::PlaceholderInputEventFilter()
-    : InputEventFilter(InputFilterOrder::PlaceholderOutput)
+    : InputEventFilter(InputFilterOrder::PlaceholderOutput, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch)
 {
 }
 
@@ -14,6 +14,7 @@
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
 #include "effect/effecthandler.h"
+#include "opengl/glpassprofiler.h"
 #include "opengl/glplatform.h"
 #include "scene/decorationitem.h"
 #include "scene/scene.h"
@@ -29,12 +30,14 @@
 #include "utils/xcbutils.h"
 #endif
 
+#include <QFile>
 #include <QGuiApplication>
 #include <QMatrix4x4>
 #include <QScreen>
 #include <QTime>
 #include <QTimer>
 #include <QWindow>
+#include <algorithm>
 #include <cmath> // for ceil()
 #include <cstdlib>
 
@@ -120,6 +123,11 @@ BlurEffect::BlurEffect()
         m_upsamplePass.halfpixelLocation = m_upsamplePass.shader->uniformLocation("halfpixel");
     }
 
+    // Images can only be written to textures with immutable storage on OpenGL ES
+    const EglContext *context = EglContext::currentContext();
+    m_computePass.supported = context->supportsComputeShaders() && context->supportsTextureStorage()
+        && qEnvironmentVariable("KWIN_BLUR_COMPUTE") != QLatin1String("0");
+
     m_noisePass.shader = ShaderManager::instance()->generateShaderFromFile(ShaderTrait::MapTexture,
                                                                            QStringLiteral(":/effects/blur/shaders/vertex.vert"),
                                                                            QStringLiteral(":/effects/blur/shaders/noise.frag"));
@@ -134,6 +142,8 @@ BlurEffect::BlurEffect()
     initBlurStrengthValues();
     reconfigure(ReconfigureAll);
 
+    m_mergeRegions = qEnvironmentVariableIntValue("KWIN_BLUR_MERGE_REGIONS") == 1;
+
 #if KWIN_BUILD_X11
     if (effects->xcbConnection()) {
         net_wm_blur_region = effects->announceSupportProperty(s_blurAtomName, this);
@@ -169,6 +179,7 @@ BlurEffect::BlurEffect()
     connect(effects, &EffectsHandler::windowAdded, this, &BlurEffect::slotWindowAdded);
     connect(effects, &EffectsHandler::windowDeleted, this, &BlurEffect::slotWindowDeleted);
     connect(effects, &EffectsHandler::viewRemoved, this, &BlurEffect::slotViewRemoved);
+    connect(effects, &EffectsHandler::stackingOrderChanged, this, &BlurEffect::invalidateBlurCache);
 #if KWIN_BUILD_X11
     connect(effects, &EffectsHandler::propertyNotify, this, &BlurEffect::slotPropertyNotify);
     connect(effects, &EffectsHandler::xcbConnectionChanged, this, [this]() {
@@ -294,13 +305,14 @@ void BlurEffect::reconfigure(ReconfigureFlags flags)
 {
     BlurConfig::self()->read();
 
-    int blurStrength = BlurConfig::blurStrength() - 1;
-    m_iterationCount = blurStrengthValues[blurStrength].iteration;
-    m_offset = blurStrengthValues[blurStrength].offset;
-    m_expandSize = blurOffsets[m_iterationCount - 1].expandSize;
+    m_blurStrength = BlurConfig::blurStrength() - 1;
+    m_effectiveBlurStrength = -1;
+    updateBlurStrength();
     m_noiseStrength = BlurConfig::noiseStrength();
     m_saturation = BlurConfig::saturation() / 100.0;
 
+    invalidateBlurCache();
+
     // Update all windows for the blur to take effect
     effects->addRepaintFull();
 }
@@ -421,6 +433,35 @@ void BlurEffect::slotViewRemoved(KWin::RenderView *view)
             data.render.erase(it);
         }
     }
+    m_viewFrames.erase(view);
+    if (auto it = m_groupRender.find(view); it != m_groupRender.end()) {
+        effects->makeOpenGLContextCurrent();
+        m_groupRender.erase(it);
+    }
+}
+
+bool BlurEffect::updateBlurStrength()
+{
+    // While frames miss their budget, blur with fewer passes and come back as they recover
+    const int blurStrength = std::max(0, int(std::ceil((m_blurStrength + 1) * effects->renderQuality())) - 1);
+    if (blurStrength == m_effectiveBlurStrength) {
+        return false;
+    }
+    m_effectiveBlurStrength = blurStrength;
+    m_iterationCount = blurStrengthValues[blurStrength].iteration;
+    m_offset = blurStrengthValues[blurStrength].offset;
+    m_expandSize = blurOffsets[m_iterationCount - 1].expandSize;
+    return true;
+}
+
+void BlurEffect::invalidateBlurCache()
+{
+    // The windows behind a window may have changed, or the blur is computed differently
+    for (auto &[window, data] : m_windows) {
+        for (auto &[view, renderInfo] : data.render) {
+            renderInfo.valid = false;
+        }
+    }
 }
 
 #if KWIN_BUILD_X11
@@ -480,7 +521,13 @@ bool BlurEffect::enabledByDefault()
 
 bool BlurEffect::supported()
 {
-    return effects->isOpenGLCompositing();
+    if (!effects->isOpenGLCompositing()) {
+        return false;
+    }
+    // every blurred window costs several passes over its background, which llvmpipe can't
+    // keep up with even when the blur has been enabled on a machine with a real gpu
+    const auto context = effects->openglContext();
+    return context && !context->isSoftwareRenderer();
 }
 
 bool BlurEffect::decorationSupportsBlurBehind(const EffectWindow *w) const
@@ -530,8 +577,35 @@ void BlurEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseco
     m_paintedDeviceArea = QRegion();
     m_currentDeviceBlur = QRegion();
     m_currentView = data.view;
+    m_currentFrame = ++m_viewFrames[data.view];
+    m_windowRepaints.clear();
+    m_blurGroups.clear();
+
+    if (updateBlurStrength()) {
+        invalidateBlurCache();
+        effects->addRepaintFull();
+    }
 
     effects->prePaintScreen(data, presentTime);
+
+    // Windows can be painted anywhere if the screen is transformed
+    m_groupWindows = m_mergeRegions && !(data.mask & (PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS));
+}
+
+void BlurEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen)
+{
+    m_screenDamage = deviceRegion;
+    effects->paintScreen(renderTarget, viewport, mask, deviceRegion, screen);
+}
+
+static QRegion pendingRepaints(Item *item, RenderView *view)
+{
+    QRegion repaints = item->deviceRepaints(view);
+    const auto childItems = item->childItems();
+    for (Item *childItem : childItems) {
+        repaints += pendingRepaints(childItem, view);
+    }
+    return repaints;
 }
 
 void BlurEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
@@ -540,6 +614,27 @@ void BlurEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePain
 
     effects->prePaintWindow(view, w, data, presentTime);
 
+    if (!m_windows.empty()) {
+        // The scene takes the repaints of the windows only after all of them have been prepared,
+        // remember them to know later whose contents have changed
+        m_windowRepaints.push_back(WindowRepaints{
+            .window = w,
+            .deviceRegion = pendingRepaints(w->windowItem(), view),
+        });
+
+        // If the window hasn't been painted in the previous frame, e.g. because it was
+        // occluded, the background behind it may have changed unnoticed
+        if (auto it = m_windows.find(w); it != m_windows.end()) {
+            if (auto renderIt = it->second.render.find(view); renderIt != it->second.render.end()) {
+                BlurRenderData &renderInfo = renderIt->second;
+                if (renderInfo.lastFrame + 1 != m_currentFrame) {
+                    renderInfo.valid = false;
+                }
+                renderInfo.lastFrame = m_currentFrame;
+            }
+        }
+    }
+
     const QRegion oldOpaque = data.deviceOpaque;
     if (data.deviceOpaque.intersects(m_currentDeviceBlur)) {
         // to blur an area partially we have to shrink the opaque area of a window
@@ -577,6 +672,45 @@ void BlurEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePain
 
     m_paintedDeviceArea -= data.deviceOpaque;
     m_paintedDeviceArea += data.devicePaint;
+
+    if (m_groupWindows) {
+        updateBlurGroups(view, w, data, blurArea.boundingRect());
+    }
+}
+
+void BlurEffect::updateBlurGroups(RenderView *view, EffectWindow *w, const WindowPrePaintData &data, const QRect &deviceBlurRect)
+{
+    if (data.mask & PAINT_WINDOW_TRANSFORMED) {
+        // Nothing is known about where the window is going to be painted
+        m_blurGroups.push_back(BlurGroup{});
+        return;
+    }
+
+    if (!deviceBlurRect.isEmpty() && !w->isDesktop() && m_windows.contains(w)) {
+        // A window can share the blurred background with the windows below it only if nothing
+        // is painted over its background after them, and if it doesn't add too much area that
+        // needs to be blurred for nothing.
+        bool merge = false;
+        if (!m_blurGroups.empty()) {
+            const BlurGroup &group = m_blurGroups.back();
+            const QRect united = group.deviceRect | deviceBlurRect;
+            const qint64 unitedArea = qint64(united.width()) * united.height();
+            const qint64 blurredArea = group.blurredArea + qint64(deviceBlurRect.width()) * deviceBlurRect.height();
+            merge = !group.windows.empty() && !group.devicePainted.intersects(deviceBlurRect) && unitedArea * 4 <= blurredArea * 5;
+        }
+        if (!merge) {
+            m_blurGroups.push_back(BlurGroup{});
+        }
+
+        BlurGroup &group = m_blurGroups.back();
+        group.windows.push_back(w);
+        group.deviceRect |= deviceBlurRect;
+        group.blurredArea += qint64(deviceBlurRect.width()) * deviceBlurRect.height();
+    }
+
+    if (!m_blurGroups.empty()) {
+        m_blurGroups.back().devicePainted += view->mapToDeviceCoordinatesAligned(w->expandedGeometry());
+    }
 }
 
 bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const
@@ -643,6 +777,517 @@ GLTexture *BlurEffect::ensureNoiseTexture()
     return m_noisePass.noiseTexture.get();
 }
 
+QRegion BlurEffect::foregroundDamage(const EffectWindow *w) const
+{
+    // Damage that only the window itself or the windows above it have caused doesn't change
+    // what is behind the window. Anything else, e.g. repaints scheduled by effects, does.
+    QRegion above;
+    QRegion below;
+    bool found = false;
+    for (const WindowRepaints &repaints : m_windowRepaints) {
+        if (repaints.window == w) {
+            found = true;
+        }
+        if (found) {
+            above += repaints.deviceRegion;
+        } else {
+            below += repaints.deviceRegion;
+        }
+    }
+    return above - below;
+}
+
+// Only parts of the blurred background are computed again, in tiles of this many logical pixels.
+static const int s_blurTileSize = 64;
+
+static QRect snapToBlurTiles(const QRect &rect)
+{
+    const int x0 = std::floor(rect.left() / qreal(s_blurTileSize)) * s_blurTileSize;
+    const int y0 = std::floor(rect.top() / qreal(s_blurTileSize)) * s_blurTileSize;
+    const int x1 = std::ceil((rect.x() + rect.width()) / qreal(s_blurTileSize)) * s_blurTileSize;
+    const int y1 = std::ceil((rect.y() + rect.height()) / qreal(s_blurTileSize)) * s_blurTileSize;
+    return QRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+/**
+ * Returns the areas of the textures that must be computed again if the @a damage in the background
+ * has changed, in logical pixels, one for every texture. The area of a texture must contain
+ * everything the downsample pass reads when computing the area of the next texture, otherwise
+ * it would mix in what the upsample pass has written there in the previous frame.
+ */
+static std::vector<QRegion> blurDamage(const QRegion &damage, const QRect &localRect, size_t iterationCount, float offset)
+{
+    // How far the samples of a pass reach, in logical pixels
+    const auto downsampleReach = [offset](size_t level) {
+        return int(std::ceil((0.5 * offset + 1) * (1 << (level - 1)))) + (1 << level);
+    };
+    const auto upsampleReach = [offset](size_t level) {
+        return int(std::ceil((offset + 1) * (1 << level))) + (1 << level);
+    };
+
+    std::vector<int> margins(iterationCount + 1, 0);
+    for (size_t i = 1; i <= iterationCount; ++i) {
+        margins[iterationCount] += downsampleReach(i);
+    }
+    for (size_t i = 2; i <= iterationCount; ++i) {
+        margins[iterationCount] += upsampleReach(i);
+    }
+    for (size_t i = iterationCount; i > 1; --i) {
+        margins[i - 1] = margins[i] + downsampleReach(i);
+    }
+
+    std::vector<QRegion> regions(iterationCount + 1);
+    for (size_t i = 1; i <= iterationCount; ++i) {
+        for (const QRect &rect : damage) {
+            regions[i] += snapToBlurTiles(rect.adjusted(-margins[i], -margins[i], margins[i], margins[i]));
+        }
+        regions[i] &= localRect;
+    }
+    return regions;
+}
+
+static QRect blurTileTexels(const QRect &rect, const QSize &localSize, const QSize &size)
+{
+    const qreal xScale = qreal(size.width()) / localSize.width();
+    const qreal yScale = qreal(size.height()) / localSize.height();
+
+    const int x0 = std::floor(rect.left() * xScale);
+    const int y0 = std::floor(rect.top() * yScale);
+    const int x1 = std::ceil((rect.x() + rect.width()) * xScale);
+    const int y1 = std::ceil((rect.y() + rect.height()) * yScale);
+
+    // The offscreen textures are upside down
+    return QRect(x0, size.height() - y1, x1 - x0, y1 - y0) & QRect(QPoint(0, 0), size);
+}
+
+static void scissorBlurTile(const QRect &rect, const QSize &localSize, const GLFramebuffer *framebuffer)
+{
+    const QRect texels = blurTileTexels(rect, localSize, framebuffer->size());
+    glScissor(texels.x(), texels.y(), texels.width(), texels.height());
+}
+
+static const char *imageFormatQualifier(GLenum textureFormat)
+{
+    const bool gles = EglContext::currentContext()->isOpenGLES();
+    switch (textureFormat) {
+    case GL_RGBA8:
+        return "rgba8";
+    case GL_RGBA16F:
+        return "rgba16f";
+    case GL_RGB10_A2:
+        return gles ? nullptr : "rgb10_a2";
+    case GL_RGBA16:
+        return gles ? nullptr : "rgba16";
+    default:
+        return nullptr;
+    }
+}
+
+bool BlurEffect::ensureComputeKernels(GLenum textureFormat)
+{
+    if (auto it = m_computePass.kernels.find(textureFormat); it != m_computePass.kernels.end()) {
+        return it->second.has_value();
+    }
+
+    // Failures are remembered, the fragment shaders are used for the format instead
+    std::optional<ComputeKernels> &kernels = m_computePass.kernels[textureFormat];
+
+    const char *qualifier = imageFormatQualifier(textureFormat);
+    if (!qualifier) {
+        return false;
+    }
+
+    const auto loadKernel = [qualifier](const QString &fileName) -> std::optional<ComputeKernel> {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCWarning(KWIN_BLUR) << "Failed to read" << fileName;
+            return std::nullopt;
+        }
+        QByteArray source = file.readAll();
+        source.replace("IMAGE_FORMAT", qualifier);
+
+        std::unique_ptr<GLShader> shader = ShaderManager::instance()->loadComputeShaderFromCode(source);
+        if (!shader->isValid()) {
+            qCWarning(KWIN_BLUR) << "Failed to load compute shader" << fileName;
+            return std::nullopt;
+        }
+
+        ComputeKernel kernel{
+            .shader = std::move(shader),
+        };
+        kernel.offsetLocation = kernel.shader->uniformLocation("offset");
+        kernel.halfpixelLocation = kernel.shader->uniformLocation("halfpixel");
+        kernel.regionLocation = kernel.shader->uniformLocation("region");
+        return kernel;
+    };
+
+    auto downsample = loadKernel(QStringLiteral(":/effects/blur/shaders/downsample.comp"));
+    auto upsample = loadKernel(QStringLiteral(":/effects/blur/shaders/upsample.comp"));
+    if (!downsample || !upsample) {
+        return false;
+    }
+
+    kernels = ComputeKernels{
+        .downsample = std::move(*downsample),
+        .upsample = std::move(*upsample),
+    };
+    return true;
+}
+
+void BlurEffect::blurTexturesCompute(BlurRenderData &renderInfo, const QSize &size, const std::vector<QRegion> &tiles)
+{
+    const GLenum textureFormat = renderInfo.textures[0]->internalFormat();
+    const ComputeKernels &kernels = *m_computePass.kernels[textureFormat];
+
+    // Writes the texture at the given level of the blur, only the damaged tiles if possible.
+    const auto dispatch = [&](const ComputeKernel &kernel, size_t level) {
+        const GLTexture *texture = renderInfo.textures[level].get();
+        glBindImageTexture(0, texture->texture(), 0, GL_FALSE, 0, GL_WRITE_ONLY, textureFormat);
+
+        const auto run = [&](const QRect &texels) {
+            if (texels.isEmpty()) {
+                return;
+            }
+            kernel.shader->setUniform(kernel.regionLocation, QVector4D(texels.x(), texels.y(), texels.width(), texels.height()));
+            glDispatchCompute((texels.width() + 7) / 8, (texels.height() + 7) / 8, 1);
+        };
+        if (tiles.empty()) {
+            run(QRect(QPoint(0, 0), texture->size()));
+        } else {
+            for (const QRect &tile : tiles[level]) {
+                run(blurTileTexels(tile, size, texture->size()));
+            }
+        }
+
+        // The next iteration samples what has been written
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    };
+
+    {
+        GLPassScope passScope(u"blur downsample");
+        ShaderManager::instance()->pushShader(kernels.downsample.shader.get());
+        kernels.downsample.shader->setUniform(kernels.downsample.offsetLocation, float(m_offset));
+
+        for (size_t i = 1; i < renderInfo.textures.size(); ++i) {
+            const auto &read = renderInfo.textures[i - 1];
+
+            const QVector2D halfpixel(0.5 / read->width(), 0.5 / read->height());
+            kernels.downsample.shader->setUniform(kernels.downsample.halfpixelLocation, halfpixel);
+
+            read->bind();
+            dispatch(kernels.downsample, i);
+        }
+
+        ShaderManager::instance()->popShader();
+    }
+
+    {
+        GLPassScope passScope(u"blur upsample");
+        ShaderManager::instance()->pushShader(kernels.upsample.shader.get());
+        kernels.upsample.shader->setUniform(kernels.upsample.offsetLocation, float(m_offset));
+
+        for (size_t i = renderInfo.textures.size() - 1; i > 1; --i) {
+            const auto &read = renderInfo.textures[i];
+
+            const QVector2D halfpixel(0.5 / read->width(), 0.5 / read->height());
+            kernels.upsample.shader->setUniform(kernels.upsample.halfpixelLocation, halfpixel);
+
+            read->bind();
+            dispatch(kernels.upsample, i - 1);
+        }
+
+        ShaderManager::instance()->popShader();
+    }
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, textureFormat);
+
+    // The textures are also drawn into and blitted from the next time
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+
+    renderInfo.valid = true;
+}
+
+static size_t appendBlurQuad(std::span<GLVertex2D> map, size_t index, const QRectF &rect, const QSizeF &textureSize)
+{
+    const float x0 = rect.left();
+    const float y0 = rect.top();
+    const float x1 = rect.right();
+    const float y1 = rect.bottom();
+
+    const float u0 = x0 / textureSize.width();
+    const float v0 = 1.0f - y0 / textureSize.height();
+    const float u1 = x1 / textureSize.width();
+    const float v1 = 1.0f - y1 / textureSize.height();
+
+    // first triangle
+    map[index++] = GLVertex2D{
+        .position = QVector2D(x0, y0),
+        .texcoord = QVector2D(u0, v0),
+    };
+    map[index++] = GLVertex2D{
+        .position = QVector2D(x1, y1),
+        .texcoord = QVector2D(u1, v1),
+    };
+    map[index++] = GLVertex2D{
+        .position = QVector2D(x0, y1),
+        .texcoord = QVector2D(u0, v1),
+    };
+
+    // second triangle
+    map[index++] = GLVertex2D{
+        .position = QVector2D(x0, y0),
+        .texcoord = QVector2D(u0, v0),
+    };
+    map[index++] = GLVertex2D{
+        .position = QVector2D(x1, y0),
+        .texcoord = QVector2D(u1, v0),
+    };
+    map[index++] = GLVertex2D{
+        .position = QVector2D(x1, y1),
+        .texcoord = QVector2D(u1, v1),
+    };
+
+    return index;
+}
+
+bool BlurEffect::ensureBlurTextures(BlurRenderData &renderInfo, const QSize &size, GLenum textureFormat)
+{
+    if (renderInfo.framebuffers.size() == (m_iterationCount + 1) && renderInfo.textures[0]->size() == size && renderInfo.textures[0]->internalFormat() == textureFormat) {
+        return true;
+    }
+
+    renderInfo.framebuffers.clear();
+    renderInfo.textures.clear();
+    renderInfo.valid = false;
+
+    glClearColor(0, 0, 0, 0);
+    for (size_t i = 0; i <= m_iterationCount; ++i) {
+        auto texture = GLTexture::allocate(textureFormat, size / (1 << i));
+        if (!texture) {
+            qCWarning(KWIN_BLUR) << "Failed to allocate an offscreen texture";
+            renderInfo.framebuffers.clear();
+            renderInfo.textures.clear();
+            return false;
+        }
+        texture->setFilter(GL_LINEAR);
+        texture->setWrapMode(GL_CLAMP_TO_EDGE);
+
+        auto framebuffer = std::make_unique<GLFramebuffer>(texture.get());
+        if (!framebuffer->valid()) {
+            qCWarning(KWIN_BLUR) << "Failed to create an offscreen framebuffer";
+            renderInfo.framebuffers.clear();
+            renderInfo.textures.clear();
+            return false;
+        }
+        EglContext::currentContext()->pushFramebuffer(framebuffer.get());
+        glClear(GL_COLOR_BUFFER_BIT);
+        EglContext::currentContext()->popFramebuffer();
+        renderInfo.textures.push_back(std::move(texture));
+        renderInfo.framebuffers.push_back(std::move(framebuffer));
+    }
+
+    return true;
+}
+
+void BlurEffect::blurTextures(BlurRenderData &renderInfo, const QSize &size, GLVertexBuffer *vbo, const std::vector<QRegion> &tiles)
+{
+    if (m_computePass.supported && ensureComputeKernels(renderInfo.textures[0]->internalFormat())) {
+        blurTexturesCompute(renderInfo, size, tiles);
+        return;
+    }
+
+    // Draws into the texture at the given level of the blur, only the damaged tiles if possible.
+    const auto drawLevel = [&](size_t level) {
+        if (tiles.empty()) {
+            vbo->draw(GL_TRIANGLES, 0, 6);
+            return;
+        }
+        for (const QRect &tile : tiles[level]) {
+            scissorBlurTile(tile, size, renderInfo.framebuffers[level].get());
+            vbo->draw(GL_TRIANGLES, 0, 6);
+        }
+    };
+
+    if (!tiles.empty()) {
+        glEnable(GL_SCISSOR_TEST);
+    }
+
+    // The downsample pass of the dual Kawase algorithm: the background will be scaled down 50% every iteration.
+    {
+        GLPassScope passScope(u"blur downsample");
+        ShaderManager::instance()->pushShader(m_downsamplePass.shader.get());
+
+        QMatrix4x4 projectionMatrix;
+        projectionMatrix.ortho(QRectF(0.0, 0.0, size.width(), size.height()));
+
+        m_downsamplePass.shader->setUniform(m_downsamplePass.mvpMatrixLocation, projectionMatrix);
+        m_downsamplePass.shader->setUniform(m_downsamplePass.offsetLocation, float(m_offset));
+
+        for (size_t i = 1; i < renderInfo.framebuffers.size(); ++i) {
+            const auto &read = renderInfo.framebuffers[i - 1];
+            const auto &draw = renderInfo.framebuffers[i];
+
+            const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
+                                      0.5 / read->colorAttachment()->height());
+            m_downsamplePass.shader->setUniform(m_downsamplePass.halfpixelLocation, halfpixel);
+
+            read->colorAttachment()->bind();
+
+            GLFramebuffer::pushFramebuffer(draw.get());
+            drawLevel(i);
+        }
+
+        ShaderManager::instance()->popShader();
+    }
+
+    // The upsample pass of the dual Kawase algorithm: the background will be scaled up 200% every iteration.
+    {
+        GLPassScope passScope(u"blur upsample");
+        ShaderManager::instance()->pushShader(m_upsamplePass.shader.get());
+
+        QMatrix4x4 projectionMatrix;
+        projectionMatrix.ortho(QRectF(0.0, 0.0, size.width(), size.height()));
+
+        m_upsamplePass.shader->setUniform(m_upsamplePass.mvpMatrixLocation, projectionMatrix);
+        m_upsamplePass.shader->setUniform(m_upsamplePass.offsetLocation, float(m_offset));
+
+        for (size_t i = renderInfo.framebuffers.size() - 1; i > 1; --i) {
+            GLFramebuffer::popFramebuffer();
+            const auto &read = renderInfo.framebuffers[i];
+
+            const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
+                                      0.5 / read->colorAttachment()->height());
+            m_upsamplePass.shader->setUniform(m_upsamplePass.halfpixelLocation, halfpixel);
+
+            read->colorAttachment()->bind();
+
+            drawLevel(i - 1);
+        }
+
+        ShaderManager::instance()->popShader();
+    }
+
+    GLFramebuffer::popFramebuffer();
+
+    if (!tiles.empty()) {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    renderInfo.valid = true;
+}
+
+BlurEffect::BlurGroup *BlurEffect::findBlurGroup(const EffectWindow *w)
+{
+    for (BlurGroup &group : m_blurGroups) {
+        if (std::ranges::find(group.windows, w) != group.windows.end()) {
+            return group.windows.size() > 1 ? &group : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void BlurEffect::blurGroup(const RenderTarget &renderTarget, const RenderViewport &viewport, BlurGroup &group, GLenum textureFormat)
+{
+    // Only windows whose unblurred background is already cached can take part, the parts of it
+    // that have not been repainted in this frame can't be fetched from the render target.
+    QRect groupRect;
+    QRegion memberArea;
+    QRegion dirtyRegion;
+    std::vector<std::pair<EffectWindow *, QRect>> members;
+    const QRegion screenDamage = viewport.mapFromDeviceCoordinatesContained(m_screenDamage);
+    for (EffectWindow *window : group.windows) {
+        const auto it = m_windows.find(window);
+        if (it == m_windows.end()) {
+            continue;
+        }
+        const QRect backgroundRect = blurRegion(window).boundingRect().translated(window->pos().toPoint());
+        const BlurRenderData &renderInfo = it->second.render[m_currentView];
+        if (renderInfo.textures.empty() || renderInfo.backgroundRect != backgroundRect || renderInfo.scale != viewport.scale()
+            || renderInfo.textures[0]->size() != backgroundRect.size() || renderInfo.textures[0]->internalFormat() != textureFormat) {
+            continue;
+        }
+        members.emplace_back(window, backgroundRect);
+        groupRect |= backgroundRect;
+        memberArea += backgroundRect;
+        dirtyRegion += screenDamage & backgroundRect;
+    }
+    if (members.size() < 2 || dirtyRegion.isEmpty()) {
+        return;
+    }
+
+    // The textures of the groups are reused in the next frame if the groups stay the same
+    auto &groupRender = m_groupRender[m_currentView];
+    groupRender.resize(m_blurGroups.size());
+    BlurRenderData &renderInfo = groupRender[&group - m_blurGroups.data()];
+    if (!ensureBlurTextures(renderInfo, groupRect.size(), textureFormat)) {
+        return;
+    }
+
+    // Fetch the pixels behind every window and put them together. Nothing has been painted over
+    // the other windows yet, the group is split otherwise.
+    for (const auto &[window, backgroundRect] : members) {
+        BlurRenderData &memberInfo = m_windows[window].render[m_currentView];
+        for (const QRect &dirtyRect : screenDamage & backgroundRect) {
+            memberInfo.framebuffers[0]->blitFromRenderTarget(renderTarget, viewport, dirtyRect, dirtyRect.translated(-backgroundRect.topLeft()));
+        }
+
+        GLFramebuffer::pushFramebuffer(memberInfo.framebuffers[0].get());
+        renderInfo.framebuffers[0]->blitFromFramebuffer(QRect(QPoint(0, 0), backgroundRect.size()), backgroundRect.translated(-groupRect.topLeft()), GL_NEAREST);
+        GLFramebuffer::popFramebuffer();
+
+        // The blurred textures of the window itself are out of date now
+        memberInfo.valid = false;
+    }
+
+    // The gaps between the windows only bleed into the edges of the blur
+    for (const QRect &gapRect : QRegion(groupRect) - memberArea) {
+        renderInfo.framebuffers[0]->blitFromRenderTarget(renderTarget, viewport, gapRect, gapRect.translated(-groupRect.topLeft()));
+    }
+
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setAttribLayout(std::span(GLVertexBuffer::GLVertex2DLayout), sizeof(GLVertex2D));
+    if (auto result = vbo->map<GLVertex2D>(6)) {
+        appendBlurQuad(*result, 0, QRectF(0, 0, groupRect.width(), groupRect.height()), groupRect.size());
+        vbo->unmap();
+    } else {
+        qCWarning(KWIN_BLUR) << "Failed to map vertex buffer";
+        return;
+    }
+
+    vbo->bindArrays();
+    blurTextures(renderInfo, groupRect.size(), vbo, {});
+    vbo->unbindArrays();
+
+    group.backgroundRect = groupRect;
+    group.members = std::move(members);
+    group.render = &renderInfo;
+}
+
+const BlurRenderData *BlurEffect::groupBlur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, const QRect &backgroundRect, GLenum textureFormat, QRect *groupRect)
+{
+    BlurGroup *group = findBlurGroup(w);
+    if (!group) {
+        return nullptr;
+    }
+    if (group->windows.front() == w && !group->prepared) {
+        group->prepared = true;
+        blurGroup(renderTarget, viewport, *group, textureFormat);
+    }
+    if (!group->render) {
+        return nullptr;
+    }
+
+    const auto it = std::ranges::find_if(group->members, [w](const auto &member) {
+        return member.first == w;
+    });
+    if (it == group->members.end() || it->second != backgroundRect) {
+        return nullptr;
+    }
+
+    *groupRect = group->backgroundRect;
+    return group->render;
+}
+
 void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
 {
     auto it = m_windows.find(w);
@@ -653,6 +1298,8 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
     BlurEffectData &blurInfo = it->second;
     BlurRenderData &renderInfo = blurInfo.render[m_currentView];
     if (!shouldBlur(w, mask, data)) {
+        // The background may change in the meantime without anybody noticing
+        renderInfo.valid = false;
         return;
     }
 
@@ -673,7 +1320,18 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
         blurShape.translate(std::round(data.xTranslation()), std::round(data.yTranslation()));
     }
 
-    const QRect backgroundRect = blurShape.boundingRect();
+    GLenum textureFormat = GL_RGBA8;
+    if (renderTarget.texture()) {
+        textureFormat = renderTarget.texture()->internalFormat();
+    }
+
+    // The background may have been blurred together with the neighbouring windows already.
+    QRect backgroundRect = blurShape.boundingRect();
+    const BlurRenderData *groupInfo = nullptr;
+    if (!m_blurGroups.empty()) {
+        groupInfo = groupBlur(renderTarget, viewport, w, backgroundRect, textureFormat, &backgroundRect);
+    }
+
     const QRect deviceBackgroundRect = snapToPixelGrid(scaledRect(backgroundRect, viewport.scale()));
     const QRect deviceViewport = snapToPixelGrid(scaledRect(viewport.renderRect(), viewport.scale()));
     const auto opacity = w->opacity() * data.opacity();
@@ -697,47 +1355,11 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
         }
     }
     if (effectiveShape.isEmpty()) {
-        return;
-    }
-
-    // Maybe reallocate offscreen render targets. Keep in mind that the first one contains
-    // original background behind the window, it's not blurred.
-    GLenum textureFormat = GL_RGBA8;
-    if (renderTarget.texture()) {
-        textureFormat = renderTarget.texture()->internalFormat();
-    }
-
-    if (renderInfo.framebuffers.size() != (m_iterationCount + 1) || renderInfo.textures[0]->size() != backgroundRect.size() || renderInfo.textures[0]->internalFormat() != textureFormat) {
-        renderInfo.framebuffers.clear();
-        renderInfo.textures.clear();
-
-        glClearColor(0, 0, 0, 0);
-        for (size_t i = 0; i <= m_iterationCount; ++i) {
-            auto texture = GLTexture::allocate(textureFormat, backgroundRect.size() / (1 << i));
-            if (!texture) {
-                qCWarning(KWIN_BLUR) << "Failed to allocate an offscreen texture";
-                return;
-            }
-            texture->setFilter(GL_LINEAR);
-            texture->setWrapMode(GL_CLAMP_TO_EDGE);
-
-            auto framebuffer = std::make_unique<GLFramebuffer>(texture.get());
-            if (!framebuffer->valid()) {
-                qCWarning(KWIN_BLUR) << "Failed to create an offscreen framebuffer";
-                return;
-            }
-            EglContext::currentContext()->pushFramebuffer(framebuffer.get());
-            glClear(GL_COLOR_BUFFER_BIT);
-            EglContext::currentContext()->popFramebuffer();
-            renderInfo.textures.push_back(std::move(texture));
-            renderInfo.framebuffers.push_back(std::move(framebuffer));
+        // The parts of the background next to the blur shape still bleed into it
+        if (!groupInfo && !(viewport.mapFromDeviceCoordinatesContained(deviceRegion) & backgroundRect).isEmpty()) {
+            renderInfo.valid = false;
         }
-    }
-
-    // Fetch the pixels behind the shape that is going to be blurred.
-    const QRegion dirtyRegion = viewport.mapFromDeviceCoordinatesContained(deviceRegion) & backgroundRect;
-    for (const QRect &dirtyRect : dirtyRegion) {
-        renderInfo.framebuffers[0]->blitFromRenderTarget(renderTarget, viewport, dirtyRect, dirtyRect.translated(-backgroundRect.topLeft()));
+        return;
     }
 
     // Upload the geometry: the first 6 vertices are used when downsampling and upsampling offscreen,
@@ -750,90 +1372,12 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
     if (auto result = vbo->map<GLVertex2D>(6 + vertexCount)) {
         auto map = *result;
 
-        size_t vboIndex = 0;
-
         // The geometry that will be blurred offscreen, in logical pixels.
-        {
-            const QRectF localRect = QRectF(0, 0, backgroundRect.width(), backgroundRect.height());
-
-            const float x0 = localRect.left();
-            const float y0 = localRect.top();
-            const float x1 = localRect.right();
-            const float y1 = localRect.bottom();
-
-            const float u0 = x0 / backgroundRect.width();
-            const float v0 = 1.0f - y0 / backgroundRect.height();
-            const float u1 = x1 / backgroundRect.width();
-            const float v1 = 1.0f - y1 / backgroundRect.height();
-
-            // first triangle
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x0, y0),
-                .texcoord = QVector2D(u0, v0),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x1, y1),
-                .texcoord = QVector2D(u1, v1),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x0, y1),
-                .texcoord = QVector2D(u0, v1),
-            };
-
-            // second triangle
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x0, y0),
-                .texcoord = QVector2D(u0, v0),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x1, y0),
-                .texcoord = QVector2D(u1, v0),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x1, y1),
-                .texcoord = QVector2D(u1, v1),
-            };
-        }
+        size_t vboIndex = appendBlurQuad(map, 0, QRectF(0, 0, backgroundRect.width(), backgroundRect.height()), backgroundRect.size());
 
         // The geometry that will be painted on screen, in device pixels.
         for (const QRectF &rect : effectiveShape) {
-            const float x0 = rect.left();
-            const float y0 = rect.top();
-            const float x1 = rect.right();
-            const float y1 = rect.bottom();
-
-            const float u0 = x0 / deviceBackgroundRect.width();
-            const float v0 = 1.0f - y0 / deviceBackgroundRect.height();
-            const float u1 = x1 / deviceBackgroundRect.width();
-            const float v1 = 1.0f - y1 / deviceBackgroundRect.height();
-
-            // first triangle
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x0, y0),
-                .texcoord = QVector2D(u0, v0),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x1, y1),
-                .texcoord = QVector2D(u1, v1),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x0, y1),
-                .texcoord = QVector2D(u0, v1),
-            };
-
-            // second triangle
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x0, y0),
-                .texcoord = QVector2D(u0, v0),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x1, y0),
-                .texcoord = QVector2D(u1, v0),
-            };
-            map[vboIndex++] = GLVertex2D{
-                .position = QVector2D(x1, y1),
-                .texcoord = QVector2D(u1, v1),
-            };
+            vboIndex = appendBlurQuad(map, vboIndex, rect, deviceBackgroundRect.size());
         }
 
         vbo->unmap();
@@ -844,58 +1388,45 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
     vbo->bindArrays();
 
-    // The downsample pass of the dual Kawase algorithm: the background will be scaled down 50% every iteration.
-    {
-        ShaderManager::instance()->pushShader(m_downsamplePass.shader.get());
-
-        QMatrix4x4 projectionMatrix;
-        projectionMatrix.ortho(QRectF(0.0, 0.0, backgroundRect.width(), backgroundRect.height()));
-
-        m_downsamplePass.shader->setUniform(m_downsamplePass.mvpMatrixLocation, projectionMatrix);
-        m_downsamplePass.shader->setUniform(m_downsamplePass.offsetLocation, float(m_offset));
-
-        for (size_t i = 1; i < renderInfo.framebuffers.size(); ++i) {
-            const auto &read = renderInfo.framebuffers[i - 1];
-            const auto &draw = renderInfo.framebuffers[i];
-
-            const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
-                                      0.5 / read->colorAttachment()->height());
-            m_downsamplePass.shader->setUniform(m_downsamplePass.halfpixelLocation, halfpixel);
-
-            read->colorAttachment()->bind();
-
-            GLFramebuffer::pushFramebuffer(draw.get());
-            vbo->draw(GL_TRIANGLES, 0, 6);
+    if (!groupInfo) {
+        // Maybe reallocate offscreen render targets. Keep in mind that the first one contains
+        // original background behind the window, it's not blurred.
+        if (!ensureBlurTextures(renderInfo, backgroundRect.size(), textureFormat)) {
+            vbo->unbindArrays();
+            return;
         }
 
-        ShaderManager::instance()->popShader();
-    }
-
-    // The upsample pass of the dual Kawase algorithm: the background will be scaled up 200% every iteration.
-    {
-        ShaderManager::instance()->pushShader(m_upsamplePass.shader.get());
-
-        QMatrix4x4 projectionMatrix;
-        projectionMatrix.ortho(QRectF(0.0, 0.0, backgroundRect.width(), backgroundRect.height()));
-
-        m_upsamplePass.shader->setUniform(m_upsamplePass.mvpMatrixLocation, projectionMatrix);
-        m_upsamplePass.shader->setUniform(m_upsamplePass.offsetLocation, float(m_offset));
-
-        for (size_t i = renderInfo.framebuffers.size() - 1; i > 1; --i) {
-            GLFramebuffer::popFramebuffer();
-            const auto &read = renderInfo.framebuffers[i];
-
-            const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
-                                      0.5 / read->colorAttachment()->height());
-            m_upsamplePass.shader->setUniform(m_upsamplePass.halfpixelLocation, halfpixel);
-
-            read->colorAttachment()->bind();
+        // Fetch the pixels behind the shape that is going to be blurred.
+        const QRegion dirtyRegion = viewport.mapFromDeviceCoordinatesContained(deviceRegion) & backgroundRect;
+        for (const QRect &dirtyRect : dirtyRegion) {
+            renderInfo.framebuffers[0]->blitFromRenderTarget(renderTarget, viewport, dirtyRect, dirtyRect.translated(-backgroundRect.topLeft()));
+        }
 
-            vbo->draw(GL_TRIANGLES, 0, 6);
+        // The blurred background from the previous frame can be reused, except for the parts where the
+        // windows underneath have changed.
+        const QRect localRect(QPoint(0, 0), backgroundRect.size());
+        QRegion backgroundDamage = localRect;
+        if (renderInfo.valid && renderInfo.backgroundRect == backgroundRect && renderInfo.scale == viewport.scale() && deviceRegion != infiniteRegion()) {
+            const QRegion deviceDamage = deviceRegion - foregroundDamage(w);
+            backgroundDamage = (viewport.mapFromDeviceCoordinatesAligned(deviceDamage) & backgroundRect).translated(-backgroundRect.topLeft());
         }
 
-        ShaderManager::instance()->popShader();
+        if (!backgroundDamage.isEmpty()) {
+            std::vector<QRegion> tiles;
+            if (backgroundDamage != localRect) {
+                tiles = blurDamage(backgroundDamage, localRect, m_iterationCount, m_offset);
+                if (tiles[1] == localRect) {
+                    tiles.clear();
+                }
+            }
+            blurTextures(renderInfo, backgroundRect.size(), vbo, tiles);
+        }
     }
+    renderInfo.backgroundRect = blurShape.boundingRect();
+    renderInfo.scale = viewport.scale();
+    renderInfo.lastFrame = m_currentFrame;
+
+    const auto &read = (groupInfo ? groupInfo : &renderInfo)->framebuffers[1];
 
     const float modulation = opacity * opacity;
 
@@ -907,9 +1438,6 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
         const QMatrix4x4 colorMatrix = BlurEffect::colorMatrix(blurInfo);
 
-        GLFramebuffer::popFramebuffer();
-        const auto &read = renderInfo.framebuffers[1];
-
         const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
                                   0.5 / read->colorAttachment()->height());
 
@@ -949,9 +1477,6 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
         QMatrix4x4 colorMatrix = BlurEffect::colorMatrix(blurInfo);
 
-        GLFramebuffer::popFramebuffer();
-        const auto &read = renderInfo.framebuffers[1];
-
         const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
                                   0.5 / read->colorAttachment()->height());
 
@@ -27,6 +27,15 @@ struct BlurRenderData
     /// contains not blurred background behind the window, it's cached.
     std::vector<std::unique_ptr<GLTexture>> textures;
     std::vector<std::unique_ptr<GLFramebuffer>> framebuffers;
+
+    /// The area behind the window that the blurred textures have been computed for, in logical
+    /// pixels. The blurred result is reused for as long as nothing changes behind the window.
+    QRect backgroundRect;
+    qreal scale = 1.0;
+    bool valid = false;
+
+    /// The last frame of the render view that the window has been prepared for painting in.
+    uint64_t lastFrame = 0;
 };
 
 struct BlurEffectData
@@ -62,6 +71,7 @@ public:
 
     void reconfigure(ReconfigureFlags flags) override;
     void prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
+    void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen) override;
     void prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime) override;
     void drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data) override;
 
@@ -87,6 +97,23 @@ public Q_SLOTS:
     void setupDecorationConnections(EffectWindow *w);
 
 private:
+    /**
+     * Windows that are painted one after another and whose blurred areas are close to each other
+     * can share one blurred background, which is computed when the first of them is painted.
+     */
+    struct BlurGroup
+    {
+        std::vector<EffectWindow *> windows; // from bottom to top
+        QRect deviceRect;
+        qint64 blurredArea = 0;
+        QRegion devicePainted; // everything painted since the first window of the group
+
+        bool prepared = false;
+        QRect backgroundRect;
+        std::vector<std::pair<EffectWindow *, QRect>> members;
+        const BlurRenderData *render = nullptr;
+    };
+
     void initBlurStrengthValues();
     QMatrix4x4 colorMatrix(const BlurEffectData &params) const;
     QRegion blurRegion(EffectWindow *w) const;
@@ -95,6 +122,17 @@ private:
     bool shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const;
     void updateBlurRegion(EffectWindow *w);
     void blur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data);
+    void invalidateBlurCache();
+    bool updateBlurStrength();
+    bool ensureBlurTextures(BlurRenderData &renderInfo, const QSize &size, GLenum textureFormat);
+    void blurTextures(BlurRenderData &renderInfo, const QSize &size, GLVertexBuffer *vbo, const std::vector<QRegion> &tiles);
+    void blurTexturesCompute(BlurRenderData &renderInfo, const QSize &size, const std::vector<QRegion> &tiles);
+    bool ensureComputeKernels(GLenum textureFormat);
+    void updateBlurGroups(RenderView *view, EffectWindow *w, const WindowPrePaintData &data, const QRect &deviceBlurRect);
+    BlurGroup *findBlurGroup(const EffectWindow *w);
+    void blurGroup(const RenderTarget &renderTarget, const RenderViewport &viewport, BlurGroup &group, GLenum textureFormat);
+    const BlurRenderData *groupBlur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, const QRect &backgroundRect, GLenum textureFormat, QRect *groupRect);
+    QRegion foregroundDamage(const EffectWindow *w) const;
     GLTexture *ensureNoiseTexture();
 
 private:
@@ -135,6 +173,31 @@ private:
         int halfpixelLocation;
     } m_upsamplePass;
 
+    struct ComputeKernel
+    {
+        std::unique_ptr<GLShader> shader;
+        int offsetLocation;
+        int halfpixelLocation;
+        int regionLocation;
+    };
+
+    struct ComputeKernels
+    {
+        ComputeKernel downsample;
+        ComputeKernel upsample;
+    };
+
+    /**
+     * Compute shaders that replace the downsample and upsample passes if they are supported. They
+     * write the textures directly instead of switching between framebuffers for every iteration.
+     * The image format is part of the shader, so they are compiled for every texture format.
+     */
+    struct
+    {
+        bool supported = false;
+        std::unordered_map<GLenum, std::optional<ComputeKernels>> kernels;
+    } m_computePass;
+
     struct
     {
         std::unique_ptr<GLShader> shader;
@@ -154,6 +217,23 @@ private:
     QRegion m_currentDeviceBlur; // keeps track of currently blurred area of the windows (from bottom to top)
     RenderView *m_currentView = nullptr;
 
+    struct WindowRepaints
+    {
+        EffectWindow *window;
+        QRegion deviceRegion;
+    };
+    std::vector<WindowRepaints> m_windowRepaints; // keeps track of the damage of the windows that are painted (from bottom to top)
+    std::unordered_map<RenderView *, uint64_t> m_viewFrames;
+    uint64_t m_currentFrame = 0;
+
+    std::vector<BlurGroup> m_blurGroups; // the windows sharing a blurred background in the current frame
+    std::unordered_map<RenderView *, std::vector<BlurRenderData>> m_groupRender;
+    QRegion m_screenDamage;
+    bool m_mergeRegions = false;
+    bool m_groupWindows = false;
+
+    int m_blurStrength = 0; // the configured strength, as an index into blurStrengthValues
+    int m_effectiveBlurStrength = -1; // the strength scaled by the render quality
     size_t m_iterationCount; // number of times the texture will be downsized to half size
     int m_offset;
     int m_expandSize;
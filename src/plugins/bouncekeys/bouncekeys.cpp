@@ -8,7 +8,7 @@
 #include "keyboard_input.h"
 
 BounceKeysFilter::BounceKeysFilter()
-    : KWin::InputEventFilter(KWin::InputFilterOrder::BounceKeys)
+    : KWin::InputEventFilter(KWin::InputFilterOrder::BounceKeys, KWin::InputEventKind::Keyboard)
     , m_configWatcher(KConfigWatcher::create(KSharedConfig::openConfig("kaccessrc")))
 {
     const QLatin1String groupName("Keyboard");
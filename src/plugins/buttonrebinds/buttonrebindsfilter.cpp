@@ -106,7 +106,7 @@ bool InputDevice::isTouchpad() const
 }
 
 ButtonRebindsFilter::ButtonRebindsFilter()
-    : KWin::InputEventFilter(KWin::InputFilterOrder::ButtonRebind)
+    : KWin::InputEventFilter(KWin::InputFilterOrder::ButtonRebind, KWin::InputEventKind::Pointer | KWin::InputEventKind::Tablet)
     , m_configWatcher(KConfigWatcher::create(KSharedConfig::openConfig("kcminputrc")))
 {
     const QLatin1String groupName("ButtonRebinds");
@@ -139,6 +139,22 @@ void EisBackend::disconnect(int cookie)
     }
 }
 
+QVariantMap EisBackend::latencyStatistics(int cookie)
+{
+    auto it = std::ranges::find(m_contexts, cookie, [](const std::unique_ptr<DbusEisContext> &context) {
+        return context->cookie;
+    });
+    if (it == std::ranges::end(m_contexts)) {
+        return QVariantMap();
+    }
+    const EisLatencyStatistics statistics = (*it)->latencyStatistics();
+    return QVariantMap{
+        {QStringLiteral("frames"), qulonglong(statistics.frames)},
+        {QStringLiteral("average"), qlonglong(statistics.frames ? statistics.total.count() / qint64(statistics.frames) : 0)},
+        {QStringLiteral("maximum"), qlonglong(statistics.maximum.count())},
+    };
+}
+
 eis_device *createDevice(eis_seat *seat, const QByteArray &name)
 {
     auto device = eis_seat_new_device(seat);
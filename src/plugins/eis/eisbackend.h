@@ -11,6 +11,7 @@
 
 #include <QDBusContext>
 #include <QDBusUnixFileDescriptor>
+#include <QVariantMap>
 
 #include <memory>
 
@@ -39,6 +40,11 @@ public:
 
     Q_INVOKABLE QDBusUnixFileDescriptor connectToEIS(const int &capabilities, int &cookie);
     Q_INVOKABLE void disconnect(int cookie);
+    /**
+     * Returns the number of frames as well as the average and the maximum latency in
+     * microseconds of the context that was connected with the given @a cookie.
+     */
+    Q_INVOKABLE QVariantMap latencyStatistics(int cookie);
 
     eis_device *createKeyboard(eis_seat *seat);
     eis_device *createPointer(eis_seat *seat);
@@ -9,6 +9,7 @@
 #include "eisdevice.h"
 #include "libeis_logging.h"
 
+#include <algorithm>
 #include <unistd.h>
 
 namespace KWin
@@ -125,233 +126,308 @@ static std::chrono::microseconds currentTime()
     return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch());
 }
 
-void EisContext::handleEvents()
+void EisContext::recordLatency(eis_event *event)
 {
-    auto eventDevice = [](eis_event *event) {
-        return static_cast<EisDevice *>(eis_device_get_user_data(eis_event_get_device(event)));
-    };
+    const std::chrono::microseconds sent(eis_event_get_time(event));
+    const std::chrono::microseconds now = currentTime();
+    // the time is up to the clients, it may be missing or use some other clock
+    if (sent.count() == 0 || sent > now) {
+        return;
+    }
+    const std::chrono::microseconds latency = now - sent;
+    m_latency.frames++;
+    m_latency.total += latency;
+    m_latency.maximum = std::max(m_latency.maximum, latency);
+}
+
+EisLatencyStatistics EisContext::latencyStatistics() const
+{
+    return m_latency;
+}
 
+static bool isEventOf(eis_event *event, eis_event_type type, eis_device *device)
+{
+    return eis_event_get_type(event) == type && eis_event_get_device(event) == device;
+}
+
+void EisContext::handleEvents()
+{
     eis_dispatch(m_eisContext);
 
+    // All events that have arrived are looked at together, so that pointer motion that was
+    // sent in quick succession reaches the input stack at once, as it does with libinput
+    std::vector<eis_event *> events;
     while (eis_event *const event = eis_get_event(m_eisContext)) {
-        switch (eis_event_get_type(event)) {
-        case EIS_EVENT_CLIENT_CONNECT: {
-            auto client = eis_event_get_client(event);
-            const char *clientName = eis_client_get_name(client);
-            if (!eis_client_is_sender(client)) {
-                qCDebug(KWIN_EIS) << "disconnecting receiving client" << clientName;
-                eis_client_disconnect(client);
-                break;
-            }
-            eis_client_connect(client);
+        events.push_back(event);
+    }
 
-            auto seat = eis_client_new_seat(client, QByteArrayLiteral(" seat").prepend(clientName));
-            constexpr std::array allCapabilities{EIS_DEVICE_CAP_POINTER, EIS_DEVICE_CAP_POINTER_ABSOLUTE, EIS_DEVICE_CAP_KEYBOARD, EIS_DEVICE_CAP_TOUCH, EIS_DEVICE_CAP_SCROLL, EIS_DEVICE_CAP_BUTTON};
-            for (auto capability : allCapabilities) {
-                if (m_allowedCapabilities & capability) {
-                    eis_seat_configure_capability(seat, capability);
-                }
-            }
+    for (size_t i = 0; i < events.size(); ++i) {
+        eis_event *event = events[i];
+        const eis_event_type type = eis_event_get_type(event);
+        eis_device *const handle = type == EIS_EVENT_POINTER_MOTION || type == EIS_EVENT_POINTER_MOTION_ABSOLUTE ? eis_event_get_device(event) : nullptr;
+        if (!handle || i + 2 >= events.size() || !isEventOf(events[i + 1], EIS_EVENT_FRAME, handle) || !isEventOf(events[i + 2], type, handle)) {
+            handleEvent(event);
+            eis_event_unref(event);
+            continue;
+        }
 
-            eis_seat_add(seat);
-            m_clients.emplace_back(std::make_unique<EisClient>(client, seat));
-            qCDebug(KWIN_EIS) << "New eis client" << clientName;
-            break;
+        // Frames that only move the pointer of the same device further are merged into one,
+        // the frame of the last motion ends the merged frame
+        auto device = static_cast<EisDevice *>(eis_device_get_user_data(handle));
+        QPointF delta;
+        QPointF position;
+        if (type == EIS_EVENT_POINTER_MOTION) {
+            delta = QPointF(eis_event_pointer_get_dx(event), eis_event_pointer_get_dy(event));
+        } else {
+            position = QPointF(eis_event_pointer_get_absolute_x(event), eis_event_pointer_get_absolute_y(event));
         }
-        case EIS_EVENT_CLIENT_DISCONNECT: {
-            auto client = eis_event_get_client(event);
-            qCDebug(KWIN_EIS) << "Client disconnected" << eis_client_get_name(client);
-            if (auto seat = static_cast<EisClient *>(eis_client_get_user_data(client))) {
-                m_clients.erase(std::ranges::find(m_clients, seat, &std::unique_ptr<EisClient>::get));
+        eis_event_unref(event);
+        while (i + 2 < events.size() && isEventOf(events[i + 1], EIS_EVENT_FRAME, handle) && isEventOf(events[i + 2], type, handle)) {
+            eis_event *const frame = events[i + 1];
+            eis_event *const motion = events[i + 2];
+            recordLatency(frame);
+            if (type == EIS_EVENT_POINTER_MOTION) {
+                delta += QPointF(eis_event_pointer_get_dx(motion), eis_event_pointer_get_dy(motion));
+            } else {
+                position = QPointF(eis_event_pointer_get_absolute_x(motion), eis_event_pointer_get_absolute_y(motion));
             }
-            break;
+            eis_event_unref(frame);
+            eis_event_unref(motion);
+            i += 2;
         }
-        case EIS_EVENT_SEAT_BIND: {
-            auto seat = eis_event_get_seat(event);
-            auto clientSeat = static_cast<EisClient *>(eis_seat_get_user_data(seat));
-            qCDebug(KWIN_EIS) << "Client" << eis_client_get_name(eis_event_get_client(event)) << "bound to seat" << eis_seat_get_name(seat);
-            auto updateDevice = [event, this](std::unique_ptr<EisDevice> &device, auto &&createFunc, bool shouldHave) {
-                if (shouldHave) {
-                    if (!device) {
-                        device = std::make_unique<EisDevice>(std::invoke(createFunc, m_backend, (eis_event_get_seat(event))));
-                        device->setEnabled(true);
-                        Q_EMIT m_backend->deviceAdded(device.get());
-                    }
-                } else if (device) {
-                    Q_EMIT m_backend->deviceRemoved(device.get());
-                    device.reset();
-                }
-            };
-            updateDevice(clientSeat->absoluteDevice, &EisBackend::createAbsoluteDevice, eis_event_seat_has_capability(event, EIS_DEVICE_CAP_POINTER_ABSOLUTE) || eis_event_seat_has_capability(event, EIS_DEVICE_CAP_TOUCH));
-            updateDevice(clientSeat->pointer, &EisBackend::createPointer, eis_event_seat_has_capability(event, EIS_DEVICE_CAP_POINTER));
-            updateDevice(clientSeat->keyboard, &EisBackend::createKeyboard, eis_event_seat_has_capability(event, EIS_DEVICE_CAP_KEYBOARD));
-            break;
+        if (type == EIS_EVENT_POINTER_MOTION) {
+            qCDebug(KWIN_EIS) << device->name() << "merged pointer motion" << delta;
+            Q_EMIT device->pointerMotion(delta, delta, currentTime(), device);
+        } else {
+            qCDebug(KWIN_EIS) << device->name() << "merged pointer motion absolute" << position;
+            Q_EMIT device->pointerMotionAbsolute(position, currentTime(), device);
         }
-        case EIS_EVENT_DEVICE_CLOSED: {
-            auto device = eventDevice(event);
-            qCDebug(KWIN_EIS) << "Device" << device->name() << "closed by client";
-            Q_EMIT m_backend->deviceRemoved(device);
-            auto seat = static_cast<EisClient *>(eis_seat_get_user_data(eis_device_get_seat(device->handle())));
-            if (device == seat->absoluteDevice.get()) {
-                seat->absoluteDevice.reset();
-            } else if (device == seat->keyboard.get()) {
-                seat->keyboard.reset();
-            } else if (device == seat->pointer.get()) {
-                seat->pointer.reset();
-            }
+    }
+}
+
+void EisContext::handleEvent(eis_event *event)
+{
+    auto eventDevice = [](eis_event *event) {
+        return static_cast<EisDevice *>(eis_device_get_user_data(eis_event_get_device(event)));
+    };
+
+    switch (eis_event_get_type(event)) {
+    case EIS_EVENT_CLIENT_CONNECT: {
+        auto client = eis_event_get_client(event);
+        const char *clientName = eis_client_get_name(client);
+        if (!eis_client_is_sender(client)) {
+            qCDebug(KWIN_EIS) << "disconnecting receiving client" << clientName;
+            eis_client_disconnect(client);
             break;
         }
-        case EIS_EVENT_FRAME: {
-            auto device = eventDevice(event);
-            qCDebug(KWIN_EIS) << "Frame for device" << device->name();
-            if (device->isTouch()) {
-                Q_EMIT device->touchFrame(device);
-            }
-            if (device->isPointer()) {
-                Q_EMIT device->pointerFrame(device);
+        eis_client_connect(client);
+
+        auto seat = eis_client_new_seat(client, QByteArrayLiteral(" seat").prepend(clientName));
+        constexpr std::array allCapabilities{EIS_DEVICE_CAP_POINTER, EIS_DEVICE_CAP_POINTER_ABSOLUTE, EIS_DEVICE_CAP_KEYBOARD, EIS_DEVICE_CAP_TOUCH, EIS_DEVICE_CAP_SCROLL, EIS_DEVICE_CAP_BUTTON};
+        for (auto capability : allCapabilities) {
+            if (m_allowedCapabilities & capability) {
+                eis_seat_configure_capability(seat, capability);
             }
-            break;
         }
-        case EIS_EVENT_DEVICE_START_EMULATING: {
-            auto device = eventDevice(event);
-            qCDebug(KWIN_EIS) << "Device" << device->name() << "starts emulating";
-            break;
-        }
-        case EIS_EVENT_DEVICE_STOP_EMULATING: {
-            auto device = eventDevice(event);
-            qCDebug(KWIN_EIS) << "Device" << device->name() << "stops emulating";
-            break;
-        }
-        case EIS_EVENT_POINTER_MOTION: {
-            auto device = eventDevice(event);
-            const double x = eis_event_pointer_get_dx(event);
-            const double y = eis_event_pointer_get_dy(event);
-            qCDebug(KWIN_EIS) << device->name() << "pointer motion" << x << y;
-            const QPointF delta(x, y);
-            Q_EMIT device->pointerMotion(delta, delta, currentTime(), device);
-            break;
-        }
-        case EIS_EVENT_POINTER_MOTION_ABSOLUTE: {
-            auto device = eventDevice(event);
-            const double x = eis_event_pointer_get_absolute_x(event);
-            const double y = eis_event_pointer_get_absolute_y(event);
-            qCDebug(KWIN_EIS) << device->name() << "pointer motion absolute" << x << y;
-            Q_EMIT device->pointerMotionAbsolute({x, y}, currentTime(), device);
-            break;
+
+        eis_seat_add(seat);
+        m_clients.emplace_back(std::make_unique<EisClient>(client, seat));
+        qCDebug(KWIN_EIS) << "New eis client" << clientName;
+        break;
+    }
+    case EIS_EVENT_CLIENT_DISCONNECT: {
+        auto client = eis_event_get_client(event);
+        qCDebug(KWIN_EIS) << "Client disconnected" << eis_client_get_name(client);
+        if (auto seat = static_cast<EisClient *>(eis_client_get_user_data(client))) {
+            m_clients.erase(std::ranges::find(m_clients, seat, &std::unique_ptr<EisClient>::get));
         }
-        case EIS_EVENT_BUTTON_BUTTON: {
-            auto device = eventDevice(event);
-            const quint32 button = eis_event_button_get_button(event);
-            const bool press = eis_event_button_get_is_press(event);
-            qCDebug(KWIN_EIS) << device->name() << "button" << button << press;
-            if (press) {
-                if (device->pressedButtons.contains(button)) {
-                    continue;
-                }
-                device->pressedButtons.insert(button);
-            } else {
-                if (!device->pressedButtons.remove(button)) {
-                    continue;
+        break;
+    }
+    case EIS_EVENT_SEAT_BIND: {
+        auto seat = eis_event_get_seat(event);
+        auto clientSeat = static_cast<EisClient *>(eis_seat_get_user_data(seat));
+        qCDebug(KWIN_EIS) << "Client" << eis_client_get_name(eis_event_get_client(event)) << "bound to seat" << eis_seat_get_name(seat);
+        auto updateDevice = [event, this](std::unique_ptr<EisDevice> &device, auto &&createFunc, bool shouldHave) {
+            if (shouldHave) {
+                if (!device) {
+                    device = std::make_unique<EisDevice>(std::invoke(createFunc, m_backend, (eis_event_get_seat(event))));
+                    device->setEnabled(true);
+                    Q_EMIT m_backend->deviceAdded(device.get());
                 }
+            } else if (device) {
+                Q_EMIT m_backend->deviceRemoved(device.get());
+                device.reset();
             }
-            Q_EMIT device->pointerButtonChanged(button, press ? PointerButtonState::Pressed : PointerButtonState::Released, currentTime(), device);
-            break;
+        };
+        updateDevice(clientSeat->absoluteDevice, &EisBackend::createAbsoluteDevice, eis_event_seat_has_capability(event, EIS_DEVICE_CAP_POINTER_ABSOLUTE) || eis_event_seat_has_capability(event, EIS_DEVICE_CAP_TOUCH));
+        updateDevice(clientSeat->pointer, &EisBackend::createPointer, eis_event_seat_has_capability(event, EIS_DEVICE_CAP_POINTER));
+        updateDevice(clientSeat->keyboard, &EisBackend::createKeyboard, eis_event_seat_has_capability(event, EIS_DEVICE_CAP_KEYBOARD));
+        break;
+    }
+    case EIS_EVENT_DEVICE_CLOSED: {
+        auto device = eventDevice(event);
+        qCDebug(KWIN_EIS) << "Device" << device->name() << "closed by client";
+        Q_EMIT m_backend->deviceRemoved(device);
+        auto seat = static_cast<EisClient *>(eis_seat_get_user_data(eis_device_get_seat(device->handle())));
+        if (device == seat->absoluteDevice.get()) {
+            seat->absoluteDevice.reset();
+        } else if (device == seat->keyboard.get()) {
+            seat->keyboard.reset();
+        } else if (device == seat->pointer.get()) {
+            seat->pointer.reset();
         }
-        case EIS_EVENT_SCROLL_DELTA: {
-            auto device = eventDevice(event);
-            const auto x = eis_event_scroll_get_dx(event);
-            const auto y = eis_event_scroll_get_dy(event);
-            qCDebug(KWIN_EIS) << device->name() << "scroll" << x << y;
-            if (x != 0) {
-                Q_EMIT device->pointerAxisChanged(PointerAxis::Horizontal, x, 0, PointerAxisSource::Unknown, false, currentTime(), device);
-            }
-            if (y != 0) {
-                Q_EMIT device->pointerAxisChanged(PointerAxis::Vertical, y, 0, PointerAxisSource::Unknown, false, currentTime(), device);
-            }
-            break;
+        break;
+    }
+    case EIS_EVENT_FRAME: {
+        auto device = eventDevice(event);
+        qCDebug(KWIN_EIS) << "Frame for device" << device->name();
+        recordLatency(event);
+        if (device->isTouch()) {
+            Q_EMIT device->touchFrame(device);
         }
-        case EIS_EVENT_SCROLL_STOP:
-        case EIS_EVENT_SCROLL_CANCEL: {
-            auto device = eventDevice(event);
-            if (eis_event_scroll_get_stop_x(event)) {
-                qCDebug(KWIN_EIS) << device->name() << "scroll x" << (eis_event_get_type(event) == EIS_EVENT_SCROLL_STOP ? "stop" : "cancel");
-                Q_EMIT device->pointerAxisChanged(PointerAxis::Horizontal, 0, 0, PointerAxisSource::Unknown, false, currentTime(), device);
-            }
-            if (eis_event_scroll_get_stop_y(event)) {
-                qCDebug(KWIN_EIS) << device->name() << "scroll y" << (eis_event_get_type(event) == EIS_EVENT_SCROLL_STOP ? "stop" : "cancel");
-                Q_EMIT device->pointerAxisChanged(PointerAxis::Vertical, 0, 0, PointerAxisSource::Unknown, false, currentTime(), device);
-            }
-            break;
+        if (device->isPointer()) {
+            Q_EMIT device->pointerFrame(device);
         }
-        case EIS_EVENT_SCROLL_DISCRETE: {
-            auto device = eventDevice(event);
-            const double x = eis_event_scroll_get_discrete_dx(event);
-            const double y = eis_event_scroll_get_discrete_dy(event);
-            qCDebug(KWIN_EIS) << device->name() << "scroll discrete" << x << y;
-            // otherwise no scroll event
-            constexpr auto anglePer120Step = 15 / 120.0;
-            if (x != 0) {
-                Q_EMIT device->pointerAxisChanged(PointerAxis::Horizontal, x * anglePer120Step, x, PointerAxisSource::Unknown, false, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_DEVICE_START_EMULATING: {
+        auto device = eventDevice(event);
+        qCDebug(KWIN_EIS) << "Device" << device->name() << "starts emulating";
+        break;
+    }
+    case EIS_EVENT_DEVICE_STOP_EMULATING: {
+        auto device = eventDevice(event);
+        qCDebug(KWIN_EIS) << "Device" << device->name() << "stops emulating";
+        break;
+    }
+    case EIS_EVENT_POINTER_MOTION: {
+        auto device = eventDevice(event);
+        const double x = eis_event_pointer_get_dx(event);
+        const double y = eis_event_pointer_get_dy(event);
+        qCDebug(KWIN_EIS) << device->name() << "pointer motion" << x << y;
+        const QPointF delta(x, y);
+        Q_EMIT device->pointerMotion(delta, delta, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_POINTER_MOTION_ABSOLUTE: {
+        auto device = eventDevice(event);
+        const double x = eis_event_pointer_get_absolute_x(event);
+        const double y = eis_event_pointer_get_absolute_y(event);
+        qCDebug(KWIN_EIS) << device->name() << "pointer motion absolute" << x << y;
+        Q_EMIT device->pointerMotionAbsolute({x, y}, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_BUTTON_BUTTON: {
+        auto device = eventDevice(event);
+        const quint32 button = eis_event_button_get_button(event);
+        const bool press = eis_event_button_get_is_press(event);
+        qCDebug(KWIN_EIS) << device->name() << "button" << button << press;
+        if (press) {
+            if (device->pressedButtons.contains(button)) {
+                continue;
             }
-            if (y != 0) {
-                Q_EMIT device->pointerAxisChanged(PointerAxis::Vertical, y * anglePer120Step, y, PointerAxisSource::Unknown, false, currentTime(), device);
+            device->pressedButtons.insert(button);
+        } else {
+            if (!device->pressedButtons.remove(button)) {
+                continue;
             }
-            break;
         }
-        case EIS_EVENT_KEYBOARD_KEY: {
-            auto device = eventDevice(event);
-            const quint32 key = eis_event_keyboard_get_key(event);
-            const bool press = eis_event_keyboard_get_key_is_press(event);
-            qCDebug(KWIN_EIS) << device->name() << "key" << key << press;
-            if (press) {
-                if (device->pressedKeys.contains(key)) {
-                    continue;
-                }
-                device->pressedKeys.insert(key);
-            } else {
-                if (!device->pressedKeys.remove(key)) {
-                    continue;
-                }
-            }
-            Q_EMIT device->keyChanged(key, press ? KeyboardKeyState::Pressed : KeyboardKeyState::Released, currentTime(), device);
-            break;
+        Q_EMIT device->pointerButtonChanged(button, press ? PointerButtonState::Pressed : PointerButtonState::Released, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_SCROLL_DELTA: {
+        auto device = eventDevice(event);
+        const auto x = eis_event_scroll_get_dx(event);
+        const auto y = eis_event_scroll_get_dy(event);
+        qCDebug(KWIN_EIS) << device->name() << "scroll" << x << y;
+        if (x != 0) {
+            Q_EMIT device->pointerAxisChanged(PointerAxis::Horizontal, x, 0, PointerAxisSource::Unknown, false, currentTime(), device);
         }
-        case EIS_EVENT_TOUCH_DOWN: {
-            auto device = eventDevice(event);
-            const auto x = eis_event_touch_get_x(event);
-            const auto y = eis_event_touch_get_y(event);
-            const auto id = eis_event_touch_get_id(event);
-            qCDebug(KWIN_EIS) << device->name() << "touch down" << id << x << y;
-            device->activeTouches.push_back(id);
-            Q_EMIT device->touchDown(id, {x, y}, currentTime(), device);
-            break;
+        if (y != 0) {
+            Q_EMIT device->pointerAxisChanged(PointerAxis::Vertical, y, 0, PointerAxisSource::Unknown, false, currentTime(), device);
         }
-        case EIS_EVENT_TOUCH_UP: {
-            auto device = eventDevice(event);
-            const auto id = eis_event_touch_get_id(event);
-            qCDebug(KWIN_EIS) << device->name() << "touch up" << id;
-            std::erase(device->activeTouches, id);
-            if (eis_event_touch_get_is_cancel(event)) {
-                Q_EMIT device->touchCanceled(device);
-                break;
-            }
-            Q_EMIT device->touchUp(id, currentTime(), device);
-            break;
+        break;
+    }
+    case EIS_EVENT_SCROLL_STOP:
+    case EIS_EVENT_SCROLL_CANCEL: {
+        auto device = eventDevice(event);
+        if (eis_event_scroll_get_stop_x(event)) {
+            qCDebug(KWIN_EIS) << device->name() << "scroll x" << (eis_event_get_type(event) == EIS_EVENT_SCROLL_STOP ? "stop" : "cancel");
+            Q_EMIT device->pointerAxisChanged(PointerAxis::Horizontal, 0, 0, PointerAxisSource::Unknown, false, currentTime(), device);
         }
-        case EIS_EVENT_TOUCH_MOTION: {
-            auto device = eventDevice(event);
-            const auto x = eis_event_touch_get_x(event);
-            const auto y = eis_event_touch_get_y(event);
-            const auto id = eis_event_touch_get_id(event);
-            qCDebug(KWIN_EIS) << device->name() << "touch move" << id << x << y;
-            Q_EMIT device->touchMotion(id, {x, y}, currentTime(), device);
-            break;
+        if (eis_event_scroll_get_stop_y(event)) {
+            qCDebug(KWIN_EIS) << device->name() << "scroll y" << (eis_event_get_type(event) == EIS_EVENT_SCROLL_STOP ? "stop" : "cancel");
+            Q_EMIT device->pointerAxisChanged(PointerAxis::Vertical, 0, 0, PointerAxisSource::Unknown, false, currentTime(), device);
+        }
+        break;
+    }
+    case EIS_EVENT_SCROLL_DISCRETE: {
+        auto device = eventDevice(event);
+        const double x = eis_event_scroll_get_discrete_dx(event);
+        const double y = eis_event_scroll_get_discrete_dy(event);
+        qCDebug(KWIN_EIS) << device->name() << "scroll discrete" << x << y;
+        // otherwise no scroll event
+        constexpr auto anglePer120Step = 15 / 120.0;
+        if (x != 0) {
+            Q_EMIT device->pointerAxisChanged(PointerAxis::Horizontal, x * anglePer120Step, x, PointerAxisSource::Unknown, false, currentTime(), device);
+        }
+        if (y != 0) {
+            Q_EMIT device->pointerAxisChanged(PointerAxis::Vertical, y * anglePer120Step, y, PointerAxisSource::Unknown, false, currentTime(), device);
+        }
+        break;
+    }
+    case EIS_EVENT_KEYBOARD_KEY: {
+        auto device = eventDevice(event);
+        const quint32 key = eis_event_keyboard_get_key(event);
+        const bool press = eis_event_keyboard_get_key_is_press(event);
+        qCDebug(KWIN_EIS) << device->name() << "key" << key << press;
+        if (press) {
+            if (device->pressedKeys.contains(key)) {
+                continue;
+            }
+            device->pressedKeys.insert(key);
+        } else {
+            if (!device->pressedKeys.remove(key)) {
+                continue;
+            }
         }
-        case EIS_EVENT_PONG:
-        case EIS_EVENT_SYNC:
+        Q_EMIT device->keyChanged(key, press ? KeyboardKeyState::Pressed : KeyboardKeyState::Released, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_TOUCH_DOWN: {
+        auto device = eventDevice(event);
+        const auto x = eis_event_touch_get_x(event);
+        const auto y = eis_event_touch_get_y(event);
+        const auto id = eis_event_touch_get_id(event);
+        qCDebug(KWIN_EIS) << device->name() << "touch down" << id << x << y;
+        device->activeTouches.push_back(id);
+        Q_EMIT device->touchDown(id, {x, y}, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_TOUCH_UP: {
+        auto device = eventDevice(event);
+        const auto id = eis_event_touch_get_id(event);
+        qCDebug(KWIN_EIS) << device->name() << "touch up" << id;
+        std::erase(device->activeTouches, id);
+        if (eis_event_touch_get_is_cancel(event)) {
+            Q_EMIT device->touchCanceled(device);
             break;
         }
-        eis_event_unref(event);
+        Q_EMIT device->touchUp(id, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_TOUCH_MOTION: {
+        auto device = eventDevice(event);
+        const auto x = eis_event_touch_get_x(event);
+        const auto y = eis_event_touch_get_y(event);
+        const auto id = eis_event_touch_get_id(event);
+        qCDebug(KWIN_EIS) << device->name() << "touch move" << id << x << y;
+        Q_EMIT device->touchMotion(id, {x, y}, currentTime(), device);
+        break;
+    }
+    case EIS_EVENT_PONG:
+    case EIS_EVENT_SYNC:
+        break;
     }
 }
 }
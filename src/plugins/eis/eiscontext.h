@@ -12,6 +12,7 @@
 
 #include <libeis.h>
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -21,6 +22,17 @@ namespace KWin
 class EisBackend;
 struct EisClient;
 
+/**
+ * How long it took the frames of the clients to get from the clients to KWin, measured with
+ * the timestamps the clients put into the frames.
+ */
+struct EisLatencyStatistics
+{
+    uint64_t frames = 0;
+    std::chrono::microseconds total = std::chrono::microseconds::zero();
+    std::chrono::microseconds maximum = std::chrono::microseconds::zero();
+};
+
 class EisContext
 {
 public:
@@ -30,16 +42,21 @@ public:
     void updateScreens();
     void updateKeymap();
 
+    EisLatencyStatistics latencyStatistics() const;
+
 protected:
     eis *m_eisContext;
 
 private:
     void handleEvents();
+    void handleEvent(eis_event *event);
+    void recordLatency(eis_event *event);
 
     EisBackend *m_backend;
     QFlags<eis_device_capability> m_allowedCapabilities;
     QSocketNotifier m_socketNotifier;
     std::vector<std::unique_ptr<EisClient>> m_clients;
+    EisLatencyStatistics m_latency;
 };
 
 class DbusEisContext : public EisContext
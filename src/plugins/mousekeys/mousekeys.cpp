@@ -65,7 +65,7 @@ bool MouseKeysInputDevice::isTouchpad() const
 
 MouseKeysFilter::MouseKeysFilter()
     : KWin::Plugin()
-    , KWin::InputEventFilter(KWin::InputFilterOrder::MouseKeys)
+    , KWin::InputEventFilter(KWin::InputFilterOrder::MouseKeys, KWin::InputEventKind::Keyboard)
     , m_configWatcher(KConfigWatcher::create(KSharedConfig::openConfig("kaccessrc")))
 {
     const QLatin1String groupName("Mouse");
@@ -61,6 +61,9 @@ OutputLocatorEffect::OutputLocatorEffect(QObject *parent)
                                                  this,
                                                  QDBusConnection::ExportAllSlots);
     connect(&m_showTimer, &QTimer::timeout, this, &OutputLocatorEffect::hide);
+    connect(effects, &EffectsHandler::screenRemoved, this, [this](LogicalOutput *screen) {
+        m_scenesByScreens.erase(screen);
+    });
 }
 
 bool OutputLocatorEffect::isActive() const
@@ -75,17 +78,33 @@ void OutputLocatorEffect::show()
         return;
     }
 
+    // the scenes are kept after they have been hidden, showing the labels again only
+    // needs to update them, without loading the qml and rendering everything from scratch
     const auto screens = effects->screens();
     for (const auto screen : screens) {
-        auto scene = new OffscreenQuickScene();
-        scene->loadFromModule(QStringLiteral("org.kde.kwin.outputlocator"), QStringLiteral("OutputLabel"), {{QStringLiteral("outputName"), outputName(screen)}, {QStringLiteral("resolution"), screen->pixelSize()}, {QStringLiteral("scale"), screen->scale()}});
+        const QVariantMap properties{
+            {QStringLiteral("outputName"), outputName(screen)},
+            {QStringLiteral("resolution"), screen->pixelSize()},
+            {QStringLiteral("scale"), screen->scale()},
+        };
+        std::unique_ptr<OffscreenQuickScene> &scene = m_scenesByScreens[screen];
+        if (!scene) {
+            scene = std::make_unique<OffscreenQuickScene>();
+            scene->loadFromModule(QStringLiteral("org.kde.kwin.outputlocator"), QStringLiteral("OutputLabel"), properties);
+            connect(scene.get(), &OffscreenQuickView::repaintNeeded, this, [this, view = scene.get()] {
+                if (isActive()) {
+                    effects->addRepaint(view->geometry());
+                }
+            });
+        } else {
+            for (auto it = properties.cbegin(); it != properties.cend(); ++it) {
+                scene->rootItem()->setProperty(it.key().toUtf8().constData(), it.value());
+            }
+        }
         QRectF geometry(0, 0, scene->rootItem()->implicitWidth(), scene->rootItem()->implicitHeight());
         geometry.moveCenter(screen->geometry().center());
         scene->setGeometry(geometry.toRect());
-        connect(scene, &OffscreenQuickView::repaintNeeded, this, [scene] {
-            effects->addRepaint(scene->geometry());
-        });
-        m_scenesByScreens[screen].reset(scene);
+        effects->addRepaint(scene->geometry());
     }
 
     m_showTimer.start(std::chrono::milliseconds(2500));
@@ -100,7 +119,7 @@ void OutputLocatorEffect::hide()
         repaintRegion += scene->geometry();
     }
 
-    m_scenesByScreens.clear();
+    // the scenes stay visible to keep their textures, they're just not painted anymore
     effects->addRepaint(repaintRegion);
 }
 
@@ -108,6 +127,9 @@ void OutputLocatorEffect::paintScreen(const RenderTarget &renderTarget, const Re
 {
     effects->paintScreen(renderTarget, viewport, mask, deviceRegion, screen);
 
+    if (!isActive()) {
+        return;
+    }
     if (auto it = m_scenesByScreens.find(screen); it != m_scenesByScreens.end()) {
         effects->renderOffscreenQuickView(renderTarget, viewport, it->second.get());
     }
@@ -166,7 +166,8 @@ void Window::unmap()
     m_handle->destroyWindow();
     m_handle = nullptr;
 
-    invalidateSurface();
+    // the buffers are kept, windows like the on-screen display and the outline are shown
+    // over and over again and shouldn't need to allocate and import new buffers each time
 
     m_exposed = false;
     QWindowSystemInterface::handleExposeEvent(window(), QRect());
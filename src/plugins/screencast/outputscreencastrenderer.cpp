@@ -0,0 +1,258 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "outputscreencastrenderer.h"
+#include "filteredsceneview.h"
+#include "screencastlayer.h"
+
+#include "compositor.h"
+#include "core/colorpipeline.h"
+#include "core/graphicsbuffer.h"
+#include "core/output.h"
+#include "core/syncobjtimeline.h"
+#include "opengl/eglbackend.h"
+#include "opengl/egldisplay.h"
+#include "opengl/eglnativefence.h"
+#include "opengl/glframebuffer.h"
+#include "opengl/gltexture.h"
+#include "scene/surfaceitem.h"
+#include "scene/workspacescene.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+static std::vector<std::weak_ptr<OutputScreenCastRenderer>> s_renderers;
+
+OutputScreenCastRenderer::OutputScreenCastRenderer(LogicalOutput *output, std::optional<pid_t> pidToHide, bool renderCursor)
+    : m_output(output)
+    , m_pidToHide(pidToHide)
+    , m_renderCursor(renderCursor)
+{
+    m_layer = std::make_unique<ScreencastLayer>(m_output, static_cast<EglBackend *>(Compositor::self()->backend())->openglContext()->displayObject()->nonExternalOnlySupportedDrmFormats());
+
+    m_sceneView = std::make_unique<FilteredSceneView>(Compositor::self()->scene(), m_output, m_layer.get(), m_pidToHide);
+    m_sceneView->setViewport(m_output->geometryF());
+    m_sceneView->setScale(m_output->scale());
+    connect(m_output, &LogicalOutput::changed, m_sceneView.get(), [this]() {
+        m_sceneView->setViewport(m_output->geometryF());
+        m_sceneView->setScale(m_output->scale());
+    });
+
+    m_cursorView = std::make_unique<ItemTreeView>(m_sceneView.get(), Compositor::self()->scene()->cursorItem(), m_output, nullptr);
+    m_cursorView->setExclusive(!m_renderCursor);
+
+    connect(m_layer.get(), &OutputLayer::repaintScheduled, this, [this]() {
+        m_sharedFrame.dirty = true;
+        Q_EMIT frame();
+    });
+}
+
+OutputScreenCastRenderer::~OutputScreenCastRenderer() = default;
+
+std::shared_ptr<OutputScreenCastRenderer> OutputScreenCastRenderer::acquire(LogicalOutput *output, std::optional<pid_t> pidToHide, bool renderCursor)
+{
+    std::erase_if(s_renderers, [](const std::weak_ptr<OutputScreenCastRenderer> &renderer) {
+        return renderer.expired();
+    });
+
+    for (const auto &weakRenderer : s_renderers) {
+        const auto renderer = weakRenderer.lock();
+        if (renderer->m_output == output && renderer->m_pidToHide == pidToHide && renderer->m_renderCursor == renderCursor) {
+            return renderer;
+        }
+    }
+
+    std::shared_ptr<OutputScreenCastRenderer> renderer(new OutputScreenCastRenderer(output, pidToHide, renderCursor));
+    s_renderers.push_back(renderer);
+    return renderer;
+}
+
+void OutputScreenCastRenderer::addConsumer(const void *consumer)
+{
+    m_consumers[consumer] = 0;
+}
+
+void OutputScreenCastRenderer::removeConsumer(const void *consumer)
+{
+    m_consumers.erase(consumer);
+}
+
+QRegion OutputScreenCastRenderer::render(const void *consumer, GLFramebuffer *target, const QRegion &bufferRepair)
+{
+    const QRect targetRect(QPoint(), target->size());
+    if (m_consumers.size() == 1) {
+        // With nothing to share, the scene is painted straight into the buffer of the stream.
+        // The shared frame doesn't follow the scene then and has to be painted from scratch
+        // if another stream comes along.
+        m_sharedFrame.texture.reset();
+        m_sharedFrame.framebuffer.reset();
+        return paint(target, bufferRepair);
+    }
+
+    if (!updateSharedFrame() || m_sharedFrame.texture->size() != target->size()) {
+        return QRegion{};
+    }
+
+    uint64_t &lastSequence = m_consumers[consumer];
+    QRegion damage;
+    if (lastSequence == 0) {
+        damage = targetRect;
+    } else if (lastSequence != m_sharedFrame.sequence) {
+        damage = m_sharedFrame.damageJournal.accumulate(m_sharedFrame.sequence - lastSequence, infiniteRegion()) & targetRect;
+    }
+    lastSequence = m_sharedFrame.sequence;
+
+    GLFramebuffer::pushFramebuffer(m_sharedFrame.framebuffer.get());
+    for (const QRect &rect : (damage | bufferRepair) & targetRect) {
+        target->blitFromFramebuffer(rect, rect, GL_NEAREST);
+    }
+    GLFramebuffer::popFramebuffer();
+
+    return damage;
+}
+
+bool OutputScreenCastRenderer::updateSharedFrame()
+{
+    const QSize size = m_output->pixelSize();
+    QRegion repair;
+    if (!m_sharedFrame.texture || m_sharedFrame.texture->size() != size) {
+        m_sharedFrame.framebuffer.reset();
+        m_sharedFrame.texture = GLTexture::allocate(GL_RGBA8, size);
+        if (!m_sharedFrame.texture) {
+            return false;
+        }
+        // Blits copy rows as they are, so the frame must be stored top down like dmabufs
+        m_sharedFrame.texture->setContentTransform(OutputTransform::FlipY);
+        m_sharedFrame.framebuffer = std::make_unique<GLFramebuffer>(m_sharedFrame.texture.get());
+        m_sharedFrame.damageJournal.clear();
+        m_sharedFrame.dirty = true;
+        repair = infiniteRegion();
+    }
+
+    if (!m_sharedFrame.dirty) {
+        return true;
+    }
+
+    const QRegion damage = paint(m_sharedFrame.framebuffer.get(), repair);
+    m_sharedFrame.damageJournal.add(repair.isEmpty() ? damage : QRegion(QRect(QPoint(), size)));
+    m_sharedFrame.sequence++;
+    m_sharedFrame.dirty = false;
+    return true;
+}
+
+SurfaceItem *OutputScreenCastRenderer::passthroughCandidate(const QSize &targetSize) const
+{
+    const auto candidates = m_sceneView->scanoutCandidates(1);
+    if (candidates.size() != 1) {
+        return nullptr;
+    }
+    SurfaceItem *candidate = candidates.front();
+    GraphicsBuffer *buffer = candidate->buffer();
+    if (!buffer) {
+        return nullptr;
+    }
+    const DmaBufAttributes *attrs = buffer->dmabufAttributes();
+    if (!attrs || attrs->planeCount != 1 || buffer->size() != targetSize) {
+        return nullptr;
+    }
+
+    // The buffer must be shown exactly as it is, covering the entire output
+    if (candidate->bufferTransform() != OutputTransform::Kind::Normal
+        || candidate->bufferSourceBox() != QRectF(QPointF(0, 0), buffer->size())) {
+        return nullptr;
+    }
+    // Streams are sRGB. Compare by the conversion rather than by the description object, as
+    // clients that describe their sRGB content explicitly get a different one
+    const auto conversion = ColorConversionCache::lookup(candidate->colorDescription(), ColorDescription::sRGB, candidate->renderingIntent());
+    if (!conversion->pipeline.isIdentity()) {
+        return nullptr;
+    }
+    const QRectF geometry = candidate->mapToView(QRectF(QPointF(0, 0), candidate->size()), m_sceneView.get()).translated(-m_output->geometryF().topLeft());
+    if (scaledRect(geometry, m_output->scale()).toRect() != QRect(QPoint(), targetSize)) {
+        return nullptr;
+    }
+    if (buffer->hasAlphaChannel() && !candidate->opaque().contains(QRect(QPoint(), candidate->size().toSize()))) {
+        return nullptr;
+    }
+    return candidate;
+}
+
+bool OutputScreenCastRenderer::copyScanoutBuffer(SurfaceItem *candidate, GLFramebuffer *target, const QRegion &region)
+{
+    GraphicsBuffer *buffer = candidate->buffer();
+    auto it = m_scanoutImports.find(buffer);
+    if (it == m_scanoutImports.end()) {
+        auto backend = static_cast<EglBackend *>(Compositor::self()->backend());
+        auto texture = backend->openglContext()->importDmaBufAsTexture(*buffer->dmabufAttributes());
+        if (!texture) {
+            return false;
+        }
+        auto framebuffer = std::make_unique<GLFramebuffer>(texture.get());
+        if (!framebuffer->valid()) {
+            return false;
+        }
+        connect(buffer, &QObject::destroyed, this, [this, buffer]() {
+            m_scanoutImports.erase(buffer);
+        });
+        it = m_scanoutImports.emplace(buffer, ScanoutImport{
+                                                  .texture = std::move(texture),
+                                                  .framebuffer = std::move(framebuffer),
+                                              })
+                 .first;
+    }
+
+    GLFramebuffer::pushFramebuffer(it->second.framebuffer.get());
+    for (const QRect &rect : region) {
+        target->blitFromFramebuffer(rect, rect, GL_NEAREST);
+    }
+    GLFramebuffer::popFramebuffer();
+
+    // The client may reuse the buffer only after the copy has finished
+    if (const auto releasePoint = candidate->bufferReleasePoint()) {
+        EGLNativeFence fence(static_cast<EglBackend *>(Compositor::self()->backend())->eglDisplayObject());
+        if (fence.isValid()) {
+            releasePoint->addReleaseFence(fence.fileDescriptor());
+        }
+    }
+    return true;
+}
+
+QRegion OutputScreenCastRenderer::paint(GLFramebuffer *target, const QRegion &bufferRepair)
+{
+    m_layer->setFramebuffer(target, bufferRepair & QRect(QPoint(), target->size()));
+    if (!m_layer->preparePresentationTest()) {
+        return QRegion{};
+    }
+    const auto beginInfo = m_layer->beginFrame();
+    if (!beginInfo) {
+        return QRegion{};
+    }
+    m_sceneView->prePaint();
+    const auto bufferDamage = (m_layer->deviceRepaints() | m_sceneView->collectDamage()) & QRect(QPoint(), target->size());
+    const auto repaints = beginInfo->repaint | bufferDamage;
+    m_layer->resetRepaints();
+
+    // If the output shows nothing but a client buffer, e.g. a fullscreen game that is being
+    // scanned out directly, copy it instead of compositing the scene again
+    SurfaceItem *candidate = EglContext::currentContext()->supportsBlits() ? passthroughCandidate(target->size()) : nullptr;
+    if (!candidate || !copyScanoutBuffer(candidate, target, repaints)) {
+        m_sceneView->paint(beginInfo->renderTarget, repaints);
+    }
+    m_sceneView->postPaint();
+    if (!m_layer->endFrame(repaints, bufferDamage, nullptr)) {
+        return QRegion{};
+    }
+    return bufferDamage;
+}
+
+} // namespace KWin
+
+#include "moc_outputscreencastrenderer.cpp"
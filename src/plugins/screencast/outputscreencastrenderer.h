@@ -0,0 +1,100 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "utils/damagejournal.h"
+
+#include <QObject>
+#include <QPointer>
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+namespace KWin
+{
+
+class FilteredSceneView;
+class GLFramebuffer;
+class GLTexture;
+class GraphicsBuffer;
+class ItemTreeView;
+class LogicalOutput;
+class ScreencastLayer;
+class SurfaceItem;
+
+/**
+ * The OutputScreenCastRenderer class paints an output for screencasts.
+ *
+ * All screencasts of an output that hide the same client and agree on whether the cursor
+ * is painted share one renderer. If there is more than one of them, the scene is painted
+ * once per frame into a shared frame, which is then copied into the buffers of the
+ * individual streams.
+ */
+class OutputScreenCastRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~OutputScreenCastRenderer() override;
+
+    /**
+     * Returns the renderer with the given properties, creating it if there's none yet.
+     */
+    static std::shared_ptr<OutputScreenCastRenderer> acquire(LogicalOutput *output, std::optional<pid_t> pidToHide, bool renderCursor);
+
+    void addConsumer(const void *consumer);
+    void removeConsumer(const void *consumer);
+
+    /**
+     * Paints the output into the @a target of the @a consumer and returns the region that has
+     * changed since the last time the consumer has been painted.
+     */
+    QRegion render(const void *consumer, GLFramebuffer *target, const QRegion &bufferRepair);
+
+Q_SIGNALS:
+    void frame();
+
+private:
+    struct ScanoutImport
+    {
+        std::shared_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+    };
+
+    OutputScreenCastRenderer(LogicalOutput *output, std::optional<pid_t> pidToHide, bool renderCursor);
+
+    QRegion paint(GLFramebuffer *target, const QRegion &bufferRepair);
+    bool updateSharedFrame();
+    SurfaceItem *passthroughCandidate(const QSize &targetSize) const;
+    bool copyScanoutBuffer(SurfaceItem *candidate, GLFramebuffer *target, const QRegion &region);
+
+    QPointer<LogicalOutput> m_output;
+    const std::optional<pid_t> m_pidToHide;
+    const bool m_renderCursor;
+    std::unique_ptr<ScreencastLayer> m_layer;
+    std::unique_ptr<FilteredSceneView> m_sceneView;
+    std::unique_ptr<ItemTreeView> m_cursorView;
+    std::unordered_map<GraphicsBuffer *, ScanoutImport> m_scanoutImports;
+
+    // The sequence number of the last frame every consumer has got, zero if none
+    std::unordered_map<const void *, uint64_t> m_consumers;
+
+    struct
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        DamageJournal damageJournal;
+        uint64_t sequence = 0;
+        bool dirty = true;
+    } m_sharedFrame;
+};
+
+} // namespace KWin
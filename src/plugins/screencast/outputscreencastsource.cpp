@@ -5,20 +5,14 @@
 */
 
 #include "outputscreencastsource.h"
-#include "filteredsceneview.h"
-#include "screencastlayer.h"
+#include "outputscreencastrenderer.h"
 #include "screencastutils.h"
 
-#include "compositor.h"
 #include "core/output.h"
-#include "core/renderbackend.h"
 #include "core/renderloop.h"
 #include "cursor.h"
-#include "opengl/eglbackend.h"
-#include "opengl/egldisplay.h"
 #include "opengl/glframebuffer.h"
 #include "opengl/gltexture.h"
-#include "scene/workspacescene.h"
 #include "workspace.h"
 
 #include <drm_fourcc.h>
@@ -60,9 +54,25 @@ qreal OutputScreenCastSource::devicePixelRatio() const
 
 void OutputScreenCastSource::setRenderCursor(bool enable)
 {
+    if (m_renderCursor == enable) {
+        return;
+    }
     m_renderCursor = enable;
-    if (m_cursorView) {
-        m_cursorView->setExclusive(!enable);
+    if (m_active) {
+        setRenderer(OutputScreenCastRenderer::acquire(m_output, m_pidToHide, m_renderCursor));
+    }
+}
+
+void OutputScreenCastSource::setRenderer(const std::shared_ptr<OutputScreenCastRenderer> &renderer)
+{
+    if (m_renderer) {
+        disconnect(m_renderer.get(), &OutputScreenCastRenderer::frame, this, &OutputScreenCastSource::frame);
+        m_renderer->removeConsumer(this);
+    }
+    m_renderer = renderer;
+    if (m_renderer) {
+        m_renderer->addConsumer(this);
+        connect(m_renderer.get(), &OutputScreenCastRenderer::frame, this, &OutputScreenCastSource::frame);
     }
 }
 
@@ -72,6 +82,8 @@ QRegion OutputScreenCastSource::render(QImage *target, const QRegion &bufferRepa
     if (!texture) {
         return QRegion{};
     }
+    // Store the frame top down like dmabufs, client buffers can be copied into it as they are then
+    texture->setContentTransform(OutputTransform::FlipY);
     GLFramebuffer buffer(texture.get());
     const QRegion ret = render(&buffer, infiniteRegion());
     grabTexture(texture.get(), target);
@@ -80,24 +92,7 @@ QRegion OutputScreenCastSource::render(QImage *target, const QRegion &bufferRepa
 
 QRegion OutputScreenCastSource::render(GLFramebuffer *target, const QRegion &bufferRepair)
 {
-    m_layer->setFramebuffer(target, bufferRepair & QRect(QPoint(), target->size()));
-    if (!m_layer->preparePresentationTest()) {
-        return QRegion{};
-    }
-    const auto beginInfo = m_layer->beginFrame();
-    if (!beginInfo) {
-        return QRegion{};
-    }
-    m_sceneView->prePaint();
-    const auto bufferDamage = (m_layer->deviceRepaints() | m_sceneView->collectDamage()) & QRect(QPoint(), target->size());
-    const auto repaints = beginInfo->repaint | bufferDamage;
-    m_layer->resetRepaints();
-    m_sceneView->paint(beginInfo->renderTarget, repaints);
-    m_sceneView->postPaint();
-    if (!m_layer->endFrame(repaints, bufferDamage, nullptr)) {
-        return QRegion{};
-    }
-    return bufferDamage;
+    return m_renderer->render(this, target, bufferRepair);
 }
 
 std::chrono::nanoseconds OutputScreenCastSource::clock() const
@@ -116,20 +111,7 @@ void OutputScreenCastSource::resume()
         return;
     }
 
-    m_layer = std::make_unique<ScreencastLayer>(m_output, static_cast<EglBackend *>(Compositor::self()->backend())->openglContext()->displayObject()->nonExternalOnlySupportedDrmFormats());
-
-    m_sceneView = std::make_unique<FilteredSceneView>(Compositor::self()->scene(), m_output, m_layer.get(), m_pidToHide);
-    m_sceneView->setViewport(m_output->geometryF());
-    m_sceneView->setScale(m_output->scale());
-    connect(m_output, &LogicalOutput::changed, m_sceneView.get(), [this]() {
-        m_sceneView->setViewport(m_output->geometryF());
-        m_sceneView->setScale(m_output->scale());
-    });
-
-    m_cursorView = std::make_unique<ItemTreeView>(m_sceneView.get(), Compositor::self()->scene()->cursorItem(), m_output, nullptr);
-    m_cursorView->setExclusive(!m_renderCursor);
-
-    connect(m_layer.get(), &OutputLayer::repaintScheduled, this, &OutputScreenCastSource::frame);
+    setRenderer(OutputScreenCastRenderer::acquire(m_output, m_pidToHide, m_renderCursor));
     Q_EMIT frame();
 
     m_active = true;
@@ -141,11 +123,7 @@ void OutputScreenCastSource::pause()
         return;
     }
 
-    disconnect(m_layer.get(), &OutputLayer::repaintScheduled, this, &OutputScreenCastSource::frame);
-
-    m_cursorView.reset();
-    m_sceneView.reset();
-    m_layer.reset();
+    setRenderer(nullptr);
 
     m_active = false;
 }
@@ -165,6 +143,11 @@ QRectF OutputScreenCastSource::mapFromGlobal(const QRectF &rect) const
     return m_output->mapFromGlobal(rect);
 }
 
+ContentType OutputScreenCastSource::contentType() const
+{
+    return dominantContentType(m_output->geometryF(), m_pidToHide);
+}
+
 } // namespace KWin
 
 #include "moc_outputscreencastsource.cpp"
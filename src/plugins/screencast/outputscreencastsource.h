@@ -10,13 +10,13 @@
 
 #include <QPointer>
 
+#include <memory>
+
 namespace KWin
 {
 
-class FilteredSceneView;
-class ItemTreeView;
 class LogicalOutput;
-class ScreencastLayer;
+class OutputScreenCastRenderer;
 
 class OutputScreenCastSource : public ScreenCastSource
 {
@@ -44,12 +44,14 @@ public:
     QPointF mapFromGlobal(const QPointF &point) const override;
     QRectF mapFromGlobal(const QRectF &rect) const override;
 
+    ContentType contentType() const override;
+
 private:
+    void setRenderer(const std::shared_ptr<OutputScreenCastRenderer> &renderer);
+
     QPointer<LogicalOutput> m_output;
     std::optional<pid_t> m_pidToHide;
-    std::unique_ptr<ScreencastLayer> m_layer;
-    std::unique_ptr<FilteredSceneView> m_sceneView;
-    std::unique_ptr<ItemTreeView> m_cursorView;
+    std::shared_ptr<OutputScreenCastRenderer> m_renderer;
     bool m_active = false;
     bool m_renderCursor = false;
 };
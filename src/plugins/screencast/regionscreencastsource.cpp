@@ -177,6 +177,11 @@ QRectF RegionScreenCastSource::mapFromGlobal(const QRectF &rect) const
     return rect.translated(-m_region.topLeft());
 }
 
+ContentType RegionScreenCastSource::contentType() const
+{
+    return dominantContentType(m_region, m_pidToHide);
+}
+
 } // namespace KWin
 
 #include "moc_regionscreencastsource.cpp"
@@ -45,6 +45,8 @@ public:
     QPointF mapFromGlobal(const QPointF &point) const override;
     QRectF mapFromGlobal(const QRectF &rect) const override;
 
+    ContentType contentType() const override;
+
 private:
     const QRect m_region;
     const qreal m_scale;
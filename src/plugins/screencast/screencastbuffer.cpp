@@ -24,12 +24,23 @@ ScreenCastBuffer::~ScreenCastBuffer()
     m_buffer->drop();
 }
 
+GraphicsBuffer *ScreenCastBuffer::buffer() const
+{
+    return m_buffer;
+}
+
 DmaBufScreenCastBuffer::DmaBufScreenCastBuffer(GraphicsBuffer *buffer, std::shared_ptr<GLTexture> &&texture, std::unique_ptr<GLFramebuffer> &&framebuffer, std::unique_ptr<SyncTimeline> &&synctimeline)
     : ScreenCastBuffer(buffer)
     , texture(std::move(texture))
     , framebuffer(std::move(framebuffer))
     , synctimeline(std::move(synctimeline))
 {
+    const DmaBufAttributes *attrs = buffer->dmabufAttributes();
+    uint64_t byteSize = 0;
+    for (int i = 0; i < attrs->planeCount; ++i) {
+        byteSize += uint64_t(attrs->pitch[i]) * attrs->height;
+    }
+    allocation = GpuMemoryAllocation(GpuMemoryCategory::ScreenCast, byteSize);
 }
 
 DmaBufScreenCastBuffer *DmaBufScreenCastBuffer::create(pw_buffer *pwBuffer, const GraphicsBufferOptions &options)
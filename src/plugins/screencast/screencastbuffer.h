@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "core/gpumemory.h"
 #include "core/graphicsbufferview.h"
 #include "core/syncobjtimeline.h"
 
@@ -25,6 +26,8 @@ public:
     explicit ScreenCastBuffer(GraphicsBuffer *buffer);
     virtual ~ScreenCastBuffer();
 
+    GraphicsBuffer *buffer() const;
+
     int m_age = 0;
 
 private:
@@ -39,6 +42,7 @@ public:
     std::shared_ptr<GLTexture> texture;
     std::unique_ptr<GLFramebuffer> framebuffer;
     std::unique_ptr<SyncTimeline> synctimeline;
+    GpuMemoryAllocation allocation;
 
 private:
     DmaBufScreenCastBuffer(GraphicsBuffer *buffer, std::shared_ptr<GLTexture> &&texture, std::unique_ptr<GLFramebuffer> &&framebuffer, std::unique_ptr<SyncTimeline> &&synctimeline);
@@ -5,6 +5,12 @@
 */
 
 #include "screencastsource.h"
+#include "scene/windowitem.h"
+#include "wayland/surface.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <ranges>
 
 namespace KWin
 {
@@ -13,6 +19,55 @@ ScreenCastSource::ScreenCastSource()
 {
 }
 
+ContentType ScreenCastSource::contentType() const
+{
+    return ContentType::None;
+}
+
+static ContentType windowContentType(const Window *window)
+{
+    const SurfaceInterface *surface = window->surface();
+    return surface ? surface->contentType() : ContentType::None;
+}
+
+ContentType ScreenCastSource::dominantContentType(const QRectF &area, std::optional<pid_t> pidToHide)
+{
+    const QRect bounds = area.toAlignedRect();
+    QRegion covered;
+    qint64 largestArea = 0;
+    ContentType ret = ContentType::None;
+
+    const auto stackingOrder = workspace()->stackingOrder();
+    for (Window *window : stackingOrder | std::views::reverse) {
+        if (window->isDeleted() || !window->windowItem() || !window->windowItem()->isVisible()) {
+            continue;
+        }
+        if (pidToHide && window->pid() == *pidToHide) {
+            continue;
+        }
+        const QRect geometry = window->frameGeometry().toAlignedRect() & bounds;
+        if (geometry.isEmpty()) {
+            continue;
+        }
+
+        qint64 visibleArea = 0;
+        for (const QRect &rect : QRegion(geometry) - covered) {
+            visibleArea += qint64(rect.width()) * rect.height();
+        }
+        if (visibleArea > largestArea) {
+            largestArea = visibleArea;
+            ret = windowContentType(window);
+        }
+
+        covered += geometry;
+        if (covered.contains(bounds)) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
 } // namespace KWin
 
 #include "moc_screencastsource.cpp"
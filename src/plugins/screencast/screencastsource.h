@@ -6,8 +6,12 @@
 
 #pragma once
 
+#include "effect/globals.h"
+
 #include <QObject>
 
+#include <optional>
+
 class QImage;
 
 namespace KWin
@@ -42,6 +46,19 @@ public:
     virtual QPointF mapFromGlobal(const QPointF &point) const = 0;
     virtual QRectF mapFromGlobal(const QRectF &rect) const = 0;
 
+    /**
+     * Returns the content type of the window that takes up most of the source, so that encoders
+     * can tune themselves for videos or games.
+     */
+    virtual ContentType contentType() const;
+
+protected:
+    /**
+     * Returns the content type of the window that takes up the largest visible part of the
+     * @a area, in global logical coordinates.
+     */
+    static ContentType dominantContentType(const QRectF &area, std::optional<pid_t> pidToHide);
+
 Q_SIGNALS:
     void frame();
     void closed();
@@ -9,6 +9,7 @@
 #include "screencaststream.h"
 #include "compositor.h"
 #include "core/drmdevice.h"
+#include "core/graphicsbuffer.h"
 #include "core/graphicsbufferallocator.h"
 #include "core/renderbackend.h"
 #include "cursor.h"
@@ -16,12 +17,15 @@
 #include "main.h"
 #include "opengl/eglbackend.h"
 #include "opengl/eglnativefence.h"
+#include "opengl/glframebuffer.h"
+#include "opengl/glpassprofiler.h"
 #include "opengl/glplatform.h"
 #include "opengl/gltexture.h"
 #include "pipewirecore.h"
 #include "scene/workspacescene.h"
 #include "screencastbuffer.h"
 #include "screencastsource.h"
+#include "screencastutils.h"
 #include "utils/drm_format_helper.h"
 
 #include <KLocalizedString>
@@ -145,14 +149,15 @@ void ScreenCastStream::onStreamStateChanged(pw_stream_state old, pw_stream_state
 
 #define CURSOR_BPP 4
 #define CURSOR_META_SIZE(w, h) (sizeof(struct spa_meta_cursor) + sizeof(struct spa_meta_bitmap) + w * h * CURSOR_BPP)
-static const int videoDamageRegionCount = 16;
+static const int videoDamageRegionCount = 64;
 
 void ScreenCastStream::newStreamParams()
 {
     qCDebug(KWIN_SCREENCAST) << objectName() << "announcing stream params. with dmabuf:" << m_dmabufParams.has_value();
     const int buffertypes = m_dmabufParams ? (1 << SPA_DATA_DmaBuf) : (1 << SPA_DATA_MemFd);
     const int bpp = m_videoFormat.format == SPA_VIDEO_FORMAT_RGB || m_videoFormat.format == SPA_VIDEO_FORMAT_BGR ? 3 : 4;
-    const int stride = SPA_ROUND_UP_N(m_resolution.width() * bpp, 4);
+    const QSize size = streamSize();
+    const int stride = SPA_ROUND_UP_N(size.width() * bpp, 4);
 
     struct spa_pod_dynamic_builder pod_builder;
     struct spa_pod_frame f;
@@ -181,7 +186,7 @@ void ScreenCastStream::newStreamParams()
     if (!m_dmabufParams) {
         spa_pod_builder_add(&pod_builder.b,
                             SPA_PARAM_BUFFERS_blocks, SPA_POD_Int(1),
-                            SPA_PARAM_BUFFERS_size, SPA_POD_Int(stride * m_resolution.height()),
+                            SPA_PARAM_BUFFERS_size, SPA_POD_Int(stride * size.height()),
                             SPA_PARAM_BUFFERS_stride, SPA_POD_Int(stride),
                             SPA_PARAM_BUFFERS_align, SPA_POD_Int(16), 0);
     } else {
@@ -244,13 +249,14 @@ void ScreenCastStream::onStreamParamChanged(uint32_t id, const struct spa_pod *f
             }
         }
 
-        if (!m_dmabufParams || m_dmabufParams->width != m_resolution.width() || m_dmabufParams->height != m_resolution.height() || !receivedModifiers.contains(m_dmabufParams->modifier)) {
+        const QSize size = streamSize();
+        if (!m_dmabufParams || m_dmabufParams->width != size.width() || m_dmabufParams->height != size.height() || !receivedModifiers.contains(m_dmabufParams->modifier)) {
             // DRM_MOD_INVALID should be used as a last option. Do not just remove it it's the only
             // item on the list
             if (receivedModifiers.count() > 1) {
                 receivedModifiers.removeAll(DRM_FORMAT_MOD_INVALID);
             }
-            m_dmabufParams = testCreateDmaBuf(m_resolution, m_drmFormat, receivedModifiers);
+            m_dmabufParams = testCreateDmaBuf(size, m_drmFormat, receivedModifiers);
 
             // In case we fail to use any modifier from the list of offered ones, remove these
             // from our all future offerings, otherwise there will be no indication that it cannot
@@ -284,7 +290,7 @@ void ScreenCastStream::onStreamAddBuffer(pw_buffer *pwBuffer)
     struct spa_data *spa_data = pwBuffer->buffer->datas;
     if (spa_data[0].type & (1 << SPA_DATA_DmaBuf)) {
         if (auto dmabuf = DmaBufScreenCastBuffer::create(pwBuffer, GraphicsBufferOptions{
-                                                                       .size = QSize(m_videoFormat.size.width, m_videoFormat.size.height),
+                                                                       .size = streamSize(),
                                                                        .format = spaVideoFormatToDrmFormat(m_videoFormat.format),
                                                                        .modifiers = {m_videoFormat.modifier},
                                                                    })) {
@@ -296,7 +302,7 @@ void ScreenCastStream::onStreamAddBuffer(pw_buffer *pwBuffer)
 
     if (spa_data[0].type & (1 << SPA_DATA_MemFd)) {
         if (auto memfd = MemFdScreenCastBuffer::create(pwBuffer, GraphicsBufferOptions{
-                                                                     .size = QSize(m_videoFormat.size.width, m_videoFormat.size.height),
+                                                                     .size = streamSize(),
                                                                      .format = spaVideoFormatToDrmFormat(m_videoFormat.format),
                                                                      .software = true,
                                                                  })) {
@@ -348,9 +354,15 @@ ScreenCastStream::ScreenCastStream(ScreenCastSource *source, std::shared_ptr<Pip
     };
 
     m_pendingFrame.setSingleShot(true);
+    m_pendingFrame.setTimerType(Qt::PreciseTimer);
     connect(&m_pendingFrame, &QTimer::timeout, this, [this] {
-        record(m_pendingContents);
-        m_pendingContents = Contents();
+        if (record(m_pendingContents)) {
+            m_pendingContents = Contents();
+        } else {
+            // All buffers are still held by the consumer. Rather than painting a frame that
+            // would be dropped, keep the changes and try again once the consumer is done
+            m_pendingFrame.start(std::max(std::chrono::duration_cast<std::chrono::milliseconds>(frameInterval() / 4), std::chrono::milliseconds(1)));
+        }
     });
 }
 
@@ -401,10 +413,25 @@ uint ScreenCastStream::nodeId()
     return m_pwNodeId;
 }
 
+// The media role tells encoders what kind of content dominates the stream
+static const char *mediaRole(ContentType contentType)
+{
+    switch (contentType) {
+    case ContentType::Video:
+        return "Movie";
+    case ContentType::Game:
+        return "Game";
+    case ContentType::None:
+    case ContentType::Photo:
+        return "Screen";
+    }
+    Q_UNREACHABLE();
+}
+
 bool ScreenCastStream::createStream()
 {
     const QByteArray objname = "kwin-screencast-" + objectName().toUtf8();
-    m_pwStream = pw_stream_new(m_pwCore->pwCore, objname, nullptr);
+    m_pwStream = pw_stream_new(m_pwCore->pwCore, objname, pw_properties_new(PW_KEY_MEDIA_ROLE, mediaRole(m_contentType), nullptr));
 
     const auto supported = Compositor::self()->backend()->supportedFormats();
     auto itModifiers = supported.constFind(m_source->drmFormat());
@@ -479,6 +506,22 @@ void ScreenCastStream::close()
     Q_EMIT closed();
 }
 
+static bool attachRenderFence(DmaBufScreenCastBuffer *buffer)
+{
+    const auto backend = static_cast<EglBackend *>(Compositor::self()->backend());
+    EGLNativeFence fence(backend->eglDisplayObject());
+    if (!fence.isValid()) {
+        return false;
+    }
+    const DmaBufAttributes *attributes = buffer->buffer()->dmabufAttributes();
+    for (int i = 0; i < attributes->planeCount; ++i) {
+        if (!importDmaBufWriteFence(attributes->fd[i], fence.fileDescriptor())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ScreenCastStream::scheduleRecord(Contents contents)
 {
     Q_ASSERT(!m_closed);
@@ -503,18 +546,28 @@ void ScreenCastStream::scheduleRecord(Contents contents)
     if (m_pendingFrame.isActive()) {
         return;
     }
+
+    // Changes that arrive before the consumer wants the next frame are coalesced into it
     std::chrono::milliseconds waitInterval{0};
     if (m_videoFormat.max_framerate.num != 0 && m_lastSent.has_value()) {
         const auto now = std::chrono::steady_clock::now();
-        const auto frameInterval = std::chrono::milliseconds(1000 * m_videoFormat.max_framerate.denom / m_videoFormat.max_framerate.num);
-        const auto lastSentAgo = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastSent.value());
-        if (lastSentAgo < frameInterval) {
-            waitInterval = frameInterval - lastSentAgo;
+        const auto nextFrame = m_lastSent.value() + frameInterval();
+        if (now < nextFrame) {
+            waitInterval = std::chrono::ceil<std::chrono::milliseconds>(nextFrame - now);
         }
     }
     m_pendingFrame.start(waitInterval);
 }
 
+std::chrono::nanoseconds ScreenCastStream::frameInterval() const
+{
+    if (m_videoFormat.max_framerate.num != 0) {
+        return std::chrono::nanoseconds(1'000'000'000ll * m_videoFormat.max_framerate.denom / m_videoFormat.max_framerate.num);
+    }
+    // The refresh rate is in millihertz
+    return std::chrono::nanoseconds(1'000'000'000'000ll / std::max(m_source->refreshRate(), 1u));
+}
+
 pw_buffer *ScreenCastStream::dequeueBuffer()
 {
     const auto isBufferUsable = [](pw_buffer *pwBuffer) {
@@ -566,16 +619,16 @@ pw_buffer *ScreenCastStream::dequeueBuffer()
     return pwBuffer;
 }
 
-void ScreenCastStream::record(Contents contents)
+bool ScreenCastStream::record(Contents contents)
 {
     EglBackend *backend = qobject_cast<EglBackend *>(Compositor::self()->backend());
     if (!backend) {
-        return;
+        return true;
     }
 
     struct pw_buffer *pwBuffer = dequeueBuffer();
     if (!pwBuffer) {
-        return;
+        return false;
     }
 
     struct spa_buffer *spa_buffer = pwBuffer->buffer;
@@ -606,10 +659,18 @@ void ScreenCastStream::record(Contents contents)
 
     spa_meta_sync_timeline *synctmeta = nullptr;
 
+    // Consumers may ask for a smaller size than the one of the source
+    const bool scaled = streamSize() != m_source->textureSize();
+
     QRegion damage;
     if (effectiveContents & Content::Video) {
+        GLPassScope passScope(u"screencast", objectName());
         if (auto memfd = dynamic_cast<MemFdScreenCastBuffer *>(buffer)) {
-            damage = m_source->render(memfd->view.image(), m_damageJournal.accumulate(memfd->m_age, infiniteRegion()));
+            if (scaled) {
+                damage = renderScaled(memfd->view.image());
+            } else {
+                damage = m_source->render(memfd->view.image(), m_damageJournal.accumulate(memfd->m_age, infiniteRegion()));
+            }
             bumpBufferAge(memfd);
         } else if (auto dmabuf = dynamic_cast<DmaBufScreenCastBuffer *>(buffer)) {
             if (dmabuf->synctimeline) {
@@ -623,7 +684,11 @@ void ScreenCastStream::record(Contents contents)
                 }
             }
 
-            damage = m_source->render(dmabuf->framebuffer.get(), m_damageJournal.accumulate(dmabuf->m_age, infiniteRegion()));
+            if (scaled) {
+                damage = renderScaled(dmabuf->framebuffer.get(), m_damageJournal.accumulate(dmabuf->m_age, infiniteRegion()));
+            } else {
+                damage = m_source->render(dmabuf->framebuffer.get(), m_damageJournal.accumulate(dmabuf->m_age, infiniteRegion()));
+            }
             bumpBufferAge(dmabuf);
         }
         m_damageJournal.add(damage);
@@ -639,9 +704,12 @@ void ScreenCastStream::record(Contents contents)
             auto dmabuf = static_cast<DmaBufScreenCastBuffer *>(buffer);
             dmabuf->synctimeline->moveInto(synctmeta->acquire_point, fence.takeFileDescriptor());
         } else {
-            // Implicit sync is broken on Nvidia and with llvmpipe
+            // Implicit sync is broken on Nvidia and with llvmpipe. Put the fence of the rendering
+            // into the dma-buf so that the consumer waits nevertheless, and only block if that fails
             if (context->glPlatform()->isNvidia() || context->isSoftwareRenderer()) {
-                glFinish();
+                if (!attachRenderFence(static_cast<DmaBufScreenCastBuffer *>(buffer))) {
+                    EglContext::finish();
+                }
             } else {
                 glFlush();
             }
@@ -649,7 +717,11 @@ void ScreenCastStream::record(Contents contents)
     }
 
     addDamage(spa_buffer, damage);
-    addHeader(spa_buffer);
+    addHeader(spa_buffer, (effectiveContents & Content::Video) && damage.isEmpty());
+
+    if (effectiveContents & Content::Video) {
+        updateContentType(m_source->contentType());
+    }
 
     if (effectiveContents & Content::Video) {
         spa_data->chunk->flags = SPA_CHUNK_FLAG_NONE;
@@ -659,9 +731,104 @@ void ScreenCastStream::record(Contents contents)
     }
 
     pw_stream_queue_buffer(m_pwStream, pwBuffer);
-    m_lastSent = std::chrono::steady_clock::now();
+
+    // Keep the frames on the grid given by the frame rate, so that timer latency doesn't add up
+    // and push the rate below what the consumer asked for
+    const auto now = std::chrono::steady_clock::now();
+    const auto interval = frameInterval();
+    if (m_lastSent && now - *m_lastSent < 2 * interval) {
+        m_lastSent = std::max(*m_lastSent + interval, now - interval);
+    } else {
+        m_lastSent = now;
+    }
 
     resize(m_source->textureSize());
+    return true;
+}
+
+QSize ScreenCastStream::streamSize() const
+{
+    return QSize(m_videoFormat.size.width, m_videoFormat.size.height);
+}
+
+bool ScreenCastStream::updateScaledFrame()
+{
+    const QSize sourceSize = m_source->textureSize();
+    QRegion repair;
+    if (!m_scaledFrame.texture || m_scaledFrame.texture->size() != sourceSize) {
+        m_scaledFrame.framebuffer.reset();
+        m_scaledFrame.texture = GLTexture::allocate(GL_RGBA8, sourceSize);
+        if (!m_scaledFrame.texture) {
+            return false;
+        }
+        // Blits copy rows as they are, so the frame must be stored top down like dmabufs
+        m_scaledFrame.texture->setContentTransform(OutputTransform::FlipY);
+        m_scaledFrame.framebuffer = std::make_unique<GLFramebuffer>(m_scaledFrame.texture.get());
+        repair = infiniteRegion();
+    }
+
+    // The frame is kept around, so only the parts that have changed since the last time need
+    // to be painted again
+    m_scaledFrame.damage = m_source->render(m_scaledFrame.framebuffer.get(), repair);
+    return true;
+}
+
+void ScreenCastStream::downscale(GLFramebuffer *target, const QRegion &region)
+{
+    const QRect targetRect(QPoint(), target->size());
+
+    // The whole frame is blitted and the damaged parts are picked with the scissor, so that
+    // the rectangles line up without any seams between them
+    GLFramebuffer::pushFramebuffer(m_scaledFrame.framebuffer.get());
+    glEnable(GL_SCISSOR_TEST);
+    for (const QRect &rect : region) {
+        glScissor(rect.x(), targetRect.height() - rect.y() - rect.height(), rect.width(), rect.height());
+        target->blitFromFramebuffer(QRect(QPoint(), m_scaledFrame.texture->size()), targetRect, GL_LINEAR);
+    }
+    glDisable(GL_SCISSOR_TEST);
+    GLFramebuffer::popFramebuffer();
+}
+
+QRegion ScreenCastStream::scaledDamage(const QSize &targetSize) const
+{
+    const QSize sourceSize = m_scaledFrame.texture->size();
+    const qreal xScale = qreal(targetSize.width()) / sourceSize.width();
+    const qreal yScale = qreal(targetSize.height()) / sourceSize.height();
+    const QRect bounds(QPoint(), targetSize);
+
+    QRegion ret;
+    for (const QRect &rect : m_scaledFrame.damage) {
+        const QRectF scaled(rect.x() * xScale, rect.y() * yScale, rect.width() * xScale, rect.height() * yScale);
+        // Linear filtering also reads the texels next to the damaged ones
+        ret += scaled.toAlignedRect().adjusted(-1, -1, 1, 1) & bounds;
+    }
+    return ret;
+}
+
+QRegion ScreenCastStream::renderScaled(GLFramebuffer *target, const QRegion &bufferRepair)
+{
+    if (!updateScaledFrame()) {
+        return QRegion{};
+    }
+    const QRegion damage = scaledDamage(target->size());
+    downscale(target, (damage | bufferRepair) & QRect(QPoint(), target->size()));
+    return damage;
+}
+
+QRegion ScreenCastStream::renderScaled(QImage *target)
+{
+    if (!updateScaledFrame()) {
+        return QRegion{};
+    }
+    auto texture = GLTexture::allocate(GL_RGBA8, target->size());
+    if (!texture) {
+        return QRegion{};
+    }
+    texture->setContentTransform(OutputTransform::FlipY);
+    GLFramebuffer framebuffer(texture.get());
+    downscale(&framebuffer, QRect(QPoint(), target->size()));
+    grabTexture(texture.get(), target);
+    return scaledDamage(target->size());
 }
 
 void ScreenCastStream::bumpBufferAge(ScreenCastBuffer *renderedBuffer)
@@ -687,11 +854,12 @@ void ScreenCastStream::resize(const QSize &resolution)
     pw_stream_update_params(m_pwStream, params.data(), params.count());
 }
 
-void ScreenCastStream::addHeader(spa_buffer *spaBuffer)
+void ScreenCastStream::addHeader(spa_buffer *spaBuffer, bool unchanged)
 {
     spa_meta_header *spaHeader = (spa_meta_header *)spa_buffer_find_meta_data(spaBuffer, SPA_META_Header, sizeof(spa_meta_header));
     if (spaHeader) {
-        spaHeader->flags = 0;
+        // A gap tells encoders that the frame is the same as the previous one
+        spaHeader->flags = unchanged ? SPA_META_HEADER_FLAG_GAP : 0;
         spaHeader->dts_offset = 0;
         spaHeader->seq = m_sequential++;
         spaHeader->pts = m_source->clock().count();
@@ -710,19 +878,28 @@ void ScreenCastStream::addDamage(spa_buffer *spaBuffer, const QRegion &damagedRe
 {
     if (spa_meta *vdMeta = spa_buffer_find_meta(spaBuffer, SPA_META_VideoDamage)) {
         struct spa_meta_region *r = (spa_meta_region *)spa_meta_first(vdMeta);
+        const int capacity = vdMeta->size / sizeof(spa_meta_region);
 
-        // If there's too many rectangles, we just send the bounding rect
-        if (damagedRegion.rectCount() > videoDamageRegionCount - 1) {
+        auto append = [&r, vdMeta](const QRect &rect) {
             if (spa_meta_check(r, vdMeta)) {
-                auto rect = damagedRegion.boundingRect();
                 r->region = SPA_REGION(rect.x(), rect.y(), quint32(rect.width()), quint32(rect.height()));
                 r++;
             }
-        } else {
+        };
+
+        if (damagedRegion.rectCount() <= capacity) {
             for (const QRect &rect : damagedRegion) {
-                if (spa_meta_check(r, vdMeta)) {
-                    r->region = SPA_REGION(rect.x(), rect.y(), quint32(rect.width()), quint32(rect.height()));
-                    r++;
+                append(rect);
+            }
+        } else {
+            // If there are too many rectangles, split the damage into as many horizontal bands as
+            // the consumer can take and send the bounding rect of each band
+            const QRect bounds = damagedRegion.boundingRect();
+            const int bandHeight = (bounds.height() + capacity - 1) / capacity;
+            for (int y = bounds.top(); y <= bounds.bottom(); y += bandHeight) {
+                const QRect band = (damagedRegion & QRect(bounds.x(), y, bounds.width(), bandHeight)).boundingRect();
+                if (!band.isEmpty()) {
+                    append(band);
                 }
             }
         }
@@ -733,6 +910,20 @@ void ScreenCastStream::addDamage(spa_buffer *spaBuffer, const QRegion &damagedRe
     }
 }
 
+void ScreenCastStream::updateContentType(ContentType contentType)
+{
+    if (m_contentType == contentType) {
+        return;
+    }
+    m_contentType = contentType;
+
+    const spa_dict_item items[] = {
+        SPA_DICT_ITEM_INIT(PW_KEY_MEDIA_ROLE, mediaRole(contentType)),
+    };
+    const spa_dict dict = SPA_DICT_INIT_ARRAY(items);
+    pw_stream_update_properties(m_pwStream, &dict);
+}
+
 void ScreenCastStream::invalidateCursor()
 {
     m_cursor.invalid = true;
@@ -748,20 +939,24 @@ QList<const spa_pod *> ScreenCastStream::buildFormats(bool fixate, char buffer[2
     spa_fraction minFramerate = SPA_FRACTION(1, 1);
     spa_fraction maxFramerate = SPA_FRACTION(m_source->refreshRate() / 1000, 1);
 
+    // Consumers can pick a smaller size, the frames are downscaled after they have been painted
     spa_rectangle resolution = SPA_RECTANGLE(uint32_t(m_resolution.width()), uint32_t(m_resolution.height()));
+    spa_rectangle minResolution = SPA_RECTANGLE(1, 1);
 
     QList<const spa_pod *> params;
     if (m_hasDmaBuf) {
         if (fixate) {
-            params.append(buildFormat(&podBuilder, dmabufFormat, &resolution, &defFramerate, &minFramerate, &maxFramerate, {m_dmabufParams->modifier}, SPA_POD_PROP_FLAG_MANDATORY));
+            spa_rectangle fixatedResolution = SPA_RECTANGLE(uint32_t(m_dmabufParams->width), uint32_t(m_dmabufParams->height));
+            params.append(buildFormat(&podBuilder, dmabufFormat, &fixatedResolution, &fixatedResolution, &fixatedResolution, &defFramerate, &minFramerate, &maxFramerate, {m_dmabufParams->modifier}, SPA_POD_PROP_FLAG_MANDATORY));
         }
-        params.append(buildFormat(&podBuilder, dmabufFormat, &resolution, &defFramerate, &minFramerate, &maxFramerate, m_modifiers, SPA_POD_PROP_FLAG_MANDATORY | SPA_POD_PROP_FLAG_DONT_FIXATE));
+        params.append(buildFormat(&podBuilder, dmabufFormat, &resolution, &minResolution, &resolution, &defFramerate, &minFramerate, &maxFramerate, m_modifiers, SPA_POD_PROP_FLAG_MANDATORY | SPA_POD_PROP_FLAG_DONT_FIXATE));
     }
-    params.append(buildFormat(&podBuilder, shmFormat, &resolution, &defFramerate, &minFramerate, &maxFramerate, {}, 0));
+    params.append(buildFormat(&podBuilder, shmFormat, &resolution, &minResolution, &resolution, &defFramerate, &minFramerate, &maxFramerate, {}, 0));
     return params;
 }
 
-spa_pod *ScreenCastStream::buildFormat(struct spa_pod_builder *b, enum spa_video_format format, struct spa_rectangle *resolution,
+spa_pod *ScreenCastStream::buildFormat(struct spa_pod_builder *b, enum spa_video_format format,
+                                       struct spa_rectangle *resolution, struct spa_rectangle *minResolution, struct spa_rectangle *maxResolution,
                                        struct spa_fraction *defaultFramerate, struct spa_fraction *minFramerate, struct spa_fraction *maxFramerate,
                                        const QList<uint64_t> &modifiers, quint32 modifiersFlags)
 {
@@ -769,7 +964,12 @@ spa_pod *ScreenCastStream::buildFormat(struct spa_pod_builder *b, enum spa_video
     spa_pod_builder_push_object(b, &f[0], SPA_TYPE_OBJECT_Format, SPA_PARAM_EnumFormat);
     spa_pod_builder_add(b, SPA_FORMAT_mediaType, SPA_POD_Id(SPA_MEDIA_TYPE_video), 0);
     spa_pod_builder_add(b, SPA_FORMAT_mediaSubtype, SPA_POD_Id(SPA_MEDIA_SUBTYPE_raw), 0);
-    spa_pod_builder_add(b, SPA_FORMAT_VIDEO_size, SPA_POD_Rectangle(resolution), 0);
+    spa_pod_builder_add(b, SPA_FORMAT_VIDEO_size,
+                        SPA_POD_CHOICE_RANGE_Rectangle(
+                            SPA_POD_Rectangle(resolution),
+                            SPA_POD_Rectangle(minResolution),
+                            SPA_POD_Rectangle(maxResolution)),
+                        0);
     spa_pod_builder_add(b, SPA_FORMAT_VIDEO_framerate, SPA_POD_Fraction(defaultFramerate), 0);
     spa_pod_builder_add(b, SPA_FORMAT_VIDEO_maxFramerate,
                         SPA_POD_CHOICE_RANGE_Fraction(
@@ -822,12 +1022,14 @@ void ScreenCastStream::addCursorMetadata(spa_buffer *spaBuffer, Cursor *cursor)
     }
     m_cursor.visible = true;
 
-    const qreal scale = m_source->devicePixelRatio();
-    const auto position = m_source->mapFromGlobal(cursor->pos()) * scale;
+    // The stream can be smaller than the source
+    const QSizeF streamScale(qreal(m_videoFormat.size.width) / m_resolution.width(), qreal(m_videoFormat.size.height) / m_resolution.height());
+    const qreal scale = m_source->devicePixelRatio() * streamScale.width();
+    const auto position = m_source->mapFromGlobal(cursor->pos()) * m_source->devicePixelRatio();
 
     spaMetaCursor->id = 1;
-    spaMetaCursor->position.x = position.x();
-    spaMetaCursor->position.y = position.y();
+    spaMetaCursor->position.x = position.x() * streamScale.width();
+    spaMetaCursor->position.y = position.y() * streamScale.height();
     spaMetaCursor->hotspot.x = cursor->hotspot().x() * scale;
     spaMetaCursor->hotspot.y = cursor->hotspot().y() * scale;
     spaMetaCursor->bitmap_offset = 0;
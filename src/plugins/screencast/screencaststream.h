@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "effect/globals.h"
 #include "utils/damagejournal.h"
 #include "wayland/screencast_v1.h"
 
@@ -28,6 +29,8 @@ namespace KWin
 {
 
 class Cursor;
+class GLFramebuffer;
+class GLTexture;
 class PipeWireCore;
 class ScreenCastBuffer;
 class ScreenCastSource;
@@ -90,16 +93,29 @@ private:
     void resize(const QSize &resolution);
     void coreFailed(const QString &errorMessage);
     void addCursorMetadata(spa_buffer *spaBuffer, Cursor *cursor);
-    void addHeader(spa_buffer *spaBuffer);
+    void addHeader(spa_buffer *spaBuffer, bool unchanged);
     void corruptHeader(spa_buffer *spaBuffer);
     void addDamage(spa_buffer *spaBuffer, const QRegion &damagedRegion);
+    void updateContentType(ContentType contentType);
     void newStreamParams();
-    spa_pod *buildFormat(struct spa_pod_builder *b, enum spa_video_format format, struct spa_rectangle *resolution,
+    spa_pod *buildFormat(struct spa_pod_builder *b, enum spa_video_format format,
+                         struct spa_rectangle *resolution, struct spa_rectangle *minResolution, struct spa_rectangle *maxResolution,
                          struct spa_fraction *defaultFramerate, struct spa_fraction *minFramerate, struct spa_fraction *maxFramerate,
                          const QList<uint64_t> &modifiers, quint32 modifiersFlags);
     pw_buffer *dequeueBuffer();
-    void record(Contents contents);
+    /**
+     * Returns @c false if there was no buffer to record the frame into.
+     */
+    bool record(Contents contents);
+    std::chrono::nanoseconds frameInterval() const;
     void bumpBufferAge(ScreenCastBuffer *renderedBuffer);
+    QSize streamSize() const;
+
+    bool updateScaledFrame();
+    void downscale(GLFramebuffer *target, const QRegion &region);
+    QRegion scaledDamage(const QSize &targetSize) const;
+    QRegion renderScaled(GLFramebuffer *target, const QRegion &bufferRepair);
+    QRegion renderScaled(QImage *target);
 
     std::optional<ScreenCastDmaBufTextureParams> testCreateDmaBuf(const QSize &size, quint32 format, const QList<uint64_t> &modifiers);
 
@@ -130,6 +146,7 @@ private:
     } m_cursor;
 
     quint64 m_sequential = 0;
+    ContentType m_contentType = ContentType::None;
     bool m_hasDmaBuf = false;
     quint32 m_drmFormat = 0;
 
@@ -140,6 +157,14 @@ private:
 
     QList<ScreenCastBuffer *> m_allBuffers;
     DamageJournal m_damageJournal;
+
+    // The frame at the size of the source, used when the stream is smaller
+    struct
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        QRegion damage;
+    } m_scaledFrame;
 };
 
 } // namespace KWin
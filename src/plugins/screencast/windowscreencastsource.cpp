@@ -9,7 +9,9 @@
 #include "screencastutils.h"
 
 #include "compositor.h"
+#include "cursor.h"
 #include "core/backendoutput.h"
+#include "core/colorpipeline.h"
 #include "core/renderloop.h"
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
@@ -18,8 +20,10 @@
 #include "opengl/glframebuffer.h"
 #include "opengl/gltexture.h"
 #include "scene/itemrenderer.h"
+#include "scene/surfaceitem.h"
 #include "scene/windowitem.h"
 #include "scene/workspacescene.h"
+#include "wayland/surface.h"
 #include "workspace.h"
 
 #include <drm_fourcc.h>
@@ -119,8 +123,85 @@ QRegion WindowScreenCastSource::render(QImage *target, const QRegion &bufferDama
     return QRect(QPoint(), target->size());
 }
 
+bool WindowScreenCastSource::blitSurface(GLFramebuffer *target)
+{
+    // Only a window that consists of one opaque surface which covers the frame exactly
+    // looks the same when its buffer is copied as is
+    if (m_windows.size() != 1) {
+        return false;
+    }
+    Window *window = m_windows.front();
+    WindowItem *windowItem = window->windowItem();
+    if (windowItem->decorationItem() || window->opacity() != 1.0 || window->bufferGeometry() != window->frameGeometry()) {
+        return false;
+    }
+    if (m_renderCursor && includesCursor(Cursors::self()->currentCursor())) {
+        return false;
+    }
+    SurfaceItem *surfaceItem = windowItem->surfaceItem();
+    if (!surfaceItem || !surfaceItem->childItems().isEmpty() || !surfaceItem->buffer()) {
+        return false;
+    }
+    if (surfaceItem->bufferTransform() != OutputTransform::Normal
+        || surfaceItem->bufferSize() != target->size()
+        || surfaceItem->bufferSourceBox() != QRectF(QPointF(0, 0), surfaceItem->bufferSize())) {
+        return false;
+    }
+    // the items may be translucent, e.g. while a window fades in
+    qreal opacity = 1.0;
+    for (Item *item = surfaceItem; item; item = item == windowItem ? nullptr : item->parentItem()) {
+        opacity *= item->opacity();
+    }
+    if (opacity != 1.0) {
+        return false;
+    }
+    // HDR, wide gamut and YUV contents have to be converted to the sRGB of the stream
+    if (surfaceItem->colorDescription()->yuvCoefficients() != YUVMatrixCoefficients::Identity) {
+        return false;
+    }
+    const auto conversion = ColorConversionCache::lookup(surfaceItem->colorDescription(), ColorDescription::sRGB, surfaceItem->renderingIntent());
+    if (!conversion->pipeline.isIdentity()) {
+        return false;
+    }
+
+    // the window may be hidden, in which case nobody else keeps the texture up to date
+    surfaceItem->preprocess();
+    auto surfaceTexture = static_cast<OpenGLSurfaceTexture *>(surfaceItem->texture());
+    if (!surfaceTexture || !surfaceTexture->isValid()) {
+        return false;
+    }
+    const OpenGLSurfaceContents contents = surfaceTexture->texture();
+    if (contents.planes.size() != 1) {
+        return false;
+    }
+    GLTexture *source = contents.planes.constFirst().get();
+    if (source->target() != GL_TEXTURE_2D) {
+        return false;
+    }
+    const OutputTransform sourceTransform = source->contentTransform();
+    const OutputTransform targetTransform = target->colorAttachment()->contentTransform();
+    if ((sourceTransform != OutputTransform::Normal && sourceTransform != OutputTransform::FlipY)
+        || (targetTransform != OutputTransform::Normal && targetTransform != OutputTransform::FlipY)) {
+        return false;
+    }
+
+    GLFramebuffer sourceFramebuffer(source);
+    if (!sourceFramebuffer.valid()) {
+        return false;
+    }
+    const QRect rect(QPoint(), target->size());
+    GLFramebuffer::pushFramebuffer(&sourceFramebuffer);
+    target->blitFromFramebuffer(rect, rect, GL_NEAREST, false, sourceTransform != targetTransform);
+    GLFramebuffer::popFramebuffer();
+    return true;
+}
+
 QRegion WindowScreenCastSource::render(GLFramebuffer *target, const QRegion &bufferDamage)
 {
+    if (blitSurface(target)) {
+        return QRect(QPoint(), target->size());
+    }
+
     RenderTarget renderTarget(target);
     RenderViewport viewport(boundingRect(), devicePixelRatio(), renderTarget);
 
@@ -198,6 +279,13 @@ QRectF WindowScreenCastSource::mapFromGlobal(const QRectF &rect) const
     return rect.translated(-boundingRect().topLeft());
 }
 
+ContentType WindowScreenCastSource::contentType() const
+{
+    // The main window is the one that has been asked for, popups come after it
+    const SurfaceInterface *surface = m_windows.isEmpty() ? nullptr : m_windows.front()->surface();
+    return surface ? surface->contentType() : ContentType::None;
+}
+
 QRectF WindowScreenCastSource::boundingRect() const
 {
     QRectF boundingRect;
@@ -41,10 +41,13 @@ public:
     QPointF mapFromGlobal(const QPointF &point) const override;
     QRectF mapFromGlobal(const QRectF &rect) const override;
 
+    ContentType contentType() const override;
+
 private:
     void add(Window *window);
     void watch(Window *window);
     void unwatch(Window *window);
+    bool blitSurface(GLFramebuffer *target);
     QRectF boundingRect() const;
 
     QList<Window *> m_windows;
@@ -28,10 +28,16 @@
 #include "scene/windowitem.h"
 #include "scene/workspacescene.h"
 #include "screenshotlayer.h"
+#include "screenshotlogging.h"
 #include "window.h"
 #include "workspace.h"
 
 #include <QPainter>
+#include <QPromise>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+#include <cstring>
 
 namespace KWin
 {
@@ -72,6 +78,193 @@ static void convertFromGLImage(QImage &img, int w, int h, const OutputTransform
     img = img.transformed(matrix.toTransform());
 }
 
+static QFuture<std::optional<QImage>> noScreenShot()
+{
+    return QtFuture::makeReadyValueFuture(std::optional<QImage>());
+}
+
+/**
+ * The ScreenShotReadback class reads a framebuffer back into a pixel pack buffer without
+ * waiting for the GPU. Once the fence that follows the copy is signalled, the buffer is
+ * mapped and converted into a QImage on a worker thread.
+ */
+class ScreenShotReadback : public QObject
+{
+public:
+    ScreenShotReadback(EglContext *context, qreal scale, QObject *parent);
+    ~ScreenShotReadback() override;
+
+    static bool isSupported(EglContext *context);
+
+    bool start(GLFramebuffer *source);
+    QFuture<std::optional<QImage>> future();
+
+private:
+    void poll();
+    void finish(const std::optional<QImage> &image);
+    void release();
+
+    EglContext *const m_context;
+    const qreal m_scale;
+    QSize m_size;
+    GLuint m_buffer = 0;
+    GLsync m_sync = nullptr;
+    const uchar *m_data = nullptr;
+    QTimer m_pollTimer;
+    QPromise<std::optional<QImage>> m_promise;
+    QFuture<QImage> m_conversion;
+};
+
+ScreenShotReadback::ScreenShotReadback(EglContext *context, qreal scale, QObject *parent)
+    : QObject(parent)
+    , m_context(context)
+    , m_scale(scale)
+{
+    // The fence is usually signalled within a frame or two, checking it is cheap
+    m_pollTimer.setInterval(1);
+    m_pollTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_pollTimer, &QTimer::timeout, this, &ScreenShotReadback::poll);
+}
+
+ScreenShotReadback::~ScreenShotReadback()
+{
+    m_conversion.waitForFinished();
+    release();
+}
+
+bool ScreenShotReadback::isSupported(EglContext *context)
+{
+    // Pixel pack buffers and glMapBufferRange() are not available in OpenGL ES 2.0
+    return context->haveSyncFences() && (!context->isOpenGLES() || context->hasVersion(Version(3, 0)));
+}
+
+bool ScreenShotReadback::start(GLFramebuffer *source)
+{
+    m_size = source->size();
+    const qsizetype size = qsizetype(m_size.width()) * m_size.height() * 4;
+
+    glGenBuffers(1, &m_buffer);
+    if (!m_buffer) {
+        return false;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+
+    GLFramebuffer::pushFramebuffer(source);
+    glReadPixels(0, 0, m_size.width(), m_size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLFramebuffer::popFramebuffer();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!m_sync) {
+        return false;
+    }
+    // Make sure the copy gets submitted, otherwise the fence may never be signalled
+    glFlush();
+
+    m_promise.start();
+    m_pollTimer.start();
+    return true;
+}
+
+QFuture<std::optional<QImage>> ScreenShotReadback::future()
+{
+    return m_promise.future();
+}
+
+void ScreenShotReadback::poll()
+{
+    if (!m_context->makeCurrent()) {
+        finish(std::nullopt);
+        return;
+    }
+
+    const GLenum status = glClientWaitSync(m_sync, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return;
+    }
+    m_pollTimer.stop();
+    if (status == GL_WAIT_FAILED) {
+        finish(std::nullopt);
+        return;
+    }
+
+    const qsizetype size = qsizetype(m_size.width()) * m_size.height() * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+    m_data = static_cast<const uchar *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!m_data) {
+        finish(std::nullopt);
+        return;
+    }
+
+    // The buffer stays mapped until the worker is done with it, rows are tightly packed
+    // with the default pack alignment because every pixel takes four bytes
+    m_conversion = QtConcurrent::run([data = m_data, size = m_size, scale = m_scale]() {
+        QImage image(size, QImage::Format_ARGB32_Premultiplied);
+        std::memcpy(image.bits(), data, image.sizeInBytes());
+        convertFromGLImage(image, image.width(), image.height(), OutputTransform::Normal);
+        image.setDevicePixelRatio(scale);
+        return image;
+    });
+    m_conversion.then(this, [this](const QImage &image) {
+        finish(image);
+    });
+}
+
+void ScreenShotReadback::finish(const std::optional<QImage> &image)
+{
+    release();
+    m_promise.addResult(image);
+    m_promise.finish();
+    deleteLater();
+}
+
+void ScreenShotReadback::release()
+{
+    if (!m_buffer && !m_sync) {
+        return;
+    }
+    if (!m_context->makeCurrent()) {
+        qCWarning(KWIN_SCREENSHOT) << "Could not release the screenshot readback buffer because the context is lost";
+        return;
+    }
+    if (m_data) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_data = nullptr;
+    }
+    if (m_sync) {
+        glDeleteSync(m_sync);
+        m_sync = nullptr;
+    }
+    if (m_buffer) {
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+}
+
+static QFuture<std::optional<QImage>> readBack(EglContext *context, GLFramebuffer *source, qreal scale, QObject *parent)
+{
+    if (ScreenShotReadback::isSupported(context)) {
+        auto readback = new ScreenShotReadback(context, scale, parent);
+        if (readback->start(source)) {
+            return readback->future();
+        }
+        delete readback;
+    }
+
+    GLFramebuffer::pushFramebuffer(source);
+    QImage snapshot = QImage(source->size(), QImage::Format_ARGB32_Premultiplied);
+    context->glReadnPixels(0, 0, snapshot.width(), snapshot.height(), GL_RGBA, GL_UNSIGNED_BYTE, snapshot.sizeInBytes(), static_cast<GLvoid *>(snapshot.bits()));
+    convertFromGLImage(snapshot, snapshot.width(), snapshot.height(), OutputTransform::Normal);
+    GLFramebuffer::popFramebuffer();
+
+    snapshot.setDevicePixelRatio(scale);
+    return QtFuture::makeReadyValueFuture(std::optional<QImage>(snapshot));
+}
+
 ScreenShotManager::ScreenShotManager()
     : m_dbusInterface2(new ScreenShotDBusInterface2(this))
 {
@@ -83,15 +276,15 @@ ScreenShotManager::~ScreenShotManager()
 
 // TODO share code with the screencast plugin?
 
-std::optional<QImage> ScreenShotManager::takeScreenShot(LogicalOutput *screen, ScreenShotFlags flags, std::optional<pid_t> pidToHide)
+QFuture<std::optional<QImage>> ScreenShotManager::takeScreenShot(LogicalOutput *screen, ScreenShotFlags flags, std::optional<pid_t> pidToHide)
 {
     const auto eglBackend = dynamic_cast<EglBackend *>(Compositor::self()->backend());
     if (!eglBackend) {
-        return std::nullopt;
+        return noScreenShot();
     }
     const auto context = eglBackend->openglContext();
     if (!context || !context->makeCurrent()) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
     qreal scale = 1.0;
@@ -102,22 +295,22 @@ std::optional<QImage> ScreenShotManager::takeScreenShot(LogicalOutput *screen, S
 
     const auto offscreenTexture = GLTexture::allocate(GL_RGBA8, nativeSize);
     if (!offscreenTexture) {
-        return std::nullopt;
+        return noScreenShot();
     }
     offscreenTexture->setFilter(GL_LINEAR);
     offscreenTexture->setWrapMode(GL_CLAMP_TO_EDGE);
     const auto target = std::make_unique<GLFramebuffer>(offscreenTexture.get());
     if (!target->valid()) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
     ScreenshotLayer layer(screen, target.get());
     if (!layer.preparePresentationTest()) {
-        return std::nullopt;
+        return noScreenShot();
     }
     const auto beginInfo = layer.beginFrame();
     if (!beginInfo) {
-        return std::nullopt;
+        return noScreenShot();
     }
     SceneView sceneView(Compositor::self()->scene(), screen, &layer);
     std::unique_ptr<ItemTreeView> cursorView;
@@ -137,28 +330,21 @@ std::optional<QImage> ScreenShotManager::takeScreenShot(LogicalOutput *screen, S
     sceneView.paint(beginInfo->renderTarget, fullDamage);
     sceneView.postPaint();
     if (!layer.endFrame(fullDamage, fullDamage, nullptr)) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
-    GLFramebuffer::pushFramebuffer(target.get());
-    QImage snapshot = QImage(offscreenTexture->size(), QImage::Format_ARGB32_Premultiplied);
-    context->glReadnPixels(0, 0, snapshot.width(), snapshot.height(), GL_RGBA, GL_UNSIGNED_BYTE, snapshot.sizeInBytes(), static_cast<GLvoid *>(snapshot.bits()));
-    convertFromGLImage(snapshot, snapshot.width(), snapshot.height(), OutputTransform::Normal);
-    GLFramebuffer::popFramebuffer();
-
-    snapshot.setDevicePixelRatio(scale);
-    return snapshot;
+    return readBack(context, target.get(), scale, this);
 }
 
-std::optional<QImage> ScreenShotManager::takeScreenShot(const QRect &area, ScreenShotFlags flags, std::optional<pid_t> pidToHide)
+QFuture<std::optional<QImage>> ScreenShotManager::takeScreenShot(const QRect &area, ScreenShotFlags flags, std::optional<pid_t> pidToHide)
 {
     const auto eglBackend = dynamic_cast<EglBackend *>(Compositor::self()->backend());
     if (!eglBackend) {
-        return std::nullopt;
+        return noScreenShot();
     }
     const auto context = eglBackend->openglContext();
     if (!context || !context->makeCurrent()) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
     qreal scale = 1.0;
@@ -172,22 +358,22 @@ std::optional<QImage> ScreenShotManager::takeScreenShot(const QRect &area, Scree
 
     const auto offscreenTexture = GLTexture::allocate(GL_RGBA8, nativeSize);
     if (!offscreenTexture) {
-        return std::nullopt;
+        return noScreenShot();
     }
     offscreenTexture->setFilter(GL_LINEAR);
     offscreenTexture->setWrapMode(GL_CLAMP_TO_EDGE);
     const auto target = std::make_unique<GLFramebuffer>(offscreenTexture.get());
     if (!target->valid()) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
     ScreenshotLayer layer(workspace()->outputs().front(), target.get());
     if (!layer.preparePresentationTest()) {
-        return std::nullopt;
+        return noScreenShot();
     }
     const auto beginInfo = layer.beginFrame();
     if (!beginInfo) {
-        return std::nullopt;
+        return noScreenShot();
     }
     SceneView sceneView(Compositor::self()->scene(), workspace()->outputs().front(), &layer);
     std::unique_ptr<ItemTreeView> cursorView;
@@ -207,28 +393,21 @@ std::optional<QImage> ScreenShotManager::takeScreenShot(const QRect &area, Scree
     sceneView.paint(beginInfo->renderTarget, fullDamage);
     sceneView.postPaint();
     if (!layer.endFrame(fullDamage, fullDamage, nullptr)) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
-    GLFramebuffer::pushFramebuffer(target.get());
-    QImage snapshot = QImage(offscreenTexture->size(), QImage::Format_ARGB32_Premultiplied);
-    context->glReadnPixels(0, 0, snapshot.width(), snapshot.height(), GL_RGBA, GL_UNSIGNED_BYTE, snapshot.sizeInBytes(), static_cast<GLvoid *>(snapshot.bits()));
-    convertFromGLImage(snapshot, snapshot.width(), snapshot.height(), OutputTransform::Normal);
-    GLFramebuffer::popFramebuffer();
-
-    snapshot.setDevicePixelRatio(scale);
-    return snapshot;
+    return readBack(context, target.get(), scale, this);
 }
 
-std::optional<QImage> ScreenShotManager::takeScreenShot(Window *window, ScreenShotFlags flags)
+QFuture<std::optional<QImage>> ScreenShotManager::takeScreenShot(Window *window, ScreenShotFlags flags)
 {
     const auto eglBackend = dynamic_cast<EglBackend *>(Compositor::self()->backend());
     if (!eglBackend) {
-        return std::nullopt;
+        return noScreenShot();
     }
     const auto context = eglBackend->openglContext();
     if (!context || !context->makeCurrent()) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
     const qreal scale = window->targetScale();
@@ -241,7 +420,7 @@ std::optional<QImage> ScreenShotManager::takeScreenShot(Window *window, ScreenSh
     const QSize nativeSize = (geometry.size() * scale).toSize();
     const auto offscreenTexture = GLTexture::allocate(GL_RGBA8, nativeSize);
     if (!offscreenTexture) {
-        return std::nullopt;
+        return noScreenShot();
     }
 
     GLFramebuffer offscreenTarget(offscreenTexture.get());
@@ -265,14 +444,7 @@ std::optional<QImage> ScreenShotManager::takeScreenShot(Window *window, ScreenSh
     }
     scene->renderer()->endFrame();
 
-    GLFramebuffer::pushFramebuffer(&offscreenTarget);
-    QImage snapshot = QImage(offscreenTexture->size(), QImage::Format_ARGB32_Premultiplied);
-    context->glReadnPixels(0, 0, snapshot.width(), snapshot.height(), GL_RGBA, GL_UNSIGNED_BYTE, snapshot.sizeInBytes(), static_cast<GLvoid *>(snapshot.bits()));
-    convertFromGLImage(snapshot, snapshot.width(), snapshot.height(), OutputTransform::Normal);
-    GLFramebuffer::popFramebuffer();
-
-    snapshot.setDevicePixelRatio(scale);
-    return snapshot;
+    return readBack(context, &offscreenTarget, scale, this);
 }
 
 } // namespace KWin
@@ -12,6 +12,9 @@
 
 #include "plugin.h"
 
+#include <QFuture>
+#include <QImage>
+
 namespace KWin
 {
 
@@ -33,6 +36,10 @@ class Window;
 /**
  * The ScreenShotManager provides a convenient way to capture the contents of a given window,
  * screen or an area in the global coordinates.
+ *
+ * The contents are painted right away, but read back asynchronously if the driver allows
+ * it, so that large screenshots don't stall the compositor. The returned futures finish on
+ * the main thread.
  */
 class ScreenShotManager : public Plugin
 {
@@ -40,9 +47,9 @@ public:
     ScreenShotManager();
     ~ScreenShotManager() override;
 
-    std::optional<QImage> takeScreenShot(LogicalOutput *screen, ScreenShotFlags flags, std::optional<pid_t> pidToHide);
-    std::optional<QImage> takeScreenShot(const QRect &area, ScreenShotFlags flags, std::optional<pid_t> pidToHide);
-    std::optional<QImage> takeScreenShot(Window *window, ScreenShotFlags flags = {});
+    QFuture<std::optional<QImage>> takeScreenShot(LogicalOutput *screen, ScreenShotFlags flags, std::optional<pid_t> pidToHide);
+    QFuture<std::optional<QImage>> takeScreenShot(const QRect &area, ScreenShotFlags flags, std::optional<pid_t> pidToHide);
+    QFuture<std::optional<QImage>> takeScreenShot(Window *window, ScreenShotFlags flags = {});
 
 private:
     std::unique_ptr<ScreenShotDBusInterface2> m_dbusInterface2;
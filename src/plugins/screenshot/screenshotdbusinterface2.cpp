@@ -457,41 +457,40 @@ QVariantMap ScreenShotDBusInterface2::CaptureWorkspace(const QVariantMap &option
     return QVariantMap();
 }
 
+static void deliverScreenShot(QObject *context, QFuture<std::optional<QImage>> future, ScreenShotSinkPipe2 *sink, const QVariantMap &attributes)
+{
+    future.then(context, [sink, attributes](const std::optional<QImage> &result) {
+        if (result) {
+            sink->flush(*result, attributes);
+        } else {
+            sink->cancel();
+        }
+        sink->deleteLater();
+    });
+}
+
 void ScreenShotDBusInterface2::takeScreenShot(LogicalOutput *screen, ScreenShotFlags flags,
                                               ScreenShotSinkPipe2 *sink, std::optional<pid_t> pid)
 {
-    if (const auto result = m_effect->takeScreenShot(screen, flags, pid)) {
-        sink->flush(*result, QVariantMap{
-                                 {QStringLiteral("screen"), screen->name()},
-                             });
-    } else {
-        sink->cancel();
-    }
-    sink->deleteLater();
+    const QVariantMap attributes{
+        {QStringLiteral("screen"), screen->name()},
+    };
+    deliverScreenShot(this, m_effect->takeScreenShot(screen, flags, pid), sink, attributes);
 }
 
 void ScreenShotDBusInterface2::takeScreenShot(const QRect &area, ScreenShotFlags flags,
                                               ScreenShotSinkPipe2 *sink, std::optional<pid_t> pid)
 {
-    if (const auto result = m_effect->takeScreenShot(area, flags, pid)) {
-        sink->flush(*result, {});
-    } else {
-        sink->cancel();
-    }
-    sink->deleteLater();
+    deliverScreenShot(this, m_effect->takeScreenShot(area, flags, pid), sink, {});
 }
 
 void ScreenShotDBusInterface2::takeScreenShot(Window *window, ScreenShotFlags flags,
                                               ScreenShotSinkPipe2 *sink)
 {
-    if (const auto result = m_effect->takeScreenShot(window, flags)) {
-        sink->flush(*result, QVariantMap{
-                                 {QStringLiteral("windowId"), window->internalId().toString()},
-                             });
-    } else {
-        sink->cancel();
-    }
-    sink->deleteLater();
+    const QVariantMap attributes{
+        {QStringLiteral("windowId"), window->internalId().toString()},
+    };
+    deliverScreenShot(this, m_effect->takeScreenShot(window, flags), sink, attributes);
 }
 
 } // namespace KWin
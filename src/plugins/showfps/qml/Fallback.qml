@@ -21,6 +21,18 @@ Rectangle {
             text: root.effect.fps + "/" + root.effect.maximumFps
         }
 
+        Text {
+            Layout.fillWidth: true
+            visible: root.effect.frameStages.length > 0
+            text: root.effect.frameStages.join("\n")
+        }
+
+        Text {
+            Layout.fillWidth: true
+            visible: root.effect.gpuPasses.length > 0
+            text: root.effect.gpuPasses.join("\n")
+        }
+
         Text {
             Layout.fillWidth: true
             text: i18nc("@label", "This effect is not a benchmark")
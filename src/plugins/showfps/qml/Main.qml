@@ -187,6 +187,20 @@ Rectangle {
             }
         }
 
+        Label {
+            Layout.fillWidth: true
+            visible: root.effect.frameStages.length > 0
+            text: root.effect.frameStages.join("\n")
+            font: Kirigami.Theme.smallFont
+        }
+
+        Label {
+            Layout.fillWidth: true
+            visible: root.effect.gpuPasses.length > 0
+            text: root.effect.gpuPasses.join("\n")
+            font: Kirigami.Theme.smallFont
+        }
+
         Label {
             Layout.fillWidth: true
             text: i18nc("@label", "This effect is not a benchmark")
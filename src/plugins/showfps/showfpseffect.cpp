@@ -7,20 +7,49 @@
 */
 
 #include "showfpseffect.h"
+#include "core/backendoutput.h"
 #include "core/output.h"
+#include "core/renderjournal.h"
+#include "core/renderloop.h"
 #include "core/renderviewport.h"
 #include "effect/effecthandler.h"
+#include "opengl/eglcontext.h"
+#include "opengl/glpassprofiler.h"
+#include "wayland/surface.h"
+
+#include <KLocalizedString>
 
 #include <QQmlContext>
 
+#include <ranges>
+
 namespace KWin
 {
 
+// The number of passes that are shown, the ones that take the most time come first
+static const int s_maxGpuPasses = 6;
+
+static QString formatMilliseconds(std::chrono::nanoseconds duration)
+{
+    return QString::number(std::chrono::duration<double, std::milli>(duration).count(), 'f', 2);
+}
+
 ShowFpsEffect::ShowFpsEffect()
 {
+    if (EglContext *context = effects->openglContext()) {
+        m_profiler = context->passProfiler();
+    }
+    if (m_profiler) {
+        m_profiler->ref();
+    }
 }
 
-ShowFpsEffect::~ShowFpsEffect() = default;
+ShowFpsEffect::~ShowFpsEffect()
+{
+    if (m_profiler) {
+        m_profiler->unref();
+    }
+}
 
 int ShowFpsEffect::fps() const
 {
@@ -48,6 +77,16 @@ QColor ShowFpsEffect::paintColor() const
     return QColor::fromHsvF(0.3 - (0.3 * normalizedDuration), 1.0, 1.0);
 }
 
+QStringList ShowFpsEffect::gpuPasses() const
+{
+    return m_gpuPasses;
+}
+
+QStringList ShowFpsEffect::frameStages() const
+{
+    return m_frameStages;
+}
+
 void ShowFpsEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
 {
     effects->prePaintScreen(data, presentTime);
@@ -82,21 +121,99 @@ void ShowFpsEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::millis
 
 void ShowFpsEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen)
 {
+    const auto paintStart = std::chrono::steady_clock::now();
     effects->paintScreen(renderTarget, viewport, mask, deviceRegion, screen);
+    const auto now = std::chrono::steady_clock::now();
+
+    // The breakdown is shown for the active screen only, so that the overlay stays the same on
+    // all screens and has to be rendered again only when the numbers are updated
+    LogicalOutput *activeScreen = effects->activeScreen();
+    if (screen == activeScreen) {
+        const auto sceneTime = effects->scenePaintDuration();
+        m_sceneTime += sceneTime;
+        m_effectsTime += std::max(now - paintStart - sceneTime, std::chrono::nanoseconds::zero());
+        m_stageFrames++;
+    }
 
-    auto now = std::chrono::steady_clock::now();
     if ((now - m_lastFpsTime) >= std::chrono::milliseconds(1000)) {
         m_fps = m_newFps;
         m_newFps = 0;
         m_lastFpsTime = now;
         Q_EMIT fpsChanged();
+
+        if (activeScreen) {
+            updateGpuPasses(activeScreen);
+            updateFrameStages(activeScreen);
+        }
     }
 
     const auto rect = viewport.renderRect();
-    m_scene->setGeometry(QRect(rect.x() + rect.width() - 300, rect.y(), 300, 150));
+    const int height = 150 + (m_gpuPasses.isEmpty() ? 0 : 100) + (m_frameStages.isEmpty() ? 0 : 130);
+    m_scene->setGeometry(QRect(rect.x() + rect.width() - 300, rect.y(), 300, height));
     effects->renderOffscreenQuickView(renderTarget, viewport, m_scene.get());
 }
 
+void ShowFpsEffect::updateGpuPasses(LogicalOutput *screen)
+{
+    if (!m_profiler) {
+        return;
+    }
+    QList<GLPassProfiler::Pass> passes = m_profiler->passes(screen->name());
+    std::ranges::sort(passes, [](const GLPassProfiler::Pass &a, const GLPassProfiler::Pass &b) {
+        return a.duration > b.duration;
+    });
+    QStringList gpuPasses;
+    for (const GLPassProfiler::Pass &pass : std::as_const(passes) | std::views::take(s_maxGpuPasses)) {
+        gpuPasses.append(i18nc("@label name of a rendering pass and the time it took on the GPU", "%1: %2 ms", pass.name, formatMilliseconds(pass.duration)));
+    }
+    if (gpuPasses != m_gpuPasses) {
+        m_gpuPasses = gpuPasses;
+        Q_EMIT gpuPassesChanged();
+    }
+}
+
+void ShowFpsEffect::updateFrameStages(LogicalOutput *screen)
+{
+    QStringList frameStages;
+    if (m_stageFrames) {
+        frameStages.append(i18nc("@label average CPU time", "Scene: %1 ms", formatMilliseconds(m_sceneTime / m_stageFrames)));
+        frameStages.append(i18nc("@label average CPU time", "Effects: %1 ms", formatMilliseconds(m_effectsTime / m_stageFrames)));
+    }
+    m_sceneTime = std::chrono::nanoseconds::zero();
+    m_effectsTime = std::chrono::nanoseconds::zero();
+    m_stageFrames = 0;
+
+    const FrameTimingJournal::Histograms histograms = screen->backendOutput()->renderLoop()->frameTimings().histograms();
+    const auto addPercentiles = [&frameStages](const QString &label, const FrameTimingHistogram &histogram) {
+        if (histogram.count()) {
+            frameStages.append(i18nc("@label name of a frame stage and the median and 99th percentile of its duration", "%1: %2 / %3 ms",
+                                     label, formatMilliseconds(histogram.percentile(50)), formatMilliseconds(histogram.percentile(99))));
+        }
+    };
+    addPercentiles(i18nc("@label", "Render"), histograms.renderTime);
+    addPercentiles(i18nc("@label", "GPU"), histograms.gpuTime);
+    addPercentiles(i18nc("@label time between the end of rendering and the commit", "Commit"), histograms.commitLatency);
+    addPercentiles(i18nc("@label delay of the presentation relative to the target", "Presentation"), histograms.presentationDelay);
+    if (histograms.missedFrames) {
+        frameStages.append(i18nc("@label", "Missed frames: %1", histograms.missedFrames));
+    }
+
+    if (EffectWindow *window = effects->activeWindow()) {
+        if (SurfaceInterface *surface = window->surface()) {
+            const PresentationStatistics &statistics = surface->presentationStatistics();
+            if (statistics.presented) {
+                frameStages.append(i18nc("@label median and 99th percentile of the time between a commit of the focused window and its presentation", "%1: %2 / %3 ms",
+                                         window->windowClass(), formatMilliseconds(statistics.latency(50)), formatMilliseconds(statistics.latency(99))));
+            }
+        }
+    }
+
+    if (frameStages != m_frameStages) {
+        m_frameStages = frameStages;
+        Q_EMIT frameStagesChanged();
+    }
+}
+
 void ShowFpsEffect::paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
 {
     effects->paintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
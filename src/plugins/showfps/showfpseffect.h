@@ -16,6 +16,8 @@
 namespace KWin
 {
 
+class GLPassProfiler;
+
 class ShowFpsEffect : public Effect
 {
     Q_OBJECT
@@ -24,6 +26,8 @@ class ShowFpsEffect : public Effect
     Q_PROPERTY(int paintDuration READ paintDuration NOTIFY paintChanged)
     Q_PROPERTY(int paintAmount READ paintAmount NOTIFY paintChanged)
     Q_PROPERTY(QColor paintColor READ paintColor NOTIFY paintChanged)
+    Q_PROPERTY(QStringList gpuPasses READ gpuPasses NOTIFY gpuPassesChanged)
+    Q_PROPERTY(QStringList frameStages READ frameStages NOTIFY frameStagesChanged)
 
 public:
     ShowFpsEffect();
@@ -34,6 +38,8 @@ public:
     int paintDuration() const;
     int paintAmount() const;
     QColor paintColor() const;
+    QStringList gpuPasses() const;
+    QStringList frameStages() const;
 
     void prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
     void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen) override;
@@ -46,8 +52,13 @@ Q_SIGNALS:
     void fpsChanged();
     void maximumFpsChanged();
     void paintChanged();
+    void gpuPassesChanged();
+    void frameStagesChanged();
 
 private:
+    void updateGpuPasses(LogicalOutput *screen);
+    void updateFrameStages(LogicalOutput *screen);
+
     std::unique_ptr<OffscreenQuickScene> m_scene;
 
     uint32_t m_maximumFps = 0;
@@ -59,6 +70,15 @@ private:
     int m_paintDuration = 0;
     int m_paintAmount = 0;
     QElapsedTimer m_paintDurationTimer;
+
+    GLPassProfiler *m_profiler = nullptr;
+    QStringList m_gpuPasses;
+
+    // the CPU time of the frames painted on the active screen since the stages were updated
+    std::chrono::nanoseconds m_sceneTime = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds m_effectsTime = std::chrono::nanoseconds::zero();
+    int m_stageFrames = 0;
+    QStringList m_frameStages;
 };
 
 } // namespace KWin
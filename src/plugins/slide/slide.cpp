@@ -130,9 +130,9 @@ void SlideEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::millisec
     // Clipping
     m_paintCtx.visibleDesktops.clear();
     m_paintCtx.visibleDesktops.reserve(4); // 4 - maximum number of visible desktops
-    bool includedX = false, includedY = false;
     for (VirtualDesktop *desktop : desktops) {
         const QPoint coords = effects->desktopGridCoords(desktop);
+        bool includedX = false, includedY = false;
         if (coords.x() % w == (int)(m_paintCtx.position.x()) % w) {
             includedX = true;
         } else if (coords.x() % w == ((int)(m_paintCtx.position.x()) + 1) % w) {
@@ -248,11 +248,18 @@ void SlideEffect::paintWindow(const RenderTarget &renderTarget, const RenderView
 
         for (LogicalOutput *screen : screens) {
             QPoint drawTranslation = getDrawCoords(desktopTranslation, screen);
-            data += drawTranslation;
-
             const QRect screenArea = screen->geometry();
             const QRect logicalDamage = screenArea.translated(drawTranslation).intersected(screenArea);
 
+            // Most windows of a desktop that slides in or out are off this screen, skip them
+            // rather than going through the whole window paint just to paint nothing.
+            const QRectF windowGeometry = w->expandedGeometry().translated(QPointF(drawTranslation) + QPointF(data.xTranslation(), data.yTranslation()));
+            if (logicalDamage.isEmpty() || (data.xScale() == 1 && data.yScale() == 1 && !windowGeometry.intersects(logicalDamage))) {
+                continue;
+            }
+
+            data += drawTranslation;
+
             effects->paintWindow(
                 renderTarget, viewport, w, mask,
                 // Only paint the region that intersects the current screen and desktop.
@@ -271,6 +278,11 @@ void SlideEffect::postPaintScreen()
         finishedSwitching();
     }
 
+    // The whole desktop grid moves, so every output is repainted in full each frame. Window
+    // contents are not rendered again though, the scene only updates the texture of a surface
+    // when it gets damaged. Snapshotting desktops that are only passed by would swap those
+    // texture draws for an offscreen pass per desktop and output, and freeze the windows that
+    // keep updating during the slide.
     effects->addRepaintFull();
     effects->postPaintScreen();
 }
@@ -148,8 +148,12 @@ void StartupFeedbackEffect::reconfigure(Effect::ReconfigureFlags flags)
 #if KWIN_BUILD_X11
     m_startupInfo->setTimeout(m_timeout.count());
 #endif
-    const bool busyBlinking = c.readEntry("Blinking", false);
-    const bool busyBouncing = c.readEntry("Bouncing", true);
+    // the animated styles repaint every frame while an application starts, which is
+    // when the cpu has the least time to spare for software rendering
+    const auto context = effects->openglContext();
+    const bool animate = context && !context->isSoftwareRenderer();
+    const bool busyBlinking = animate && c.readEntry("Blinking", false);
+    const bool busyBouncing = animate && c.readEntry("Bouncing", true);
     if (!busyCursor) {
         m_type = NoFeedback;
     } else if (busyBouncing) {
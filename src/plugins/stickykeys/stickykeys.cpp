@@ -31,7 +31,7 @@ static const std::array<Modifier, 5> modifiers = {
 };
 
 StickyKeysFilter::StickyKeysFilter()
-    : KWin::InputEventFilter(KWin::InputFilterOrder::StickyKeys)
+    : KWin::InputEventFilter(KWin::InputFilterOrder::StickyKeys, KWin::InputEventKind::Pointer | KWin::InputEventKind::Keyboard)
     , m_configWatcher(KConfigWatcher::create(KSharedConfig::openConfig("kaccessrc")))
 {
     const QLatin1String groupName("Keyboard");
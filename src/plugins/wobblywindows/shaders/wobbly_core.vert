@@ -0,0 +1,34 @@
+#version 140
+
+uniform mat4 modelViewProjectionMatrix;
+// the 4x4 control points of the bezier surface in the coordinates of the vertices
+uniform vec2 controlPoints[16];
+uniform vec2 frameSize;
+
+in vec2 position;
+in vec2 texcoord;
+
+out vec2 texcoord0;
+
+vec4 bernstein(float t)
+{
+    float s = 1.0 - t;
+    return vec4(s * s * s, 3.0 * s * s * t, 3.0 * s * t * t, t * t * t);
+}
+
+void main()
+{
+    vec2 uv = position / frameSize;
+    vec4 px = bernstein(uv.x);
+    vec4 py = bernstein(uv.y);
+
+    vec2 deformed = vec2(0.0);
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < 4; ++i) {
+            deformed += px[i] * py[j] * controlPoints[i + j * 4];
+        }
+    }
+
+    gl_Position = modelViewProjectionMatrix * vec4(deformed, 0.0, 1.0);
+    texcoord0 = texcoord;
+}
@@ -8,9 +8,12 @@
 */
 
 #include "wobblywindows.h"
+#include "core/renderviewport.h"
 #include "effect/effecthandler.h"
+#include "opengl/glutils.h"
 #include "wobblywindowsconfig.h"
 
+#include <array>
 #include <cmath>
 
 //#define COMPUTE_STATS
@@ -120,6 +123,12 @@ static const ParameterSet set_4 = {
 
 static const ParameterSet pset[5] = {set_0, set_1, set_2, set_3, set_4};
 
+static void ensureResources()
+{
+    // Must initialize resources manually because the effect is a static lib.
+    Q_INIT_RESOURCE(wobblywindows);
+}
+
 WobblyWindowsEffect::WobblyWindowsEffect()
 {
     WobblyWindowsConfig::instance(effects->config());
@@ -254,11 +263,37 @@ void WobblyWindowsEffect::prePaintWindow(RenderView *view, EffectWindow *w, Wind
     effects->prePaintWindow(view, w, data, presentTime);
 }
 
+GLShader *WobblyWindowsEffect::ensureShader()
+{
+    if (!m_shader && !m_shaderFailed) {
+        ensureResources();
+        m_shader = ShaderManager::instance()->generateShaderFromFile(ShaderTrait::MapTexture | ShaderTrait::Modulate | ShaderTrait::AdjustSaturation | ShaderTrait::TransformColorspace,
+                                                                     QStringLiteral(":/effects/wobblywindows/shaders/wobbly.vert"));
+        if (!m_shader->isValid()) {
+            qCWarning(KWIN_WOBBLYWINDOWS) << "Failed to compile the wobbly windows shader, deforming windows on the CPU";
+            m_shader.reset();
+            m_shaderFailed = true;
+        } else {
+            m_controlPointsLocation = m_shader->uniformLocation("controlPoints");
+            m_frameSizeLocation = m_shader->uniformLocation("frameSize");
+        }
+    }
+    return m_shader.get();
+}
+
+void WobblyWindowsEffect::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
+{
+    // the vertices are in device coordinates by the time they reach the shader
+    m_deviceScale = viewport.scale();
+    OffscreenEffect::drawWindow(renderTarget, viewport, w, mask, deviceRegion, data);
+}
+
 void WobblyWindowsEffect::apply(EffectWindow *w, int mask, WindowPaintData &data, WindowQuadList &quads)
 {
     if (windows.contains(w)) {
         WindowWobblyInfos &wwi = windows[w];
         if (!wwi.wobblying) {
+            setShader(w, nullptr);
             return;
         }
 
@@ -266,23 +301,61 @@ void WobblyWindowsEffect::apply(EffectWindow *w, int mask, WindowPaintData &data
         int ty = w->frameGeometry().y();
         int width = w->frameGeometry().width();
         int height = w->frameGeometry().height();
+        // a coarser grid is good enough while frames miss their budget
+        const int xTesselation = std::max(4, int(m_xTesselation * effects->renderQuality()));
+        const int yTesselation = std::max(4, int(m_yTesselation * effects->renderQuality()));
         double left = 0.0;
         double top = 0.0;
         double right = w->width();
         double bottom = w->height();
 
-        quads = quads.makeRegularGrid(m_xTesselation, m_yTesselation);
-        for (int i = 0; i < quads.count(); ++i) {
-            for (int j = 0; j < 4; ++j) {
-                WindowVertex &v = quads[i][j];
-                Pair uv = {v.x() / width, v.y() / height};
-                Pair newPos = computeBezierPoint(wwi, uv);
-                v.move(newPos.x - tx, newPos.y - ty);
+        if (GLShader *shader = ensureShader()) {
+            // The physics only move the 16 control points, let the shader evaluate the surface
+            // for every vertex. The bounds of the deformed window are estimated from a few
+            // samples instead.
+            const QRectF bounds = quads.front().bounds();
+            quads = quads.makeRegularGrid(xTesselation, yTesselation);
+
+            std::array<float, 2 * 16> controlPoints;
+            for (unsigned int i = 0; i < wwi.count; ++i) {
+                controlPoints[2 * i] = (wwi.position[i].x - tx) * m_deviceScale;
+                controlPoints[2 * i + 1] = (wwi.position[i].y - ty) * m_deviceScale;
+            }
+            setShader(w, shader);
+            ShaderBinder binder(shader);
+            glUniform2fv(m_controlPointsLocation, 16, controlPoints.data());
+            shader->setUniform(m_frameSizeLocation, QVector2D(width, height) * m_deviceScale);
+
+            constexpr int samples = 8;
+            for (int j = 0; j <= samples; ++j) {
+                for (int i = 0; i <= samples; ++i) {
+                    const QPointF position(bounds.left() + bounds.width() * i / samples, bounds.top() + bounds.height() * j / samples);
+                    const Pair deformed = computeBezierPoint(wwi, Pair{position.x() / width, position.y() / height});
+                    left = std::min(left, deformed.x - tx);
+                    top = std::min(top, deformed.y - ty);
+                    right = std::max(right, deformed.x - tx);
+                    bottom = std::max(bottom, deformed.y - ty);
+                }
+            }
+            // the samples may miss the outermost parts of the surface by a little
+            left -= 2.0;
+            top -= 2.0;
+            right += 2.0;
+            bottom += 2.0;
+        } else {
+            quads = quads.makeRegularGrid(xTesselation, yTesselation);
+            for (int i = 0; i < quads.count(); ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    WindowVertex &v = quads[i][j];
+                    Pair uv = {v.x() / width, v.y() / height};
+                    Pair newPos = computeBezierPoint(wwi, uv);
+                    v.move(newPos.x - tx, newPos.y - ty);
+                }
+                left = std::min(left, quads[i].left());
+                top = std::min(top, quads[i].top());
+                right = std::max(right, quads[i].right());
+                bottom = std::max(bottom, quads[i].bottom());
             }
-            left = std::min(left, quads[i].left());
-            top = std::min(top, quads[i].top());
-            right = std::max(right, quads[i].right());
-            bottom = std::max(bottom, quads[i].bottom());
         }
         QRectF dirtyRect(
             left * data.xScale() + w->x() + data.xTranslation(),
@@ -15,6 +15,7 @@
 namespace KWin
 {
 
+class GLShader;
 struct ParameterSet;
 
 /**
@@ -89,6 +90,7 @@ public:
     bool isResizeWobble() const;
 
 protected:
+    void drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data) override;
     void apply(EffectWindow *w, int mask, WindowPaintData &data, WindowQuadList &quads) override;
 
 public Q_SLOTS:
@@ -158,7 +160,15 @@ private:
     bool m_moveWobble;
     bool m_resizeWobble;
 
+    // the surface is deformed by a vertex shader, which only needs the control points
+    std::unique_ptr<GLShader> m_shader;
+    bool m_shaderFailed = false;
+    int m_controlPointsLocation = -1;
+    int m_frameSizeLocation = -1;
+    qreal m_deviceScale = 1.0;
+
     void initWobblyInfo(WindowWobblyInfos &wwi, QRectF geometry) const;
+    GLShader *ensureShader();
 
     WobblyWindowsEffect::Pair computeBezierPoint(const WindowWobblyInfos &wwi, Pair point) const;
 
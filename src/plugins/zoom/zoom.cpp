@@ -14,6 +14,8 @@
 #include "core/renderviewport.h"
 #include "effect/effecthandler.h"
 #include "opengl/glutils.h"
+#include "scene/item.h"
+#include "scene/workspacescene.h"
 #include "utils/keys.h"
 #include "zoomconfig.h"
 
@@ -139,6 +141,7 @@ ZoomEffect::~ZoomEffect()
 {
     // switch off and free resources
     showCursor();
+    resetCursorTransform();
     // Save the zoom value.
     saveInitialZoom();
 }
@@ -194,6 +197,30 @@ void ZoomEffect::showCursor()
     }
 }
 
+void ZoomEffect::updateCursorTransform(const QPointF &translation)
+{
+    // On Wayland, the cursor stays in the scene and is moved to where it is on the zoomed in
+    // desktop, so that it can still be shown on the cursor plane and moving it doesn't need
+    // the scene to be composited again. The cursor plane keeps the scaled image until the zoom
+    // level or the cursor changes.
+    const QPointF position = effects->cursorPos();
+    const QPointF offset = position * (m_zoom - 1.0) + translation;
+    QTransform transform;
+    if (m_mousePointer == MousePointerScale) {
+        transform.scale(m_zoom, m_zoom);
+    }
+    effects->scene()->cursorItem()->setTransform(transform * QTransform::fromTranslate(offset.x(), offset.y()));
+    m_isCursorTransformed = true;
+}
+
+void ZoomEffect::resetCursorTransform()
+{
+    if (m_isCursorTransformed) {
+        effects->scene()->cursorItem()->setTransform(QTransform());
+        m_isCursorTransformed = false;
+    }
+}
+
 void ZoomEffect::hideCursor()
 {
     if (m_mouseTracking == MouseTrackingProportional && m_mousePointer == MousePointerKeep) {
@@ -257,24 +284,54 @@ void ZoomEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseco
 
     if (m_zoom == 1.0) {
         showCursor();
+        resetCursorTransform();
+    } else if (effects->waylandDisplay() && m_mousePointer != MousePointerHide) {
+        showCursor();
     } else {
+        resetCursorTransform();
         hideCursor();
     }
 
     effects->prePaintScreen(data, presentTime);
 }
 
-ZoomEffect::OffscreenData *ZoomEffect::ensureOffscreenData(const RenderTarget &renderTarget, const RenderViewport &viewport, LogicalOutput *screen)
+/**
+ * Returns the part of @a renderRect that shows up on any screen once the scene is scaled by
+ * @a zoom and moved by @a translation.
+ */
+static QRectF visibleSourceRect(const QRectF &renderRect, const QPointF &translation, qreal zoom)
 {
-    const QSize nativeSize = renderTarget.size();
+    QRectF ret;
+    const auto screens = effects->screens();
+    for (LogicalOutput *screen : screens) {
+        const QRectF geometry = screen->geometry();
+        ret |= QRectF((geometry.topLeft() - translation) / zoom, geometry.size() / zoom) & renderRect;
+    }
+    return ret;
+}
 
+ZoomEffect::OffscreenData *ZoomEffect::ensureOffscreenData(const RenderTarget &renderTarget, const RenderViewport &viewport, LogicalOutput *screen, const QRectF &sourceRect)
+{
     OffscreenData &data = m_offscreenData[effects->waylandDisplay() ? screen : nullptr];
-    data.viewport = viewport.renderRect();
+    if (sourceRect.isEmpty()) {
+        data.framebuffer.reset();
+        data.texture.reset();
+        return nullptr;
+    }
+
+    // The size is rounded up so that the texture isn't reallocated on every frame while the
+    // zoom level is animating, the scene is painted a bit past the source rect instead
+    const qreal scale = viewport.scale();
+    const QRect deviceRect = scaledRect(sourceRect, scale).toAlignedRect();
+    const QSize deviceSize((deviceRect.width() + 127) & ~127, (deviceRect.height() + 127) & ~127);
+    const QSize textureSize = renderTarget.transform().map(deviceSize);
+    data.viewport = QRectF(QPointF(deviceRect.topLeft()) / scale, QSizeF(deviceSize) / scale);
     data.color = renderTarget.colorDescription();
 
     const GLenum textureFormat = renderTarget.colorDescription() == *ColorDescription::sRGB ? GL_RGBA8 : GL_RGBA16F;
-    if (!data.texture || data.texture->size() != nativeSize || data.texture->internalFormat() != textureFormat) {
-        data.texture = GLTexture::allocate(textureFormat, nativeSize);
+    if (!data.texture || data.texture->size() != textureSize || data.texture->internalFormat() != textureFormat) {
+        data.framebuffer.reset();
+        data.texture = GLTexture::allocate(textureFormat, textureSize);
         if (!data.texture) {
             return nullptr;
         }
@@ -299,20 +356,8 @@ GLShader *ZoomEffect::shaderForZoom(double zoom)
     }
 }
 
-void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &deviceRegion, LogicalOutput *screen)
+void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &, LogicalOutput *screen)
 {
-    OffscreenData *offscreenData = ensureOffscreenData(renderTarget, viewport, screen);
-    if (!offscreenData) {
-        return;
-    }
-
-    // Render the scene in an offscreen texture and then upscale it.
-    RenderTarget offscreenRenderTarget(offscreenData->framebuffer.get(), renderTarget.colorDescription());
-    RenderViewport offscreenViewport(viewport.renderRect(), viewport.scale(), offscreenRenderTarget);
-    GLFramebuffer::pushFramebuffer(offscreenData->framebuffer.get());
-    effects->paintScreen(offscreenRenderTarget, offscreenViewport, mask, deviceRegion, screen);
-    GLFramebuffer::popFramebuffer();
-
     const QSize screenSize = effects->virtualScreenSize();
     const auto scale = viewport.scale();
 
@@ -393,6 +438,21 @@ void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewp
         }
     }
 
+    if (m_zoom != 1.0 && effects->waylandDisplay() && m_mousePointer != MousePointerHide) {
+        updateCursorTransform(QPointF(xTranslation, yTranslation));
+    }
+
+    // Render the part of the scene that is visible once zoomed in to an offscreen texture at
+    // native resolution, and then upscale it.
+    const QRectF sourceRect = visibleSourceRect(viewport.renderRect(), QPointF(xTranslation, yTranslation), m_zoom);
+    if (OffscreenData *offscreenData = ensureOffscreenData(renderTarget, viewport, screen, sourceRect)) {
+        RenderTarget offscreenRenderTarget(offscreenData->framebuffer.get(), renderTarget.colorDescription());
+        RenderViewport offscreenViewport(offscreenData->viewport, viewport.scale(), offscreenRenderTarget);
+        GLFramebuffer::pushFramebuffer(offscreenData->framebuffer.get());
+        effects->paintScreen(offscreenRenderTarget, offscreenViewport, mask, infiniteRegion(), screen);
+        GLFramebuffer::popFramebuffer();
+    }
+
     // Render transformed offscreen texture.
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -400,6 +460,9 @@ void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewp
     GLShader *shader = shaderForZoom(m_zoom);
     ShaderManager::instance()->pushShader(shader);
     for (auto &[screen, offscreen] : m_offscreenData) {
+        if (!offscreen.texture) {
+            continue;
+        }
         QMatrix4x4 matrix;
         matrix.translate(xTranslation * scale, yTranslation * scale);
         matrix.scale(m_zoom, m_zoom);
@@ -414,7 +477,7 @@ void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewp
     }
     ShaderManager::instance()->popShader();
 
-    if (m_mousePointer != MousePointerHide) {
+    if (m_isMouseHidden && m_mousePointer != MousePointerHide) {
         // Draw the mouse-texture at the position matching to zoomed-in image of the desktop. Hiding the
         // previous mouse-cursor and drawing our own fake mouse-cursor is needed to be able to scale the
         // mouse-cursor up and to re-position those mouse-cursor to match to the chosen zoom-level.
@@ -111,8 +111,10 @@ private:
 
     void showCursor();
     void hideCursor();
+    void updateCursorTransform(const QPointF &translation);
+    void resetCursorTransform();
     GLTexture *ensureCursorTexture();
-    OffscreenData *ensureOffscreenData(const RenderTarget &renderTarget, const RenderViewport &viewport, LogicalOutput *screen);
+    OffscreenData *ensureOffscreenData(const RenderTarget &renderTarget, const RenderViewport &viewport, LogicalOutput *screen, const QRectF &sourceRect);
     void markCursorTextureDirty();
 
     GLShader *shaderForZoom(double zoom);
@@ -136,6 +138,7 @@ private:
     std::unique_ptr<GLTexture> m_cursorTexture;
     bool m_cursorTextureDirty = false;
     bool m_isMouseHidden = false;
+    bool m_isCursorTransformed = false;
     QTimeLine m_timeline;
     int m_xMove = 0;
     int m_yMove = 0;
@@ -280,7 +280,7 @@ void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QP
 
     update();
     input()->processSpies(&InputEventSpy::pointerMotion, &event);
-    input()->processFilters(&InputEventFilter::pointerMotion, &event);
+    input()->processFilters(InputEventKind::Pointer, &InputEventFilter::pointerMotion, &event);
 }
 
 void PointerInputRedirection::processButton(uint32_t button, PointerButtonState state, std::chrono::microseconds time, InputDevice *device)
@@ -309,7 +309,7 @@ void PointerInputRedirection::processButton(uint32_t button, PointerButtonState
     };
 
     input()->processSpies(&InputEventSpy::pointerButton, &event);
-    input()->processFilters(&InputEventFilter::pointerButton, &event);
+    input()->processFilters(InputEventKind::Pointer, &InputEventFilter::pointerButton, &event);
     if (state == PointerButtonState::Pressed) {
         input()->setLastInteractionSerial(waylandServer()->seat()->display()->serial());
         if (auto f = focus()) {
@@ -349,7 +349,7 @@ void PointerInputRedirection::processAxis(PointerAxis axis, qreal delta, qint32
     };
 
     input()->processSpies(&InputEventSpy::pointerAxis, &event);
-    input()->processFilters(&InputEventFilter::pointerAxis, &event);
+    input()->processFilters(InputEventKind::Pointer, &InputEventFilter::pointerAxis, &event);
 }
 
 void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -366,7 +366,7 @@ void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, std::chr
     };
 
     input()->processSpies(&InputEventSpy::swipeGestureBegin, &event);
-    input()->processFilters(&InputEventFilter::swipeGestureBegin, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::swipeGestureBegin, &event);
 }
 
 void PointerInputRedirection::processSwipeGestureUpdate(const QPointF &delta, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -383,7 +383,7 @@ void PointerInputRedirection::processSwipeGestureUpdate(const QPointF &delta, st
     };
 
     input()->processSpies(&InputEventSpy::swipeGestureUpdate, &event);
-    input()->processFilters(&InputEventFilter::swipeGestureUpdate, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::swipeGestureUpdate, &event);
 }
 
 void PointerInputRedirection::processSwipeGestureEnd(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -399,7 +399,7 @@ void PointerInputRedirection::processSwipeGestureEnd(std::chrono::microseconds t
     };
 
     input()->processSpies(&InputEventSpy::swipeGestureEnd, &event);
-    input()->processFilters(&InputEventFilter::swipeGestureEnd, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::swipeGestureEnd, &event);
 }
 
 void PointerInputRedirection::processSwipeGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -415,7 +415,7 @@ void PointerInputRedirection::processSwipeGestureCancelled(std::chrono::microsec
     };
 
     input()->processSpies(&InputEventSpy::swipeGestureCancelled, &event);
-    input()->processFilters(&InputEventFilter::swipeGestureCancelled, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::swipeGestureCancelled, &event);
 }
 
 void PointerInputRedirection::processPinchGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -432,7 +432,7 @@ void PointerInputRedirection::processPinchGestureBegin(int fingerCount, std::chr
     };
 
     input()->processSpies(&InputEventSpy::pinchGestureBegin, &event);
-    input()->processFilters(&InputEventFilter::pinchGestureBegin, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::pinchGestureBegin, &event);
 }
 
 void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angleDelta, const QPointF &delta, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -451,7 +451,7 @@ void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angle
     };
 
     input()->processSpies(&InputEventSpy::pinchGestureUpdate, &event);
-    input()->processFilters(&InputEventFilter::pinchGestureUpdate, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::pinchGestureUpdate, &event);
 }
 
 void PointerInputRedirection::processPinchGestureEnd(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -467,7 +467,7 @@ void PointerInputRedirection::processPinchGestureEnd(std::chrono::microseconds t
     };
 
     input()->processSpies(&InputEventSpy::pinchGestureEnd, &event);
-    input()->processFilters(&InputEventFilter::pinchGestureEnd, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::pinchGestureEnd, &event);
 }
 
 void PointerInputRedirection::processPinchGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -483,7 +483,7 @@ void PointerInputRedirection::processPinchGestureCancelled(std::chrono::microsec
     };
 
     input()->processSpies(&InputEventSpy::pinchGestureCancelled, &event);
-    input()->processFilters(&InputEventFilter::pinchGestureCancelled, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::pinchGestureCancelled, &event);
 }
 
 void PointerInputRedirection::processHoldGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -499,7 +499,7 @@ void PointerInputRedirection::processHoldGestureBegin(int fingerCount, std::chro
     };
 
     input()->processSpies(&InputEventSpy::holdGestureBegin, &event);
-    input()->processFilters(&InputEventFilter::holdGestureBegin, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::holdGestureBegin, &event);
 }
 
 void PointerInputRedirection::processHoldGestureEnd(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -514,7 +514,7 @@ void PointerInputRedirection::processHoldGestureEnd(std::chrono::microseconds ti
     };
 
     input()->processSpies(&InputEventSpy::holdGestureEnd, &event);
-    input()->processFilters(&InputEventFilter::holdGestureEnd, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::holdGestureEnd, &event);
 }
 
 void PointerInputRedirection::processHoldGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -529,7 +529,7 @@ void PointerInputRedirection::processHoldGestureCancelled(std::chrono::microseco
     };
 
     input()->processSpies(&InputEventSpy::holdGestureCancelled, &event);
-    input()->processFilters(&InputEventFilter::holdGestureCancelled, &event);
+    input()->processFilters(InputEventKind::Gesture, &InputEventFilter::holdGestureCancelled, &event);
 }
 
 void PointerInputRedirection::processFrame(KWin::InputDevice *device)
@@ -538,7 +538,7 @@ void PointerInputRedirection::processFrame(KWin::InputDevice *device)
         return;
     }
 
-    input()->processFilters(&InputEventFilter::pointerFrame);
+    input()->processFilters(InputEventKind::Pointer, &InputEventFilter::pointerFrame);
 }
 
 bool PointerInputRedirection::areButtonsPressed() const
@@ -1266,6 +1266,36 @@ void WaylandCursorImage::updateCursorTheme()
         qCWarning(KWIN_CORE) << "Unable to load any cursor theme";
     }
 
+    // Decode the cursors that are most likely to be needed soon ahead of time, so that e.g.
+    // hovering a window edge for the first time doesn't have to wait for them
+    static const CursorShape hotShapes[] = {
+        Qt::ArrowCursor,
+        Qt::IBeamCursor,
+        Qt::PointingHandCursor,
+        Qt::WaitCursor,
+        Qt::BusyCursor,
+        Qt::SizeAllCursor,
+        KWin::ExtendedCursor::SizeNorthWest,
+        KWin::ExtendedCursor::SizeNorth,
+        KWin::ExtendedCursor::SizeNorthEast,
+        KWin::ExtendedCursor::SizeEast,
+        KWin::ExtendedCursor::SizeSouthEast,
+        KWin::ExtendedCursor::SizeSouth,
+        KWin::ExtendedCursor::SizeSouthWest,
+        KWin::ExtendedCursor::SizeWest,
+    };
+    for (const CursorShape &shape : hotShapes) {
+        const QByteArray name = shape.name();
+        if (!m_cursorTheme.prefetch(name)) {
+            const QList<QByteArray> alternatives = CursorShape::alternatives(name);
+            for (const QByteArray &alternative : alternatives) {
+                if (m_cursorTheme.prefetch(alternative)) {
+                    break;
+                }
+            }
+        }
+    }
+
     Q_EMIT themeChanged();
 }
 
@@ -21,7 +21,7 @@ namespace KWin
 
 PopupInputFilter::PopupInputFilter()
     : QObject()
-    , InputEventFilter(InputFilterOrder::Popup)
+    , InputEventFilter(InputFilterOrder::Popup, InputEventKind::Pointer | InputEventKind::Keyboard | InputEventKind::Touch | InputEventKind::Tablet)
 {
     connect(workspace(), &Workspace::windowAdded, this, &PopupInputFilter::handleWindowAdded);
     connect(workspace(), &Workspace::windowActivated, this, &PopupInputFilter::handleWindowFocusChanged);
@@ -17,6 +17,8 @@
 #include <QTemporaryFile>
 #include <kconfig.h>
 
+#include <algorithm>
+
 #ifndef KCMRULES
 #include "client_machine.h"
 #include "main.h"
@@ -80,9 +82,10 @@ Rules::Rules()
 {
 }
 
-#define READ_MATCH_STRING(var, func) \
-    var = settings->var() func;      \
-    var##match = static_cast<StringMatch>(settings->var##match())
+#define READ_MATCH_STRING(var, func)                               \
+    var = settings->var() func;                                    \
+    var##match = static_cast<StringMatch>(settings->var##match()); \
+    var##regexp = var##match == RegExpMatch ? QRegularExpression(var) : QRegularExpression()
 
 #define READ_SET_RULE(var) \
     var = settings->var(); \
@@ -371,11 +374,10 @@ bool Rules::matchType(WindowType match_type) const
 bool Rules::matchWMClass(const QString &match_class, const QString &match_name) const
 {
     if (wmclassmatch != UnimportantMatch) {
-        // TODO optimize?
-        QString cwmclass = wmclasscomplete
+        const QString cwmclass = wmclasscomplete
             ? match_name + ' ' + match_class
             : match_class;
-        if (wmclassmatch == RegExpMatch && !QRegularExpression(wmclass).match(cwmclass).hasMatch()) {
+        if (wmclassmatch == RegExpMatch && !wmclassregexp.match(cwmclass).hasMatch()) {
             return false;
         }
         if (wmclassmatch == ExactMatch && cwmclass != wmclass) {
@@ -391,7 +393,7 @@ bool Rules::matchWMClass(const QString &match_class, const QString &match_name)
 bool Rules::matchRole(const QString &match_role) const
 {
     if (windowrolematch != UnimportantMatch) {
-        if (windowrolematch == RegExpMatch && !QRegularExpression(windowrole).match(match_role).hasMatch()) {
+        if (windowrolematch == RegExpMatch && !windowroleregexp.match(match_role).hasMatch()) {
             return false;
         }
         if (windowrolematch == ExactMatch && match_role != windowrole) {
@@ -407,7 +409,7 @@ bool Rules::matchRole(const QString &match_role) const
 bool Rules::matchTitle(const QString &match_title) const
 {
     if (titlematch != UnimportantMatch) {
-        if (titlematch == RegExpMatch && !QRegularExpression(title).match(match_title).hasMatch()) {
+        if (titlematch == RegExpMatch && !titleregexp.match(match_title).hasMatch()) {
             return false;
         }
         if (titlematch == ExactMatch && title != match_title) {
@@ -429,7 +431,7 @@ bool Rules::matchClientMachine(const QString &match_machine, bool local) const
             return true;
         }
         if (clientmachinematch == RegExpMatch
-            && !QRegularExpression(clientmachine).match(match_machine).hasMatch()) {
+            && !clientmachineregexp.match(match_machine).hasMatch()) {
             return false;
         }
         if (clientmachinematch == ExactMatch
@@ -447,7 +449,7 @@ bool Rules::matchClientMachine(const QString &match_machine, bool local) const
 bool Rules::matchTag(const QString &match_tag) const
 {
     if (tagmatch != UnimportantMatch) {
-        if (tagmatch == RegExpMatch && !QRegularExpression(tag).match(match_tag).hasMatch()) {
+        if (tagmatch == RegExpMatch && !tagregexp.match(match_tag).hasMatch()) {
             return false;
         }
         if (tagmatch == ExactMatch && tag != match_tag) {
@@ -490,6 +492,15 @@ bool Rules::match(const Window *c) const
     return true;
 }
 
+QString Rules::requiredWindowClass(bool *complete) const
+{
+    if (wmclassmatch != ExactMatch) {
+        return QString();
+    }
+    *complete = wmclasscomplete;
+    return wmclass;
+}
+
 #define NOW_REMEMBER(_T_, _V_) ((selection & _T_) && (_V_##rule == (SetRule)Remember))
 
 bool Rules::update(Window *c, int selection)
@@ -940,12 +951,55 @@ void RuleBook::deleteAll()
 {
     qDeleteAll(m_rules);
     m_rules.clear();
+    m_indexDirty = true;
+}
+
+void RuleBook::updateIndex() const
+{
+    m_rulesByWindowClass.clear();
+    m_rulesByCompleteWindowClass.clear();
+    m_rulesForAnyWindowClass.clear();
+    m_rulePositions.clear();
+    for (Rules *rule : m_rules) {
+        m_rulePositions.insert(rule, m_rulePositions.size());
+        bool complete = false;
+        const QString windowClass = rule->requiredWindowClass(&complete);
+        if (windowClass.isEmpty()) {
+            m_rulesForAnyWindowClass.append(rule);
+        } else if (complete) {
+            m_rulesByCompleteWindowClass[windowClass].append(rule);
+        } else {
+            m_rulesByWindowClass[windowClass].append(rule);
+        }
+    }
+    m_indexDirty = false;
 }
 
 WindowRules RuleBook::find(const Window *window) const
 {
+    if (m_indexDirty) {
+        updateIndex();
+    }
+
+    // Only the rules that can possibly match the window need to be checked, but they have
+    // to be checked in the order they've been defined
+    const QList<Rules *> candidates[] = {
+        m_rulesForAnyWindowClass,
+        m_rulesByWindowClass.value(window->resourceClass()),
+        m_rulesByCompleteWindowClass.value(window->resourceName() + QLatin1Char(' ') + window->resourceClass()),
+    };
+    QList<Rules *> rules;
+    for (const QList<Rules *> &list : candidates) {
+        rules += list;
+    }
+    if (!candidates[1].isEmpty() || !candidates[2].isEmpty()) {
+        std::sort(rules.begin(), rules.end(), [this](Rules *a, Rules *b) {
+            return m_rulePositions.value(a) < m_rulePositions.value(b);
+        });
+    }
+
     QList<Rules *> ret;
-    for (Rules *rule : m_rules) {
+    for (Rules *rule : std::as_const(rules)) {
         if (rule->match(window)) {
             qCDebug(KWIN_CORE) << "Rule found:" << rule << ":" << window;
             ret.append(rule);
@@ -991,6 +1045,7 @@ void RuleBook::load()
     }
     m_book->load();
     m_rules = m_book->rules();
+    m_indexDirty = true;
 }
 
 void RuleBook::save()
@@ -1019,6 +1074,7 @@ void RuleBook::discardUsed(Window *c, bool withdrawn)
                 c->removeRule(*it);
                 Rules *r = *it;
                 it = m_rules.erase(it);
+                m_indexDirty = true;
                 delete r;
                 if (index) {
                     m_book->removeRuleSettingsAt(index.value());
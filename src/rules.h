@@ -9,8 +9,10 @@
 
 #pragma once
 
+#include <QHash>
 #include <QList>
 #include <QRectF>
+#include <QRegularExpression>
 
 #include "options.h"
 #include "utils/common.h"
@@ -151,6 +153,12 @@ public:
 #ifndef KCMRULES
     bool discardUsed(bool withdrawn);
     bool match(const Window *c) const;
+    /**
+     * Returns the window class that a window must have for the rule to match, or an empty
+     * string if the rule can match any window class. @a complete is set if the class has to
+     * be prefixed with the resource name and a space.
+     */
+    QString requiredWindowClass(bool *complete) const;
     bool update(Window *, int selection);
     bool applyPlacement(PlacementPolicy &placement) const;
     bool applyGeometry(QRectF &rect, bool init) const;
@@ -228,6 +236,12 @@ private:
     StringMatch clientmachinematch;
     QString tag;
     StringMatch tagmatch;
+    // The compiled regular expressions of the strings that are matched with RegExpMatch
+    QRegularExpression wmclassregexp;
+    QRegularExpression windowroleregexp;
+    QRegularExpression titleregexp;
+    QRegularExpression clientmachineregexp;
+    QRegularExpression tagregexp;
     WindowTypes types; // types for matching
     PlacementPolicy placement;
     ForceRule placementrule;
@@ -325,9 +339,17 @@ private Q_SLOTS:
 
 private:
     void deleteAll();
+    void updateIndex() const;
     QTimer *m_updateTimer;
     bool m_updatesDisabled;
     QList<Rules *> m_rules;
+    // The rules that require a specific window class, with or without the resource name,
+    // and the rules that don't. All of them are in the same order as in m_rules.
+    mutable QHash<QString, QList<Rules *>> m_rulesByWindowClass;
+    mutable QHash<QString, QList<Rules *>> m_rulesByCompleteWindowClass;
+    mutable QList<Rules *> m_rulesForAnyWindowClass;
+    mutable QHash<Rules *, int> m_rulePositions;
+    mutable bool m_indexDirty = true;
     std::unique_ptr<RuleBookSettings> m_book;
 };
 
@@ -16,12 +16,19 @@
 #include "scene/workspacescene.h"
 #include "window.h"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <optional>
+#include <vector>
 
 #include <KDecoration3/DecoratedWindow>
 #include <KDecoration3/Decoration>
 
 #include <QPainter>
+#include <QPicture>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 
 namespace KWin
 {
@@ -67,7 +74,7 @@ void DecorationRenderer::addDamage(const QRegion &region)
 
 void DecorationRenderer::resetDamage()
 {
-    m_damage = QRegion();
+    m_damage = Region();
 }
 
 qreal DecorationRenderer::effectiveDevicePixelRatio() const
@@ -89,11 +96,231 @@ void DecorationRenderer::setDevicePixelRatio(qreal dpr)
     }
 }
 
+QPoint DecorationRenderer::textureOffset() const
+{
+    return QPoint();
+}
+
+void DecorationRenderer::publish()
+{
+}
+
 void DecorationRenderer::renderToPainter(QPainter *painter, const QRectF &rect)
 {
     client()->decoration()->paint(painter, rect);
 }
 
+/**
+ * The DecorationTextureAtlas class packs the textures of decorations into a few big textures,
+ * so the memory is not split in lots of small allocations and the decorations can be drawn
+ * without switching textures.
+ *
+ * Decoration textures are wide and short, they are packed in shelves. An empty shelf at the
+ * bottom of a page is given back, and a page is destroyed when nothing is left in it.
+ */
+class DecorationTextureAtlas
+{
+public:
+    struct Allocation
+    {
+        std::shared_ptr<GLTexture> texture;
+        QRect rect;
+    };
+
+    ~DecorationTextureAtlas();
+    DecorationTextureAtlas(const DecorationTextureAtlas &) = delete;
+    static DecorationTextureAtlas &instance();
+
+    std::optional<Allocation> allocate(const QSize &size);
+    void release(const Allocation &allocation);
+
+private:
+    DecorationTextureAtlas() = default;
+
+    struct Span
+    {
+        int x;
+        int width;
+    };
+
+    struct Shelf
+    {
+        int y;
+        int height;
+        std::vector<Span> free;
+        int allocations = 0;
+    };
+
+    struct Page
+    {
+        std::shared_ptr<GLTexture> texture;
+        std::vector<Shelf> shelves;
+        int allocations = 0;
+        bool dedicated = false;
+    };
+
+    static std::optional<QRect> allocateInPage(Page &page, const QSize &size);
+    static std::shared_ptr<GLTexture> allocateTexture(const QSize &size);
+
+    static constexpr QSize s_pageSize = QSize(4096, 512);
+    std::vector<Page> m_pages;
+};
+
+DecorationTextureAtlas &DecorationTextureAtlas::instance()
+{
+    static DecorationTextureAtlas s_instance;
+    return s_instance;
+}
+
+DecorationTextureAtlas::~DecorationTextureAtlas()
+{
+    Q_ASSERT(m_pages.empty());
+}
+
+std::shared_ptr<GLTexture> DecorationTextureAtlas::allocateTexture(const QSize &size)
+{
+    std::shared_ptr<GLTexture> texture = GLTexture::allocate(GL_RGBA8, size);
+    if (texture) {
+        texture->setContentTransform(OutputTransform::FlipY);
+        texture->setFilter(GL_LINEAR);
+        texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    }
+    return texture;
+}
+
+std::optional<QRect> DecorationTextureAtlas::allocateInPage(Page &page, const QSize &size)
+{
+    // Prefer the shelf that wastes the least space, tall shelves can be reused only when empty
+    Shelf *bestShelf = nullptr;
+    Span *bestSpan = nullptr;
+    for (Shelf &shelf : page.shelves) {
+        if (shelf.height < size.height() || (shelf.allocations && shelf.height > size.height() * 3 / 2)) {
+            continue;
+        }
+        if (bestShelf && bestShelf->height <= shelf.height) {
+            continue;
+        }
+        const auto span = std::ranges::find_if(shelf.free, [&size](const Span &candidate) {
+            return candidate.width >= size.width();
+        });
+        if (span != shelf.free.end()) {
+            bestShelf = &shelf;
+            bestSpan = &*span;
+        }
+    }
+
+    if (!bestShelf) {
+        const int bottom = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().height;
+        if (bottom + size.height() > page.texture->height()) {
+            return std::nullopt;
+        }
+        bestShelf = &page.shelves.emplace_back(Shelf{
+            .y = bottom,
+            .height = size.height(),
+            .free = {Span{.x = 0, .width = page.texture->width()}},
+        });
+        bestSpan = &bestShelf->free.front();
+    }
+
+    const QRect rect(bestSpan->x, bestShelf->y, size.width(), size.height());
+    bestSpan->x += size.width();
+    bestSpan->width -= size.width();
+    if (!bestSpan->width) {
+        std::erase_if(bestShelf->free, [](const Span &span) {
+            return !span.width;
+        });
+    }
+    bestShelf->allocations++;
+    page.allocations++;
+    return rect;
+}
+
+std::optional<DecorationTextureAtlas::Allocation> DecorationTextureAtlas::allocate(const QSize &size)
+{
+    if (size.width() > s_pageSize.width() || size.height() > s_pageSize.height()) {
+        // Doesn't fit in a shared page, e.g. a huge window on a high dpi screen
+        auto texture = allocateTexture(size);
+        if (!texture) {
+            return std::nullopt;
+        }
+        m_pages.push_back(Page{
+            .texture = texture,
+            .allocations = 1,
+            .dedicated = true,
+        });
+        return Allocation{
+            .texture = texture,
+            .rect = QRect(QPoint(0, 0), size),
+        };
+    }
+
+    for (Page &page : m_pages) {
+        if (page.dedicated) {
+            continue;
+        }
+        if (const auto rect = allocateInPage(page, size)) {
+            return Allocation{
+                .texture = page.texture,
+                .rect = *rect,
+            };
+        }
+    }
+
+    auto texture = allocateTexture(s_pageSize);
+    if (!texture) {
+        return std::nullopt;
+    }
+    Page &page = m_pages.emplace_back(Page{
+        .texture = texture,
+    });
+    const auto rect = allocateInPage(page, size);
+    Q_ASSERT(rect);
+    return Allocation{
+        .texture = texture,
+        .rect = *rect,
+    };
+}
+
+void DecorationTextureAtlas::release(const Allocation &allocation)
+{
+    const auto page = std::ranges::find_if(m_pages, [&allocation](const Page &page) {
+        return page.texture == allocation.texture;
+    });
+    Q_ASSERT(page != m_pages.end());
+
+    if (!page->dedicated) {
+        const auto shelf = std::ranges::find_if(page->shelves, [&allocation](const Shelf &shelf) {
+            return shelf.y == allocation.rect.y();
+        });
+        Q_ASSERT(shelf != page->shelves.end());
+
+        // Keep the free spans sorted and merge the adjacent ones
+        auto span = std::ranges::find_if(shelf->free, [&allocation](const Span &candidate) {
+            return candidate.x > allocation.rect.x();
+        });
+        span = shelf->free.insert(span, Span{.x = allocation.rect.x(), .width = allocation.rect.width()});
+        if (auto after = std::next(span); after != shelf->free.end() && span->x + span->width == after->x) {
+            span->width += after->width;
+            shelf->free.erase(after);
+        }
+        if (span != shelf->free.begin()) {
+            if (auto before = std::prev(span); before->x + before->width == span->x) {
+                before->width += span->width;
+                shelf->free.erase(span);
+            }
+        }
+
+        shelf->allocations--;
+        while (!page->shelves.empty() && !page->shelves.back().allocations) {
+            page->shelves.pop_back();
+        }
+    }
+
+    if (!--page->allocations) {
+        m_pages.erase(page);
+    }
+}
+
 SceneOpenGLDecorationRenderer::SceneOpenGLDecorationRenderer(Decoration::DecoratedWindowImpl *client)
     : DecorationRenderer(client)
     , m_texture()
@@ -105,6 +332,24 @@ SceneOpenGLDecorationRenderer::~SceneOpenGLDecorationRenderer()
     if (WorkspaceScene *scene = Compositor::self()->scene()) {
         scene->openglContext()->makeCurrent();
     }
+    releaseTexture();
+}
+
+QPoint SceneOpenGLDecorationRenderer::textureOffset() const
+{
+    return m_textureRect.topLeft();
+}
+
+void SceneOpenGLDecorationRenderer::releaseTexture()
+{
+    if (m_texture) {
+        DecorationTextureAtlas::instance().release(DecorationTextureAtlas::Allocation{
+            .texture = m_texture,
+            .rect = m_textureRect,
+        });
+        m_texture.reset();
+        m_textureRect = QRect();
+    }
 }
 
 static void clamp_row(int left, int width, int right, const uint32_t *src, uint32_t *dest)
@@ -157,11 +402,88 @@ static void clamp(QImage &image, const QRect &viewport)
     }
 }
 
+static QThreadPool *decorationThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(2);
+        pool->setObjectName(QStringLiteral("KWin decoration rendering"));
+        return pool;
+    }();
+    return pool;
+}
+
+/**
+ * The DecorationPicture class records the paint commands of a decoration so they can be
+ * replayed on a worker thread. It pretends to have the device pixel ratio of the texture
+ * so icons and such are picked at the right resolution.
+ */
+class DecorationPicture : public QPicture
+{
+public:
+    explicit DecorationPicture(qreal devicePixelRatio)
+        : m_devicePixelRatio(devicePixelRatio)
+    {
+    }
+
+protected:
+    int metric(PaintDeviceMetric metric) const override
+    {
+        switch (metric) {
+        case PdmDevicePixelRatio:
+            return std::ceil(m_devicePixelRatio);
+        case PdmDevicePixelRatioScaled:
+            return m_devicePixelRatio * devicePixelRatioFScale();
+        default:
+            return QPicture::metric(metric);
+        }
+    }
+
+private:
+    qreal m_devicePixelRatio;
+};
+
+struct SceneOpenGLDecorationRenderer::PartRecording
+{
+    DecorationPicture picture;
+    QSize imageSize;
+    QRect clip;
+    QPoint textureOffset;
+};
+
+SceneOpenGLDecorationRenderer::RenderedPart SceneOpenGLDecorationRenderer::rasterizePart(const PartRecording &recording)
+{
+    QImage image(recording.imageSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.drawPicture(0, 0, recording.picture);
+    painter.end();
+
+    // fill padding pixels by copying from the neighbour row
+    clamp(image, recording.clip);
+
+    return RenderedPart{
+        .image = image,
+        .textureOffset = recording.textureOffset,
+    };
+}
+
 void SceneOpenGLDecorationRenderer::render(const QRegion &region)
 {
+    if (m_rendering) {
+        // Come back once the previous frame of the decoration has been rasterized
+        m_deferredDamage += region;
+        return;
+    }
+
+    bool synchronous = false;
     if (areImageSizesDirty()) {
         resizeTexture();
         resetImageSizesDirty();
+        // A new texture has to be filled before it's shown for the first time
+        m_renderedParts.clear();
+        synchronous = true;
     }
 
     if (!m_texture) {
@@ -177,26 +499,91 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
     const int bottomHeight = std::round(bottom.height() * devicePixelRatio);
     const int leftWidth = std::round(left.width() * devicePixelRatio);
 
-    const QPoint topPosition(0, 0);
-    const QPoint bottomPosition(0, topPosition.y() + topHeight + (2 * TexturePad));
-    const QPoint leftPosition(0, bottomPosition.y() + bottomHeight + (2 * TexturePad));
-    const QPoint rightPosition(0, leftPosition.y() + leftWidth + (2 * TexturePad));
+    const QPoint topPosition = m_textureRect.topLeft();
+    const QPoint bottomPosition(topPosition.x(), topPosition.y() + topHeight + (2 * TexturePad));
+    const QPoint leftPosition(topPosition.x(), bottomPosition.y() + bottomHeight + (2 * TexturePad));
+    const QPoint rightPosition(topPosition.x(), leftPosition.y() + leftWidth + (2 * TexturePad));
+
+    // Only recording the paint commands happens here, the decoration is rasterized on a
+    // worker thread and the result is uploaded during the next frame
+    std::vector<PartRecording> recordings;
+    recordPart(recordings, region, top, topPosition, devicePixelRatio);
+    recordPart(recordings, region, bottom, bottomPosition, devicePixelRatio);
+    recordPart(recordings, region, left, leftPosition, devicePixelRatio, true);
+    recordPart(recordings, region, right, rightPosition, devicePixelRatio, true);
+    if (recordings.empty()) {
+        return;
+    }
 
-    const QRect dirtyRect = region.boundingRect();
+    if (synchronous) {
+        for (const PartRecording &recording : recordings) {
+            const RenderedPart part = rasterizePart(recording);
+            m_texture->update(part.image, part.image.rect(), part.textureOffset);
+        }
+        return;
+    }
 
-    renderPart(top.intersected(dirtyRect), top, topPosition, devicePixelRatio);
-    renderPart(bottom.intersected(dirtyRect), bottom, bottomPosition, devicePixelRatio);
-    renderPart(left.intersected(dirtyRect), left, leftPosition, devicePixelRatio, true);
-    renderPart(right.intersected(dirtyRect), right, rightPosition, devicePixelRatio, true);
+    m_rendering = true;
+    QtConcurrent::run(decorationThreadPool(), [recordings = std::move(recordings)]() {
+        std::vector<RenderedPart> parts;
+        parts.reserve(recordings.size());
+        for (const PartRecording &recording : recordings) {
+            parts.push_back(rasterizePart(recording));
+        }
+        return parts;
+    }).then(this, [this, region](std::vector<RenderedPart> parts) {
+        m_rendering = false;
+        std::move(parts.begin(), parts.end(), std::back_inserter(m_renderedParts));
+        Q_EMIT damaged(region);
+        if (!m_deferredDamage.isEmpty()) {
+            addDamage(std::exchange(m_deferredDamage, QRegion()));
+        }
+    });
 }
 
-void SceneOpenGLDecorationRenderer::renderPart(const QRectF &rect, const QRectF &partRect,
+void SceneOpenGLDecorationRenderer::publish()
+{
+    if (!m_texture) {
+        m_renderedParts.clear();
+        return;
+    }
+    for (const RenderedPart &part : m_renderedParts) {
+        m_texture->update(part.image, part.image.rect(), part.textureOffset);
+    }
+    m_renderedParts.clear();
+}
+
+void SceneOpenGLDecorationRenderer::recordPart(std::vector<PartRecording> &recordings,
+                                               const QRegion &region, const QRectF &partRect,
                                                const QPoint &textureOffset,
                                                qreal devicePixelRatio, bool rotated)
 {
-    if (!rect.isValid() || !m_texture) {
+    // Re-render only the rects that have actually changed, e.g. a hovered button and the
+    // caption, unless the damage is so fragmented that one pass over its bounds is cheaper
+    const QRegion damage = region & partRect.toAlignedRect();
+    if (damage.isEmpty()) {
         return;
     }
+    if (damage.rectCount() > 4) {
+        if (auto recording = recordPartRect(partRect.intersected(damage.boundingRect()), partRect, textureOffset, devicePixelRatio, rotated)) {
+            recordings.push_back(std::move(*recording));
+        }
+    } else {
+        for (const QRect &rect : damage) {
+            if (auto recording = recordPartRect(partRect.intersected(rect), partRect, textureOffset, devicePixelRatio, rotated)) {
+                recordings.push_back(std::move(*recording));
+            }
+        }
+    }
+}
+
+std::optional<SceneOpenGLDecorationRenderer::PartRecording> SceneOpenGLDecorationRenderer::recordPartRect(const QRectF &rect, const QRectF &partRect,
+                                                                                                          const QPoint &textureOffset,
+                                                                                                          qreal devicePixelRatio, bool rotated)
+{
+    if (!rect.isValid()) {
+        return std::nullopt;
+    }
     // We allow partial decoration updates and it might just so happen that the
     // dirty region is completely contained inside the decoration part, i.e.
     // the dirty region doesn't touch any of the decoration's edges. In that
@@ -212,16 +599,17 @@ void SceneOpenGLDecorationRenderer::renderPart(const QRectF &rect, const QRectF
     QSize paddedImageSize = imageSize;
     paddedImageSize.rheight() += verticalPadding;
     paddedImageSize.rwidth() += horizontalPadding;
-    QImage image(paddedImageSize, QImage::Format_ARGB32_Premultiplied);
-    image.setDevicePixelRatio(devicePixelRatio);
-    image.fill(Qt::transparent);
 
-    QRect padClip = QRect(padding.left(), padding.top(), imageSize.width(), imageSize.height());
-    QPainter painter(&image);
-    const qreal inverseScale = 1.0 / devicePixelRatio;
-    painter.scale(inverseScale, inverseScale);
+    PartRecording recording{
+        .picture = DecorationPicture(devicePixelRatio),
+        .imageSize = paddedImageSize,
+        .clip = QRect(padding.left(), padding.top(), imageSize.width(), imageSize.height()),
+    };
+
+    // The picture is replayed in device pixels of the texture
+    QPainter painter(&recording.picture);
     painter.setRenderHint(QPainter::Antialiasing);
-    painter.setClipRect(padClip);
+    painter.setClipRect(recording.clip);
     painter.translate(padding.left(), padding.top());
     if (rotated) {
         painter.translate(0, imageSize.height());
@@ -232,9 +620,6 @@ void SceneOpenGLDecorationRenderer::renderPart(const QRectF &rect, const QRectF
     renderToPainter(&painter, rect);
     painter.end();
 
-    // fill padding pixels by copying from the neighbour row
-    clamp(image, padClip);
-
     QPoint dirtyOffset = ((rect.topLeft() - partRect.topLeft()) * devicePixelRatio).toPoint();
     if (padding.top() == 0) {
         dirtyOffset.ry() += TexturePad;
@@ -242,7 +627,8 @@ void SceneOpenGLDecorationRenderer::renderPart(const QRectF &rect, const QRectF
     if (padding.left() == 0) {
         dirtyOffset.rx() += TexturePad;
     }
-    m_texture->update(image, image.rect(), textureOffset + dirtyOffset);
+    recording.textureOffset = textureOffset + dirtyOffset;
+    return recording;
 }
 
 const QMargins SceneOpenGLDecorationRenderer::texturePadForPart(
@@ -282,21 +668,18 @@ void SceneOpenGLDecorationRenderer::resizeTexture()
     size.rwidth() += 2 * TexturePad;
     size.rwidth() = align(size.width(), 128);
 
-    if (m_texture && m_texture->size() == size) {
+    if (m_texture && m_textureRect.size() == size) {
         return;
     }
 
+    releaseTexture();
     if (!size.isEmpty()) {
-        m_texture = GLTexture::allocate(GL_RGBA8, size);
-        if (!m_texture) {
-            return;
+        if (const auto allocation = DecorationTextureAtlas::instance().allocate(size)) {
+            m_texture = allocation->texture;
+            m_textureRect = allocation->rect;
         }
-        m_texture->setContentTransform(OutputTransform::FlipY);
-        m_texture->setFilter(GL_LINEAR);
-        m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-    } else {
-        m_texture.reset();
     }
+    Q_EMIT textureOffsetChanged();
 }
 
 int SceneOpenGLDecorationRenderer::toNativeSize(double size) const
@@ -400,6 +783,8 @@ DecorationItem::DecorationItem(KDecoration3::Decoration *decoration, Window *win
 
     connect(renderer(), &DecorationRenderer::damaged,
             this, qOverload<const QRegion &>(&Item::scheduleRepaint));
+    connect(renderer(), &DecorationRenderer::textureOffsetChanged,
+            this, &DecorationItem::discardQuads);
 
     setSize(decoration->size());
     updateScale();
@@ -439,6 +824,8 @@ QRegion DecorationItem::opaque() const
 
 void DecorationItem::preprocess()
 {
+    m_renderer->publish();
+
     const QRegion damage = m_renderer->damage();
     if (!damage.isEmpty()) {
         m_renderer->render(damage);
@@ -540,10 +927,10 @@ WindowQuadList DecorationItem::buildQuads() const
     const int bottomHeight = std::round(bottom.height() * devicePixelRatio);
     const int leftWidth = std::round(left.width() * devicePixelRatio);
 
-    const QPoint topPosition(0, 0);
-    const QPoint bottomPosition(0, topPosition.y() + topHeight + (2 * texturePad));
-    const QPoint leftPosition(0, bottomPosition.y() + bottomHeight + (2 * texturePad));
-    const QPoint rightPosition(0, leftPosition.y() + leftWidth + (2 * texturePad));
+    const QPoint topPosition = m_renderer->textureOffset();
+    const QPoint bottomPosition(topPosition.x(), topPosition.y() + topHeight + (2 * texturePad));
+    const QPoint leftPosition(topPosition.x(), bottomPosition.y() + bottomHeight + (2 * texturePad));
+    const QPoint rightPosition(topPosition.x(), leftPosition.y() + leftWidth + (2 * texturePad));
 
     WindowQuadList list;
     if (left.isValid()) {
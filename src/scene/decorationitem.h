@@ -6,8 +6,14 @@
 
 #pragma once
 
+#include "core/region.h"
 #include "scene/item.h"
 
+#include <QImage>
+
+#include <optional>
+#include <vector>
+
 namespace KDecoration3
 {
 class Decoration;
@@ -43,11 +49,22 @@ public:
     qreal devicePixelRatio() const;
     void setDevicePixelRatio(qreal dpr);
 
+    /**
+     * Returns the position of the decoration parts in the texture they are rendered into.
+     */
+    virtual QPoint textureOffset() const;
+
+    /**
+     * Makes the results of rendering that has finished in the background visible.
+     */
+    virtual void publish();
+
     // Reserve some space for padding. We pad decoration parts to avoid texture bleeding.
     static const int TexturePad = 1;
 
 Q_SIGNALS:
     void damaged(const QRegion &region);
+    void textureOffsetChanged();
 
 protected:
     explicit DecorationRenderer(Decoration::DecoratedWindowImpl *client);
@@ -66,7 +83,7 @@ protected:
 
 private:
     QPointer<Decoration::DecoratedWindowImpl> m_client;
-    QRegion m_damage;
+    Region m_damage;
     qreal m_devicePixelRatio = 1;
     bool m_imageSizesDirty;
 };
@@ -86,7 +103,13 @@ public:
     ~SceneOpenGLDecorationRenderer() override;
 
     void render(const QRegion &region) override;
+    QPoint textureOffset() const override;
+    void publish() override;
 
+    /**
+     * Returns the texture the decoration is rendered into. The texture is shared with other
+     * decorations, the decoration occupies only the area at textureOffset().
+     */
     GLTexture *texture()
     {
         return m_texture.get();
@@ -97,11 +120,25 @@ public:
     }
 
 private:
-    void renderPart(const QRectF &rect, const QRectF &partRect, const QPoint &textureOffset, qreal devicePixelRatio, bool rotated = false);
+    struct PartRecording;
+    struct RenderedPart
+    {
+        QImage image;
+        QPoint textureOffset;
+    };
+
+    void recordPart(std::vector<PartRecording> &recordings, const QRegion &region, const QRectF &partRect, const QPoint &textureOffset, qreal devicePixelRatio, bool rotated = false);
+    std::optional<PartRecording> recordPartRect(const QRectF &rect, const QRectF &partRect, const QPoint &textureOffset, qreal devicePixelRatio, bool rotated);
+    static RenderedPart rasterizePart(const PartRecording &recording);
     static const QMargins texturePadForPart(const QRectF &rect, const QRectF &partRect);
     void resizeTexture();
+    void releaseTexture();
     int toNativeSize(double size) const;
-    std::unique_ptr<GLTexture> m_texture;
+    std::shared_ptr<GLTexture> m_texture;
+    QRect m_textureRect;
+    std::vector<RenderedPart> m_renderedParts;
+    QRegion m_deferredDamage;
+    bool m_rendering = false;
 };
 
 class SceneQPainterDecorationRenderer : public DecorationRenderer
@@ -8,6 +8,8 @@
 
 #include "opengl/gltexture.h"
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -28,8 +30,96 @@ void ImageItem::setImage(const QImage &image)
     scheduleRepaint(boundingRect());
 }
 
-ImageItemOpenGL::ImageItemOpenGL(Item *parent)
+// Hashing the pixels of an image this large costs about as much as uploading it
+static const qsizetype s_maxContentMatchedSize = 256 * 256 * 4;
+
+static size_t contentHash(const QImage &image)
+{
+    return qHashBits(image.constBits(), image.sizeInBytes(), qHashMulti(0, image.width(), image.height(), int(image.format())));
+}
+
+std::shared_ptr<GLTexture> ImageTextureCache::acquire(const QImage &image, std::shared_ptr<GLTexture> &&previous)
+{
+    if (std::shared_ptr<GLTexture> texture = m_keyed.value(image.cacheKey()).lock()) {
+        return texture;
+    }
+
+    if (image.sizeInBytes() <= s_maxContentMatchedSize) {
+        const auto it = m_contents.constFind(contentHash(image));
+        if (it != m_contents.constEnd()) {
+            for (const ContentEntry &entry : *it) {
+                if (entry.image == image) {
+                    if (std::shared_ptr<GLTexture> texture = entry.texture.lock()) {
+                        m_keyed[image.cacheKey()] = texture;
+                        return texture;
+                    }
+                }
+            }
+        }
+    }
+
+    prune();
+
+    std::shared_ptr<GLTexture> texture;
+    if (previous && previous.use_count() == 1 && previous->size() == image.size()) {
+        texture = std::move(previous);
+        remove(texture.get());
+        texture->update(image, image.rect());
+    } else {
+        texture = GLTexture::upload(image);
+        if (!texture) {
+            return nullptr;
+        }
+        texture->setFilter(GL_LINEAR);
+        texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    }
+    insert(image, texture);
+    return texture;
+}
+
+void ImageTextureCache::insert(const QImage &image, const std::shared_ptr<GLTexture> &texture)
+{
+    m_keyed[image.cacheKey()] = texture;
+    if (image.sizeInBytes() <= s_maxContentMatchedSize) {
+        m_contents[contentHash(image)].push_back(ContentEntry{
+            .image = image,
+            .texture = texture,
+        });
+    }
+}
+
+void ImageTextureCache::remove(const GLTexture *texture)
+{
+    // expired entries are dropped along the way
+    for (auto it = m_keyed.begin(); it != m_keyed.end();) {
+        const std::shared_ptr<GLTexture> candidate = it->lock();
+        if (!candidate || candidate.get() == texture) {
+            it = m_keyed.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_contents.begin(); it != m_contents.end();) {
+        std::erase_if(*it, [texture](const ContentEntry &entry) {
+            const std::shared_ptr<GLTexture> candidate = entry.texture.lock();
+            return !candidate || candidate.get() == texture;
+        });
+        if (it->empty()) {
+            it = m_contents.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ImageTextureCache::prune()
+{
+    remove(nullptr);
+}
+
+ImageItemOpenGL::ImageItemOpenGL(const std::shared_ptr<ImageTextureCache> &textureCache, Item *parent)
     : ImageItem(parent)
+    , m_textureCache(textureCache)
 {
 }
 
@@ -49,17 +139,7 @@ void ImageItemOpenGL::preprocess()
         m_textureKey = 0;
     } else if (m_textureKey != m_image.cacheKey()) {
         m_textureKey = m_image.cacheKey();
-
-        if (!m_texture || m_texture->size() != m_image.size()) {
-            m_texture = GLTexture::upload(m_image);
-            if (!m_texture) {
-                return;
-            }
-            m_texture->setFilter(GL_LINEAR);
-            m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-        } else {
-            m_texture->update(m_image, m_image.rect());
-        }
+        m_texture = m_textureCache->acquire(m_image, std::move(m_texture));
     }
 }
 
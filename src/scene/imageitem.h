@@ -8,8 +8,12 @@
 
 #include "scene/item.h"
 
+#include <QHash>
 #include <QImage>
 
+#include <memory>
+#include <vector>
+
 namespace KWin
 {
 
@@ -29,12 +33,43 @@ protected:
     QImage m_image;
 };
 
+/**
+ * The ImageTextureCache class lets image items that show the same image share one texture,
+ * e.g. the cursors on different outputs. Images are matched by their cache key, and small
+ * images by their contents as well, since the same cursor or icon is often decoded into
+ * several QImage objects.
+ */
+class ImageTextureCache
+{
+public:
+    /**
+     * Returns a texture with the contents of @a image. If @a previous is not shared with
+     * any other item and has the right size, it's updated in place instead of allocating
+     * a new texture.
+     */
+    std::shared_ptr<GLTexture> acquire(const QImage &image, std::shared_ptr<GLTexture> &&previous);
+
+private:
+    struct ContentEntry
+    {
+        QImage image;
+        std::weak_ptr<GLTexture> texture;
+    };
+
+    void insert(const QImage &image, const std::shared_ptr<GLTexture> &texture);
+    void remove(const GLTexture *texture);
+    void prune();
+
+    QHash<qint64, std::weak_ptr<GLTexture>> m_keyed;
+    QHash<size_t, std::vector<ContentEntry>> m_contents;
+};
+
 class ImageItemOpenGL : public ImageItem
 {
     Q_OBJECT
 
 public:
-    explicit ImageItemOpenGL(Item *parent = nullptr);
+    explicit ImageItemOpenGL(const std::shared_ptr<ImageTextureCache> &textureCache, Item *parent = nullptr);
     ~ImageItemOpenGL() override;
 
     GLTexture *texture() const;
@@ -44,7 +79,8 @@ protected:
     WindowQuadList buildQuads() const override;
 
 private:
-    std::unique_ptr<GLTexture> m_texture;
+    std::shared_ptr<ImageTextureCache> m_textureCache;
+    std::shared_ptr<GLTexture> m_texture;
     qint64 m_textureKey = 0;
 };
 
@@ -11,6 +11,8 @@
 #include "utils/common.h"
 #include "workspace.h"
 
+#include <QMetaMethod>
+
 namespace KWin
 {
 
@@ -106,7 +108,7 @@ void Item::setParentItem(Item *item)
     if (m_parentItem) {
         m_parentItem->addChild(this);
     }
-    updateItemToSceneTransform();
+    invalidateItemToSceneTransform();
     updateEffectiveVisibility();
 }
 
@@ -117,7 +119,7 @@ void Item::addChild(Item *item)
     m_childItems.append(item);
     markSortedChildItemsDirty();
 
-    updateBoundingRect();
+    invalidateBoundingRect();
     scheduleRepaint(item->transform().mapRect(item->boundingRect()).translated(item->position()));
 
     Q_EMIT childAdded(item);
@@ -131,7 +133,7 @@ void Item::removeChild(Item *item)
     m_childItems.removeOne(item);
     markSortedChildItemsDirty();
 
-    updateBoundingRect();
+    invalidateBoundingRect();
 
     Q_EMIT childRemoved(item);
 }
@@ -178,9 +180,9 @@ void Item::setPosition(const QPointF &point)
     if (m_position != point) {
         scheduleMoveRepaint(this);
         m_position = point;
-        updateItemToSceneTransform();
+        invalidateItemToSceneTransform();
         if (m_parentItem) {
-            m_parentItem->updateBoundingRect();
+            m_parentItem->invalidateBoundingRect();
         }
         scheduleMoveRepaint(this);
         Q_EMIT positionChanged();
@@ -197,7 +199,7 @@ void Item::setSize(const QSizeF &size)
     if (m_size != size) {
         scheduleRepaint(rect());
         m_size = size;
-        updateBoundingRect();
+        invalidateBoundingRect();
         scheduleRepaint(rect());
         discardQuads();
         Q_EMIT sizeChanged();
@@ -217,11 +219,33 @@ QRectF Item::rect() const
 
 QRectF Item::boundingRect() const
 {
+    if (m_boundingRectDirty) {
+        const_cast<Item *>(this)->updateBoundingRect();
+    }
     return m_boundingRect;
 }
 
+void Item::invalidateBoundingRect()
+{
+    static const QMetaMethod boundingRectChangedSignal = QMetaMethod::fromSignal(&Item::boundingRectChanged);
+
+    // If an item is dirty, so are its ancestors, unless they're observed. Observed items are
+    // resolved right away, the others only when their bounding rect is needed, so that moving
+    // many items doesn't recompute the bounding rects of their ancestors over and over again
+    for (Item *item = this; item; item = item->m_parentItem) {
+        if (item->m_boundingRectDirty) {
+            break;
+        }
+        item->m_boundingRectDirty = true;
+        if (item->isSignalConnected(boundingRectChangedSignal)) {
+            item->updateBoundingRect();
+        }
+    }
+}
+
 void Item::updateBoundingRect()
 {
+    m_boundingRectDirty = false;
     QRectF boundingRect = rect();
     for (Item *item : std::as_const(m_childItems)) {
         boundingRect |= item->transform().mapRect(item->boundingRect()).translated(item->position());
@@ -229,9 +253,6 @@ void Item::updateBoundingRect()
     if (m_boundingRect != boundingRect) {
         m_boundingRect = boundingRect;
         Q_EMIT boundingRectChanged();
-        if (m_parentItem) {
-            m_parentItem->updateBoundingRect();
-        }
     }
 }
 
@@ -257,27 +278,39 @@ void Item::setTransform(const QTransform &transform)
     }
     scheduleRepaint(boundingRect());
     m_transform = transform;
-    updateItemToSceneTransform();
+    invalidateItemToSceneTransform();
     if (m_parentItem) {
-        m_parentItem->updateBoundingRect();
+        m_parentItem->invalidateBoundingRect();
     }
     scheduleRepaint(boundingRect());
 }
 
-void Item::updateItemToSceneTransform()
+void Item::invalidateItemToSceneTransform()
+{
+    // the descendants of a dirty item are dirty too
+    if (m_itemToSceneTransformDirty) {
+        return;
+    }
+    m_itemToSceneTransformDirty = true;
+    for (Item *childItem : std::as_const(m_childItems)) {
+        childItem->invalidateItemToSceneTransform();
+    }
+}
+
+void Item::updateItemToSceneTransform() const
 {
     m_itemToSceneTransform = m_transform;
     if (!m_position.isNull()) {
         m_itemToSceneTransform *= QTransform::fromTranslate(m_position.x(), m_position.y());
     }
     if (m_parentItem) {
+        if (m_parentItem->m_itemToSceneTransformDirty) {
+            m_parentItem->updateItemToSceneTransform();
+        }
         m_itemToSceneTransform *= m_parentItem->m_itemToSceneTransform;
     }
     m_sceneToItemTransform = m_itemToSceneTransform.inverted();
-
-    for (Item *childItem : std::as_const(m_childItems)) {
-        childItem->updateItemToSceneTransform();
-    }
+    m_itemToSceneTransformDirty = false;
 }
 
 QRegion Item::mapToView(const QRegion &region, const RenderView *view) const
@@ -305,6 +338,9 @@ QRegion Item::mapToScene(const QRegion &region) const
     if (region.isEmpty()) {
         return QRegion();
     }
+    if (m_itemToSceneTransformDirty) {
+        updateItemToSceneTransform();
+    }
     return m_itemToSceneTransform.map(region);
 }
 
@@ -313,6 +349,9 @@ QRectF Item::mapToScene(const QRectF &rect) const
     if (rect.isEmpty()) {
         return QRect();
     }
+    if (m_itemToSceneTransformDirty) {
+        updateItemToSceneTransform();
+    }
     return m_itemToSceneTransform.mapRect(rect);
 }
 
@@ -321,6 +360,9 @@ QRectF Item::mapFromScene(const QRectF &rect) const
     if (rect.isEmpty()) {
         return QRect();
     }
+    if (m_itemToSceneTransformDirty) {
+        updateItemToSceneTransform();
+    }
     return m_sceneToItemTransform.mapRect(rect);
 }
 
@@ -523,6 +565,7 @@ WindowQuadList Item::buildQuads() const
 void Item::discardQuads()
 {
     m_quads.reset();
+    m_cachedGeometry.clear();
 }
 
 WindowQuadList Item::quads() const
@@ -533,12 +576,38 @@ WindowQuadList Item::quads() const
     return m_quads.value();
 }
 
+const Item::CachedGeometry *Item::cachedGeometry(qreal scale, const QMatrix4x4 &textureMatrix) const
+{
+    for (const CachedGeometry &geometry : m_cachedGeometry) {
+        if (geometry.scale == scale && geometry.textureMatrix == textureMatrix) {
+            return &geometry;
+        }
+    }
+    return nullptr;
+}
+
+const Item::CachedGeometry &Item::cacheGeometry(CachedGeometry &&geometry)
+{
+    // Keep the geometry for a couple of scales around, in case the item is shown on
+    // several outputs with different scale factors.
+    if (m_cachedGeometry.size() == m_cachedGeometry.capacity()) {
+        m_cachedGeometry.erase(m_cachedGeometry.begin());
+    }
+    m_cachedGeometry.append(std::move(geometry));
+    return m_cachedGeometry.constLast();
+}
+
 bool Item::hasRepaints(RenderView *view) const
 {
     const auto it = m_deviceRepaints.find(view);
     return it != m_deviceRepaints.end() && !it->isEmpty();
 }
 
+QRegion Item::deviceRepaints(RenderView *view) const
+{
+    return m_deviceRepaints.value(view);
+}
+
 QRegion Item::takeDeviceRepaints(RenderView *view)
 {
     auto &repaints = m_deviceRepaints[view];
@@ -571,6 +640,9 @@ void Item::setVisible(bool visible)
 {
     if (m_explicitVisible != visible) {
         m_explicitVisible = visible;
+        if (m_parentItem) {
+            m_parentItem->markPaintOrderDirty();
+        }
         updateEffectiveVisibility();
     }
 }
@@ -648,6 +720,58 @@ QList<Item *> Item::sortedChildItems() const
 void Item::markSortedChildItemsDirty()
 {
     m_sortedChildItems.reset();
+    markPaintOrderDirty();
+}
+
+QList<Item::PaintStep> Item::paintOrder() const
+{
+    if (!m_paintOrder.has_value()) {
+        QList<PaintStep> steps;
+        appendPaintSteps(steps);
+        m_paintOrder = steps;
+    }
+    return m_paintOrder.value();
+}
+
+void Item::appendPaintSteps(QList<PaintStep> &steps) const
+{
+    Item *self = const_cast<Item *>(this);
+    const qsizetype enter = steps.size();
+    steps.append(PaintStep{
+        .item = self,
+        .kind = PaintStep::Kind::Enter,
+    });
+
+    const QList<Item *> children = sortedChildItems();
+    auto it = children.begin();
+    for (; it != children.end() && (*it)->z() < 0; ++it) {
+        if ((*it)->explicitVisible()) {
+            (*it)->appendPaintSteps(steps);
+        }
+    }
+    steps.append(PaintStep{
+        .item = self,
+        .kind = PaintStep::Kind::Paint,
+    });
+    for (; it != children.end(); ++it) {
+        if ((*it)->explicitVisible()) {
+            (*it)->appendPaintSteps(steps);
+        }
+    }
+
+    steps[enter].leave = steps.size();
+    steps.append(PaintStep{
+        .item = self,
+        .kind = PaintStep::Kind::Leave,
+    });
+}
+
+void Item::markPaintOrderDirty()
+{
+    // the steps of every ancestor include the subtree of this item
+    for (Item *item = this; item; item = item->m_parentItem) {
+        item->m_paintOrder.reset();
+    }
 }
 
 const std::shared_ptr<ColorDescription> &Item::colorDescription() const
@@ -12,9 +12,11 @@
 #include "scene/itemgeometry.h"
 
 #include <QList>
+#include <QMatrix4x4>
 #include <QObject>
 #include <QPointer>
 #include <QTransform>
+#include <QVarLengthArray>
 
 #include <optional>
 
@@ -93,6 +95,31 @@ public:
     QList<Item *> childItems() const;
     QList<Item *> sortedChildItems() const;
 
+    /**
+     * One step of the walk over an item and its explicitly visible descendants in paint
+     * order. Every item is entered before its children, painted after the children with a
+     * negative z and left after the other children.
+     */
+    struct PaintStep
+    {
+        enum class Kind : quint8 {
+            Enter,
+            Paint,
+            Leave,
+        };
+        Item *item;
+        Kind kind;
+        // the index of the matching Leave step, for skipping the subtree of an entered item
+        qsizetype leave = 0;
+    };
+
+    /**
+     * Returns the steps to paint this item and its subtree, so renderers can walk the tree
+     * linearly instead of recursing through the children of every item. The steps are kept
+     * until children are added, removed, restacked or hidden anywhere in the subtree.
+     */
+    QList<PaintStep> paintOrder() const;
+
     QTransform transform() const;
     void setTransform(const QTransform &transform);
 
@@ -149,10 +176,32 @@ public:
     void scheduleRepaint(RenderView *delegate, const QRegion &region);
     void scheduleFrame();
     bool hasRepaints(RenderView *view) const;
+    QRegion deviceRepaints(RenderView *view) const;
     QRegion takeDeviceRepaints(RenderView *delegate);
     void resetRepaints(RenderView *delegate);
 
     WindowQuadList quads() const;
+
+    /**
+     * The render geometry built from the quads of this item for a given device scale and
+     * texture matrix. Renderers can cache it in the item to avoid rebuilding the vertices
+     * of items that haven't changed.
+     */
+    struct CachedGeometry
+    {
+        qreal scale = 1;
+        QMatrix4x4 textureMatrix;
+        RenderGeometry geometry;
+        QRectF deviceBounds;
+    };
+
+    /**
+     * Returns the cached geometry for the specified device @a scale and @a textureMatrix,
+     * or @c nullptr if there is none. The cache is dropped when the quads are discarded.
+     */
+    const CachedGeometry *cachedGeometry(qreal scale, const QMatrix4x4 &textureMatrix) const;
+    const CachedGeometry &cacheGeometry(CachedGeometry &&geometry);
+
     virtual void preprocess();
     const std::shared_ptr<ColorDescription> &colorDescription() const;
     RenderingIntent renderingIntent() const;
@@ -201,12 +250,16 @@ protected:
 private:
     void addChild(Item *item);
     void removeChild(Item *item);
+    void invalidateBoundingRect();
     void updateBoundingRect();
-    void updateItemToSceneTransform();
+    void invalidateItemToSceneTransform();
+    void updateItemToSceneTransform() const;
     void scheduleRepaintInternal(const QRegion &region);
     void scheduleRepaintInternal(RenderView *delegate, const QRegion &region);
     void scheduleSceneRepaintInternal(const QRegion &region);
     void markSortedChildItemsDirty();
+    void markPaintOrderDirty();
+    void appendPaintSteps(QList<PaintStep> &steps) const;
 
     bool computeEffectiveVisibility() const;
     void updateEffectiveVisibility();
@@ -218,9 +271,12 @@ private:
     QPointer<Item> m_parentItem;
     QList<Item *> m_childItems;
     QTransform m_transform;
-    QTransform m_itemToSceneTransform;
-    QTransform m_sceneToItemTransform;
+    // the transforms to and from the scene and the bounding rect are resolved on first use
+    mutable QTransform m_itemToSceneTransform;
+    mutable QTransform m_sceneToItemTransform;
+    mutable bool m_itemToSceneTransformDirty = false;
     QRectF m_boundingRect;
+    bool m_boundingRectDirty = false;
     QPointF m_position;
     QSizeF m_size = QSize(0, 0);
     BorderRadius m_borderRadius;
@@ -230,7 +286,9 @@ private:
     bool m_effectiveVisible = true;
     QMap<RenderView *, QRegion> m_deviceRepaints;
     mutable std::optional<WindowQuadList> m_quads;
+    QVarLengthArray<CachedGeometry, 2> m_cachedGeometry;
     mutable std::optional<QList<Item *>> m_sortedChildItems;
+    mutable std::optional<QList<PaintStep>> m_paintOrder;
     std::shared_ptr<ColorDescription> m_colorDescription = ColorDescription::sRGB;
     RenderingIntent m_renderingIntent = RenderingIntent::Perceptual;
     PresentationModeHint m_presentationHint = PresentationModeHint::VSync;
@@ -10,6 +10,9 @@
 
 #include <QMatrix4x4>
 
+#include <algorithm>
+#include <array>
+
 namespace KWin
 {
 
@@ -235,18 +238,51 @@ void RenderGeometry::appendWindowVertex(const WindowVertex &windowVertex, qreal
     append(glVertex);
 }
 
-void RenderGeometry::appendWindowQuad(const WindowQuad &quad, qreal deviceScale)
+void RenderGeometry::appendQuadVertices(const std::array<GLVertex2D, 4> &vertices)
 {
     // Geometry assumes we're rendering triangles, so add the quad's
     // vertices as two triangles. Vertex order is top-left, bottom-left,
     // top-right followed by top-right, bottom-left, bottom-right.
-    appendWindowVertex(quad[0], deviceScale);
-    appendWindowVertex(quad[3], deviceScale);
-    appendWindowVertex(quad[1], deviceScale);
+    const qsizetype offset = size();
+    resize(offset + 6);
+    GLVertex2D *triangles = data() + offset;
+    triangles[0] = vertices[0];
+    triangles[1] = vertices[3];
+    triangles[2] = vertices[1];
+    triangles[3] = vertices[1];
+    triangles[4] = vertices[3];
+    triangles[5] = vertices[2];
+}
+
+void RenderGeometry::appendWindowQuad(const WindowQuad &quad, qreal deviceScale)
+{
+    // Every corner is converted once, rather than once per triangle it belongs to
+    std::array<GLVertex2D, 4> vertices;
+    switch (m_vertexSnappingMode) {
+    case VertexSnappingMode::None:
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            vertices[i].position = QVector2D(quad[i].x(), quad[i].y()) * deviceScale;
+            vertices[i].texcoord = QVector2D(quad[i].u(), quad[i].v());
+        }
+        break;
+    case VertexSnappingMode::Round:
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            vertices[i].position = QVector2D(std::round(quad[i].x() * deviceScale), std::round(quad[i].y() * deviceScale));
+            vertices[i].texcoord = QVector2D(quad[i].u(), quad[i].v());
+        }
+        break;
+    }
+    appendQuadVertices(vertices);
+}
 
-    appendWindowVertex(quad[1], deviceScale);
-    appendWindowVertex(quad[3], deviceScale);
-    appendWindowVertex(quad[2], deviceScale);
+void RenderGeometry::appendWindowQuads(const WindowQuadList &quads, qreal deviceScale)
+{
+    reserve(size() + quads.count() * 6);
+    for (const WindowQuad &quad : quads) {
+        appendWindowQuad(quad, deviceScale);
+    }
 }
 
 void RenderGeometry::appendSubQuad(const WindowQuad &quad, const QRectF &subquad, qreal deviceScale)
@@ -277,13 +313,7 @@ void RenderGeometry::appendSubQuad(const WindowQuad &quad, const QRectF &subquad
         vertices[i].texcoord = QVector2D(u, v);
     }
 
-    append(vertices[0]);
-    append(vertices[3]);
-    append(vertices[1]);
-
-    append(vertices[1]);
-    append(vertices[3]);
-    append(vertices[2]);
+    appendQuadVertices(vertices);
 }
 
 void RenderGeometry::postProcessTextureCoordinates(const QMatrix4x4 &textureMatrix)
@@ -298,4 +328,110 @@ void RenderGeometry::postProcessTextureCoordinates(const QMatrix4x4 &textureMatr
     }
 }
 
+bool RenderGeometry::splitRoundedRect(const QRectF &box, const QVector4D &radius, RenderGeometry *interior, RenderGeometry *corners) const
+{
+    if (size() % 6 != 0) {
+        return false;
+    }
+    for (qsizetype i = 0; i < size(); i += 6) {
+        // top-left, bottom-left, top-right, top-right, bottom-left, bottom-right
+        const GLVertex2D *quad = data() + i;
+        if (quad[0].position.x() != quad[1].position.x() || quad[0].position.y() != quad[2].position.y()
+            || quad[5].position.x() != quad[2].position.x() || quad[5].position.y() != quad[1].position.y()
+            || quad[3].position != quad[2].position || quad[4].position != quad[1].position) {
+            return false;
+        }
+    }
+
+    const std::array<QRectF, 4> cornerRects{
+        QRectF(box.left(), box.top(), radius.x(), radius.x()),
+        QRectF(box.right() - radius.y(), box.top(), radius.y(), radius.y()),
+        QRectF(box.left(), box.bottom() - radius.z(), radius.z(), radius.z()),
+        QRectF(box.right() - radius.w(), box.bottom() - radius.w(), radius.w(), radius.w()),
+    };
+    const auto isInterior = [&box, &cornerRects](const QPointF &point) {
+        return box.contains(point) && std::ranges::none_of(cornerRects, [&point](const QRectF &corner) {
+            return !corner.isEmpty() && corner.contains(point);
+        });
+    };
+
+    for (qsizetype i = 0; i < size(); i += 6) {
+        const GLVertex2D *quad = data() + i;
+        const float left = quad[0].position.x();
+        const float top = quad[0].position.y();
+        const float right = quad[5].position.x();
+        const float bottom = quad[5].position.y();
+        if (left >= right || top >= bottom) {
+            continue;
+        }
+
+        // cut the quad along the edges of the box and of the corners, every cell is then
+        // either completely in the interior or not at all
+        QVarLengthArray<float, 8> xs{left, right};
+        QVarLengthArray<float, 8> ys{top, bottom};
+        const auto addCut = [](QVarLengthArray<float, 8> &cuts, float cut) {
+            if (cut > cuts[0] && cut < cuts[1] && !cuts.contains(cut)) {
+                cuts.append(cut);
+            }
+        };
+        addCut(xs, box.left());
+        addCut(xs, box.right());
+        addCut(ys, box.top());
+        addCut(ys, box.bottom());
+        for (const QRectF &corner : cornerRects) {
+            if (!corner.isEmpty()) {
+                addCut(xs, corner.left());
+                addCut(xs, corner.right());
+                addCut(ys, corner.top());
+                addCut(ys, corner.bottom());
+            }
+        }
+        std::sort(xs.begin(), xs.end());
+        std::sort(ys.begin(), ys.end());
+
+        const auto vertexAt = [&](float x, float y) {
+            const float s = (x - left) / (right - left);
+            const float t = (y - top) / (bottom - top);
+            return GLVertex2D{
+                .position = QVector2D(x, y),
+                .texcoord = (1 - s) * (1 - t) * quad[0].texcoord + s * (1 - t) * quad[2].texcoord
+                    + (1 - s) * t * quad[1].texcoord + s * t * quad[5].texcoord,
+            };
+        };
+        const auto appendCell = [&](RenderGeometry *geometry, float x1, float y1, float x2, float y2) {
+            if (x1 == left && y1 == top && x2 == right && y2 == bottom) {
+                for (int vertex = 0; vertex < 6; ++vertex) {
+                    geometry->append(quad[vertex]);
+                }
+                return;
+            }
+            const GLVertex2D topLeft = vertexAt(x1, y1);
+            const GLVertex2D bottomLeft = vertexAt(x1, y2);
+            const GLVertex2D topRight = vertexAt(x2, y1);
+            const GLVertex2D bottomRight = vertexAt(x2, y2);
+            geometry->append(topLeft);
+            geometry->append(bottomLeft);
+            geometry->append(topRight);
+            geometry->append(topRight);
+            geometry->append(bottomLeft);
+            geometry->append(bottomRight);
+        };
+
+        for (qsizetype row = 0; row + 1 < ys.size(); ++row) {
+            // merge the cells of a row that end up in the same geometry
+            qsizetype start = 0;
+            bool startInterior = isInterior(QPointF((xs[0] + xs[1]) / 2, (ys[row] + ys[row + 1]) / 2));
+            for (qsizetype column = 1; column <= xs.size() - 1; ++column) {
+                const bool cellInterior = column < xs.size() - 1 && isInterior(QPointF((xs[column] + xs[column + 1]) / 2, (ys[row] + ys[row + 1]) / 2));
+                if (column == xs.size() - 1 || cellInterior != startInterior) {
+                    appendCell(startInterior ? interior : corners, xs[start], ys[row], xs[column], ys[row + 1]);
+                    start = column;
+                    startInterior = cellInterior;
+                }
+            }
+        }
+    }
+    return true;
+}
+
 } // namespace KWin
@@ -9,6 +9,8 @@
 
 #include "opengl/glvertexbuffer.h"
 
+#include <array>
+
 namespace KWin
 {
 
@@ -171,6 +173,11 @@ public:
      *                    coordinates.
      */
     void appendWindowQuad(const WindowQuad &quad, qreal deviceScale);
+    /**
+     * Append all quads in @a quads as two triangles each, like `appendWindowQuad()`
+     * does. The storage is grown once for all of the quads.
+     */
+    void appendWindowQuads(const WindowQuadList &quads, qreal deviceScale);
     /**
      * Append a sub-quad of a WindowQuad as two triangles.
      *
@@ -198,8 +205,24 @@ public:
      *                      translation are used.
      */
     void postProcessTextureCoordinates(const QMatrix4x4 &textureMatrix);
+    /**
+     * Split this geometry into the parts that lie inside a rounded rect and don't touch any
+     * of its corners, and the rest.
+     *
+     * The parts in @a interior can be drawn as they are, only the parts in @a corners need
+     * to be clipped to the rounded rect. The geometry must consist of axis aligned quads, as
+     * `appendWindowQuad()` and `appendSubQuad()` produce them.
+     *
+     * @param box The rect, in the same coordinates as the vertices.
+     * @param radius The radii of the top-left, top-right, bottom-left and bottom-right corners.
+     * @returns false if the geometry is not made of axis aligned quads, the outputs are left
+     *          untouched then.
+     */
+    bool splitRoundedRect(const QRectF &box, const QVector4D &radius, RenderGeometry *interior, RenderGeometry *corners) const;
 
 private:
+    void appendQuadVertices(const std::array<GLVertex2D, 4> &vertices);
+
     VertexSnappingMode m_vertexSnappingMode = VertexSnappingMode::Round;
 };
 
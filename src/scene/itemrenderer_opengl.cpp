@@ -12,6 +12,7 @@
 #include "core/syncobjtimeline.h"
 #include "effect/effect.h"
 #include "opengl/eglnativefence.h"
+#include "opengl/glpassprofiler.h"
 #include "scene/decorationitem.h"
 #include "scene/imageitem.h"
 #include "scene/outlinedborderitem.h"
@@ -20,28 +21,47 @@
 #include "scene/workspacescene.h"
 #include "utils/common.h"
 
+#include <QScopeGuard>
+
+#include <algorithm>
+#include <cmath>
+
 namespace KWin
 {
 
 ItemRendererOpenGL::ItemRendererOpenGL(EglDisplay *eglDisplay)
     : m_eglDisplay(eglDisplay)
+    , m_imageTextureCache(std::make_shared<ImageTextureCache>())
 {
     const QString visualizeOptionsString = qEnvironmentVariable("KWIN_SCENE_VISUALIZE");
     if (!visualizeOptionsString.isEmpty()) {
         const QStringList visualtizeOptions = visualizeOptionsString.split(';');
         m_debug.fractionalEnabled = visualtizeOptions.contains(QLatin1StringView("fractional"));
     }
+    m_frontToBack.enabled = qEnvironmentVariableIntValue("KWIN_SCENE_FRONT_TO_BACK") == 1;
+}
+
+ItemRendererOpenGL::~ItemRendererOpenGL()
+{
+    if (m_frontToBack.depthBuffer && EglContext::currentContext()) {
+        glDeleteRenderbuffers(1, &m_frontToBack.depthBuffer);
+    }
 }
 
 std::unique_ptr<ImageItem> ItemRendererOpenGL::createImageItem(Item *parent)
 {
-    return std::make_unique<ImageItemOpenGL>(parent);
+    return std::make_unique<ImageItemOpenGL>(m_imageTextureCache, parent);
 }
 
 void ItemRendererOpenGL::beginFrame(const RenderTarget &renderTarget, const RenderViewport &viewport)
 {
     GLFramebuffer *fbo = renderTarget.framebuffer();
     GLFramebuffer::pushFramebuffer(fbo);
+    if (m_frontToBack.enabled) {
+        attachDepthBuffer(fbo);
+    }
+
+    m_statistics.frameAllocations = 0;
 
     GLVertexBuffer::streamingBuffer()->beginFrame();
 }
@@ -49,6 +69,7 @@ void ItemRendererOpenGL::beginFrame(const RenderTarget &renderTarget, const Rend
 void ItemRendererOpenGL::endFrame()
 {
     GLVertexBuffer::streamingBuffer()->endOfFrame();
+    detachDepthBuffer();
     GLFramebuffer::popFramebuffer();
 
     if (m_eglDisplay) {
@@ -82,6 +103,55 @@ void ItemRendererOpenGL::setBlendEnabled(bool enabled)
     m_blendingEnabled = enabled;
 }
 
+// The depth that every batch is moved by, in normalized device coordinates. It's coarse
+// enough for a 16 bit depth buffer, and still leaves room for thousands of batches.
+static const float s_depthStep = 1.0 / (1 << 14);
+
+void ItemRendererOpenGL::attachDepthBuffer(GLFramebuffer *framebuffer)
+{
+    // The default framebuffer can't get a depth attachment of our own
+    if (!framebuffer || framebuffer->handle() == 0) {
+        return;
+    }
+
+    if (m_frontToBack.size != framebuffer->size()) {
+        if (!m_frontToBack.depthBuffer) {
+            glGenRenderbuffers(1, &m_frontToBack.depthBuffer);
+        }
+        const auto context = EglContext::currentContext();
+        GLenum format = GL_DEPTH_COMPONENT24;
+        if (context->isOpenGLES() && !context->supportsGLES24BitDepthBuffers()) {
+            format = GL_DEPTH_COMPONENT16;
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, m_frontToBack.depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, format, framebuffer->size().width(), framebuffer->size().height());
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        m_frontToBack.size = framebuffer->size();
+    }
+
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_frontToBack.depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        qCWarning(KWIN_OPENGL) << "Could not attach a depth buffer, drawing back to front";
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0);
+        m_frontToBack.enabled = false;
+        return;
+    }
+
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    m_frontToBack.framebuffer = framebuffer;
+    m_frontToBack.nextDepth = 1 - s_depthStep;
+}
+
+void ItemRendererOpenGL::detachDepthBuffer()
+{
+    if (!m_frontToBack.framebuffer) {
+        return;
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0);
+    m_frontToBack.framebuffer = nullptr;
+}
+
 static RenderGeometry clipQuads(const Item *item, const ItemRendererOpenGL::RenderContext *context)
 {
     const WindowQuadList quads = item->quads();
@@ -119,117 +189,262 @@ static RenderGeometry clipQuads(const Item *item, const ItemRendererOpenGL::Rend
     return geometry;
 }
 
-void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter)
+/**
+ * Returns the geometry of the @a item in device coordinates, with the texture coordinates
+ * mapped by @a textureMatrix.
+ *
+ * The unclipped geometry is cached in the item until its quads are discarded. It's used
+ * as is if no clipping is needed or if the item lies completely within one of the clip
+ * rects, so the vertices of static items don't have to be rebuilt every frame.
+ */
+static RenderGeometry itemGeometry(Item *item, const ItemRendererOpenGL::RenderContext *context, const QMatrix4x4 &textureMatrix)
 {
-    bool hole = false;
-    if (filter && filter(item)) {
-        if (!holeFilter || !holeFilter(item)) {
-            return;
+    const qreal scale = context->renderTargetScale;
+
+    const Item::CachedGeometry *cached = item->cachedGeometry(scale, textureMatrix);
+    if (!cached) {
+        const WindowQuadList quads = item->quads();
+
+        Item::CachedGeometry entry{
+            .scale = scale,
+            .textureMatrix = textureMatrix,
+        };
+        entry.geometry.appendWindowQuads(quads, scale);
+        for (const WindowQuad &quad : quads) {
+            entry.deviceBounds |= snapToPixelGridF(scaledRect(quad.bounds(), scale));
         }
-        hole = true;
+        entry.geometry.postProcessTextureCoordinates(textureMatrix);
+
+        cached = &item->cacheGeometry(std::move(entry));
     }
-    const QList<Item *> sortedChildItems = item->sortedChildItems();
 
-    const auto logicalPosition = QVector2D(item->position().x(), item->position().y());
-    const auto scale = context->renderTargetScale;
+    if (context->deviceClip == infiniteRegion() || context->hardwareClipping) {
+        return cached->geometry;
+    }
 
-    QMatrix4x4 matrix;
-    matrix.translate(roundVector(logicalPosition * scale).toVector3D());
-    if (context->transformStack.size() == 1) {
-        matrix *= context->rootTransform;
+    const QPointF itemToDeviceTranslation = context->transformStack.top().map(QPointF(0., 0.)) - context->viewportOrigin;
+    const QRectF deviceBounds = cached->deviceBounds.translated(itemToDeviceTranslation);
+    if (!deviceBounds.intersects(context->deviceClip.boundingRect())) {
+        return RenderGeometry();
     }
-    if (!item->transform().isIdentity()) {
-        matrix.scale(scale, scale);
-        matrix *= item->transform();
-        matrix.scale(1 / scale, 1 / scale);
+    for (const QRect &deviceClipRect : std::as_const(context->deviceClip)) {
+        if (QRectF(deviceClipRect).contains(deviceBounds)) {
+            return cached->geometry;
+        }
     }
-    context->transformStack.push(context->transformStack.top() * matrix);
 
-    context->opacityStack.push(context->opacityStack.top() * item->opacity());
+    RenderGeometry geometry = clipQuads(item, context);
+    geometry.postProcessTextureCoordinates(textureMatrix);
+    return geometry;
+}
 
-    for (Item *childItem : sortedChildItems) {
-        if (childItem->z() >= 0) {
-            break;
-        }
-        if (childItem->explicitVisible()) {
-            createRenderNode(childItem, context, filter, holeFilter);
-        }
+/**
+ * Returns how many texels of the @a texture of the @a surfaceItem end up in one pixel of the
+ * render target along the horizontal axis.
+ */
+static qreal surfaceMinification(const SurfaceItem *surfaceItem, const GLTexture *texture, const ItemRendererOpenGL::RenderContext *context)
+{
+    const QMatrix4x4 &transform = context->transformStack.top();
+    const qreal deviceWidth = surfaceItem->size().width() * std::hypot(transform(0, 0), transform(1, 0));
+    if (deviceWidth <= 0) {
+        return 1;
     }
+    return texture->contentTransform().map(texture->size()).width() / deviceWidth;
+}
 
-    if (const BorderRadius radius = item->borderRadius(); !radius.isNull()) {
-        const QRectF nativeRect = snapToPixelGridF(scaledRect(item->rect(), context->renderTargetScale));
-        const BorderRadius nativeRadius = radius.scaled(context->renderTargetScale).rounded();
-        context->cornerStack.push({
-            .box = nativeRect,
-            .radius = nativeRadius,
-        });
-    } else if (!context->cornerStack.isEmpty()) {
-        const auto &top = std::as_const(context->cornerStack).top();
-        context->cornerStack.push({
-            .box = matrix.inverted().mapRect(top.box),
-            .radius = top.radius,
-        });
+/**
+ * Returns whether every texel of the @a surfaceItem ends up on exactly one pixel of the render
+ * target, as with clients that use a fractional scale and a viewport to provide buffers at the
+ * device resolution. Such surfaces look the same without any filtering.
+ */
+static bool isPixelExact(const SurfaceItem *surfaceItem, const ItemRendererOpenGL::RenderContext *context)
+{
+    const QMatrix4x4 &transform = context->transformStack.top();
+    if (!transform.isAffine() || transform(0, 0) != 1 || transform(1, 1) != 1 || transform(0, 1) != 0 || transform(1, 0) != 0) {
+        return false;
+    }
+    const QPointF translation(transform(0, 3), transform(1, 3));
+    if (translation != QPointF(std::round(translation.x()), std::round(translation.y()))) {
+        return false;
+    }
+    const QRectF sourceBox = surfaceItem->bufferSourceBox();
+    if (sourceBox.topLeft() != QPointF(std::round(sourceBox.x()), std::round(sourceBox.y()))) {
+        return false;
     }
+    return snapToPixelGridF(scaledRect(surfaceItem->rect(), context->renderTargetScale)).size() == sourceBox.size();
+}
 
-    item->preprocess();
+void ItemRendererOpenGL::createRenderNodes(Item *rootItem, RenderContext *context, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter)
+{
+    struct Level
+    {
+        QMatrix4x4 matrix;
+        bool hole = false;
+    };
+    QVarLengthArray<Level, 16> levels;
+
+    const QList<Item::PaintStep> steps = rootItem->paintOrder();
+    for (qsizetype i = 0; i < steps.size(); ++i) {
+        const Item::PaintStep &step = steps[i];
+        Item *item = step.item;
+        switch (step.kind) {
+        case Item::PaintStep::Kind::Enter: {
+            bool hole = false;
+            if (filter && filter(item)) {
+                if (!holeFilter || !holeFilter(item)) {
+                    i = step.leave;
+                    break;
+                }
+                hole = true;
+            }
 
-    RenderGeometry geometry = clipQuads(item, context);
+            const auto logicalPosition = QVector2D(item->position().x(), item->position().y());
+            const auto scale = context->renderTargetScale;
+
+            QMatrix4x4 matrix;
+            matrix.translate(roundVector(logicalPosition * scale).toVector3D());
+            if (context->transformStack.size() == 1) {
+                matrix *= context->rootTransform;
+            }
+            if (!item->transform().isIdentity()) {
+                matrix.scale(scale, scale);
+                matrix *= item->transform();
+                matrix.scale(1 / scale, 1 / scale);
+            }
+            context->transformStack.push(context->transformStack.top() * matrix);
+            context->opacityStack.push(context->opacityStack.top() * item->opacity());
+            levels.append(Level{
+                .matrix = matrix,
+                .hole = hole,
+            });
+            break;
+        }
+        case Item::PaintStep::Kind::Paint: {
+            // the children with a negative z are painted without the corners of the item
+            if (const BorderRadius radius = item->borderRadius(); !radius.isNull()) {
+                const QRectF nativeRect = snapToPixelGridF(scaledRect(item->rect(), context->renderTargetScale));
+                const BorderRadius nativeRadius = radius.scaled(context->renderTargetScale).rounded();
+                context->cornerStack.push({
+                    .box = nativeRect,
+                    .radius = nativeRadius,
+                });
+            } else if (!context->cornerStack.isEmpty()) {
+                const auto &top = std::as_const(context->cornerStack).top();
+                context->cornerStack.push({
+                    .box = levels.last().matrix.inverted().mapRect(top.box),
+                    .radius = top.radius,
+                });
+            }
+
+            item->preprocess();
+            createRenderNode(item, context, levels.last().hole);
+            break;
+        }
+        case Item::PaintStep::Kind::Leave:
+            context->transformStack.pop();
+            context->opacityStack.pop();
+            if (!context->cornerStack.isEmpty()) {
+                context->cornerStack.pop();
+            }
+            levels.removeLast();
+            break;
+        }
+    }
+}
 
+void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, bool hole)
+{
     if (auto shadowItem = qobject_cast<ShadowItem *>(item)) {
-        if (!geometry.isEmpty()) {
-            OpenGLShadowTextureProvider *textureProvider = static_cast<OpenGLShadowTextureProvider *>(shadowItem->textureProvider());
-            if (textureProvider->shadowTexture()) {
-                RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
+        OpenGLShadowTextureProvider *textureProvider = static_cast<OpenGLShadowTextureProvider *>(shadowItem->textureProvider());
+        if (textureProvider->shadowTexture()) {
+            const RenderGeometry geometry = itemGeometry(item, context, textureProvider->shadowTexture()->matrix(UnnormalizedCoordinates));
+            if (!geometry.isEmpty()) {
+                context->renderNodes.append(RenderNode{
                     .traits = ShaderTrait::MapTexture,
                     .textures = {textureProvider->shadowTexture()},
                     .geometry = geometry,
                     .transformMatrix = context->transformStack.top(),
                     .opacity = context->opacityStack.top(),
                     .hasAlpha = true,
-                    .colorDescription = item->colorDescription(),
+                    .colorDescription = &item->colorDescription(),
                     .renderingIntent = item->renderingIntent(),
                     .bufferReleasePoint = nullptr,
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(textureProvider->shadowTexture()->matrix(UnnormalizedCoordinates));
             }
         }
     } else if (auto decorationItem = qobject_cast<DecorationItem *>(item)) {
-        if (!geometry.isEmpty()) {
-            auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
-            if (renderer->texture()) {
-                RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
+        auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
+        if (renderer->texture()) {
+            const RenderGeometry geometry = itemGeometry(item, context, renderer->texture()->matrix(UnnormalizedCoordinates));
+            if (!geometry.isEmpty()) {
+                context->renderNodes.append(RenderNode{
                     .traits = ShaderTrait::MapTexture,
                     .textures = {renderer->texture()},
                     .geometry = geometry,
                     .transformMatrix = context->transformStack.top(),
                     .opacity = context->opacityStack.top(),
                     .hasAlpha = true,
-                    .colorDescription = item->colorDescription(),
+                    .colorDescription = &item->colorDescription(),
                     .renderingIntent = item->renderingIntent(),
                     .bufferReleasePoint = nullptr,
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(renderer->texture()->matrix(UnnormalizedCoordinates));
             }
         }
     } else if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
         auto texture = static_cast<OpenGLSurfaceTexture *>(surfaceItem->texture());
-        if (texture && texture->isValid()) {
+        if (texture && texture->solidColor()) {
+            const RenderGeometry geometry = itemGeometry(item, context, QMatrix4x4());
+            if (!geometry.isEmpty()) {
+                const QColor color = *texture->solidColor();
+                context->renderNodes.append(RenderNode{
+                    .traits = ShaderTrait::UniformColor,
+                    .geometry = geometry,
+                    .transformMatrix = context->transformStack.top(),
+                    .opacity = context->opacityStack.top(),
+                    .hasAlpha = color.alpha() != 255,
+                    .colorDescription = &item->colorDescription(),
+                    .renderingIntent = item->renderingIntent(),
+                    .bufferReleasePoint = surfaceItem->bufferReleasePoint(),
+                    .color = color,
+                    .paintHole = hole,
+                });
+            }
+        } else if (texture && texture->isValid()) {
+            const OpenGLSurfaceContents contents = texture->texture();
+            QVarLengthArray<GLTexture *, 4> textures = contents.toVarLengthArray();
+            QMatrix4x4 textureMatrix = textures[0]->matrix(UnnormalizedCoordinates);
+
+            // Sampling a texture that is drawn at less than half its size skips texels and
+            // aliases, e.g. in thumbnails of big windows. Draw a downscaled copy with mipmaps
+            // instead
+            if (surfaceMinification(surfaceItem, textures[0], context) >= 2) {
+                if (GLTexture *downscaled = texture->downscaledTexture()) {
+                    const QSize sourceSize = textures[0]->contentTransform().map(textures[0]->size());
+                    textureMatrix = downscaled->matrix(UnnormalizedCoordinates);
+                    textureMatrix.scale(qreal(downscaled->width()) / sourceSize.width(), qreal(downscaled->height()) / sourceSize.height());
+                    textures = {downscaled};
+                }
+            } else if (textures.count() == 1) {
+                // the filter is only applied when the texture is bound, hence right before drawing
+                textures[0]->setFilter(isPixelExact(surfaceItem, context) ? GL_NEAREST : GL_LINEAR);
+            }
+
+            const RenderGeometry geometry = itemGeometry(item, context, textureMatrix);
             if (!geometry.isEmpty()) {
                 RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
-                    .traits = texture->texture().planes.count() == 1 ? ShaderTrait::MapTexture : ShaderTrait::MapMultiPlaneTexture,
-                    .textures = texture->texture().toVarLengthArray(),
+                    .traits = textures.count() == 1 ? ShaderTrait::MapTexture : ShaderTrait::MapMultiPlaneTexture,
+                    .textures = textures,
                     .geometry = geometry,
                     .transformMatrix = context->transformStack.top(),
                     .opacity = context->opacityStack.top(),
                     .hasAlpha = surfaceItem->hasAlphaChannel(),
-                    .colorDescription = item->colorDescription(),
+                    .colorDescription = &item->colorDescription(),
                     .renderingIntent = item->renderingIntent(),
                     .bufferReleasePoint = surfaceItem->bufferReleasePoint(),
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(texture->texture().planes.at(0)->matrix(UnnormalizedCoordinates));
                 if (surfaceItem->colorDescription()->yuvCoefficients() != YUVMatrixCoefficients::Identity) {
                     renderNode.traits |= ShaderTrait::YuvConversion;
                 }
@@ -237,35 +452,51 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
                 if (!context->cornerStack.isEmpty()) {
                     const auto &top = context->cornerStack.top();
 
-                    renderNode.traits |= ShaderTrait::RoundedCorners;
-                    renderNode.hasAlpha = true;
-                    renderNode.box = QVector4D(top.box.x() + top.box.width() * 0.5,
-                                               top.box.y() + top.box.height() * 0.5,
-                                               top.box.width() * 0.5,
-                                               top.box.height() * 0.5),
-                    renderNode.borderRadius = top.radius.toVector();
+                    // Only the parts near the corners need the rounded corners shader, the
+                    // rest is drawn as it is and can still hide what is behind it
+                    RenderGeometry interior;
+                    RenderGeometry corners;
+                    const bool split = renderNode.geometry.splitRoundedRect(top.box, top.radius.toVector(), &interior, &corners) && !interior.isEmpty();
+                    if (!split || !corners.isEmpty()) {
+                        if (split) {
+                            renderNode.geometry = std::move(interior);
+                            RenderNode cornerNode = renderNode;
+                            cornerNode.geometry = std::move(corners);
+                            context->renderNodes.append(std::move(cornerNode));
+                        }
+
+                        RenderNode &roundedNode = context->renderNodes.last();
+                        roundedNode.traits |= ShaderTrait::RoundedCorners;
+                        roundedNode.hasAlpha = true;
+                        roundedNode.box = QVector4D(top.box.x() + top.box.width() * 0.5,
+                                                    top.box.y() + top.box.height() * 0.5,
+                                                    top.box.width() * 0.5,
+                                                    top.box.height() * 0.5);
+                        roundedNode.borderRadius = top.radius.toVector();
+                    }
                 }
             }
         }
     } else if (auto imageItem = qobject_cast<ImageItemOpenGL *>(item)) {
-        if (!geometry.isEmpty()) {
-            if (imageItem->texture()) {
-                RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
+        if (imageItem->texture()) {
+            const RenderGeometry geometry = itemGeometry(item, context, imageItem->texture()->matrix(UnnormalizedCoordinates));
+            if (!geometry.isEmpty()) {
+                context->renderNodes.append(RenderNode{
                     .traits = ShaderTrait::MapTexture,
                     .textures = {imageItem->texture()},
                     .geometry = geometry,
                     .transformMatrix = context->transformStack.top(),
                     .opacity = context->opacityStack.top(),
                     .hasAlpha = imageItem->image().hasAlphaChannel(),
-                    .colorDescription = item->colorDescription(),
+                    .colorDescription = &item->colorDescription(),
                     .renderingIntent = item->renderingIntent(),
                     .bufferReleasePoint = nullptr,
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(imageItem->texture()->matrix(UnnormalizedCoordinates));
             }
         }
     } else if (auto borderItem = qobject_cast<OutlinedBorderItem *>(item)) {
+        const RenderGeometry geometry = itemGeometry(item, context, QMatrix4x4());
         if (!geometry.isEmpty()) {
             const BorderOutline outline = borderItem->outline();
             const int thickness = std::round(outline.thickness() * context->renderTargetScale);
@@ -277,7 +508,7 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
                 .transformMatrix = context->transformStack.top(),
                 .opacity = context->opacityStack.top(),
                 .hasAlpha = true,
-                .colorDescription = borderItem->colorDescription(),
+                .colorDescription = &borderItem->colorDescription(),
                 .renderingIntent = borderItem->renderingIntent(),
                 .box = QVector4D(innerRect.x() + innerRect.width() * 0.5,
                                  innerRect.y() + innerRect.height() * 0.5,
@@ -291,24 +522,12 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
         }
     }
 
-    for (Item *childItem : sortedChildItems) {
-        if (childItem->z() < 0) {
-            continue;
-        }
-        if (childItem->explicitVisible()) {
-            createRenderNode(childItem, context, filter, holeFilter);
-        }
-    }
-
-    context->transformStack.pop();
-    context->opacityStack.pop();
-    if (!context->cornerStack.isEmpty()) {
-        context->cornerStack.pop();
-    }
 }
 
 void ItemRendererOpenGL::renderBackground(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &deviceRegion)
 {
+    GLPassScope passScope(u"background");
+
     const auto clipped = deviceRegion & renderTarget.transformedRect();
     if (clipped == renderTarget.transformedRect()) {
         glClearColor(0, 0, 0, 0);
@@ -328,25 +547,283 @@ void ItemRendererOpenGL::renderBackground(const RenderTarget &renderTarget, cons
     }
 }
 
+/**
+ * Returns the factors if the @a pipeline does nothing but multiply the encoded values, like
+ * between gamma 2.2 colors that only differ in brightness. The Modulate trait can take care of
+ * that without the color management shader.
+ */
+static std::optional<QVector3D> pipelineMultiplier(const ColorPipeline &pipeline)
+{
+    if (pipeline.ops.size() != 1) {
+        return std::nullopt;
+    }
+    if (const auto multiplier = std::get_if<ColorMultiplier>(&pipeline.ops.front().operation)) {
+        return multiplier->factors;
+    }
+    return std::nullopt;
+}
+
+ShaderTraits ItemRendererOpenGL::resolveShaderTraits(const RenderTarget &renderTarget, const WindowPaintData &data, const RenderNode &renderNode) const
+{
+    ShaderTraits traits = renderNode.traits;
+    if (renderNode.opacity != 1.0 || data.brightness() != 1.0) {
+        traits |= ShaderTrait::Modulate;
+    }
+    if (data.saturation() != 1.0) {
+        traits |= ShaderTrait::AdjustSaturation;
+    }
+    if (data.brightness() != 1.0 || data.saturation() != 1.0) {
+        // make sure that brightness and saturation adjustments are always applied in linear space
+        traits |= ShaderTrait::TransformColorspace;
+    } else {
+        const auto conversion = ColorConversionCache::lookup(*renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
+        if (pipelineMultiplier(conversion->pipeline)) {
+            traits |= ShaderTrait::Modulate;
+        } else if (!conversion->pipeline.isIdentity()) {
+            traits |= ShaderTrait::TransformColorspace;
+        }
+    }
+
+    if (renderNode.paintHole) {
+        traits = (traits & ShaderTrait::RoundedCorners) | ShaderTrait::UniformColor;
+    }
+
+    return traits;
+}
+
+/**
+ * Returns the color that a node with the UniformColor trait is filled with. Holes are punched
+ * with opaque black.
+ */
+static QColor uniformColor(const ItemRendererOpenGL::RenderNode &renderNode)
+{
+    return renderNode.paintHole ? QColor(0, 0, 0, 255) : renderNode.color;
+}
+
+static bool canBatch(const ItemRendererOpenGL::RenderNode &previous, const ItemRendererOpenGL::RenderNode &next)
+{
+    if (previous.paintHole != next.paintHole) {
+        return false;
+    }
+    if (!next.paintHole && previous.textures != next.textures) {
+        return false;
+    }
+    return previous.transformMatrix == next.transformMatrix
+        && previous.opacity == next.opacity
+        && (previous.hasAlpha || previous.opacity < 1.0) == (next.hasAlpha || next.opacity < 1.0)
+        && *previous.colorDescription == *next.colorDescription
+        && previous.renderingIntent == next.renderingIntent
+        && previous.box == next.box
+        && previous.borderRadius == next.borderRadius
+        && previous.borderThickness == next.borderThickness
+        && previous.borderColor == next.borderColor
+        && previous.color == next.color;
+}
+
+void ItemRendererOpenGL::batchRenderNodes(const RenderTarget &renderTarget, const WindowPaintData &data, RenderContext *renderContext) const
+{
+    QList<RenderBatch> &batches = renderContext->batches;
+
+    for (int i = 0; i < renderContext->renderNodes.count(); ++i) {
+        const RenderNode &renderNode = renderContext->renderNodes[i];
+        if (renderNode.vertexCount == 0) {
+            continue;
+        }
+
+        const ShaderTraits traits = resolveShaderTraits(renderTarget, data, renderNode);
+        if (!batches.isEmpty()) {
+            RenderBatch &previous = batches.last();
+            // The vertices of the render nodes are laid out in the same order as the nodes,
+            // so the vertices of consecutive nodes with identical state are contiguous.
+            if (previous.traits == traits
+                && previous.firstVertex + previous.vertexCount == renderNode.firstVertex
+                && canBatch(renderContext->renderNodes[previous.node], renderNode)) {
+                previous.vertexCount += renderNode.vertexCount;
+                continue;
+            }
+        }
+
+        batches.append(RenderBatch{
+            .traits = traits,
+            .node = i,
+            .firstVertex = renderNode.firstVertex,
+            .vertexCount = renderNode.vertexCount,
+        });
+    }
+}
+
+std::unique_ptr<ItemRendererOpenGL::RenderContext> ItemRendererOpenGL::acquireRenderContext()
+{
+    if (m_renderContextPool.empty()) {
+        ++m_statistics.frameAllocations;
+        ++m_statistics.totalAllocations;
+        return std::make_unique<RenderContext>();
+    }
+    std::unique_ptr<RenderContext> renderContext = std::move(m_renderContextPool.back());
+    m_renderContextPool.pop_back();
+    return renderContext;
+}
+
+void ItemRendererOpenGL::releaseRenderContext(std::unique_ptr<RenderContext> &&renderContext)
+{
+    // Only drop the contents, the lists keep their capacity
+    renderContext->renderNodes.clear();
+    renderContext->batches.clear();
+    renderContext->transformStack.clear();
+    renderContext->opacityStack.clear();
+    renderContext->cornerStack.clear();
+    renderContext->deviceClip = QRegion();
+    m_renderContextPool.push_back(std::move(renderContext));
+}
+
+ItemRendererOpenGL::Statistics ItemRendererOpenGL::statistics() const
+{
+    return m_statistics;
+}
+
+void ItemRendererOpenGL::drawBatch(const RenderTarget &renderTarget, const WindowPaintData &data, const RenderContext &renderContext, const RenderBatch &batch, const QRegion &scissorRegion, std::optional<float> depth, DrawState *state)
+{
+    const RenderNode &renderNode = renderContext.renderNodes[batch.node];
+    const ShaderTraits traits = batch.traits;
+
+    if (renderNode.paintHole != state->holeBlending) {
+        state->holeBlending = renderNode.paintHole;
+        if (state->holeBlending) {
+            glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        } else {
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        }
+    }
+    setBlendEnabled(renderNode.paintHole || renderNode.hasAlpha || renderNode.opacity < 1.0);
+
+    GLShader *shader = state->shader;
+    if (!shader || traits != state->traits) {
+        state->traits = traits;
+        state->lastNode = nullptr;
+        if (shader) {
+            ShaderManager::instance()->popShader();
+        }
+        shader = ShaderManager::instance()->pushShader(traits);
+        state->shader = shader;
+        if (traits & ShaderTrait::AdjustSaturation) {
+            const auto toXYZ = renderTarget.colorDescription()->containerColorimetry().toXYZ();
+            shader->setUniform(GLShader::FloatUniform::Saturation, data.saturation());
+            shader->setUniform(GLShader::Vec3Uniform::PrimaryBrightness, QVector3D(toXYZ(1, 0), toXYZ(1, 1), toXYZ(1, 2)));
+        }
+
+        if (traits & ShaderTrait::MapTexture) {
+            shader->setUniform(GLShader::IntUniform::Sampler, 0);
+        } else if (traits & ShaderTrait::MapMultiPlaneTexture) {
+            shader->setUniform(GLShader::IntUniform::Sampler, 0);
+            shader->setUniform(GLShader::IntUniform::Sampler1, 1);
+        }
+    }
+
+    // Uniforms keep their values as long as the shader stays bound, so only upload
+    // the ones that differ from the previously drawn node.
+    const RenderNode *lastNode = state->lastNode;
+    if (depth) {
+        // Replace the depth with a constant one, the w component is kept so that the
+        // depth stays the same after the perspective division
+        QMatrix4x4 depthMatrix;
+        depthMatrix.setRow(2, QVector4D(0, 0, 0, *depth));
+        shader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, depthMatrix * renderContext.projectionMatrix * renderNode.transformMatrix);
+    } else if (!lastNode || lastNode->transformMatrix != renderNode.transformMatrix) {
+        shader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
+    }
+    const bool colorChanged = !lastNode || *lastNode->colorDescription != *renderNode.colorDescription || lastNode->renderingIntent != renderNode.renderingIntent;
+    if ((traits & ShaderTrait::Modulate) && (!lastNode || lastNode->opacity != renderNode.opacity || colorChanged)) {
+        QVector4D modulation = modulate(renderNode.opacity, data.brightness());
+        if (!(traits & ShaderTrait::TransformColorspace)) {
+            const auto conversion = ColorConversionCache::lookup(*renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
+            if (const auto factors = pipelineMultiplier(conversion->pipeline)) {
+                modulation *= QVector4D(*factors, 1);
+            }
+        }
+        shader->setUniform(GLShader::Vec4Uniform::ModulationConstant, modulation);
+    }
+    if ((traits & ShaderTrait::TransformColorspace) && colorChanged) {
+        shader->setColorspaceUniforms(*renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
+    }
+    if ((traits & ShaderTrait::YuvConversion) && colorChanged) {
+        shader->setUniform(GLShader::Mat4Uniform::YuvToRgb, (*renderNode.colorDescription)->yuvMatrix());
+    }
+    if ((traits & (ShaderTrait::RoundedCorners | ShaderTrait::Border)) && (!lastNode || lastNode->box != renderNode.box || lastNode->borderRadius != renderNode.borderRadius)) {
+        shader->setUniform(GLShader::Vec4Uniform::Box, renderNode.box);
+        shader->setUniform(GLShader::Vec4Uniform::CornerRadius, renderNode.borderRadius);
+    }
+    if ((traits & ShaderTrait::Border) && (!lastNode || lastNode->borderThickness != renderNode.borderThickness || lastNode->borderColor != renderNode.borderColor)) {
+        shader->setUniform(GLShader::IntUniform::Thickness, renderNode.borderThickness);
+        shader->setUniform(GLShader::ColorUniform::Color, renderNode.borderColor);
+    }
+    if ((traits & ShaderTrait::UniformColor) && (!lastNode || uniformColor(*lastNode) != uniformColor(renderNode))) {
+        shader->setUniform(GLShader::ColorUniform::Color, uniformColor(renderNode));
+    }
+    state->lastNode = &renderNode;
+
+    if (!renderNode.paintHole) {
+        QVarLengthArray<GLTexture *, 4> &boundTextures = state->boundTextures;
+        for (int i = 0; i < renderNode.textures.count(); ++i) {
+            if (i < boundTextures.count() && boundTextures[i] == renderNode.textures[i]) {
+                continue;
+            }
+            glActiveTexture(GL_TEXTURE0 + i);
+            renderNode.textures[i]->bind();
+            if (i < boundTextures.count()) {
+                boundTextures[i] = renderNode.textures[i];
+            } else {
+                boundTextures.append(renderNode.textures[i]);
+            }
+        }
+    }
+
+    GLVertexBuffer::streamingBuffer()->draw(scissorRegion, GL_TRIANGLES, batch.firstVertex,
+                                            batch.vertexCount, renderContext.hardwareClipping);
+}
+
 void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const RenderViewport &viewport, Item *item, int mask, const QRegion &deviceRegion, const WindowPaintData &data, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter)
 {
     if (deviceRegion.isEmpty()) {
         return;
     }
 
-    RenderContext renderContext{
-        .projectionMatrix = viewport.projectionMatrix(),
-        .rootTransform = data.toMatrix(viewport.scale()), // TODO: unify transforms
-        .deviceClip = deviceRegion & renderTarget.transformedRect(),
-        .hardwareClipping = deviceRegion != infiniteRegion() && ((mask & Scene::PAINT_WINDOW_TRANSFORMED) || (mask & Scene::PAINT_SCREEN_TRANSFORMED)),
-        .renderTargetScale = viewport.scale(),
-        .viewportOrigin = viewport.deviceRenderRect().topLeft(),
+    std::unique_ptr<RenderContext> context = acquireRenderContext();
+    const auto releaseContext = qScopeGuard([this, &context]() {
+        releaseRenderContext(std::move(context));
+    });
+
+    RenderContext &renderContext = *context;
+    renderContext.projectionMatrix = viewport.projectionMatrix();
+    renderContext.rootTransform = data.toMatrix(viewport.scale()); // TODO: unify transforms
+    renderContext.deviceClip = deviceRegion & renderTarget.transformedRect();
+    renderContext.hardwareClipping = deviceRegion != infiniteRegion() && ((mask & Scene::PAINT_WINDOW_TRANSFORMED) || (mask & Scene::PAINT_SCREEN_TRANSFORMED));
+    renderContext.renderTargetScale = viewport.scale();
+    renderContext.viewportOrigin = viewport.deviceRenderRect().topLeft();
+
+    const qsizetype capacities[] = {
+        renderContext.renderNodes.capacity(),
+        renderContext.transformStack.capacity(),
+        renderContext.opacityStack.capacity(),
+        renderContext.cornerStack.capacity(),
     };
 
     renderContext.transformStack.push(QMatrix4x4());
     renderContext.opacityStack.push(data.opacity());
 
-    createRenderNode(item, &renderContext, filter, holeFilter);
+    createRenderNodes(item, &renderContext, filter, holeFilter);
+
+    const qsizetype grownCapacities[] = {
+        renderContext.renderNodes.capacity(),
+        renderContext.transformStack.capacity(),
+        renderContext.opacityStack.capacity(),
+        renderContext.cornerStack.capacity(),
+    };
+    for (size_t i = 0; i < std::size(capacities); ++i) {
+        if (grownCapacities[i] != capacities[i]) {
+            ++m_statistics.frameAllocations;
+            ++m_statistics.totalAllocations;
+        }
+    }
 
     int totalVertexCount = 0;
     for (const RenderNode &node : std::as_const(renderContext.renderNodes)) {
@@ -389,98 +866,67 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         scissorRegion = viewport.transform().map(deviceRegion & renderTarget.transformedRect(), renderTarget.transformedSize());
     }
 
-    ShaderTraits lastTraits;
-    GLShader *shader = nullptr;
-    for (int i = 0; i < renderContext.renderNodes.count(); i++) {
-        const RenderNode &renderNode = renderContext.renderNodes[i];
-
-        ShaderTraits traits = renderNode.traits;
-        if (renderNode.opacity != 1.0 || data.brightness() != 1.0) {
-            traits |= ShaderTrait::Modulate;
-        }
-        if (data.saturation() != 1.0) {
-            traits |= ShaderTrait::AdjustSaturation;
-        }
-        if (data.brightness() != 1.0 || data.saturation() != 1.0) {
-            // make sure that brightness and saturation adjustments are always applied in linear space
-            traits |= ShaderTrait::TransformColorspace;
-        } else {
-            const auto colorTransformation = ColorPipeline::create(renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
-            if (!colorTransformation.isIdentity()) {
-                traits |= ShaderTrait::TransformColorspace;
-            }
-        }
-
-        if (renderNode.paintHole) {
-            traits = (traits & ShaderTrait::RoundedCorners) | ShaderTrait::UniformColor;
-            glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            setBlendEnabled(true);
-        } else {
-            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-            setBlendEnabled(renderNode.hasAlpha || renderNode.opacity < 1.0);
+    for (const RenderNode &renderNode : std::as_const(renderContext.renderNodes)) {
+        if (renderNode.bufferReleasePoint && std::ranges::find(m_releasePoints, renderNode.bufferReleasePoint) == m_releasePoints.end()) {
+            m_releasePoints.push_back(renderNode.bufferReleasePoint);
         }
+    }
 
-        if (!shader || traits != lastTraits) {
-            lastTraits = traits;
-            if (shader) {
-                ShaderManager::instance()->popShader();
-            }
-            shader = ShaderManager::instance()->pushShader(traits);
-            if (traits & ShaderTrait::AdjustSaturation) {
-                const auto toXYZ = renderTarget.colorDescription()->containerColorimetry().toXYZ();
-                shader->setUniform(GLShader::FloatUniform::Saturation, data.saturation());
-                shader->setUniform(GLShader::Vec3Uniform::PrimaryBrightness, QVector3D(toXYZ(1, 0), toXYZ(1, 1), toXYZ(1, 2)));
-            }
+    const qsizetype batchCapacity = renderContext.batches.capacity();
+    batchRenderNodes(renderTarget, data, &renderContext);
+    if (renderContext.batches.capacity() != batchCapacity) {
+        ++m_statistics.frameAllocations;
+        ++m_statistics.totalAllocations;
+    }
 
-            if (traits & ShaderTrait::MapTexture) {
-                shader->setUniform(GLShader::IntUniform::Sampler, 0);
-            } else if (traits & ShaderTrait::MapMultiPlaneTexture) {
-                shader->setUniform(GLShader::IntUniform::Sampler, 0);
-                shader->setUniform(GLShader::IntUniform::Sampler1, 1);
+    DrawState state;
+    const int batchCount = renderContext.batches.count();
+    // Effects can render the item into framebuffers of their own, those have no depth buffer
+    const bool frontToBack = m_frontToBack.framebuffer
+        && GLFramebuffer::currentFramebuffer() == m_frontToBack.framebuffer
+        && m_frontToBack.nextDepth - batchCount * s_depthStep > -1;
+    if (frontToBack) {
+        const auto isOpaque = [&renderContext](const RenderBatch &batch) {
+            const RenderNode &renderNode = renderContext.renderNodes[batch.node];
+            return !renderNode.paintHole && !renderNode.hasAlpha && renderNode.opacity >= 1.0;
+        };
+        const float firstDepth = m_frontToBack.nextDepth;
+        m_frontToBack.nextDepth -= batchCount * s_depthStep;
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        for (int i = batchCount - 1; i >= 0; --i) {
+            const RenderBatch &batch = renderContext.batches[i];
+            if (isOpaque(batch)) {
+                drawBatch(renderTarget, data, renderContext, batch, scissorRegion, firstDepth - i * s_depthStep, &state);
             }
         }
-        shader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
-        if (traits & ShaderTrait::Modulate) {
-            shader->setUniform(GLShader::Vec4Uniform::ModulationConstant, modulate(renderNode.opacity, data.brightness()));
-        }
-        if (traits & ShaderTrait::TransformColorspace) {
-            shader->setColorspaceUniforms(renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
-        }
-        if (traits & ShaderTrait::YuvConversion) {
-            shader->setUniform(GLShader::Mat4Uniform::YuvToRgb, renderNode.colorDescription->yuvMatrix());
-        }
-        if (traits & ShaderTrait::RoundedCorners) {
-            shader->setUniform(GLShader::Vec4Uniform::Box, renderNode.box);
-            shader->setUniform(GLShader::Vec4Uniform::CornerRadius, renderNode.borderRadius);
-        }
-        if (traits & ShaderTrait::Border) {
-            shader->setUniform(GLShader::Vec4Uniform::Box, renderNode.box);
-            shader->setUniform(GLShader::Vec4Uniform::CornerRadius, renderNode.borderRadius);
-            shader->setUniform(GLShader::IntUniform::Thickness, renderNode.borderThickness);
-            shader->setUniform(GLShader::ColorUniform::Color, renderNode.borderColor);
+        // The translucent batches are blended in stacking order, the parts that are covered
+        // by opaque batches above them are still rejected
+        glDepthMask(GL_FALSE);
+        for (int i = 0; i < batchCount; ++i) {
+            const RenderBatch &batch = renderContext.batches[i];
+            if (!isOpaque(batch)) {
+                drawBatch(renderTarget, data, renderContext, batch, scissorRegion, firstDepth - i * s_depthStep, &state);
+            }
         }
-        if (renderNode.paintHole) {
-            shader->setUniform(GLShader::ColorUniform::Color, QColor(0, 0, 0, 255));
-        }
-
-        for (int i = 0; i < renderNode.textures.count() && !renderNode.paintHole; ++i) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            renderNode.textures[i]->bind();
-        }
-
-        vbo->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
-                  renderNode.vertexCount, renderContext.hardwareClipping);
-
-        for (int i = 0; i < renderNode.textures.count() && !renderNode.paintHole; ++i) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            renderNode.textures[i]->unbind();
+        glDepthMask(GL_TRUE);
+        glDisable(GL_DEPTH_TEST);
+    } else {
+        for (const RenderBatch &batch : std::as_const(renderContext.batches)) {
+            drawBatch(renderTarget, data, renderContext, batch, scissorRegion, std::nullopt, &state);
         }
+    }
 
-        if (renderNode.bufferReleasePoint) {
-            m_releasePoints.insert(renderNode.bufferReleasePoint);
-        }
+    for (int i = 0; i < state.boundTextures.count(); ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        state.boundTextures[i]->unbind();
+    }
+    if (state.holeBlending) {
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     }
-    if (shader) {
+    if (state.shader) {
         // some other code assumes texture 0 is active
         glActiveTexture(GL_TEXTURE0);
         ShaderManager::instance()->popShader();
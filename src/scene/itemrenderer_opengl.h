@@ -10,12 +10,15 @@
 #include "scene/itemrenderer.h"
 #include "scene/surfaceitem.h"
 
-#include <unordered_set>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace KWin
 {
 
 class EglDisplay;
+class ImageTextureCache;
 
 class KWIN_EXPORT ItemRendererOpenGL : public ItemRenderer
 {
@@ -30,37 +33,68 @@ public:
         int vertexCount = 0;
         qreal opacity = 1;
         bool hasAlpha = false;
-        std::shared_ptr<ColorDescription> colorDescription;
+        // Points to the description held by the item, which outlives the frame, so that
+        // building the render nodes doesn't touch reference counts.
+        const std::shared_ptr<ColorDescription> *colorDescription = nullptr;
         RenderingIntent renderingIntent;
         std::shared_ptr<SyncReleasePoint> bufferReleasePoint;
         QVector4D box;
         QVector4D borderRadius;
         int borderThickness = 0;
         QColor borderColor;
+        // the premultiplied fill of nodes with the UniformColor trait
+        QColor color;
         bool paintHole = false;
     };
 
+    /**
+     * A run of consecutive render nodes that can be drawn with a single draw call. The
+     * state is taken from the first node in the run.
+     */
+    struct RenderBatch
+    {
+        ShaderTraits traits;
+        int node = 0;
+        int firstVertex = 0;
+        int vertexCount = 0;
+    };
+
     struct RenderCorner
     {
         QRectF box;
         BorderRadius radius;
     };
 
+    /**
+     * The state that is used while rendering an item. Render contexts are recycled by the
+     * renderer with their storage, so that no memory is allocated in the steady state.
+     */
     struct RenderContext
     {
         QList<RenderNode> renderNodes;
+        QList<RenderBatch> batches;
         QStack<QMatrix4x4> transformStack;
         QStack<qreal> opacityStack;
         QStack<RenderCorner> cornerStack;
-        const QMatrix4x4 projectionMatrix;
-        const QMatrix4x4 rootTransform;
-        const QRegion deviceClip;
-        const bool hardwareClipping;
-        const qreal renderTargetScale;
-        const QPointF viewportOrigin;
+        QMatrix4x4 projectionMatrix;
+        QMatrix4x4 rootTransform;
+        QRegion deviceClip;
+        bool hardwareClipping = false;
+        qreal renderTargetScale = 1;
+        QPointF viewportOrigin;
+    };
+
+    struct Statistics
+    {
+        /**
+         * The number of times the storage of render contexts had to grow in the last frame.
+         */
+        int frameAllocations = 0;
+        qint64 totalAllocations = 0;
     };
 
     ItemRendererOpenGL(EglDisplay *eglDisplay);
+    ~ItemRendererOpenGL() override;
 
     void beginFrame(const RenderTarget &renderTarget, const RenderViewport &viewport) override;
     void endFrame() override;
@@ -70,15 +104,54 @@ public:
 
     std::unique_ptr<ImageItem> createImageItem(Item *parent = nullptr) override;
 
+    Statistics statistics() const;
+
 private:
+    /**
+     * The GL state that is tracked while the batches of a render context are drawn.
+     */
+    struct DrawState
+    {
+        ShaderTraits traits;
+        GLShader *shader = nullptr;
+        const RenderNode *lastNode = nullptr;
+        bool holeBlending = false;
+        QVarLengthArray<GLTexture *, 4> boundTextures;
+    };
+
     QVector4D modulate(float opacity, float brightness) const;
     void setBlendEnabled(bool enabled);
-    void createRenderNode(Item *item, RenderContext *context, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter);
+    ShaderTraits resolveShaderTraits(const RenderTarget &renderTarget, const WindowPaintData &data, const RenderNode &renderNode) const;
+    void batchRenderNodes(const RenderTarget &renderTarget, const WindowPaintData &data, RenderContext *renderContext) const;
+    std::unique_ptr<RenderContext> acquireRenderContext();
+    void releaseRenderContext(std::unique_ptr<RenderContext> &&renderContext);
+    void createRenderNodes(Item *rootItem, RenderContext *context, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter);
+    void createRenderNode(Item *item, RenderContext *context, bool hole);
+    void attachDepthBuffer(GLFramebuffer *framebuffer);
+    void detachDepthBuffer();
+    void drawBatch(const RenderTarget &renderTarget, const WindowPaintData &data, const RenderContext &renderContext, const RenderBatch &batch, const QRegion &scissorRegion, std::optional<float> depth, DrawState *state);
     void visualizeFractional(const RenderViewport &viewport, const QRegion &logicalRegion, const RenderContext &renderContext);
 
     bool m_blendingEnabled = false;
     EglDisplay *const m_eglDisplay;
-    std::unordered_set<std::shared_ptr<SyncReleasePoint>> m_releasePoints;
+    const std::shared_ptr<ImageTextureCache> m_imageTextureCache;
+    std::vector<std::shared_ptr<SyncReleasePoint>> m_releasePoints;
+    std::vector<std::unique_ptr<RenderContext>> m_renderContextPool;
+    Statistics m_statistics;
+
+    /**
+     * Opaque render nodes are drawn front to back with the depth test enabled before the
+     * translucent ones, so the fragments that end up covered are rejected early. Every
+     * batch in the frame gets its own depth, later batches being closer to the viewer.
+     */
+    struct
+    {
+        bool enabled = false;
+        GLuint depthBuffer = 0;
+        QSize size;
+        GLFramebuffer *framebuffer = nullptr;
+        float nextDepth = 1;
+    } m_frontToBack;
 
     struct
     {
@@ -12,16 +12,75 @@
 #include "scene/imageitem.h"
 #include "scene/surfaceitem.h"
 #include "scene/workspacescene.h"
+#include "utils/softwareblend.h"
 #include "window.h"
 
-#include <QPainter>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <array>
 
 namespace KWin
 {
 
+/**
+ * Draws the @a source rect of the @a image to the @a target rect in logical coordinates
+ * without QPainter, if the image only has to be moved by whole pixels. Returns false if the
+ * image has to be drawn by QPainter.
+ */
+static bool blitImage(QPainter *painter, const QRectF &target, const QImage &image, const QRectF &source)
+{
+    if (painter->device()->devType() != QInternal::Image || painter->compositionMode() != QPainter::CompositionMode_SourceOver) {
+        return false;
+    }
+    QImage *device = static_cast<QImage *>(painter->device());
+    if (!canBlendImage(device->format()) || !canBlendImage(image.format()) || device->devicePixelRatio() != 1) {
+        return false;
+    }
+    const QTransform transform = painter->combinedTransform();
+    if (transform.type() > QTransform::TxTranslate || target.size() != source.size()) {
+        return false;
+    }
+    const QRect sourceRect = source.toRect();
+    const QPointF deviceTopLeft = transform.map(target.topLeft());
+    const QPoint devicePosition = deviceTopLeft.toPoint();
+    if (QRectF(sourceRect) != source || QPointF(devicePosition) != deviceTopLeft) {
+        return false;
+    }
+
+    QRegion clip = QRect(devicePosition, sourceRect.size());
+    if (painter->hasClipping()) {
+        clip &= transform.map(painter->clipRegion());
+    }
+    for (const QRect &rect : std::as_const(clip)) {
+        blendImage(*device, rect.topLeft(), image, QRect(sourceRect.topLeft() + (rect.topLeft() - devicePosition), rect.size()), painter->opacity());
+    }
+    return true;
+}
+
+/**
+ * Frames that cover at least this many pixels are split into tiles that are painted in parallel.
+ */
+static const qsizetype s_tiledPixelCount = 2560 * 1440;
+static const int s_tileSize = 256;
+
+static QThreadPool *tileThreadPool()
+{
+    static QThreadPool *pool = []() {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(std::clamp(QThread::idealThreadCount(), 1, 4));
+        return pool;
+    }();
+    return pool;
+}
+
 ItemRendererQPainter::ItemRendererQPainter()
     : m_painter(std::make_unique<QPainter>())
 {
+    if (qEnvironmentVariableIsSet("KWIN_QPAINTER_TILED")) {
+        m_forceTiling = qEnvironmentVariableIntValue("KWIN_QPAINTER_TILED") == 1;
+    }
 }
 
 ItemRendererQPainter::~ItemRendererQPainter()
@@ -35,6 +94,8 @@ std::unique_ptr<ImageItem> ItemRendererQPainter::createImageItem(Item *parent)
 
 QPainter *ItemRendererQPainter::painter() const
 {
+    // whoever paints with the painter directly expects everything before to be painted
+    flushCommands();
     return m_painter.get();
 }
 
@@ -43,10 +104,19 @@ void ItemRendererQPainter::beginFrame(const RenderTarget &renderTarget, const Re
     QImage *buffer = renderTarget.image();
     m_painter->begin(buffer);
     m_painter->setWindow(viewport.renderRect().toRect());
+
+    if (buffer->depth() % 8 != 0) {
+        m_tiling = false;
+    } else if (m_forceTiling) {
+        m_tiling = *m_forceTiling;
+    } else {
+        m_tiling = qsizetype(buffer->width()) * buffer->height() >= s_tiledPixelCount && QThread::idealThreadCount() > 1;
+    }
 }
 
 void ItemRendererQPainter::endFrame()
 {
+    flushCommands();
     m_painter->end();
 }
 
@@ -55,7 +125,7 @@ void ItemRendererQPainter::renderBackground(const RenderTarget &renderTarget, co
     m_painter->setCompositionMode(QPainter::CompositionMode_Source);
     const QRegion clipped = deviceRegion & renderTarget.transformedRect();
     for (const QRect &rect : clipped) {
-        m_painter->fillRect(viewport.mapFromDeviceCoordinates(rect), Qt::transparent);
+        fillRect(m_painter.get(), viewport.mapFromDeviceCoordinates(rect));
     }
     m_painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
 }
@@ -78,6 +148,8 @@ void ItemRendererQPainter::renderItem(const RenderTarget &renderTarget, const Re
     m_painter->save();
     m_painter->setClipRegion(logicalRegion);
     m_painter->setClipping(true);
+    m_clip = logicalRegion;
+    m_clipTransform = m_painter->combinedTransform();
     m_painter->setOpacity(data.opacity());
 
     if (mask & Scene::PAINT_WINDOW_TRANSFORMED) {
@@ -90,7 +162,7 @@ void ItemRendererQPainter::renderItem(const RenderTarget &renderTarget, const Re
     m_painter->restore();
 }
 
-void ItemRendererQPainter::renderItem(QPainter *painter, Item *item, const std::function<bool(Item *)> &filter) const
+void ItemRendererQPainter::renderItem(QPainter *painter, Item *item, const std::function<bool(Item *)> &filter)
 {
     if (filter && filter(item)) {
         return;
@@ -131,7 +203,7 @@ void ItemRendererQPainter::renderItem(QPainter *painter, Item *item, const std::
     painter->restore();
 }
 
-void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem) const
+void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem)
 {
     const auto surfaceTexture = static_cast<QPainterSurfaceTexture *>(surfaceItem->texture());
     if (!surfaceTexture || !surfaceTexture->isValid()) {
@@ -189,27 +261,137 @@ void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *sur
                             target.width() * xSourceBoxScale,
                             target.height() * ySourceBoxScale);
 
-        painter->drawImage(target, surfaceTexture->image(), source);
+        drawImage(painter, target, surfaceTexture->image(), source);
     }
 
     painter->restore();
 }
 
-void ItemRendererQPainter::renderDecorationItem(QPainter *painter, DecorationItem *decorationItem) const
+void ItemRendererQPainter::renderDecorationItem(QPainter *painter, DecorationItem *decorationItem)
 {
     const auto renderer = static_cast<const SceneQPainterDecorationRenderer *>(decorationItem->renderer());
     RectF dtr, dlr, drr, dbr;
     decorationItem->window()->layoutDecorationRects(dlr, dtr, drr, dbr);
 
-    painter->drawImage(dtr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Top));
-    painter->drawImage(dlr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Left));
-    painter->drawImage(drr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Right));
-    painter->drawImage(dbr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom));
+    const std::array parts{
+        std::pair(QRectF(dtr), SceneQPainterDecorationRenderer::DecorationPart::Top),
+        std::pair(QRectF(dlr), SceneQPainterDecorationRenderer::DecorationPart::Left),
+        std::pair(QRectF(drr), SceneQPainterDecorationRenderer::DecorationPart::Right),
+        std::pair(QRectF(dbr), SceneQPainterDecorationRenderer::DecorationPart::Bottom),
+    };
+    for (const auto &[rect, part] : parts) {
+        const QImage image = renderer->image(part);
+        drawImage(painter, rect, image, image.rect());
+    }
+}
+
+void ItemRendererQPainter::renderImageItem(QPainter *painter, ImageItem *imageItem)
+{
+    const QImage image = imageItem->image();
+    drawImage(painter, imageItem->rect(), image, image.rect());
+}
+
+void ItemRendererQPainter::drawImage(QPainter *painter, const QRectF &target, const QImage &image, const QRectF &source)
+{
+    if (image.isNull()) {
+        return;
+    }
+    if (m_tiling) {
+        recordCommand(painter, target, image, source);
+    } else if (!blitImage(painter, target, image, source)) {
+        painter->drawImage(target, image, source);
+    }
+}
+
+void ItemRendererQPainter::fillRect(QPainter *painter, const QRectF &rect)
+{
+    if (m_tiling) {
+        recordCommand(painter, rect, QImage(), QRectF());
+    } else {
+        painter->fillRect(rect, Qt::transparent);
+    }
+}
+
+void ItemRendererQPainter::recordCommand(QPainter *painter, const QRectF &target, const QImage &image, const QRectF &source)
+{
+    const QTransform transform = painter->combinedTransform();
+    // one more pixel on each side for the rounding of the rasterizer, the clip is exact anyway
+    QRect deviceBounds = transform.mapRect(target).toAlignedRect().adjusted(-1, -1, 1, 1);
+    if (painter->hasClipping()) {
+        deviceBounds &= m_clipTransform.mapRect(QRectF(m_clip.boundingRect())).toAlignedRect().adjusted(-1, -1, 1, 1);
+    }
+    if (deviceBounds.isEmpty()) {
+        return;
+    }
+    m_commands.push_back(PaintCommand{
+        .deviceBounds = deviceBounds,
+        .clipTransform = m_clipTransform,
+        .clip = m_clip,
+        .clipping = painter->hasClipping(),
+        .transform = transform,
+        .opacity = painter->opacity(),
+        .compositionMode = painter->compositionMode(),
+        .renderHints = painter->renderHints(),
+        .target = target,
+        .image = image,
+        .source = source,
+    });
 }
 
-void ItemRendererQPainter::renderImageItem(QPainter *painter, ImageItem *imageItem) const
+void ItemRendererQPainter::flushCommands() const
 {
-    painter->drawImage(imageItem->rect(), imageItem->image());
+    if (m_commands.empty()) {
+        return;
+    }
+
+    QImage *buffer = static_cast<QImage *>(m_painter->device());
+    QRect bounds;
+    for (const PaintCommand &command : m_commands) {
+        bounds |= command.deviceBounds;
+    }
+    bounds &= buffer->rect();
+
+    QList<QRect> tiles;
+    for (int y = bounds.top(); y <= bounds.bottom(); y += s_tileSize) {
+        for (int x = bounds.left(); x <= bounds.right(); x += s_tileSize) {
+            tiles.append(QRect(x, y, s_tileSize, s_tileSize) & bounds);
+        }
+    }
+
+    // Every tile is painted with a painter of its own into the pixels of the buffer it covers,
+    // with the commands translated by the position of the tile. Painters on distinct images
+    // don't share state, so they can run next to each other.
+    uchar *bits = buffer->bits();
+    const qsizetype bytesPerLine = buffer->bytesPerLine();
+    const int bytesPerPixel = buffer->depth() / 8;
+    QtConcurrent::blockingMap(tileThreadPool(), tiles, [&](const QRect &tile) {
+        QImage image(bits + tile.y() * bytesPerLine + tile.x() * bytesPerPixel, tile.width(), tile.height(), bytesPerLine, buffer->format());
+        QPainter painter(&image);
+        const QTransform offset = QTransform::fromTranslate(-tile.x(), -tile.y());
+        for (const PaintCommand &command : m_commands) {
+            if (!command.deviceBounds.intersects(tile)) {
+                continue;
+            }
+            painter.setRenderHints(~command.renderHints, false);
+            painter.setRenderHints(command.renderHints, true);
+            painter.setCompositionMode(command.compositionMode);
+            painter.setOpacity(command.opacity);
+            if (command.clipping) {
+                painter.setTransform(command.clipTransform * offset);
+                painter.setClipRegion(command.clip);
+            } else {
+                painter.setClipping(false);
+            }
+            painter.setTransform(command.transform * offset);
+            if (command.image.isNull()) {
+                painter.fillRect(command.target, Qt::transparent);
+            } else if (!blitImage(&painter, command.target, command.image, command.source)) {
+                painter.drawImage(command.target, command.image, command.source);
+            }
+        }
+    });
+
+    m_commands.clear();
 }
 
 } // namespace KWin
@@ -8,7 +8,12 @@
 
 #include "scene/itemrenderer.h"
 
-class QPainter;
+#include <QImage>
+#include <QPainter>
+#include <QRegion>
+
+#include <optional>
+#include <vector>
 
 namespace KWin
 {
@@ -33,12 +38,42 @@ public:
     std::unique_ptr<ImageItem> createImageItem(Item *parent = nullptr) override;
 
 private:
-    void renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem) const;
-    void renderDecorationItem(QPainter *painter, DecorationItem *decorationItem) const;
-    void renderImageItem(QPainter *painter, ImageItem *imageItem) const;
-    void renderItem(QPainter *painter, Item *item, const std::function<bool(Item *)> &filter) const;
+    /**
+     * A drawing operation of the frame, with the state of the painter it is drawn with. The
+     * images are shallow copies, so the commands stay valid while the items change.
+     */
+    struct PaintCommand
+    {
+        QRect deviceBounds;
+        QTransform clipTransform;
+        QRegion clip;
+        bool clipping;
+        QTransform transform;
+        qreal opacity;
+        QPainter::CompositionMode compositionMode;
+        QPainter::RenderHints renderHints;
+        QRectF target;
+        QImage image;
+        QRectF source;
+    };
+
+    void renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem);
+    void renderDecorationItem(QPainter *painter, DecorationItem *decorationItem);
+    void renderImageItem(QPainter *painter, ImageItem *imageItem);
+    void renderItem(QPainter *painter, Item *item, const std::function<bool(Item *)> &filter);
+
+    void drawImage(QPainter *painter, const QRectF &target, const QImage &image, const QRectF &source);
+    void fillRect(QPainter *painter, const QRectF &rect);
+    void recordCommand(QPainter *painter, const QRectF &target, const QImage &image, const QRectF &source);
+    void flushCommands() const;
 
     std::unique_ptr<QPainter> m_painter;
+    std::optional<bool> m_forceTiling;
+    bool m_tiling = false;
+    // the clip the commands are recorded with, along with the transform it has been set with
+    QRegion m_clip;
+    QTransform m_clipTransform;
+    mutable std::vector<PaintCommand> m_commands;
 };
 
 } // namespace KWin
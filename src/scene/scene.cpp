@@ -10,6 +10,7 @@
 #include "core/pixelgrid.h"
 #include "core/renderviewport.h"
 #include "effect/effect.h"
+#include "opengl/glpassprofiler.h"
 #include "scene/cursoritem.h"
 #include "scene/item.h"
 #include "scene/itemrenderer.h"
@@ -466,6 +467,16 @@ ItemTreeView::~ItemTreeView()
     }
 }
 
+QPointF ItemTreeView::hotspot() const
+{
+    // the cursor image isn't necessarily at the top left, e.g. with a drag and drop icon
+    if (qobject_cast<CursorItem *>(m_item)) {
+        return -m_item->boundingRect().topLeft();
+    } else {
+        return QPointF{};
+    }
+}
+
 QRectF ItemTreeView::viewport() const
 {
     // TODO make the viewport explicit instead?
@@ -510,6 +521,8 @@ QRegion ItemTreeView::collectDamage()
 
 void ItemTreeView::paint(const RenderTarget &renderTarget, const QRegion &deviceRegion)
 {
+    GLPassScope passScope(u"cursor");
+
     RenderViewport renderViewport(viewport(), m_output->scale(), renderTarget);
     auto renderer = m_item->scene()->renderer();
     renderer->beginFrame(renderTarget, renderViewport);
@@ -174,6 +174,7 @@ public:
     explicit ItemTreeView(SceneView *parentView, Item *item, LogicalOutput *output, OutputLayer *layer);
     ~ItemTreeView() override;
 
+    QPointF hotspot() const override;
     QRectF viewport() const override;
     bool isVisible() const override;
     QList<SurfaceItem *> scanoutCandidates(ssize_t maxCount) const override;
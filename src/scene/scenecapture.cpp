@@ -0,0 +1,179 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "scene/scenecapture.h"
+#include "core/graphicsbuffer.h"
+#include "scene/imageitem.h"
+#include "scene/scene.h"
+#include "scene/surfaceitem.h"
+
+#include <QDataStream>
+
+namespace KWin
+{
+
+static const QByteArray s_magic = QByteArrayLiteral("KWINSCAP");
+
+static QDataStream &operator<<(QDataStream &stream, const SceneCaptureItem &item)
+{
+    return stream << item.id << item.parentId << item.type << item.position << item.size << item.transform
+                  << item.opacity << item.z << item.visible << item.hasEffects
+                  << item.textureSize << item.textureFormat << item.textureHasAlpha << item.damage;
+}
+
+static QDataStream &operator>>(QDataStream &stream, SceneCaptureItem &item)
+{
+    return stream >> item.id >> item.parentId >> item.type >> item.position >> item.size >> item.transform
+        >> item.opacity >> item.z >> item.visible >> item.hasEffects
+        >> item.textureSize >> item.textureFormat >> item.textureHasAlpha >> item.damage;
+}
+
+SceneCapture::SceneCapture(int frameCount)
+    : m_framesLeft(frameCount)
+{
+}
+
+bool SceneCapture::open(const QString &fileName)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QDataStream stream(&m_file);
+    stream.writeRawData(s_magic.constData(), s_magic.size());
+    stream << s_version;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool SceneCapture::isFinished() const
+{
+    return m_framesLeft <= 0;
+}
+
+SceneCaptureFrame SceneCapture::captureFrame(const QList<Item *> &roots, RenderView *view, const QString &viewName, std::chrono::nanoseconds timestamp)
+{
+    SceneCaptureFrame frame{
+        .timestamp = timestamp,
+        .viewName = viewName,
+        .viewport = view ? view->viewport() : QRectF(),
+        .scale = view ? view->scale() : 1.0,
+        .items = {},
+    };
+    for (Item *root : roots) {
+        captureItem(root, 0, view, frame.items);
+    }
+    return frame;
+}
+
+void SceneCapture::captureItem(Item *item, quint32 parentId, RenderView *view, QList<SceneCaptureItem> &items)
+{
+    // ids start at one, zero means that the item has no parent
+    auto it = m_ids.find(item);
+    if (it == m_ids.end()) {
+        it = m_ids.insert(item, m_ids.size() + 1);
+    }
+
+    SceneCaptureItem captured{
+        .id = *it,
+        .parentId = parentId,
+        .type = item->metaObject()->className(),
+        .position = item->position(),
+        .size = item->size(),
+        .transform = item->transform(),
+        .opacity = item->opacity(),
+        .z = item->z(),
+        .visible = item->explicitVisible(),
+        .hasEffects = item->hasEffects(),
+        .damage = item->deviceRepaints(view),
+    };
+    if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
+        if (GraphicsBuffer *buffer = surfaceItem->buffer()) {
+            captured.textureSize = buffer->size();
+            captured.textureHasAlpha = buffer->hasAlphaChannel();
+            if (const DmaBufAttributes *attributes = buffer->dmabufAttributes()) {
+                captured.textureFormat = attributes->format;
+            } else if (const ShmAttributes *attributes = buffer->shmAttributes()) {
+                captured.textureFormat = attributes->format;
+            }
+        }
+    } else if (auto imageItem = qobject_cast<ImageItem *>(item)) {
+        const QImage image = imageItem->image();
+        captured.textureSize = image.size();
+        captured.textureHasAlpha = image.hasAlphaChannel();
+    }
+    items.append(captured);
+
+    const QList<Item *> children = item->sortedChildItems();
+    for (Item *child : children) {
+        captureItem(child, captured.id, view, items);
+    }
+}
+
+void SceneCapture::addFrame(const SceneCaptureFrame &frame)
+{
+    if (isFinished()) {
+        return;
+    }
+    QDataStream stream(&m_file);
+    stream << qCompress(serialize(frame));
+    if (--m_framesLeft == 0) {
+        m_file.close();
+    }
+}
+
+QByteArray SceneCapture::serialize(const SceneCaptureFrame &frame)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << qint64(frame.timestamp.count()) << frame.viewName << frame.viewport << frame.scale << frame.items;
+    return data;
+}
+
+std::optional<SceneCaptureFrame> SceneCapture::deserialize(const QByteArray &data)
+{
+    QDataStream stream(data);
+    SceneCaptureFrame frame;
+    qint64 timestamp;
+    stream >> timestamp >> frame.viewName >> frame.viewport >> frame.scale >> frame.items;
+    if (stream.status() != QDataStream::Ok) {
+        return std::nullopt;
+    }
+    frame.timestamp = std::chrono::nanoseconds(timestamp);
+    return frame;
+}
+
+bool SceneCaptureReader::open(const QString &fileName)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&m_file);
+    QByteArray magic(s_magic.size(), Qt::Uninitialized);
+    quint32 version = 0;
+    stream.readRawData(magic.data(), magic.size());
+    stream >> version;
+    return stream.status() == QDataStream::Ok && magic == s_magic && version == SceneCapture::s_version;
+}
+
+std::optional<SceneCaptureFrame> SceneCaptureReader::readFrame()
+{
+    if (m_file.atEnd()) {
+        return std::nullopt;
+    }
+    QDataStream stream(&m_file);
+    QByteArray compressed;
+    stream >> compressed;
+    if (stream.status() != QDataStream::Ok) {
+        return std::nullopt;
+    }
+    return SceneCapture::deserialize(qUncompress(compressed));
+}
+
+} // namespace KWin
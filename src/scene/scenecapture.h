@@ -0,0 +1,122 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QRegion>
+#include <QTransform>
+
+#include <chrono>
+#include <optional>
+
+namespace KWin
+{
+
+class Item;
+class RenderView;
+
+/**
+ * The state of a single item in a captured frame.
+ */
+struct KWIN_EXPORT SceneCaptureItem
+{
+    // stays the same for the item in all frames of a capture
+    quint32 id = 0;
+    // the id of the parent item, or zero if the item is one of the roots
+    quint32 parentId = 0;
+    QByteArray type;
+    QPointF position;
+    QSizeF size;
+    QTransform transform;
+    qreal opacity = 1;
+    qint32 z = 0;
+    bool visible = true;
+    bool hasEffects = false;
+    // the metadata of the texture of the item, the size is empty if the item has none
+    QSize textureSize;
+    quint32 textureFormat = 0;
+    bool textureHasAlpha = false;
+    // in device coordinates
+    QRegion damage;
+
+    bool operator==(const SceneCaptureItem &other) const = default;
+};
+
+/**
+ * The items of one frame of one view, parents come before their children and siblings come
+ * in the order they are painted in.
+ */
+struct KWIN_EXPORT SceneCaptureFrame
+{
+    std::chrono::nanoseconds timestamp{0};
+    QString viewName;
+    QRectF viewport;
+    qreal scale = 1;
+    QList<SceneCaptureItem> items;
+
+    bool operator==(const SceneCaptureFrame &other) const = default;
+};
+
+/**
+ * The SceneCapture class writes the item trees of a number of frames to a file, so that they
+ * can be replayed with kwin_replay to profile the rendering of a scene that can't be
+ * reproduced otherwise. Only the metadata of the textures is recorded, not their contents.
+ *
+ * Every frame is stored compressed, prefixed with its size, after a header with a magic
+ * number and the version of the format.
+ */
+class KWIN_EXPORT SceneCapture
+{
+public:
+    static constexpr quint32 s_version = 1;
+
+    explicit SceneCapture(int frameCount);
+
+    bool open(const QString &fileName);
+    bool isFinished() const;
+
+    /**
+     * Builds a frame from the items under the given @a roots, as seen by the @a view.
+     */
+    SceneCaptureFrame captureFrame(const QList<Item *> &roots, RenderView *view, const QString &viewName, std::chrono::nanoseconds timestamp);
+    void addFrame(const SceneCaptureFrame &frame);
+
+    static QByteArray serialize(const SceneCaptureFrame &frame);
+    static std::optional<SceneCaptureFrame> deserialize(const QByteArray &data);
+
+private:
+    void captureItem(Item *item, quint32 parentId, RenderView *view, QList<SceneCaptureItem> &items);
+
+    QFile m_file;
+    QHash<const Item *, quint32> m_ids;
+    int m_framesLeft;
+};
+
+/**
+ * The SceneCaptureReader class reads the frames written by SceneCapture.
+ */
+class KWIN_EXPORT SceneCaptureReader
+{
+public:
+    bool open(const QString &fileName);
+    /**
+     * Returns the next frame, or none if all frames have been read or the file is broken.
+     */
+    std::optional<SceneCaptureFrame> readFrame();
+
+private:
+    QFile m_file;
+};
+
+} // namespace KWin
@@ -13,8 +13,11 @@
 #include "shadow.h"
 #include "window.h"
 
+#include <QMultiHash>
 #include <QPainter>
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -321,83 +324,80 @@ void ShadowItem::preprocess()
     }
 }
 
-class DecorationShadowTextureCache
+/**
+ * The ShadowTextureCache class shares the textures of shadows that look the same, which is
+ * the case for nearly all windows with server-side decorations, but also for clients that
+ * provide the same shadow for every window. The textures are looked up by their contents.
+ */
+class ShadowTextureCache
 {
 public:
-    ~DecorationShadowTextureCache();
-    DecorationShadowTextureCache(const DecorationShadowTextureCache &) = delete;
-    static DecorationShadowTextureCache &instance();
+    ~ShadowTextureCache();
+    ShadowTextureCache(const ShadowTextureCache &) = delete;
+    static ShadowTextureCache &instance();
 
-    void unregister(ShadowTextureProvider *provider);
-    std::shared_ptr<GLTexture> getTexture(ShadowTextureProvider *provider);
+    std::shared_ptr<GLTexture> getTexture(const QImage &image);
 
 private:
-    DecorationShadowTextureCache() = default;
+    ShadowTextureCache() = default;
     struct Data
     {
-        std::shared_ptr<GLTexture> texture;
-        QList<ShadowTextureProvider *> providers;
+        QImage image;
+        std::weak_ptr<GLTexture> texture;
     };
-    QHash<KDecoration3::DecorationShadow *, Data> m_cache;
+    QMultiHash<size_t, Data> m_cache;
 };
 
-DecorationShadowTextureCache &DecorationShadowTextureCache::instance()
+ShadowTextureCache &ShadowTextureCache::instance()
 {
-    static DecorationShadowTextureCache s_instance;
+    static ShadowTextureCache s_instance;
     return s_instance;
 }
 
-DecorationShadowTextureCache::~DecorationShadowTextureCache()
+ShadowTextureCache::~ShadowTextureCache()
 {
-    Q_ASSERT(m_cache.isEmpty());
+    Q_ASSERT(std::all_of(m_cache.cbegin(), m_cache.cend(), [](const Data &data) {
+        return data.texture.expired();
+    }));
 }
 
-void DecorationShadowTextureCache::unregister(ShadowTextureProvider *provider)
+std::shared_ptr<GLTexture> ShadowTextureCache::getTexture(const QImage &image)
 {
-    auto it = m_cache.begin();
-    while (it != m_cache.end()) {
-        auto &d = it.value();
-        // check whether the Vector of Shadows contains our shadow and remove all of them
-        auto glIt = d.providers.begin();
-        while (glIt != d.providers.end()) {
-            if (*glIt == provider) {
-                glIt = d.providers.erase(glIt);
-            } else {
-                glIt++;
+    const size_t key = qHashMulti(0, image.width(), image.height(), int(image.format()), qHashBits(image.constBits(), image.sizeInBytes()));
+    for (auto it = m_cache.find(key); it != m_cache.end() && it.key() == key; ++it) {
+        if (it->image == image) {
+            if (auto texture = it->texture.lock()) {
+                return texture;
             }
         }
-        // if there are no shadows any more we can erase the cache entry
-        if (d.providers.isEmpty()) {
+    }
+
+    // The textures are owned by the providers, forget the ones that nobody uses anymore
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (it->texture.expired()) {
             it = m_cache.erase(it);
         } else {
-            it++;
+            ++it;
         }
     }
-}
 
-std::shared_ptr<GLTexture> DecorationShadowTextureCache::getTexture(ShadowTextureProvider *provider)
-{
-    Shadow *shadow = provider->shadow();
-    Q_ASSERT(shadow->hasDecorationShadow());
-    unregister(provider);
-    const auto decoShadow = shadow->decorationShadow().lock();
-    Q_ASSERT(decoShadow);
-    auto it = m_cache.find(decoShadow.get());
-    if (it != m_cache.end()) {
-        Q_ASSERT(!it.value().providers.contains(provider));
-        it.value().providers << provider;
-        return it.value().texture;
-    }
-    Data d;
-    d.providers << provider;
-    d.texture = GLTexture::upload(shadow->decorationShadowImage());
-    if (!d.texture) {
+    std::shared_ptr<GLTexture> texture = GLTexture::upload(image);
+    if (!texture) {
         return nullptr;
     }
-    d.texture->setFilter(GL_LINEAR);
-    d.texture->setWrapMode(GL_CLAMP_TO_EDGE);
-    m_cache.insert(decoShadow.get(), d);
-    return d.texture;
+    texture->setFilter(GL_LINEAR);
+    texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    if (texture->internalFormat() == GL_R8) {
+        // Swizzle red to alpha and all other channels to zero
+        texture->bind();
+        texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
+    }
+
+    m_cache.insert(key, Data{
+                            .image = image,
+                            .texture = texture,
+                        });
+    return texture;
 }
 
 OpenGLShadowTextureProvider::OpenGLShadowTextureProvider(Shadow *shadow)
@@ -409,7 +409,6 @@ OpenGLShadowTextureProvider::~OpenGLShadowTextureProvider()
 {
     if (m_texture) {
         Compositor::self()->scene()->openglContext()->makeCurrent();
-        DecorationShadowTextureCache::instance().unregister(this);
         m_texture.reset();
     }
 }
@@ -418,7 +417,7 @@ void OpenGLShadowTextureProvider::update()
 {
     if (m_shadow->hasDecorationShadow()) {
         // simplifies a lot by going directly to
-        m_texture = DecorationShadowTextureCache::instance().getTexture(this);
+        m_texture = ShadowTextureCache::instance().getTexture(m_shadow->decorationShadowImage());
         return;
     }
 
@@ -484,18 +483,7 @@ void OpenGLShadowTextureProvider::update()
         }
     }
 
-    m_texture = GLTexture::upload(image);
-    if (!m_texture) {
-        return;
-    }
-    m_texture->setFilter(GL_LINEAR);
-    m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-
-    if (m_texture->internalFormat() == GL_R8) {
-        // Swizzle red to alpha and all other channels to zero
-        m_texture->bind();
-        m_texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
-    }
+    m_texture = ShadowTextureCache::instance().getTexture(image);
 }
 
 QPainterShadowTextureProvider::QPainterShadowTextureProvider(Shadow *shadow)
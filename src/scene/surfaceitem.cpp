@@ -6,17 +6,28 @@
 
 #include "scene/surfaceitem.h"
 #include "compositor.h"
+#include "core/gpumemory.h"
 #include "core/graphicsbufferview.h"
 #include "core/pixelgrid.h"
 #include "core/renderbackend.h"
 #include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "opengl/glasyncupload.h"
+#include "opengl/glframebuffer.h"
+#include "opengl/glshader.h"
+#include "opengl/glshadermanager.h"
 #include "opengl/gltexture.h"
 #include "qpainter/qpainterbackend.h"
 #include "scene/scene.h"
+#include "scene/windowitem.h"
+#include "window.h"
 #include "utils/common.h"
 
 #include <QPainter>
 
+#include <cmath>
+#include <limits>
+
 #include <epoxy/egl.h>
 #include <utils/drm_format_helper.h>
 
@@ -161,12 +172,12 @@ void SurfaceItem::addDamage(const QRegion &region)
         scheduleRepaint(view, viewDamage);
     }
 
-    Q_EMIT damaged();
+    Q_EMIT damaged(logicalDamage);
 }
 
 void SurfaceItem::resetDamage()
 {
-    m_damage = QRegion();
+    m_damage = Region();
 }
 
 QRegion SurfaceItem::damage() const
@@ -184,6 +195,16 @@ void SurfaceItem::destroyTexture()
     m_texture.reset();
 }
 
+static QString windowName(Item *item)
+{
+    for (Item *ancestor = item; ancestor; ancestor = ancestor->parentItem()) {
+        if (auto windowItem = qobject_cast<WindowItem *>(ancestor)) {
+            return windowItem->window()->resourceClass();
+        }
+    }
+    return QString();
+}
+
 void SurfaceItem::preprocess()
 {
     if (!m_texture || m_texture->size() != m_bufferSize) {
@@ -194,12 +215,19 @@ void SurfaceItem::preprocess()
         }
     }
 
+    const QRegion region = damage();
+    if (m_texture->isValid() && region.isEmpty()) {
+        return;
+    }
+
+    const GpuMemoryOwner memoryOwner{
+        .kind = GpuMemoryOwner::Kind::Window,
+        .name = windowName(this),
+    };
+    GpuMemoryOwnerScope memoryScope(&memoryOwner);
     if (m_texture->isValid()) {
-        const QRegion region = damage();
-        if (!region.isEmpty()) {
-            m_texture->update(region);
-            resetDamage();
-        }
+        m_texture->update(region);
+        resetDamage();
     } else {
         if (m_texture->create()) {
             resetDamage();
@@ -296,6 +324,25 @@ QSize SurfaceTexture::size() const
     return m_size;
 }
 
+void SurfaceTexture::prefetch(const QRegion &region)
+{
+}
+
+// Large shm buffers can be sampled in place rather than copied to a texture. As the client
+// has no way to tell when the GPU is done with the buffer, it's opt-in.
+static const bool s_shmImport = environmentVariableBoolValue("KWIN_SHM_ZERO_COPY").value_or(false);
+static const qsizetype s_minimumShmImportSize = 4 * 1024 * 1024;
+
+// Surfaces are hardly ever drawn smaller than a thumbnail, so there's no need for the
+// smallest mipmap levels of the downscaled copy
+static const int s_maxDownscaledLevels = 4;
+
+static bool shouldImportShmBuffer(GraphicsBuffer *buffer)
+{
+    const ShmAttributes *attributes = buffer->shmAttributes();
+    return s_shmImport && qsizetype(attributes->stride) * attributes->size.height() >= s_minimumShmImportSize;
+}
+
 OpenGLSurfaceTexture::OpenGLSurfaceTexture(EglBackend *backend, SurfaceItem *item)
     : m_backend(backend)
     , m_item(item)
@@ -309,7 +356,7 @@ OpenGLSurfaceTexture::~OpenGLSurfaceTexture()
 
 bool OpenGLSurfaceTexture::isValid() const
 {
-    return m_texture.isValid();
+    return m_texture.isValid() || m_bufferType == BufferType::SinglePixel;
 }
 
 OpenGLSurfaceContents OpenGLSurfaceTexture::texture() const
@@ -317,12 +364,27 @@ OpenGLSurfaceContents OpenGLSurfaceTexture::texture() const
     return m_texture;
 }
 
+std::optional<QColor> OpenGLSurfaceTexture::solidColor() const
+{
+    if (m_bufferType != BufferType::SinglePixel) {
+        return std::nullopt;
+    }
+    return m_solidColor;
+}
+
 bool OpenGLSurfaceTexture::create()
 {
+    if (m_downscaled) {
+        m_downscaled->dirty = true;
+    }
+
     GraphicsBuffer *buffer = m_item->buffer();
     if (buffer->dmabufAttributes()) {
         return loadDmabufTexture(buffer);
     } else if (buffer->shmAttributes()) {
+        if (!m_shmImportFailed && shouldImportShmBuffer(buffer) && loadShmImportTexture(buffer)) {
+            return true;
+        }
         return loadShmTexture(buffer);
     } else if (buffer->singlePixelAttributes()) {
         return loadSinglePixelTexture(buffer);
@@ -332,9 +394,71 @@ bool OpenGLSurfaceTexture::create()
     }
 }
 
+GLTexture *OpenGLSurfaceTexture::downscaledTexture()
+{
+    if (m_texture.planes.count() != 1) {
+        return nullptr;
+    }
+    GLTexture *source = m_texture.planes.constFirst().get();
+    if (source->target() != GL_TEXTURE_2D) {
+        return nullptr;
+    }
+
+    const QSize sourceSize = source->contentTransform().map(source->size());
+    const QSize size = QSize(sourceSize.width() / 2, sourceSize.height() / 2).expandedTo(QSize(1, 1));
+    if (!m_downscaled || m_downscaled->texture->size() != size) {
+        m_downscaled.reset();
+
+        const int levels = std::clamp(int(std::log2(std::max(size.width(), size.height()))) + 1, 1, s_maxDownscaledLevels);
+        auto texture = GLTexture::allocate(source->internalFormat(), size, levels);
+        if (!texture) {
+            return nullptr;
+        }
+        texture->setFilter(levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        auto framebuffer = std::make_unique<GLFramebuffer>(texture.get());
+        if (!framebuffer->valid()) {
+            return nullptr;
+        }
+        m_downscaled = Downscaled{
+            .texture = std::move(texture),
+            .framebuffer = std::move(framebuffer),
+        };
+    }
+
+    m_downscaled->used = true;
+    if (m_downscaled->dirty) {
+        // Linear filtering halves the texture with a box filter, the mipmaps take it from there
+        GLFramebuffer::pushFramebuffer(m_downscaled->framebuffer.get());
+        const bool blending = glIsEnabled(GL_BLEND);
+        glDisable(GL_BLEND);
+
+        QMatrix4x4 projection;
+        projection.ortho(QRectF(QPointF(), size));
+        ShaderBinder binder(ShaderTrait::MapTexture);
+        binder.shader()->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, projection);
+        source->render(size);
+
+        if (blending) {
+            glEnable(GL_BLEND);
+        }
+        GLFramebuffer::popFramebuffer();
+
+        m_downscaled->texture->bind();
+        m_downscaled->texture->generateMipmaps();
+        m_downscaled->texture->unbind();
+        m_downscaled->dirty = false;
+    }
+
+    return m_downscaled->texture.get();
+}
+
 void OpenGLSurfaceTexture::destroy()
 {
+    m_pendingUpload.reset();
+    m_downscaled.reset();
     m_texture.reset();
+    m_solidColor = QColor();
     m_bufferType = BufferType::None;
     m_size = QSize();
 }
@@ -345,12 +469,25 @@ void OpenGLSurfaceTexture::update(const QRegion &region)
     if (buffer->dmabufAttributes()) {
         updateDmabufTexture(buffer);
     } else if (buffer->shmAttributes()) {
-        updateShmTexture(buffer, region);
+        if (m_bufferType == BufferType::ShmImport) {
+            updateShmImportTexture(buffer);
+        } else {
+            updateShmTexture(buffer, region);
+        }
     } else if (buffer->singlePixelAttributes()) {
         updateSinglePixelTexture(buffer);
     } else {
         qCDebug(KWIN_OPENGL) << "Failed to update OpenGLSurfaceTexture for a buffer of unknown type" << buffer;
     }
+
+    if (m_downscaled) {
+        if (m_downscaled->used) {
+            m_downscaled->dirty = true;
+            m_downscaled->used = false;
+        } else {
+            m_downscaled.reset();
+        }
+    }
 }
 
 bool OpenGLSurfaceTexture::loadShmTexture(GraphicsBuffer *buffer)
@@ -399,7 +536,94 @@ void OpenGLSurfaceTexture::updateShmTexture(GraphicsBuffer *buffer, const QRegio
         return;
     }
 
-    m_texture.planes[0]->update(*view.image(), simplifyDamage(region));
+    const QRegion damage = simplifyDamage(region);
+    if (m_pendingUpload) {
+        const PendingUpload pendingUpload = std::exchange(m_pendingUpload, std::nullopt).value();
+        if (pendingUpload.buffer.buffer() == buffer && pendingUpload.upload->region() == damage) {
+            pendingUpload.upload->finish(m_texture.planes[0].get());
+            return;
+        }
+    }
+
+    m_texture.planes[0]->update(*view.image(), damage);
+}
+
+bool OpenGLSurfaceTexture::loadShmImportTexture(GraphicsBuffer *buffer)
+{
+    const EGLImageKHR image = m_backend->importShmBufferAsImage(buffer);
+    if (image == EGL_NO_IMAGE_KHR) {
+        m_shmImportFailed = true;
+        return false;
+    }
+
+    const ShmAttributes *attributes = buffer->shmAttributes();
+    const GLint target = m_backend->eglDisplayObject()->isExternalOnly(attributes->format, DRM_FORMAT_MOD_LINEAR) ? GL_TEXTURE_EXTERNAL_OES : GL_TEXTURE_2D;
+    auto texture = std::make_shared<GLTexture>(target);
+    texture->setSize(buffer->size());
+    if (!texture->create()) {
+        return false;
+    }
+    texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    texture->setFilter(GL_LINEAR);
+    texture->bind();
+    glEGLImageTargetTexture2DOES(target, static_cast<GLeglImageOES>(image));
+    texture->unbind();
+    texture->setContentTransform(OutputTransform::FlipY);
+
+    m_texture = {{texture}};
+    m_bufferType = BufferType::ShmImport;
+    m_size = buffer->size();
+
+    return true;
+}
+
+void OpenGLSurfaceTexture::updateShmImportTexture(GraphicsBuffer *buffer)
+{
+    // The texture shows the memory of the client buffer, only a new buffer needs to be imported
+    const EGLImageKHR image = m_backend->importShmBufferAsImage(buffer);
+    if (Q_UNLIKELY(image == EGL_NO_IMAGE_KHR)) {
+        m_shmImportFailed = true;
+        destroy();
+        create();
+        return;
+    }
+
+    GLTexture *texture = m_texture.planes[0].get();
+    texture->bind();
+    glEGLImageTargetTexture2DOES(texture->target(), static_cast<GLeglImageOES>(image));
+    texture->unbind();
+}
+
+void OpenGLSurfaceTexture::prefetch(const QRegion &region)
+{
+    m_pendingUpload.reset();
+
+    GraphicsBuffer *buffer = m_item->buffer();
+    if (m_bufferType != BufferType::Shm || !buffer || !buffer->shmAttributes() || buffer->size() != m_size) {
+        return;
+    }
+
+    // The commit may be handled while the context is not current, e.g. in the middle of
+    // rendering with another context. It's not worth disturbing that.
+    if (EglContext::currentContext() != m_backend->openglContext()) {
+        return;
+    }
+
+    auto view = std::make_unique<GraphicsBufferView>(buffer);
+    if (Q_UNLIKELY(view->isNull())) {
+        return;
+    }
+
+    auto upload = GLAsyncUpload::start(*view->image(), simplifyDamage(region));
+    if (!upload) {
+        return;
+    }
+
+    m_pendingUpload = PendingUpload{
+        .buffer = GraphicsBufferRef(buffer),
+        .view = std::move(view),
+        .upload = std::move(upload),
+    };
 }
 
 bool OpenGLSurfaceTexture::loadDmabufTexture(GraphicsBuffer *buffer)
@@ -487,16 +711,16 @@ void OpenGLSurfaceTexture::updateDmabufTexture(GraphicsBuffer *buffer)
     }
 }
 
+static QColor singlePixelColor(const SinglePixelAttributes *attributes)
+{
+    constexpr double max = std::numeric_limits<uint32_t>::max();
+    return QColor::fromRgbF(attributes->red / max, attributes->green / max, attributes->blue / max, attributes->alpha / max);
+}
+
 bool OpenGLSurfaceTexture::loadSinglePixelTexture(GraphicsBuffer *buffer)
 {
-    // TODO this shouldn't allocate a texture,
-    // the renderer should just use a color in the shader
-    const GraphicsBufferView view(buffer);
-    std::shared_ptr<GLTexture> texture = GLTexture::upload(*view.image());
-    if (Q_UNLIKELY(!texture)) {
-        return false;
-    }
-    m_texture = {{texture}};
+    // there is nothing to sample, the renderer fills the surface with the color
+    m_solidColor = singlePixelColor(buffer->singlePixelAttributes());
     m_bufferType = BufferType::SinglePixel;
     m_size = QSize(1, 1);
     return true;
@@ -509,8 +733,7 @@ void OpenGLSurfaceTexture::updateSinglePixelTexture(GraphicsBuffer *buffer)
         create();
         return;
     }
-    const GraphicsBufferView view(buffer);
-    m_texture.planes[0]->update(*view.image(), QRect(0, 0, 1, 1));
+    m_solidColor = singlePixelColor(buffer->singlePixelAttributes());
 }
 
 QPainterSurfaceTexture::QPainterSurfaceTexture(QPainterBackend *backend, SurfaceItem *item)
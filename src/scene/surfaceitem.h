@@ -8,15 +8,21 @@
 
 #include "core/graphicsbuffer.h"
 #include "core/output.h"
+#include "core/region.h"
 #include "scene/item.h"
 
+#include <QColor>
+
 #include <deque>
 
 namespace KWin
 {
 
 class EglBackend;
+class GLAsyncUpload;
+class GLFramebuffer;
 class GLTexture;
+class GraphicsBufferView;
 class QPainterBackend;
 class SurfaceTexture;
 class Window;
@@ -69,16 +75,25 @@ public:
     std::optional<std::chrono::nanoseconds> recursiveFrameTimeEstimation() const;
     std::optional<std::chrono::nanoseconds> frameTimeEstimation() const;
 
+    /**
+     * Brings the texture up to date with the buffer, this is done before painting the item
+     * but may also be needed if the contents are used while the item isn't painted.
+     */
+    void preprocess() override;
+
 Q_SIGNALS:
-    void damaged();
+    /**
+     * This signal is emitted when the surface contents change. The @a region is specified
+     * in the surface-local logical coordinates.
+     */
+    void damaged(const QRegion &region);
 
 protected:
     explicit SurfaceItem(Item *parent = nullptr);
 
-    void preprocess() override;
     WindowQuadList buildQuads() const override;
 
-    QRegion m_damage;
+    Region m_damage;
     OutputTransform m_bufferToSurfaceTransform;
     OutputTransform m_surfaceToBufferTransform;
     GraphicsBufferRef m_bufferRef;
@@ -103,6 +118,12 @@ public:
     virtual bool create() = 0;
     virtual void update(const QRegion &region) = 0;
 
+    /**
+     * Starts preparing the update of the @a region ahead of time, e.g. when the buffer is
+     * committed. The texture is still updated by update().
+     */
+    virtual void prefetch(const QRegion &region);
+
     // TODO: create()/update() steps are unnecessary now, consider removing size().
     QSize size() const;
 
@@ -146,13 +167,32 @@ public:
 
     bool create() override;
     void update(const QRegion &region) override;
+    void prefetch(const QRegion &region) override;
     bool isValid() const override;
 
     OpenGLSurfaceContents texture() const;
 
+    /**
+     * Returns the premultiplied color of a single pixel buffer. Such buffers aren't uploaded
+     * to a texture, texture() is empty and the surface is drawn with a uniform color instead.
+     */
+    std::optional<QColor> solidColor() const;
+
+    /**
+     * Returns a copy of the texture that is half as big and has mipmaps, for drawing the
+     * surface at a fraction of its size, or @c null if there can be no such copy.
+     *
+     * The copy is made the first time it's requested and redrawn on request after the surface
+     * has been damaged. It's dropped if the surface is updated without the copy having been
+     * requested since the previous update.
+     */
+    GLTexture *downscaledTexture();
+
 private:
     bool loadShmTexture(GraphicsBuffer *buffer);
     void updateShmTexture(GraphicsBuffer *buffer, const QRegion &region);
+    bool loadShmImportTexture(GraphicsBuffer *buffer);
+    void updateShmImportTexture(GraphicsBuffer *buffer);
     bool loadDmabufTexture(GraphicsBuffer *buffer);
     void updateDmabufTexture(GraphicsBuffer *buffer);
     bool loadSinglePixelTexture(GraphicsBuffer *buffer);
@@ -162,14 +202,34 @@ private:
     enum class BufferType {
         None,
         Shm,
+        ShmImport,
         DmaBuf,
         SinglePixel,
     };
 
+    struct Downscaled
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        bool dirty = true;
+        bool used = false;
+    };
+
+    struct PendingUpload
+    {
+        GraphicsBufferRef buffer;
+        std::unique_ptr<GraphicsBufferView> view;
+        std::unique_ptr<GLAsyncUpload> upload;
+    };
+
     BufferType m_bufferType = BufferType::None;
     EglBackend *m_backend;
     SurfaceItem *m_item;
     OpenGLSurfaceContents m_texture;
+    QColor m_solidColor;
+    std::optional<PendingUpload> m_pendingUpload;
+    std::optional<Downscaled> m_downscaled;
+    bool m_shmImportFailed = false;
 };
 
 class KWIN_EXPORT QPainterSurfaceTexture : public SurfaceTexture
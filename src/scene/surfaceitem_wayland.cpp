@@ -8,6 +8,9 @@
 #include "core/backendoutput.h"
 #include "core/drmdevice.h"
 #include "core/renderbackend.h"
+#include "scene/windowitem.h"
+#include "utils/envvar.h"
+#include "wayland/clientconnection.h"
 #include "wayland/linuxdmabufv1clientbuffer.h"
 #include "wayland/subcompositor.h"
 #include "wayland/surface.h"
@@ -20,6 +23,23 @@
 namespace KWin
 {
 
+/**
+ * How often surfaces that are fully occluded by other windows get frame callbacks.
+ * Zero disables throttling
+ */
+static const std::chrono::milliseconds s_occludedFrameCallbackInterval{environmentVariableIntValue("KWIN_OCCLUDED_FRAME_CALLBACK_INTERVAL").value_or(1000)};
+
+/**
+ * How often surfaces of clients that exceed their dispatch budget get frame callbacks.
+ */
+static const std::chrono::milliseconds s_throttledClientFrameCallbackInterval{50};
+
+/**
+ * How long the scanout candidate has to stay the same before the client is asked to
+ * reallocate its buffers for it.
+ */
+static const std::chrono::milliseconds s_scanoutFeedbackDelay{250};
+
 SurfaceItemWayland::SurfaceItemWayland(SurfaceInterface *surface, Item *parent)
     : SurfaceItem(parent)
     , m_surface(surface)
@@ -75,6 +95,13 @@ SurfaceItemWayland::SurfaceItemWayland(SurfaceInterface *surface, Item *parent)
     m_fifoFallbackTimer.setInterval(1000 / 20);
     m_fifoFallbackTimer.setSingleShot(true);
     connect(&m_fifoFallbackTimer, &QTimer::timeout, this, &SurfaceItemWayland::handleFifoFallback);
+
+    m_throttledFrameCallbackTimer.setSingleShot(true);
+    connect(&m_throttledFrameCallbackTimer, &QTimer::timeout, this, &SurfaceItemWayland::handleThrottledFrameCallback);
+
+    m_scanoutFeedbackTimer.setInterval(s_scanoutFeedbackDelay);
+    m_scanoutFeedbackTimer.setSingleShot(true);
+    connect(&m_scanoutFeedbackTimer, &QTimer::timeout, this, &SurfaceItemWayland::handleScanoutFeedbackTimeout);
 }
 
 QList<QRectF> SurfaceItemWayland::shape() const
@@ -117,6 +144,10 @@ void SurfaceItemWayland::handleBufferTransformChanged()
 
 void SurfaceItemWayland::handleSurfaceCommitted()
 {
+    if (m_texture && m_texture->isValid() && !m_damage.isEmpty()) {
+        // Get the pixels of big updates ready while the compositor is idle
+        m_texture->prefetch(m_damage);
+    }
     if (m_surface->hasFifoBarrier()) {
         m_fifoFallbackTimer.start();
     }
@@ -175,17 +206,42 @@ void SurfaceItemWayland::setScanoutHint(DrmDevice *device, const QHash<uint32_t,
     if (!m_surface || !m_surface->dmabufFeedbackV1()) {
         return;
     }
-    if (!device && m_scanoutFeedback.has_value()) {
-        m_surface->dmabufFeedbackV1()->setTranches({});
-        m_scanoutFeedback.reset();
-        return;
-    }
-    if (!m_scanoutFeedback || m_scanoutFeedback->device != device || m_scanoutFeedback->formats != drmFormats) {
-        m_scanoutFeedback = ScanoutFeedback{
+
+    std::optional<ScanoutFeedback> feedback;
+    if (device) {
+        feedback = ScanoutFeedback{
             .device = device,
             .formats = drmFormats,
         };
-        m_surface->dmabufFeedbackV1()->setScanoutTranches(device, drmFormats);
+    }
+
+    // Every change makes the client reallocate its buffers, so the feedback is only updated
+    // once the hint has settled. Otherwise, a surface that is a scanout candidate only every
+    // now and then, or whose candidate formats flip, e.g. when tearing is toggled, would keep
+    // switching between scanout and composited formats.
+    if (feedback == m_scanoutFeedback) {
+        m_pendingScanoutFeedback.reset();
+        m_scanoutFeedbackTimer.stop();
+        return;
+    }
+    if (m_scanoutFeedbackTimer.isActive() && feedback == m_pendingScanoutFeedback) {
+        return;
+    }
+    m_pendingScanoutFeedback = feedback;
+    m_scanoutFeedbackTimer.start();
+}
+
+void SurfaceItemWayland::handleScanoutFeedbackTimeout()
+{
+    if (!m_surface || !m_surface->dmabufFeedbackV1()) {
+        return;
+    }
+
+    m_scanoutFeedback = std::exchange(m_pendingScanoutFeedback, std::nullopt);
+    if (m_scanoutFeedback) {
+        m_surface->dmabufFeedbackV1()->setScanoutTranches(m_scanoutFeedback->device, m_scanoutFeedback->formats);
+    } else {
+        m_surface->dmabufFeedbackV1()->setTranches({});
     }
 }
 
@@ -206,6 +262,8 @@ void SurfaceItemWayland::freeze()
 
     m_surface = nullptr;
     m_fifoFallbackTimer.stop();
+    m_throttledFrameCallbackTimer.stop();
+    m_scanoutFeedbackTimer.stop();
 }
 
 void SurfaceItemWayland::handleColorDescriptionChanged()
@@ -229,11 +287,49 @@ void SurfaceItemWayland::handleAlphaMultiplierChanged()
     setOpacity(m_surface->alphaMultiplier());
 }
 
+bool SurfaceItemWayland::isOccluded() const
+{
+    for (Item *item = parentItem(); item; item = item->parentItem()) {
+        if (auto windowItem = qobject_cast<WindowItem *>(item)) {
+            return windowItem->isOccluded();
+        }
+    }
+    return false;
+}
+
 void SurfaceItemWayland::handleFramePainted(LogicalOutput *output, OutputFrame *frame, std::chrono::milliseconds timestamp)
 {
     if (!m_surface) {
         return;
     }
+    if (s_occludedFrameCallbackInterval > std::chrono::milliseconds::zero() && isOccluded()) {
+        // nothing of the surface is visible, there's no point in letting the client render at the full refresh rate
+        if (!m_throttledFrameCallbackTimer.isActive()) {
+            m_throttledFrameCallbackTimer.start(s_occludedFrameCallbackInterval);
+        }
+        return;
+    }
+    if (m_surface->client()->isThrottled()) {
+        // the client keeps the compositor too busy, slow it down so that other clients get their share
+        if (!m_throttledFrameCallbackTimer.isActive()) {
+            m_throttledFrameCallbackTimer.start(s_throttledClientFrameCallbackInterval);
+        }
+        return;
+    }
+    m_throttledFrameCallbackTimer.stop();
+    sendFrameCallbacks(output, frame, timestamp);
+}
+
+void SurfaceItemWayland::handleThrottledFrameCallback()
+{
+    if (m_surface) {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+        sendFrameCallbacks(nullptr, nullptr, timestamp);
+    }
+}
+
+void SurfaceItemWayland::sendFrameCallbacks(LogicalOutput *output, OutputFrame *frame, std::chrono::milliseconds timestamp)
+{
     m_surface->frameRendered(timestamp.count());
     if (frame) {
         // FIXME make frame always valid
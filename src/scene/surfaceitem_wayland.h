@@ -54,20 +54,29 @@ private Q_SLOTS:
     void handleAlphaMultiplierChanged();
 
     void handleFifoFallback();
+    void handleThrottledFrameCallback();
+    void handleScanoutFeedbackTimeout();
 
 private:
     SurfaceItemWayland *getOrCreateSubSurfaceItem(SubSurfaceInterface *s);
     void handleFramePainted(LogicalOutput *output, OutputFrame *frame, std::chrono::milliseconds timestamp) override;
+    void sendFrameCallbacks(LogicalOutput *output, OutputFrame *frame, std::chrono::milliseconds timestamp);
+    bool isOccluded() const;
 
     QPointer<SurfaceInterface> m_surface;
     struct ScanoutFeedback
     {
         DrmDevice *device = nullptr;
         QHash<uint32_t, QList<uint64_t>> formats;
+
+        bool operator==(const ScanoutFeedback &other) const = default;
     };
     std::optional<ScanoutFeedback> m_scanoutFeedback;
+    std::optional<ScanoutFeedback> m_pendingScanoutFeedback;
     std::unordered_map<SubSurfaceInterface *, std::unique_ptr<SurfaceItemWayland>> m_subsurfaces;
     QTimer m_fifoFallbackTimer;
+    QTimer m_throttledFrameCallbackTimer;
+    QTimer m_scanoutFeedbackTimer;
 };
 
 #if KWIN_BUILD_X11
@@ -130,6 +130,16 @@ void WindowItem::unrefVisible(int reason)
     updateVisibility();
 }
 
+bool WindowItem::isOccluded() const
+{
+    return m_occluded;
+}
+
+void WindowItem::setOccluded(bool occluded)
+{
+    m_occluded = occluded;
+}
+
 void WindowItem::elevate()
 {
     // Not ideal, but it's also highly unlikely that there are more than 1000 windows. The
@@ -197,7 +207,9 @@ void WindowItem::updatePosition()
 void WindowItem::addSurfaceItemDamageConnects(Item *item)
 {
     auto surfaceItem = static_cast<SurfaceItem *>(item);
-    connect(surfaceItem, &SurfaceItem::damaged, this, &WindowItem::markDamaged);
+    connect(surfaceItem, &SurfaceItem::damaged, this, [this, surfaceItem](const QRegion &region) {
+        markRegionDamaged(surfaceItem->mapToScene(region));
+    });
     connect(surfaceItem, &SurfaceItem::childAdded, this, &WindowItem::addSurfaceItemDamageConnects);
     connect(surfaceItem, &SurfaceItem::childRemoved, this, &WindowItem::markDamaged);
     connect(surfaceItem, &SurfaceItem::visibleChanged, this, &WindowItem::markDamaged);
@@ -292,6 +304,12 @@ void WindowItem::updateStackingOrder()
 
 void WindowItem::markDamaged()
 {
+    markRegionDamaged(infiniteRegion());
+}
+
+void WindowItem::markRegionDamaged(const QRegion &region)
+{
+    Q_EMIT damaged(region);
     Q_EMIT m_window->damaged(m_window);
 }
 
@@ -58,6 +58,21 @@ public:
     void elevate();
     void deelevate();
 
+    /**
+     * Returns @c true if the window was fully covered by opaque windows the last
+     * time the output it's on was painted.
+     */
+    bool isOccluded() const;
+    void setOccluded(bool occluded);
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when the contents of the window change. The @a region is
+     * specified in the scene coordinates, it's infinite if the whole window needs to be
+     * considered damaged.
+     */
+    void damaged(const QRegion &region);
+
 protected:
     explicit WindowItem(Window *window, Item *parent = nullptr);
     void updateSurfaceItem(std::unique_ptr<SurfaceItem> &&surfaceItem);
@@ -76,6 +91,7 @@ private:
     bool computeVisibility() const;
     void updateVisibility();
     void markDamaged();
+    void markRegionDamaged(const QRegion &region);
     void freeze();
 
     Window *m_window;
@@ -84,6 +100,7 @@ private:
     std::unique_ptr<ShadowItem> m_shadowItem;
     std::unique_ptr<EffectWindow> m_effectWindow;
     std::optional<int> m_elevation;
+    bool m_occluded = false;
     int m_forceVisibleByHiddenCount = 0;
     int m_forceVisibleByDesktopCount = 0;
     int m_forceVisibleByMinimizeCount = 0;
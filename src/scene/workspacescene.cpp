@@ -64,17 +64,22 @@
 #include "effect/effecthandler.h"
 #include "opengl/eglbackend.h"
 #include "opengl/eglcontext.h"
+#include "opengl/glpassprofiler.h"
 #include "scene/decorationitem.h"
 #include "scene/dndiconitem.h"
 #include "scene/itemrenderer.h"
 #include "scene/rootitem.h"
 #include "scene/surfaceitem.h"
 #include "scene/windowitem.h"
+#include "tracing.h"
 #include "wayland/seat.h"
 #include "wayland_server.h"
 #include "window.h"
 #include "workspace.h"
 
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 #include <QtMath>
 
 namespace KWin
@@ -107,6 +112,8 @@ WorkspaceScene::WorkspaceScene(std::unique_ptr<ItemRenderer> renderer)
 
 WorkspaceScene::~WorkspaceScene()
 {
+    // it may be a child of the cursor item
+    m_dndIcon.reset();
 }
 
 void WorkspaceScene::createDndIconItem()
@@ -117,14 +124,31 @@ void WorkspaceScene::createDndIconItem()
     }
     m_dndIcon = std::make_unique<DragAndDropIconItem>(dragIcon, m_overlayItem.get());
 
-    auto updatePosition = [this]() {
-        const auto position = waylandServer()->seat()->dragPosition();
-        m_dndIcon->setPosition(position);
-        m_dndIcon->setOutput(workspace()->outputAt(position));
-    };
+    updateDndIcon();
+    connect(waylandServer()->seat(), &SeatInterface::dragMoved, m_dndIcon.get(), [this]() {
+        updateDndIcon();
+    });
+}
 
-    updatePosition();
-    connect(waylandServer()->seat(), &SeatInterface::dragMoved, m_dndIcon.get(), updatePosition);
+void WorkspaceScene::updateDndIcon()
+{
+    if (!m_dndIcon) {
+        return;
+    }
+    const QPointF position = waylandServer()->seat()->dragPosition();
+    // with a pointer the icon moves together with the cursor, as a child of the cursor
+    // item both can be put on the cursor plane instead of repainting the scene all the time
+    const bool followCursor = waylandServer()->seat()->isDragPointer() && m_cursorItem->isVisible();
+    if (followCursor) {
+        m_dndIcon->setParentItem(m_cursorItem.get());
+        m_dndIcon->setZ(-1);
+        m_dndIcon->setPosition(position - m_cursorItem->position());
+    } else {
+        m_dndIcon->setParentItem(m_overlayItem.get());
+        m_dndIcon->setZ(0);
+        m_dndIcon->setPosition(position);
+    }
+    m_dndIcon->setOutput(workspace()->outputAt(position));
 }
 
 void WorkspaceScene::destroyDndIconItem()
@@ -140,6 +164,7 @@ void WorkspaceScene::updateCursor()
         m_cursorItem->setVisible(true);
         m_cursorItem->setPosition(Cursors::self()->currentCursor()->pos());
     }
+    updateDndIcon();
 }
 
 Item *WorkspaceScene::containerItem() const
@@ -295,7 +320,22 @@ static QRegion mapToDevice(SceneView *view, Item *item, const QRegion &itemLocal
     return ret;
 }
 
-static bool findOverlayCandidates(SceneView *view, Item *item, ssize_t maxTotalCount, ssize_t maxOverlayCount, ssize_t maxUnderlayCount, QRegion &occupied, QRegion &opaque, QRegion &effected, QList<SurfaceItem *> &overlays, QList<SurfaceItem *> &underlays, QStack<ClipCorner> &corners)
+/**
+ * Items that cover the entire view are left to direct scanout on the primary plane
+ */
+static bool coversView(SceneView *view, SurfaceItem *item)
+{
+    return item->mapToView(item->rect(), view).contains(view->viewport());
+}
+
+static ssize_t countPlaneItems(SceneView *view, const QList<SurfaceItem *> &items)
+{
+    return std::ranges::count_if(items, [view](SurfaceItem *item) {
+        return !coversView(view, item);
+    });
+}
+
+static bool findOverlayCandidates(SceneView *view, Item *item, ssize_t maxTotalCount, ssize_t maxOverlayCount, ssize_t maxUnderlayCount, bool requireRegularUpdates, QRegion &occupied, QRegion &opaque, QRegion &effected, QList<SurfaceItem *> &overlays, QList<SurfaceItem *> &underlays, QStack<ClipCorner> &corners)
 {
     if (!item || !item->isVisible() || item->boundingRect().isEmpty() || !view->viewport().intersects(item->mapToView(item->boundingRect(), view))) {
         return true;
@@ -320,7 +360,7 @@ static bool findOverlayCandidates(SceneView *view, Item *item, ssize_t maxTotalC
         if (child->z() < 0) {
             break;
         }
-        if (!findOverlayCandidates(view, child, maxTotalCount, maxOverlayCount, maxUnderlayCount, occupied, opaque, effected, overlays, underlays, corners)) {
+        if (!findOverlayCandidates(view, child, maxTotalCount, maxOverlayCount, maxUnderlayCount, requireRegularUpdates, occupied, opaque, effected, overlays, underlays, corners)) {
             return false;
         }
     }
@@ -329,7 +369,7 @@ static bool findOverlayCandidates(SceneView *view, Item *item, ssize_t maxTotalC
     // - be a SurfaceItem (for now at least)
     // - not be empty
     // - be the topmost item in the relevant screen area
-    // - regularly get updates
+    // - regularly get updates, unless requireRegularUpdates is false
     // - use dmabufs
     // - not have any surface-wide opacity (for now)
     // - not be entirely covered by other opaque windows
@@ -337,27 +377,36 @@ static bool findOverlayCandidates(SceneView *view, Item *item, ssize_t maxTotalC
     const QRect deviceRect = mapToDevice(view, item, item->rect());
     if (surfaceItem
         && !surfaceItem->rect().isEmpty()
-        && surfaceItem->frameTimeEstimation().transform([](const auto t) {
+        && (!requireRegularUpdates || surfaceItem->frameTimeEstimation().transform([](const auto t) {
         return t < std::chrono::nanoseconds(1'000'000'000) / 20;
-    }).value_or(false)
+    }).value_or(false))
+        && surfaceItem->buffer()
         && surfaceItem->buffer()->dmabufAttributes()
         // TODO make the compositor handle item opacity as well
         && surfaceItem->opacity() == 1.0
         && !regionActuallyContains(opaque, deviceRect)
         && !effected.intersects(deviceRect)) {
+        const bool isOpaque = regionActuallyContains(surfaceItem->opaque(), surfaceItem->rect().toAlignedRect());
         if (occupied.intersects(deviceRect) || (!corners.isEmpty() && corners.top().radius.clips(item->rect(), corners.top().box))) {
-            const bool isOpaque = regionActuallyContains(surfaceItem->opaque(), surfaceItem->rect().toAlignedRect());
             if (!isOpaque) {
                 // only fully opaque items can be used as underlays
                 return false;
             }
             underlays.push_back(surfaceItem);
+        } else if (isOpaque && !coversView(view, surfaceItem) && countPlaneItems(view, overlays) >= maxOverlayCount) {
+            // there's no plane above the primary one left, but an opaque surface can be shown
+            // just as well below it, through a hole in the primary plane. Anything below that
+            // overlaps it has to go below it as well
+            underlays.push_back(surfaceItem);
+            occupied += deviceRect;
         } else {
             overlays.push_back(surfaceItem);
         }
-        if (overlays.size() + underlays.size() > maxTotalCount
-            || overlays.size() > maxOverlayCount
-            || underlays.size() > maxUnderlayCount) {
+        const ssize_t overlayCount = countPlaneItems(view, overlays);
+        const ssize_t underlayCount = countPlaneItems(view, underlays);
+        if (overlayCount + underlayCount > maxTotalCount
+            || overlayCount > maxOverlayCount
+            || underlayCount > maxUnderlayCount) {
             // If we have to repaint the primary plane anyways, it's not going to provide an efficiency
             // or latency improvement to put some but not all quickly updating surfaces on overlays,
             // at least not with the current way we use them.
@@ -370,7 +419,7 @@ static bool findOverlayCandidates(SceneView *view, Item *item, ssize_t maxTotalC
 
     for (; it != children.rend(); it++) {
         Item *const child = *it;
-        if (!findOverlayCandidates(view, child, maxTotalCount, maxOverlayCount, maxUnderlayCount, occupied, opaque, effected, overlays, underlays, corners)) {
+        if (!findOverlayCandidates(view, child, maxTotalCount, maxOverlayCount, maxUnderlayCount, requireRegularUpdates, occupied, opaque, effected, overlays, underlays, corners)) {
             return false;
         }
     }
@@ -382,6 +431,24 @@ Scene::OverlayCandidates WorkspaceScene::overlayCandidates(ssize_t maxTotalCount
     if (effects->blocksDirectScanout()) {
         return {};
     }
+    const OverlayCandidates ret = collectOverlayCandidates(maxTotalCount, maxOverlayCount, maxUnderlayCount, true);
+    const auto coversViewport = [this](SurfaceItem *item) {
+        return coversView(painted_delegate, item);
+    };
+    if (std::ranges::any_of(ret.overlays, coversViewport) || std::ranges::any_of(ret.underlays, coversViewport)) {
+        // If everything on top of a fullscreen surface goes onto other planes, the fullscreen
+        // surface can be scanned out directly, which is worth it even for surfaces that rarely
+        // change, like subtitles or the FPS counter of a game
+        OverlayCandidates relaxed = collectOverlayCandidates(maxTotalCount, maxOverlayCount, maxUnderlayCount, false);
+        if (!relaxed.overlays.isEmpty() || !relaxed.underlays.isEmpty()) {
+            return relaxed;
+        }
+    }
+    return ret;
+}
+
+Scene::OverlayCandidates WorkspaceScene::collectOverlayCandidates(ssize_t maxTotalCount, ssize_t maxOverlayCount, ssize_t maxUnderlayCount, bool requireRegularUpdates) const
+{
     QRegion occupied;
     QRegion opaque;
     QRegion effected;
@@ -394,13 +461,13 @@ Scene::OverlayCandidates WorkspaceScene::overlayCandidates(ssize_t maxTotalCount
         if (item == cursorItem() && !painted_delegate->shouldRenderItem(item)) {
             continue;
         }
-        if (!findOverlayCandidates(painted_delegate, item, maxTotalCount, maxOverlayCount, maxUnderlayCount, occupied, opaque, effected, overlays, underlays, cornerStack)) {
+        if (!findOverlayCandidates(painted_delegate, item, maxTotalCount, maxOverlayCount, maxUnderlayCount, requireRegularUpdates, occupied, opaque, effected, overlays, underlays, cornerStack)) {
             return {};
         }
     }
     const auto items = m_containerItem->sortedChildItems();
     for (Item *item : items | std::views::reverse) {
-        if (!findOverlayCandidates(painted_delegate, item, maxTotalCount, maxOverlayCount, maxUnderlayCount, occupied, opaque, effected, overlays, underlays, cornerStack)) {
+        if (!findOverlayCandidates(painted_delegate, item, maxTotalCount, maxOverlayCount, maxUnderlayCount, requireRegularUpdates, occupied, opaque, effected, overlays, underlays, cornerStack)) {
             return {};
         }
     }
@@ -452,6 +519,7 @@ void WorkspaceScene::frame(SceneView *delegate, OutputFrame *frame)
 
 void WorkspaceScene::prePaint(SceneView *delegate)
 {
+    traceScope(Scene, "prePaint");
     painted_delegate = delegate;
     painted_screen = painted_delegate->output();
 
@@ -476,7 +544,10 @@ void WorkspaceScene::prePaint(SceneView *delegate)
     effects->makeOpenGLContextCurrent();
     Q_EMIT preFrameRender();
 
-    effects->prePaintScreen(prePaintData, m_expectedPresentTimestamp);
+    {
+        traceScope(Effects, "prePaintScreen");
+        effects->prePaintScreen(prePaintData, m_expectedPresentTimestamp);
+    }
     m_paintContext.deviceDamage = painted_delegate->mapToDeviceCoordinatesAligned(prePaintData.paint);
     m_paintContext.mask = prePaintData.mask;
     m_paintContext.phase2Data.clear();
@@ -512,10 +583,101 @@ static void accumulateRepaints(Item *item, SceneView *delegate, QRegion *repaint
     }
 }
 
+/**
+ * The opaque area of an item in view coordinates. It's collected on the main thread, mapping
+ * it to device coordinates doesn't touch the item anymore and can be done on any thread.
+ */
+struct OpaqueArea
+{
+    QRegion opaque;
+    QPointF viewOffset;
+    QRectF viewRect;
+};
+
+struct WindowOpaqueArea
+{
+    std::optional<OpaqueArea> surface;
+    std::optional<OpaqueArea> decoration;
+    QRegion deviceOpaque;
+};
+
+static OpaqueArea opaqueArea(SceneView *delegate, const Item *item)
+{
+    return OpaqueArea{
+        .opaque = item->borderRadius().clip(item->opaque(), item->rect()),
+        // mapping to the view only translates
+        .viewOffset = item->mapToView(QRectF(), delegate).topLeft(),
+        .viewRect = item->mapToView(item->rect(), delegate),
+    };
+}
+
+static QRegion mapOpaqueToDevice(const SceneView *delegate, const OpaqueArea &area)
+{
+    const QRect deviceRect = snapToPixelGrid(delegate->mapToDeviceCoordinates(area.viewRect));
+    QRegion ret;
+    for (QRectF rect : area.opaque) {
+        ret |= snapToPixelGrid(delegate->mapToDeviceCoordinates(rect.translated(area.viewOffset))) & deviceRect;
+    }
+    return ret;
+}
+
+static WindowOpaqueArea windowOpaqueArea(SceneView *delegate, const WindowItem *windowItem)
+{
+    WindowOpaqueArea ret;
+    if (windowItem->window()->opacity() != 1.0) {
+        return ret;
+    }
+    if (const SurfaceItem *surfaceItem = windowItem->surfaceItem(); Q_LIKELY(surfaceItem)) {
+        ret.surface = opaqueArea(delegate, surfaceItem);
+    }
+    if (const DecorationItem *decorationItem = windowItem->decorationItem()) {
+        ret.decoration = opaqueArea(delegate, decorationItem);
+    }
+    return ret;
+}
+
+static void mapWindowOpaqueToDevice(const SceneView *delegate, WindowOpaqueArea &area)
+{
+    if (area.surface) {
+        area.deviceOpaque = mapOpaqueToDevice(delegate, *area.surface);
+    }
+    if (area.decoration) {
+        area.deviceOpaque += mapOpaqueToDevice(delegate, *area.decoration);
+    }
+}
+
+static QThreadPool *scenePreparationPool()
+{
+    static QThreadPool *pool = []() {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(std::clamp(QThread::idealThreadCount() - 1, 1, 4));
+        return pool;
+    }();
+    return pool;
+}
+
+/**
+ * The number of windows from which the opaque regions are mapped on multiple threads. The
+ * region math of a few windows is cheaper than handing it to other threads.
+ */
+static const qsizetype s_parallelOpaqueThreshold = 16;
+
+static void updateOcclusion(SceneView *delegate, WindowItem *windowItem, bool occluded)
+{
+    // frame callbacks are only sent by the output the center of the window is on, see Item::framePainted
+    if (workspace()->outputAt(windowItem->mapToScene(windowItem->boundingRect()).center()) != delegate->output()) {
+        return;
+    }
+    // offscreen rendering means that something wants to show the contents of the window elsewhere
+    windowItem->setOccluded(occluded && !windowItem->window()->isOffscreenRendering());
+}
+
 void WorkspaceScene::preparePaintGenericScreen()
 {
     for (WindowItem *windowItem : std::as_const(stacking_order)) {
         resetRepaintsHelper(windowItem, painted_delegate);
+        // windows may be moved around by effects, occlusion can't be known
+        updateOcclusion(painted_delegate, windowItem, false);
 
         WindowPrePaintData data;
         data.mask = m_paintContext.mask;
@@ -533,40 +695,89 @@ void WorkspaceScene::preparePaintGenericScreen()
 
 void WorkspaceScene::preparePaintSimpleScreen()
 {
-    for (WindowItem *windowItem : std::as_const(stacking_order)) {
-        Window *window = windowItem->window();
-        WindowPrePaintData data;
-        data.mask = m_paintContext.mask;
+    // This is the occlusion culling pass. Windows that are entirely covered by opaque
+    // windows above them don't need to go through the effects chain or be painted at all.
+    // Only windows that no effect is attached to are assumed to occlude others, as effects
+    // may change their opacity or transform in prePaintWindow
+    const qsizetype count = stacking_order.size();
+    QList<WindowOpaqueArea> opaqueAreas(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        opaqueAreas[i] = windowOpaqueArea(painted_delegate, stacking_order[i]);
+    }
+    const auto mapToDevice = [delegate = painted_delegate](WindowOpaqueArea &area) {
+        mapWindowOpaqueToDevice(delegate, area);
+    };
+    if (count >= s_parallelOpaqueThreshold) {
+        traceScope(Scene, "mapOpaqueRegions");
+        QtConcurrent::blockingMap(scenePreparationPool(), opaqueAreas, mapToDevice);
+    } else {
+        std::ranges::for_each(opaqueAreas, mapToDevice);
+    }
 
+    QList<QRegion> deviceOpaque(count);
+    QList<bool> occluded(count, false);
+    QList<bool> culled(count, false);
+    const QRect viewRect = painted_delegate->deviceRect();
+    QRegion occluder;
+    for (qsizetype i = count - 1; i >= 0; --i) {
+        WindowItem *windowItem = stacking_order[i];
         // Clip out the decoration for opaque windows; the decoration is drawn in the second pass.
-        if (window->opacity() == 1.0) {
-            const SurfaceItem *surfaceItem = windowItem->surfaceItem();
-            const auto mapOpaqueToDevice = [this](const Item *item) {
-                const QRegion opaque = item->borderRadius().clip(item->opaque(), item->rect());
-                const QRect deviceRect = snapToPixelGrid(painted_delegate->mapToDeviceCoordinates(item->mapToView(item->rect(), painted_delegate)));
-                QRegion ret;
-                for (QRectF rect : opaque) {
-                    ret |= snapToPixelGrid(painted_delegate->mapToDeviceCoordinates(item->mapToView(rect, painted_delegate))) & deviceRect;
-                }
-                return ret;
-            };
-            if (Q_LIKELY(surfaceItem)) {
-                data.deviceOpaque = mapOpaqueToDevice(surfaceItem);
-            }
-
-            const DecorationItem *decorationItem = windowItem->decorationItem();
-            if (decorationItem) {
-                data.deviceOpaque += mapOpaqueToDevice(decorationItem);
-            }
+        deviceOpaque[i] = std::move(opaqueAreas[i].deviceOpaque);
+        if (!windowItem->hasEffects()) {
+            const QRect deviceRect = snapToPixelGrid(painted_delegate->mapToDeviceCoordinates(windowItem->mapToView(windowItem->boundingRect(), painted_delegate)));
+            // views that show only a part of the scene, such as region screencasts, don't
+            // need to go through the windows outside of it either
+            culled[i] = !deviceRect.intersects(viewRect);
+            occluded[i] = culled[i] || regionActuallyContains(occluder, deviceRect);
+            occluder += deviceOpaque[i];
         }
+    }
+
+    const auto prePaint = [this, &deviceOpaque](qsizetype index) {
+        WindowItem *windowItem = stacking_order[index];
+        WindowPrePaintData data;
+        data.mask = m_paintContext.mask;
+        data.deviceOpaque = deviceOpaque[index];
 
         effects->prePaintWindow(painted_delegate, windowItem->effectWindow(), data, m_expectedPresentTimestamp);
-        m_paintContext.phase2Data.append(Phase2Data{
+        return Phase2Data{
             .item = windowItem,
             .deviceRegion = data.devicePaint,
             .deviceOpaque = data.deviceOpaque,
             .mask = data.mask,
-        });
+        };
+    };
+
+    bool assumptionsHold = true;
+    m_paintContext.phase2Data.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        if (occluded[i]) {
+            m_paintContext.phase2Data.append(Phase2Data{
+                .item = stacking_order[i],
+                .mask = m_paintContext.mask,
+                .occluded = true,
+            });
+            continue;
+        }
+        const Phase2Data &paintData = m_paintContext.phase2Data.emplace_back(prePaint(i));
+        if (!stacking_order[i]->hasEffects() && ((paintData.mask & (PAINT_WINDOW_TRANSLUCENT | PAINT_WINDOW_TRANSFORMED)) || paintData.deviceOpaque != deviceOpaque[i])) {
+            // some effect made the window not cover what it was assumed to cover
+            assumptionsHold = false;
+        }
+    }
+    if (!assumptionsHold) {
+        // rare case, like the whole screen being faded. Let the effects see all windows
+        for (qsizetype i = 0; i < count; ++i) {
+            if (occluded[i]) {
+                m_paintContext.phase2Data[i] = prePaint(i);
+                occluded[i] = false;
+            }
+        }
+    }
+
+    for (qsizetype i = 0; i < count; ++i) {
+        // a window that isn't in the view is not covered by anything
+        updateOcclusion(painted_delegate, stacking_order[i], occluded[i] && !culled[i]);
     }
 }
 
@@ -609,13 +820,17 @@ void WorkspaceScene::paint(const RenderTarget &renderTarget, const QRegion &devi
 
     m_renderer->beginFrame(renderTarget, viewport);
 
-    effects->paintScreen(renderTarget, viewport, m_paintContext.mask, deviceRegion, painted_screen);
+    {
+        traceScope(Effects, "paintScreen");
+        effects->paintScreen(renderTarget, viewport, m_paintContext.mask, deviceRegion, painted_screen);
+    }
     m_paintScreenCount = 0;
 
     if (m_overlayItem) {
         const QRect bounds = viewport.mapToDeviceCoordinates(m_overlayItem->mapToScene(m_overlayItem->boundingRect())).toRect();
         const QRegion deviceRepaint = deviceRegion & bounds;
         if (!deviceRepaint.isEmpty()) {
+            GLPassScope passScope(u"cursor");
             m_renderer->renderItem(renderTarget, viewport, m_overlayItem.get(), PAINT_SCREEN_TRANSFORMED, deviceRepaint, WindowPaintData{}, [this](Item *item) {
                 return !painted_delegate->shouldRenderItem(item);
             }, [this](Item *item) {
@@ -665,6 +880,10 @@ void WorkspaceScene::paintSimpleScreen(const RenderTarget &renderTarget, const R
     QRegion visible = deviceRegion;
     for (int i = m_paintContext.phase2Data.size() - 1; i >= 0; --i) {
         Phase2Data *data = &m_paintContext.phase2Data[i];
+        if (data->occluded) {
+            data->deviceRegion = QRegion();
+            continue;
+        }
         data->deviceRegion = visible;
 
         if (!(data->mask & PAINT_WINDOW_TRANSFORMED)) {
@@ -708,6 +927,8 @@ void WorkspaceScene::paintWindow(const RenderTarget &renderTarget, const RenderV
         return;
     }
 
+    GLPassScope passScope(u"window", item->window()->caption());
+
     WindowPaintData data;
     effects->paintWindow(renderTarget, viewport, item->effectWindow(), mask, deviceRegion, data);
 }
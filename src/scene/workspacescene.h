@@ -88,6 +88,8 @@ protected:
         QRegion deviceRegion;
         QRegion deviceOpaque;
         int mask = 0;
+        // whether the window is hidden behind other windows and skipped the effects chain
+        bool occluded = false;
     };
 
     struct PaintContext
@@ -107,7 +109,9 @@ protected:
 private:
     void createDndIconItem();
     void destroyDndIconItem();
+    void updateDndIcon();
     void updateCursor();
+    OverlayCandidates collectOverlayCandidates(ssize_t maxTotalCount, ssize_t maxOverlayCount, ssize_t maxUnderlayCount, bool requireRegularUpdates) const;
 
     std::chrono::milliseconds m_expectedPresentTimestamp = std::chrono::milliseconds::zero();
     // how many times finalPaintScreen() has been called
@@ -107,9 +107,9 @@ void DesktopBackgroundItem::updateWindow()
 
     Window *clientCandidate = nullptr;
 
-    const auto clients = workspace()->windows();
+    const auto clients = workspace()->windowsOnDesktop(desktop);
     for (Window *client : clients) {
-        if (client->isDesktop() && client->isOnOutput(m_output) && client->isOnDesktop(desktop) && client->isOnActivity(activity)) {
+        if (client->isDesktop() && client->isOnOutput(m_output) && client->isOnActivity(activity)) {
             // In the unlikely event there are multiple desktop windows (e.g. conky's floating panel is of type "desktop")
             // choose the one which matches the output size, if possible.
             if (!clientCandidate || client->size() == m_output->geometry().size()) {
@@ -212,6 +212,8 @@ ScriptedEffect::ScriptedEffect()
     , m_chainPosition(0)
 {
     Q_ASSERT(effects);
+    // Scripted effects change windows only through animations
+    setPaintsSelectedWindowsOnly(true);
     connect(effects, &EffectsHandler::activeFullScreenEffectChanged, this, [this]() {
         Effect *fullScreenEffect = effects->activeFullScreenEffect();
         if (fullScreenEffect == m_activeFullScreenEffect) {
@@ -370,7 +372,7 @@ QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType an
 
         const int length = static_cast<int>(animations.property(QStringLiteral("length")).toInt());
         for (int i = 0; i < length; ++i) {
-            QJSValue value = animations.property(QString::number(i));
+            QJSValue value = animations.property(quint32(i));
             if (value.isObject()) {
                 AnimationSettings s = animationSettingsFromObject(value);
                 const uint set = s.set | settings.at(0).set;
@@ -528,8 +530,9 @@ bool ScriptedEffect::retarget(quint64 animationId, const QJSValue &newTarget, in
 
 bool ScriptedEffect::retarget(const QList<quint64> &animationIds, const QJSValue &newTarget, int newRemainingTime)
 {
+    const FPx2 target = fpx2FromScriptValue(newTarget);
     return std::all_of(animationIds.begin(), animationIds.end(), [&](quint64 animationId) {
-        return retarget(animationId, newTarget, newRemainingTime);
+        return AnimationEffect::retarget(animationId, target, newRemainingTime);
     });
 }
 
@@ -55,6 +55,9 @@
 #include <QStandardPaths>
 #include <QtConcurrentRun>
 
+#include <chrono>
+#include <time.h>
+
 #include "scriptadaptor.h"
 
 static QRect scriptValueToQRect(const QJSValue &value)
@@ -147,6 +150,13 @@ KWin::ScriptTimer::ScriptTimer(QObject *parent)
 {
 }
 
+static std::chrono::nanoseconds threadCpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
 KWin::Script::Script(int id, QString scriptName, QString pluginName, QObject *parent)
     : AbstractScript(id, scriptName, pluginName, parent)
     , m_engine(new QJSEngine(this))
@@ -297,7 +307,9 @@ void KWin::Script::slotScriptLoadedFromFile()
     )"));
     Q_ASSERT(!result.isError());
 
+    const auto start = threadCpuTime();
     result = m_engine->evaluate(QString::fromUtf8(watcher->result()), fileName());
+    m_cpuTime += threadCpuTime() - start;
     if (result.isError()) {
         qCWarning(KWIN_SCRIPTING, "%s:%d: error: %s", qPrintable(fileName()),
                   result.property(QStringLiteral("lineNumber")).toInt(),
@@ -392,7 +404,7 @@ void KWin::Script::callDBus(const QString &service, const QString &path, const Q
             arguments << m_engine->toScriptValue(dbusToVariant(variant));
         }
 
-        QJSValue(callback).call(arguments);
+        invoke(callback, arguments);
     });
 }
 
@@ -411,7 +423,7 @@ bool KWin::Script::registerShortcut(const QString &objectName, const QString &te
     KGlobalAccel::self()->setShortcut(action, {shortcut});
 
     connect(action, &QAction::triggered, this, [this, action, callback]() {
-        QJSValue(callback).call({m_engine->toScriptValue(action)});
+        invoke(callback, {m_engine->toScriptValue(action)});
     });
 
     return true;
@@ -461,8 +473,8 @@ bool KWin::Script::registerTouchScreenEdge(int edge, const QJSValue &callback)
     workspace()->screenEdges()->reserveTouch(KWin::ElectricBorder(edge), action);
     m_touchScreenEdgeCallbacks.insert(edge, action);
 
-    connect(action, &QAction::triggered, this, [callback]() {
-        QJSValue(callback).call();
+    connect(action, &QAction::triggered, this, [this, callback]() {
+        invoke(callback);
     });
 
     return true;
@@ -495,8 +507,8 @@ QList<QAction *> KWin::Script::actionsForUserActionMenu(KWin::Window *client, QM
     QList<QAction *> actions;
     actions.reserve(m_userActionsMenuCallbacks.count());
 
-    for (QJSValue callback : std::as_const(m_userActionsMenuCallbacks)) {
-        const QJSValue result = callback.call({m_engine->toScriptValue(client)});
+    for (const QJSValue &callback : std::as_const(m_userActionsMenuCallbacks)) {
+        const QJSValue result = invoke(callback, {m_engine->toScriptValue(client)});
         if (result.isError()) {
             continue;
         }
@@ -517,12 +529,43 @@ bool KWin::Script::slotBorderActivated(ElectricBorder border)
     if (callbacks.isEmpty()) {
         return false;
     }
-    std::for_each(callbacks.begin(), callbacks.end(), [](QJSValue callback) {
-        callback.call();
-    });
+    for (const QJSValue &callback : callbacks) {
+        invoke(callback);
+    }
     return true;
 }
 
+QJSValue KWin::Script::invoke(QJSValue callback, const QJSValueList &arguments)
+{
+    const auto start = threadCpuTime();
+    const QJSValue result = callback.call(arguments);
+    accountCpuTime(threadCpuTime() - start);
+    return result;
+}
+
+void KWin::Script::accountCpuTime(std::chrono::nanoseconds cpuTime)
+{
+    // a script that takes longer than a frame to handle an event makes the whole desktop stutter
+    static constexpr std::chrono::milliseconds budget(10);
+    // don't flood the journal with the warnings of a script that is slow all the time
+    static constexpr std::chrono::seconds warningInterval(10);
+
+    m_cpuTime += cpuTime;
+    if (cpuTime <= budget) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_lastBudgetWarning < warningInterval) {
+        return;
+    }
+    m_lastBudgetWarning = now;
+    qCWarning(KWIN_SCRIPTING, "%s took %lldms to handle an event (%lldms in total), which is more than its budget of %lldms",
+              qPrintable(fileName()),
+              qlonglong(std::chrono::duration_cast<std::chrono::milliseconds>(cpuTime).count()),
+              qlonglong(std::chrono::duration_cast<std::chrono::milliseconds>(m_cpuTime).count()),
+              qlonglong(budget.count()));
+}
+
 QAction *KWin::Script::scriptValueToAction(const QJSValue &value, QMenu *parent)
 {
     const QString title = value.property(QStringLiteral("text")).toString();
@@ -554,7 +597,7 @@ QAction *KWin::Script::createAction(const QString &title, const QJSValue &item,
     action->setChecked(checked);
 
     connect(action, &QAction::triggered, this, [this, action, callback]() {
-        QJSValue(callback).call({m_engine->toScriptValue(action)});
+        invoke(callback, {m_engine->toScriptValue(action)});
     });
 
     return action;
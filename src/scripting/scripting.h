@@ -22,6 +22,8 @@
 #include <QDBusContext>
 #include <QDBusMessage>
 
+#include <chrono>
+
 class QQmlComponent;
 class QQmlContext;
 class QQmlEngine;
@@ -241,12 +243,21 @@ private:
      */
     QAction *createMenu(const QString &title, const QJSValue &items, QMenu *parent);
 
+    /**
+     * Calls @a callback with the given @a arguments and warns if it took longer than the
+     * budget that a script has for handling a single event.
+     */
+    QJSValue invoke(QJSValue callback, const QJSValueList &arguments = QJSValueList());
+    void accountCpuTime(std::chrono::nanoseconds cpuTime);
+
     QJSEngine *m_engine;
     QDBusMessage m_invocationContext;
     bool m_starting;
     QHash<int, QJSValueList> m_screenEdgeCallbacks;
     QHash<int, QAction *> m_touchScreenEdgeCallbacks;
     QJSValueList m_userActionsMenuCallbacks;
+    std::chrono::nanoseconds m_cpuTime = std::chrono::nanoseconds::zero();
+    std::chrono::steady_clock::time_point m_lastBudgetWarning;
 };
 
 class DeclarativeScript : public AbstractScript
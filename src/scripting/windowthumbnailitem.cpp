@@ -29,18 +29,22 @@
 #include <QSGImageNode>
 #include <QSGTextureProvider>
 
+#include <algorithm>
+#include <cmath>
+
 namespace KWin
 {
 
+static const int s_maxMipLevels = 4;
+
 static bool useGlThumbnails()
 {
     static bool qtQuickIsSoftware = QStringList({QStringLiteral("software"), QStringLiteral("softwarecontext")}).contains(QQuickWindow::sceneGraphBackend());
     return Compositor::self()->backend() && Compositor::self()->backend()->compositingType() == OpenGLCompositing && !qtQuickIsSoftware;
 }
 
-WindowThumbnailSource::WindowThumbnailSource(QQuickWindow *view, Window *handle)
-    : m_view(view)
-    , m_handle(handle)
+WindowThumbnailSource::WindowThumbnailSource(Window *handle)
+    : m_handle(handle)
 {
     connect(handle, &Window::frameGeometryChanged, this, [this]() {
         m_dirty = true;
@@ -78,25 +82,21 @@ WindowThumbnailSource::~WindowThumbnailSource()
     }
 }
 
-std::shared_ptr<WindowThumbnailSource> WindowThumbnailSource::getOrCreate(QQuickWindow *window, Window *handle)
+std::shared_ptr<WindowThumbnailSource> WindowThumbnailSource::getOrCreate(Window *handle)
 {
-    using WindowThumbnailSourceKey = std::pair<QQuickWindow *, Window *>;
-    const WindowThumbnailSourceKey key{window, handle};
-
-    static std::map<WindowThumbnailSourceKey, std::weak_ptr<WindowThumbnailSource>> sources;
-    auto &source = sources[key];
+    // All views share their textures with kwin's opengl context, so the overview, the task
+    // switcher and the like can share one thumbnail of a window too
+    static std::map<Window *, std::weak_ptr<WindowThumbnailSource>> sources;
+    auto &source = sources[handle];
     if (!source.expired()) {
         return source.lock();
     }
 
-    auto s = std::make_shared<WindowThumbnailSource>(window, handle);
+    auto s = std::make_shared<WindowThumbnailSource>(handle);
     source = s;
 
-    QObject::connect(handle, &Window::destroyed, [key]() {
-        sources.erase(key);
-    });
-    QObject::connect(window, &QQuickWindow::destroyed, [key]() {
-        sources.erase(key);
+    QObject::connect(handle, &Window::destroyed, [handle]() {
+        sources.erase(handle);
     });
     return s;
 }
@@ -105,28 +105,96 @@ WindowThumbnailSource::Frame WindowThumbnailSource::acquire()
 {
     return Frame{
         .texture = m_offscreenTexture,
-        .fence = std::exchange(m_acquireFence, nullptr),
+        .fence = m_acquireFence,
+        .mipmapped = m_offscreenLevels > 1,
     };
 }
 
+void WindowThumbnailSource::setConsumerSize(const void *consumer, const QSize &size, qreal devicePixelRatio)
+{
+    const QSize previousSize = requestedSize();
+    const qreal previousDevicePixelRatio = requestedDevicePixelRatio();
+    if (size.isEmpty()) {
+        m_consumers.erase(consumer);
+    } else {
+        m_consumers[consumer] = Consumer{
+            .size = size,
+            .devicePixelRatio = devicePixelRatio,
+        };
+    }
+
+    // A thumbnail that has to grow must be rendered again, a smaller one can be scaled down
+    // until the window gets damaged the next time
+    const QSize currentSize = requestedSize();
+    if (currentSize.width() > previousSize.width() || currentSize.height() > previousSize.height()
+        || requestedDevicePixelRatio() > previousDevicePixelRatio) {
+        m_dirty = true;
+        Q_EMIT changed();
+    }
+}
+
+QSize WindowThumbnailSource::requestedSize() const
+{
+    QSize size;
+    for (const auto &[key, consumer] : m_consumers) {
+        size = size.expandedTo(consumer.size);
+    }
+    if (size.isEmpty()) {
+        return QSize();
+    }
+
+    // Round the size up so the texture is not reallocated in every frame of an animation
+    // that resizes the thumbnail
+    constexpr int granularity = 64;
+    return QSize((size.width() + granularity - 1) / granularity * granularity,
+                 (size.height() + granularity - 1) / granularity * granularity);
+}
+
+qreal WindowThumbnailSource::requestedDevicePixelRatio() const
+{
+    qreal devicePixelRatio = 0;
+    for (const auto &[key, consumer] : m_consumers) {
+        devicePixelRatio = std::max(devicePixelRatio, consumer.devicePixelRatio);
+    }
+    return devicePixelRatio;
+}
+
+QSize WindowThumbnailSource::textureSize(const QSize &fullSize) const
+{
+    const QSize requestedSize = this->requestedSize();
+    if (requestedSize.isEmpty()) {
+        return QSize();
+    }
+    if (requestedSize.width() >= fullSize.width() || requestedSize.height() >= fullSize.height()) {
+        return fullSize;
+    }
+    return fullSize.scaled(requestedSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+}
+
 void WindowThumbnailSource::update()
 {
-    if (m_acquireFence || !m_dirty || !m_handle) {
+    if (!m_dirty || !m_handle || m_consumers.empty()) {
         return;
     }
-    Q_ASSERT(m_view);
 
     const QRectF geometry = m_handle->visibleGeometry();
-    const qreal devicePixelRatio = m_view->devicePixelRatio();
-    const QSize textureSize = geometry.toAlignedRect().size() * devicePixelRatio;
+    const QSize textureSize = this->textureSize(geometry.toAlignedRect().size() * requestedDevicePixelRatio());
+    if (textureSize.isEmpty()) {
+        return;
+    }
+    const qreal devicePixelRatio = textureSize.width() / geometry.width();
 
     if (!m_offscreenTexture || m_offscreenTexture->size() != textureSize) {
-        m_offscreenTexture = GLTexture::allocate(GL_RGBA8, textureSize);
+        // Consumers that show the thumbnail smaller than the biggest one sample the mipmaps,
+        // which are downscaled once per refresh rather than in every frame of every view
+        const int levels = std::clamp(int(std::log2(std::max(textureSize.width(), textureSize.height()))) + 1, 1, s_maxMipLevels);
+        m_offscreenTexture = GLTexture::allocate(GL_RGBA8, textureSize, levels);
         if (!m_offscreenTexture) {
             return;
         }
+        m_offscreenLevels = levels;
         m_offscreenTexture->setContentTransform(OutputTransform::FlipY);
-        m_offscreenTexture->setFilter(GL_LINEAR);
+        m_offscreenTexture->setFilter(levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
         m_offscreenTexture->setWrapMode(GL_CLAMP_TO_EDGE);
         m_offscreenTarget = std::make_unique<GLFramebuffer>(m_offscreenTexture.get());
     }
@@ -144,8 +212,18 @@ void WindowThumbnailSource::update()
     Compositor::self()->scene()->renderer()->renderItem(offscreenRenderTarget, offscreenViewport, m_handle->windowItem(), mask, infiniteRegion(), WindowPaintData{}, {}, {});
     GLFramebuffer::popFramebuffer();
 
+    if (m_offscreenLevels > 1) {
+        m_offscreenTexture->bind();
+        m_offscreenTexture->generateMipmaps();
+        m_offscreenTexture->unbind();
+    }
+
     // The fence is needed to avoid the case where qtquick renderer starts using
-    // the texture while all rendering commands to it haven't completed yet.
+    // the texture while all rendering commands to it haven't completed yet. Every
+    // consumer waits for it, so it stays around until the next refresh.
+    if (m_acquireFence) {
+        glDeleteSync(m_acquireFence);
+    }
     m_dirty = false;
     m_acquireFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
@@ -158,7 +236,7 @@ public:
     explicit ThumbnailTextureProvider(QQuickWindow *window);
 
     QSGTexture *texture() const override;
-    void setTexture(const std::shared_ptr<GLTexture> &nativeTexture);
+    void setTexture(const std::shared_ptr<GLTexture> &nativeTexture, bool mipmapped);
     void setTexture(QSGTexture *texture);
 
 private:
@@ -177,15 +255,20 @@ QSGTexture *ThumbnailTextureProvider::texture() const
     return m_texture.get();
 }
 
-void ThumbnailTextureProvider::setTexture(const std::shared_ptr<GLTexture> &nativeTexture)
+void ThumbnailTextureProvider::setTexture(const std::shared_ptr<GLTexture> &nativeTexture, bool mipmapped)
 {
     if (m_nativeTexture != nativeTexture) {
         const GLuint textureId = nativeTexture->texture();
+        QQuickWindow::CreateTextureOptions options = QQuickWindow::TextureHasAlphaChannel;
+        if (mipmapped) {
+            options |= QQuickWindow::TextureHasMipmaps;
+        }
         m_nativeTexture = nativeTexture;
         m_texture.reset(QNativeInterface::QSGOpenGLTexture::fromNative(textureId, m_window,
                                                                        nativeTexture->size(),
-                                                                       QQuickWindow::TextureHasAlphaChannel));
+                                                                       options));
         m_texture->setFiltering(QSGTexture::Linear);
+        m_texture->setMipmapFiltering(mipmapped ? QSGTexture::Linear : QSGTexture::None);
         m_texture->setHorizontalWrapMode(QSGTexture::ClampToEdge);
         m_texture->setVerticalWrapMode(QSGTexture::ClampToEdge);
     }
@@ -231,6 +314,7 @@ WindowThumbnailItem::WindowThumbnailItem(QQuickItem *parent)
 
 WindowThumbnailItem::~WindowThumbnailItem()
 {
+    resetSource();
     if (m_provider) {
         if (window()) {
             window()->scheduleRenderJob(new ThumbnailTextureProviderCleanupJob(m_provider),
@@ -260,10 +344,18 @@ void WindowThumbnailItem::itemChange(QQuickItem::ItemChange change, const QQuick
 {
     if (change == QQuickItem::ItemSceneChange) {
         updateSource();
+    } else if (change == QQuickItem::ItemVisibleHasChanged) {
+        updateConsumerSize();
     }
     QQuickItem::itemChange(change, value);
 }
 
+void WindowThumbnailItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    updateConsumerSize();
+}
+
 bool WindowThumbnailItem::isTextureProvider() const
 {
     return true;
@@ -282,16 +374,41 @@ QSGTextureProvider *WindowThumbnailItem::textureProvider() const
 
 void WindowThumbnailItem::resetSource()
 {
-    m_source.reset();
+    if (m_source) {
+        disconnect(m_source.get(), nullptr, this, nullptr);
+        m_source->setConsumerSize(this, QSize(), 0);
+        m_source.reset();
+    }
 }
 
 void WindowThumbnailItem::updateSource()
 {
     if (useGlThumbnails() && window() && m_client) {
-        m_source = WindowThumbnailSource::getOrCreate(window(), m_client);
-        connect(m_source.get(), &WindowThumbnailSource::changed, this, &WindowThumbnailItem::update);
+        auto source = WindowThumbnailSource::getOrCreate(m_client);
+        if (source != m_source) {
+            resetSource();
+            m_source = source;
+            connect(m_source.get(), &WindowThumbnailSource::changed, this, &WindowThumbnailItem::update);
+        }
+        updateConsumerSize();
     } else {
-        m_source.reset();
+        resetSource();
+    }
+}
+
+void WindowThumbnailItem::updateConsumerSize()
+{
+    if (!m_source) {
+        return;
+    }
+    // Hidden thumbnails, e.g. the delegates of a switcher that are scrolled out of view,
+    // don't make the window render. They keep showing the last frame once they're visible
+    // again until a fresh one arrives.
+    if (isVisible() && window()) {
+        const qreal devicePixelRatio = window()->devicePixelRatio();
+        m_source->setConsumerSize(this, (paintedRect().size() * devicePixelRatio).toSize(), devicePixelRatio);
+    } else {
+        m_source->setConsumerSize(this, QSize(), 0);
     }
 }
 
@@ -301,7 +418,7 @@ QSGNode *WindowThumbnailItem::updatePaintNode(QSGNode *oldNode, QQuickItem::Upda
         return oldNode;
     }
 
-    auto [texture, acquireFence] = m_source->acquire();
+    auto [texture, acquireFence, mipmapped] = m_source->acquire();
     if (!texture) {
         return oldNode;
     }
@@ -309,19 +426,19 @@ QSGNode *WindowThumbnailItem::updatePaintNode(QSGNode *oldNode, QQuickItem::Upda
     // Wait for rendering commands to the offscreen texture complete if there are any.
     if (acquireFence) {
         glWaitSync(acquireFence, 0, GL_TIMEOUT_IGNORED);
-        glDeleteSync(acquireFence);
     }
 
     if (!m_provider) {
         m_provider = new ThumbnailTextureProvider(window());
     }
-    m_provider->setTexture(texture);
+    m_provider->setTexture(texture, mipmapped);
 
     QSGImageNode *node = static_cast<QSGImageNode *>(oldNode);
     if (!node) {
         node = window()->createImageNode();
         node->setFiltering(QSGTexture::Linear);
     }
+    node->setMipmapFiltering(mipmapped ? QSGTexture::Linear : QSGTexture::None);
     node->setTexture(m_provider->texture());
     node->setTextureCoordinatesTransform(QSGImageNode::NoTransform);
     node->setRect(paintedRect());
@@ -365,11 +482,15 @@ void WindowThumbnailItem::setClient(Window *client)
     if (m_client) {
         disconnect(m_client, &Window::frameGeometryChanged,
                    this, &WindowThumbnailItem::updateImplicitSize);
+        disconnect(m_client, &Window::frameGeometryChanged,
+                   this, &WindowThumbnailItem::updateConsumerSize);
     }
     m_client = client;
     if (m_client) {
         connect(m_client, &Window::frameGeometryChanged,
                 this, &WindowThumbnailItem::updateImplicitSize);
+        connect(m_client, &Window::frameGeometryChanged,
+                this, &WindowThumbnailItem::updateConsumerSize);
         setWId(m_client->internalId());
     } else {
         setWId(QUuid());
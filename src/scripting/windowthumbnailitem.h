@@ -12,6 +12,8 @@
 
 #include <epoxy/gl.h>
 
+#include <unordered_map>
+
 namespace KWin
 {
 class Window;
@@ -25,32 +27,53 @@ class WindowThumbnailSource : public QObject
     Q_OBJECT
 
 public:
-    WindowThumbnailSource(QQuickWindow *view, Window *handle);
+    explicit WindowThumbnailSource(Window *handle);
     ~WindowThumbnailSource() override;
 
-    static std::shared_ptr<WindowThumbnailSource> getOrCreate(QQuickWindow *window, Window *handle);
+    static std::shared_ptr<WindowThumbnailSource> getOrCreate(Window *handle);
 
     struct Frame
     {
         std::shared_ptr<GLTexture> texture;
         GLsync fence;
+        bool mipmapped;
     };
 
     Frame acquire();
 
+    /**
+     * Sets the size in device pixels at which the @a consumer shows the thumbnail. The
+     * thumbnail is rendered only as large as the biggest consumer needs it, and not at all
+     * if there are no consumers. An empty @a size withdraws the consumer.
+     *
+     * The thumbnail is shared by all views, so it is rendered once for the biggest
+     * consumer, and the smaller ones sample its mipmaps.
+     */
+    void setConsumerSize(const void *consumer, const QSize &size, qreal devicePixelRatio);
+
 Q_SIGNALS:
     void changed();
 
 private:
     void update();
+    QSize requestedSize() const;
+    qreal requestedDevicePixelRatio() const;
+    QSize textureSize(const QSize &fullSize) const;
+
+    struct Consumer
+    {
+        QSize size;
+        qreal devicePixelRatio;
+    };
 
-    QPointer<QQuickWindow> m_view;
     QPointer<Window> m_handle;
 
     std::shared_ptr<GLTexture> m_offscreenTexture;
     std::unique_ptr<GLFramebuffer> m_offscreenTarget;
+    int m_offscreenLevels = 1;
     GLsync m_acquireFence = 0;
     bool m_dirty = true;
+    std::unordered_map<const void *, Consumer> m_consumers;
 };
 
 class WindowThumbnailItem : public QQuickItem
@@ -76,6 +99,7 @@ public:
 protected:
     void releaseResources() override;
     void itemChange(QQuickItem::ItemChange change, const QQuickItem::ItemChangeData &value) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 
 Q_SIGNALS:
     void wIdChanged();
@@ -99,6 +123,7 @@ private:
     void updateImplicitSize();
     void updateSource();
     void resetSource();
+    void updateConsumerSize();
 
     QUuid m_wId;
     QPointer<Window> m_client;
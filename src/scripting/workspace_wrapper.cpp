@@ -60,6 +60,14 @@ WorkspaceWrapper::WorkspaceWrapper(QObject *parent)
     connect(Cursors::self()->mouse(), &Cursor::posChanged, this, &WorkspaceWrapper::cursorPosChanged);
 }
 
+WorkspaceWrapper::~WorkspaceWrapper()
+{
+    // A script that is unloaded in the middle of a transaction must not leave it open
+    while (m_geometryTransactions > 0 && Workspace::self()) {
+        endGeometryTransaction();
+    }
+}
+
 VirtualDesktop *WorkspaceWrapper::currentDesktop() const
 {
     return VirtualDesktopManager::self()->currentDesktop();
@@ -329,6 +337,23 @@ void WorkspaceWrapper::unconstrain(KWin::Window *below, KWin::Window *above)
     KWin::Workspace::self()->unconstrain(below, above);
 }
 
+void WorkspaceWrapper::beginGeometryTransaction()
+{
+    m_geometryTransactions++;
+    KWin::Workspace::self()->beginGeometryTransaction();
+}
+
+void WorkspaceWrapper::endGeometryTransaction()
+{
+    // Don't let an unbalanced call from a script end a transaction that somebody else began
+    if (m_geometryTransactions == 0) {
+        qCWarning(KWIN_SCRIPTING) << "endGeometryTransaction() called without beginGeometryTransaction()";
+        return;
+    }
+    m_geometryTransactions--;
+    KWin::Workspace::self()->endGeometryTransaction();
+}
+
 #if KWIN_BUILD_X11
 Window *WorkspaceWrapper::getClient(qulonglong windowId)
 {
@@ -341,18 +366,11 @@ Window *WorkspaceWrapper::getClient(qulonglong windowId)
 QList<KWin::Window *> WorkspaceWrapper::windowAt(const QPointF &pos, int count) const
 {
     QList<KWin::Window *> result;
-    int found = 0;
-    const QList<Window *> &stacking = workspace()->stackingOrder();
-    if (stacking.isEmpty()) {
-        return result;
-    }
-    auto it = stacking.end();
-    do {
-        if (found == count) {
-            return result;
+    const QList<Window *> candidates = workspace()->windowsAt(pos);
+    for (Window *window : candidates) {
+        if (result.size() == count) {
+            break;
         }
-        --it;
-        Window *window = (*it);
         if (window->isDeleted()) {
             continue;
         }
@@ -361,9 +379,8 @@ QList<KWin::Window *> WorkspaceWrapper::windowAt(const QPointF &pos, int count)
         }
         if (window->hitTest(pos)) {
             result.append(window);
-            found++;
         }
-    } while (it != stacking.begin());
+    }
     return result;
 }
 
@@ -73,6 +73,8 @@ class WorkspaceWrapper : public QObject
 private:
     Q_DISABLE_COPY(WorkspaceWrapper)
 
+    int m_geometryTransactions = 0;
+
 Q_SIGNALS:
     void windowAdded(KWin::Window *window);
     void windowRemoved(KWin::Window *window);
@@ -189,6 +191,7 @@ public:
 
 protected:
     explicit WorkspaceWrapper(QObject *parent = nullptr);
+    ~WorkspaceWrapper() override;
 
 public:
     Window *activeWindow() const;
@@ -336,6 +339,24 @@ public:
      */
     Q_INVOKABLE void unconstrain(KWin::Window *below, KWin::Window *above);
 
+    /**
+     * Starts batching geometry changes. Windows that are moved or resized until the matching
+     * endGeometryTransaction() call are shown with their new geometry together, once all of
+     * them have applied it, so re-tiling many windows looks like a single frame.
+     *
+     * Calls may be nested, every call must be matched by a call to endGeometryTransaction().
+     *
+     * @since 6.6
+     */
+    Q_INVOKABLE void beginGeometryTransaction();
+
+    /**
+     * Ends the geometry transaction started with beginGeometryTransaction().
+     *
+     * @since 6.6
+     */
+    Q_INVOKABLE void endGeometryTransaction();
+
 public Q_SLOTS:
     // all the available key bindings
     void slotSwitchDesktopNext();
@@ -10,6 +10,7 @@
 
 #include "sm.h"
 
+#include <chrono>
 #include <cstdlib>
 #include <kconfig.h>
 #include <pwd.h>
@@ -38,6 +39,8 @@ using namespace Qt::StringLiterals;
 namespace KWin
 {
 
+static constexpr std::chrono::milliseconds s_restoreSettleInterval(250);
+
 static KConfig *sessionConfig(QString id, QString key)
 {
     static KConfig *config = nullptr;
@@ -193,6 +196,35 @@ void SessionManager::loadSession(const QString &sessionName)
     KConfigGroup cg(sessionConfig(sessionName, QString()), QStringLiteral("Session"));
     Q_EMIT loadSessionRequested(sessionName);
     addSessionInfo(cg);
+    if (!session.isEmpty()) {
+        beginRestore();
+    }
+}
+
+/**
+ * Blocks the stacking order updates while the windows of the loaded session are being
+ * managed, so the stack is computed and propagated once rather than once per window.
+ * The batch ends when no restored window has shown up for a while, when every saved
+ * window has been matched, or at the latest after a timeout.
+ */
+void SessionManager::beginRestore()
+{
+    if (!m_restoring) {
+        m_restoring = true;
+        workspace()->blockStackingUpdates(true);
+    }
+    m_restoreSettleTimer.start();
+    m_restoreTimeoutTimer.start();
+}
+
+void SessionManager::endRestore()
+{
+    m_restoreSettleTimer.stop();
+    m_restoreTimeoutTimer.stop();
+    if (m_restoring) {
+        m_restoring = false;
+        workspace()->blockStackingUpdates(false);
+    }
 }
 
 void SessionManager::addSessionInfo(KConfigGroup &cg)
@@ -298,6 +330,14 @@ std::optional<SessionInfo> SessionManager::takeSessionInfo(X11Window *c)
             }
         }
     }
+    if (realInfo && m_restoring) {
+        if (session.isEmpty()) {
+            // let the window finish being managed before restacking
+            m_restoreSettleTimer.start(0);
+        } else {
+            m_restoreSettleTimer.start(s_restoreSettleInterval);
+        }
+    }
     return realInfo;
 }
 #endif
@@ -307,6 +347,13 @@ SessionManager::SessionManager(QObject *parent)
 {
     new SessionAdaptor(this);
     QDBusConnection::sessionBus().registerObject(QStringLiteral("/Session"), this);
+
+    m_restoreSettleTimer.setSingleShot(true);
+    m_restoreSettleTimer.setInterval(s_restoreSettleInterval);
+    connect(&m_restoreSettleTimer, &QTimer::timeout, this, &SessionManager::endRestore);
+    m_restoreTimeoutTimer.setSingleShot(true);
+    m_restoreTimeoutTimer.setInterval(std::chrono::seconds(1));
+    connect(&m_restoreTimeoutTimer, &QTimer::timeout, this, &SessionManager::endRestore);
 }
 
 SessionState SessionManager::state() const
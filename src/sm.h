@@ -77,6 +77,9 @@ private:
 
     void updateWaylandCancelNotification();
 
+    void beginRestore();
+    void endRestore();
+
     SessionState m_sessionState = SessionState::Normal;
 
     int m_sessionActiveClient;
@@ -88,6 +91,11 @@ private:
     QTimer m_logoutAnywayTimer;
     std::unique_ptr<QObject> m_closingWindowsGuard;
     QPointer<KNotification> m_cancelNotification;
+
+    // the stacking order is updated once the restored windows have shown up
+    bool m_restoring = false;
+    QTimer m_restoreSettleTimer;
+    QTimer m_restoreTimeoutTimer;
 };
 
 struct SessionInfo
@@ -0,0 +1,84 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "startuptimeline.h"
+#include "utils/common.h"
+
+namespace KWin
+{
+
+static double toMilliseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+StartupTimeline::StartupTimeline()
+    : m_start(std::chrono::steady_clock::now())
+{
+}
+
+void StartupTimeline::addPhase(const char *name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    std::lock_guard lock(m_mutex);
+    if (m_finished) {
+        return;
+    }
+    m_phases.append(Phase{
+        .name = name,
+        .start = start - m_start,
+        .duration = end - start,
+    });
+}
+
+QList<StartupTimeline::Phase> StartupTimeline::phases() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_phases;
+}
+
+void StartupTimeline::finish()
+{
+    std::lock_guard lock(m_mutex);
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_totalDuration = std::chrono::steady_clock::now() - m_start;
+    for (const Phase &phase : std::as_const(m_phases)) {
+        qCInfo(KWIN_CORE, "Startup phase %s took %.2f ms, starting at %.2f ms", phase.name, toMilliseconds(phase.duration), toMilliseconds(phase.start));
+    }
+    qCInfo(KWIN_CORE, "The first frame was presented after %.2f ms", toMilliseconds(m_totalDuration));
+}
+
+bool StartupTimeline::isFinished() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_finished;
+}
+
+std::chrono::nanoseconds StartupTimeline::totalDuration() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_totalDuration;
+}
+
+StartupPhase::StartupPhase(StartupTimeline *timeline, const char *name)
+    : m_timeline(timeline)
+    , m_name(name)
+    , m_start(std::chrono::steady_clock::now())
+    , m_traceScope(name)
+{
+}
+
+StartupPhase::~StartupPhase()
+{
+    m_timeline->addPhase(m_name, m_start, std::chrono::steady_clock::now());
+}
+
+} // namespace KWin
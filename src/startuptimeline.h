@@ -0,0 +1,83 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "effect/globals.h"
+#include "tracing.h"
+
+#include <QList>
+
+#include <chrono>
+#include <mutex>
+
+namespace KWin
+{
+
+/**
+ * The StartupTimeline class records how long the phases of the startup take, from the moment
+ * the timeline is created until the first frame has been presented. Every phase is also recorded
+ * as a span in the "startup" trace category. The phases may overlap and may be recorded from any
+ * thread.
+ */
+class KWIN_EXPORT StartupTimeline
+{
+public:
+    struct Phase
+    {
+        const char *name;
+        // relative to the creation of the timeline
+        std::chrono::nanoseconds start;
+        std::chrono::nanoseconds duration;
+    };
+
+    StartupTimeline();
+
+    /**
+     * The @a name must be a string literal, only the pointer is kept.
+     */
+    void addPhase(const char *name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+    QList<Phase> phases() const;
+
+    /**
+     * Marks the startup as finished and writes the phases to the log. Phases that end
+     * afterwards are not recorded anymore.
+     */
+    void finish();
+    bool isFinished() const;
+    std::chrono::nanoseconds totalDuration() const;
+
+private:
+    const std::chrono::steady_clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    QList<Phase> m_phases;
+    std::chrono::nanoseconds m_totalDuration = std::chrono::nanoseconds::zero();
+    bool m_finished = false;
+};
+
+/**
+ * Records a phase of the startup from its construction to its destruction.
+ */
+class KWIN_EXPORT StartupPhase
+{
+public:
+    StartupPhase(StartupTimeline *timeline, const char *name);
+    ~StartupPhase();
+
+    StartupPhase(const StartupPhase &) = delete;
+    StartupPhase &operator=(const StartupPhase &) = delete;
+
+private:
+    StartupTimeline *const m_timeline;
+    const char *const m_name;
+    const std::chrono::steady_clock::time_point m_start;
+    TraceScope<TraceCategory::Startup> m_traceScope;
+};
+
+} // namespace KWin
@@ -0,0 +1,267 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "stateexport.h"
+#include "compositor.h"
+#include "core/backendoutput.h"
+#include "core/output.h"
+#include "core/renderjournal.h"
+#include "core/renderloop.h"
+#include "utils/common.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <QFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace KWin
+{
+
+StateExportBuffer::StateExportBuffer(const QString &fileName, FileDescriptor &&fd, MemoryMap &&map)
+    : m_fileName(fileName)
+    , m_fd(std::move(fd))
+    , m_map(std::move(map))
+{
+    new (m_map.data()) StateExportSegment{
+        .magic = s_stateExportMagic,
+        .version = s_stateExportVersion,
+        .size = sizeof(StateExportSegment),
+        .padding = 0,
+        .sequence = 0,
+        .snapshot = {},
+    };
+}
+
+StateExportBuffer::~StateExportBuffer()
+{
+    unlink(QFile::encodeName(m_fileName).constData());
+}
+
+std::unique_ptr<StateExportBuffer> StateExportBuffer::create(const QString &fileName)
+{
+    const QByteArray encodedFileName = QFile::encodeName(fileName);
+    // the snapshot contains window captions, only the user may look at it
+    FileDescriptor fd(open(encodedFileName.constData(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+    if (!fd.isValid()) {
+        qCWarning(KWIN_CORE) << "Failed to create" << fileName << strerror(errno);
+        return nullptr;
+    }
+    if (ftruncate(fd.get(), sizeof(StateExportSegment)) < 0) {
+        qCWarning(KWIN_CORE) << "Failed to resize" << fileName << strerror(errno);
+        unlink(encodedFileName.constData());
+        return nullptr;
+    }
+    MemoryMap map(sizeof(StateExportSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (!map.isValid()) {
+        qCWarning(KWIN_CORE) << "Failed to map" << fileName << strerror(errno);
+        unlink(encodedFileName.constData());
+        return nullptr;
+    }
+    return std::unique_ptr<StateExportBuffer>(new StateExportBuffer(fileName, std::move(fd), std::move(map)));
+}
+
+QString StateExportBuffer::fileName() const
+{
+    return m_fileName;
+}
+
+static size_t snapshotSize(const StateExportSnapshot &snapshot)
+{
+    return offsetof(StateExportSnapshot, windows) + snapshot.windowCount * sizeof(StateExportWindow);
+}
+
+void StateExportBuffer::publish(const StateExportSnapshot &snapshot)
+{
+    auto segment = static_cast<StateExportSegment *>(m_map.data());
+    const uint64_t sequence = segment->sequence.load(std::memory_order_relaxed);
+    segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // the window entries past windowCount are stale, leave them
+    std::memcpy(&segment->snapshot, &snapshot, snapshotSize(snapshot));
+    segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool StateExportBuffer::read(const StateExportSegment *segment, StateExportSnapshot *snapshot)
+{
+    if (segment->magic != s_stateExportMagic || segment->version != s_stateExportVersion || segment->size != sizeof(StateExportSegment)) {
+        return false;
+    }
+    // the writer publishes once per frame, so a few attempts are plenty
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        const uint64_t before = segment->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        std::memcpy(snapshot, &segment->snapshot, offsetof(StateExportSnapshot, windows));
+        snapshot->outputCount = std::min(snapshot->outputCount, s_stateExportMaxOutputs);
+        snapshot->windowCount = std::min(snapshot->windowCount, s_stateExportMaxWindows);
+        std::memcpy(snapshot->windows, segment->snapshot.windows, snapshot->windowCount * sizeof(StateExportWindow));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<size_t size>
+static void copyString(char (&target)[size], const QString &source)
+{
+    const QByteArray utf8 = source.toUtf8();
+    qsizetype length = std::min<qsizetype>(utf8.size(), size - 1);
+    // don't cut a multi-byte sequence in half
+    if (length < utf8.size()) {
+        while (length > 0 && (uchar(utf8[length]) & 0xc0) == 0x80) {
+            --length;
+        }
+    }
+    std::memcpy(target, utf8.constData(), length);
+    std::memset(target + length, 0, size - length);
+}
+
+StateExport::StateExport(const QString &socketName, QObject *parent)
+    : QObject(parent)
+    , m_snapshot(std::make_unique<StateExportSnapshot>())
+{
+    const QString runtimeDirectory = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    m_buffer = StateExportBuffer::create(runtimeDirectory + QLatin1String("/kwin-state-") + socketName);
+    if (!m_buffer) {
+        return;
+    }
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(0);
+    connect(&m_updateTimer, &QTimer::timeout, this, &StateExport::update);
+
+    const auto outputs = workspace()->outputs();
+    for (LogicalOutput *output : outputs) {
+        handleOutputAdded(output);
+    }
+    connect(workspace(), &Workspace::outputAdded, this, &StateExport::handleOutputAdded);
+    connect(workspace(), &Workspace::outputRemoved, this, &StateExport::handleOutputRemoved);
+}
+
+StateExport::~StateExport() = default;
+
+void StateExport::handleOutputAdded(LogicalOutput *output)
+{
+    RenderLoop *renderLoop = output->backendOutput()->renderLoop();
+    if (!renderLoop) {
+        return;
+    }
+    m_presentations.insert(renderLoop, Presentation{});
+    connect(renderLoop, &RenderLoop::framePresented, this, [this](RenderLoop *loop, std::chrono::nanoseconds timestamp) {
+        auto it = m_presentations.find(loop);
+        if (it != m_presentations.end()) {
+            it->count++;
+            it->timestamp = timestamp;
+        }
+        if (!m_updateTimer.isActive()) {
+            m_updateTimer.start();
+        }
+    });
+    m_updateTimer.start();
+}
+
+void StateExport::handleOutputRemoved(LogicalOutput *output)
+{
+    if (RenderLoop *renderLoop = output->backendOutput()->renderLoop()) {
+        disconnect(renderLoop, nullptr, this, nullptr);
+        m_presentations.remove(renderLoop);
+    }
+    m_updateTimer.start();
+}
+
+void StateExport::update()
+{
+    StateExportSnapshot &snapshot = *m_snapshot;
+    snapshot.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    snapshot.compositingActive = Compositor::self() && Compositor::self()->isActive();
+
+    snapshot.outputCount = 0;
+    const auto outputs = workspace()->outputs();
+    for (LogicalOutput *output : outputs) {
+        if (snapshot.outputCount == s_stateExportMaxOutputs) {
+            break;
+        }
+        StateExportOutput &entry = snapshot.outputs[snapshot.outputCount++];
+        const QRect geometry = output->geometry();
+        copyString(entry.name, output->name());
+        entry.x = geometry.x();
+        entry.y = geometry.y();
+        entry.width = geometry.width();
+        entry.height = geometry.height();
+        entry.scale = output->scale();
+        entry.refreshRate = 0;
+        entry.presentedFrames = 0;
+        entry.missedDeadlines = 0;
+        entry.lastPresentation = 0;
+        if (RenderLoop *renderLoop = output->backendOutput()->renderLoop()) {
+            const Presentation presentation = m_presentations.value(renderLoop);
+            entry.refreshRate = renderLoop->refreshRate();
+            entry.presentedFrames = presentation.count;
+            entry.missedDeadlines = renderLoop->missedDeadlines().total();
+            entry.lastPresentation = presentation.timestamp.count();
+        }
+    }
+
+    snapshot.windowCount = 0;
+    const auto windows = workspace()->stackingOrder();
+    for (const Window *window : windows) {
+        if (window->isDeleted() || !window->isClient()) {
+            continue;
+        }
+        if (snapshot.windowCount == s_stateExportMaxWindows) {
+            break;
+        }
+        StateExportWindow &entry = snapshot.windows[snapshot.windowCount++];
+        const QRect geometry = window->frameGeometry().toRect();
+        copyString(entry.uuid, window->internalId().toString());
+        copyString(entry.resourceClass, window->resourceClass());
+        copyString(entry.caption, window->caption());
+        entry.x = geometry.x();
+        entry.y = geometry.y();
+        entry.width = geometry.width();
+        entry.height = geometry.height();
+        entry.pid = window->pid();
+        entry.flags = 0;
+        if (window->isActive()) {
+            entry.flags |= StateExportWindowActive;
+        }
+        if (window->isMinimized()) {
+            entry.flags |= StateExportWindowMinimized;
+        }
+        if (window->isFullScreen()) {
+            entry.flags |= StateExportWindowFullScreen;
+        }
+        if (window->maximizeMode() == MaximizeFull) {
+            entry.flags |= StateExportWindowMaximized;
+        }
+        if (window->keepAbove()) {
+            entry.flags |= StateExportWindowKeepAbove;
+        }
+        if (window->isOnCurrentDesktop()) {
+            entry.flags |= StateExportWindowOnCurrentDesktop;
+        }
+    }
+
+    m_buffer->publish(snapshot);
+}
+
+} // namespace KWin
+
+#include "moc_stateexport.cpp"
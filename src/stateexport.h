@@ -0,0 +1,165 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "utils/filedescriptor.h"
+#include "utils/memorymap.h"
+
+#include <kwin_export.h>
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace KWin
+{
+
+class LogicalOutput;
+class RenderLoop;
+
+/**
+ * The layout of the exported state. Readers must check the magic, the version and the size
+ * before looking at anything else, the version is bumped whenever the layout changes.
+ *
+ * Strings are UTF-8, null terminated and truncated to fit. Timestamps use CLOCK_MONOTONIC.
+ */
+static constexpr uint32_t s_stateExportMagic = 0x5453574b; // "KWST"
+static constexpr uint32_t s_stateExportVersion = 1;
+static constexpr uint32_t s_stateExportMaxOutputs = 16;
+static constexpr uint32_t s_stateExportMaxWindows = 512;
+
+struct StateExportOutput
+{
+    char name[32];
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    float scale;
+    // in millihertz
+    uint32_t refreshRate;
+    uint64_t presentedFrames;
+    uint64_t missedDeadlines;
+    int64_t lastPresentation;
+};
+
+enum StateExportWindowFlag : uint32_t {
+    StateExportWindowActive = 1 << 0,
+    StateExportWindowMinimized = 1 << 1,
+    StateExportWindowFullScreen = 1 << 2,
+    StateExportWindowMaximized = 1 << 3,
+    StateExportWindowKeepAbove = 1 << 4,
+    StateExportWindowOnCurrentDesktop = 1 << 5,
+};
+
+struct StateExportWindow
+{
+    char uuid[40];
+    char resourceClass[64];
+    char caption[128];
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int32_t pid;
+    uint32_t flags;
+};
+
+struct StateExportSnapshot
+{
+    int64_t timestamp;
+    uint32_t compositingActive;
+    uint32_t outputCount;
+    // the windows are in the stacking order, bottom most first
+    uint32_t windowCount;
+    uint32_t padding;
+    StateExportOutput outputs[s_stateExportMaxOutputs];
+    StateExportWindow windows[s_stateExportMaxWindows];
+};
+
+struct StateExportSegment
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t padding;
+    // odd while the snapshot is being written
+    std::atomic<uint64_t> sequence;
+    StateExportSnapshot snapshot;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+/**
+ * The StateExportBuffer class shares a StateExportSegment with other processes through a file,
+ * which is normally on a tmpfs. The snapshot is guarded by a sequence lock: the writer never
+ * waits for the readers, and a reader that raced with the writer simply reads again.
+ */
+class KWIN_EXPORT StateExportBuffer
+{
+public:
+    ~StateExportBuffer();
+
+    static std::unique_ptr<StateExportBuffer> create(const QString &fileName);
+
+    QString fileName() const;
+    void publish(const StateExportSnapshot &snapshot);
+
+    /**
+     * Copies the snapshot out of a mapped @a segment. Returns @c false if the segment has an
+     * unknown layout or the writer kept updating it.
+     */
+    static bool read(const StateExportSegment *segment, StateExportSnapshot *snapshot);
+
+private:
+    StateExportBuffer(const QString &fileName, FileDescriptor &&fd, MemoryMap &&map);
+
+    QString m_fileName;
+    FileDescriptor m_fd;
+    MemoryMap m_map;
+};
+
+/**
+ * The StateExport class exports compositor statistics and window metadata to
+ * $XDG_RUNTIME_DIR/kwin-state-$WAYLAND_DISPLAY, so that monitoring tools can look at them
+ * without asking KWin over D-Bus. The snapshot is refreshed at most once per event loop turn
+ * after a frame has been presented.
+ */
+class StateExport : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StateExport(const QString &socketName, QObject *parent = nullptr);
+    ~StateExport() override;
+
+private:
+    void handleOutputAdded(LogicalOutput *output);
+    void handleOutputRemoved(LogicalOutput *output);
+    void update();
+
+    struct Presentation
+    {
+        uint64_t count = 0;
+        std::chrono::nanoseconds timestamp = std::chrono::nanoseconds::zero();
+    };
+
+    std::unique_ptr<StateExportBuffer> m_buffer;
+    std::unique_ptr<StateExportSnapshot> m_snapshot;
+    QHash<RenderLoop *, Presentation> m_presentations;
+    QTimer m_updateTimer;
+};
+
+} // namespace KWin
@@ -23,11 +23,13 @@ SyncAlarmX11Filter::SyncAlarmX11Filter()
 bool SyncAlarmX11Filter::event(xcb_generic_event_t *event)
 {
     auto alarmEvent = reinterpret_cast<xcb_sync_alarm_notify_event_t *>(event);
-    auto client = workspace()->findClient([alarmEvent](const X11Window *client) {
-        const auto syncRequest = client->syncRequest();
-        return alarmEvent->alarm == syncRequest.alarm && alarmEvent->counter_value.hi == syncRequest.value.hi && alarmEvent->counter_value.lo == syncRequest.value.lo;
-    });
-    if (client) {
+    X11Window *client = workspace()->findX11WindowBySyncAlarm(alarmEvent->alarm);
+    if (!client) {
+        return false;
+    }
+    // Alarms for older sync requests are stale, only the latest one matters
+    const auto &syncRequest = client->syncRequest();
+    if (alarmEvent->counter_value.hi == syncRequest.value.hi && alarmEvent->counter_value.lo == syncRequest.value.lo) {
         client->ackSync();
     }
     return false;
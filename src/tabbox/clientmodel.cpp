@@ -14,6 +14,7 @@
 #include <KLocalizedString>
 
 #include <QIcon>
+#include <QSet>
 #include <QUuid>
 
 #include <cmath>
@@ -239,9 +240,37 @@ void ClientModel::createClientList(bool partialReset)
         return;
     }
 
-    beginResetModel();
-    m_clientList = m_mutableClientList;
-    endResetModel();
+    updateClientList(m_mutableClientList);
+}
+
+void ClientModel::updateClientList(const QList<Window *> &clients)
+{
+    // Report the changes row by row rather than resetting the model, so that the switcher
+    // keeps the delegates of the windows that are still there
+    const QSet<Window *> kept(clients.constBegin(), clients.constEnd());
+    for (int i = m_clientList.count() - 1; i >= 0; --i) {
+        if (!kept.contains(m_clientList[i])) {
+            beginRemoveRows(QModelIndex(), i, i);
+            m_clientList.removeAt(i);
+            endRemoveRows();
+        }
+    }
+
+    for (int i = 0; i < clients.count(); ++i) {
+        if (i < m_clientList.count() && m_clientList[i] == clients[i]) {
+            continue;
+        }
+        const int from = m_clientList.indexOf(clients[i], i + 1);
+        if (from != -1) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            m_clientList.move(from, i);
+            endMoveRows();
+        } else {
+            beginInsertRows(QModelIndex(), i, i);
+            m_clientList.insert(i, clients[i]);
+            endInsertRows();
+        }
+    }
 }
 
 void ClientModel::close(int i)
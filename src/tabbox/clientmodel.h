@@ -89,6 +89,7 @@ public Q_SLOTS:
 private:
     void createFocusChainClientList(Window *start);
     void createStackingOrderClientList(Window *start);
+    void updateClientList(const QList<Window *> &clients);
 
     QList<Window *> m_clientList;
     QList<Window *> m_mutableClientList;
@@ -30,6 +30,8 @@
 #include <QHoverEvent>
 #include <QWindow>
 
+#include <utility>
+
 namespace KWin
 {
 
@@ -85,6 +87,9 @@ private:
 TabletInputRedirection::TabletInputRedirection(InputRedirection *parent)
     : InputDeviceHandler(parent)
 {
+    m_resamplingTimer.setSingleShot(true);
+    m_resamplingTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_resamplingTimer, &QTimer::timeout, this, &TabletInputRedirection::sendResampledAxisEvents);
 }
 
 TabletInputRedirection::~TabletInputRedirection() = default;
@@ -214,7 +219,70 @@ void TabletInputRedirection::tabletToolAxisEvent(const QPointF &pos, qreal press
     if (!inited()) {
         return;
     }
+    if (!resamplesMotion()) {
+        processToolAxisEvent(pos, pressure, xTilt, yTilt, rotation, distance, tipDown, sliderPosition, tool, time, device);
+        return;
+    }
 
+    auto it = m_resampledTools.find(tool);
+    if (it == m_resampledTools.end()) {
+        it = m_resampledTools.insert(tool, ResampledTool{});
+        connect(tool, &QObject::destroyed, this, [this, tool]() {
+            m_resampledTools.remove(tool);
+        });
+    }
+    it->device = device;
+    it->resampler.addSample(pos, time);
+    it->pressure = pressure;
+    it->xTilt = xTilt;
+    it->yTilt = yTilt;
+    it->rotation = rotation;
+    it->distance = distance;
+    it->sliderPosition = sliderPosition;
+    it->tipDown = tipDown;
+    it->queued = true;
+    if (!m_resamplingTimer.isActive()) {
+        m_resamplingTimer.start(timeUntilNextRefreshCycle(pos));
+    }
+}
+
+void TabletInputRedirection::flushQueuedAxisEvent(InputDeviceTabletTool *tool)
+{
+    auto it = m_resampledTools.find(tool);
+    if (it == m_resampledTools.end() || !std::exchange(it->queued, false)) {
+        return;
+    }
+    // the events that follow are at the last reported position, don't predict anything
+    it->lastDispatchedTime = std::max(it->lastDispatchedTime, it->resampler.lastTime());
+    const ResampledTool state = *it;
+    if (state.device) {
+        processToolAxisEvent(state.resampler.lastPosition(), state.pressure, state.xTilt, state.yTilt, state.rotation, state.distance, state.tipDown, state.sliderPosition, tool, state.lastDispatchedTime, state.device);
+    }
+}
+
+void TabletInputRedirection::sendResampledAxisEvents()
+{
+    if (!inited()) {
+        return;
+    }
+    // the maximum extrapolation past the last reported position, whatever the time
+    static constexpr std::chrono::microseconds maxPrediction = std::chrono::milliseconds(20);
+    const std::chrono::microseconds time = resamplingTime();
+    QList<std::pair<InputDeviceTabletTool *, ResampledTool>> events;
+    for (auto it = m_resampledTools.begin(); it != m_resampledTools.end(); ++it) {
+        if (std::exchange(it->queued, false) && it->device) {
+            it->lastDispatchedTime = std::max(it->lastDispatchedTime, time);
+            events.append(std::make_pair(it.key(), *it));
+        }
+    }
+    // the filters may remove tools, so the events are sent after going through the tools
+    for (const auto &[tool, state] : std::as_const(events)) {
+        processToolAxisEvent(state.resampler.positionAt(time, maxPrediction), state.pressure, state.xTilt, state.yTilt, state.rotation, state.distance, state.tipDown, state.sliderPosition, tool, state.lastDispatchedTime, state.device);
+    }
+}
+
+void TabletInputRedirection::processToolAxisEvent(const QPointF &pos, qreal pressure, qreal xTilt, qreal yTilt, qreal rotation, qreal distance, bool tipDown, qreal sliderPosition, InputDeviceTabletTool *tool, std::chrono::microseconds time, InputDevice *device)
+{
     ensureTabletTool(tool);
 
     m_lastPosition = pos;
@@ -238,7 +306,7 @@ void TabletInputRedirection::tabletToolAxisEvent(const QPointF &pos, qreal press
     };
 
     input()->processSpies(&InputEventSpy::tabletToolAxisEvent, &ev);
-    input()->processFilters(&InputEventFilter::tabletToolAxisEvent, &ev);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletToolAxisEvent, &ev);
     input()->setLastInputHandler(this);
 }
 
@@ -278,7 +346,7 @@ void TabletInputRedirection::tabletToolAxisEventRelative(const QPointF &delta,
     };
 
     input()->processSpies(&InputEventSpy::tabletToolAxisEvent, &ev);
-    input()->processFilters(&InputEventFilter::tabletToolAxisEvent, &ev);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletToolAxisEvent, &ev);
     input()->setLastInputHandler(this);
 }
 
@@ -287,6 +355,11 @@ void TabletInputRedirection::tabletToolProximityEvent(const QPointF &pos, qreal
     if (!inited()) {
         return;
     }
+    flushQueuedAxisEvent(tool);
+    if (auto it = m_resampledTools.find(tool); it != m_resampledTools.end()) {
+        // the tool may come back anywhere
+        it->resampler.reset();
+    }
 
     ensureTabletTool(tool);
 
@@ -315,7 +388,7 @@ void TabletInputRedirection::tabletToolProximityEvent(const QPointF &pos, qreal
     };
 
     input()->processSpies(&InputEventSpy::tabletToolProximityEvent, &ev);
-    input()->processFilters(&InputEventFilter::tabletToolProximityEvent, &ev);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletToolProximityEvent, &ev);
     input()->setLastInputHandler(this);
 }
 
@@ -324,6 +397,7 @@ void TabletInputRedirection::tabletToolTipEvent(const QPointF &pos, qreal pressu
     if (!inited()) {
         return;
     }
+    flushQueuedAxisEvent(tool);
 
     ensureTabletTool(tool);
 
@@ -363,7 +437,7 @@ void TabletInputRedirection::tabletToolTipEvent(const QPointF &pos, qreal pressu
     };
 
     input()->processSpies(&InputEventSpy::tabletToolTipEvent, &ev);
-    input()->processFilters(&InputEventFilter::tabletToolTipEvent, &ev);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletToolTipEvent, &ev);
     input()->setLastInputHandler(this);
     if (tipDown) {
         input()->setLastInteractionSerial(waylandServer()->seat()->display()->serial());
@@ -383,12 +457,13 @@ void KWin::TabletInputRedirection::tabletToolButtonEvent(uint button, bool isPre
         .time = time,
     };
 
+    flushQueuedAxisEvent(tool);
     ensureTabletTool(tool);
 
     m_buttonDown = isPressed;
 
     input()->processSpies(&InputEventSpy::tabletToolButtonEvent, &event);
-    input()->processFilters(&InputEventFilter::tabletToolButtonEvent, &event);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletToolButtonEvent, &event);
     input()->setLastInputHandler(this);
     if (isPressed) {
         input()->setLastInteractionSerial(waylandServer()->seat()->display()->serial());
@@ -410,7 +485,7 @@ void KWin::TabletInputRedirection::tabletPadButtonEvent(uint button, bool isPres
         .time = time,
     };
     input()->processSpies(&InputEventSpy::tabletPadButtonEvent, &event);
-    input()->processFilters(&InputEventFilter::tabletPadButtonEvent, &event);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletPadButtonEvent, &event);
     input()->setLastInputHandler(this);
     if (isPressed) {
         input()->setLastInteractionSerial(waylandServer()->seat()->display()->serial());
@@ -433,7 +508,7 @@ void KWin::TabletInputRedirection::tabletPadStripEvent(int number, qreal positio
     };
 
     input()->processSpies(&InputEventSpy::tabletPadStripEvent, &event);
-    input()->processFilters(&InputEventFilter::tabletPadStripEvent, &event);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletPadStripEvent, &event);
     input()->setLastInputHandler(this);
 }
 
@@ -450,7 +525,7 @@ void KWin::TabletInputRedirection::tabletPadRingEvent(int number, qreal position
     };
 
     input()->processSpies(&InputEventSpy::tabletPadRingEvent, &event);
-    input()->processFilters(&InputEventFilter::tabletPadRingEvent, &event);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletPadRingEvent, &event);
     input()->setLastInputHandler(this);
 }
 
@@ -466,7 +541,7 @@ void KWin::TabletInputRedirection::tabletPadDialEvent(int number, double delta,
     };
 
     input()->processSpies(&InputEventSpy::tabletPadDialEvent, &event);
-    input()->processFilters(&InputEventFilter::tabletPadDialEvent, &event);
+    input()->processFilters(InputEventKind::Tablet, &InputEventFilter::tabletPadDialEvent, &event);
     input()->setLastInputHandler(this);
 }
 
@@ -9,11 +9,13 @@
 
 #pragma once
 #include "input.h"
+#include "utils/motionresampler.h"
 
 #include <QHash>
 #include <QObject>
 #include <QPointF>
 #include <QPointer>
+#include <QTimer>
 
 namespace KWin
 {
@@ -70,12 +72,37 @@ private:
     void trackNextOutput();
     void ensureTabletTool(InputDeviceTabletTool *tool);
 
+    void processToolAxisEvent(const QPointF &pos, qreal pressure, qreal xTilt, qreal yTilt, qreal rotation, qreal distance, bool tipDown, qreal sliderPosition, InputDeviceTabletTool *tool, std::chrono::microseconds time, InputDevice *device);
+    void flushQueuedAxisEvent(InputDeviceTabletTool *tool);
+    void sendResampledAxisEvents();
+
+    /**
+     * The latest axis event of a tool, which is held back until the next refresh cycle. Only
+     * the position is resampled, the other axes are sent as they were reported last.
+     */
+    struct ResampledTool
+    {
+        QPointer<InputDevice> device;
+        MotionResampler resampler;
+        qreal pressure = 0;
+        qreal xTilt = 0;
+        qreal yTilt = 0;
+        qreal rotation = 0;
+        qreal distance = 0;
+        qreal sliderPosition = 0;
+        bool tipDown = false;
+        std::chrono::microseconds lastDispatchedTime = std::chrono::microseconds::zero();
+        bool queued = false;
+    };
+
     QPointF m_lastPosition;
     QMetaObject::Connection m_decorationGeometryConnection;
     QMetaObject::Connection m_decorationDestroyedConnection;
     QHash<InputDeviceTabletTool *, Cursor *> m_cursorByTool;
     bool m_tipDown = false;
     bool m_buttonDown = false;
+    QHash<InputDeviceTabletTool *, ResampledTool> m_resampledTools;
+    QTimer m_resamplingTimer;
 };
 
 }
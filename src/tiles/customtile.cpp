@@ -65,6 +65,9 @@ void CustomTile::setRelativeGeometry(const QRectF &geom)
     }
 
     auto *parentT = static_cast<CustomTile *>(parentTile());
+    // Moving an edge resizes the neighbors and the descendants too, their windows are
+    // updated once the whole layout has been recomputed
+    TileLayoutUpdatesBlocker blocker(m_tiling);
 
     if (!m_geometryLock && parentT && parentT->layoutDirection() != LayoutDirection::Floating) {
         m_geometryLock = true;
@@ -137,6 +137,11 @@ void Tile::setRelativeGeometry(const QRectF &geom)
     Q_EMIT absoluteGeometryChanged();
     Q_EMIT windowGeometryChanged();
 
+    m_tiling->scheduleWindowGeometryUpdate(this);
+}
+
+void Tile::updateWindowGeometries()
+{
     if (isActive()) {
         for (auto *w : std::as_const(m_windows)) {
             // Resize only if we are the currently managing tile for that window
@@ -240,15 +245,11 @@ void Tile::setPadding(qreal padding)
 
     m_padding = padding;
 
+    TileLayoutUpdatesBlocker blocker(m_tiling);
     for (auto *t : std::as_const(m_children)) {
         t->setPadding(padding);
     }
-    if (isActive()) {
-        for (auto *w : std::as_const(m_windows)) {
-            // Resize only if we are the currently managing tile for that window
-            w->moveResize(windowGeometry());
-        }
-    }
+    m_tiling->scheduleWindowGeometryUpdate(this);
 
     Q_EMIT paddingChanged(padding);
     Q_EMIT windowGeometryChanged();
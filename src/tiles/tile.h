@@ -57,6 +57,12 @@ public:
     void setGeometryFromAbsolute(const QRectF &geom);
     virtual void setRelativeGeometry(const QRectF &geom);
 
+    /**
+     * Moves and resizes the windows in this tile to the geometry of the tile, if it's the tile
+     * that manages them currently.
+     */
+    void updateWindowGeometries();
+
     virtual bool supportsResizeGravity(Gravity gravity);
 
     /**
@@ -282,8 +282,41 @@ static QString generateOutputId(LogicalOutput *output)
     return QUuid::createUuidV5(kwinNs, payload).toString(QUuid::StringFormat::WithoutBraces);
 }
 
+void TileManager::beginLayoutUpdate()
+{
+    m_layoutUpdateNesting++;
+}
+
+void TileManager::endLayoutUpdate()
+{
+    Q_ASSERT(m_layoutUpdateNesting > 0);
+    if (--m_layoutUpdateNesting > 0) {
+        return;
+    }
+
+    // All windows get their final geometries together
+    GeometryTransactionScope transaction(workspace());
+    const auto tiles = std::exchange(m_pendingWindowGeometryUpdates, {});
+    for (Tile *tile : tiles) {
+        if (tile) {
+            tile->updateWindowGeometries();
+        }
+    }
+}
+
+void TileManager::scheduleWindowGeometryUpdate(Tile *tile)
+{
+    if (m_layoutUpdateNesting == 0) {
+        GeometryTransactionScope transaction(workspace());
+        tile->updateWindowGeometries();
+    } else if (!m_pendingWindowGeometryUpdates.contains(tile)) {
+        m_pendingWindowGeometryUpdates.append(tile);
+    }
+}
+
 void TileManager::readSettings(RootTile *rootTile)
 {
+    TileLayoutUpdatesBlocker blocker(this);
     KConfigGroup cg = kwinApp()->config()->group(QStringLiteral("Tiling"));
     qreal padding = cg.readEntry("padding", 4);
     VirtualDesktop *desk = rootTile->desktop();
@@ -18,6 +18,7 @@
 
 #include <QAbstractItemModel>
 #include <QObject>
+#include <QPointer>
 #include <QRectF>
 
 #include <QJsonValue>
@@ -60,6 +61,19 @@ public:
     Tile *tileForWindow(Window *window, VirtualDesktop *desktop);
     void forgetWindow(Window *window, VirtualDesktop *desktop);
 
+    /**
+     * Defers moving and resizing the windows in the tiles until the matching endLayoutUpdate()
+     * call. While the layout is being recomputed, a tile can change its geometry several times,
+     * its windows are updated only once with the final geometry afterwards.
+     */
+    void beginLayoutUpdate();
+    void endLayoutUpdate();
+
+    /**
+     * Updates the windows in the @a tile, or later if a layout update is in progress.
+     */
+    void scheduleWindowGeometryUpdate(Tile *tile);
+
 Q_SIGNALS:
     void tileRemoved(KWin::Tile *tile);
     void rootTileChanged(CustomTile *rootTile);
@@ -79,10 +93,33 @@ private:
     QHash<VirtualDesktop *, RootTile *> m_rootTiles;
     QHash<VirtualDesktop *, QuickRootTile *> m_quickRootTiles;
 
+    int m_layoutUpdateNesting = 0;
+    QList<QPointer<Tile>> m_pendingWindowGeometryUpdates;
+
     bool m_tearingDown = false;
     friend class CustomTile;
 };
 
+/**
+ * Helper for TileManager::beginLayoutUpdate() and endLayoutUpdate() being called in pairs
+ */
+class TileLayoutUpdatesBlocker
+{
+public:
+    explicit TileLayoutUpdatesBlocker(TileManager *manager)
+        : m_manager(manager)
+    {
+        m_manager->beginLayoutUpdate();
+    }
+    ~TileLayoutUpdatesBlocker()
+    {
+        m_manager->endLayoutUpdate();
+    }
+
+private:
+    TileManager *m_manager;
+};
+
 KWIN_EXPORT QDebug operator<<(QDebug debug, const TileManager *tileManager);
 
 } // namespace KWin
@@ -30,12 +30,20 @@
 #include <QHoverEvent>
 #include <QWindow>
 
+#include <utility>
+
 namespace KWin
 {
 
+// the resampled position is never predicted further ahead than this, whatever the time
+static constexpr std::chrono::microseconds s_maxPrediction = std::chrono::milliseconds(20);
+
 TouchInputRedirection::TouchInputRedirection(InputRedirection *parent)
     : InputDeviceHandler(parent)
 {
+    m_resamplingTimer.setSingleShot(true);
+    m_resamplingTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_resamplingTimer, &QTimer::timeout, this, &TouchInputRedirection::sendResampledMotion);
 }
 
 TouchInputRedirection::~TouchInputRedirection() = default;
@@ -111,6 +119,14 @@ void TouchInputRedirection::processDown(qint32 id, const QPointF &pos, std::chro
     if (!inited()) {
         return;
     }
+    flushQueuedMotion();
+    if (resamplesMotion()) {
+        ResampledTouchPoint &point = m_resampledPoints[id];
+        point.resampler.reset();
+        point.resampler.addSample(pos, time);
+        point.lastDispatchedTime = time;
+    }
+    m_unframedEvents = true;
     m_lastPosition = pos;
     m_windowUpdatedInCycle = false;
     m_activeTouchPoints.insert(id);
@@ -127,7 +143,7 @@ void TouchInputRedirection::processDown(qint32 id, const QPointF &pos, std::chro
     };
 
     input()->processSpies(&InputEventSpy::touchDown, &event);
-    input()->processFilters(&InputEventFilter::touchDown, &event);
+    input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchDown, &event);
     m_windowUpdatedInCycle = false;
     input()->setLastInteractionSerial(waylandServer()->seat()->display()->serial());
     if (auto f = focus()) {
@@ -140,9 +156,14 @@ void TouchInputRedirection::processUp(qint32 id, std::chrono::microseconds time,
     if (!inited()) {
         return;
     }
-    if (!m_activeTouchPoints.remove(id)) {
+    if (!m_activeTouchPoints.contains(id)) {
         return;
     }
+    // the last position of the touch point is sent as it is
+    flushQueuedMotion();
+    m_activeTouchPoints.remove(id);
+    m_resampledPoints.remove(id);
+    m_unframedEvents = true;
     input()->setLastInputHandler(this);
 
     TouchUpEvent event{
@@ -152,7 +173,7 @@ void TouchInputRedirection::processUp(qint32 id, std::chrono::microseconds time,
 
     m_windowUpdatedInCycle = false;
     input()->processSpies(&InputEventSpy::touchUp, &event);
-    input()->processFilters(&InputEventFilter::touchUp, &event);
+    input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchUp, &event);
     m_windowUpdatedInCycle = false;
     if (m_activeTouchPoints.count() == 0) {
         update();
@@ -167,6 +188,69 @@ void TouchInputRedirection::processMotion(qint32 id, const QPointF &pos, std::ch
     if (!m_activeTouchPoints.contains(id)) {
         return;
     }
+    if (resamplesMotion()) {
+        queueMotion(id, pos, time);
+        return;
+    }
+    dispatchMotion(id, pos, time);
+}
+
+void TouchInputRedirection::queueMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time)
+{
+    ResampledTouchPoint &point = m_resampledPoints[id];
+    point.resampler.addSample(pos, time);
+    point.queued = true;
+    if (!m_resamplingTimer.isActive()) {
+        m_resamplingTimer.start(timeUntilNextRefreshCycle(pos));
+    }
+}
+
+QList<TouchMotionEvent> TouchInputRedirection::takeQueuedMotion(std::optional<std::chrono::microseconds> time)
+{
+    QList<TouchMotionEvent> events;
+    for (auto it = m_resampledPoints.begin(); it != m_resampledPoints.end(); ++it) {
+        if (!std::exchange(it->queued, false)) {
+            continue;
+        }
+        // the timestamps of a touch point must not go backwards
+        it->lastDispatchedTime = std::max(it->lastDispatchedTime, time.value_or(it->resampler.lastTime()));
+        events.append(TouchMotionEvent{
+            .id = it.key(),
+            .pos = time ? it->resampler.positionAt(*time, s_maxPrediction) : it->resampler.lastPosition(),
+            .time = it->lastDispatchedTime,
+        });
+    }
+    return events;
+}
+
+void TouchInputRedirection::flushQueuedMotion()
+{
+    m_resamplingTimer.stop();
+    // the filters may cancel the touch sequence, don't iterate the touch points meanwhile
+    const auto events = takeQueuedMotion(std::nullopt);
+    for (const TouchMotionEvent &event : events) {
+        dispatchMotion(event.id, event.pos, event.time);
+    }
+}
+
+void TouchInputRedirection::sendResampledMotion()
+{
+    if (!inited()) {
+        return;
+    }
+    const auto events = takeQueuedMotion(resamplingTime());
+    for (const TouchMotionEvent &event : events) {
+        dispatchMotion(event.id, event.pos, event.time);
+    }
+    if (!events.isEmpty()) {
+        m_unframedEvents = false;
+        input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchFrame);
+    }
+}
+
+void TouchInputRedirection::dispatchMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time)
+{
+    m_unframedEvents = true;
     input()->setLastInputHandler(this);
     m_lastPosition = pos;
 
@@ -178,7 +262,7 @@ void TouchInputRedirection::processMotion(qint32 id, const QPointF &pos, std::ch
 
     m_windowUpdatedInCycle = false;
     input()->processSpies(&InputEventSpy::touchMotion, &event);
-    input()->processFilters(&InputEventFilter::touchMotion, &event);
+    input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchMotion, &event);
     m_windowUpdatedInCycle = false;
 }
 
@@ -191,9 +275,11 @@ void TouchInputRedirection::cancel()
     // up events will be silently ignored and won't be passed down through the event filter chain.
     // If the touch sequence is cancelled because we received a TOUCH_CANCEL event from libinput,
     // the compositor will not receive any TOUCH_MOTION or TOUCH_UP events for that slot.
+    m_resamplingTimer.stop();
+    m_resampledPoints.clear();
     if (!m_activeTouchPoints.isEmpty()) {
         m_activeTouchPoints.clear();
-        input()->processFilters(&InputEventFilter::touchCancel);
+        input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchCancel);
     }
 }
 
@@ -202,7 +288,11 @@ void TouchInputRedirection::frame()
     if (!inited() || !waylandServer()->seat()->hasTouch()) {
         return;
     }
-    input()->processFilters(&InputEventFilter::touchFrame);
+    // the frame of motion that has been held back is sent along with the resampled motion
+    if (resamplesMotion() && !std::exchange(m_unframedEvents, false)) {
+        return;
+    }
+    input()->processFilters(InputEventKind::Touch, &InputEventFilter::touchFrame);
 }
 
 }
@@ -9,11 +9,15 @@
 */
 #pragma once
 #include "input.h"
+#include "utils/motionresampler.h"
 
 #include <QHash>
 #include <QObject>
 #include <QPointF>
 #include <QPointer>
+#include <QTimer>
+
+#include <optional>
 
 namespace KWin
 {
@@ -21,6 +25,7 @@ namespace KWin
 class InputDevice;
 class InputRedirection;
 class Window;
+struct TouchMotionEvent;
 
 namespace Decoration
 {
@@ -68,10 +73,27 @@ private:
 
     void focusUpdate(Window *focusOld, Window *focusNow) override;
 
+    void dispatchMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time);
+    void queueMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time);
+    QList<TouchMotionEvent> takeQueuedMotion(std::optional<std::chrono::microseconds> time);
+    void flushQueuedMotion();
+    void sendResampledMotion();
+
+    struct ResampledTouchPoint
+    {
+        MotionResampler resampler;
+        std::chrono::microseconds lastDispatchedTime = std::chrono::microseconds::zero();
+        bool queued = false;
+    };
+
     QSet<qint32> m_activeTouchPoints;
     qint32 m_decorationId = -1;
     bool m_windowUpdatedInCycle = false;
     QPointF m_lastPosition;
+    QHash<qint32, ResampledTouchPoint> m_resampledPoints;
+    QTimer m_resamplingTimer;
+    // whether events that haven't been held back were sent since the last frame
+    bool m_unframedEvents = false;
 };
 
 }
@@ -0,0 +1,231 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "tracing.h"
+
+#include <QDBusConnection>
+#include <QDebug>
+#include <QFile>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+
+namespace KWin
+{
+
+KWIN_SINGLETON_FACTORY(KWin::Tracer)
+
+std::atomic<uint32_t> Tracer::s_enabledCategories = 0;
+
+namespace
+{
+
+struct TraceEvent
+{
+    const char *name;
+    int64_t timestamp;
+    uint32_t category;
+    char phase;
+};
+
+/**
+ * The events of one thread. Only the owning thread writes into it, the events are read after
+ * recording has been stopped.
+ */
+struct ThreadBuffer
+{
+    static constexpr uint64_t s_capacity = 16384;
+
+    // threads are numbered in the order they recorded their first event
+    uint32_t threadId;
+    std::array<TraceEvent, s_capacity> events;
+    std::atomic<uint64_t> count = 0;
+    // the index of the first event that belongs to the current trace
+    uint64_t start = 0;
+};
+
+struct TraceBuffers
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+};
+
+}
+
+static TraceBuffers &traceBuffers()
+{
+    // leaked on purpose, threads may still record while the process exits
+    static TraceBuffers *buffers = new TraceBuffers();
+    return *buffers;
+}
+
+static ThreadBuffer *threadBuffer()
+{
+    thread_local ThreadBuffer *buffer = []() {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        TraceBuffers &buffers = traceBuffers();
+        std::lock_guard lock(buffers.mutex);
+        buffer->threadId = buffers.threads.size() + 1;
+        buffers.threads.push_back(std::move(buffer));
+        return buffers.threads.back().get();
+    }();
+    return buffer;
+}
+
+static void record(TraceCategory category, const char *name, char phase)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    const uint64_t index = buffer->count.load(std::memory_order_relaxed);
+    buffer->events[index % ThreadBuffer::s_capacity] = TraceEvent{
+        .name = name,
+        .timestamp = std::chrono::steady_clock::now().time_since_epoch().count(),
+        .category = uint32_t(category),
+        .phase = phase,
+    };
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+static const char *categoryName(uint32_t category)
+{
+    switch (TraceCategory(category)) {
+    case TraceCategory::RenderLoop:
+        return "renderloop";
+    case TraceCategory::Scene:
+        return "scene";
+    case TraceCategory::Effects:
+        return "effects";
+    case TraceCategory::Drm:
+        return "drm";
+    case TraceCategory::Wayland:
+        return "wayland";
+    case TraceCategory::Input:
+        return "input";
+    case TraceCategory::Startup:
+        return "startup";
+    }
+    return "unknown";
+}
+
+Tracer::Tracer(QObject *parent)
+    : QObject(parent)
+{
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/Tracing"), this, QDBusConnection::ExportScriptableContents);
+    if (qEnvironmentVariableIsSet("KWIN_TRACE")) {
+        start(qEnvironmentVariable("KWIN_TRACE"));
+    }
+}
+
+Tracer::~Tracer()
+{
+    if (s_enabledCategories && qEnvironmentVariableIsSet("KWIN_TRACE_FILE")) {
+        stop(qEnvironmentVariable("KWIN_TRACE_FILE"));
+    }
+    s_self = nullptr;
+}
+
+void Tracer::begin(TraceCategory category, const char *name)
+{
+    record(category, name, 'B');
+}
+
+void Tracer::end(TraceCategory category, const char *name)
+{
+    // spans that were open when recording stopped are left unfinished
+    if (isEnabled(category)) {
+        record(category, name, 'E');
+    }
+}
+
+uint32_t Tracer::parseCategories(const QString &categories)
+{
+    uint32_t mask = 0;
+    const QStringList names = categories.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &name : names) {
+        const QString trimmed = name.trimmed();
+        if (trimmed == QLatin1String("all")) {
+            mask = 0xffffffffu;
+            continue;
+        }
+        bool found = false;
+        for (uint32_t category = 1; category <= uint32_t(TraceCategory::Startup); category <<= 1) {
+            if (trimmed == QLatin1String(categoryName(category))) {
+                mask |= category;
+                found = true;
+            }
+        }
+        if (!found) {
+            qWarning() << "Unknown trace category" << trimmed;
+        }
+    }
+    return mask & KWIN_TRACE_CATEGORIES;
+}
+
+bool Tracer::start(const QString &categories)
+{
+    const uint32_t mask = parseCategories(categories);
+    if (!mask) {
+        return false;
+    }
+    s_enabledCategories.store(0);
+    TraceBuffers &buffers = traceBuffers();
+    {
+        std::lock_guard lock(buffers.mutex);
+        for (const auto &thread : buffers.threads) {
+            thread->start = thread->count.load(std::memory_order_acquire);
+        }
+    }
+    s_enabledCategories.store(mask);
+    return true;
+}
+
+bool Tracer::stop(const QString &fileName)
+{
+    if (!s_enabledCategories.exchange(0)) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open the trace file" << fileName;
+        return false;
+    }
+
+    const QByteArray processId = QByteArray::number(getpid());
+    QByteArray json = QByteArrayLiteral("{\"traceEvents\":[");
+    bool first = true;
+    TraceBuffers &buffers = traceBuffers();
+    std::lock_guard lock(buffers.mutex);
+    for (const auto &thread : buffers.threads) {
+        const uint64_t end = thread->count.load(std::memory_order_acquire);
+        const uint64_t begin = std::max(thread->start, end > ThreadBuffer::s_capacity ? end - ThreadBuffer::s_capacity : 0);
+        const QByteArray threadId = QByteArray::number(thread->threadId);
+        for (uint64_t i = begin; i < end; ++i) {
+            const TraceEvent &event = thread->events[i % ThreadBuffer::s_capacity];
+            if (!first) {
+                json += ',';
+            }
+            first = false;
+            json += "{\"name\":\"" + QByteArray(event.name) + "\",\"cat\":\"" + categoryName(event.category)
+                + "\",\"ph\":\"" + event.phase + "\",\"ts\":" + QByteArray::number(event.timestamp / 1000.0, 'f', 3)
+                + ",\"pid\":" + processId + ",\"tid\":" + threadId + '}';
+        }
+        thread->start = end;
+    }
+    json += "]}\n";
+    return file.write(json) == json.size();
+}
+
+} // namespace KWin
+
+#include "moc_tracing.cpp"
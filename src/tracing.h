@@ -0,0 +1,135 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "effect/globals.h"
+
+#include <QObject>
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * The categories that are compiled in, as a mask of TraceCategory values. Spans of other
+ * categories compile to nothing.
+ */
+#ifndef KWIN_TRACE_CATEGORIES
+#define KWIN_TRACE_CATEGORIES 0xffffffffu
+#endif
+
+namespace KWin
+{
+
+enum class TraceCategory : uint32_t {
+    RenderLoop = 1 << 0,
+    Scene = 1 << 1,
+    Effects = 1 << 2,
+    Drm = 1 << 3,
+    Wayland = 1 << 4,
+    Input = 1 << 5,
+    Startup = 1 << 6,
+};
+
+/**
+ * The Tracer class records spans of the compositor's work, such as painting a frame or
+ * dispatching Wayland requests, so that they can be looked at on a timeline.
+ *
+ * Unlike FTraceLogger, nothing is formatted while recording. Every thread appends fixed size
+ * events to a ring buffer of its own without locking, and the events are only converted when
+ * the trace is written to a file, in the JSON trace event format that Perfetto and
+ * chrome://tracing load. While a category is disabled, a span costs a relaxed atomic load.
+ *
+ * Usage: Either:
+ *  Set KWIN_TRACE to a comma separated list of categories (or "all") and KWIN_TRACE_FILE to
+ *  the path the trace will be written to when KWin quits
+ *  Calling on DBus /Tracing org.kde.kwin.Tracing.start "all" and .stop "/path/to/trace.json"
+ */
+class KWIN_EXPORT Tracer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kwin.Tracing")
+
+public:
+    ~Tracer() override;
+
+    static bool isEnabled(TraceCategory category)
+    {
+        return s_enabledCategories.load(std::memory_order_relaxed) & uint32_t(category);
+    }
+
+    /**
+     * The @a name must be a string literal, only the pointer is recorded.
+     */
+    static void begin(TraceCategory category, const char *name);
+    static void end(TraceCategory category, const char *name);
+
+    static uint32_t parseCategories(const QString &categories);
+
+public Q_SLOTS:
+    /**
+     * Starts recording the given comma separated @a categories, dropping the events that
+     * have been recorded so far.
+     */
+    Q_SCRIPTABLE bool start(const QString &categories);
+    /**
+     * Stops recording and writes the recorded events to @a fileName.
+     */
+    Q_SCRIPTABLE bool stop(const QString &fileName);
+
+private:
+    static std::atomic<uint32_t> s_enabledCategories;
+    KWIN_SINGLETON(Tracer)
+};
+
+/**
+ * Records a span from its construction to its destruction.
+ */
+template<TraceCategory category>
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+    {
+        if constexpr (s_compiledIn) {
+            if (Tracer::isEnabled(category)) {
+                m_name = name;
+                Tracer::begin(category, name);
+            }
+        }
+    }
+
+    ~TraceScope()
+    {
+        if constexpr (s_compiledIn) {
+            if (m_name) {
+                Tracer::end(category, m_name);
+            }
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    static constexpr bool s_compiledIn = (KWIN_TRACE_CATEGORIES & uint32_t(category)) != 0;
+    const char *m_name = nullptr;
+};
+
+} // namespace KWin
+
+#define KWIN_TRACE_CONCAT_IMPL(a, b) a##b
+#define KWIN_TRACE_CONCAT(a, b) KWIN_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * Records the rest of the enclosing block as a span named @a name in the given category, e.g.
+ * traceScope(Scene, "paint");
+ */
+#define traceScope(category, name) \
+    KWin::TraceScope<KWin::TraceCategory::category> KWIN_TRACE_CONCAT(_traceScope, __LINE__)(name)
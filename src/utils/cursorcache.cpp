@@ -0,0 +1,203 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "utils/cursorcache.h"
+#include "utils/common.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace KWin
+{
+
+static const quint32 s_cursorMagic = 0x4b574343; // KWCC
+static const quint32 s_cursorVersion = 1;
+
+// The pixel data of every sprite starts at a multiple of this offset in the cache file
+static const quint64 s_pixelAlignment = 64;
+
+struct CursorCacheHeader
+{
+    quint32 magic;
+    quint32 version;
+    qint64 sourceTimestamp;
+    quint32 spriteCount;
+    quint32 reserved;
+};
+
+struct CursorCacheSprite
+{
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 delay;
+    double hotspotX;
+    double hotspotY;
+    double devicePixelRatio;
+    quint64 offset;
+};
+
+static bool isEnabled()
+{
+    static const bool enabled = qEnvironmentVariable("KWIN_CURSOR_CACHE") != QLatin1String("0");
+    return enabled;
+}
+
+static QString cacheDirectory()
+{
+    static const QString directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kwin/cursors");
+    return directory;
+}
+
+static QString cacheFilePath(const QString &sourcePath, int size, qreal devicePixelRatio)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QFile::encodeName(sourcePath));
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(QByteArray::number(size));
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(QByteArray::number(devicePixelRatio));
+    return cacheDirectory() + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QLatin1String(".bin");
+}
+
+static qint64 sourceTimestamp(const QString &sourcePath)
+{
+    // An svg cursor is a directory, any of the files in it can change the sprites
+    const QFileInfo sourceInfo(sourcePath);
+    qint64 timestamp = sourceInfo.lastModified().toMSecsSinceEpoch();
+    if (sourceInfo.isDir()) {
+        const QFileInfoList entries = QDir(sourcePath).entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
+        for (const QFileInfo &entry : entries) {
+            timestamp = std::max(timestamp, entry.lastModified().toMSecsSinceEpoch());
+        }
+    }
+    return timestamp;
+}
+
+static void releaseCacheFile(void *info)
+{
+    delete static_cast<std::shared_ptr<QFile> *>(info);
+}
+
+QList<CursorSprite> CursorCache::load(const QString &sourcePath, int size, qreal devicePixelRatio)
+{
+    if (!isEnabled()) {
+        return {};
+    }
+
+    auto file = std::make_shared<QFile>(cacheFilePath(sourcePath, size, devicePixelRatio));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    const quint64 fileSize = file->size();
+    if (fileSize < sizeof(CursorCacheHeader)) {
+        return {};
+    }
+    const uchar *data = file->map(0, fileSize);
+    if (!data) {
+        return {};
+    }
+
+    CursorCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != s_cursorMagic || header.version != s_cursorVersion || header.spriteCount == 0) {
+        return {};
+    }
+    if (header.sourceTimestamp != sourceTimestamp(sourcePath)) {
+        return {};
+    }
+    if (fileSize < sizeof(CursorCacheHeader) + quint64(header.spriteCount) * sizeof(CursorCacheSprite)) {
+        return {};
+    }
+
+    QList<CursorSprite> sprites;
+    sprites.reserve(header.spriteCount);
+    for (quint32 i = 0; i < header.spriteCount; ++i) {
+        CursorCacheSprite sprite;
+        std::memcpy(&sprite, data + sizeof(CursorCacheHeader) + i * sizeof(CursorCacheSprite), sizeof(sprite));
+        if (sprite.bytesPerLine < quint64(sprite.width) * 4 || sprite.offset % s_pixelAlignment != 0) {
+            return {};
+        }
+        if (sprite.offset > fileSize || fileSize - sprite.offset < quint64(sprite.bytesPerLine) * sprite.height) {
+            return {};
+        }
+
+        // The image refers to the mapped file, which stays around as long as any image uses it
+        QImage image(data + sprite.offset, sprite.width, sprite.height, sprite.bytesPerLine, QImage::Format_ARGB32_Premultiplied,
+                     releaseCacheFile, new std::shared_ptr<QFile>(file));
+        image.setDevicePixelRatio(sprite.devicePixelRatio);
+        sprites.append(CursorSprite(image, QPointF(sprite.hotspotX, sprite.hotspotY), std::chrono::milliseconds(sprite.delay)));
+    }
+
+    return sprites;
+}
+
+void CursorCache::store(const QString &sourcePath, int size, qreal devicePixelRatio, const QList<CursorSprite> &sprites)
+{
+    if (!isEnabled() || sprites.isEmpty()) {
+        return;
+    }
+    if (!QDir().mkpath(cacheDirectory())) {
+        qCWarning(KWIN_CORE) << "Failed to create cursor cache directory" << cacheDirectory();
+        return;
+    }
+
+    const CursorCacheHeader header{
+        .magic = s_cursorMagic,
+        .version = s_cursorVersion,
+        .sourceTimestamp = sourceTimestamp(sourcePath),
+        .spriteCount = quint32(sprites.size()),
+        .reserved = 0,
+    };
+
+    QList<QImage> images;
+    QList<CursorCacheSprite> records;
+    quint64 offset = sizeof(CursorCacheHeader) + sprites.size() * sizeof(CursorCacheSprite);
+    for (const CursorSprite &sprite : sprites) {
+        const QImage image = sprite.data().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        offset = (offset + s_pixelAlignment - 1) / s_pixelAlignment * s_pixelAlignment;
+        records.append(CursorCacheSprite{
+            .width = quint32(image.width()),
+            .height = quint32(image.height()),
+            .bytesPerLine = quint32(image.bytesPerLine()),
+            .delay = quint32(sprite.delay().count()),
+            .hotspotX = sprite.hotspot().x(),
+            .hotspotY = sprite.hotspot().y(),
+            .devicePixelRatio = image.devicePixelRatio(),
+            .offset = offset,
+        });
+        offset += image.sizeInBytes();
+        images.append(image);
+    }
+
+    QByteArray contents;
+    contents.reserve(offset);
+    contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    contents.append(reinterpret_cast<const char *>(records.constData()), records.size() * sizeof(CursorCacheSprite));
+    for (qsizetype i = 0; i < images.size(); ++i) {
+        contents.resize(records[i].offset, '\0');
+        contents.append(reinterpret_cast<const char *>(images[i].constBits()), images[i].sizeInBytes());
+    }
+
+    QSaveFile file(cacheFilePath(sourcePath, size, devicePixelRatio));
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size() || !file.commit()) {
+        qCWarning(KWIN_CORE) << "Failed to store cursor sprites of" << sourcePath;
+    }
+}
+
+} // namespace KWin
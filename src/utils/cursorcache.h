@@ -0,0 +1,35 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "utils/cursortheme.h"
+
+namespace KWin
+{
+
+/**
+ * The CursorCache class stores rasterized cursor sprites on disk, so that they don't have to
+ * be rendered again in later sessions or when the scale changes back.
+ *
+ * The sprites are stored per source file, size and scale factor, in a layout that allows the
+ * images to reference the memory mapped cache file directly. The cache entry is discarded
+ * when the source has been modified after it was stored.
+ */
+class CursorCache
+{
+public:
+    /**
+     * Returns the cached sprites for the cursor at @a sourcePath, or an empty list if they
+     * have not been stored yet or are out of date.
+     */
+    static QList<CursorSprite> load(const QString &sourcePath, int size, qreal devicePixelRatio);
+    static void store(const QString &sourcePath, int size, qreal devicePixelRatio, const QList<CursorSprite> &sprites);
+};
+
+} // namespace KWin
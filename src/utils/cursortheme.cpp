@@ -5,6 +5,7 @@
 */
 
 #include "utils/cursortheme.h"
+#include "utils/cursorcache.h"
 #include "utils/svgcursorreader.h"
 #include "utils/xcursorreader.h"
 
@@ -13,10 +14,13 @@
 #include <KShell>
 
 #include <QDir>
+#include <QFuture>
 #include <QSet>
 #include <QSharedData>
 #include <QStack>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 
 namespace KWin
 {
@@ -46,11 +50,17 @@ class CursorThemeEntry
 {
 public:
     explicit CursorThemeEntry(const CursorThemeEntryInfo &info);
+    ~CursorThemeEntry();
 
     void load(int size, qreal devicePixelRatio);
+    void prefetch(int size, qreal devicePixelRatio);
+
+    static QList<CursorSprite> decode(const CursorThemeEntryInfo &info, int size, qreal devicePixelRatio);
 
     CursorThemeEntryInfo info;
     QList<CursorSprite> sprites;
+    QFuture<QList<CursorSprite>> pendingSprites;
+    bool loaded = false;
 };
 
 class CursorThemePrivate : public QSharedData
@@ -124,22 +134,64 @@ CursorThemePrivate::CursorThemePrivate(const QString &themeName, int size, qreal
 {
 }
 
+static QThreadPool *decodeThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(1);
+        pool->setObjectName(QStringLiteral("KWin cursor decoder"));
+        return pool;
+    }();
+    return pool;
+}
+
 CursorThemeEntry::CursorThemeEntry(const CursorThemeEntryInfo &info)
     : info(info)
 {
 }
 
+CursorThemeEntry::~CursorThemeEntry()
+{
+    pendingSprites.waitForFinished();
+}
+
+QList<CursorSprite> CursorThemeEntry::decode(const CursorThemeEntryInfo &info, int size, qreal devicePixelRatio)
+{
+    if (const auto raster = std::get_if<CursorThemeXEntryInfo>(&info)) {
+        return XCursorReader::load(raster->path, size, devicePixelRatio);
+    } else if (const auto svg = std::get_if<CursorThemeSvgEntryInfo>(&info)) {
+        // Rendering svg files is expensive, so keep the result around for later sessions
+        QList<CursorSprite> sprites = CursorCache::load(svg->path, size, devicePixelRatio);
+        if (sprites.isEmpty()) {
+            sprites = SvgCursorReader::load(svg->path, size, devicePixelRatio);
+            CursorCache::store(svg->path, size, devicePixelRatio, sprites);
+        }
+        return sprites;
+    }
+    return {};
+}
+
 void CursorThemeEntry::load(int size, qreal devicePixelRatio)
 {
-    if (!sprites.isEmpty()) {
+    if (loaded) {
         return;
     }
 
-    if (const auto raster = std::get_if<CursorThemeXEntryInfo>(&info)) {
-        sprites = XCursorReader::load(raster->path, size, devicePixelRatio);
-    } else if (const auto svg = std::get_if<CursorThemeSvgEntryInfo>(&info)) {
-        sprites = SvgCursorReader::load(svg->path, size, devicePixelRatio);
+    if (pendingSprites.isValid()) {
+        sprites = pendingSprites.result();
+        pendingSprites = {};
+    } else {
+        sprites = decode(info, size, devicePixelRatio);
     }
+    loaded = true;
+}
+
+void CursorThemeEntry::prefetch(int size, qreal devicePixelRatio)
+{
+    if (loaded || pendingSprites.isValid()) {
+        return;
+    }
+    pendingSprites = QtConcurrent::run(decodeThreadPool(), &CursorThemeEntry::decode, info, size, devicePixelRatio);
 }
 
 void CursorThemePrivate::discoverXCursors(const QString &packagePath)
@@ -317,6 +369,15 @@ bool CursorTheme::isEmpty() const
     return d->registry.isEmpty();
 }
 
+bool CursorTheme::prefetch(const QByteArray &name) const
+{
+    if (auto entry = d->registry.value(name)) {
+        entry->prefetch(d->size, d->devicePixelRatio);
+        return true;
+    }
+    return false;
+}
+
 QList<CursorSprite> CursorTheme::shape(const QByteArray &name) const
 {
     if (auto entry = d->registry.value(name)) {
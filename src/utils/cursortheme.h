@@ -130,6 +130,13 @@ public:
      */
     bool isEmpty() const;
 
+    /**
+     * Starts loading the sprites for the cursor with the given @a name on a worker thread,
+     * so that shape() doesn't have to wait as long for them later. Returns @c false if the
+     * theme has no such cursor.
+     */
+    bool prefetch(const QByteArray &name) const;
+
     /**
      * Returns the list of cursor sprites for the cursor with the given @a name.
      */
@@ -6,16 +6,25 @@
 
 #pragma once
 
+#include "core/region.h"
 #include "kwin_export.h"
 
 #include <QList>
 #include <QRegion>
 
+#include <algorithm>
+
 namespace KWin
 {
 
 /**
  * The DamageJournal class is a helper that tracks last N damage regions.
+ *
+ * The damage regions are stored in a ring buffer. Accumulated damage is cached per buffer
+ * age until the next damage region is added. If the accumulated damage consists of too many
+ * rectangles or covers most of its bounding rectangle, the bounding rectangle is returned
+ * instead, because repainting a few extra pixels is cheaper than setting up a scissor and
+ * vertices for every small rectangle.
  */
 class KWIN_EXPORT DamageJournal
 {
@@ -34,7 +43,53 @@ public:
      */
     void setCapacity(int capacity)
     {
+        capacity = std::max(capacity, 1);
+        if (m_capacity == capacity) {
+            return;
+        }
+
+        QList<Region> log;
+        log.reserve(capacity);
+        for (int i = std::min(m_count, capacity) - 1; i >= 0; --i) {
+            log.append(at(i));
+        }
+
         m_capacity = capacity;
+        m_count = log.size();
+        m_head = m_count - 1;
+        m_log = std::move(log);
+        m_accumulated.clear();
+    }
+
+    /**
+     * Returns the maximum number of rectangles in the accumulated damage before it is
+     * replaced with its bounding rectangle. Zero means no limit.
+     */
+    int maximumRectCount() const
+    {
+        return m_maximumRectCount;
+    }
+
+    void setMaximumRectCount(int count)
+    {
+        m_maximumRectCount = count;
+        m_accumulated.clear();
+    }
+
+    /**
+     * Returns the ratio between the area of the accumulated damage and the area of its
+     * bounding rectangle above which the bounding rectangle is used instead. Zero or
+     * negative values disable this heuristic.
+     */
+    qreal minimumFillRatio() const
+    {
+        return m_minimumFillRatio;
+    }
+
+    void setMinimumFillRatio(qreal ratio)
+    {
+        m_minimumFillRatio = ratio;
+        m_accumulated.clear();
     }
 
     /**
@@ -42,10 +97,13 @@ public:
      */
     void add(const QRegion &region)
     {
-        while (m_log.size() >= m_capacity) {
-            m_log.removeLast();
+        if (m_log.size() < m_capacity) {
+            m_log.resize(m_capacity);
         }
-        m_log.prepend(region);
+        m_head = (m_head + 1) % m_capacity;
+        m_log[m_head] = Region(region);
+        m_count = std::min(m_count + 1, m_capacity);
+        m_accumulated.clear();
     }
 
     /**
@@ -55,6 +113,9 @@ public:
     void clear()
     {
         m_log.clear();
+        m_head = -1;
+        m_count = 0;
+        m_accumulated.clear();
     }
 
     /**
@@ -65,25 +126,77 @@ public:
      */
     QRegion accumulate(int bufferAge, const QRegion &fallback = QRegion()) const
     {
-        QRegion region;
-        if (bufferAge > 0 && bufferAge <= m_log.size()) {
-            for (int i = 0; i < bufferAge - 1; ++i) {
-                region += m_log[i];
+        if (bufferAge <= 0 || bufferAge > m_count) {
+            return fallback;
+        }
+
+        const int index = bufferAge - 1;
+        while (m_accumulated.size() <= index) {
+            if (m_accumulated.isEmpty()) {
+                m_accumulated.append(Accumulated{});
+            } else {
+                const Region united = m_accumulated.constLast().united | at(m_accumulated.size() - 1);
+                m_accumulated.append(Accumulated{
+                    .united = united,
+                    .simplified = simplified(united),
+                });
             }
-        } else {
-            region = fallback;
         }
-        return region;
+
+        return m_accumulated[index].simplified;
     }
 
     QRegion lastDamage() const
     {
-        return m_log.first();
+        return at(0);
     }
 
 private:
-    QList<QRegion> m_log;
+    struct Accumulated
+    {
+        Region united;
+        QRegion simplified;
+    };
+
+    /**
+     * Returns the damage region that was added @a index frames ago.
+     */
+    const Region &at(int index) const
+    {
+        return m_log[(m_head - index + m_capacity) % m_capacity];
+    }
+
+    QRegion simplified(const Region &region) const
+    {
+        if (region.rectCount() <= 1) {
+            return region;
+        }
+
+        const Rect bounds = region.boundingRect();
+        if (m_maximumRectCount > 0 && region.rectCount() > m_maximumRectCount) {
+            return QRegion(bounds);
+        }
+
+        if (m_minimumFillRatio > 0) {
+            qint64 area = 0;
+            for (const Rect &rect : region) {
+                area += qint64(rect.width()) * rect.height();
+            }
+            if (area >= m_minimumFillRatio * qint64(bounds.width()) * bounds.height()) {
+                return QRegion(bounds);
+            }
+        }
+
+        return region;
+    }
+
+    QList<Region> m_log;
+    mutable QList<Accumulated> m_accumulated;
+    int m_head = -1;
+    int m_count = 0;
     int m_capacity = 10;
+    int m_maximumRectCount = 64;
+    qreal m_minimumFillRatio = 0.9;
 };
 
 } // namespace KWin
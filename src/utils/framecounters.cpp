@@ -0,0 +1,49 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "framecounters.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+#if KWIN_BUILD_FRAME_COUNTERS
+std::array<std::atomic<uint64_t>, FrameCounters::s_counterCount> FrameCounters::s_counters{};
+#endif
+
+FrameCounters::Values FrameCounters::snapshot()
+{
+    Values values{};
+#if KWIN_BUILD_FRAME_COUNTERS
+    for (size_t i = 0; i < s_counterCount; ++i) {
+        values[i] = s_counters[i].load(std::memory_order_relaxed);
+    }
+#endif
+    return values;
+}
+
+void FrameCounterJournal::add(const FrameCounterRecord &record)
+{
+    m_records[m_count % s_capacity] = record;
+    m_count++;
+}
+
+std::vector<FrameCounterRecord> FrameCounterJournal::records() const
+{
+    const uint64_t count = std::min<uint64_t>(m_count, s_capacity);
+    std::vector<FrameCounterRecord> ret;
+    ret.reserve(count);
+    for (uint64_t i = m_count - count; i < m_count; ++i) {
+        ret.push_back(m_records[i % s_capacity]);
+    }
+    return ret;
+}
+
+} // namespace KWin
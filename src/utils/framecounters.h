@@ -0,0 +1,112 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "config-kwin.h"
+#include "kwin_export.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace KWin
+{
+
+/**
+ * The FrameCounters class counts process wide events that make frames slower than
+ * they need to be, such as heap allocations and waits for contended locks. The compositor
+ * takes a snapshot before and after painting a frame, the difference is the cost of the
+ * frame and of whatever else ran concurrently.
+ *
+ * The counters are only compiled in when KWin is built with KWIN_BUILD_FRAME_COUNTERS,
+ * which is the default for debug builds. Otherwise, counting compiles to nothing.
+ */
+class KWIN_EXPORT FrameCounters
+{
+public:
+    enum class Counter {
+        Allocations,
+        AllocatedBytes,
+        MutexWaits,
+        MutexWaitNanoseconds,
+    };
+    static constexpr size_t s_counterCount = size_t(Counter::MutexWaitNanoseconds) + 1;
+    using Values = std::array<uint64_t, s_counterCount>;
+
+    static constexpr bool isCompiledIn()
+    {
+        return KWIN_BUILD_FRAME_COUNTERS;
+    }
+
+    static void add(Counter counter, uint64_t value)
+    {
+#if KWIN_BUILD_FRAME_COUNTERS
+        s_counters[size_t(counter)].fetch_add(value, std::memory_order_relaxed);
+#endif
+    }
+
+    static Values snapshot();
+
+    /**
+     * Locks the @a mutex, counting the wait if it's already held by another thread.
+     */
+    template<typename Mutex>
+    static std::unique_lock<Mutex> lock(Mutex &mutex)
+    {
+#if KWIN_BUILD_FRAME_COUNTERS
+        std::unique_lock lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            const auto start = std::chrono::steady_clock::now();
+            lock.lock();
+            add(Counter::MutexWaits, 1);
+            add(Counter::MutexWaitNanoseconds, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+        return lock;
+#else
+        return std::unique_lock(mutex);
+#endif
+    }
+
+private:
+#if KWIN_BUILD_FRAME_COUNTERS
+    static std::array<std::atomic<uint64_t>, s_counterCount> s_counters;
+#endif
+};
+
+struct FrameCounterRecord
+{
+    std::chrono::nanoseconds timestamp{0};
+    FrameCounters::Values values{};
+};
+
+/**
+ * The FrameCounterJournal class keeps the counters of the most recently painted frames.
+ */
+class KWIN_EXPORT FrameCounterJournal
+{
+public:
+    static constexpr size_t s_capacity = 256;
+
+    void add(const FrameCounterRecord &record);
+
+    /**
+     * Returns the recorded frames, oldest first.
+     */
+    std::vector<FrameCounterRecord> records() const;
+
+private:
+    std::array<FrameCounterRecord, s_capacity> m_records;
+    uint64_t m_count = 0;
+};
+
+} // namespace KWin
@@ -0,0 +1,84 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace KWin
+{
+
+/**
+ * The FreeList class keeps the memory of up to @c Capacity released objects of type @c T
+ * around so that they can be allocated again without going through the general purpose
+ * allocator. It's meant to back class specific operator new and operator delete of objects
+ * that are created and destroyed at a high rate, e.g. for every surface commit.
+ *
+ * The FreeList is not thread safe.
+ */
+template<typename T, size_t Capacity>
+class FreeList
+{
+public:
+    FreeList()
+    {
+        m_slots.reserve(Capacity);
+    }
+
+    ~FreeList()
+    {
+        for (void *slot : m_slots) {
+            ::operator delete(slot);
+        }
+    }
+
+    FreeList(const FreeList &) = delete;
+    FreeList &operator=(const FreeList &) = delete;
+
+    /**
+     * Returns the memory for an object of type @c T, reusing the memory of a released object
+     * if there's one.
+     */
+    void *allocate()
+    {
+        if (m_slots.empty()) {
+            return ::operator new(sizeof(T));
+        }
+        void *slot = m_slots.back();
+        m_slots.pop_back();
+        return slot;
+    }
+
+    /**
+     * Releases the memory of an object that has been allocated with allocate().
+     */
+    void release(void *slot)
+    {
+        if (m_slots.size() < Capacity) {
+            m_slots.push_back(slot);
+        } else {
+            ::operator delete(slot);
+        }
+    }
+
+    /**
+     * Returns the number of released objects whose memory is kept around.
+     */
+    size_t size() const
+    {
+        return m_slots.size();
+    }
+
+private:
+    std::vector<void *> m_slots;
+};
+
+} // namespace KWin
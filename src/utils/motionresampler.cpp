@@ -0,0 +1,96 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/motionresampler.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+void MotionResampler::addSample(const QPointF &position, std::chrono::microseconds time)
+{
+    // devices restart their timestamps now and then, old samples are useless afterwards
+    if (m_count && time < lastTime()) {
+        reset();
+    }
+    m_samples[m_next] = Sample{
+        .position = position,
+        .time = time,
+    };
+    m_next = (m_next + 1) % s_capacity;
+    m_count = std::min(m_count + 1, s_capacity);
+}
+
+void MotionResampler::reset()
+{
+    m_count = 0;
+    m_next = 0;
+}
+
+bool MotionResampler::isEmpty() const
+{
+    return m_count == 0;
+}
+
+const MotionResampler::Sample &MotionResampler::sample(size_t age) const
+{
+    return m_samples[(m_next + s_capacity - 1 - age) % s_capacity];
+}
+
+QPointF MotionResampler::lastPosition() const
+{
+    return sample(0).position;
+}
+
+std::chrono::microseconds MotionResampler::lastTime() const
+{
+    return sample(0).time;
+}
+
+QPointF MotionResampler::positionAt(std::chrono::microseconds time, std::chrono::microseconds maxPrediction) const
+{
+    if (m_count == 0) {
+        return QPointF();
+    }
+    const Sample &last = sample(0);
+    if (m_count == 1) {
+        return last.position;
+    }
+
+    if (time >= last.time) {
+        const Sample &previous = sample(1);
+        const auto interval = last.time - previous.time;
+        if (interval <= std::chrono::microseconds::zero()) {
+            return last.position;
+        }
+        const auto prediction = std::min({time - last.time, maxPrediction, interval / 2});
+        const double factor = double(prediction.count()) / interval.count();
+        return last.position + (last.position - previous.position) * factor;
+    }
+
+    for (size_t age = 1; age < m_count; ++age) {
+        const Sample &before = sample(age);
+        if (before.time > time) {
+            continue;
+        }
+        const Sample &after = sample(age - 1);
+        const auto interval = after.time - before.time;
+        if (interval <= std::chrono::microseconds::zero()) {
+            return after.position;
+        }
+        const double factor = double((time - before.time).count()) / interval.count();
+        return before.position + (after.position - before.position) * factor;
+    }
+
+    // older than everything that is still known
+    return sample(m_count - 1).position;
+}
+
+} // namespace KWin
@@ -0,0 +1,60 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QPointF>
+
+#include <array>
+#include <chrono>
+
+namespace KWin
+{
+
+/**
+ * The MotionResampler class estimates where a touch point or a stylus is at a given time,
+ * from the last few positions that the device has reported. The position is interpolated
+ * between the two samples around the time, or extrapolated from the last two samples if the
+ * time is past the last one.
+ */
+class KWIN_EXPORT MotionResampler
+{
+public:
+    void addSample(const QPointF &position, std::chrono::microseconds time);
+    void reset();
+
+    bool isEmpty() const;
+    QPointF lastPosition() const;
+    std::chrono::microseconds lastTime() const;
+
+    /**
+     * Returns the position at @a time. The position is extrapolated by at most @a maxPrediction
+     * past the last sample, and by at most half of the time between the last two samples, so
+     * that a device that just slowed down doesn't overshoot.
+     */
+    QPointF positionAt(std::chrono::microseconds time, std::chrono::microseconds maxPrediction) const;
+
+private:
+    struct Sample
+    {
+        QPointF position;
+        std::chrono::microseconds time;
+    };
+
+    const Sample &sample(size_t age) const;
+
+    static constexpr size_t s_capacity = 4;
+    std::array<Sample, s_capacity> m_samples;
+    size_t m_count = 0;
+    size_t m_next = 0;
+};
+
+} // namespace KWin
@@ -0,0 +1,115 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/softwareblend.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace KWin
+{
+
+/**
+ * The number of pixels from which blending is split across threads.
+ */
+static const qsizetype s_parallelPixelCount = 512 * 512;
+static const int s_bandHeight = 64;
+
+static QThreadPool *blendThreadPool()
+{
+    static QThreadPool *pool = []() {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(std::clamp(QThread::idealThreadCount(), 1, 4));
+        return pool;
+    }();
+    return pool;
+}
+
+bool canBlendImage(QImage::Format format)
+{
+    return format == QImage::Format_ARGB32_Premultiplied || format == QImage::Format_RGB32;
+}
+
+/**
+ * Multiplies all four channels of @a pixel by @a alpha / 255, two channels at a time.
+ */
+static inline uint32_t multiplyPixel(uint32_t pixel, uint32_t alpha)
+{
+    uint32_t redBlue = (pixel & 0x00ff00ff) * alpha;
+    redBlue = ((redBlue + ((redBlue >> 8) & 0x00ff00ff) + 0x00800080) >> 8) & 0x00ff00ff;
+    uint32_t alphaGreen = ((pixel >> 8) & 0x00ff00ff) * alpha;
+    alphaGreen = (alphaGreen + ((alphaGreen >> 8) & 0x00ff00ff) + 0x00800080) & 0xff00ff00;
+    return alphaGreen | redBlue;
+}
+
+// Plain loops without branches on the pixels, so that the compiler can vectorize them
+static void blendRow(uint32_t *target, const uint32_t *source, int width, uint32_t opacity, uint32_t sourceAlpha)
+{
+    if (opacity == 255) {
+        for (int i = 0; i < width; ++i) {
+            const uint32_t pixel = source[i] | sourceAlpha;
+            target[i] = pixel + multiplyPixel(target[i], 255 - (pixel >> 24));
+        }
+    } else {
+        for (int i = 0; i < width; ++i) {
+            const uint32_t pixel = multiplyPixel(source[i] | sourceAlpha, opacity);
+            target[i] = pixel + multiplyPixel(target[i], 255 - (pixel >> 24));
+        }
+    }
+}
+
+void blendImage(QImage &target, const QPoint &targetPosition, const QImage &source, const QRect &sourceRect, qreal opacity)
+{
+    Q_ASSERT(canBlendImage(target.format()) && canBlendImage(source.format()));
+
+    const QRect targetRect = QRect(targetPosition, sourceRect.size()) & target.rect() & source.rect().translated(targetPosition - sourceRect.topLeft());
+    const uint32_t alpha = std::clamp<int>(std::round(opacity * 255), 0, 255);
+    if (targetRect.isEmpty() || alpha == 0) {
+        return;
+    }
+    const QPoint sourceOffset = sourceRect.topLeft() - targetPosition;
+    // the alpha channel of XRGB images is undefined, so it's forced to be opaque
+    const uint32_t sourceAlpha = source.format() == QImage::Format_RGB32 ? 0xff000000 : 0;
+    const bool copy = alpha == 255 && sourceAlpha;
+    // the bits of the target have to be detached before the threads write to them
+    uchar *targetBits = target.bits();
+    const qsizetype targetStride = target.bytesPerLine();
+
+    const auto drawRows = [&](int firstRow, int lastRow) {
+        for (int y = firstRow; y < lastRow; ++y) {
+            auto targetRow = reinterpret_cast<uint32_t *>(targetBits + y * targetStride) + targetRect.x();
+            auto sourceRow = reinterpret_cast<const uint32_t *>(source.constScanLine(y + sourceOffset.y())) + targetRect.x() + sourceOffset.x();
+            if (copy) {
+                std::memcpy(targetRow, sourceRow, targetRect.width() * sizeof(uint32_t));
+            } else {
+                blendRow(targetRow, sourceRow, targetRect.width(), alpha, sourceAlpha);
+            }
+        }
+    };
+
+    if (qsizetype(targetRect.width()) * targetRect.height() < s_parallelPixelCount) {
+        drawRows(targetRect.top(), targetRect.bottom() + 1);
+        return;
+    }
+
+    QList<int> bands((targetRect.height() + s_bandHeight - 1) / s_bandHeight);
+    std::iota(bands.begin(), bands.end(), 0);
+    QtConcurrent::blockingMap(blendThreadPool(), bands, [&](int band) {
+        const int firstRow = targetRect.top() + band * s_bandHeight;
+        drawRows(firstRow, std::min(firstRow + s_bandHeight, targetRect.bottom() + 1));
+    });
+}
+
+} // namespace KWin
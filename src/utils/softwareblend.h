@@ -0,0 +1,35 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QImage>
+
+namespace KWin
+{
+
+/**
+ * Returns whether images of the given @a format can be drawn and drawn into with
+ * blendImage(), i.e. whether they're 32 bit premultiplied or opaque XRGB.
+ */
+KWIN_EXPORT bool canBlendImage(QImage::Format format);
+
+/**
+ * Draws the @a sourceRect of the @a source image at @a targetPosition in the @a target
+ * image with source-over composition and the given @a opacity, clipped to the target.
+ *
+ * This covers what the software compositor draws most, windows that are neither scaled nor
+ * rotated, without the overhead of going through QPainter. Opaque sources are copied row by
+ * row, and large areas are split into bands that are drawn on multiple threads.
+ */
+KWIN_EXPORT void blendImage(QImage &target, const QPoint &targetPosition, const QImage &source, const QRect &sourceRect, qreal opacity);
+
+} // namespace KWin
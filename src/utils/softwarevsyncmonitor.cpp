@@ -6,6 +6,10 @@
 
 #include "utils/softwarevsyncmonitor.h"
 
+#include <QRandomGenerator>
+
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -30,8 +34,24 @@ void SoftwareVsyncMonitor::setRefreshRate(int refreshRate)
     m_refreshRate = refreshRate;
 }
 
+void SoftwareVsyncMonitor::setPhase(std::chrono::nanoseconds phase)
+{
+    m_phase = phase;
+}
+
+void SoftwareVsyncMonitor::setJitter(std::chrono::nanoseconds jitter)
+{
+    m_jitter = jitter;
+}
+
+void SoftwareVsyncMonitor::setLatency(std::chrono::nanoseconds latency)
+{
+    m_latency = latency;
+}
+
 void SoftwareVsyncMonitor::handleSyntheticVsync()
 {
+    m_lastVblankTimestamp = m_vblankTimestamp;
     Q_EMIT vblankOccurred(m_vblankTimestamp);
 }
 
@@ -50,9 +70,30 @@ void SoftwareVsyncMonitor::arm()
     const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
     const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / m_refreshRate);
 
-    m_vblankTimestamp = alignTimestamp(currentTime, vblankInterval);
+    m_vblankTimestamp = alignTimestamp(currentTime + m_latency - m_phase, vblankInterval) + m_phase;
+    schedule(currentTime);
+}
 
-    m_softwareClock.start(std::chrono::duration_cast<std::chrono::milliseconds>(m_vblankTimestamp - currentTime));
+void SoftwareVsyncMonitor::armAdaptive(int maxRefreshRate)
+{
+    if (m_softwareClock.isActive()) {
+        return;
+    }
+
+    const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
+    const std::chrono::nanoseconds minimumInterval(1'000'000'000'000ull / maxRefreshRate);
+
+    m_vblankTimestamp = std::max(currentTime + m_latency, m_lastVblankTimestamp + minimumInterval);
+    schedule(currentTime);
+}
+
+void SoftwareVsyncMonitor::schedule(std::chrono::nanoseconds currentTime)
+{
+    std::chrono::nanoseconds delay = m_vblankTimestamp - currentTime;
+    if (m_jitter > std::chrono::nanoseconds::zero()) {
+        delay += std::chrono::nanoseconds(QRandomGenerator::global()->bounded(qint64(m_jitter.count())));
+    }
+    m_softwareClock.start(std::chrono::duration_cast<std::chrono::milliseconds>(delay));
 }
 
 } // namespace KWin
@@ -32,16 +32,43 @@ public:
     int refreshRate() const;
     void setRefreshRate(int refreshRate);
 
+    /**
+     * Offsets the vblanks from the ones of other monitors with the same refresh rate.
+     */
+    void setPhase(std::chrono::nanoseconds phase);
+    /**
+     * Delays the delivery of every vblank event by a random amount up to @a jitter. The
+     * reported timestamps stay on the vblank grid, like they would with real hardware.
+     */
+    void setJitter(std::chrono::nanoseconds jitter);
+    /**
+     * Simulates the time a commit takes to reach the hardware, a vblank that is closer
+     * than @a latency when arming can't be hit anymore.
+     */
+    void setLatency(std::chrono::nanoseconds latency);
+
+    /**
+     * Simulates a variable refresh rate display that can refresh at up to @a maxRefreshRate:
+     * the vblank occurs as soon as the latency allows, but not earlier than the shortest
+     * refresh interval after the previous one.
+     */
+    void armAdaptive(int maxRefreshRate);
+
 public Q_SLOTS:
     void arm() override;
 
 private:
     explicit SoftwareVsyncMonitor();
     void handleSyntheticVsync();
+    void schedule(std::chrono::nanoseconds currentTime);
 
     QTimer m_softwareClock;
     int m_refreshRate = 60000;
+    std::chrono::nanoseconds m_phase = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds m_jitter = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds m_latency = std::chrono::nanoseconds::zero();
     std::chrono::nanoseconds m_vblankTimestamp = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds m_lastVblankTimestamp = std::chrono::nanoseconds::zero();
 };
 
 } // namespace KWin
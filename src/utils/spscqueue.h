@@ -0,0 +1,69 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace KWin
+{
+
+/**
+ * The SpscQueue class is a bounded queue for passing values from one thread to another
+ * without locking. There must be only one thread that pushes values and only one thread
+ * that pops them.
+ */
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+    /**
+     * Appends the @a value to the queue. Returns @c false if the queue is full. Must be called
+     * only by the producer.
+     */
+    bool push(const T &value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest value from the queue and returns it, or @c std::nullopt if the queue
+     * is empty. Must be called only by the consumer.
+     */
+    std::optional<T> pop()
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        T value = std::move(m_slots[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    std::array<T, Capacity> m_slots{};
+    // The producer and the consumer each write only one of the indices, keep them apart so
+    // that they don't share a cache line
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+} // namespace KWin
@@ -10,10 +10,24 @@
 #include "watchdoglogging.h"
 #include <unistd.h>
 #include <sys/types.h>
+#include <QAbstractEventDispatcher>
 #include <QCoreApplication>
 #include <QTimer>
 #include <systemd/sd-daemon.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define KWIN_HAVE_BACKTRACE 1
+#endif
+
 class Watchdog : public QObject
 {
     Q_OBJECT
@@ -66,9 +80,156 @@ private:
     pid_t m_onBehalf = 0;
 };
 
+/**
+ * The StallMonitor class reports when the main thread has been busy for longer than a threshold
+ * without going back to the event loop, e.g. because a frame or a Wayland request took too long.
+ *
+ * The main thread only records when it wakes up and when it is about to block. A separate
+ * thread looks at it, and when the main thread stalls, interrupts it with a signal to capture
+ * its stack, which shows the frame or the request that is being processed.
+ *
+ * The threshold can be set in milliseconds with KWIN_STALL_THRESHOLD_MS, 0 disables the monitor.
+ */
+class StallMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    StallMonitor(std::chrono::milliseconds threshold, QObject *parent)
+        : QObject(parent)
+        , m_threshold(threshold)
+        , m_mainThread(pthread_self())
+    {
+#if KWIN_HAVE_BACKTRACE
+        // backtrace() loads libgcc the first time, which isn't safe in a signal handler
+        void *frame;
+        backtrace(&frame, 1);
+
+        struct sigaction action = {};
+        action.sa_handler = captureStack;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(stackSignal(), &action, nullptr);
+#endif
+
+        QAbstractEventDispatcher *dispatcher = QCoreApplication::eventDispatcher();
+        connect(dispatcher, &QAbstractEventDispatcher::awake, this, [this]() {
+            if (!m_busySince.load(std::memory_order_relaxed)) {
+                m_busySince.store(now(), std::memory_order_relaxed);
+            }
+        });
+        connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this, [this]() {
+            const int64_t busySince = m_busySince.exchange(0, std::memory_order_relaxed);
+            if (m_reported.exchange(false, std::memory_order_relaxed)) {
+                qCWarning(KWIN_WATCHDOG) << "Watchdog: the main thread was stalled for" << std::chrono::nanoseconds(now() - busySince);
+            }
+        });
+
+        m_thread = std::jthread([this](std::stop_token stopToken) {
+            run(stopToken);
+        });
+        qCDebug(KWIN_WATCHDOG) << "Watchdog: monitoring main thread stalls longer than" << m_threshold;
+    }
+
+    ~StallMonitor() override
+    {
+        m_thread.request_stop();
+        m_thread.join();
+    }
+
+private:
+    static int64_t now()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    static int stackSignal()
+    {
+        return SIGRTMIN + 4;
+    }
+
+    static void captureStack(int)
+    {
+#if KWIN_HAVE_BACKTRACE
+        s_stackDepth.store(backtrace(s_stack, s_maxStackDepth), std::memory_order_release);
+#endif
+    }
+
+    void run(std::stop_token stopToken)
+    {
+        std::mutex mutex;
+        std::condition_variable_any condition;
+        std::unique_lock lock(mutex);
+        while (!stopToken.stop_requested()) {
+            condition.wait_for(lock, stopToken, m_threshold / 2, [] {
+                return false;
+            });
+            if (stopToken.stop_requested()) {
+                break;
+            }
+            const int64_t busySince = m_busySince.load(std::memory_order_relaxed);
+            if (!busySince || m_reported.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            const auto stalled = std::chrono::nanoseconds(now() - busySince);
+            if (stalled < m_threshold) {
+                continue;
+            }
+            m_reported.store(true, std::memory_order_relaxed);
+            report(stalled);
+        }
+    }
+
+    void report(std::chrono::nanoseconds stalled)
+    {
+#if KWIN_HAVE_BACKTRACE
+        s_stackDepth.store(-1, std::memory_order_relaxed);
+        pthread_kill(m_mainThread, stackSignal());
+        int depth = -1;
+        for (int attempt = 0; attempt < 100 && depth < 0; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            depth = s_stackDepth.load(std::memory_order_acquire);
+        }
+        if (depth < 0) {
+            qCWarning(KWIN_WATCHDOG) << "Watchdog: the main thread has been stalled for" << stalled << "and did not respond";
+            return;
+        }
+
+        QString stack;
+        char **symbols = backtrace_symbols(s_stack, depth);
+        // the first two frames are the signal handler and the signal trampoline
+        for (int i = 2; i < depth; ++i) {
+            stack += QStringLiteral("\n  #%1 %2").arg(i - 2).arg(symbols ? QString::fromLocal8Bit(symbols[i]) : QStringLiteral("%1").arg(quintptr(s_stack[i]), 0, 16));
+        }
+        free(symbols);
+        qCWarning(KWIN_WATCHDOG).noquote() << "Watchdog: the main thread has been stalled for" << stalled << "in:" << stack;
+#else
+        qCWarning(KWIN_WATCHDOG) << "Watchdog: the main thread has been stalled for" << stalled;
+#endif
+    }
+
+    static constexpr int s_maxStackDepth = 64;
+    static inline void *s_stack[s_maxStackDepth];
+    static inline std::atomic<int> s_stackDepth = -1;
+
+    const std::chrono::milliseconds m_threshold;
+    const pthread_t m_mainThread;
+    std::atomic<int64_t> m_busySince = 0;
+    std::atomic<bool> m_reported = false;
+    std::jthread m_thread;
+};
+
 static void setupWatchdog()
 {
     new Watchdog(QCoreApplication::instance());
+
+    bool ok;
+    int stallThreshold = qEnvironmentVariableIntValue("KWIN_STALL_THRESHOLD_MS", &ok);
+    if (!ok) {
+        stallThreshold = 250;
+    }
+    if (stallThreshold > 0) {
+        new StallMonitor(std::chrono::milliseconds(stallThreshold), QCoreApplication::instance());
+    }
 }
 
 Q_COREAPP_STARTUP_FUNCTION(setupWatchdog)
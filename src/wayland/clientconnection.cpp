@@ -4,7 +4,9 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
 */
 #include "clientconnection.h"
+#include "clientconnection_p.h"
 #include "display.h"
+#include "display_p.h"
 #include "utils/executable_path.h"
 // Qt
 #include <QFileInfo>
@@ -14,26 +16,10 @@
 
 namespace KWin
 {
-class ClientConnectionPrivate
+ClientConnectionPrivate *ClientConnectionPrivate::get(ClientConnection *connection)
 {
-public:
-    ClientConnectionPrivate(wl_client *c, Display *display, ClientConnection *q);
-
-    wl_client *client;
-    Display *display;
-    pid_t pid = 0;
-    uid_t user = 0;
-    gid_t group = 0;
-    QString executablePath;
-    QString securityContextAppId;
-    qreal scaleOverride = 1.0;
-    bool tearingDown = false;
-
-private:
-    static void destroyListenerCallback(wl_listener *listener, void *data);
-
-    wl_listener destroyListener;
-};
+    return connection->d.get();
+}
 
 ClientConnectionPrivate::ClientConnectionPrivate(wl_client *c, Display *display, ClientConnection *q)
     : client(c)
@@ -56,6 +42,7 @@ void ClientConnectionPrivate::destroyListenerCallback(wl_listener *listener, voi
     ClientConnection *q = ClientConnection::get(reinterpret_cast<wl_client *>(data));
 
     Q_EMIT q->aboutToBeDestroyed();
+    DisplayPrivate::get(q->d->display)->clientDestroyed(q);
     wl_list_remove(&q->d->destroyListener.link);
     q->d->tearingDown = true;
 }
@@ -145,6 +132,21 @@ QString ClientConnection::securityContextAppId() const
     return d->securityContextAppId;
 }
 
+ClientConnection::Statistics ClientConnection::statistics() const
+{
+    return d->statistics;
+}
+
+void ClientConnection::addTearingPresentation()
+{
+    d->statistics.tearingPresentations++;
+}
+
+bool ClientConnection::isThrottled() const
+{
+    return d->throttled;
+}
+
 ClientConnection *ClientConnection::get(wl_client *native)
 {
     return static_cast<ClientConnection *>(wl_client_get_user_data(native));
@@ -10,6 +10,7 @@
 #include <sys/types.h>
 
 #include <QObject>
+#include <chrono>
 #include <memory>
 
 struct wl_client;
@@ -129,6 +130,43 @@ public:
     void setSecurityContextAppId(const QString &appId);
     QString securityContextAppId() const;
 
+    /**
+     * The Statistics struct describes how much work the client has caused the compositor. The
+     * counters only grow, sample them twice to get rates.
+     */
+    struct Statistics
+    {
+        quint64 requests = 0;
+        /**
+         * The size of all requests on the wire, excluding file descriptors.
+         */
+        quint64 bytesReceived = 0;
+        /**
+         * The time spent in request handlers, approximately.
+         */
+        std::chrono::nanoseconds dispatchTime{0};
+        quint64 bufferCommits = 0;
+        /**
+         * The area of all buffer damage, in device pixels.
+         */
+        quint64 damagedPixels = 0;
+        /**
+         * The number of frames presented with tearing while the client was fullscreen.
+         */
+        quint64 tearingPresentations = 0;
+    };
+    Statistics statistics() const;
+    void addTearingPresentation();
+
+    /**
+     * Returns @c true if the client has spent more time in request handlers than it's allowed
+     * to during the last budget period. Throttled clients should be asked to render less often.
+     *
+     * Budgets are only enforced if KWIN_CLIENT_DISPATCH_BUDGET is set to the number of
+     * milliseconds per second a client may keep the compositor busy.
+     */
+    bool isThrottled() const;
+
     /**
      * Returns the associated client connection object for the specified @a native wl_client object.
      */
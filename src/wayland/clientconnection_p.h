@@ -0,0 +1,44 @@
+/*
+    SPDX-FileCopyrightText: 2014 Martin Gräßlin <mgraesslin@kde.org>
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "clientconnection.h"
+
+#include <wayland-server-core.h>
+
+namespace KWin
+{
+
+class ClientConnectionPrivate
+{
+public:
+    static ClientConnectionPrivate *get(ClientConnection *connection);
+
+    ClientConnectionPrivate(wl_client *c, Display *display, ClientConnection *q);
+
+    wl_client *client;
+    Display *display;
+    pid_t pid = 0;
+    uid_t user = 0;
+    gid_t group = 0;
+    QString executablePath;
+    QString securityContextAppId;
+    qreal scaleOverride = 1.0;
+    bool tearingDown = false;
+
+    ClientConnection::Statistics statistics;
+    // The dispatch time when the budget has been checked the last time
+    std::chrono::nanoseconds budgetedDispatchTime{0};
+    bool throttled = false;
+
+private:
+    static void destroyListenerCallback(wl_listener *listener, void *data);
+
+    wl_listener destroyListener;
+};
+
+} // namespace KWin
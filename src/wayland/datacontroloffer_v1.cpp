@@ -6,6 +6,7 @@
 #include "datacontroloffer_v1.h"
 #include "datacontroldevice_v1.h"
 #include "datacontrolsource_v1.h"
+#include "selectioncache.h"
 // Qt
 #include <QPointer>
 #include <QStringList>
@@ -50,7 +51,11 @@ void DataControlOfferV1InterfacePrivate::ext_data_control_offer_v1_receive(Resou
     FileDescriptor pipe(fd);
 
     if (source) {
-        source->requestData(mimeType, std::move(pipe));
+        if (SelectionCache::isEnabled()) {
+            SelectionCache::get(source)->requestData(mimeType, std::move(pipe));
+        } else {
+            source->requestData(mimeType, std::move(pipe));
+        }
     }
 }
 
@@ -9,13 +9,17 @@
 #include "config-kwin.h"
 
 #include "clientconnection.h"
+#include "clientconnection_p.h"
+#include "core/graphicsbuffer.h"
 #include "display_p.h"
 #include "linuxdmabufv1clientbuffer_p.h"
 #include "output.h"
 #include "shmclientbuffer_p.h"
 #include "singlepixelbuffer.h"
+#include "tracing.h"
 #include "utils/common.h"
 #include "utils/containerof.h"
+#include "utils/envvar.h"
 
 #include <poll.h>
 #include <string.h>
@@ -26,6 +30,9 @@
 #include <QDebug>
 #include <QRect>
 
+#include <algorithm>
+#include <utility>
+
 namespace KWin
 {
 DisplayPrivate *DisplayPrivate::get(Display *display)
@@ -54,6 +61,109 @@ void DisplayPrivate::clientCreatedCallback(wl_listener *listener, void *data)
     Q_EMIT display->clientConnected(connection);
 }
 
+// Estimates the size of a request on the wire, see wl_closure_marshal()
+static quint64 requestSize(const wl_protocol_logger_message *message)
+{
+    quint64 size = 8;
+    int argument = 0;
+    for (const char *signature = message->message->signature; *signature; ++signature) {
+        switch (*signature) {
+        case 'i':
+        case 'u':
+        case 'f':
+        case 'o':
+        case 'n':
+            size += 4;
+            argument++;
+            break;
+        case 's':
+            size += 4;
+            if (argument < message->arguments_count && message->arguments[argument].s) {
+                size += (strlen(message->arguments[argument].s) + 1 + 3) & ~3;
+            }
+            argument++;
+            break;
+        case 'a':
+            size += 4;
+            if (argument < message->arguments_count && message->arguments[argument].a) {
+                size += (message->arguments[argument].a->size + 3) & ~3;
+            }
+            argument++;
+            break;
+        case 'h':
+            // file descriptors are passed out of band
+            argument++;
+            break;
+        default:
+            // version and nullability annotations
+            break;
+        }
+    }
+    return size;
+}
+
+void DisplayPrivate::protocolLoggerCallback(void *userData, wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    if (type != WL_PROTOCOL_LOGGER_REQUEST) {
+        return;
+    }
+    DisplayPrivate *displayPrivate = static_cast<DisplayPrivate *>(userData);
+    if (ClientConnection *client = ClientConnection::get(wl_resource_get_client(message->resource))) {
+        displayPrivate->beginRequest(client, message);
+    }
+}
+
+void DisplayPrivate::beginRequest(ClientConnection *client, const wl_protocol_logger_message *message)
+{
+    // The logger is called right before the handler of a request runs, so a request is
+    // considered handled when the next one begins or the event loop is done
+    endRequest();
+
+    ClientConnection::Statistics &statistics = ClientConnectionPrivate::get(client)->statistics;
+    statistics.requests++;
+    statistics.bytesReceived += requestSize(message);
+
+    dispatchingClient = client;
+    dispatchStart = std::chrono::steady_clock::now();
+}
+
+void DisplayPrivate::endRequest()
+{
+    if (dispatchingClient) {
+        ClientConnectionPrivate::get(dispatchingClient)->statistics.dispatchTime += std::chrono::steady_clock::now() - dispatchStart;
+        dispatchingClient = nullptr;
+    }
+}
+
+void DisplayPrivate::clientDestroyed(ClientConnection *client)
+{
+    if (dispatchingClient == client) {
+        endRequest();
+    }
+}
+
+void DisplayPrivate::checkDispatchBudgets()
+{
+    const auto clients = q->clients();
+    for (ClientConnection *client : clients) {
+        ClientConnectionPrivate *clientPrivate = ClientConnectionPrivate::get(client);
+        const std::chrono::nanoseconds dispatchTime = clientPrivate->statistics.dispatchTime - clientPrivate->budgetedDispatchTime;
+        clientPrivate->budgetedDispatchTime = clientPrivate->statistics.dispatchTime;
+        clientPrivate->throttled = dispatchTime > dispatchBudget;
+    }
+}
+
+void DisplayPrivate::sendBufferReleases()
+{
+    const auto releases = std::exchange(pendingBufferReleases, {});
+    for (const PendingBufferRelease &release : releases) {
+        // the buffer is gone if the client has destroyed it in the meantime
+        if (release.buffer && !release.buffer->isDropped() && !release.buffer->isReferenced()) {
+            wl_buffer_send_release(release.resource);
+        }
+    }
+}
+
 Display::Display(QObject *parent)
     : QObject(parent)
     , d(new DisplayPrivate(this))
@@ -63,6 +173,17 @@ Display::Display(QObject *parent)
 
     d->clientCreatedListener.notify = DisplayPrivate::clientCreatedCallback;
     wl_display_add_client_created_listener(d->display, &d->clientCreatedListener);
+
+    d->protocolLogger = wl_display_add_protocol_logger(d->display, DisplayPrivate::protocolLoggerCallback, d.get());
+
+    if (const auto budget = environmentVariableIntValue("KWIN_CLIENT_DISPATCH_BUDGET"); budget && *budget > 0) {
+        d->dispatchBudget = std::chrono::milliseconds(*budget);
+        d->dispatchBudgetTimer.setInterval(std::chrono::seconds(1));
+        connect(&d->dispatchBudgetTimer, &QTimer::timeout, this, [this]() {
+            d->checkDispatchBudgets();
+        });
+        d->dispatchBudgetTimer.start();
+    }
 }
 
 Display::~Display()
@@ -70,6 +191,7 @@ Display::~Display()
     wl_list_remove(&d->clientCreatedListener.link);
 
     wl_display_destroy_clients(d->display);
+    wl_protocol_logger_destroy(d->protocolLogger);
     wl_display_destroy(d->display);
 }
 
@@ -135,13 +257,16 @@ bool Display::start()
 
 void Display::dispatchEvents()
 {
+    traceScope(Wayland, "dispatchEvents");
     if (wl_event_loop_dispatch(d->loop, 0) != 0) {
         qCWarning(KWIN_CORE) << "Error on dispatching Wayland event loop";
     }
+    d->endRequest();
 }
 
 void Display::flush()
 {
+    d->sendBufferReleases();
     wl_display_flush_clients(d->display);
 }
 
@@ -217,6 +342,18 @@ QList<SeatInterface *> Display::seats() const
     return d->seats;
 }
 
+QList<ClientConnection *> Display::clients() const
+{
+    QList<ClientConnection *> connections;
+    wl_client *client;
+    wl_client_for_each (client, wl_display_get_client_list(d->display)) {
+        if (ClientConnection *connection = ClientConnection::get(client)) {
+            connections.append(connection);
+        }
+    }
+    return connections;
+}
+
 ClientConnection *Display::createClient(int fd)
 {
     Q_ASSERT(fd != -1);
@@ -242,6 +379,21 @@ GraphicsBuffer *Display::bufferForResource(wl_resource *resource)
     }
 }
 
+void Display::scheduleBufferRelease(GraphicsBuffer *buffer, wl_resource *resource)
+{
+    ClientConnection *client = ClientConnection::get(wl_resource_get_client(resource));
+    DisplayPrivate *displayPrivate = DisplayPrivate::get(client->display());
+    const bool pending = std::ranges::any_of(displayPrivate->pendingBufferReleases, [buffer](const auto &release) {
+        return release.buffer == buffer;
+    });
+    if (!pending) {
+        displayPrivate->pendingBufferReleases.push_back(DisplayPrivate::PendingBufferRelease{
+            .buffer = buffer,
+            .resource = resource,
+        });
+    }
+}
+
 void Display::setDefaultMaxBufferSize(size_t max)
 {
     wl_display_set_default_max_buffer_size(d->display, max);
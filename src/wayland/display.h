@@ -88,6 +88,11 @@ public:
      */
     ClientConnection *createClient(int fd);
 
+    /**
+     * Returns all clients that are connected to the display.
+     */
+    QList<ClientConnection *> clients() const;
+
     operator wl_display *();
     operator wl_display *() const;
     bool isRunning() const;
@@ -106,6 +111,12 @@ public:
      * Returns the graphics buffer for the given @a resource, or @c null if there's no buffer.
      */
     static GraphicsBuffer *bufferForResource(wl_resource *resource);
+    /**
+     * Sends wl_buffer.release for the @a buffer with the given @a resource right before the
+     * clients are flushed, unless the buffer has been referenced again by then. This way, the
+     * releases of a frame reach the clients along with its frame callbacks.
+     */
+    static void scheduleBufferRelease(GraphicsBuffer *buffer, wl_resource *resource);
 
     /**
      * Sets the default maximum size for connection buffers of new clients. The size is in bytes.
@@ -11,8 +11,13 @@
 
 #include "utils/filedescriptor.h"
 #include <QList>
+#include <QPointer>
 #include <QSocketNotifier>
 #include <QString>
+#include <QTimer>
+
+#include <chrono>
+#include <vector>
 
 struct wl_resource;
 
@@ -20,6 +25,7 @@ namespace KWin
 {
 class ClientConnection;
 class Display;
+class GraphicsBuffer;
 class OutputInterface;
 class OutputDeviceV2Interface;
 class SeatInterface;
@@ -33,6 +39,13 @@ public:
     void registerSocketName(const QString &socketName);
 
     static void clientCreatedCallback(wl_listener *listener, void *data);
+    static void protocolLoggerCallback(void *userData, wl_protocol_logger_type type, const wl_protocol_logger_message *message);
+
+    void beginRequest(ClientConnection *client, const wl_protocol_logger_message *message);
+    void endRequest();
+    void clientDestroyed(ClientConnection *client);
+    void checkDispatchBudgets();
+    void sendBufferReleases();
 
     Display *q;
     QSocketNotifier *socketNotifier = nullptr;
@@ -44,6 +57,22 @@ public:
     QList<SeatInterface *> seats;
     QStringList socketNames;
     wl_listener clientCreatedListener;
+    wl_protocol_logger *protocolLogger = nullptr;
+
+    // The client whose request is being dispatched
+    ClientConnection *dispatchingClient = nullptr;
+    std::chrono::steady_clock::time_point dispatchStart;
+
+    std::chrono::nanoseconds dispatchBudget{0};
+    QTimer dispatchBudgetTimer;
+
+    struct PendingBufferRelease
+    {
+        QPointer<GraphicsBuffer> buffer;
+        wl_resource *resource;
+    };
+    // The buffers that have been released since the clients were flushed last time
+    std::vector<PendingBufferRelease> pendingBufferReleases;
 };
 
 /**
@@ -6,10 +6,15 @@
 #include "externalbrightness_v1.h"
 #include "display.h"
 
+#include <chrono>
+#include <utility>
+
 namespace KWin
 {
 
 static constexpr uint32_t s_version = 3;
+// a DDC/CI write takes tens of milliseconds, the monitor can't follow faster than that anyway
+static constexpr std::chrono::milliseconds s_ddcCiInterval{100};
 
 ExternalBrightnessV1::ExternalBrightnessV1(Display *display, QObject *parent)
     : QObject(parent)
@@ -59,11 +64,47 @@ ExternalBrightnessDeviceV1::~ExternalBrightnessDeviceV1()
 
 void ExternalBrightnessDeviceV1::setBrightness(double brightness)
 {
-    m_observedBrightness.reset();
-
     const uint32_t minBrightness = m_internal ? 1 : 0; // some laptop screens turn off at brightness 0
     const uint32_t val = std::round(std::lerp(minBrightness, m_maxBrightness, std::clamp(brightness, 0.0, 1.0)));
-    send_requested_brightness(val);
+    // the brightness is set far more often than it changes by a whole step
+    const std::optional<uint32_t> latest = m_pendingBrightness ? m_pendingBrightness : m_requestedBrightness;
+    if (latest == val) {
+        return;
+    }
+    m_observedBrightness.reset();
+
+    if (!m_usesDdcCi) {
+        sendRequestedBrightness(val);
+        return;
+    }
+    m_pendingBrightness = val;
+    if (!m_ddcCiTimer) {
+        m_ddcCiTimer = std::make_unique<QTimer>();
+        m_ddcCiTimer->setSingleShot(true);
+        m_ddcCiTimer->setInterval(s_ddcCiInterval);
+        QObject::connect(m_ddcCiTimer.get(), &QTimer::timeout, [this]() {
+            sendPendingBrightness();
+        });
+    }
+    if (!m_ddcCiTimer->isActive()) {
+        sendPendingBrightness();
+    }
+}
+
+void ExternalBrightnessDeviceV1::sendRequestedBrightness(uint32_t value)
+{
+    m_requestedBrightness = value;
+    send_requested_brightness(value);
+}
+
+void ExternalBrightnessDeviceV1::sendPendingBrightness()
+{
+    // only the latest value matters, the ones in between are dropped
+    const auto value = std::exchange(m_pendingBrightness, std::nullopt);
+    if (value && value != m_requestedBrightness) {
+        sendRequestedBrightness(*value);
+        m_ddcCiTimer->start();
+    }
 }
 
 std::optional<double> ExternalBrightnessDeviceV1::observedBrightness() const
@@ -124,11 +165,15 @@ void ExternalBrightnessDeviceV1::kde_external_brightness_device_v1_set_uses_ddc_
 void ExternalBrightnessDeviceV1::kde_external_brightness_device_v1_set_max_brightness(Resource *resource, uint32_t value)
 {
     m_maxBrightness = value;
+    // the requested values are in the old range
+    m_requestedBrightness.reset();
 }
 
 void ExternalBrightnessDeviceV1::kde_external_brightness_device_v1_set_observed_brightness(Resource *resource, uint32_t value)
 {
     m_observedBrightness = value;
+    // the brightness has been changed behind our back, e.g. with the buttons on the monitor
+    m_requestedBrightness.reset();
 }
 
 void ExternalBrightnessDeviceV1::kde_external_brightness_device_v1_commit(Resource *resource)
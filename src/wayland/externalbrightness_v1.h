@@ -10,6 +10,7 @@
 #include <QByteArray>
 #include <QObject>
 #include <QPointer>
+#include <QTimer>
 #include <qwayland-server-kde-external-brightness-v1.h>
 
 namespace KWin
@@ -65,9 +66,16 @@ private:
     void kde_external_brightness_device_v1_set_observed_brightness(Resource *resource, uint32_t value) override;
     void kde_external_brightness_device_v1_commit(Resource *resource) override;
 
+    void sendRequestedBrightness(uint32_t value);
+    void sendPendingBrightness();
+
     QPointer<ExternalBrightnessV1> m_global;
     QByteArray m_edidBeginning;
     std::optional<uint32_t> m_observedBrightness;
+    std::optional<uint32_t> m_requestedBrightness;
+    std::optional<uint32_t> m_pendingBrightness;
+    // limits how often DDC/CI monitors are written to, while the brightness is being dragged
+    std::unique_ptr<QTimer> m_ddcCiTimer;
     uint32_t m_maxBrightness = 1;
     bool m_internal = false;
     bool m_usesDdcCi = false;
@@ -179,6 +179,12 @@ public:
         Q_EMIT q->textDirection(serial, qtDirection);
     }
 
+    void zwp_input_method_context_v1_bind_resource(Resource *) override
+    {
+        // the new resource has not seen the surrounding text yet
+        m_surroundingTextSent = false;
+    }
+
     void zwp_input_method_context_v1_destroy(Resource *resource) override
     {
         wl_resource_destroy(resource->handle);
@@ -186,6 +192,11 @@ public:
 
     InputMethodContextV1Interface *const q;
     std::unique_ptr<InputMethodGrabV1> m_keyboardGrab;
+
+    QString m_surroundingText;
+    uint32_t m_surroundingTextCursor = 0;
+    uint32_t m_surroundingTextAnchor = 0;
+    bool m_surroundingTextSent = false;
 };
 
 InputMethodContextV1Interface::InputMethodContextV1Interface(InputMethodV1Interface *parent)
@@ -312,8 +323,18 @@ void InputMethodContextV1Interface::sendReset()
 
 void InputMethodContextV1Interface::sendSurroundingText(const QString &text, uint32_t cursor, uint32_t anchor)
 {
+    // the input method reparses the whole text on every update, skip the ones that change nothing
+    if (d->m_surroundingTextSent && d->m_surroundingText == text && d->m_surroundingTextCursor == cursor && d->m_surroundingTextAnchor == anchor) {
+        return;
+    }
+    d->m_surroundingText = text;
+    d->m_surroundingTextCursor = cursor;
+    d->m_surroundingTextAnchor = anchor;
+    d->m_surroundingTextSent = true;
+
+    const QByteArray utf8 = text.toUtf8();
     for (auto r : d->resourceMap()) {
-        d->send_surrounding_text(r->handle, text, cursor, anchor);
+        zwp_input_method_context_v1_send_surrounding_text(r->handle, utf8.constData(), cursor, anchor);
     }
 }
 
@@ -13,6 +13,7 @@
 // Qt
 #include <QList>
 
+#include <algorithm>
 #include <unistd.h>
 
 namespace KWin
@@ -84,9 +85,10 @@ void KeyboardInterfacePrivate::sendRepeatInfo(Resource *resource)
 
 void KeyboardInterfacePrivate::sendKeymap(Resource *resource)
 {
-    // From version 7 on, keymaps must be mapped privately, so that
-    // we can seal the fd and reuse it between clients.
-    if (resource->version() >= 7 && sharedKeymapFile.effectiveFlags().testFlag(RamFile::Flag::SealWrite)) {
+    // From version 7 on, keymaps must be mapped privately. Older clients map them shared, but
+    // only for reading, which a file that is sealed for writing allows as well. So all clients
+    // can get the same file, unless it could not be sealed.
+    if (sharedKeymapFileSealed) {
         send_keymap(resource->handle, keymap_format::keymap_format_xkb_v1, sharedKeymapFile.fd(), sharedKeymapFile.size());
         // otherwise give each client its own unsealed copy.
     } else {
@@ -97,13 +99,26 @@ void KeyboardInterfacePrivate::sendKeymap(Resource *resource)
 
 void KeyboardInterface::setKeymap(const QByteArray &content)
 {
-    if (content.isNull()) {
+    if (content.isNull() || content == d->keymap) {
         return;
     }
 
-    d->keymap = content;
-    // +1 to include QByteArray null terminator.
-    d->sharedKeymapFile = RamFile("kwin-xkb-keymap-shared", content.constData(), content.size() + 1, RamFile::Flag::SealWrite);
+    const auto previous = std::ranges::find(d->previousKeymaps, content, &std::pair<QByteArray, RamFile>::first);
+    std::pair<QByteArray, RamFile> current(std::exchange(d->keymap, content), std::move(d->sharedKeymapFile));
+    if (previous != d->previousKeymaps.end()) {
+        d->sharedKeymapFile = std::move(previous->second);
+        d->previousKeymaps.erase(previous);
+    } else {
+        // +1 to include QByteArray null terminator.
+        d->sharedKeymapFile = RamFile("kwin-xkb-keymap-shared", content.constData(), content.size() + 1, RamFile::Flag::SealWrite);
+    }
+    if (!current.first.isNull()) {
+        d->previousKeymaps.push_front(std::move(current));
+        if (d->previousKeymaps.size() > 4) {
+            d->previousKeymaps.pop_back();
+        }
+    }
+    d->sharedKeymapFileSealed = d->sharedKeymapFile.effectiveFlags().testFlag(RamFile::Flag::SealWrite);
 
     const auto keyboardResources = d->resourceMap();
     for (KeyboardInterfacePrivate::Resource *resource : keyboardResources) {
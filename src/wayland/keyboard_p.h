@@ -13,6 +13,8 @@
 #include <QHash>
 #include <QPointer>
 
+#include <deque>
+
 namespace KWin
 {
 class ClientConnection;
@@ -43,6 +45,9 @@ public:
     QPointer<SurfaceInterface> modifierFocusSurface;
     QByteArray keymap;
     RamFile sharedKeymapFile;
+    bool sharedKeymapFileSealed = false;
+    // Recently used keymaps, so that switching back to one of them can reuse its file
+    std::deque<std::pair<QByteArray, RamFile>> previousKeymaps;
 
     struct
     {
@@ -363,7 +363,7 @@ void LinuxDmaBufV1ClientBuffer::initialize(wl_resource *resource)
     wl_resource_set_implementation(resource, &implementation, this, buffer_destroy_resource);
 
     connect(this, &GraphicsBuffer::released, [this]() {
-        wl_buffer_send_release(m_resource);
+        Display::scheduleBufferRelease(this, m_resource);
     });
 }
 
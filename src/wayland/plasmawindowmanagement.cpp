@@ -12,13 +12,16 @@
 #include "wayland/quirks.h"
 
 #include <QFile>
+#include <QFuture>
 #include <QHash>
 #include <QIcon>
 #include <QList>
 #include <QPointer>
 #include <QRect>
 #include <QThreadPool>
+#include <QTimer>
 #include <QUuid>
+#include <QtConcurrentRun>
 
 #include <qwayland-server-plasma-window-management.h>
 
@@ -27,6 +30,17 @@ namespace KWin
 static const quint32 s_version = 20;
 static const quint32 s_activationVersion = 1;
 
+static QThreadPool *iconThreadPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(1);
+        pool->setObjectName(QStringLiteral("KWin window icons"));
+        return pool;
+    }();
+    return pool;
+}
+
 class PlasmaWindowManagementInterfacePrivate : public QtWaylandServer::org_kde_plasma_window_management
 {
 public:
@@ -39,6 +53,8 @@ public:
     void sendStackingOrderUuidsChanged(wl_resource *resource);
     void sendStackingOrderChanged2();
     void sendStackingOrderChanged2(Resource *resource);
+    void scheduleFlush();
+    void flush();
 
     PlasmaWindowManagementInterface::ShowingDesktopState state = PlasmaWindowManagementInterface::ShowingDesktopState::Disabled;
     QList<PlasmaWindowInterface *> windows;
@@ -48,6 +64,13 @@ public:
     QList<QString> stackingOrderUuids;
     PlasmaWindowManagementInterface *q;
 
+    // Changes are sent once per turn of the event loop, so that clients wake up once for a
+    // burst of changes, e.g. when a window gets activated and restacked
+    QTimer flushTimer;
+    QList<PlasmaWindowInterfacePrivate *> pendingWindows;
+    bool stackingOrderPending = false;
+    bool stackingOrderUuidsPending = false;
+
 protected:
     void org_kde_plasma_window_management_bind_resource(Resource *resource) override;
     void org_kde_plasma_window_management_show_desktop(Resource *resource, uint32_t state) override;
@@ -83,6 +106,21 @@ public:
     wl_resource *resourceForParent(PlasmaWindowInterface *parent, Resource *child) const;
     void setClientGeometry(const QRect &geometry);
 
+    enum class Change : uint32_t {
+        AppId = 1 << 0,
+        Pid = 1 << 1,
+        Title = 1 << 2,
+        ApplicationMenu = 1 << 3,
+        State = 1 << 4,
+        ThemedIconName = 1 << 5,
+        Icon = 1 << 6,
+        Geometry = 1 << 7,
+        ResourceName = 1 << 8,
+        ClientGeometry = 1 << 9,
+    };
+    void scheduleChange(Change change);
+    void sendPendingChanges();
+
     quint32 windowId = 0;
     QHash<SurfaceInterface *, QRect> minimizedGeometries;
     PlasmaWindowManagementInterface *wm;
@@ -101,7 +139,12 @@ public:
     QString m_appServiceName;
     QString m_appObjectPath;
     QIcon m_icon;
+    // The serialized icon, shared by all get_icon requests until the icon changes
+    QFuture<QByteArray> m_iconData;
     quint32 m_state = 0;
+    // the state that the existing resources have been told about
+    quint32 m_sentState = 0;
+    uint32_t m_pendingChanges = 0;
     QString uuid;
     QString m_resourceName;
     QRect clientGeometry;
@@ -129,6 +172,36 @@ PlasmaWindowManagementInterfacePrivate::PlasmaWindowManagementInterfacePrivate(P
     : QtWaylandServer::org_kde_plasma_window_management(*display, s_version)
     , q(_q)
 {
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(0);
+    QObject::connect(&flushTimer, &QTimer::timeout, q, [this]() {
+        flush();
+    });
+}
+
+void PlasmaWindowManagementInterfacePrivate::scheduleFlush()
+{
+    if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+void PlasmaWindowManagementInterfacePrivate::flush()
+{
+    // the windows go first, the stacking order may refer to windows that got announced
+    // together with their properties
+    while (!pendingWindows.isEmpty()) {
+        pendingWindows.first()->sendPendingChanges();
+    }
+    if (stackingOrderPending) {
+        stackingOrderPending = false;
+        sendStackingOrderChanged();
+    }
+    if (stackingOrderUuidsPending) {
+        stackingOrderUuidsPending = false;
+        sendStackingOrderUuidsChanged();
+        sendStackingOrderChanged2();
+    }
 }
 
 void PlasmaWindowManagementInterfacePrivate::sendShowingDesktopState()
@@ -340,7 +413,8 @@ void PlasmaWindowManagementInterface::setStackingOrder(const QList<quint32> &sta
         return;
     }
     d->stackingOrder = stackingOrder;
-    d->sendStackingOrderChanged();
+    d->stackingOrderPending = true;
+    d->scheduleFlush();
 }
 
 void PlasmaWindowManagementInterface::setStackingOrderUuids(const QList<QString> &stackingOrderUuids)
@@ -349,8 +423,8 @@ void PlasmaWindowManagementInterface::setStackingOrderUuids(const QList<QString>
         return;
     }
     d->stackingOrderUuids = stackingOrderUuids;
-    d->sendStackingOrderUuidsChanged();
-    d->sendStackingOrderChanged2();
+    d->stackingOrderUuidsPending = true;
+    d->scheduleFlush();
 }
 
 void PlasmaWindowManagementInterface::setPlasmaVirtualDesktopManagementInterface(PlasmaVirtualDesktopManagementInterface *manager)
@@ -377,6 +451,9 @@ PlasmaWindowInterfacePrivate::PlasmaWindowInterfacePrivate(PlasmaWindowManagemen
 PlasmaWindowInterfacePrivate::~PlasmaWindowInterfacePrivate()
 {
     unmap();
+    if (m_pendingChanges) {
+        wm->d->pendingWindows.removeOne(this);
+    }
 }
 
 QtWaylandServer::org_kde_plasma_window::Resource *PlasmaWindowInterfacePrivate::org_kde_plasma_window_allocate()
@@ -389,6 +466,61 @@ void PlasmaWindowInterfacePrivate::org_kde_plasma_window_destroy(Resource *resou
     wl_resource_destroy(resource->handle);
 }
 
+void PlasmaWindowInterfacePrivate::scheduleChange(Change change)
+{
+    if (!m_pendingChanges) {
+        wm->d->pendingWindows.append(this);
+        wm->d->scheduleFlush();
+    }
+    m_pendingChanges |= uint32_t(change);
+}
+
+void PlasmaWindowInterfacePrivate::sendPendingChanges()
+{
+    const uint32_t changes = std::exchange(m_pendingChanges, 0);
+    if (!changes) {
+        return;
+    }
+    wm->d->pendingWindows.removeOne(this);
+
+    const bool stateChanged = (changes & uint32_t(Change::State)) && m_state != m_sentState;
+    m_sentState = m_state;
+
+    const auto clientResources = resourceMap();
+    for (auto resource : clientResources) {
+        if (changes & uint32_t(Change::AppId)) {
+            send_app_id_changed(resource->handle, truncate(m_appId));
+        }
+        if (changes & uint32_t(Change::Pid)) {
+            send_pid_changed(resource->handle, m_pid);
+        }
+        if (changes & uint32_t(Change::Title)) {
+            send_title_changed(resource->handle, truncate(m_title));
+        }
+        if ((changes & uint32_t(Change::ApplicationMenu)) && resource->version() >= ORG_KDE_PLASMA_WINDOW_APPLICATION_MENU_SINCE_VERSION) {
+            send_application_menu(resource->handle, m_appServiceName, m_appObjectPath);
+        }
+        if (stateChanged) {
+            send_state_changed(resource->handle, m_state);
+        }
+        if (changes & uint32_t(Change::ThemedIconName)) {
+            send_themed_icon_name_changed(resource->handle, m_themedIconName);
+        }
+        if ((changes & uint32_t(Change::Icon)) && resource->version() >= ORG_KDE_PLASMA_WINDOW_ICON_CHANGED_SINCE_VERSION) {
+            send_icon_changed(resource->handle);
+        }
+        if ((changes & uint32_t(Change::Geometry)) && geometry.isValid() && resource->version() >= ORG_KDE_PLASMA_WINDOW_GEOMETRY_SINCE_VERSION) {
+            send_geometry(resource->handle, geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        }
+        if ((changes & uint32_t(Change::ResourceName)) && resource->version() >= ORG_KDE_PLASMA_WINDOW_RESOURCE_NAME_CHANGED_SINCE_VERSION) {
+            send_resource_name_changed(resource->handle, m_resourceName);
+        }
+        if ((changes & uint32_t(Change::ClientGeometry)) && clientGeometry.isValid() && resource->version() >= ORG_KDE_PLASMA_WINDOW_CLIENT_GEOMETRY_SINCE_VERSION) {
+            send_client_geometry(resource->handle, clientGeometry.x(), clientGeometry.y(), clientGeometry.width(), clientGeometry.height());
+        }
+    }
+}
+
 void PlasmaWindowInterfacePrivate::sendInitialState(Resource *resource)
 {
     for (const auto &desk : std::as_const(plasmaVirtualDesktops)) {
@@ -447,11 +579,7 @@ void PlasmaWindowInterfacePrivate::setAppId(const QString &appId)
     }
 
     m_appId = appId;
-    const auto clientResources = resourceMap();
-
-    for (auto resource : clientResources) {
-        send_app_id_changed(resource->handle, truncate(m_appId));
-    }
+    scheduleChange(Change::AppId);
 }
 
 void PlasmaWindowInterfacePrivate::setPid(quint32 pid)
@@ -460,11 +588,7 @@ void PlasmaWindowInterfacePrivate::setPid(quint32 pid)
         return;
     }
     m_pid = pid;
-    const auto clientResources = resourceMap();
-
-    for (auto resource : clientResources) {
-        send_pid_changed(resource->handle, pid);
-    }
+    scheduleChange(Change::Pid);
 }
 
 void PlasmaWindowInterfacePrivate::setThemedIconName(const QString &iconName)
@@ -473,24 +597,15 @@ void PlasmaWindowInterfacePrivate::setThemedIconName(const QString &iconName)
         return;
     }
     m_themedIconName = iconName;
-    const auto clientResources = resourceMap();
-
-    for (auto resource : clientResources) {
-        send_themed_icon_name_changed(resource->handle, m_themedIconName);
-    }
+    scheduleChange(Change::ThemedIconName);
 }
 
 void PlasmaWindowInterfacePrivate::setIcon(const QIcon &icon)
 {
     m_icon = icon;
+    m_iconData = QFuture<QByteArray>();
     setThemedIconName(m_icon.name());
-
-    const auto clientResources = resourceMap();
-    for (auto resource : clientResources) {
-        if (resource->version() >= ORG_KDE_PLASMA_WINDOW_ICON_CHANGED_SINCE_VERSION) {
-            send_icon_changed(resource->handle);
-        }
-    }
+    scheduleChange(Change::Icon);
 }
 
 void PlasmaWindowInterfacePrivate::setResourceName(const QString &resourceName)
@@ -499,26 +614,42 @@ void PlasmaWindowInterfacePrivate::setResourceName(const QString &resourceName)
         return;
     }
     m_resourceName = resourceName;
-
-    const auto clientResources = resourceMap();
-    for (auto resource : clientResources) {
-        if (resource->version() >= ORG_KDE_PLASMA_WINDOW_RESOURCE_NAME_CHANGED_SINCE_VERSION) {
-            send_resource_name_changed(resource->handle, resourceName);
-        }
-    }
+    scheduleChange(Change::ResourceName);
 }
 
 void PlasmaWindowInterfacePrivate::org_kde_plasma_window_get_icon(Resource *resource, int32_t fd)
 {
-    QThreadPool::globalInstance()->start([fd, icon = m_icon]() {
+    // Serializing an icon can take a while, so it's done only once per icon on a dedicated
+    // thread. Clients that request icons over and over again then neither keep the compositor
+    // nor the global thread pool busy. Writing happens in the global thread pool, because a
+    // client that doesn't read the pipe would stall the icon thread otherwise.
+    if (!m_iconData.isValid()) {
+        // Themed icons are sent by name. Other icons may decode their pixmaps on demand, which
+        // must happen on this thread, so only the pixmaps go to the icon thread
+        QIcon icon = m_icon;
+        if (icon.name().isEmpty()) {
+            icon = QIcon();
+            const QList<QSize> sizes = m_icon.availableSizes();
+            for (const QSize &size : sizes) {
+                icon.addPixmap(m_icon.pixmap(size));
+            }
+        }
+        m_iconData = QtConcurrent::run(iconThreadPool(), [icon]() {
+            QByteArray data;
+            QDataStream ds(&data, QIODevice::WriteOnly);
+            ds << icon;
+            return data;
+        });
+    }
+
+    m_iconData.then(QThreadPool::globalInstance(), [fd](const QByteArray &data) {
         QFile file;
         if (!file.open(fd, QIODevice::WriteOnly, QFileDevice::AutoCloseHandle)) {
             close(fd);
             qCWarning(KWIN_CORE) << Q_FUNC_INFO << "failed to open file:" << file.errorString();
             return;
         }
-        QDataStream ds(&file);
-        ds << icon;
+        file.write(data);
         file.close();
     });
 }
@@ -559,11 +690,7 @@ void PlasmaWindowInterfacePrivate::setTitle(const QString &title)
         return;
     }
     m_title = title;
-    const auto clientResources = resourceMap();
-
-    for (auto resource : clientResources) {
-        send_title_changed(resource->handle, truncate(m_title));
-    }
+    scheduleChange(Change::Title);
 }
 
 void PlasmaWindowInterfacePrivate::unmap()
@@ -572,6 +699,8 @@ void PlasmaWindowInterfacePrivate::unmap()
         return;
     }
     unmapped = true;
+    // the clients forget about the window once it's unmapped
+    sendPendingChanges();
     const auto clientResources = resourceMap();
 
     for (auto resource : clientResources) {
@@ -591,11 +720,7 @@ void PlasmaWindowInterfacePrivate::setState(org_kde_plasma_window_management_sta
         return;
     }
     m_state = newState;
-    const auto clientResources = resourceMap();
-
-    for (auto resource : clientResources) {
-        send_state_changed(resource->handle, m_state);
-    }
+    scheduleChange(Change::State);
 }
 
 wl_resource *PlasmaWindowInterfacePrivate::resourceForParent(PlasmaWindowInterface *parent, Resource *child) const
@@ -647,14 +772,7 @@ void PlasmaWindowInterfacePrivate::setGeometry(const QRect &geo)
     if (!geometry.isValid()) {
         return;
     }
-
-    const auto clientResources = resourceMap();
-    for (auto resource : clientResources) {
-        if (resource->version() < ORG_KDE_PLASMA_WINDOW_GEOMETRY_SINCE_VERSION) {
-            continue;
-        }
-        send_geometry(resource->handle, geometry.x(), geometry.y(), geometry.width(), geometry.height());
-    }
+    scheduleChange(Change::Geometry);
 }
 
 void PlasmaWindowInterfacePrivate::setApplicationMenuPaths(const QString &service, const QString &object)
@@ -664,13 +782,7 @@ void PlasmaWindowInterfacePrivate::setApplicationMenuPaths(const QString &servic
     }
     m_appServiceName = service;
     m_appObjectPath = object;
-    const auto clientResources = resourceMap();
-    for (auto resource : clientResources) {
-        if (resource->version() < ORG_KDE_PLASMA_WINDOW_APPLICATION_MENU_SINCE_VERSION) {
-            continue;
-        }
-        send_application_menu(resource->handle, service, object);
-    }
+    scheduleChange(Change::ApplicationMenu);
 }
 
 void PlasmaWindowInterfacePrivate::org_kde_plasma_window_close(Resource *resource)
@@ -1180,14 +1292,7 @@ void PlasmaWindowInterfacePrivate::setClientGeometry(const QRect &geometry)
     if (!clientGeometry.isValid()) {
         return;
     }
-
-    const auto clientResources = resourceMap();
-    for (auto resource : clientResources) {
-        if (resource->version() < ORG_KDE_PLASMA_WINDOW_CLIENT_GEOMETRY_SINCE_VERSION) {
-            continue;
-        }
-        send_client_geometry(resource->handle, clientGeometry.x(), clientGeometry.y(), clientGeometry.width(), clientGeometry.height());
-    }
+    scheduleChange(Change::ClientGeometry);
 }
 }
 
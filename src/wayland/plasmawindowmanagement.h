@@ -97,6 +97,7 @@ Q_SIGNALS:
     void requestChangeShowingDesktop(ShowingDesktopState requestedState);
 
 private:
+    friend class PlasmaWindowInterfacePrivate;
     std::unique_ptr<PlasmaWindowManagementInterfacePrivate> d;
 };
 
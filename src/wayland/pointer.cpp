@@ -164,6 +164,11 @@ quint32 PointerInterface::focusedSerial() const
     return d->focusedSerial;
 }
 
+bool PointerInterface::hasRelativePointer(ClientConnection *client) const
+{
+    return d->relativePointersV1->resourceMap().contains(client->client());
+}
+
 void PointerInterface::sendEnter(SurfaceInterface *surface, const QPointF &position, quint32 serial)
 {
     if (d->focusedSurface == surface) {
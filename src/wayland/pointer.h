@@ -44,6 +44,11 @@ public:
     SurfaceInterface *focusedSurface() const;
     quint32 focusedSerial() const;
 
+    /**
+     * Returns @c true if the given @a client has a relative pointer for this pointer.
+     */
+    bool hasRelativePointer(ClientConnection *client) const;
+
     /**
      * Returns the seat to which this pointer belongs to.
      */
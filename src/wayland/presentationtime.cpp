@@ -35,7 +35,7 @@ void PresentationTime::wp_presentation_feedback(Resource *resource, wl_resource
 
     auto &feedback = surfPriv->pending->presentationFeedback;
     if (!feedback) {
-        feedback = std::make_unique<PresentationTimeFeedback>();
+        feedback = std::make_unique<PresentationTimeFeedback>(surfPriv->presentationStatistics);
     }
 
     wl_resource *feedbackResource = wl_resource_create(resource->client(), &wp_presentation_feedback_interface, resource->version(), callback);
@@ -46,7 +46,8 @@ void PresentationTime::wp_presentation_feedback(Resource *resource, wl_resource
     wl_list_insert(feedback->resources.prev, wl_resource_get_link(feedbackResource));
 }
 
-PresentationTimeFeedback::PresentationTimeFeedback()
+PresentationTimeFeedback::PresentationTimeFeedback(const std::shared_ptr<PresentationStatistics> &statistics)
+    : m_statistics(statistics)
 {
     wl_list_init(&resources);
 }
@@ -56,6 +57,7 @@ PresentationTimeFeedback::~PresentationTimeFeedback()
     if (m_presented) {
         return;
     }
+    m_statistics->addDiscarded();
     wl_resource *resource;
     wl_resource *tmp;
     wl_resource_for_each_safe (resource, tmp, &resources) {
@@ -70,6 +72,9 @@ void PresentationTimeFeedback::presented(std::chrono::nanoseconds refreshCycleDu
         return;
     }
     m_presented = true;
+    if (commitTimestamp != std::chrono::nanoseconds::zero()) {
+        m_statistics->addPresented(timestamp - commitTimestamp, mode, zeroCopy);
+    }
     const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timestamp);
     const uint32_t tvSecHi = secs.count() >> 32;
     const uint32_t tvSecLo = secs.count() & 0xffffffff;
@@ -80,6 +85,9 @@ void PresentationTimeFeedback::presented(std::chrono::nanoseconds refreshCycleDu
     if (mode == PresentationMode::VSync || mode == PresentationMode::AdaptiveSync) {
         flags |= WP_PRESENTATION_FEEDBACK_KIND_VSYNC;
     }
+    if (zeroCopy) {
+        flags |= WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY;
+    }
 
     wl_resource *resource;
     wl_resource *tmp;
@@ -17,6 +17,7 @@ namespace KWin
 
 class Display;
 class SurfaceInterface;
+struct PresentationStatistics;
 
 class PresentationTime : public QObject, QtWaylandServer::wp_presentation
 {
@@ -33,14 +34,24 @@ private:
 class PresentationTimeFeedback : public PresentationFeedback
 {
 public:
-    PresentationTimeFeedback();
+    explicit PresentationTimeFeedback(const std::shared_ptr<PresentationStatistics> &statistics);
     ~PresentationTimeFeedback() override;
 
     wl_list resources;
+    /**
+     * The time at which the surface state this feedback belongs to has been committed.
+     */
+    std::chrono::nanoseconds commitTimestamp = std::chrono::nanoseconds::zero();
+    /**
+     * Whether the buffer of the surface is going to be scanned out directly.
+     */
+    bool zeroCopy = false;
 
     void presented(std::chrono::nanoseconds refreshCycleDuration, std::chrono::nanoseconds timestamp, PresentationMode mode) override;
 
 private:
+    // shared with the surface, which may be destroyed before the feedback
+    std::shared_ptr<PresentationStatistics> m_statistics;
     bool m_presented = false;
 };
 
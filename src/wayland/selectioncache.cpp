@@ -0,0 +1,235 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "selectioncache.h"
+#include "abstract_data_source.h"
+#include "config-kwin.h"
+#include "utils/envvar.h"
+#include "utils/pipe.h"
+
+#include <QSocketNotifier>
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <optional>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+namespace KWin
+{
+
+// Images are the largest thing that is usually copied, anything bigger is read from the source every time
+static const off_t s_maxCacheSize = 32 * 1024 * 1024;
+
+static void discardNotifier(std::unique_ptr<QSocketNotifier> notifier)
+{
+    // this may be called from the notifier's own signal
+    if (notifier) {
+        notifier->setEnabled(false);
+        notifier.release()->deleteLater();
+    }
+}
+
+SelectionCache::SelectionCache(AbstractDataSource *source)
+    : QObject(source)
+    , m_source(source)
+{
+}
+
+SelectionCache::~SelectionCache() = default;
+
+bool SelectionCache::isEnabled()
+{
+    static const bool enabled = environmentVariableBoolValue("KWIN_WAYLAND_SELECTION_CACHE").value_or(false);
+    return enabled;
+}
+
+SelectionCache *SelectionCache::get(AbstractDataSource *source)
+{
+    if (auto cache = source->findChild<SelectionCache *>(QString(), Qt::FindDirectChildrenOnly)) {
+        return cache;
+    }
+    return new SelectionCache(source);
+}
+
+void SelectionCache::requestData(const QString &mimeType, FileDescriptor fd)
+{
+    if (!m_source->mimeTypes().contains(mimeType)) {
+        m_source->requestData(mimeType, std::move(fd));
+        return;
+    }
+
+    std::unique_ptr<Entry> &entry = m_entries[mimeType];
+    if (!entry) {
+        entry = std::make_unique<Entry>();
+        entry->mimeType = mimeType;
+        if (!startCaching(entry.get())) {
+            entry->uncacheable = true;
+        }
+    }
+    if (entry->uncacheable) {
+        m_source->requestData(mimeType, std::move(fd));
+        return;
+    }
+
+    const int flags = fcntl(fd.get(), F_GETFL);
+    if (flags == -1 || fcntl(fd.get(), F_SETFL, flags | O_NONBLOCK) == -1) {
+        m_source->requestData(mimeType, std::move(fd));
+        return;
+    }
+
+    entry->readers.push_back(std::make_unique<Reader>(Reader{
+        .fd = std::move(fd),
+    }));
+    if (entry->complete) {
+        serve(entry.get(), entry->readers.back().get());
+    }
+}
+
+bool SelectionCache::startCaching(Entry *entry)
+{
+#if HAVE_MEMFD
+    entry->memfd = FileDescriptor(memfd_create("kwin-selection", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!entry->memfd.isValid()) {
+        return false;
+    }
+
+    std::optional<Pipe> pipe = Pipe::create(O_CLOEXEC);
+    if (!pipe) {
+        entry->memfd.reset();
+        return false;
+    }
+    // only our end is non-blocking, the source client must not be surprised by EAGAIN
+    const int flags = fcntl(pipe->readEndpoint.get(), F_GETFL);
+    if (flags == -1 || fcntl(pipe->readEndpoint.get(), F_SETFL, flags | O_NONBLOCK) == -1) {
+        entry->memfd.reset();
+        return false;
+    }
+
+    entry->sourceFd = std::move(pipe->readEndpoint);
+    entry->sourceNotifier = std::make_unique<QSocketNotifier>(entry->sourceFd.get(), QSocketNotifier::Read);
+    connect(entry->sourceNotifier.get(), &QSocketNotifier::activated, this, [this, entry]() {
+        readSource(entry);
+    });
+    m_source->requestData(entry->mimeType, std::move(pipe->writeEndpoint));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SelectionCache::readSource(Entry *entry)
+{
+    char buffer[16384];
+    while (true) {
+        const ssize_t readSize = read(entry->sourceFd.get(), buffer, sizeof(buffer));
+        if (readSize > 0) {
+            if (entry->size + readSize > s_maxCacheSize) {
+                abortCaching(entry);
+                return;
+            }
+            ssize_t written = 0;
+            while (written < readSize) {
+                const ssize_t ret = write(entry->memfd.get(), buffer + written, readSize - written);
+                if (ret < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    abortCaching(entry);
+                    return;
+                }
+                written += ret;
+            }
+            entry->size += readSize;
+        } else if (readSize == 0) {
+            finishCaching(entry);
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN) {
+            return;
+        } else {
+            abortCaching(entry);
+            return;
+        }
+    }
+}
+
+void SelectionCache::finishCaching(Entry *entry)
+{
+    discardNotifier(std::move(entry->sourceNotifier));
+    entry->sourceFd.reset();
+    fcntl(entry->memfd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    entry->complete = true;
+
+    std::vector<Reader *> readers;
+    readers.reserve(entry->readers.size());
+    for (const auto &reader : entry->readers) {
+        readers.push_back(reader.get());
+    }
+    for (Reader *reader : readers) {
+        serve(entry, reader);
+    }
+}
+
+void SelectionCache::abortCaching(Entry *entry)
+{
+    discardNotifier(std::move(entry->sourceNotifier));
+    entry->sourceFd.reset();
+    entry->memfd.reset();
+    entry->size = 0;
+    entry->uncacheable = true;
+
+    // nothing has been written to the readers yet, let the source serve them directly
+    const std::vector<std::unique_ptr<Reader>> readers = std::move(entry->readers);
+    entry->readers.clear();
+    for (const auto &reader : readers) {
+        m_source->requestData(entry->mimeType, std::move(reader->fd));
+    }
+}
+
+void SelectionCache::serve(Entry *entry, Reader *reader)
+{
+    while (reader->offset < entry->size) {
+        const ssize_t ret = sendfile(reader->fd.get(), entry->memfd.get(), &reader->offset, entry->size - reader->offset);
+        if (ret > 0) {
+            continue;
+        }
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0 && errno == EAGAIN) {
+            if (!reader->notifier) {
+                reader->notifier = std::make_unique<QSocketNotifier>(reader->fd.get(), QSocketNotifier::Write);
+                connect(reader->notifier.get(), &QSocketNotifier::activated, this, [this, entry, reader]() {
+                    serve(entry, reader);
+                });
+            }
+            return;
+        }
+        // the reader has gone away
+        break;
+    }
+    removeReader(entry, reader);
+}
+
+void SelectionCache::removeReader(Entry *entry, Reader *reader)
+{
+    auto it = std::ranges::find_if(entry->readers, [reader](const auto &candidate) {
+        return candidate.get() == reader;
+    });
+    if (it == entry->readers.end()) {
+        return;
+    }
+    discardNotifier(std::move(reader->notifier));
+    entry->readers.erase(it);
+}
+
+} // namespace KWin
+
+#include "moc_selectioncache.cpp"
@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include "utils/filedescriptor.h"
+
+#include <QObject>
+
+#include <map>
+#include <memory>
+#include <sys/types.h>
+#include <vector>
+
+class QSocketNotifier;
+
+namespace KWin
+{
+
+class AbstractDataSource;
+
+/**
+ * The SelectionCache class reads the contents of a selection once per mime type and serves
+ * every reader from a sealed memfd, so clipboard managers that all fetch the new selection
+ * don't make the source client send the same data over and over again.
+ *
+ * Contents that are larger than the size limit aren't cached, the readers are sent to the
+ * source client as usual then.
+ */
+class SelectionCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~SelectionCache() override;
+
+    /**
+     * Returns @c true if the selection contents should be cached, i.e. KWIN_WAYLAND_SELECTION_CACHE is set to 1.
+     */
+    static bool isEnabled();
+
+    /**
+     * Returns the cache of @a source, it's created on first use and goes away together with the source.
+     */
+    static SelectionCache *get(AbstractDataSource *source);
+
+    /**
+     * Writes the contents of the selection with the given @a mimeType to @a fd.
+     */
+    void requestData(const QString &mimeType, FileDescriptor fd);
+
+private:
+    struct Reader
+    {
+        FileDescriptor fd;
+        off_t offset = 0;
+        std::unique_ptr<QSocketNotifier> notifier;
+    };
+
+    struct Entry
+    {
+        QString mimeType;
+        FileDescriptor memfd;
+        off_t size = 0;
+        bool complete = false;
+        bool uncacheable = false;
+        FileDescriptor sourceFd;
+        std::unique_ptr<QSocketNotifier> sourceNotifier;
+        std::vector<std::unique_ptr<Reader>> readers;
+    };
+
+    explicit SelectionCache(AbstractDataSource *source);
+
+    bool startCaching(Entry *entry);
+    void readSource(Entry *entry);
+    void finishCaching(Entry *entry);
+    void abortCaching(Entry *entry);
+    void serve(Entry *entry, Reader *reader);
+    void removeReader(Entry *entry, Reader *reader);
+
+    AbstractDataSource *m_source;
+    std::map<QString, std::unique_ptr<Entry>> m_entries;
+};
+
+} // namespace KWin
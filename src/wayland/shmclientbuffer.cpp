@@ -177,7 +177,7 @@ ShmClientBuffer::ShmClientBuffer(ShmPool *pool, ShmAttributes attributes, wl_cli
     m_shmPool->ref();
 
     connect(this, &GraphicsBuffer::released, [this]() {
-        wl_buffer_send_release(m_resource);
+        Display::scheduleBufferRelease(this, m_resource);
     });
 
     m_resource = wl_resource_create(client, &wl_buffer_interface, 1, id);
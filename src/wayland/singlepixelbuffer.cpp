@@ -46,7 +46,7 @@ SinglePixelClientBuffer::SinglePixelClientBuffer(uint32_t r, uint32_t g, uint32_
     , m_resource(wl_resource_create(client, &wl_buffer_interface, 1, id))
 {
     connect(this, &GraphicsBuffer::released, [this]() {
-        wl_buffer_send_release(m_resource);
+        Display::scheduleBufferRelease(this, m_resource);
     });
     wl_resource_set_implementation(m_resource, &implementation, this, buffer_destroy_resource);
 }
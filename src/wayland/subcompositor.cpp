@@ -284,6 +284,7 @@ void SubSurfaceInterface::parentApplyState()
         const QPoint &pos = parentPrivate->current->subsurface.position[this];
         if (d->position != pos) {
             d->position = pos;
+            parentPrivate->markSubSurfaceTreeChanged();
             Q_EMIT positionChanged(pos);
         }
     }
@@ -7,6 +7,7 @@
 #include "surface.h"
 #include "blur.h"
 #include "clientconnection.h"
+#include "clientconnection_p.h"
 #include "colormanagement_v1.h"
 #include "colorrepresentation_v1.h"
 #include "compositor.h"
@@ -26,6 +27,7 @@
 #include "subcompositor.h"
 #include "surface_p.h"
 #include "transaction.h"
+#include "utils/freelist.h"
 #include "utils/resource.h"
 
 #include <algorithm>
@@ -45,6 +47,51 @@ static QRegion map_helper(const QMatrix4x4 &matrix, const QRegion &region)
     return result;
 }
 
+void PresentationStatistics::addPresented(std::chrono::nanoseconds latency, PresentationMode mode, bool zeroCopy)
+{
+    presented++;
+    if (mode == PresentationMode::VSync || mode == PresentationMode::AdaptiveSync) {
+        vsync++;
+    } else {
+        async++;
+    }
+    if (zeroCopy) {
+        this->zeroCopy++;
+    } else {
+        composited++;
+        if (m_lastZeroCopy) {
+            zeroCopyExits++;
+        }
+    }
+    m_lastZeroCopy = zeroCopy;
+    m_latencies[m_latencyCount % s_latencyCount] = latency;
+    m_latencyCount++;
+}
+
+void PresentationStatistics::addDiscarded()
+{
+    discarded++;
+}
+
+std::chrono::nanoseconds PresentationStatistics::latency(double percentile) const
+{
+    const size_t count = std::min<quint64>(m_latencyCount, s_latencyCount);
+    if (!count) {
+        return std::chrono::nanoseconds::zero();
+    }
+    std::array<std::chrono::nanoseconds, s_latencyCount> sorted = m_latencies;
+    std::sort(sorted.begin(), sorted.begin() + count);
+    return sorted[std::min<size_t>(count - 1, count * percentile / 100)];
+}
+
+std::chrono::nanoseconds PresentationStatistics::lastLatency() const
+{
+    if (!m_latencyCount) {
+        return std::chrono::nanoseconds::zero();
+    }
+    return m_latencies[(m_latencyCount - 1) % s_latencyCount];
+}
+
 SurfaceRole::SurfaceRole(const QByteArray &name)
     : m_name(name)
 {
@@ -93,6 +140,9 @@ void SurfaceInterfacePrivate::addChild(SubSurfaceInterface *child)
 
     Q_EMIT q->childSubSurfaceAdded(child);
     Q_EMIT q->childSubSurfacesChanged();
+
+    markSubSurfaceTreeChanged();
+    SurfaceInterfacePrivate::get(q->mainSurface())->flushSubSurfaceTreeChanged();
 }
 
 void SurfaceInterfacePrivate::removeChild(SubSurfaceInterface *child)
@@ -120,6 +170,9 @@ void SurfaceInterfacePrivate::removeChild(SubSurfaceInterface *child)
 
     Q_EMIT q->childSubSurfaceRemoved(child);
     Q_EMIT q->childSubSurfacesChanged();
+
+    markSubSurfaceTreeChanged();
+    SurfaceInterfacePrivate::get(q->mainSurface())->flushSubSurfaceTreeChanged();
 }
 
 bool SurfaceInterfacePrivate::raiseChild(SubSurfaceInterface *subsurface, SurfaceInterface *anchor)
@@ -355,6 +408,10 @@ void SurfaceInterfacePrivate::surface_commit(Resource *resource)
         pending->bufferDamage = QRegion();
     }
 
+    if (pending->presentationFeedback) {
+        pending->presentationFeedback->commitTimestamp = std::chrono::steady_clock::now().time_since_epoch();
+    }
+
     // unless a protocol overrides the properties, we need to assume some YUV->RGB conversion
     // matrix and color space to be attached to YUV formats
     const bool hasColorManagementProtocol = colorSurface || frogColorManagement;
@@ -577,6 +634,18 @@ bool SurfaceInterface::hasPresentationFeedback() const
     return d->current->presentationFeedback.get();
 }
 
+void SurfaceInterface::markZeroCopy()
+{
+    if (d->current->presentationFeedback) {
+        d->current->presentationFeedback->zeroCopy = true;
+    }
+}
+
+const PresentationStatistics &SurfaceInterface::presentationStatistics() const
+{
+    return *d->presentationStatistics;
+}
+
 bool SurfaceInterface::hasFrameCallbacks() const
 {
     return !wl_list_empty(&d->current->frameCallbacks);
@@ -597,6 +666,19 @@ QRectF SurfaceInterfacePrivate::computeBufferSourceBox() const
     return current->bufferTransform.map(box, bounds);
 }
 
+static FreeList<SurfaceState, 64> s_surfaceStateFreeList;
+
+void *SurfaceState::operator new(size_t size)
+{
+    Q_ASSERT(size == sizeof(SurfaceState));
+    return s_surfaceStateFreeList.allocate();
+}
+
+void SurfaceState::operator delete(void *ptr)
+{
+    s_surfaceStateFreeList.release(ptr);
+}
+
 SurfaceState::SurfaceState()
 {
     wl_list_init(&frameCallbacks);
@@ -683,6 +765,7 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
     const bool bufferReleasePointChanged = (next->committed & SurfaceState::Field::Buffer) && current->releasePoint != next->releasePoint;
     const bool alphaMultiplierChanged = (next->committed & SurfaceState::Field::AlphaMultiplier);
     const bool yuvCoefficientsChanged = (next->committed & SurfaceState::Field::YuvCoefficients) && (current->yuvCoefficients != next->yuvCoefficients);
+    const bool bufferCommitted = (next->committed & SurfaceState::Field::Buffer);
 
     const QSizeF oldSurfaceSize = surfaceSize;
     const QRectF oldBufferSourceBox = bufferSourceBox;
@@ -727,6 +810,14 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
         current->damage = QRegion();
         current->bufferDamage = QRegion();
 
+        ClientConnection::Statistics &statistics = ClientConnectionPrivate::get(client)->statistics;
+        if (bufferCommitted) {
+            statistics.bufferCommits++;
+        }
+        for (const QRect &rect : bufferDamage) {
+            statistics.damagedPixels += quint64(rect.width()) * rect.height();
+        }
+
         if (scaleOverride != 1.0) {
             QMatrix4x4 scaleOverrideMatrix;
             scaleOverrideMatrix.scale(1.0 / scaleOverride, 1.0 / scaleOverride);
@@ -778,6 +869,10 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
     }
     if (subsurfaceOrderChanged) {
         Q_EMIT q->childSubSurfacesChanged();
+        markSubSurfaceTreeChanged();
+    }
+    if (subsurface.handle && surfaceSize != oldSurfaceSize) {
+        markSubSurfaceTreeChanged();
     }
     if (colorDescriptionChanged || yuvCoefficientsChanged) {
         current->colorDescription = current->colorDescription->withYuvCoefficients(current->yuvCoefficients, current->range);
@@ -830,6 +925,9 @@ void SurfaceInterfacePrivate::updateEffectiveMapped()
     }
 
     mapped = effectiveMapped;
+    if (subsurface.handle) {
+        markSubSurfaceTreeChanged();
+    }
 
     if (mapped) {
         Q_EMIT q->mapped();
@@ -847,6 +945,19 @@ void SurfaceInterfacePrivate::updateEffectiveMapped()
     }
 }
 
+void SurfaceInterfacePrivate::markSubSurfaceTreeChanged()
+{
+    SurfaceInterfacePrivate::get(q->mainSurface())->subSurfaceTreeChanged = true;
+}
+
+void SurfaceInterfacePrivate::flushSubSurfaceTreeChanged()
+{
+    if (subSurfaceTreeChanged) {
+        subSurfaceTreeChanged = false;
+        Q_EMIT q->subSurfaceTreeChanged();
+    }
+}
+
 bool SurfaceInterfacePrivate::contains(const QPointF &position) const
 {
     // avoid QRectF::contains as that includes all edges
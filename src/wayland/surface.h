@@ -13,6 +13,8 @@
 #include <QObject>
 #include <QRegion>
 
+#include <array>
+
 struct wl_resource;
 
 namespace KWin
@@ -53,6 +55,49 @@ private:
     QByteArray m_name;
 };
 
+/**
+ * The PresentationStatistics struct describes how the states of a surface that the client
+ * asked presentation feedback for have been presented. The latencies are kept for the most
+ * recently presented states only, the counters are never reset.
+ */
+struct KWIN_EXPORT PresentationStatistics
+{
+    static constexpr size_t s_latencyCount = 128;
+
+    void addPresented(std::chrono::nanoseconds latency, PresentationMode mode, bool zeroCopy);
+    void addDiscarded();
+
+    /**
+     * Returns the @a percentile (0-100) of the time between the commit of a state and it being
+     * shown on the screen among the recent states, or zero if no state has been presented.
+     */
+    std::chrono::nanoseconds latency(double percentile) const;
+    std::chrono::nanoseconds lastLatency() const;
+
+    quint64 presented = 0;
+    /**
+     * The number of states that have been replaced or hidden before they were shown.
+     */
+    quint64 discarded = 0;
+    quint64 vsync = 0;
+    quint64 async = 0;
+    /**
+     * The number of states that have been shown without being composited, i.e. with the buffer
+     * of the client being scanned out directly.
+     */
+    quint64 zeroCopy = 0;
+    quint64 composited = 0;
+    /**
+     * How often the surface has gone from being scanned out to being composited.
+     */
+    quint64 zeroCopyExits = 0;
+
+private:
+    std::array<std::chrono::nanoseconds, s_latencyCount> m_latencies{};
+    quint64 m_latencyCount = 0;
+    bool m_lastZeroCopy = false;
+};
+
 /**
  * @brief Resource representing a wl_surface.
  *
@@ -140,6 +185,12 @@ public:
 
     std::shared_ptr<PresentationFeedback> presentationFeedback(LogicalOutput *output);
     bool hasPresentationFeedback() const;
+    /**
+     * Marks the current state of the surface as being shown by scanning out its buffer
+     * directly, which will be reported to the client when the state is presented.
+     */
+    void markZeroCopy();
+    const PresentationStatistics &presentationStatistics() const;
 
     QRegion opaque() const;
     QRegion input() const;
@@ -447,6 +498,12 @@ Q_SIGNALS:
      * This signal is emitted when the list of child subsurfaces changes.
      */
     void childSubSurfacesChanged();
+    /**
+     * This signal is emitted on the main surface when a sub-surface anywhere in its tree has
+     * been added, removed, restacked, moved, resized, mapped or unmapped. Changes that are
+     * applied together, for example when the tree is committed in one go, are reported once.
+     */
+    void subSurfaceTreeChanged();
 
     /**
      * Emitted whenever a pointer constraint get (un)installed on this SurfaceInterface.
@@ -42,6 +42,10 @@ struct SurfaceState
     ~SurfaceState();
     SurfaceState &operator=(SurfaceState &&mv) = default;
 
+    // A state is created for every commit, their memory is recycled
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
     enum class Field {
         Input = 1 << 0,
         Opaque = 1 << 1,
@@ -147,6 +151,13 @@ public:
     bool computeEffectiveMapped() const;
     void updateEffectiveMapped();
 
+    /**
+     * Notes that the sub-surface tree this surface belongs to has changed. The main surface
+     * emits subSurfaceTreeChanged() once the transaction has been applied.
+     */
+    void markSubSurfaceTreeChanged();
+    void flushSubSurfaceTreeChanged();
+
     /**
      * Returns true if this surface (not including subsurfaces) contains a given point
      * @param position in surface-local co-ordiantes
@@ -168,6 +179,7 @@ public:
     GraphicsBufferRef bufferRef;
     QRegion bufferDamage;
     bool mapped = false;
+    bool subSurfaceTreeChanged = false;
     qreal scaleOverride = 1.;
     qreal pendingScaleOverride = 1.;
 
@@ -207,6 +219,7 @@ public:
     } subsurface;
 
     std::vector<std::unique_ptr<PresentationTimeFeedback>> pendingPresentationFeedbacks;
+    std::shared_ptr<PresentationStatistics> presentationStatistics = std::make_shared<PresentationStatistics>();
 
     bool m_tearingDown = false;
 
@@ -195,21 +195,10 @@ void TextInputV3InterfacePrivate::sendPreEdit(const QString &text, const quint32
         return;
     }
 
+    // sent with done(), so that an unchanged preedit can be skipped altogether
     pending.preeditText = text;
     pending.preeditCursorBegin = cursorBegin;
     pending.preeditCursorEnd = cursorEnd;
-
-    const QList<Resource *> textInputs = enabledTextInputsForClient(surface->client());
-    for (auto resource : textInputs) {
-        // Special handling for empty preedit, send null instead of empty string.
-        // text in preedit_string is defined as allow-null, however qt wayland can't generate a
-        // null ptr call from either null QString() or empty QString().
-        if (text.isEmpty()) {
-            zwp_text_input_v3_send_preedit_string(resource->handle, nullptr, cursorBegin, cursorEnd);
-        } else {
-            send_preedit_string(resource->handle, text, cursorBegin, cursorEnd);
-        }
-    }
 }
 
 void TextInputV3InterfacePrivate::commitString(const QString &text)
@@ -221,6 +210,7 @@ void TextInputV3InterfacePrivate::commitString(const QString &text)
     for (auto resource : textInputs) {
         send_commit_string(resource->handle, text);
     }
+    hasPendingEvents = true;
 }
 
 void TextInputV3InterfacePrivate::deleteSurroundingText(quint32 before, quint32 after)
@@ -232,6 +222,7 @@ void TextInputV3InterfacePrivate::deleteSurroundingText(quint32 before, quint32
     for (auto resource : textInputs) {
         send_delete_surrounding_text(resource->handle, before, after);
     }
+    hasPendingEvents = true;
 }
 
 void TextInputV3InterfacePrivate::done()
@@ -239,14 +230,32 @@ void TextInputV3InterfacePrivate::done()
     if (!surface) {
         return;
     }
+
+    // input methods tend to resend the preedit with every key, an update that changes nothing
+    // would only make the client lay out its text again
+    if (!hasPendingEvents && pending.preeditText == preeditText && pending.preeditCursorBegin == preeditCursorBegin
+        && pending.preeditCursorEnd == preeditCursorEnd) {
+        defaultPendingPreedit();
+        return;
+    }
+
     const QList<Resource *> textInputs = enabledTextInputsForClient(surface->client());
 
     preeditText = pending.preeditText;
     preeditCursorBegin = pending.preeditCursorBegin;
     preeditCursorEnd = pending.preeditCursorEnd;
     defaultPendingPreedit();
+    hasPendingEvents = false;
 
     for (auto resource : textInputs) {
+        // Special handling for empty preedit, send null instead of empty string.
+        // text in preedit_string is defined as allow-null, however qt wayland can't generate a
+        // null ptr call from either null QString() or empty QString().
+        if (preeditText.isEmpty()) {
+            zwp_text_input_v3_send_preedit_string(resource->handle, nullptr, preeditCursorBegin, preeditCursorEnd);
+        } else {
+            send_preedit_string(resource->handle, preeditText, preeditCursorBegin, preeditCursorEnd);
+        }
         // zwp_text_input_v3.done takes the serial argument which is equal to number of commit requests issued
         send_done(resource->handle, serialHash[resource]);
     }
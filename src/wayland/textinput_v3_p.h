@@ -67,6 +67,8 @@ public:
     QString preeditText;
     quint32 preeditCursorBegin = 0;
     quint32 preeditCursorEnd = 0;
+    // whether text has been committed or deleted since the last done
+    bool hasPendingEvents = false;
 
     struct
     {
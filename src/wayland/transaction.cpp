@@ -7,32 +7,174 @@
 #include "wayland/transaction.h"
 #include "core/syncobjtimeline.h"
 #include "utils/filedescriptor.h"
+#include "utils/freelist.h"
 #include "wayland/clientconnection.h"
 #include "wayland/subcompositor.h"
 #include "wayland/surface_p.h"
 
+#include <QSocketNotifier>
+
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
 #if defined(Q_OS_LINUX)
 #include <linux/dma-buf.h>
+#include <sys/epoll.h>
 #include <xf86drm.h>
 #endif
 
 namespace KWin
 {
 
-TransactionFence::TransactionFence(Transaction *transaction, FileDescriptor &&fileDescriptor)
+/**
+ * The TransactionFenceWatcher class watches the file descriptors of all transaction fences. On
+ * Linux, they are put in a single epoll set so only one socket notifier is needed no matter
+ * how many transactions wait, and all fences that have been signaled by the time the event
+ * loop gets to it are handled at once.
+ */
+class TransactionFenceWatcher
+{
+public:
+    TransactionFenceWatcher();
+
+    static TransactionFenceWatcher *self();
+
+    void add(TransactionFence *fence);
+    void remove(TransactionFence *fence);
+
+private:
+    void signal(const std::vector<uint64_t> &ids);
+
+    struct Watch
+    {
+        TransactionFence *fence;
+        std::unique_ptr<QSocketNotifier> notifier;
+    };
+
+    std::unordered_map<uint64_t, Watch> m_watches;
+    uint64_t m_lastId = 0;
+#if defined(Q_OS_LINUX)
+    FileDescriptor m_epoll;
+    std::unique_ptr<QSocketNotifier> m_epollNotifier;
+#endif
+};
+
+TransactionFenceWatcher::TransactionFenceWatcher()
+{
+#if defined(Q_OS_LINUX)
+    m_epoll = FileDescriptor(epoll_create1(EPOLL_CLOEXEC));
+    if (!m_epoll.isValid()) {
+        return;
+    }
+
+    m_epollNotifier = std::make_unique<QSocketNotifier>(m_epoll.get(), QSocketNotifier::Read);
+    QObject::connect(m_epollNotifier.get(), &QSocketNotifier::activated, [this]() {
+        std::vector<uint64_t> ids;
+        epoll_event events[32];
+        int count;
+        do {
+            count = epoll_wait(m_epoll.get(), events, int(std::size(events)), 0);
+            for (int i = 0; i < count; ++i) {
+                ids.push_back(events[i].data.u64);
+            }
+        } while (count == int(std::size(events)));
+        signal(ids);
+    });
+#endif
+}
+
+TransactionFenceWatcher *TransactionFenceWatcher::self()
+{
+    static TransactionFenceWatcher *watcher = new TransactionFenceWatcher();
+    return watcher;
+}
+
+void TransactionFenceWatcher::add(TransactionFence *fence)
+{
+    fence->m_id = ++m_lastId;
+
+#if defined(Q_OS_LINUX)
+    if (m_epoll.isValid()) {
+        epoll_event event{
+            .events = EPOLLIN | EPOLLONESHOT,
+            .data = {.u64 = fence->m_id},
+        };
+        if (epoll_ctl(m_epoll.get(), EPOLL_CTL_ADD, fence->m_fileDescriptor.get(), &event) == 0) {
+            m_watches[fence->m_id] = Watch{
+                .fence = fence,
+            };
+            return;
+        }
+    }
+#endif
+
+    // Fall back to watching the file descriptor on its own
+    auto notifier = std::make_unique<QSocketNotifier>(fence->m_fileDescriptor.get(), QSocketNotifier::Read);
+    QObject::connect(notifier.get(), &QSocketNotifier::activated, [this, id = fence->m_id]() {
+        signal({id});
+    });
+    m_watches[fence->m_id] = Watch{
+        .fence = fence,
+        .notifier = std::move(notifier),
+    };
+}
+
+void TransactionFenceWatcher::remove(TransactionFence *fence)
+{
+    auto it = m_watches.find(fence->m_id);
+    if (it == m_watches.end()) {
+        return;
+    }
+#if defined(Q_OS_LINUX)
+    if (!it->second.notifier) {
+        epoll_ctl(m_epoll.get(), EPOLL_CTL_DEL, fence->m_fileDescriptor.get(), nullptr);
+    }
+#endif
+    m_watches.erase(it);
+}
+
+void TransactionFenceWatcher::signal(const std::vector<uint64_t> &ids)
+{
+    // Mark all fences as signaled first so that a transaction that waits for several of them
+    // is applied once rather than being tried again for every fence
+    for (const uint64_t id : ids) {
+        if (auto it = m_watches.find(id); it != m_watches.end()) {
+            it->second.fence->m_waiting = false;
+            if (it->second.notifier) {
+                it->second.notifier->setEnabled(false);
+            }
+        }
+    }
+
+    // Applying a transaction destroys its fences and can apply the following transactions as
+    // well, so look every fence up again
+    for (const uint64_t id : ids) {
+        if (auto it = m_watches.find(id); it != m_watches.end()) {
+            it->second.fence->m_transaction->tryApply();
+        }
+    }
+}
+
+TransactionFence::TransactionFence(Transaction *transaction, FileDescriptor &&fileDescriptor, Type type)
     : m_transaction(transaction)
     , m_fileDescriptor(std::move(fileDescriptor))
+    , m_type(type)
 {
-    m_notifier = std::make_unique<QSocketNotifier>(m_fileDescriptor.get(), QSocketNotifier::Read);
-    QObject::connect(m_notifier.get(), &QSocketNotifier::activated, [this]() {
-        m_notifier->setEnabled(false);
-        m_transaction->tryApply();
-    });
+    TransactionFenceWatcher::self()->add(this);
+}
+
+TransactionFence::~TransactionFence()
+{
+    TransactionFenceWatcher::self()->remove(this);
+    if (m_type == Type::EventFd && !m_waiting) {
+        SyncTimeline::recycleEventFd(std::move(m_fileDescriptor));
+    }
 }
 
 bool TransactionFence::isWaiting() const
 {
-    return m_notifier->isEnabled();
+    return m_waiting;
 }
 
 bool TransactionEntry::isDiscarded() const
@@ -40,6 +182,19 @@ bool TransactionEntry::isDiscarded() const
     return !surface || surface->tearingDown() || surface->client()->tearingDown();
 }
 
+static FreeList<Transaction, 64> s_transactionFreeList;
+
+void *Transaction::operator new(size_t size)
+{
+    Q_ASSERT(size == sizeof(Transaction));
+    return s_transactionFreeList.allocate();
+}
+
+void Transaction::operator delete(void *ptr)
+{
+    s_transactionFreeList.release(ptr);
+}
+
 Transaction::Transaction()
 {
 }
@@ -170,6 +325,13 @@ void Transaction::apply()
         }
     }
 
+    // A sub-surface tree is usually updated in a single transaction, report it only once
+    for (TransactionEntry &entry : m_entries) {
+        if (entry.surface) {
+            SurfaceInterfacePrivate::get(mainSurface(entry.surface))->flushSubSurfaceTreeChanged();
+        }
+    }
+
     for (TransactionEntry &entry : m_entries) {
         if (entry.surface) {
             if (entry.surface->lastTransaction() == this) {
@@ -194,10 +356,75 @@ void Transaction::apply()
     delete this;
 }
 
+bool Transaction::absorbPrevious()
+{
+    if (m_entries.size() != 1) {
+        return false;
+    }
+    TransactionEntry &entry = m_entries.front();
+    Transaction *previous = entry.previousTransaction;
+    if (!previous || previous->m_entries.size() != 1 || entry.isDiscarded()) {
+        return false;
+    }
+    TransactionEntry &previousEntry = previous->m_entries.front();
+    if (previousEntry.previousTransaction || previousEntry.surface != entry.surface) {
+        return false;
+    }
+
+    // The previous transaction can be skipped only if its buffer is going to be replaced anyway
+    // and nothing but that buffer holds this transaction back. FIFO requires every frame to be
+    // shown. With explicit sync, the release point must not be signaled before the acquire point.
+    if (!(entry.state->committed & SurfaceState::Field::Buffer)) {
+        return false;
+    }
+    if (entry.state->hasFifoWaitCondition || previousEntry.state->hasFifoWaitCondition) {
+        return false;
+    }
+    if (previousEntry.state->acquirePoint.timeline) {
+        return false;
+    }
+    for (const auto &fence : entry.fences) {
+        if (fence->isWaiting()) {
+            return false;
+        }
+    }
+
+    SurfaceState *state = previousEntry.state.get();
+    const QRegion damage = state->damage | entry.state->damage;
+    const QRegion bufferDamage = state->bufferDamage | entry.state->bufferDamage;
+    entry.state->mergeInto(state);
+    state->damage = damage;
+    state->bufferDamage = bufferDamage;
+
+    entry.state = std::move(previousEntry.state);
+    entry.previousTransaction = nullptr;
+    entry.surface->setFirstTransaction(this);
+
+    // This releases the buffer of the previous transaction
+    delete previous;
+    return true;
+}
+
 void Transaction::tryApply()
 {
     if (isReady()) {
         apply();
+        return;
+    }
+
+    // If a client commits faster than its buffers become ready, the newest ready buffer
+    // replaces the older ones that are still being rendered
+    if (absorbPrevious()) {
+        if (isReady()) {
+            apply();
+        }
+        return;
+    }
+
+    // The next transaction may have been waiting only for this one to become the first. Note
+    // that it can absorb and destroy this transaction.
+    if (m_entries.size() == 1 && !m_entries.front().previousTransaction && m_entries.front().nextTransaction) {
+        m_entries.front().nextTransaction->tryApply();
     }
 }
 
@@ -243,10 +470,11 @@ void Transaction::watchSyncObj(TransactionEntry *entry)
     }
 
     if (eventFd.isReadable()) {
+        SyncTimeline::recycleEventFd(std::move(eventFd));
         return;
     }
 
-    entry->fences.emplace_back(std::make_unique<TransactionFence>(this, std::move(eventFd)));
+    entry->fences.emplace_back(std::make_unique<TransactionFence>(this, std::move(eventFd), TransactionFence::Type::EventFd));
 }
 
 #if defined(Q_OS_LINUX)
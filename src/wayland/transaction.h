@@ -9,11 +9,10 @@
 #include "core/graphicsbuffer.h"
 
 #include <QPointer>
-#include <QSocketNotifier>
+#include <QVarLengthArray>
 
 #include <functional>
 #include <memory>
-#include <vector>
 
 namespace KWin
 {
@@ -27,18 +26,32 @@ class Transaction;
  *
  * The TransactionFence prevents the corresponding transaction from getting applied until the
  * specified file descriptor becomes readable.
+ *
+ * The file descriptors of all fences are watched together, so fences that are signaled at the
+ * same time are handled in one go.
  */
 class TransactionFence
 {
 public:
-    TransactionFence(Transaction *transaction, FileDescriptor &&fileDescriptor);
+    enum class Type {
+        SyncFile,
+        // an event fd from SyncTimeline::eventFd(), which is recycled once it has been signalled
+        EventFd,
+    };
+
+    TransactionFence(Transaction *transaction, FileDescriptor &&fileDescriptor, Type type = Type::SyncFile);
+    ~TransactionFence();
 
     bool isWaiting() const;
 
 private:
     Transaction *m_transaction;
-    std::unique_ptr<QSocketNotifier> m_notifier;
     FileDescriptor m_fileDescriptor;
+    uint64_t m_id;
+    Type m_type;
+    bool m_waiting = true;
+
+    friend class TransactionFenceWatcher;
 };
 
 /**
@@ -85,7 +98,7 @@ struct TransactionEntry
     /**
      * A list of fences that must be signaled before the transaction can be applied.
      */
-    std::vector<std::unique_ptr<TransactionFence>> fences;
+    QVarLengthArray<std::unique_ptr<TransactionFence>, 1> fences;
 };
 
 /**
@@ -96,6 +109,10 @@ class KWIN_EXPORT Transaction
 public:
     Transaction();
 
+    // A transaction is created for every commit, their memory is recycled
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
     /**
      * Returns \c true if this transaction can be applied, i.e. all its dependencies are resolved;
      * otherwise returns \c false.
@@ -143,11 +160,13 @@ public:
 
 private:
     void apply();
+    bool absorbPrevious();
 
     void watchSyncObj(TransactionEntry *entry);
     void watchDmaBuf(TransactionEntry *entry);
 
-    std::vector<TransactionEntry> m_entries;
+    // Most transactions affect only one surface
+    QVarLengthArray<TransactionEntry, 1> m_entries;
 };
 
 } // namespace KWin
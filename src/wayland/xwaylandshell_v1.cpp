@@ -10,6 +10,7 @@
 
 #include "qwayland-server-xwayland-shell-v1.h"
 
+#include <QHash>
 #include <QPointer>
 
 namespace KWin
@@ -23,7 +24,7 @@ public:
     XwaylandShellV1InterfacePrivate(Display *display, XwaylandShellV1Interface *q);
 
     XwaylandShellV1Interface *q;
-    QList<XwaylandSurfaceV1Interface *> m_surfaces;
+    QHash<uint64_t, XwaylandSurfaceV1Interface *> m_surfacesBySerial;
 
 protected:
     void xwayland_shell_v1_destroy(Resource *resource) override;
@@ -77,11 +78,7 @@ void XwaylandShellV1InterfacePrivate::xwayland_shell_v1_get_xwayland_surface(Res
         surface->setRole(XwaylandSurfaceV1Interface::role());
     }
 
-    auto xwaylandSurface = new XwaylandSurfaceV1Interface(q, surface, resource->client(), id, resource->version());
-    m_surfaces.append(xwaylandSurface);
-    QObject::connect(xwaylandSurface, &QObject::destroyed, q, [this, xwaylandSurface]() {
-        m_surfaces.removeOne(xwaylandSurface);
-    });
+    new XwaylandSurfaceV1Interface(q, surface, resource->client(), id, resource->version());
 }
 
 XwaylandSurfaceV1InterfacePrivate::XwaylandSurfaceV1InterfacePrivate(XwaylandShellV1Interface *shell, SurfaceInterface *surface, wl_client *client, uint32_t id, int version, XwaylandSurfaceV1Interface *q)
@@ -96,6 +93,12 @@ void XwaylandSurfaceV1InterfacePrivate::apply(XwaylandSurfaceV1Commit *commit)
 {
     if (commit->serial.has_value()) {
         serial = commit->serial;
+        shell->d->m_surfacesBySerial.insert(*serial, q);
+        QObject::connect(q, &QObject::destroyed, shell, [shell = shell, surface = q, serial = *serial]() {
+            if (shell->d->m_surfacesBySerial.value(serial) == surface) {
+                shell->d->m_surfacesBySerial.remove(serial);
+            }
+        });
         Q_EMIT shell->surfaceAssociated(q);
     }
 }
@@ -139,12 +142,7 @@ XwaylandShellV1Interface::~XwaylandShellV1Interface()
 
 XwaylandSurfaceV1Interface *XwaylandShellV1Interface::findSurface(uint64_t serial) const
 {
-    for (XwaylandSurfaceV1Interface *surface : std::as_const(d->m_surfaces)) {
-        if (surface->serial() == serial) {
-            return surface;
-        }
-    }
-    return nullptr;
+    return d->m_surfacesBySerial.value(serial);
 }
 
 XwaylandSurfaceV1Interface::XwaylandSurfaceV1Interface(XwaylandShellV1Interface *shell, SurfaceInterface *surface, wl_client *client, uint32_t id, int version)
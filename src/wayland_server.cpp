@@ -359,20 +359,8 @@ bool WaylandServer::init()
 #if KWIN_BUILD_X11
     m_xwaylandShell = new XwaylandShellV1Interface(m_display, m_display);
     connect(m_xwaylandShell, &XwaylandShellV1Interface::surfaceAssociated, this, [](XwaylandSurfaceV1Interface *surface) {
-        X11Window *window = workspace()->findClient([&surface](const X11Window *window) {
-            return window->surfaceSerial() == surface->serial();
-        });
-        if (window) {
+        if (X11Window *window = workspace()->findX11WindowBySurfaceSerial(surface->serial().value())) {
             window->associate(surface);
-            return;
-        }
-
-        X11Window *unmanaged = workspace()->findUnmanaged([&surface](const X11Window *window) {
-            return window->surfaceSerial() == surface->serial();
-        });
-        if (unmanaged) {
-            unmanaged->associate(surface);
-            return;
         }
     });
 #endif
@@ -21,6 +21,7 @@
 #include "decorations/decoratedwindow.h"
 #include "decorations/decorationpalette.h"
 #include "focuschain.h"
+#include "geometrytransaction.h"
 #include "input.h"
 #include "outline.h"
 #include "placement.h"
@@ -49,6 +50,7 @@
 #include <QDir>
 #include <QJSEngine>
 #include <QMouseEvent>
+#include <QSet>
 #include <QStyleHints>
 
 namespace KWin
@@ -96,7 +98,6 @@ Window::Window()
     connect(Workspace::self()->applicationMenu(), &ApplicationMenu::applicationMenuEnabledChanged, this, [this] {
         Q_EMIT hasApplicationMenuChanged(hasApplicationMenu());
     });
-    connect(&m_offscreenFramecallbackTimer, &QTimer::timeout, this, &Window::maybeSendFrameCallback);
 }
 
 Window::~Window()
@@ -175,10 +176,32 @@ QString Window::wmClientMachine(bool use_localhost) const
     return m_clientMachine->hostName();
 }
 
+/**
+ * Returns a copy of @a string that shares its data with the other windows that use the same
+ * string. There are only a handful of distinct resource names and classes in a session, but
+ * every window would keep a copy of its own otherwise.
+ */
+static QString internString(const QString &string)
+{
+    static QSet<QString> pool;
+    if (string.isEmpty()) {
+        return string;
+    }
+    if (const auto it = pool.constFind(string); it != pool.cend()) {
+        return *it;
+    }
+    // clients could make up new names indefinitely, the windows keep their copies anyway
+    if (pool.size() >= 1024) {
+        pool.clear();
+    }
+    pool.insert(string);
+    return string;
+}
+
 void Window::setResourceClass(const QString &name, const QString &className)
 {
-    resource_name = name;
-    resource_class = className;
+    resource_name = internString(name);
+    resource_class = internString(className);
     Q_EMIT windowClassChanged();
 }
 
@@ -209,6 +232,7 @@ bool Window::setupCompositing()
 
     connect(windowItem(), &WindowItem::positionChanged, this, &Window::visibleGeometryChanged);
     connect(windowItem(), &WindowItem::boundingRectChanged, this, &Window::visibleGeometryChanged);
+    Q_EMIT visibleGeometryChanged();
 
     return true;
 }
@@ -373,6 +397,16 @@ bool Window::hitTest(const QPointF &point) const
     return exclusiveContains(m_bufferGeometry, point);
 }
 
+RectF Window::inputBoundingRect() const
+{
+    // The window item contains all surfaces of the window, but it may not exist yet
+    RectF rect = visibleGeometry() | frameGeometry() | bufferGeometry();
+    if (isDecorated()) {
+        rect |= RectF(m_decoration.inputRegion.boundingRect()).translated(frameGeometry().topLeft());
+    }
+    return rect;
+}
+
 QPointF Window::mapToFrame(const QPointF &point) const
 {
     return point - frameGeometry().topLeft();
@@ -529,6 +563,10 @@ void Window::markAsDeleted()
 {
     Q_ASSERT(!m_deleted);
     m_deleted = true;
+    // the window only stays around for the close animation, which doesn't need these
+    m_applicationMenuServiceName.clear();
+    m_applicationMenuObjectPath.clear();
+    m_activationToken.clear();
     workspace()->addDeleted(this);
 }
 
@@ -550,6 +588,7 @@ void Window::updateLayer()
     }
     StackingUpdatesBlocker blocker(workspace());
     m_layer = UnknownLayer; // invalidate, will be updated when doing restacking
+    workspace()->invalidateStackingLayers();
 }
 
 Layer Window::belongsToLayer() const
@@ -2663,6 +2702,7 @@ void Window::updateDecorationInputShape()
 {
     if (!isDecorated()) {
         m_decoration.inputRegion = QRegion();
+        Q_EMIT inputBoundingRectChanged();
         return;
     }
 
@@ -2673,6 +2713,7 @@ void Window::updateDecorationInputShape()
     const RectF outerRect = innerRect + borders + resizeBorders;
 
     m_decoration.inputRegion = QRegion(outerRect.toAlignedRect()) - QRect(innerRect.toAlignedRect());
+    Q_EMIT inputBoundingRectChanged();
 }
 
 void Window::updateDecorationBorderRadius()
@@ -3458,10 +3499,18 @@ void Window::moveResize(const RectF &rect)
         return;
     }
 
+    if (GeometryTransaction *transaction = workspace()->geometryTransaction()) {
+        transaction->add(this);
+    }
     setMoveResizeGeometry(rect);
     moveResizeInternal(rect, MoveResizeMode::MoveResize);
 }
 
+bool Window::isWaitingForGeometryUpdate() const
+{
+    return false;
+}
+
 bool Window::isPlaced() const
 {
     return m_placed;
@@ -4513,7 +4562,11 @@ void Window::refOffscreenRendering()
 {
     m_offscreenRenderCount++;
     if (m_offscreenRenderCount == 1) {
-        m_offscreenFramecallbackTimer.start(1'000'000 / output()->refreshRate());
+        if (!m_offscreenFramecallbackTimer) {
+            m_offscreenFramecallbackTimer = std::make_unique<QTimer>();
+            connect(m_offscreenFramecallbackTimer.get(), &QTimer::timeout, this, &Window::maybeSendFrameCallback);
+        }
+        m_offscreenFramecallbackTimer->start(1'000'000 / output()->refreshRate());
         Q_EMIT offscreenRenderingChanged();
     }
 }
@@ -4523,7 +4576,7 @@ void Window::unrefOffscreenRendering()
     Q_ASSERT(m_offscreenRenderCount);
     m_offscreenRenderCount--;
     if (m_offscreenRenderCount == 0) {
-        m_offscreenFramecallbackTimer.stop();
+        m_offscreenFramecallbackTimer->stop();
         Q_EMIT offscreenRenderingChanged();
     }
 }
@@ -4539,7 +4592,7 @@ void Window::maybeSendFrameCallback()
         const auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
         m_windowItem->framePainted(nullptr, output(), nullptr, timestamp);
         // update refresh rate, it might have changed
-        m_offscreenFramecallbackTimer.start(1'000'000 / output()->refreshRate());
+        m_offscreenFramecallbackTimer->start(1'000'000 / output()->refreshRate());
     }
 }
 
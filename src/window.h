@@ -769,6 +769,15 @@ public:
      */
     void moveResize(const RectF &geometry);
 
+    /**
+     * Returns @c true if the window has requested the client to adopt a new geometry, but the
+     * client hasn't applied it yet; otherwise returns @c false. The geometryUpdateApplied()
+     * signal is emitted when the client is done.
+     *
+     * Default implementation returns @c false.
+     */
+    virtual bool isWaitingForGeometryUpdate() const;
+
     /**
      * Returns @c true if the window has already been placed in the workspace; otherwise returns @c false.
      */
@@ -895,6 +904,11 @@ public:
      * Returns @c true if the window can accept input at the specified position @a point.
      */
     virtual bool hitTest(const QPointF &point) const;
+    /**
+     * Returns a rectangle that contains every point where hitTest() can return @c true. The
+     * inputBoundingRectChanged() signal is emitted when it may have changed.
+     */
+    RectF inputBoundingRect() const;
 
     /**
      * The window has a popup grab. This means that when it got mapped the
@@ -1458,6 +1472,13 @@ Q_SIGNALS:
      * This signal is emitted when the Window's frame geometry changes.
      */
     void frameGeometryChanged(const KWin::RectF &oldGeometry);
+    /**
+     * This signal is emitted when the client has applied all geometry changes that have been
+     * requested from it.
+     *
+     * @see isWaitingForGeometryUpdate()
+     */
+    void geometryUpdateApplied();
     /**
      * This signal is emitted when the Window's client geometry has changed.
      */
@@ -1517,6 +1538,7 @@ Q_SIGNALS:
     void applicationMenuActiveChanged(bool);
     void unresponsiveChanged(bool);
     void decorationChanged();
+    void inputBoundingRectChanged();
     void hiddenChanged();
     void hiddenByShowDesktopChanged();
     void lockScreenOverlayChanged();
@@ -1930,7 +1952,8 @@ protected:
     quint32 m_lastUsageSerial = 0;
     bool m_lockScreenOverlay = false;
     uint32_t m_offscreenRenderCount = 0;
-    QTimer m_offscreenFramecallbackTimer;
+    // only allocated while rendering offscreen, most windows never do
+    std::unique_ptr<QTimer> m_offscreenFramecallbackTimer;
 
     QString m_tag;
     QString m_description;
@@ -0,0 +1,125 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "windowhittestgrid.h"
+#include "window.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace KWin
+{
+
+static const int s_cellSize = 256;
+// A window that covers more cells than that, e.g. because it has been moved far off screen
+// and is huge, is kept out of the grid so that it doesn't blow up its memory usage
+static const int s_maxCellsPerWindow = 1024;
+
+static QPoint cellAt(const QPointF &position)
+{
+    return QPoint(std::floor(position.x() / s_cellSize), std::floor(position.y() / s_cellSize));
+}
+
+void WindowHitTestGrid::add(Window *window)
+{
+    if (m_windows.contains(window) || m_oversizedWindows.contains(window)) {
+        return;
+    }
+    connect(window, &Window::frameGeometryChanged, this, [this, window]() {
+        update(window);
+    });
+    connect(window, &Window::bufferGeometryChanged, this, [this, window]() {
+        update(window);
+    });
+    connect(window, &Window::visibleGeometryChanged, this, [this, window]() {
+        update(window);
+    });
+    connect(window, &Window::inputBoundingRectChanged, this, [this, window]() {
+        update(window);
+    });
+    m_windows.insert(window, QRect());
+    update(window);
+}
+
+void WindowHitTestGrid::remove(Window *window)
+{
+    disconnect(window, nullptr, this, nullptr);
+    if (auto it = m_windows.find(window); it != m_windows.end()) {
+        removeFromCells(window, *it);
+        m_windows.erase(it);
+    }
+    m_oversizedWindows.removeOne(window);
+}
+
+void WindowHitTestGrid::update(Window *window)
+{
+    const RectF bounds = window->inputBoundingRect();
+    QRect cells;
+    if (!bounds.isEmpty()) {
+        cells = QRect(cellAt(bounds.topLeft()), cellAt(bounds.bottomRight()));
+    }
+
+    const bool oversized = qint64(cells.width()) * cells.height() > s_maxCellsPerWindow;
+    if (oversized) {
+        if (auto it = m_windows.find(window); it != m_windows.end()) {
+            removeFromCells(window, *it);
+            m_windows.erase(it);
+            m_oversizedWindows.append(window);
+        }
+        return;
+    }
+
+    if (m_oversizedWindows.removeOne(window)) {
+        m_windows.insert(window, QRect());
+    }
+    QRect &occupiedCells = m_windows[window];
+    if (occupiedCells != cells) {
+        removeFromCells(window, occupiedCells);
+        insertIntoCells(window, cells);
+        occupiedCells = cells;
+    }
+}
+
+void WindowHitTestGrid::insertIntoCells(Window *window, const QRect &cells)
+{
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            m_cells[QPoint(x, y)].append(window);
+        }
+    }
+}
+
+void WindowHitTestGrid::removeFromCells(Window *window, const QRect &cells)
+{
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            auto it = m_cells.find(QPoint(x, y));
+            if (it == m_cells.end()) {
+                continue;
+            }
+            it->removeOne(window);
+            if (it->isEmpty()) {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+QList<Window *> WindowHitTestGrid::windowsAt(const QPointF &position) const
+{
+    QList<Window *> windows = m_cells.value(cellAt(position)) + m_oversizedWindows;
+    std::sort(windows.begin(), windows.end(), [](const Window *a, const Window *b) {
+        return a->stackingOrder() > b->stackingOrder();
+    });
+    return windows;
+}
+
+} // namespace KWin
+
+#include "moc_windowhittestgrid.cpp"
@@ -0,0 +1,55 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin developers <kwin@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+
+namespace KWin
+{
+
+class Window;
+
+/**
+ * The WindowHitTestGrid class partitions the workspace into square cells and keeps track of the
+ * windows whose input bounding rect overlaps every cell, so finding the window at a position
+ * doesn't require hit testing every window in the stacking order.
+ *
+ * The grid is conservative, the windows it reports for a position still need to be hit tested.
+ */
+class WindowHitTestGrid : public QObject
+{
+    Q_OBJECT
+
+public:
+    void add(Window *window);
+    void remove(Window *window);
+
+    /**
+     * Returns the windows that may accept input at the given @a position, topmost first.
+     */
+    QList<Window *> windowsAt(const QPointF &position) const;
+
+private:
+    void update(Window *window);
+    void insertIntoCells(Window *window, const QRect &cells);
+    void removeFromCells(Window *window, const QRect &cells);
+
+    QHash<QPoint, QList<Window *>> m_cells;
+    // The range of cells that every window occupies, in cell coordinates
+    QHash<Window *, QRect> m_windows;
+    // Windows that are too large to put them in the grid, they're always considered
+    QList<Window *> m_oversizedWindows;
+};
+
+} // namespace KWin
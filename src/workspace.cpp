@@ -23,8 +23,10 @@
 #include "core/outputconfiguration.h"
 #include "cursor.h"
 #include "dbusinterface.h"
+#include "desktopwindowindex.h"
 #include "effect/effecthandler.h"
 #include "focuschain.h"
+#include "geometrytransaction.h"
 #include "input.h"
 #include "internalwindow.h"
 #include "killwindow.h"
@@ -34,10 +36,12 @@
 #include "pointer_input.h"
 #include "rules.h"
 #include "screenedge.h"
+#include "stateexport.h"
 #include "scripting/scripting.h"
 #include "syncalarmx11filter.h"
 #include "tiles/tilemanager.h"
 #include "window.h"
+#include "windowhittestgrid.h"
 #if KWIN_BUILD_TABBOX
 #include "tabbox/tabbox.h"
 #endif
@@ -116,6 +120,8 @@ Workspace::Workspace()
     , m_userActionsMenu(new UserActionsMenu(this))
     , m_sessionManager(new SessionManager(this))
     , m_focusChain(std::make_unique<FocusChain>())
+    , m_hitTestGrid(std::make_unique<WindowHitTestGrid>())
+    , m_desktopWindowIndex(std::make_unique<DesktopWindowIndex>())
     , m_applicationMenu(std::make_unique<ApplicationMenu>())
     , m_placementTracker(std::make_unique<PlacementTracker>(this))
     , m_lidSwitchTracker(std::make_unique<LidSwitchTracker>())
@@ -190,6 +196,10 @@ void Workspace::init()
     connect(VirtualDesktopManager::self(), &VirtualDesktopManager::layoutChanged, m_screenEdges.get(), &ScreenEdges::updateLayout);
     connect(this, &Workspace::windowActivated, m_screenEdges.get(), &ScreenEdges::checkBlocking);
 
+    connect(this, &Workspace::windowAdded, m_hitTestGrid.get(), &WindowHitTestGrid::add);
+    connect(this, &Workspace::windowRemoved, m_hitTestGrid.get(), &WindowHitTestGrid::remove);
+    connect(this, &Workspace::windowAdded, m_desktopWindowIndex.get(), &DesktopWindowIndex::add);
+    connect(this, &Workspace::windowRemoved, m_desktopWindowIndex.get(), &DesktopWindowIndex::remove);
     connect(this, &Workspace::windowRemoved, m_focusChain.get(), &FocusChain::remove);
     connect(this, &Workspace::windowActivated, m_focusChain.get(), &FocusChain::setActiveWindow);
     connect(VirtualDesktopManager::self(), &VirtualDesktopManager::currentChanged, m_focusChain.get(), [this]() {
@@ -283,6 +293,8 @@ void Workspace::init()
     connect(this, &Workspace::windowRemoved, m_placementTracker.get(), &PlacementTracker::remove);
     m_placementTracker->init(outputLayoutId());
 
+    m_stateExport = std::make_unique<StateExport>(waylandServer()->socketName());
+
     connect(waylandServer()->externalBrightness(), &ExternalBrightnessV1::devicesChanged, this, &Workspace::updateOutputConfiguration);
 
     m_kdeglobalsWatcher = KConfigWatcher::create(kwinApp()->kdeglobals());
@@ -380,6 +392,7 @@ void Workspace::cleanupX11()
     }
 
     manual_overlays.clear();
+    m_x11WindowStack.clear();
 
     VirtualDesktopManager *desktopManager = VirtualDesktopManager::self();
     desktopManager->setRootInfo(nullptr);
@@ -395,6 +408,7 @@ void Workspace::cleanupX11()
 
 Workspace::~Workspace()
 {
+    m_stateExport.reset();
     blockStackingUpdates(true);
 
 #if KWIN_BUILD_X11
@@ -657,6 +671,11 @@ void Workspace::addToStack(Window *window)
     // window will already be in the stack when Workspace::addX11Window() is called.
     if (!unconstrained_stacking_order.contains(window)) {
         unconstrained_stacking_order.append(window);
+        if (m_layerStackingOrderValid) {
+            const Layer layer = window->layer();
+            m_layerStackingOrder[layer].append(window);
+            m_stackingLayers.insert(window, layer);
+        }
     }
     if (!stacking_order.contains(window)) {
         stacking_order.append(window);
@@ -667,6 +686,10 @@ void Workspace::removeFromStack(Window *window)
 {
     unconstrained_stacking_order.removeAll(window);
     stacking_order.removeAll(window);
+    if (const auto it = m_stackingLayers.constFind(window); it != m_stackingLayers.constEnd()) {
+        m_layerStackingOrder[it.value()].removeOne(window);
+        m_stackingLayers.erase(it);
+    }
 
     for (int i = m_constraints.count() - 1; i >= 0; --i) {
         Constraint *constraint = m_constraints[i];
@@ -728,6 +751,10 @@ void Workspace::addX11Window(X11Window *window)
     m_focusChain->update(window, FocusChain::Update);
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
+    addX11WindowToIndex(window);
+    // The window may have been mapped before and lowered in manage() since then, so its last
+    // known position in the stack is stale
+    m_x11WindowStack.removeOne(window->window());
     addToStack(window);
     window->updateLayer();
     window->checkActiveModal();
@@ -740,6 +767,7 @@ void Workspace::addUnmanaged(X11Window *window)
 {
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
+    addX11WindowToIndex(window);
     addToStack(window);
     updateXStackingOrder();
     updateStackingOrder(true);
@@ -756,15 +784,46 @@ void Workspace::removeX11Window(X11Window *window)
     if (group != nullptr) {
         group->lostLeader();
     }
+    removeX11WindowFromIndex(window);
     removeWindow(window);
 }
 
 void Workspace::removeUnmanaged(X11Window *window)
 {
     Q_ASSERT(m_windows.contains(window));
+    removeX11WindowFromIndex(window);
     m_windows.removeOne(window);
     Q_EMIT windowRemoved(window);
 }
+
+void Workspace::addX11WindowToIndex(X11Window *window)
+{
+    m_x11WindowsById.insert(window->window(), window);
+    if (window->surfaceSerial()) {
+        m_x11WindowsBySurfaceSerial.insert(window->surfaceSerial(), window);
+    }
+}
+
+void Workspace::removeX11WindowFromIndex(X11Window *window)
+{
+    // A new window with the same id may have been tracked already, leave it alone
+    if (auto it = m_x11WindowsById.find(window->window()); it != m_x11WindowsById.end() && *it == window) {
+        m_x11WindowsById.erase(it);
+    }
+    if (auto it = m_x11WindowsBySurfaceSerial.find(window->surfaceSerial()); it != m_x11WindowsBySurfaceSerial.end() && *it == window) {
+        m_x11WindowsBySurfaceSerial.erase(it);
+    }
+}
+
+void Workspace::setX11WindowSurfaceSerial(X11Window *window, quint64 serial)
+{
+    if (auto it = m_x11WindowsBySurfaceSerial.find(window->surfaceSerial()); it != m_x11WindowsBySurfaceSerial.end() && *it == window) {
+        m_x11WindowsBySurfaceSerial.erase(it);
+    }
+    if (serial) {
+        m_x11WindowsBySurfaceSerial.insert(serial, window);
+    }
+}
 #endif
 
 void Workspace::addDeleted(Window *c)
@@ -974,11 +1033,8 @@ void Workspace::updateWindowVisibilityAndActivateOnDesktopChange(VirtualDesktop
     // Restore the focus on this desktop
     --block_focus;
 
-    for (Window *window : std::as_const(m_windows)) {
-        if (!window->isOnDesktop(newDesktop)) {
-            continue;
-        }
-
+    const QList<Window *> windows = windowsOnDesktop(newDesktop);
+    for (Window *window : windows) {
         Tile *tile = nullptr;
         for (const auto &[output, manager] : m_tileManagers) {
             if (Tile *candidate = manager->tileForWindow(window, newDesktop)) {
@@ -1793,6 +1849,7 @@ QString Workspace::supportInformation() const
             }
 
             support.append(QStringLiteral("OpenGL 2 Shaders are used\n"));
+            support.append(QStringLiteral("Blocking GPU waits: ") + QString::number(EglContext::blockingWaitCount()) + QStringLiteral("\n"));
             break;
         }
         case QPainterCompositing:
@@ -1885,19 +1942,78 @@ X11Window *Workspace::findUnmanaged(std::function<bool(const X11Window *)> func)
 
 X11Window *Workspace::findUnmanaged(xcb_window_t w) const
 {
-    return findUnmanaged([w](const X11Window *u) {
-        return u->window() == w;
-    });
+    X11Window *window = m_x11WindowsById.value(w);
+    if (window && window->isUnmanaged()) {
+        return window;
+    }
+    return nullptr;
 }
 
 X11Window *Workspace::findClient(xcb_window_t w) const
 {
-    return findClient([w](const X11Window *c) {
-        return c->window() == w;
-    });
+    X11Window *window = m_x11WindowsById.value(w);
+    if (window && !window->isUnmanaged()) {
+        return window;
+    }
+    return nullptr;
+}
+
+X11Window *Workspace::findX11WindowBySurfaceSerial(quint64 serial) const
+{
+    return m_x11WindowsBySurfaceSerial.value(serial);
+}
+
+X11Window *Workspace::findX11WindowBySyncAlarm(xcb_sync_alarm_t alarm) const
+{
+    return m_x11WindowsBySyncAlarm.value(alarm);
+}
+
+void Workspace::addSyncAlarm(xcb_sync_alarm_t alarm, X11Window *window)
+{
+    m_x11WindowsBySyncAlarm.insert(alarm, window);
+}
+
+void Workspace::removeSyncAlarm(xcb_sync_alarm_t alarm)
+{
+    m_x11WindowsBySyncAlarm.remove(alarm);
 }
 #endif
 
+QList<Window *> Workspace::windowsAt(const QPointF &position) const
+{
+    return m_hitTestGrid->windowsAt(position);
+}
+
+QList<Window *> Workspace::windowsOnDesktop(VirtualDesktop *desktop) const
+{
+    return m_desktopWindowIndex->windowsOnDesktop(desktop);
+}
+
+QList<Window *> Workspace::windowsOnActivity(const QString &activity) const
+{
+    return m_desktopWindowIndex->windowsOnActivity(activity);
+}
+
+void Workspace::beginGeometryTransaction()
+{
+    if (m_geometryTransactionNesting++ == 0) {
+        m_geometryTransaction = new GeometryTransaction(this);
+    }
+}
+
+void Workspace::endGeometryTransaction()
+{
+    Q_ASSERT(m_geometryTransactionNesting > 0);
+    if (--m_geometryTransactionNesting == 0) {
+        std::exchange(m_geometryTransaction, nullptr)->commit();
+    }
+}
+
+GeometryTransaction *Workspace::geometryTransaction() const
+{
+    return m_geometryTransaction;
+}
+
 Window *Workspace::findWindow(std::function<bool(const Window *)> func) const
 {
     return Window::findInList(m_windows, func);
@@ -21,11 +21,17 @@
 #include "utils/serial.h"
 // KF
 #include <netwm_def.h>
+// xcb
+#if KWIN_BUILD_X11
+#include <xcb/sync.h>
+#endif
 // Qt
+#include <QHash>
 #include <QList>
 #include <QStringList>
 #include <QTimer>
 // std
+#include <array>
 #include <functional>
 #include <memory>
 
@@ -67,11 +73,15 @@ class VirtualDesktop;
 class X11Window;
 class X11EventFilter;
 class FocusChain;
+class GeometryTransaction;
+class WindowHitTestGrid;
+class DesktopWindowIndex;
 class ApplicationMenu;
 class PlacementTracker;
 class Outline;
 class RuleBook;
 class ScreenEdges;
+class StateExport;
 #if KWIN_BUILD_ACTIVITIES
 class Activities;
 #endif
@@ -113,6 +123,17 @@ public:
     void forEachClient(std::function<void(X11Window *)> func);
     X11Window *findUnmanaged(std::function<bool(const X11Window *)> func) const;
     X11Window *findUnmanaged(xcb_window_t w) const;
+    /**
+     * Returns the X11 window whose wl_surface has been announced with the given @a serial.
+     */
+    X11Window *findX11WindowBySurfaceSerial(quint64 serial) const;
+    void setX11WindowSurfaceSerial(X11Window *window, quint64 serial);
+    /**
+     * Returns the X11 window that waits for the given sync @a alarm.
+     */
+    X11Window *findX11WindowBySyncAlarm(xcb_sync_alarm_t alarm) const;
+    void addSyncAlarm(xcb_sync_alarm_t alarm, X11Window *window);
+    void removeSyncAlarm(xcb_sync_alarm_t alarm);
 #endif
 
     Window *findWindow(const QUuid &internalId) const;
@@ -157,6 +178,35 @@ public:
     Window *activeWindow() const;
 
     Window *windowUnderMouse(LogicalOutput *output) const;
+    /**
+     * Returns the windows that may accept input at the given @a position, topmost first. The
+     * returned windows still need to be hit tested with Window::hitTest().
+     */
+    QList<Window *> windowsAt(const QPointF &position) const;
+    /**
+     * Returns the windows on the given virtual @a desktop, including the windows on all
+     * desktops. Unlike windows(), the list is not in the stacking order.
+     */
+    QList<Window *> windowsOnDesktop(VirtualDesktop *desktop) const;
+    /**
+     * Returns the windows on the given @a activity, including the windows on all activities.
+     * Unlike windows(), the list is not in the stacking order.
+     */
+    QList<Window *> windowsOnActivity(const QString &activity) const;
+
+    /**
+     * Opens a geometry transaction, or joins the one that is already open. The windows that
+     * are moved or resized until the matching endGeometryTransaction() call show up with
+     * their new geometry together.
+     *
+     * @see GeometryTransaction
+     */
+    void beginGeometryTransaction();
+    void endGeometryTransaction();
+    /**
+     * Returns the geometry transaction that is open, or @c null if there's none.
+     */
+    GeometryTransaction *geometryTransaction() const;
 
     void activateWindow(Window *window, bool force = false);
     bool requestFocus(Window *window, bool force = false);
@@ -188,6 +238,11 @@ public:
     void stackAbove(Window *window, Window *reference);
     void raiseOrLowerWindow(Window *window);
     void updateStackingOrder(bool propagate_new_windows = false);
+    /**
+     * Tells the workspace that the layer of a window has changed, so the windows get sorted
+     * into their layers anew on the next stacking order update.
+     */
+    void invalidateStackingLayers();
 
     void constrain(Window *below, Window *above);
     void unconstrain(Window *below, Window *above);
@@ -588,6 +643,9 @@ private:
     void saveOldScreenSizes();
     void addToStack(Window *window);
     void removeFromStack(Window *window);
+    void rebuildLayerStackingOrder();
+    void raiseInLayerStackingOrder(Window *window);
+    void lowerInLayerStackingOrder(Window *window);
 
 #if KWIN_BUILD_X11
     void initializeX11();
@@ -600,6 +658,8 @@ private:
     void addX11Window(X11Window *c);
     X11Window *createUnmanaged(xcb_window_t windowId);
     void addUnmanaged(X11Window *c);
+    void addX11WindowToIndex(X11Window *window);
+    void removeX11WindowFromIndex(X11Window *window);
     bool updateXStackingOrder();
 #endif
     void setupWindowConnections(Window *window);
@@ -656,8 +716,20 @@ private:
 
     QList<Window *> m_windows;
     QList<Window *> deleted;
+#if KWIN_BUILD_X11
+    // Indices of the X11 windows in m_windows, so that event handling doesn't need to scan
+    // the whole window list
+    QHash<xcb_window_t, X11Window *> m_x11WindowsById;
+    QHash<quint64, X11Window *> m_x11WindowsBySurfaceSerial;
+    QHash<xcb_sync_alarm_t, X11Window *> m_x11WindowsBySyncAlarm;
+#endif
 
     QList<Window *> unconstrained_stacking_order; // Topmost last
+    // unconstrained_stacking_order split up by layer, topmost last. It's kept up to date when
+    // windows are added, removed, raised or lowered, and rebuilt after any other change.
+    std::array<QList<Window *>, NumLayers> m_layerStackingOrder;
+    QHash<Window *, Layer> m_stackingLayers; // The layer a window is sorted into in m_layerStackingOrder
+    bool m_layerStackingOrderValid = false;
     QList<Window *> stacking_order; // Topmost last
     QList<Window *> attention_chain;
 
@@ -668,6 +740,7 @@ private:
     bool was_user_interaction;
 #if KWIN_BUILD_X11
     QList<xcb_window_t> manual_overlays; // Topmost last
+    QList<xcb_window_t> m_x11WindowStack; // The order the X11 windows have been restacked in last, topmost first
     std::unique_ptr<Xcb::Window> m_nullFocus;
     std::unique_ptr<X11EventFilter> m_syncAlarmFilter;
     UInt32Serial m_x11FocusSerial = 0;
@@ -708,11 +781,16 @@ private:
     int m_blockStackingUpdates = 0; // When > 0, stacking updates are temporarily disabled
     bool m_blockedPropagatingNewWindows; // Propagate also new windows after enabling stacking updates?
     friend class StackingUpdatesBlocker;
+    friend class SessionManager;
 
     std::unique_ptr<KillWindow> m_windowKiller;
 
     SessionManager *m_sessionManager;
     std::unique_ptr<FocusChain> m_focusChain;
+    std::unique_ptr<WindowHitTestGrid> m_hitTestGrid;
+    std::unique_ptr<DesktopWindowIndex> m_desktopWindowIndex;
+    GeometryTransaction *m_geometryTransaction = nullptr;
+    int m_geometryTransactionNesting = 0;
     std::unique_ptr<ApplicationMenu> m_applicationMenu;
     std::unique_ptr<Decoration::DecorationBridge> m_decorationBridge;
     std::unique_ptr<Outline> m_outline;
@@ -726,6 +804,7 @@ private:
     std::unique_ptr<Activities> m_activities;
 #endif
     std::unique_ptr<PlacementTracker> m_placementTracker;
+    std::unique_ptr<StateExport> m_stateExport;
 
     PlaceholderOutput *m_placeholderOutput = nullptr;
     std::unique_ptr<PlaceholderInputEventFilter> m_placeholderFilter;
@@ -770,6 +849,26 @@ private:
     Workspace *ws;
 };
 
+/**
+ * Helper for Workspace::beginGeometryTransaction() and endGeometryTransaction() being called in pairs
+ */
+class GeometryTransactionScope
+{
+public:
+    explicit GeometryTransactionScope(Workspace *workspace)
+        : m_workspace(workspace)
+    {
+        m_workspace->beginGeometryTransaction();
+    }
+    ~GeometryTransactionScope()
+    {
+        m_workspace->endGeometryTransaction();
+    }
+
+private:
+    Workspace *m_workspace;
+};
+
 //---------------------------------------------------------
 // Unsorted
 
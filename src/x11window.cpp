@@ -21,6 +21,7 @@
 #include "decorations/decorationbridge.h"
 #include "focuschain.h"
 #include "group.h"
+#include "input.h"
 #include "killprompt.h"
 #include "netinfo.h"
 #include "placement.h"
@@ -38,6 +39,8 @@
 #include <KStartupInfo>
 #include <KX11Extras>
 // Qt
+#include <QIconEngine>
+#include <QPainter>
 #include <QProcess>
 // xcb
 #include <xcb/xcb_icccm.h>
@@ -46,6 +49,7 @@
 // c++
 #include <cmath>
 #include <csignal>
+#include <utility>
 
 namespace KWin
 {
@@ -99,6 +103,80 @@ const NET::WindowTypes SUPPORTED_UNMANAGED_WINDOW_TYPES_MASK = NET::NormalMask
  * \brief The Client class encapsulates a window decoration frame.
  */
 
+/**
+ * The X11WindowIconEngine class decodes the icon of an X11 window only when a pixmap of
+ * some size is requested, and keeps the decoded pixmaps. Windows often provide icons in
+ * many sizes, but only one or two of them are ever shown.
+ */
+class X11WindowIconEngine : public QIconEngine
+{
+public:
+    explicit X11WindowIconEngine(X11Window *window)
+        : m_window(window)
+    {
+    }
+
+    QIconEngine *clone() const override
+    {
+        auto engine = new X11WindowIconEngine(m_window);
+        engine->m_pixmaps = m_pixmaps;
+        return engine;
+    }
+
+    QString key() const override
+    {
+        return QStringLiteral("X11WindowIconEngine");
+    }
+
+    bool isNull() override
+    {
+        return false;
+    }
+
+    QList<QSize> availableSizes(QIcon::Mode mode, QIcon::State state) override
+    {
+        QList<QSize> sizes;
+        if (m_window && m_window->info) {
+            if (const int *iconSizes = m_window->info->iconSizes()) {
+                for (int i = 0; iconSizes[i] && iconSizes[i + 1]; i += 2) {
+                    sizes.append(QSize(iconSizes[i], iconSizes[i + 1]));
+                }
+            }
+        }
+        if (sizes.isEmpty()) {
+            sizes = {QSize(16, 16), QSize(32, 32), QSize(48, 48), QSize(64, 64), QSize(128, 128)};
+        }
+        return sizes;
+    }
+
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override
+    {
+        const int extent = std::max(size.width(), size.height());
+        auto it = m_pixmaps.find(extent);
+        if (it == m_pixmaps.end()) {
+            QPixmap pixmap;
+            if (m_window && m_window->info) {
+                // small icons are scaled to the exact size, larger ones are used as they are
+                pixmap = KX11Extras::icon(m_window->window(), extent, extent, extent <= 32, KX11Extras::NETWM | KX11Extras::WMHints, m_window->info);
+            }
+            it = m_pixmaps.insert(extent, pixmap);
+        }
+        return *it;
+    }
+
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override
+    {
+        const QPixmap pixmap = this->pixmap(rect.size(), mode, state);
+        if (!pixmap.isNull()) {
+            painter->drawPixmap(rect, pixmap);
+        }
+    }
+
+private:
+    QPointer<X11Window> m_window;
+    QHash<int, QPixmap> m_pixmaps;
+};
+
 /**
  * This ctor is "dumb" - it only initializes data. All the real initialization
  * is done in manage().
@@ -243,6 +321,7 @@ void X11Window::releaseWindow(bool on_shutdown)
         m_syncRequest.timeout->stop();
     }
     if (m_syncRequest.alarm != XCB_NONE) {
+        workspace()->removeSyncAlarm(m_syncRequest.alarm);
         xcb_sync_destroy_alarm(kwinApp()->x11Connection(), m_syncRequest.alarm);
         m_syncRequest.alarm = XCB_NONE;
     }
@@ -289,6 +368,7 @@ void X11Window::destroyWindow()
         m_syncRequest.timeout->stop();
     }
     if (m_syncRequest.alarm != XCB_NONE) {
+        workspace()->removeSyncAlarm(m_syncRequest.alarm);
         xcb_sync_destroy_alarm(kwinApp()->x11Connection(), m_syncRequest.alarm);
         m_syncRequest.alarm = XCB_NONE;
     }
@@ -361,6 +441,9 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     m_client.reset(w, false, windowGeometry.rect());
     m_client.setBorderWidth(0);
     m_client.selectInput(XCB_EVENT_MASK_FOCUS_CHANGE | XCB_EVENT_MASK_PROPERTY_CHANGE);
+    if (Xcb::Extensions::self()->isShapeAvailable()) {
+        xcb_shape_select_input(kwinApp()->x11Connection(), window(), true);
+    }
 
     bit_depth = windowGeometry->depth;
 
@@ -379,6 +462,8 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     auto applicationMenuServiceNameCookie = fetchApplicationMenuServiceName();
     auto applicationMenuObjectPathCookie = fetchApplicationMenuObjectPath();
     auto pidCookie = fetchPid();
+    auto syncCounterCookie = fetchSyncCounter();
+    const auto shapeCookies = fetchShapeRegion();
 
     m_geometryHints.init(window());
     m_motif.init(window());
@@ -396,7 +481,7 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     getResourceClass();
     readWmClientLeader(wmClientLeaderCookie);
     getWmClientMachine();
-    getSyncCounter();
+    readSyncCounter(syncCounterCookie);
     setCaption(readName());
 
     // Sending ConfigureNotify is done when setting mapping state below, getting the
@@ -410,10 +495,7 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     setupWindowRules();
     connect(this, &X11Window::windowClassChanged, this, &X11Window::evaluateWindowRules);
 
-    if (Xcb::Extensions::self()->isShapeAvailable()) {
-        xcb_shape_select_input(kwinApp()->x11Connection(), window(), true);
-    }
-    updateShapeRegion();
+    readShapeRegion(shapeCookies);
     detectNoBorder();
     fetchIconicName();
     setClientFrameExtents(info->gtkFrameExtents());
@@ -1603,6 +1685,31 @@ void X11Window::fetchName()
     setCaption(readName());
 }
 
+void X11Window::schedulePropertyUpdate(PropertyUpdate update)
+{
+    if (!m_pendingPropertyUpdates) {
+        QMetaObject::invokeMethod(this, &X11Window::applyPropertyUpdates, Qt::QueuedConnection);
+    }
+    m_pendingPropertyUpdates |= update;
+}
+
+void X11Window::applyPropertyUpdates()
+{
+    const uint updates = std::exchange(m_pendingPropertyUpdates, 0);
+    if (isDeleted()) {
+        return;
+    }
+    if (updates & NameUpdate) {
+        fetchName();
+    }
+    if (updates & IconicNameUpdate) {
+        fetchIconicName();
+    }
+    if (updates & IconUpdate) {
+        getIcons();
+    }
+}
+
 static inline QString readNameProperty(xcb_window_t w, xcb_atom_t atom)
 {
     const auto cookie = xcb_icccm_get_text_property_unchecked(kwinApp()->x11Connection(), w, atom);
@@ -1743,17 +1850,11 @@ void X11Window::getIcons()
         return;
     }
     QIcon icon;
-    auto readIcon = [this, &icon](int size, bool scale = true) {
-        const QPixmap pix = KX11Extras::icon(window(), size, size, scale, KX11Extras::NETWM | KX11Extras::WMHints, info);
-        if (!pix.isNull()) {
-            icon.addPixmap(pix);
-        }
-    };
-    readIcon(16);
-    readIcon(32);
-    readIcon(48, false);
-    readIcon(64, false);
-    readIcon(128, false);
+    const int *iconSizes = info->iconSizes();
+    if ((iconSizes && iconSizes[0] && iconSizes[1]) || info->icccmIconPixmap() != XCB_PIXMAP_NONE) {
+        // The icon is decoded in the sizes that are actually asked for
+        icon = QIcon(new X11WindowIconEngine(this));
+    }
     if (icon.isNull()) {
         // Then try window group
         icon = group()->icon();
@@ -1778,19 +1879,33 @@ void X11Window::getIcons()
     setIcon(icon);
 }
 
-void X11Window::getSyncCounter()
+Xcb::Property X11Window::fetchSyncCounter() const
 {
     if (!Xcb::Extensions::self()->isSyncAvailable()) {
-        return;
+        return Xcb::Property();
     }
 
     static bool noXsync = qEnvironmentVariableIntValue("KWIN_X11_NO_SYNC_REQUEST") == 1;
     if (noXsync) {
+        return Xcb::Property();
+    }
+
+    return Xcb::Property(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
+}
+
+void X11Window::getSyncCounter()
+{
+    Xcb::Property property = fetchSyncCounter();
+    readSyncCounter(property);
+}
+
+void X11Window::readSyncCounter(Xcb::Property &property)
+{
+    if (property.isNull()) {
         return;
     }
 
-    Xcb::Property syncProp(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
-    const xcb_sync_counter_t counter = syncProp.value<xcb_sync_counter_t>().value_or(XCB_NONE);
+    const xcb_sync_counter_t counter = property.value<xcb_sync_counter_t>().value_or(XCB_NONE);
     if (counter != XCB_NONE) {
         m_syncRequest.enabled = true;
         m_syncRequest.counter = counter;
@@ -1811,6 +1926,7 @@ void X11Window::getSyncCounter()
             if (error) {
                 m_syncRequest.alarm = XCB_NONE;
             } else {
+                workspace()->addSyncAlarm(m_syncRequest.alarm, this);
                 xcb_sync_change_alarm_value_list_t value{};
                 value.value.hi = 0;
                 value.value.lo = 1;
@@ -2218,6 +2334,12 @@ void X11Window::finishSync()
     }
 
     m_syncRequest.acked = false;
+
+    // The pointer motion that has arrived while waiting for the client has been held back,
+    // catch up with it in one step
+    if (isInteractiveResize()) {
+        updateInteractiveMoveResize(interactiveMoveResizeAnchor(), input()->keyboardModifiers());
+    }
 }
 
 bool X11Window::belongToSameApplication(const X11Window *c1, const X11Window *c2, SameApplicationChecks checks)
@@ -3925,6 +4047,33 @@ void X11Window::doInteractiveResizeSync(const RectF &rect)
         return;
     }
 
+    // There's no point in asking the client to resize more often than the output refreshes,
+    // hold back the step and send the latest geometry once the refresh cycle is over
+    const uint32_t refreshRate = output() ? output()->refreshRate() : 0;
+    const std::chrono::nanoseconds interval(refreshRate ? 1'000'000'000'000ull / refreshRate : 0);
+    if (m_lastInteractiveResizeStep.isValid() && m_lastInteractiveResizeStep.durationElapsed() < interval) {
+        m_pendingInteractiveResizeGeometry = rect;
+        if (!m_interactiveResizeTimer) {
+            m_interactiveResizeTimer = new QTimer(this);
+            m_interactiveResizeTimer->setSingleShot(true);
+            m_interactiveResizeTimer->setTimerType(Qt::PreciseTimer);
+            connect(m_interactiveResizeTimer, &QTimer::timeout, this, [this]() {
+                if (const auto geometry = std::exchange(m_pendingInteractiveResizeGeometry, std::nullopt)) {
+                    // If a sync request has been sent in the meantime, finishSync() will catch up
+                    if (isInteractiveResize() && !isWaitingForInteractiveResizeSync()) {
+                        doInteractiveResizeSync(*geometry);
+                    }
+                }
+            });
+        }
+        if (!m_interactiveResizeTimer->isActive()) {
+            m_interactiveResizeTimer->start(std::chrono::ceil<std::chrono::milliseconds>(interval - m_lastInteractiveResizeStep.durationElapsed()));
+        }
+        return;
+    }
+    m_pendingInteractiveResizeGeometry.reset();
+    m_lastInteractiveResizeStep.start();
+
     if (!m_syncRequest.enabled) {
         moveResize(rect);
     } else {
@@ -3934,6 +4083,15 @@ void X11Window::doInteractiveResizeSync(const RectF &rect)
     }
 }
 
+void X11Window::doFinishInteractiveMoveResize()
+{
+    // Don't lose the last step of the resize if it has been held back
+    if (const auto geometry = std::exchange(m_pendingInteractiveResizeGeometry, std::nullopt)) {
+        moveResize(*geometry);
+    }
+    m_lastInteractiveResizeStep.invalidate();
+}
+
 void X11Window::applyWindowRules()
 {
     Window::applyWindowRules();
@@ -3994,13 +4152,40 @@ QList<QRectF> X11Window::shapeRegion() const
     return m_shapeRegion;
 }
 
+std::optional<X11Window::ShapeCookies> X11Window::fetchShapeRegion() const
+{
+    if (!Xcb::Extensions::self()->isShapeAvailable()) {
+        return std::nullopt;
+    }
+    // Ask for the rectangles right away rather than after the extents have arrived, so both
+    // requests need only one round trip
+    xcb_connection_t *connection = kwinApp()->x11Connection();
+    return ShapeCookies{
+        .extents = xcb_shape_query_extents_unchecked(connection, window()),
+        .rectangles = xcb_shape_get_rectangles_unchecked(connection, window(), XCB_SHAPE_SK_BOUNDING),
+    };
+}
+
 void X11Window::updateShapeRegion()
+{
+    readShapeRegion(fetchShapeRegion());
+}
+
+void X11Window::readShapeRegion(const std::optional<ShapeCookies> &cookies)
 {
     const QRectF bufferGeometry = this->bufferGeometry();
     const auto previousRegion = m_shapeRegion;
-    if (Xcb::Extensions::self()->hasShape(window())) {
-        auto cookie = xcb_shape_get_rectangles_unchecked(kwinApp()->x11Connection(), window(), XCB_SHAPE_SK_BOUNDING);
-        UniqueCPtr<xcb_shape_get_rectangles_reply_t> reply(xcb_shape_get_rectangles_reply(kwinApp()->x11Connection(), cookie, nullptr));
+    xcb_connection_t *connection = kwinApp()->x11Connection();
+    bool shaped = false;
+    if (cookies) {
+        UniqueCPtr<xcb_shape_query_extents_reply_t> extents(xcb_shape_query_extents_reply(connection, cookies->extents, nullptr));
+        shaped = extents && extents->bounding_shaped > 0;
+        if (!shaped) {
+            xcb_discard_reply(connection, cookies->rectangles.sequence);
+        }
+    }
+    if (shaped) {
+        UniqueCPtr<xcb_shape_get_rectangles_reply_t> reply(xcb_shape_get_rectangles_reply(connection, cookies->rectangles, nullptr));
         if (reply) {
             m_shapeRegion.clear();
             const xcb_rectangle_t *rects = xcb_shape_get_rectangles_rectangles(reply.get());
@@ -26,6 +26,7 @@
 // X
 #include <NETWM>
 #include <xcb/res.h>
+#include <xcb/shape.h>
 #include <xcb/sync.h>
 
 // TODO: Cleanup the order of things in this .h file
@@ -270,6 +271,7 @@ protected:
     bool belongsToDesktop() const override;
     bool isWaitingForInteractiveResizeSync() const override;
     void doInteractiveResizeSync(const RectF &rect) override;
+    void doFinishInteractiveMoveResize() override;
     QSizeF resizeIncrements() const override;
     bool acceptsFocus() const override;
     void doSetQuickTileMode() override;
@@ -291,10 +293,29 @@ private:
     void getMotifHints();
     void getIcons();
     void getWmOpaqueRegion();
+    struct ShapeCookies
+    {
+        xcb_shape_query_extents_cookie_t extents;
+        xcb_shape_get_rectangles_cookie_t rectangles;
+    };
+    std::optional<ShapeCookies> fetchShapeRegion() const;
+    void readShapeRegion(const std::optional<ShapeCookies> &cookies);
     void updateShapeRegion();
     void fetchName();
     void fetchIconicName();
     QString readName() const;
+
+    enum PropertyUpdate {
+        NameUpdate = 1 << 0,
+        IconicNameUpdate = 1 << 1,
+        IconUpdate = 1 << 2,
+    };
+    /**
+     * Refetches the given properties once the pending X11 events have been processed, clients
+     * that update their title or icon rapidly would otherwise cause a refetch for every change.
+     */
+    void schedulePropertyUpdate(PropertyUpdate update);
+    void applyPropertyUpdates();
     void setCaption(const QString &s, bool force = false);
     bool hasTransientInternal(const X11Window *c, bool indirect, QList<const X11Window *> &set) const;
     void setShortcutInternal() override;
@@ -306,6 +327,8 @@ private:
     void getSkipCloseAnimation();
 
     void configureRequest(int value_mask, qreal rx, qreal ry, qreal rw, qreal rh, int gravity, bool from_tool);
+    Xcb::Property fetchSyncCounter() const;
+    void readSyncCounter(Xcb::Property &property);
     void getSyncCounter();
     void sendSyncRequest();
 
@@ -395,12 +418,16 @@ private:
     pid_t m_pid = 0;
     NET::Actions allowed_actions;
     SyncRequest m_syncRequest;
+    QTimer *m_interactiveResizeTimer = nullptr;
+    QElapsedTimer m_lastInteractiveResizeStep;
+    std::optional<RectF> m_pendingInteractiveResizeGeometry;
     static bool check_active_modal; ///< \see X11Window::checkActiveModal()
     int sm_stacking_order;
     int bit_depth = 24;
     QRegion opaque_region;
     QList<QRectF> m_shapeRegion;
     friend struct ResetupRulesProcedure;
+    friend class X11WindowIconEngine;
 
     friend bool performTransiencyCheck();
 
@@ -412,6 +439,7 @@ private:
 
     QTimer *m_focusOutTimer;
     QTimer m_releaseTimer;
+    uint m_pendingPropertyUpdates = 0;
     QPointer<VirtualDesktop> m_netWmDesktop;
 
     QMetaObject::Connection m_edgeGeometryTrackingConnection;
@@ -21,7 +21,6 @@
 #include "killprompt.h"
 #include "placement.h"
 #include "tiles/tilemanager.h"
-#include "utils/subsurfacemonitor.h"
 #include "virtualdesktops.h"
 #include "wayland/appmenu.h"
 #include "wayland/output.h"
@@ -40,6 +39,8 @@
 #include <KDecoration3/DecoratedWindow>
 #include <KDecoration3/Decoration>
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -67,15 +68,7 @@ XdgSurfaceWindow::XdgSurfaceWindow(XdgSurfaceInterface *shellSurface)
     // out that geometry updates do not occur that frequently, so we don't need to recompute the
     // bounding geometry every time the client commits the surface.
 
-    SubSurfaceMonitor *treeMonitor = new SubSurfaceMonitor(surface(), this);
-
-    connect(treeMonitor, &SubSurfaceMonitor::subSurfaceAdded,
-            this, &XdgSurfaceWindow::setHaveNextWindowGeometry);
-    connect(treeMonitor, &SubSurfaceMonitor::subSurfaceRemoved,
-            this, &XdgSurfaceWindow::setHaveNextWindowGeometry);
-    connect(treeMonitor, &SubSurfaceMonitor::subSurfaceMoved,
-            this, &XdgSurfaceWindow::setHaveNextWindowGeometry);
-    connect(treeMonitor, &SubSurfaceMonitor::subSurfaceResized,
+    connect(surface(), &SurfaceInterface::subSurfaceTreeChanged,
             this, &XdgSurfaceWindow::setHaveNextWindowGeometry);
     connect(shellSurface, &XdgSurfaceInterface::windowGeometryChanged,
             this, &XdgSurfaceWindow::setHaveNextWindowGeometry);
@@ -137,6 +130,16 @@ void XdgSurfaceWindow::handleConfigureAcknowledged(quint32 serial)
     m_lastAcknowledgedConfigureSerial = serial;
 }
 
+bool XdgSurfaceWindow::isWaitingForGeometryUpdate() const
+{
+    if (m_configureTimer->isActive() && (m_configureFlags & XdgSurfaceConfigure::ConfigurePosition)) {
+        return true;
+    }
+    return std::any_of(m_configureEvents.cbegin(), m_configureEvents.cend(), [](const XdgSurfaceConfigure *configureEvent) {
+        return configureEvent->flags & XdgSurfaceConfigure::ConfigurePosition;
+    });
+}
+
 void XdgSurfaceWindow::handleCommit()
 {
     if (!m_shellSurface->isConfigured()) {
@@ -147,6 +150,8 @@ void XdgSurfaceWindow::handleCommit()
         return;
     }
 
+    const bool wasWaitingForGeometryUpdate = isWaitingForGeometryUpdate();
+
     if (m_lastAcknowledgedConfigureSerial.has_value()) {
         const quint32 serial = m_lastAcknowledgedConfigureSerial.value();
         while (!m_configureEvents.isEmpty()) {
@@ -168,6 +173,10 @@ void XdgSurfaceWindow::handleCommit()
     m_lastAcknowledgedConfigureSerial.reset();
 
     markAsMapped();
+
+    if (wasWaitingForGeometryUpdate && !isWaitingForGeometryUpdate()) {
+        Q_EMIT geometryUpdateApplied();
+    }
 }
 
 void XdgSurfaceWindow::handleRolePrecommit()
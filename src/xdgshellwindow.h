@@ -67,6 +67,7 @@ public:
     WindowType windowType() const override;
     RectF frameRectToBufferRect(const RectF &rect) const override;
     void destroyWindow() override;
+    bool isWaitingForGeometryUpdate() const override;
 
     void installPlasmaShellSurface(PlasmaShellSurfaceInterface *shellSurface);
 
@@ -25,6 +25,7 @@
 #include <xkbcommon/xkbcommon-keysyms.h>
 // system
 #include "main.h"
+#include <algorithm>
 #include <bitset>
 #include <linux/input-event-codes.h>
 #include <sys/mman.h>
@@ -509,6 +510,9 @@ Xkb::~Xkb()
     xkb_compose_table_unref(m_compose.table);
     xkb_state_unref(m_state);
     xkb_keymap_unref(m_keymap);
+    for (const CachedKeymap &entry : m_keymapCache) {
+        xkb_keymap_unref(entry.keymap);
+    }
     xkb_context_unref(m_context);
 }
 
@@ -604,7 +608,7 @@ xkb_keymap *Xkb::loadKeymapFromConfig()
 
     m_layoutList = QString::fromLatin1(ruleNames.layout).split(QLatin1Char(','));
 
-    return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    return compileKeymap(ruleNames);
 }
 
 xkb_keymap *Xkb::loadDefaultKeymap()
@@ -612,7 +616,7 @@ xkb_keymap *Xkb::loadDefaultKeymap()
     xkb_rule_names ruleNames = {};
     applyEnvironmentRules(ruleNames);
     m_layoutList = QString::fromLatin1(ruleNames.layout).split(QLatin1Char(','));
-    return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    return compileKeymap(ruleNames);
 }
 
 xkb_keymap *Xkb::loadKeymapFromLocale1()
@@ -637,7 +641,58 @@ xkb_keymap *Xkb::loadKeymapFromLocale1()
 
     m_layoutList = QString::fromLatin1(ruleNames.layout).split(QLatin1Char(','));
 
-    return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    return compileKeymap(ruleNames);
+}
+
+xkb_keymap *Xkb::findCachedKeymap(const QByteArray &key)
+{
+    const auto it = std::ranges::find(m_keymapCache, key, &CachedKeymap::key);
+    if (it == m_keymapCache.end()) {
+        return nullptr;
+    }
+    CachedKeymap entry = std::move(*it);
+    m_keymapCache.erase(it);
+    m_keymapCache.push_front(std::move(entry));
+    return xkb_keymap_ref(m_keymapCache.front().keymap);
+}
+
+void Xkb::cacheKeymap(const QByteArray &key, xkb_keymap *keymap)
+{
+    // Switching between a handful of configurations is common, e.g. when the virtual keyboard
+    // types a symbol that isn't in the layout, there is no need to keep more of them around
+    static const size_t s_maxCachedKeymaps = 8;
+    if (m_keymapCache.size() == s_maxCachedKeymaps) {
+        xkb_keymap_unref(m_keymapCache.back().keymap);
+        m_keymapCache.pop_back();
+    }
+    m_keymapCache.push_front(CachedKeymap{
+        .key = key,
+        .keymap = xkb_keymap_ref(keymap),
+        .contents = QByteArray(),
+    });
+}
+
+xkb_keymap *Xkb::compileKeymap(const xkb_rule_names &ruleNames)
+{
+    // A component that is not set is different from an empty one, libxkbcommon falls back to
+    // the defaults for the former
+    auto component = [](const char *value) {
+        return value ? QByteArrayLiteral("=") + value : QByteArray();
+    };
+    const QByteArray key = component(ruleNames.rules) + '\n'
+        + component(ruleNames.model) + '\n'
+        + component(ruleNames.layout) + '\n'
+        + component(ruleNames.variant) + '\n'
+        + component(ruleNames.options);
+    if (xkb_keymap *keymap = findCachedKeymap(key)) {
+        return keymap;
+    }
+
+    xkb_keymap *keymap = xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (keymap) {
+        cacheKeymap(key, keymap);
+    }
+    return keymap;
 }
 
 void Xkb::updateKeymap(xkb_keymap *keymap)
@@ -746,12 +801,25 @@ QByteArray Xkb::keymapContents() const
     if (!m_keymap) {
         return {};
     }
+    return keymapContents(m_keymap);
+}
 
-    UniqueCPtr<char> keymapString(xkb_keymap_get_as_string(m_keymap, XKB_KEYMAP_FORMAT_TEXT_V1));
+QByteArray Xkb::keymapContents(xkb_keymap *keymap) const
+{
+    const auto it = std::ranges::find(m_keymapCache, keymap, &CachedKeymap::keymap);
+    if (it != m_keymapCache.end() && !it->contents.isEmpty()) {
+        return it->contents;
+    }
+
+    UniqueCPtr<char> keymapString(xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1));
     if (!keymapString) {
         return {};
     }
-    return keymapString.get();
+    const QByteArray contents = keymapString.get();
+    if (it != m_keymapCache.end()) {
+        it->contents = contents;
+    }
+    return contents;
 }
 
 void Xkb::updateModifiers(uint32_t modsDepressed, uint32_t modsLatched, uint32_t modsLocked, uint32_t group)
@@ -1328,11 +1396,9 @@ QByteArray Xkb::keymapContentsForKeysym(xkb_keycode_t newKeycode, xkb_keysym_t c
     if (!keymap) {
         return {};
     }
-    UniqueCPtr<char> keymapString(xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1));
-    if (!keymapString) {
-        return {};
-    }
-    return keymapString.get();
+    const QByteArray contents = keymapContents(keymap);
+    xkb_keymap_unref(keymap);
+    return contents;
 }
 
 bool Xkb::updateToKeymapForKeySym(xkb_keycode_t newKeycode, xkb_keysym_t customSym)
@@ -1371,9 +1437,14 @@ xkb_keymap *Xkb::createKeymapForKeysym(xkb_keycode_t newKeycode,
 )eof",
         keycode, symName);
 
+    const QByteArray source = keyMapString.toLatin1();
+    if (xkb_keymap *cachedMap = findCachedKeymap(source)) {
+        return cachedMap;
+    }
+
     struct xkb_keymap *newMap =
         xkb_keymap_new_from_string(m_context,
-                                   keyMapString.toLatin1().constData(),
+                                   source.constData(),
                                    XKB_KEYMAP_FORMAT_TEXT_V1,
                                    XKB_KEYMAP_COMPILE_NO_FLAGS);
 
@@ -1381,6 +1452,7 @@ xkb_keymap *Xkb::createKeymapForKeysym(xkb_keycode_t newKeycode,
         qWarning() << "Could not create new keymap for keysym" << customSym;
         return {};
     }
+    cacheKeymap(source, newMap);
     return newMap;
 }
 }
@@ -16,6 +16,7 @@
 
 #include <QLoggingCategory>
 
+#include <deque>
 #include <optional>
 
 Q_DECLARE_LOGGING_CATEGORY(KWIN_XKB)
@@ -166,6 +167,10 @@ private:
     xkb_keymap *loadDefaultKeymap();
     xkb_keymap *loadKeymapFromLocale1();
     xkb_keymap *createKeymapForKeysym(xkb_keycode_t newKeycode, xkb_keysym_t customSym);
+    xkb_keymap *compileKeymap(const xkb_rule_names &ruleNames);
+    xkb_keymap *findCachedKeymap(const QByteArray &key);
+    void cacheKeymap(const QByteArray &key, xkb_keymap *keymap);
+    QByteArray keymapContents(xkb_keymap *keymap) const;
     void updateKeymap(xkb_keymap *keymap);
     void createKeymapFile();
     void updateModifiers();
@@ -173,6 +178,15 @@ private:
     xkb_context *m_context;
     xkb_keymap *m_keymap;
     QStringList m_layoutList;
+
+    struct CachedKeymap
+    {
+        QByteArray key;
+        xkb_keymap *keymap;
+        QByteArray contents;
+    };
+    // The most recently used keymaps are at the front
+    mutable std::deque<CachedKeymap> m_keymapCache;
     xkb_state *m_state;
     xkb_mod_index_t m_shiftModifier;
     xkb_mod_index_t m_capsModifier;
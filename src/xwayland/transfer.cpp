@@ -16,6 +16,7 @@
 #include <xcb/xfixes.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <unistd.h>
 
 #include <xwayland_logging.h>
@@ -27,6 +28,9 @@ namespace Xwl
 
 // in Bytes: equals 64KB
 static const uint32_t s_incrChunkSize = 63 * 1024;
+// Reading from a Wayland source pauses while this many chunks wait for the X client to take
+// them, so that a large selection isn't kept in memory at once
+static const qsizetype s_maxPendingChunks = 16;
 
 Transfer::Transfer(xcb_atom_t selection, FileDescriptor fd, xcb_timestamp_t timestamp, QObject *parent)
     : QObject(parent)
@@ -95,6 +99,9 @@ int TransferWltoX::flushSourceData()
     resetTimeout();
 
     const auto rm = m_chunks.takeFirst();
+    if (QSocketNotifier *notifier = socketNotifier(); notifier && !notifier->isEnabled()) {
+        notifier->setEnabled(true);
+    }
     return rm.first.size();
 }
 
@@ -142,6 +149,9 @@ void TransferWltoX::readWlSource()
 
     ssize_t readLen = read(fd(), m_chunks.last().first.data() + oldLen, avail);
     if (readLen == -1) {
+        if (errno == EAGAIN || errno == EINTR) {
+            return;
+        }
         qCWarning(KWIN_XWL) << "Error reading in Wl data.";
 
         // TODO: cleanup X side?
@@ -181,6 +191,10 @@ void TransferWltoX::readWlSource()
             // starting incremental transfer
             startIncr();
         }
+        if (m_chunks.size() >= s_maxPendingChunks) {
+            // wait until the requestor has caught up
+            socketNotifier()->setEnabled(false);
+        }
     }
     resetTimeout();
 }
@@ -414,9 +428,13 @@ void TransferXtoWl::dataSourceWrite()
 
     ssize_t len = write(fd(), property.constData(), property.size());
     if (len == -1) {
-        qCWarning(KWIN_XWL) << "X11 to Wayland write error on fd:" << fd();
-        endTransfer();
-        return;
+        if (errno != EAGAIN && errno != EINTR) {
+            qCWarning(KWIN_XWL) << "X11 to Wayland write error on fd:" << fd();
+            endTransfer();
+            return;
+        }
+        // the pipe is full, try again once the client has read from it
+        len = 0;
     }
 
     m_receiver->partRead(len);
@@ -21,6 +21,7 @@
 #include "core/output.h"
 #include "keyboard_input.h"
 #include "main_wayland.h"
+#include "options.h"
 #include "utils/common.h"
 #include "utils/xcbutils.h"
 #include "wayland/display.h"
@@ -28,10 +29,13 @@
 #include "waylandwindow.h"
 #include "workspace.h"
 #include "x11eventfilter.h"
+#include "x11window.h"
 #include "xkb.h"
 #include "xwayland_logging.h"
 
+#include <KConfigGroup>
 #include <KSelectionOwner>
+#include <KSharedConfig>
 #include <wayland/keyboard.h>
 #include <wayland/pointer.h>
 #include <wayland/seat.h>
@@ -47,6 +51,7 @@
 #include <QTimer>
 #include <QtConcurrentRun>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <input_event.h>
@@ -59,6 +64,11 @@ namespace KWin
 namespace Xwl
 {
 
+/**
+ * The number of past sessions that are looked at to guess whether X11 clients will be used.
+ */
+static const int s_usageHistoryLength = 8;
+
 class XrandrEventFilter : public X11EventFilter
 {
 public:
@@ -87,7 +97,7 @@ class XwaylandInputFilter : public QObject, public KWin::InputEventFilter
 {
 public:
     XwaylandInputFilter()
-        : KWin::InputEventFilter(InputFilterOrder::XWayland)
+        : KWin::InputEventFilter(InputFilterOrder::XWayland, InputEventKind::Pointer | InputEventKind::Keyboard)
     {
         connect(waylandServer()->seat(), &SeatInterface::focusedKeyboardSurfaceAboutToChange,
                 this, [this](SurfaceInterface *newSurface) {
@@ -362,6 +372,9 @@ Xwayland::Xwayland(Application *app)
     connect(m_launcher, &XwaylandLauncher::ready, this, &Xwayland::handleXwaylandReady);
     connect(m_launcher, &XwaylandLauncher::finished, this, &Xwayland::handleXwaylandFinished);
     connect(m_launcher, &XwaylandLauncher::errorOccurred, this, &Xwayland::errorOccurred);
+
+    connect(&m_idleTimer, &QTimer::timeout, this, &Xwayland::checkIdle);
+    connect(options, &Options::xwaylandIdleTimeoutChanged, this, &Xwayland::updateIdleTimer);
 }
 
 Xwayland::~Xwayland()
@@ -379,6 +392,73 @@ void Xwayland::init()
     qputenv("DISPLAY", m_launcher->displayName().toLatin1());
     qputenv("XAUTHORITY", m_launcher->xauthority().toLatin1());
     m_app->setProcessStartupEnvironment(env);
+
+    // one bit per session, the lowest one is the current session
+    KConfigGroup state(KSharedConfig::openStateConfig(), QStringLiteral("Xwayland"));
+    const uint previousSessions = state.readEntry("SessionsWithX11Clients", 0u) & ((1u << s_usageHistoryLength) - 1);
+    m_usageHistory = previousSessions << 1;
+    state.writeEntry("SessionsWithX11Clients", m_usageHistory);
+    state.sync();
+    connect(workspace(), &Workspace::windowAdded, this, [this](Window *window) {
+        if (qobject_cast<X11Window *>(window)) {
+            recordX11Usage();
+        }
+    });
+
+    // the X11 socket is listened on anyway, so this merely saves the first X11 client the
+    // time it takes to start Xwayland
+    if (options->xwaylandPrewarm() && previousSessions) {
+        qCDebug(KWIN_XWL) << "Starting Xwayland ahead of time, X11 clients were used in the previous sessions";
+        m_launcher->start();
+    }
+}
+
+void Xwayland::recordX11Usage()
+{
+    if (m_usageHistory & 1) {
+        return;
+    }
+    m_usageHistory |= 1;
+    KConfigGroup state(KSharedConfig::openStateConfig(), QStringLiteral("Xwayland"));
+    state.writeEntry("SessionsWithX11Clients", m_usageHistory);
+    state.sync();
+}
+
+void Xwayland::updateIdleTimer()
+{
+    m_idleSince.reset();
+    const std::chrono::seconds timeout(options->xwaylandIdleTimeout());
+    if (timeout.count() <= 0 || !kwinApp()->x11Connection()) {
+        m_idleTimer.stop();
+        return;
+    }
+    m_idleTimer.start(std::clamp<std::chrono::milliseconds>(timeout / 4, std::chrono::seconds(1), std::chrono::seconds(30)));
+}
+
+void Xwayland::checkIdle()
+{
+    xcb_connection_t *connection = kwinApp()->x11Connection();
+    if (!connection) {
+        return;
+    }
+    UniqueCPtr<xcb_res_query_clients_reply_t> clients(xcb_res_query_clients_reply(connection, xcb_res_query_clients(connection), nullptr));
+    if (!clients) {
+        return;
+    }
+    // kwin itself is a client too
+    if (clients->num_clients > 1) {
+        m_idleSince.reset();
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_idleSince) {
+        m_idleSince = now;
+    } else if (now - *m_idleSince >= std::chrono::seconds(options->xwaylandIdleTimeout())) {
+        qCInfo(KWIN_XWL) << "Stopping Xwayland, there have been no X11 clients for" << options->xwaylandIdleTimeout() << "seconds";
+        // the listening sockets stay open, the next X11 client starts Xwayland again
+        m_launcher->stop();
+    }
 }
 
 XwaylandLauncher *Xwayland::xwaylandLauncher() const
@@ -443,6 +523,9 @@ void Xwayland::uninstallSocketNotifier()
 
 void Xwayland::handleXwaylandFinished()
 {
+    m_idleTimer.stop();
+    m_idleSince.reset();
+
     disconnect(workspace(), &Workspace::outputOrderChanged, this, &Xwayland::updatePrimary);
 
     delete m_xrandrEventsFilter;
@@ -496,6 +579,7 @@ void Xwayland::handleXwaylandReady()
     connect(options, &Options::xwaylandEavesdropsMouseChanged, this, &Xwayland::refreshEavesdropping);
 
     runXWaylandStartupScripts();
+    updateIdleTimer();
 
     Q_EMIT started();
 }
@@ -19,7 +19,11 @@
 
 #include "xwayland_interface.h"
 
+#include <QTimer>
+
+#include <chrono>
 #include <memory>
+#include <optional>
 
 class KSelectionOwner;
 class QSocketNotifier;
@@ -83,6 +87,10 @@ private:
 
     void runXWaylandStartupScripts();
 
+    void recordX11Usage();
+    void updateIdleTimer();
+    void checkIdle();
+
     bool dragMoveFilter(Window *target, const QPointF &position) override;
     AbstractDropHandler *xwlDropHandler() override;
     QSocketNotifier *m_socketNotifier = nullptr;
@@ -96,6 +104,10 @@ private:
     XwaylandLauncher *m_launcher;
     std::unique_ptr<XwaylandInputFilter> m_inputFilter;
 
+    QTimer m_idleTimer;
+    std::optional<std::chrono::steady_clock::time_point> m_idleSince;
+    uint m_usageHistory = 0;
+
     Q_DISABLE_COPY(Xwayland)
 };
 